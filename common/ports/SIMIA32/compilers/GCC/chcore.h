@@ -459,6 +459,11 @@ static inline void port_enable(void) {
  */
 static inline void port_wait_for_interrupt(void) {
 
+#if CH_CFG_ST_TIMEDELTA > 0
+  /* The free-running timer only signals on the next deadline, the idle
+     process sleeps until then.*/
+  st_lld_wait_for_interrupt();
+#endif
 }
 
 /*===========================================================================*/
@@ -36,6 +36,8 @@
 #include "qhal_serial_virtual.h"
 
 /* Shared headers.*/
+#include "qhal_ramfunc.h"
+#include "qhal_perf.h"
 
 /* Layered drivers.*/
 #include "qhal_flash.h"
@@ -45,18 +47,34 @@
 
 /* Complex drivers.*/
 #include "qhal_flash_jedec_spi.h"
+#include "qhal_flash_jedec_qspi.h"
 #include "qhal_nvm_partition.h"
 #include "qhal_nvm_file.h"
 #include "qhal_nvm_memory.h"
 #include "qhal_nvm_mirror.h"
 #include "qhal_nvm_fee.h"
 #include "qhal_nvm_ioblock.h"
+#include "qhal_nvm_ftl.h"
+#include "qhal_nvm_async.h"
+#include "qhal_nvm_sched.h"
+#include "qhal_nvm_stripe.h"
+#include "qhal_nvm_cache.h"
+#include "qhal_nvm_write_buffer.h"
+#include "qhal_nvm_read_ahead.h"
+#include "qhal_nvm_compress.h"
+#include "qhal_nvm_wear.h"
+#include "qhal_nvm_dedup.h"
+#include "qhal_nvm_trace.h"
+#include "qhal_nvm_nor_sim.h"
 #include "qhal_led.h"
+#include "qhal_led_group.h"
 #include "qhal_gd_ili9341.h"
+#include "qhal_gd_framebuffer.h"
 #include "qhal_ms5541.h"
 #include "qhal_serial_fdx.h"
 #include "qhal_ms58xx.h"
 #include "qhal_bq275xx.h"
+#include "qhal_i2c_sched.h"
 
 /*===========================================================================*/
 /* External declarations.                                                    */
@@ -17,6 +17,34 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Battery data fields for @p bq275xxReadFields()
+ * @{
+ */
+#define BQ275XX_FIELD_TEMPERATURE                       (1u << 0)
+#define BQ275XX_FIELD_VOLTAGE                           (1u << 1)
+#define BQ275XX_FIELD_NOM_AVAILABLE_CAPACITY            (1u << 2)
+#define BQ275XX_FIELD_FULL_AVAILABLE_CAPACITY           (1u << 3)
+#define BQ275XX_FIELD_REMAINING_CAPACITY                (1u << 4)
+#define BQ275XX_FIELD_FULL_CHARGE_CAPACITY              (1u << 5)
+#define BQ275XX_FIELD_EFFECTIVE_CURRENT                 (1u << 6)
+#define BQ275XX_FIELD_STATE_OF_CHARGE                   (1u << 7)
+#define BQ275XX_FIELD_INTERNAL_TEMPERATURE              (1u << 8)
+#define BQ275XX_FIELD_REM_CAPACITY_UNFILTERED           (1u << 9)
+#define BQ275XX_FIELD_REM_CAPACITY_FILTERED             (1u << 10)
+#define BQ275XX_FIELD_FULL_CHARGE_CAPACITY_UNFILTERED   (1u << 11)
+#define BQ275XX_FIELD_FULL_CHARGE_CAPACITY_FILTERED     (1u << 12)
+#define BQ275XX_FIELD_STATE_OF_CHARGE_UNFILTERED        (1u << 13)
+#define BQ275XX_FIELD_TIME_TO_EMPTY                     (1u << 14)
+#define BQ275XX_FIELD_STANDBY_TIME_TO_EMPTY             (1u << 15)
+#define BQ275XX_FIELD_ALL                               0xffffu
+/** @} */
+
+/**
+ * @brief   Number of battery data fields.
+ */
+#define BQ275XX_FIELDS                                  16
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -114,6 +142,11 @@ typedef struct
     I2CDriver* i2cp;
     uint8_t i2c_address;
     systime_t i2c_timeout;
+    /**
+     * @brief Age up to which cached readings are returned, 0 disables the
+     *        cache.
+     */
+    systime_t max_age;
 } BQ275XXConfig;
 
 /**
@@ -141,6 +174,18 @@ struct BQ275XXDriver
     Semaphore semaphore;
 #endif
 #endif /* BQ275XX_USE_MUTUAL_EXCLUSION */
+    /**
+    * @brief Cached readings.
+    */
+    bq275xx_bat_data_s cache;
+    /**
+    * @brief Time each field of @p cache was read.
+    */
+    systime_t cache_time[BQ275XX_FIELDS];
+    /**
+    * @brief Mask of the valid fields of @p cache.
+    */
+    uint32_t cache_valid;
 };
 
 /*===========================================================================*/
@@ -163,6 +208,8 @@ extern "C" {
     void bq275xxAcquireBus(BQ275XXDriver* bq275xxp);
     void bq275xxReleaseBus(BQ275XXDriver* bq275xxp);
     bool bq275xxReadData(BQ275XXDriver* bq275xxp, bq275xx_bat_data_s* datap);
+    bool bq275xxReadFields(BQ275XXDriver* bq275xxp, bq275xx_bat_data_s* datap,
+            uint32_t fields);
     bool bq275xxCommandBatInsert(BQ275XXDriver* bq275xxp);
     bool bq275xxCommandBatRemove(BQ275XXDriver* bq275xxp);
 #ifdef __cplusplus
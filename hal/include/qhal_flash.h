@@ -55,16 +55,59 @@
 #if !defined(FLASH_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define FLASH_USE_MUTUAL_EXCLUSION              TRUE
 #endif
+
+/**
+ * @brief   Lets readers share the flash.
+ * @details The mutex is replaced by a readers-writer lock and the
+ *          @p flashAcquireBusShared() and @p flashReleaseBusShared() APIs
+ *          are enabled.
+ */
+#if !defined(FLASH_USE_RW_LOCK) || defined(__DOXYGEN__)
+#define FLASH_USE_RW_LOCK                       FALSE
+#endif
+
+/**
+ * @brief   Enables the @p flashStartRequest() API.
+ * @details Requests are advanced from the end of operation interrupt so
+ *          the caller is not blocked while the flash is busy.
+ */
+#if !defined(FLASH_USE_REQUEST) || defined(__DOXYGEN__)
+#define FLASH_USE_REQUEST                       FALSE
+#endif
+
+/**
+ * @brief   Skips erasing sectors which are already blank.
+ * @details @p flashErase() scans each sector through the memory mapped
+ *          flash before erasing it, blank sectors are left alone.
+ */
+#if !defined(FLASH_ERASE_SKIP_BLANK) || defined(__DOXYGEN__)
+#define FLASH_ERASE_SKIP_BLANK                  FALSE
+#endif
+
+/**
+ * @brief   Bytes programmed per kernel lock in a bank not used for execution.
+ * @details Writes and erases of such a bank leave the kernel unlocked
+ *          between chunks and while waiting, a power of two which is a
+ *          multiple of the program unit.
+ */
+#if !defined(FLASH_OTHER_BANK_CHUNK_SIZE) || defined(__DOXYGEN__)
+#define FLASH_OTHER_BANK_CHUNK_SIZE             256
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if FLASH_USE_RW_LOCK && !FLASH_USE_MUTUAL_EXCLUSION
+#error "FLASH_USE_RW_LOCK requires FLASH_USE_MUTUAL_EXCLUSION"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
 
+#include "qrwlock.h"
 #include "qhal_flash_lld.h"
 
 /*===========================================================================*/
@@ -92,12 +135,22 @@ extern "C" {
     bool flashGetInfo(FLASHDriver* flashp, NVMDeviceInfo* nvmdip);
     void flashAcquireBus(FLASHDriver* flashp);
     void flashReleaseBus(FLASHDriver* flashp);
+    void flashAcquireBusShared(FLASHDriver* flashp);
+    void flashReleaseBusShared(FLASHDriver* flashp);
     bool flashWriteProtect(FLASHDriver* flashp, uint32_t startaddr,
             uint32_t n);
     bool flashMassWriteProtect(FLASHDriver* flashp);
     bool flashWriteUnprotect(FLASHDriver* flashp, uint32_t startaddr,
             uint32_t n);
     bool flashMassWriteUnprotect(FLASHDriver* flashp);
+    bool flashIsErased(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
+            bool* erasedp);
+    bool flashMap(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
+            const uint8_t** ptrp);
+#if FLASH_USE_REQUEST || defined(__DOXYGEN__)
+    bool flashStartRequest(FLASHDriver* flashp, NVMRequest* reqp);
+    void _flash_serve_request_isr(FLASHDriver* flashp, bool failed);
+#endif /* FLASH_USE_REQUEST */
 #ifdef __cplusplus
 }
 #endif
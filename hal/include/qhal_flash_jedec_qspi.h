@@ -0,0 +1,259 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qflash_jedec_qspi.h
+ * @brief   FLASH JEDEC over quad SPI driver header.
+ *
+ * @addtogroup FLASH_JEDEC_QSPI
+ * @{
+ */
+
+#ifndef _QFLASH_JEDEC_QSPI_H_
+#define _QFLASH_JEDEC_QSPI_H_
+
+#if HAL_USE_FLASH_JEDEC_QSPI || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    FLASH_JEDEC_QSPI configuration options
+ * @{
+ */
+/**
+ * @brief   Delays insertions.
+ * @details If enabled this options inserts delays into the flash waiting
+ *          routines releasing some extra CPU time for the threads with
+ *          lower priority, this may slow down the driver a bit however.
+ */
+#if !defined(FLASH_JEDEC_QSPI_NICE_WAITING) || defined(__DOXYGEN__)
+#define FLASH_JEDEC_QSPI_NICE_WAITING            TRUE
+#endif
+
+/**
+ * @brief   Enables the @p fjqAcquireBus() and @p fjqReleaseBus() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION    TRUE
+#endif
+
+/**
+ * @brief   Keeps the flash memory mapped while idle.
+ * @details Reads and the @p fjqMap() API go through the memory mapped
+ *          window. Program and erase commands leave the mapped mode, it is
+ *          entered again once the chip is idle.
+ * @note    On cores with data cache the window must be non cacheable.
+ */
+#if !defined(FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED) || defined(__DOXYGEN__)
+#define FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED       FALSE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !HAL_USE_WSPI
+#error "FLASH_JEDEC_QSPI driver requires HAL_USE_WSPI"
+#endif
+
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED && !WSPI_SUPPORTS_MEMMAP
+#error "FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED requires WSPI_SUPPORTS_MEMMAP"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Read command and bus width.
+ */
+typedef enum
+{
+    FLASH_JEDEC_QSPI_READ_1_1_1 = 0,    /**< FAST READ (0x0b).              */
+    FLASH_JEDEC_QSPI_READ_1_1_2 = 1,    /**< Dual output read (0x3b).       */
+    FLASH_JEDEC_QSPI_READ_1_1_4 = 2,    /**< Quad output read (0x6b).       */
+    FLASH_JEDEC_QSPI_READ_1_4_4 = 3,    /**< Quad I/O read (0xeb).          */
+} fjqreadmode_t;
+
+/**
+ * @brief   Page program command and bus width.
+ */
+typedef enum
+{
+    FLASH_JEDEC_QSPI_PROGRAM_1_1_1 = 0, /**< Page program (0x02).           */
+    FLASH_JEDEC_QSPI_PROGRAM_1_1_4 = 1, /**< Quad page program (0x32).      */
+} fjqprogrammode_t;
+
+/**
+ * @brief   Location of the quad enable bit.
+ */
+typedef enum
+{
+    FLASH_JEDEC_QSPI_QE_NONE = 0,       /**< No QE bit or always enabled.   */
+    FLASH_JEDEC_QSPI_QE_SR1_BIT6 = 1,   /**< Bit 6 of status register 1.    */
+    FLASH_JEDEC_QSPI_QE_SR2_BIT1 = 2,   /**< Bit 1 of status register 2,
+                                             read by 0x35, written by 0x31. */
+} fjqqemode_t;
+
+/**
+ * @brief   Flash JEDEC over quad SPI driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief WSPI driver associated to this Flash JEDEC driver.
+    */
+    WSPIDriver* wspip;
+    /**
+    * @brief WSPI driver configuration or NULL if already started.
+    */
+    const WSPIConfig* wspi_cfgp;
+    /**
+     * @brief Smallest erasable sector size in bytes.
+     */
+    uint32_t sector_size;
+    /**
+     * @brief Total number of sectors.
+     */
+    uint32_t sector_num;
+    /**
+     * @brief Maximum amount of data programmable through page program command.
+     */
+    uint32_t page_size;
+    /**
+     * @brief Number of address bytes used in commands, 3 or 4.
+     */
+    uint8_t addrbytes_num;
+    /**
+     * @brief Sector erase command.
+     */
+    uint8_t cmd_sector_erase;
+    /**
+     * @brief Read command and bus width.
+     */
+    fjqreadmode_t read_mode;
+    /**
+     * @brief Dummy cycles of the read command.
+     * For @p FLASH_JEDEC_QSPI_READ_1_4_4 the two cycles of the mode byte
+     * are sent separately and not part of this count.
+     */
+    uint8_t read_dummy_cycles;
+    /**
+     * @brief Page program command and bus width.
+     */
+    fjqprogrammode_t program_mode;
+    /**
+     * @brief Quad enable bit set by @p fjqStart().
+     */
+    fjqqemode_t qe_mode;
+    /**
+     * @brief Datasheet timing reported through @p fjqGetInfo().
+     * Leave zeroed if unknown.
+     */
+    NVMDeviceTiming timing;
+} FlashJedecQSPIConfig;
+
+/**
+ * @brief   @p FlashJedecQSPIDriver specific methods.
+ */
+#define _flash_jedec_qspi_driver_methods                                      \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p FlashJedecQSPIDriver virtual methods table.
+ */
+struct FlashJedecQSPIDriverVMT
+{
+    _flash_jedec_qspi_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a FLASH JEDEC over quad SPI driver.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct FlashJedecQSPIDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const FlashJedecQSPIConfig* config;
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED || defined(__DOXYGEN__)
+    /**
+     * @brief Base of the memory mapped window or @p NULL if not mapped.
+     */
+    uint8_t* mapped;
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+#if FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION */
+} FlashJedecQSPIDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void fjqInit(void);
+    void fjqObjectInit(FlashJedecQSPIDriver* fjqp);
+    void fjqStart(FlashJedecQSPIDriver* fjqp,
+            const FlashJedecQSPIConfig* config);
+    void fjqStop(FlashJedecQSPIDriver* fjqp);
+    bool fjqRead(FlashJedecQSPIDriver* fjqp, uint32_t startaddr, uint32_t n,
+            uint8_t* buffer);
+    bool fjqWrite(FlashJedecQSPIDriver* fjqp, uint32_t startaddr, uint32_t n,
+            const uint8_t* buffer);
+    bool fjqErase(FlashJedecQSPIDriver* fjqp, uint32_t startaddr, uint32_t n);
+    bool fjqMassErase(FlashJedecQSPIDriver* fjqp);
+    bool fjqSync(FlashJedecQSPIDriver* fjqp);
+    bool fjqGetInfo(FlashJedecQSPIDriver* fjqp, NVMDeviceInfo* nvmdip);
+    void fjqAcquireBus(FlashJedecQSPIDriver* fjqp);
+    void fjqReleaseBus(FlashJedecQSPIDriver* fjqp);
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED || defined(__DOXYGEN__)
+    bool fjqMap(FlashJedecQSPIDriver* fjqp, uint32_t startaddr, uint32_t n,
+            const uint8_t** ptrp);
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_FLASH_JEDEC_QSPI */
+
+#endif /* _QFLASH_JEDEC_QSPI_H_ */
+
+/** @} */
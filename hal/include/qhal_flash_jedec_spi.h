@@ -29,6 +29,11 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Number of block erase commands besides the sector erase.
+ */
+#define FLASH_JEDEC_SPI_BLOCK_ERASE_NUM (NVM_ERASE_SIZES_NUM - 1)
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -44,6 +49,9 @@
  *          lower priority, this may slow down the driver a bit however.
  *          This option is recommended also if the SPI driver does not
  *          use a DMA channel and heavily loads the CPU.
+ *          Waits first sleep through the expected duration of the pending
+ *          operation, taken from the measured average or the configured
+ *          timing, then poll without delay for up to one system tick.
  */
 #if !defined(FLASH_JEDEC_SPI_NICE_WAITING) || defined(__DOXYGEN__)
 #define FLASH_JEDEC_SPI_NICE_WAITING             TRUE
@@ -56,6 +64,28 @@
 #if !defined(FLASH_JEDEC_SPI_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define FLASH_JEDEC_SPI_USE_MUTUAL_EXCLUSION     TRUE
 #endif
+
+/**
+ * @brief   Size of the erased block used for padding.
+ * @details Padding and dummy page data are sent in transfers of up to
+ *          this many bytes.
+ */
+#if !defined(FLASH_JEDEC_SPI_ERASED_BLOCK_SIZE) || defined(__DOXYGEN__)
+#define FLASH_JEDEC_SPI_ERASED_BLOCK_SIZE        64
+#endif
+
+/**
+ * @brief   Enables SFDP discovery in @p fjsStart().
+ * @details The basic flash parameter table of the chip replaces geometry,
+ *          erase commands, page size, addressing, read and suspend commands
+ *          of the configuration. The configuration is used unchanged if the
+ *          chip does not provide SFDP.
+ * @note    Enabling this option keeps a copy of the configuration in the
+ *          driver structure.
+ */
+#if !defined(FLASH_JEDEC_SPI_USE_SFDP) || defined(__DOXYGEN__)
+#define FLASH_JEDEC_SPI_USE_SFDP                 FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -66,10 +96,63 @@
 #error "FLASH_JEDEC_SPI driver requires HAL_USE_SPI and SPI_USE_WAIT"
 #endif
 
+#if FLASH_JEDEC_SPI_ERASED_BLOCK_SIZE < 1
+#error "FLASH_JEDEC_SPI_ERASED_BLOCK_SIZE must be at least 1"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Operation keeping the chip busy.
+ */
+typedef enum
+{
+    FLASH_JEDEC_SPI_BUSY_NONE = 0,          /**< Not busy or unknown.       */
+    FLASH_JEDEC_SPI_BUSY_PROGRAM = 1,       /**< Page program.              */
+    FLASH_JEDEC_SPI_BUSY_ERASE = 2,         /**< Sector erase.              */
+    FLASH_JEDEC_SPI_BUSY_BLOCK_ERASE = 3,   /**< Block erase.               */
+    FLASH_JEDEC_SPI_BUSY_MASS_ERASE = 4,    /**< Mass erase.                */
+    FLASH_JEDEC_SPI_BUSY_WRITE_STATUS = 5,  /**< Status register write.     */
+} fjsbusy_t;
+
+/**
+ * @brief   Busy time statistics of a single operation type.
+ */
+typedef struct
+{
+    /**
+     * @brief Number of completed operations.
+     */
+    uint32_t calls;
+    /**
+     * @brief Number of status register polls.
+     */
+    uint32_t polls;
+    /**
+     * @brief Cumulative busy time in system ticks.
+     */
+    uint64_t time_total;
+    /**
+     * @brief Longest busy time in system ticks.
+     */
+    uint32_t time_max;
+} FlashJedecSPIBusyStats;
+
+/**
+ * @brief   FLASH JEDEC over SPI busy time statistics.
+ * @note    Operations interrupted by a suspend are not accounted.
+ */
+typedef struct
+{
+    FlashJedecSPIBusyStats program;
+    FlashJedecSPIBusyStats erase;
+    FlashJedecSPIBusyStats block_erase;
+    FlashJedecSPIBusyStats mass_erase;
+    FlashJedecSPIBusyStats write_status;
+} FlashJedecSPIStats;
+
 /**
  * @brief   Flash JEDEC over SPI driver configuration structure.
  */
@@ -83,6 +166,14 @@ typedef struct
     * @brief SPI driver configuration for multi slave buses or NULL.
     */
     const SPIConfig* spi_cfgp;
+    /**
+    * @brief SPI driver configuration for reading data or NULL.
+    * @details Applied while transferring data by @p cmd_read, allowing the
+    *          faster clock of fast read commands. Commands, programming
+    *          and status polls keep using @p spi_cfgp, which is required
+    *          then. NULL reads with @p spi_cfgp as well.
+    */
+    const SPIConfig* spi_read_cfgp;
     /**
      * @brief Smallest erasable sector size in bytes.
      */
@@ -113,6 +204,19 @@ typedef struct
      * Set to 0x00 if erase is not required.
      */
     uint8_t cmd_sector_erase;
+    /**
+     * @brief Block erase sizes in bytes, ascending.
+     * Erases use the largest aligned block fitting into the range.
+     * Set to 0 if unused.
+     */
+    uint32_t block_erase_sizes[FLASH_JEDEC_SPI_BLOCK_ERASE_NUM];
+    /**
+     * @brief Block erase commands matching @p block_erase_sizes.
+     * Commands:
+     * - 0x52 (32 KiB block erase)
+     * - 0xd8 (64 KiB block erase)
+     */
+    uint8_t cmd_block_erase[FLASH_JEDEC_SPI_BLOCK_ERASE_NUM];
     /**
      * @brief Page program command.
      * Commands:
@@ -127,6 +231,27 @@ typedef struct
      * - 0x0b (FAST READ)
      */
     uint8_t cmd_read;
+    /**
+     * @brief Erase / program suspend command.
+     * Commands:
+     * - 0x75 (Winbond, Micron, GigaDevice)
+     * - 0xb0 (Macronix)
+     * Set to 0x00 if suspend is not supported.
+     */
+    uint8_t cmd_suspend;
+    /**
+     * @brief Erase / program resume command.
+     * Commands:
+     * - 0x7a (Winbond, Micron, GigaDevice)
+     * - 0x30 (Macronix)
+     */
+    uint8_t cmd_resume;
+    /**
+     * @brief Datasheet timing reported through @p fjsGetInfo().
+     * The typical times are expected by busy waits until measured.
+     * Leave zeroed if unknown.
+     */
+    NVMDeviceTiming timing;
 } FlashJedecSPIConfig;
 
 /**
@@ -161,6 +286,36 @@ typedef struct
     * @brief Current configuration data.
     */
     const FlashJedecSPIConfig* config;
+    /**
+     * @brief Start of the erase unit started last.
+     */
+    uint32_t erase_start;
+    /**
+     * @brief Next sector of a pending erase.
+     */
+    uint32_t erase_next;
+    /**
+     * @brief End of the erase, sectors are pending while below.
+     */
+    uint32_t erase_end;
+    /**
+     * @brief Operation started last, cleared once completed.
+     */
+    fjsbusy_t busy_op;
+    /**
+     * @brief System time the operation has been started at.
+     */
+    systime_t busy_start;
+    /**
+     * @brief Busy time statistics accumulated since start or the last reset.
+     */
+    FlashJedecSPIStats stats;
+#if FLASH_JEDEC_SPI_USE_SFDP || defined(__DOXYGEN__)
+    /**
+     * @brief Configuration completed by SFDP discovery.
+     */
+    FlashJedecSPIConfig sfdp_config;
+#endif /* FLASH_JEDEC_SPI_USE_SFDP */
 #if FLASH_JEDEC_SPI_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
     /**
      * @brief mutex_t protecting the device.
@@ -201,6 +356,14 @@ extern "C" {
     bool fjsMassWriteProtect(FlashJedecSPIDriver* fjsp);
     bool fjsWriteUnprotect(FlashJedecSPIDriver* fjsp, uint32_t startaddr, uint32_t n);
     bool fjsMassWriteUnprotect(FlashJedecSPIDriver* fjsp);
+    bool fjsReadv(FlashJedecSPIDriver* fjsp, const NVMReadSegment* segp,
+            uint32_t segn);
+    bool fjsWritev(FlashJedecSPIDriver* fjsp, const NVMWriteSegment* segp,
+            uint32_t segn);
+    bool fjsIsErased(FlashJedecSPIDriver* fjsp, uint32_t startaddr,
+            uint32_t n, bool* erasedp);
+    void fjsGetStats(FlashJedecSPIDriver* fjsp, FlashJedecSPIStats* statsp);
+    void fjsResetStats(FlashJedecSPIDriver* fjsp);
 #ifdef __cplusplus
 }
 #endif
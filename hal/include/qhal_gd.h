@@ -46,6 +46,20 @@
 #define GD_COLORFORMAT_RGB666 3
 #define GD_COLORFORMAT_RGB565 4
 
+/**
+ * @name    Run length encoded image packets
+ * @details An image is a sequence of packets, each starting with a header
+ *          byte. The low bits hold the number of pixels minus one. A run
+ *          packet is followed by one color repeated for all its pixels, a
+ *          literal packet by one color per pixel. Colors are RGB565, least
+ *          significant byte first.
+ * @{
+ */
+#define GD_IMAGE_RUN            0x80    /**< Run packet flag.               */
+#define GD_IMAGE_COUNT_MASK     0x7f    /**< Pixel count minus one.         */
+#define GD_IMAGE_PACKET_MAX     128     /**< Largest pixel count.           */
+/** @} */
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -59,6 +73,13 @@
 #define GD_COLORFORMAT GD_COLORFORMAT_RGB565
 #endif /* !defined(GD_COLORFORMAT) */
 
+/**
+ * @brief   Number of pixels converted at once on the stack by blits.
+ */
+#if !defined(GD_BLIT_CHUNK_SIZE) || defined(__DOXYGEN__)
+#define GD_BLIT_CHUNK_SIZE 64
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -109,6 +130,58 @@ typedef struct
     uint8_t id[3];
 } GDDeviceInfo;
 
+/**
+ * @brief   Blit source pixel formats.
+ */
+typedef enum
+{
+    GD_BLIT_MASK1 = 0,              /**< 1 bit per pixel, MSB first.        */
+    GD_BLIT_RGB565 = 1,             /**< 16 bit RGB565 pixels.              */
+    GD_BLIT_ARGB8888 = 2,           /**< 32 bit ARGB8888 pixels.            */
+} gdblitformat_t;
+
+/**
+ * @brief   Blit source bitmap.
+ * @note    Rows of 16 and 32 bit formats must be aligned accordingly.
+ */
+typedef struct
+{
+    /**
+     * @brief Pixel format of the bitmap.
+     */
+    gdblitformat_t format;
+    /**
+     * @brief First row of the bitmap.
+     */
+    const void* data;
+    /**
+     * @brief Bytes from one row to the next.
+     */
+    size_t stride;
+    /**
+     * @brief Column of the bitmap drawn at the left border.
+     */
+    coord_t x;
+    /**
+     * @brief Color of set bits of @p GD_BLIT_MASK1 bitmaps.
+     */
+    color_t fg;
+    /**
+     * @brief Color of cleared bits of @p GD_BLIT_MASK1 bitmaps.
+     */
+    color_t bg;
+    /**
+     * @brief Skips transparent pixels instead of drawing them.
+     * @details Transparent are the cleared bits of @p GD_BLIT_MASK1 bitmaps
+     *          and the pixels matching @p key once converted otherwise.
+     */
+    bool transparent;
+    /**
+     * @brief Transparent color.
+     */
+    color_t key;
+} GDBlitSource;
+
 /**
  * @brief   @p BaseGDDevice specific methods.
  */
@@ -123,6 +196,8 @@ typedef struct
     void (*rect_fill)(void *instance, coord_t left, coord_t top,              \
             coord_t width, coord_t height, color_t color);                    \
     bool (*get_info)(void *instance, GDDeviceInfo *gddip);                    \
+    void (*blit)(void *instance, coord_t left, coord_t top,                   \
+            coord_t width, coord_t height, const GDBlitSource *srcp);         \
     /* End of mandatory functions. */                                         \
     /* Acquire device if supported by underlying driver.*/                    \
     void (*acquire)(void *instance);                                          \
@@ -263,6 +338,22 @@ typedef struct
  */
 #define gdGetInfo(ip, gddip) ((ip)->vmt->get_info(ip, gddip))
 
+/**
+ * @brief   Draws a bitmap into a rectangle.
+ * @details The bitmap is converted to @p color_t on the fly.
+ *
+ * @param[in] ip        pointer to a @p BaseGDDevice or derived class
+ * @param[in] left      left rectangle border coordinate
+ * @param[in] top       top rectangle border coordinate
+ * @param[in] width     width of the rectangle
+ * @param[in] height    height of the rectangle
+ * @param[in] srcp      pointer to the @p GDBlitSource bitmap
+ *
+ * @api
+ */
+#define gdBlit(ip, left, top, width, height, srcp) \
+    ((ip)->vmt->blit(ip, left, top, width, height, srcp))
+
 /**
  * @brief   Acquires device for exclusive access if implemented.
  *
@@ -283,4 +374,28 @@ typedef struct
 
 /** @} */
 
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void gdBlitConvert(const GDBlitSource* srcp, coord_t row, coord_t col,
+            coord_t n, color_t data[]);
+    coord_t gdBlitRun(const GDBlitSource* srcp, const color_t data[],
+            coord_t n, bool opaque);
+    void gdGenericBlit(BaseGDDevice* ip, coord_t left, coord_t top,
+            coord_t width, coord_t height, const GDBlitSource* srcp);
+    size_t gdImageEncode(const uint16_t pixels[], size_t n, uint8_t* buffer,
+            size_t size);
+    bool gdStreamImage(BaseGDDevice* ip, coord_t left, coord_t top,
+            coord_t width, coord_t height, const uint8_t* data, size_t size);
+    bool gdStreamImageNVM(BaseGDDevice* ip, coord_t left, coord_t top,
+            coord_t width, coord_t height, BaseNVMDevice* nvmp,
+            uint32_t startaddr, uint32_t size);
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* _QGPRAHICS_DISPLAY_H_ */
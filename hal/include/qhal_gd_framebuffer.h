@@ -0,0 +1,201 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qgd_framebuffer.h
+ * @brief   Graphics display RAM framebuffer header.
+ *
+ * @addtogroup GD_FRAMEBUFFER
+ * @{
+ */
+
+#ifndef _QGD_FRAMEBUFFER_H_
+#define _QGD_FRAMEBUFFER_H_
+
+#if HAL_USE_GD_FRAMEBUFFER || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    GD_FRAMEBUFFER configuration options
+ * @{
+ */
+
+/**
+ * @brief   Enables the @p gdfbAcquireBus() and @p gdfbReleaseBus() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION     TRUE
+#endif
+
+/**
+ * @brief   Number of dirty rectangles tracked between presents.
+ * @details Further rectangles are merged into the closest tracked one.
+ */
+#if !defined(GD_FRAMEBUFFER_DIRTY_RECTS) || defined(__DOXYGEN__)
+#define GD_FRAMEBUFFER_DIRTY_RECTS              8
+#endif
+
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if GD_FRAMEBUFFER_DIRTY_RECTS < 1
+#error "GD_FRAMEBUFFER_DIRTY_RECTS must be at least 1"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Rectangle, right and bottom borders excluded.
+ */
+typedef struct
+{
+    coord_t left;
+    coord_t top;
+    coord_t right;
+    coord_t bottom;
+} gdfbrect_t;
+
+/**
+ * @brief   Graphics display framebuffer configuration structure.
+ */
+typedef struct
+{
+    /**
+     * @brief Display presented to.
+     */
+    BaseGDDevice* gdp;
+    /**
+     * @brief Framebuffer of size_x * size_y colors of @p gdp, row by row.
+     * @details May be placed in any memory, e.g. external SDRAM or CCM.
+     */
+    color_t* buffer;
+} GDFramebufferConfig;
+
+/**
+ * @brief   @p GDFramebufferDriver specific methods.
+ */
+#define _gd_framebuffer_driver_methods                                        \
+    _base_gd_device_methods
+
+/**
+ * @extends BaseGDDeviceVMT
+ *
+ * @brief   @p GDFramebufferDriver virtual methods table.
+ */
+struct GDFramebufferDriverVMT
+{
+    _gd_framebuffer_driver_methods
+};
+
+/**
+ * @extends BaseGDDevice
+ *
+ * @brief   Structure representing a graphics display framebuffer driver.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct GDFramebufferDriverVMT* vmt;
+    _base_gd_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const GDFramebufferConfig* config;
+#if GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION */
+    /**
+    * @brief Device info of the underlying display.
+    */
+    GDDeviceInfo gddi;
+    /**
+    * @brief Stream window and position within it.
+    */
+    coord_t stream_left;
+    coord_t stream_top;
+    coord_t stream_width;
+    coord_t stream_height;
+    size_t stream_pos;
+    /**
+    * @brief Areas drawn since the last present.
+    */
+    gdfbrect_t dirty[GD_FRAMEBUFFER_DIRTY_RECTS];
+    /**
+    * @brief Number of valid entries of @p dirty.
+    */
+    uint8_t dirty_n;
+} GDFramebufferDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void gdfbInit(void);
+    void gdfbObjectInit(GDFramebufferDriver* gdfbp);
+    void gdfbStart(GDFramebufferDriver* gdfbp,
+            const GDFramebufferConfig* config);
+    void gdfbStop(GDFramebufferDriver* gdfbp);
+    void gdfbPixelSet(GDFramebufferDriver* gdfbp, coord_t x, coord_t y,
+            color_t color);
+    void gdfbStreamStart(GDFramebufferDriver* gdfbp, coord_t left,
+            coord_t top, coord_t width, coord_t height);
+    void gdfbStreamWrite(GDFramebufferDriver* gdfbp, const color_t data[],
+            size_t n);
+    void gdfbStreamColor(GDFramebufferDriver* gdfbp, const color_t color,
+            uint16_t n);
+    void gdfbStreamEnd(GDFramebufferDriver* gdfbp);
+    void gdfbRectFill(GDFramebufferDriver* gdfbp, coord_t left, coord_t top,
+            coord_t width, coord_t height, color_t color);
+    bool gdfbGetInfo(GDFramebufferDriver* gdfbp, GDDeviceInfo* gddip);
+    void gdfbBlit(GDFramebufferDriver* gdfbp, coord_t left, coord_t top,
+            coord_t width, coord_t height, const GDBlitSource* srcp);
+    void gdfbAcquireBus(GDFramebufferDriver* gdfbp);
+    void gdfbReleaseBus(GDFramebufferDriver* gdfbp);
+    void gdfbPresent(GDFramebufferDriver* gdfbp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_GD_FRAMEBUFFER */
+
+#endif /* _QGD_FRAMEBUFFER_H_ */
+
+/** @} */
@@ -124,6 +124,11 @@
 #define GD_ILI9341_SET_PUMP_RATIO_CTL      0xF7    /**< Set pump ratio control.*/
 /** @} */
 
+/**
+ * @brief   Frame memory lines covered by the vertical scrolling definition.
+ */
+#define GD_ILI9341_SCROLL_LINES            320
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -141,6 +146,16 @@
 #define GD_ILI9341_USE_MUTUAL_EXCLUSION         FALSE
 #endif
 
+/**
+ * @brief   Enables asynchronous streaming through two pixel buffers.
+ * @details Stream writes are copied into the free buffer and sent by the
+ *          @p start_mem_cb callback while the application renders the
+ *          next chunk.
+ */
+#if !defined(GD_ILI9341_USE_ASYNC) || defined(__DOXYGEN__)
+#define GD_ILI9341_USE_ASYNC                    FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -182,6 +197,22 @@ typedef struct
      * @brief Configuration callback
      */
     void (*config_cb)(BaseGDDevice* gdp);
+#if GD_ILI9341_USE_ASYNC || defined(__DOXYGEN__)
+    /**
+     * @brief Starts sending pixel data and returns at once.
+     * @details The end of the transfer is reported by calling
+     *          @p gdili9341TransferCompleteI().
+     */
+    void (*start_mem_cb)(const color_t data[], size_t n);
+    /**
+     * @brief Pixel buffers alternately rendered into and sent.
+     */
+    color_t* buffer[2];
+    /**
+     * @brief Size of each pixel buffer in pixels.
+     */
+    size_t buffer_size;
+#endif /* GD_ILI9341_USE_ASYNC */
 } GDILI9341Config;
 
 /**
@@ -226,6 +257,20 @@ typedef struct
     * @brief Cached device info
     */
     GDDeviceInfo gddi;
+#if GD_ILI9341_USE_ASYNC || defined(__DOXYGEN__)
+    /**
+     * @brief Index of the buffer to render into.
+     */
+    uint8_t buffer_index;
+    /**
+     * @brief A transfer is in progress.
+     */
+    volatile bool busy;
+    /**
+     * @brief Thread waiting for the transfer to end.
+     */
+    thread_reference_t thread;
+#endif /* GD_ILI9341_USE_ASYNC */
 } GDILI9341Driver;
 
 /*===========================================================================*/
@@ -256,6 +301,11 @@ extern "C" {
     void gdili9341RectFill(GDILI9341Driver* gdili9341p, coord_t left, coord_t top,
             coord_t width, coord_t height, color_t color);
     bool gdili9341GetInfo(GDILI9341Driver* gdili9341p, GDDeviceInfo* gddip);
+    void gdili9341Blit(GDILI9341Driver* gdili9341p, coord_t left, coord_t top,
+            coord_t width, coord_t height, const GDBlitSource* srcp);
+    void gdili9341ScrollDefine(GDILI9341Driver* gdili9341p, coord_t top_fixed,
+            coord_t scroll_height, coord_t bottom_fixed);
+    void gdili9341ScrollSet(GDILI9341Driver* gdili9341p, coord_t start);
     void gdili9341AcquireBus(GDILI9341Driver* gdili9341p);
     void gdili9341ReleaseBus(GDILI9341Driver* gdili9341p);
     void gdili9341Select(GDILI9341Driver* gdili9341p);
@@ -263,6 +313,11 @@ extern "C" {
     void gdili9341WriteCommand(GDILI9341Driver* gdili9341p, uint8_t cmd);
     void gdili9341WriteByte(GDILI9341Driver* gdili9341p, uint8_t value);
     uint8_t gdili9341ReadByte(GDILI9341Driver* gdili9341p);
+#if GD_ILI9341_USE_ASYNC || defined(__DOXYGEN__)
+    color_t* gdili9341StreamBuffer(GDILI9341Driver* gdili9341p, size_t* np);
+    void gdili9341StreamSubmit(GDILI9341Driver* gdili9341p, size_t n);
+    void gdili9341TransferCompleteI(GDILI9341Driver* gdili9341p);
+#endif /* GD_ILI9341_USE_ASYNC */
 #ifdef __cplusplus
 }
 #endif
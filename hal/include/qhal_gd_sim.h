@@ -84,6 +84,11 @@ extern "C" {
     void gdsimRectFill(GDSimDriver* gdsimp, coord_t left, coord_t top,
             coord_t width, coord_t height, color_t color);
     bool gdsimGetInfo(GDSimDriver* gdsimp, GDDeviceInfo* gddip);
+    void gdsimBlit(GDSimDriver* gdsimp, coord_t left, coord_t top,
+            coord_t width, coord_t height, const GDBlitSource* srcp);
+    void gdsimScrollDefine(GDSimDriver* gdsimp, coord_t top_fixed,
+            coord_t scroll_height, coord_t bottom_fixed);
+    void gdsimScrollSet(GDSimDriver* gdsimp, coord_t start);
     void gdsimAcquireBus(GDSimDriver* gdsimp);
     void gdsimReleaseBus(GDSimDriver* gdsimp);
 #ifdef __cplusplus
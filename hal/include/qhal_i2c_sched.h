@@ -0,0 +1,223 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qi2c_sched.h
+ * @brief   I2C bus transaction scheduler header.
+ *
+ * @addtogroup I2C_SCHED
+ * @{
+ */
+
+#ifndef _QI2C_SCHED_H_
+#define _QI2C_SCHED_H_
+
+#if HAL_USE_I2C_SCHED || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    I2C_SCHED configuration options
+ * @{
+ */
+
+/**
+ * @brief   Worker thread stack size.
+ */
+#if !defined(I2C_SCHED_THREAD_STACK_SIZE) || defined(__DOXYGEN__)
+#define I2C_SCHED_THREAD_STACK_SIZE         512
+#endif
+
+/**
+ * @brief   Worker thread priority.
+ */
+#if !defined(I2C_SCHED_THREAD_PRIO) || defined(__DOXYGEN__)
+#define I2C_SCHED_THREAD_PRIO               NORMALPRIO
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !HAL_USE_I2C
+#error "I2C_SCHED driver requires HAL_USE_I2C"
+#endif
+
+#if !defined(_CHIBIOS_RT_)
+#error "I2C_SCHED requires ChibiOS/RT"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Driver state machine possible states.
+ */
+typedef enum
+{
+    I2C_SCHED_UNINIT = 0,           /**< Not initialized.                   */
+    I2C_SCHED_STOP = 1,             /**< Stopped.                           */
+    I2C_SCHED_READY = 2,            /**< Ready.                             */
+} i2cschedstate_t;
+
+/**
+ * @brief   Type of a bus transaction.
+ */
+typedef struct I2CTransaction I2CTransaction;
+
+/**
+ * @brief   Transaction completion callback type.
+ * @note    Invoked from a locked context in the worker thread, further
+ *          transactions may be submitted with @p i2cschedSubmitI().
+ */
+typedef void (*i2ctransactioncb_t)(I2CTransaction* tp);
+
+/**
+ * @brief   Structure representing a bus transaction.
+ */
+struct I2CTransaction
+{
+    /** @brief Slave address, 7 bits right aligned.*/
+    i2caddr_t addr;
+    /** @brief Bytes to transmit or @p NULL.*/
+    const uint8_t* txbuf;
+    /** @brief Number of bytes to transmit.*/
+    size_t txbytes;
+    /** @brief Buffer for received bytes or @p NULL.*/
+    uint8_t* rxbuf;
+    /** @brief Number of bytes to receive.*/
+    size_t rxbytes;
+    /** @brief Bus timeout of the transfer.*/
+    sysinterval_t timeout;
+    /** @brief Completion callback or @p NULL.*/
+    i2ctransactioncb_t callback;
+    /** @brief Callback argument.*/
+    void* arg;
+    /** @brief Scheduling priority, higher first.*/
+    uint8_t priority;
+    /** @brief Deadline is valid.*/
+    bool has_deadline;
+    /** @brief Time the transfer should have started by.*/
+    systime_t deadline;
+    /** @brief Next transaction in the queue of the scheduler.*/
+    I2CTransaction* next;
+    /** @brief Thread waiting for completion or @p NULL.*/
+    thread_reference_t thread;
+    /** @brief Transfer result once completed.*/
+    msg_t result;
+    /** @brief Transaction completed.*/
+    volatile bool done;
+};
+
+/**
+ * @brief   I2C bus scheduler configuration structure.
+ */
+typedef struct
+{
+    /**
+     * @brief Bus served, already started.
+     */
+    I2CDriver* i2cp;
+} I2CSchedConfig;
+
+/**
+ * @brief   Structure representing an I2C bus scheduler.
+ * @details Runs the submitted transactions of all devices of a bus from one
+ *          worker thread, back to back, highest priority first and earliest
+ *          deadline first within a priority.
+ */
+typedef struct
+{
+    /**
+    * @brief Driver state.
+    */
+    i2cschedstate_t state;
+    /**
+    * @brief Current configuration data.
+    */
+    const I2CSchedConfig* config;
+    /**
+    * @brief Pointer to the worker thread.
+    */
+    thread_reference_t tr;
+    /**
+    * @brief Worker thread while waiting for transactions or @p NULL.
+    */
+    thread_reference_t wait;
+    /**
+    * @brief Pending transactions in scheduling order.
+    */
+    I2CTransaction* queue;
+    /**
+    * @brief Transactions started after their deadline.
+    */
+    uint32_t missed;
+    /**
+    * @brief Working area for the worker thread.
+    */
+    THD_WORKING_AREA(wa, I2C_SCHED_THREAD_STACK_SIZE);
+} I2CSchedDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Checks whether a transaction completed.
+ *
+ * @param[in] tp        pointer to a @p I2CTransaction
+ *
+ * @api
+ */
+#define i2cTransactionIsDone(tp) ((tp)->done)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void i2cschedInit(void);
+    void i2cschedObjectInit(I2CSchedDriver* i2cschedp);
+    void i2cschedStart(I2CSchedDriver* i2cschedp, const I2CSchedConfig* config);
+    void i2cschedStop(I2CSchedDriver* i2cschedp);
+    void i2cschedSubmit(I2CSchedDriver* i2cschedp, I2CTransaction* tp,
+            uint8_t priority, sysinterval_t deadline);
+    void i2cschedSubmitI(I2CSchedDriver* i2cschedp, I2CTransaction* tp,
+            uint8_t priority, sysinterval_t deadline);
+    msg_t i2cschedTransfer(I2CSchedDriver* i2cschedp, I2CTransaction* tp,
+            uint8_t priority, sysinterval_t deadline);
+    void i2cTransactionInit(I2CTransaction* tp, i2caddr_t addr,
+            const uint8_t* txbuf, size_t txbytes, uint8_t* rxbuf,
+            size_t rxbytes, sysinterval_t timeout,
+            i2ctransactioncb_t callback, void* arg);
+    msg_t i2cTransactionWait(I2CTransaction* tp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_I2C_SCHED */
+
+#endif /* _QI2C_SCHED_H_ */
+
+/** @} */
@@ -26,6 +26,9 @@
  *          abstract C++ classes (even if written in C). This system
  *          has then advantage to make the access to nvm devices
  *          independent from the implementation logic.
+ *          The only code is the generic fallback for vectored operations
+ *          of drivers not implementing them natively and the handling of
+ *          asynchronous requests.
  * @{
  */
 
@@ -45,6 +48,23 @@ typedef enum
     NVM_ERASING = 5,                /**< Erase operation in progress.       */
 } nvmstate_t;
 
+/**
+ * @brief   Number of erase block sizes reported in @p NVMDeviceInfo.
+ */
+#define NVM_ERASE_SIZES_NUM 3
+
+/**
+ * @brief   Non volatile memory device timing hints in microseconds.
+ * @note    A value of 0 means unknown.
+ */
+typedef struct
+{
+    uint32_t      program_typ;        /**< @brief Typical page program time.  */
+    uint32_t      program_max;        /**< @brief Maximum page program time.  */
+    uint32_t      erase_typ;          /**< @brief Typical sector erase time.  */
+    uint32_t      erase_max;          /**< @brief Maximum sector erase time.  */
+} NVMDeviceTiming;
+
 /**
  * @brief   Non volatile memory device info.
  */
@@ -54,8 +74,69 @@ typedef struct
     uint32_t      sector_num;         /**< @brief Total number of sectors.    */
     uint8_t       identification[3];  /**< @brief Jedec device identification.*/
     uint8_t       write_alignment;    /**< @brief Alignment for writes.       */
+    uint32_t      page_size;          /**< @brief Program page size, 0 if none.*/
+    uint32_t      erase_sizes[NVM_ERASE_SIZES_NUM];
+                                      /**< @brief Erase sizes, ascending.     */
+    NVMDeviceTiming timing;           /**< @brief Timing hints.               */
+    bool          memory_mapped;      /**< @brief Reads are memory mapped.    */
 } NVMDeviceInfo;
 
+/**
+ * @brief   Segment of a vectored read.
+ */
+typedef struct
+{
+    uint32_t      startaddr;          /**< @brief First address to read.      */
+    uint32_t      n;                  /**< @brief Number of bytes to read.    */
+    uint8_t*      buffer;             /**< @brief Pointer to the read buffer. */
+} NVMReadSegment;
+
+/**
+ * @brief   Segment of a vectored write.
+ */
+typedef struct
+{
+    uint32_t      startaddr;          /**< @brief First address to write.     */
+    uint32_t      n;                  /**< @brief Number of bytes to write.   */
+    const uint8_t* buffer;            /**< @brief Pointer to the write buffer.*/
+} NVMWriteSegment;
+
+/**
+ * @brief   Number of segments layered drivers translate per lower level
+ *          vectored call.
+ */
+#if !defined(NVM_SEGMENT_BATCH_SIZE) || defined(__DOXYGEN__)
+#define NVM_SEGMENT_BATCH_SIZE 8
+#endif
+
+/**
+ * @brief   Stack buffer size used by the generic blank check.
+ */
+#if !defined(NVM_BLANK_CHECK_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_BLANK_CHECK_BUFFER_SIZE 32
+#endif
+
+/**
+ * @brief   Asynchronous request operations.
+ */
+typedef enum
+{
+    NVM_REQUEST_READ = 0,           /**< Read bytes.                        */
+    NVM_REQUEST_WRITE = 1,          /**< Write bytes.                       */
+    NVM_REQUEST_ERASE = 2,          /**< Erase sectors.                     */
+} nvmrequestop_t;
+
+/**
+ * @brief   Type of an asynchronous request.
+ */
+typedef struct NVMRequest NVMRequest;
+
+/**
+ * @brief   Request completion callback type.
+ * @note    Invoked from a locked context, either ISR or thread.
+ */
+typedef void (*nvmrequestcb_t)(NVMRequest* reqp);
+
 /**
  * @brief   @p BaseNVMDevice specific methods.
  */
@@ -90,7 +171,25 @@ typedef struct
     bool (*writeunprotect)(void *instance, uint32_t startaddr,                \
             uint32_t n);                                                      \
     /* Write unprotect whole device. */                                       \
-    bool (*mass_writeunprotect)(void *instance);
+    bool (*mass_writeunprotect)(void *instance);                              \
+    /* Reads multiple segments, NULL uses the generic fallback. */            \
+    bool (*readv)(void *instance, const NVMReadSegment *segp,                 \
+            uint32_t segn);                                                   \
+    /* Writes multiple segments, NULL uses the generic fallback. */           \
+    bool (*writev)(void *instance, const NVMWriteSegment *segp,               \
+            uint32_t segn);                                                   \
+    /* Starts an asynchronous request, NULL if not supported natively. */     \
+    bool (*start_request)(void *instance, NVMRequest *reqp);                  \
+    /* Checks whether a range is erased, NULL uses the generic fallback. */   \
+    bool (*is_erased)(void *instance, uint32_t startaddr,                     \
+            uint32_t n, bool *erasedp);                                       \
+    /* Maps a range for direct reads, NULL if not memory mapped. */           \
+    bool (*map)(void *instance, uint32_t startaddr, uint32_t n,               \
+            const uint8_t **ptrp);                                            \
+    /* Acquire device for reading, NULL falls back to acquire. */             \
+    void (*acquire_shared)(void *instance);                                   \
+    /* Release device acquired for reading, NULL falls back to release. */    \
+    void (*release_shared)(void *instance);
 
 /**
  * @brief   @p BaseNVMDevice specific data.
@@ -118,6 +217,42 @@ typedef struct
     _base_nvm_device_data
 } BaseNVMDevice;
 
+/**
+ * @brief   Asynchronous request.
+ * @details Describes a read, write or erase operation served in the
+ *          background. The structure must stay valid until the request
+ *          completed.
+ */
+struct NVMRequest
+{
+    /** @brief Operation to perform.*/
+    nvmrequestop_t op;
+    /** @brief First address of the operation.*/
+    uint32_t startaddr;
+    /** @brief Number of bytes of the operation.*/
+    uint32_t n;
+    /** @brief Data buffer, unused for erases.*/
+    union
+    {
+        uint8_t* read;
+        const uint8_t* write;
+    } buffer;
+    /** @brief Completion callback or @p NULL.*/
+    nvmrequestcb_t callback;
+    /** @brief Callback argument.*/
+    void* arg;
+    /** @brief Device serving the request.*/
+    BaseNVMDevice* nvmp;
+    /** @brief Next request in the queue of the serving driver.*/
+    NVMRequest* next;
+    /** @brief Thread waiting for completion or @p NULL.*/
+    thread_reference_t thread;
+    /** @brief Operation result once completed.*/
+    bool result;
+    /** @brief Request completed.*/
+    volatile bool done;
+};
+
 /**
  * @name    Macro Functions (BaseNVMDevice)
  * @{
@@ -259,6 +394,31 @@ typedef struct
  */
 #define nvmRelease(ip) ((ip)->vmt->release)(ip)
 
+/**
+ * @brief   Acquires device for shared read access if implemented.
+ * @details Devices without readers-writer locking are acquired for
+ *          exclusive access. Only reads and other non modifying calls are
+ *          allowed until @p nvmReleaseShared().
+ *
+ * @param[in] ip        pointer to a @p BaseNVMDevice or derived class
+ *
+ * @api
+ */
+#define nvmAcquireShared(ip)                                                  \
+    (((ip)->vmt->acquire_shared != NULL) ?                                    \
+            (ip)->vmt->acquire_shared(ip) : (ip)->vmt->acquire(ip))
+
+/**
+ * @brief   Releases shared read access from device if implemented.
+ *
+ * @param[in] ip        pointer to a @p BaseNVMDevice or derived class
+ *
+ * @api
+ */
+#define nvmReleaseShared(ip)                                                  \
+    (((ip)->vmt->release_shared != NULL) ?                                    \
+            (ip)->vmt->release_shared(ip) : (ip)->vmt->release(ip))
+
 /**
  * @brief   Write protects one or more sectors if implemented.
  *
@@ -319,8 +479,211 @@ typedef struct
 #define nvmMassWriteUnprotect(ip)                                             \
         ((ip)->vmt->mass_writeunprotect)(ip)
 
+/**
+ * @brief   Reads multiple segments in order.
+ * @details Drivers not implementing vectored reads are served by
+ *          individual reads.
+ *
+ * @param[in] ip        pointer to a @p BaseNVMDevice or derived class
+ * @param[in] segp      pointer to an array of @p NVMReadSegment
+ * @param[in] segn      number of segments
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define nvmReadv(ip, segp, segn)                                              \
+    (((ip)->vmt->readv != NULL) ?                                             \
+            (ip)->vmt->readv(ip, segp, segn) :                                \
+            nvmGenericReadv((BaseNVMDevice*)(ip), segp, segn))
+
+/**
+ * @brief   Writes multiple segments in order.
+ * @details Drivers not implementing vectored writes are served by
+ *          individual writes.
+ *
+ * @param[in] ip        pointer to a @p BaseNVMDevice or derived class
+ * @param[in] segp      pointer to an array of @p NVMWriteSegment
+ * @param[in] segn      number of segments
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define nvmWritev(ip, segp, segn)                                             \
+    (((ip)->vmt->writev != NULL) ?                                            \
+            (ip)->vmt->writev(ip, segp, segn) :                               \
+            nvmGenericWritev((BaseNVMDevice*)(ip), segp, segn))
+
+/**
+ * @brief   Starts an asynchronous request.
+ * @details Only available for drivers serving requests natively, other
+ *          drivers can be served by an @p NVMAsyncDriver.
+ *
+ * @param[in] ip        pointer to a @p BaseNVMDevice or derived class
+ * @param[in] reqp      pointer to an initialized @p NVMRequest
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  request started, completion is signaled.
+ * @retval HAL_FAILED   request not supported or not started.
+ *
+ * @api
+ */
+#define nvmStartRequest(ip, reqp)                                             \
+    (((ip)->vmt->start_request != NULL) ?                                     \
+            (ip)->vmt->start_request(ip, reqp) : HAL_FAILED)
+
+/**
+ * @brief   Checks whether a range is in erased state.
+ * @details Drivers not implementing a native blank check are served by
+ *          reading the range and comparing it against the erased value.
+ *          Callers can use it to skip erasing sectors which are already
+ *          blank.
+ *
+ * @param[in] ip        pointer to a @p BaseNVMDevice or derived class
+ * @param[in] startaddr first address to check
+ * @param[in] n         number of bytes to check
+ * @param[out] erasedp  set to @p true if all bytes are erased
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define nvmIsErased(ip, startaddr, n, erasedp)                                \
+    (((ip)->vmt->is_erased != NULL) ?                                         \
+            (ip)->vmt->is_erased(ip, startaddr, n, erasedp) :                 \
+            nvmGenericIsErased((BaseNVMDevice*)(ip), startaddr, n, erasedp))
+
+/**
+ * @brief   Maps a range for direct reads.
+ * @details Memory mapped drivers return a pointer to the data in place so
+ *          callers can use it without copying. All others fail, callers
+ *          are expected to fall back to @p nvmRead() then.
+ * @note    The pointer is valid until the range is written or erased.
+ *
+ * @param[in] ip        pointer to a @p BaseNVMDevice or derived class
+ * @param[in] startaddr first address to map
+ * @param[in] n         number of bytes to map
+ * @param[out] ptrp     receives the address of @p startaddr
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   range can not be mapped.
+ *
+ * @api
+ */
+#define nvmMap(ip, startaddr, n, ptrp)                                        \
+    (((ip)->vmt->map != NULL) ?                                               \
+            (ip)->vmt->map(ip, startaddr, n, ptrp) : HAL_FAILED)
+
+/**
+ * @brief   Determines if a request completed.
+ * @note    Can be called in ISR context.
+ *
+ * @param[in] reqp      pointer to a @p NVMRequest
+ *
+ * @special
+ */
+#define nvmRequestIsDone(reqp) ((reqp)->done)
+
+/**
+ * @brief   Binds lower layer calls through the virtual methods table.
+ * @details Default of the @p *_LLD options of the layered drivers.
+ */
+#define NVM_LLD_DYNAMIC nvmVmt
+
+/* Methods table dispatch, usable with a pointer of any driver type. */
+#define nvmVmtRead(ip, startaddr, n, buffer)                                  \
+    (((BaseNVMDevice*)(ip))->vmt->read(ip, startaddr, n, buffer))
+#define nvmVmtWrite(ip, startaddr, n, buffer)                                 \
+    (((BaseNVMDevice*)(ip))->vmt->write(ip, startaddr, n, buffer))
+#define nvmVmtErase(ip, startaddr, n)                                         \
+    (((BaseNVMDevice*)(ip))->vmt->erase(ip, startaddr, n))
+#define nvmVmtSync(ip)                                                        \
+    (((BaseNVMDevice*)(ip))->vmt->sync(ip))
+
+#define _nvm_lld_method(lld, method) _nvm_lld_method_(lld, method)
+#define _nvm_lld_method_(lld, method) lld##method
+
+/**
+ * @brief   Reads from a lower layer bound at compile time.
+ * @details @p lld is the function prefix of the lower driver, e.g.
+ *          @p flash or @p nvmpart, the call then goes directly to its
+ *          read function and can be inlined with link time optimization.
+ *          @p NVM_LLD_DYNAMIC dispatches like @p nvmRead().
+ *
+ * @param[in] lld       function prefix of the lower driver
+ * @param[in] ip        pointer to the lower driver
+ * @param[in] startaddr first address to read
+ * @param[in] n         number of bytes to read
+ * @param[out] buffer   pointer to the read buffer
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define nvmLldRead(lld, ip, startaddr, n, buffer)                             \
+    _nvm_lld_method(lld, Read)((void*)(ip), startaddr, n, buffer)
+
+/**
+ * @brief   Writes to a lower layer bound at compile time.
+ * @details See @p nvmLldRead().
+ *
+ * @api
+ */
+#define nvmLldWrite(lld, ip, startaddr, n, buffer)                            \
+    _nvm_lld_method(lld, Write)((void*)(ip), startaddr, n, buffer)
+
+/**
+ * @brief   Erases on a lower layer bound at compile time.
+ * @details See @p nvmLldRead().
+ *
+ * @api
+ */
+#define nvmLldErase(lld, ip, startaddr, n)                                    \
+    _nvm_lld_method(lld, Erase)((void*)(ip), startaddr, n)
+
+/**
+ * @brief   Synchronizes a lower layer bound at compile time.
+ * @details See @p nvmLldRead().
+ *
+ * @api
+ */
+#define nvmLldSync(lld, ip)                                                   \
+    _nvm_lld_method(lld, Sync)((void*)(ip))
+
 /** @} */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+    bool nvmGenericReadv(BaseNVMDevice* nvmp, const NVMReadSegment* segp,
+            uint32_t segn);
+    bool nvmGenericWritev(BaseNVMDevice* nvmp, const NVMWriteSegment* segp,
+            uint32_t segn);
+    bool nvmGenericIsErased(BaseNVMDevice* nvmp, uint32_t startaddr,
+            uint32_t n, bool* erasedp);
+    void nvmRequestReadInit(NVMRequest* reqp, uint32_t startaddr, uint32_t n,
+            uint8_t* buffer, nvmrequestcb_t callback, void* arg);
+    void nvmRequestWriteInit(NVMRequest* reqp, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer, nvmrequestcb_t callback,
+            void* arg);
+    void nvmRequestEraseInit(NVMRequest* reqp, uint32_t startaddr,
+            uint32_t n, nvmrequestcb_t callback, void* arg);
+    void nvmRequestCompleteI(NVMRequest* reqp, bool result);
+    bool nvmRequestWait(NVMRequest* reqp);
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* _QIO_NVM_H_ */
 
 /** @} */
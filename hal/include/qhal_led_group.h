@@ -0,0 +1,201 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qled_group.h
+ * @brief   Driver for groups of LEDs sharing one pattern timer.
+ *
+ * @addtogroup LED_GROUP
+ * @{
+ */
+
+#ifndef _QLED_GROUP_H_
+#define _QLED_GROUP_H_
+
+#if HAL_USE_LED_GROUP || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    LED_GROUP configuration options
+ * @{
+ */
+
+/**
+ * @brief   Number of software PWM brightness levels.
+ * @details Brightness ranges from 0 (off) to this value (fully on). Values
+ *          above 1 modulate the LEDs over this many engine ticks, so the
+ *          tick interval has to be short enough to avoid visible flicker.
+ */
+#if !defined(LED_GROUP_PWM_LEVELS) || defined(__DOXYGEN__)
+#define LED_GROUP_PWM_LEVELS                1
+#endif
+
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !HAL_USE_LED
+#error "LED_GROUP driver requires HAL_USE_LED"
+#endif
+
+#if (LED_GROUP_PWM_LEVELS < 1) || (LED_GROUP_PWM_LEVELS > 255)
+#error "LED_GROUP_PWM_LEVELS must be within 1 and 255"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief Driver state machine possible states.
+ */
+typedef enum
+{
+    LED_GROUP_UNINIT = 0,           /**< Not initialized.                    */
+    LED_GROUP_STOP = 1,             /**< Stopped.                            */
+    LED_GROUP_READY = 2             /**< Ready.                              */
+} ledgroupstate_t;
+
+/**
+ * @brief   Single step of a LED pattern.
+ */
+typedef struct
+{
+    /**
+     * @brief Brightness, 0 to @p LED_GROUP_PWM_LEVELS.
+     */
+    uint8_t level;
+    /**
+     * @brief Duration in engine ticks, at least 1.
+     */
+    uint16_t ticks;
+} ledstep_t;
+
+/**
+ * @brief   LED pattern, a sequence of steps played in a loop.
+ */
+typedef struct
+{
+    /**
+     * @brief Steps of the pattern.
+     */
+    const ledstep_t* steps;
+    /**
+     * @brief Number of entries of @p steps.
+     */
+    uint8_t n;
+    /**
+     * @brief Number of pattern loops or <= 0 for infinite loop.
+     * @details The LED is switched off after the last loop.
+     */
+    int32_t loop;
+} LedPattern;
+
+/**
+ * @brief   Runtime state of a LED of a group.
+ */
+typedef struct
+{
+    /* Pattern played or NULL for a constant level */
+    const LedPattern* pattern;
+    /* Loops left, negative for infinite loop */
+    int32_t loop;
+    /* Ticks left of the current step */
+    uint16_t remaining;
+    /* Index of the current step */
+    uint8_t step;
+    /* Current brightness */
+    uint8_t level;
+    /* Pin currently energized */
+    bool lit;
+} ledchannel_t;
+
+/**
+ * @brief   LED group configuration structure.
+ */
+typedef struct
+{
+    /**
+     * @brief LEDs of the group.
+     */
+    const LedConfig* leds;
+    /**
+     * @brief Runtime state, one entry per LED.
+     */
+    ledchannel_t* channels;
+    /**
+     * @brief Number of LEDs of the group.
+     */
+    uint16_t n;
+    /**
+     * @brief Engine tick interval.
+     * @details With @p TIME_IMMEDIATE the driver arms no timer and the
+     *          application calls @p ledgroupTickI() periodically, e.g. from
+     *          a hardware timer callback.
+     */
+    sysinterval_t interval;
+} LedGroupConfig;
+
+/**
+ * @brief   Structure representing a LED group driver.
+ */
+typedef struct
+{
+    /* Driver state */
+    ledgroupstate_t state;
+    /* Current configuration data */
+    const LedGroupConfig* config;
+    /* Engine timer, shared by all LEDs of the group */
+    virtual_timer_t vt;
+    /* Software PWM phase */
+    uint8_t phase;
+} LedGroupDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void ledgroupInit(void);
+    void ledgroupObjectInit(LedGroupDriver* lgp);
+    void ledgroupStart(LedGroupDriver* lgp, const LedGroupConfig* config);
+    void ledgroupStop(LedGroupDriver* lgp);
+    void ledgroupSet(LedGroupDriver* lgp, uint16_t index, uint8_t level);
+    void ledgroupSetI(LedGroupDriver* lgp, uint16_t index, uint8_t level);
+    void ledgroupPattern(LedGroupDriver* lgp, uint16_t index,
+            const LedPattern* pattern);
+    void ledgroupPatternI(LedGroupDriver* lgp, uint16_t index,
+            const LedPattern* pattern);
+    void ledgroupTickI(LedGroupDriver* lgp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_LED_GROUP */
+
+#endif /* _QLED_GROUP_H_ */
+
+/** @} */
@@ -29,6 +29,11 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Event flag broadcast by the sequencer for each new sample.
+ */
+#define MS58XX_EVENT_SAMPLE             ((eventflags_t)1)
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -45,6 +50,36 @@
 #if !defined(MS58XX_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define MS58XX_USE_MUTUAL_EXCLUSION     FALSE
 #endif
+
+/**
+ * @brief   Enables the driver owned measurement sequencer.
+ * @details A worker thread alternates pressure and temperature conversions
+ *          and publishes compensated samples, see @p ms58xxSequencerStart().
+ */
+#if !defined(MS58XX_USE_SEQUENCER) || defined(__DOXYGEN__)
+#define MS58XX_USE_SEQUENCER            FALSE
+#endif
+
+/**
+ * @brief   Sequencer thread stack size.
+ */
+#if !defined(MS58XX_SEQUENCER_STACK_SIZE) || defined(__DOXYGEN__)
+#define MS58XX_SEQUENCER_STACK_SIZE     512
+#endif
+
+/**
+ * @brief   Sequencer thread priority.
+ */
+#if !defined(MS58XX_SEQUENCER_PRIO) || defined(__DOXYGEN__)
+#define MS58XX_SEQUENCER_PRIO           NORMALPRIO
+#endif
+
+/**
+ * @brief   Number of sequencer samples kept for @p ms58xxSamplesRead().
+ */
+#if !defined(MS58XX_SEQUENCER_RING_SIZE) || defined(__DOXYGEN__)
+#define MS58XX_SEQUENCER_RING_SIZE      16
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -55,6 +90,18 @@
 #error "MS58XX driver requires HAL_USE_I2C"
 #endif
 
+#if MS58XX_USE_SEQUENCER && !defined(_CHIBIOS_RT_)
+#error "MS58XX_USE_SEQUENCER requires ChibiOS/RT"
+#endif
+
+#if MS58XX_USE_SEQUENCER && !CH_CFG_USE_EVENTS
+#error "MS58XX_USE_SEQUENCER requires CH_CFG_USE_EVENTS"
+#endif
+
+#if MS58XX_SEQUENCER_RING_SIZE < 1
+#error "MS58XX_SEQUENCER_RING_SIZE must be at least 1"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -92,6 +139,29 @@ typedef enum
     MS58XX_ACTIVE = 4,              /**< Device converting.                 */
 } ms58xxstate_t;
 
+/**
+ * @brief   Compensated measurement published by the sequencer.
+ */
+typedef struct
+{
+    /**
+     * @brief Temperature in degree C * 100.
+     */
+    int32_t temperature;
+    /**
+     * @brief Pressure in bar * 10000.
+     */
+    int32_t pressure;
+    /**
+     * @brief Number of the sample, starting at 1.
+     */
+    uint32_t sequence;
+    /**
+     * @brief System time of the last conversion of the sample.
+     */
+    systime_t timestamp;
+} ms58xxsample_t;
+
 /**
  * @brief   Type of a structure representing an I2C driver.
  */
@@ -141,6 +211,60 @@ struct MS58XXDriver
     */
     uint32_t last_d1;
     uint32_t last_d2;
+#if MS58XX_USE_SEQUENCER || defined(__DOXYGEN__)
+    /**
+    * @brief Pointer to the sequencer thread.
+    */
+    thread_reference_t tr;
+    /**
+    * @brief Sequencer thread while waiting or @p NULL.
+    */
+    thread_reference_t wait;
+    /**
+    * @brief Thread waiting for the sequencer to stop or @p NULL.
+    */
+    thread_reference_t stopper;
+    /**
+    * @brief Conversion timer.
+    */
+    virtual_timer_t vt;
+    /**
+    * @brief Sequencer running.
+    */
+    bool running;
+    /**
+    * @brief Oversampling of the sequenced conversions.
+    */
+    enum ms58xx_osr_e osr;
+    /**
+    * @brief Pressure conversions per temperature conversion.
+    */
+    uint16_t temperature_divider;
+    /**
+    * @brief Pressure conversions averaged per sample.
+    */
+    uint16_t decimation;
+    /**
+    * @brief Last published samples, sample n at (n - 1) % size.
+    */
+    ms58xxsample_t ring[MS58XX_SEQUENCER_RING_SIZE];
+    /**
+    * @brief Number of the last published sample.
+    */
+    uint32_t ring_head;
+    /**
+    * @brief Number of failed sequencer transfers.
+    */
+    uint32_t errors;
+    /**
+    * @brief Event source broadcasting @p MS58XX_EVENT_SAMPLE.
+    */
+    event_source_t event;
+    /**
+    * @brief Working area for the sequencer thread.
+    */
+    THD_WORKING_AREA(wa, MS58XX_SEQUENCER_STACK_SIZE);
+#endif /* MS58XX_USE_SEQUENCER */
 };
 
 /*===========================================================================*/
@@ -166,6 +290,17 @@ extern "C" {
     bool ms58xxTemperatureResult(MS58XXDriver* ms58xxp, float *resultp);
     bool ms58xxPressureStart(MS58XXDriver* ms58xxp, enum ms58xx_osr_e osr);
     bool ms58xxPressureResult(MS58XXDriver* ms58xxp, float *resultp);
+    bool ms58xxTemperatureResultInt(MS58XXDriver* ms58xxp, int32_t *resultp);
+    bool ms58xxPressureResultInt(MS58XXDriver* ms58xxp, int32_t *resultp);
+#if MS58XX_USE_SEQUENCER || defined(__DOXYGEN__)
+    void ms58xxSequencerStart(MS58XXDriver* ms58xxp, enum ms58xx_osr_e osr,
+            uint16_t temperature_divider, uint16_t decimation);
+    void ms58xxSequencerStop(MS58XXDriver* ms58xxp);
+    bool ms58xxSampleGet(MS58XXDriver* ms58xxp, ms58xxsample_t* samplep);
+    size_t ms58xxSamplesRead(MS58XXDriver* ms58xxp, ms58xxsample_t samples[],
+            size_t n, uint32_t* sequencep);
+    event_source_t* ms58xxGetEventSource(MS58XXDriver* ms58xxp);
+#endif /* MS58XX_USE_SEQUENCER */
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,162 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_async.h
+ * @brief   NVM asynchronous request driver header.
+ *
+ * @addtogroup NVM_ASYNC
+ * @{
+ */
+
+#ifndef _QNVM_ASYNC_H_
+#define _QNVM_ASYNC_H_
+
+#if HAL_USE_NVM_ASYNC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_ASYNC configuration options
+ * @{
+ */
+/**
+ * @brief   Maximum number of devices being served concurrently.
+ */
+#if !defined(NVM_ASYNC_DEVICES_MAX) || defined(__DOXYGEN__)
+#define NVM_ASYNC_DEVICES_MAX               4
+#endif
+
+/**
+ * @brief   Worker thread stack size.
+ */
+#if !defined(NVM_ASYNC_THREAD_STACK_SIZE) || defined(__DOXYGEN__)
+#define NVM_ASYNC_THREAD_STACK_SIZE         512
+#endif
+
+/**
+ * @brief   Worker thread priority.
+ */
+#if !defined(NVM_ASYNC_THREAD_PRIO) || defined(__DOXYGEN__)
+#define NVM_ASYNC_THREAD_PRIO               NORMALPRIO
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_ASYNC_DEVICES_MAX < 1
+#error "NVM_ASYNC_DEVICES_MAX must be at least 1"
+#endif
+
+#if !defined(_CHIBIOS_RT_)
+#error "NVM_ASYNC requires ChibiOS/RT"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Request being served by the worker thread.
+ */
+typedef struct
+{
+    /**
+    * @brief Request or @p NULL if unused.
+    */
+    NVMRequest* reqp;
+    /**
+    * @brief Bytes of the request already served.
+    */
+    uint32_t offset;
+    /**
+    * @brief Sector size of the serving device.
+    */
+    uint32_t sector_size;
+    /**
+    * @brief Result of the last step.
+    */
+    bool result;
+} NVMAsyncSlot;
+
+/**
+ * @brief   Structure representing a NVM asynchronous request driver.
+ * @details Serves requests of devices without native support from a
+ *          worker thread. Writes and erases are split at sector boundaries
+ *          and one step is started on every active device before waiting
+ *          for any of them, keeping several devices busy at once.
+ */
+typedef struct
+{
+    /**
+    * @brief Driver state.
+    */
+    nvmstate_t state;
+    /**
+    * @brief Pointer to the worker thread.
+    */
+    thread_reference_t tr;
+    /**
+    * @brief Worker thread while waiting for requests or @p NULL.
+    */
+    thread_reference_t wait;
+    /**
+    * @brief Queue of requests not yet active.
+    */
+    NVMRequest* queue_head;
+    NVMRequest* queue_tail;
+    /**
+    * @brief Requests being served, at most one per device.
+    */
+    NVMAsyncSlot slots[NVM_ASYNC_DEVICES_MAX];
+    /**
+    * @brief Working area for the worker thread.
+    */
+    THD_WORKING_AREA(wa, NVM_ASYNC_THREAD_STACK_SIZE);
+} NVMAsyncDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmasyncInit(void);
+    void nvmasyncObjectInit(NVMAsyncDriver* nvmasyncp);
+    void nvmasyncStart(NVMAsyncDriver* nvmasyncp);
+    void nvmasyncStop(NVMAsyncDriver* nvmasyncp);
+    bool nvmasyncSubmit(NVMAsyncDriver* nvmasyncp, BaseNVMDevice* nvmp,
+            NVMRequest* reqp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_ASYNC */
+
+#endif /* _QNVM_ASYNC_H_ */
+
+/** @} */
@@ -0,0 +1,235 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_cache.h
+ * @brief   NVM cache driver header.
+ *
+ * @addtogroup NVM_CACHE
+ * @{
+ */
+
+#ifndef _QNVM_CACHE_H_
+#define _QNVM_CACHE_H_
+
+#if HAL_USE_NVM_CACHE || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_CACHE configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the @p nvmcacheAcquireBus() and @p nvmcacheReleaseBus() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_CACHE_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define NVM_CACHE_USE_MUTUAL_EXCLUSION      TRUE
+#endif
+
+/**
+ * @brief   Size of a cache line in bytes.
+ * @details Usually the page or sector size of the underlying device.
+ */
+#if !defined(NVM_CACHE_LINE_SIZE) || defined(__DOXYGEN__)
+#define NVM_CACHE_LINE_SIZE                 256
+#endif
+
+/**
+ * @brief   Number of cache lines.
+ */
+#if !defined(NVM_CACHE_LINE_NUM) || defined(__DOXYGEN__)
+#define NVM_CACHE_LINE_NUM                  8
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_CACHE_LINE_SIZE < 1
+#error "NVM_CACHE_LINE_SIZE must be at least 1"
+#endif
+
+#if NVM_CACHE_LINE_NUM < 1
+#error "NVM_CACHE_LINE_NUM must be at least 1"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Cache write policies.
+ */
+typedef enum
+{
+    NVM_CACHE_WRITE_THROUGH = 0,    /**< Writes go to the device at once.   */
+    NVM_CACHE_WRITE_BACK = 1,       /**< Writes go to the device on sync or
+                                         eviction.                          */
+} nvmcachemode_t;
+
+/**
+ * @brief   NVM cache driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief NVM driver associated to this cache.
+    */
+    BaseNVMDevice* nvmp;
+    /**
+    * @brief Write policy.
+    * @note  Write back rewrites the whole modified range of a line, the
+    *        device must allow programming unchanged bytes again.
+    */
+    nvmcachemode_t mode;
+} NVMCacheConfig;
+
+/**
+ * @brief   Cache line.
+ */
+typedef struct
+{
+    /**
+    * @brief Address of the first byte of the line.
+    */
+    uint32_t addr;
+    /**
+    * @brief Time of last use for the LRU policy.
+    */
+    uint32_t stamp;
+    /**
+    * @brief Range of modified bytes not yet written to the device.
+    */
+    uint32_t dirty_lo;
+    uint32_t dirty_hi;
+    /**
+    * @brief Line holds data of @p addr.
+    */
+    bool valid;
+    /**
+    * @brief Data of the line.
+    */
+    uint8_t data[NVM_CACHE_LINE_SIZE];
+} NVMCacheLine;
+
+/**
+ * @brief   @p NVMCacheDriver specific methods.
+ */
+#define _nvm_cache_driver_methods                                             \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMCacheDriver virtual methods table.
+ */
+struct NVMCacheDriverVMT
+{
+    _nvm_cache_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a NVM cache driver.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMCacheDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMCacheConfig* config;
+    /**
+    * @brief Device info of underlying nvm device.
+    */
+    NVMDeviceInfo llnvmdi;
+    /**
+    * @brief Device size in bytes.
+    */
+    uint32_t cache_size;
+    /**
+    * @brief Counter providing the time of use of lines.
+    */
+    uint32_t cache_stamp;
+    /**
+    * @brief Cache lines.
+    */
+    NVMCacheLine lines[NVM_CACHE_LINE_NUM];
+#if NVM_CACHE_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* NVM_CACHE_USE_MUTUAL_EXCLUSION */
+} NVMCacheDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmcacheInit(void);
+    void nvmcacheObjectInit(NVMCacheDriver* nvmcachep);
+    void nvmcacheStart(NVMCacheDriver* nvmcachep,
+            const NVMCacheConfig* config);
+    void nvmcacheStop(NVMCacheDriver* nvmcachep);
+    bool nvmcacheRead(NVMCacheDriver* nvmcachep, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmcacheWrite(NVMCacheDriver* nvmcachep, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmcacheErase(NVMCacheDriver* nvmcachep, uint32_t startaddr,
+            uint32_t n);
+    bool nvmcacheMassErase(NVMCacheDriver* nvmcachep);
+    bool nvmcacheSync(NVMCacheDriver* nvmcachep);
+    bool nvmcacheGetInfo(NVMCacheDriver* nvmcachep, NVMDeviceInfo* nvmdip);
+    void nvmcacheAcquireBus(NVMCacheDriver* nvmcachep);
+    void nvmcacheReleaseBus(NVMCacheDriver* nvmcachep);
+    bool nvmcacheWriteProtect(NVMCacheDriver* nvmcachep,
+            uint32_t startaddr, uint32_t n);
+    bool nvmcacheMassWriteProtect(NVMCacheDriver* nvmcachep);
+    bool nvmcacheWriteUnprotect(NVMCacheDriver* nvmcachep,
+            uint32_t startaddr, uint32_t n);
+    bool nvmcacheMassWriteUnprotect(NVMCacheDriver* nvmcachep);
+    bool nvmcacheInvalidate(NVMCacheDriver* nvmcachep);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_CACHE */
+
+#endif /* _QNVM_CACHE_H_ */
+
+/** @} */
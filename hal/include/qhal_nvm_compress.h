@@ -0,0 +1,300 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_compress.h
+ * @brief   NVM compression driver header.
+ *
+ * @addtogroup NVM_COMPRESS
+ * @{
+ */
+
+#ifndef _QNVM_COMPRESS_H_
+#define _QNVM_COMPRESS_H_
+
+#if HAL_USE_NVM_COMPRESS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Magic identifying a sector header.
+ */
+#define NVM_COMPRESS_MAGIC                  0x504d434eUL
+
+/**
+ * @brief   Size of a sector header.
+ */
+#define NVM_COMPRESS_SECTOR_HEADER_SIZE     16
+
+/**
+ * @brief   Size of a record header.
+ */
+#define NVM_COMPRESS_RECORD_HEADER_SIZE     8
+
+/**
+ * @brief   Unmapped logical block or unused sector marker.
+ */
+#define NVM_COMPRESS_NONE                   0xffffffffUL
+
+/**
+ * @name    Sector flags
+ * @{
+ */
+/**
+ * @brief   The sector is erased.
+ */
+#define NVM_COMPRESS_SECTOR_ERASED          0x0001
+/**
+ * @brief   The erase count has been written to the header.
+ */
+#define NVM_COMPRESS_SECTOR_PREPARED        0x0002
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_COMPRESS configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the @p nvmcompressAcquireBus() and
+ *          @p nvmcompressReleaseBus() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_COMPRESS_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define NVM_COMPRESS_USE_MUTUAL_EXCLUSION   TRUE
+#endif
+
+/**
+ * @brief   Number of bits of the match finder hash.
+ * @details The driver holds a table of two bytes per hash value. More bits
+ *          find more matches.
+ */
+#if !defined(NVM_COMPRESS_HASH_BITS) || defined(__DOXYGEN__)
+#define NVM_COMPRESS_HASH_BITS              10
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_COMPRESS_HASH_BITS < 4 || NVM_COMPRESS_HASH_BITS > 16
+#error "NVM_COMPRESS_HASH_BITS must be within 4 and 16"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Runtime state of a physical sector.
+ */
+typedef struct
+{
+    /**
+    * @brief Number of erase cycles.
+    */
+    uint32_t erase_count;
+    /**
+    * @brief Allocation sequence number or @p NVM_COMPRESS_NONE if free.
+    */
+    uint32_t sequence;
+    /**
+    * @brief Number of bytes of records holding current data.
+    */
+    uint32_t live;
+    /**
+    * @brief Sector flags.
+    */
+    uint16_t flags;
+} NVMCompressSector;
+
+/**
+ * @brief   Location of a logical block.
+ */
+typedef struct
+{
+    /**
+    * @brief Address of the record or @p NVM_COMPRESS_NONE if unmapped.
+    */
+    uint32_t addr;
+    /**
+    * @brief Stored data length, 0 if erased, block size if uncompressed.
+    * @details Non zero for unmapped blocks while recording their erase.
+    */
+    uint16_t length;
+} NVMCompressEntry;
+
+/**
+ * @brief   NVM compression driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief NVM driver holding the compressed blocks.
+    */
+    BaseNVMDevice* nvmp;
+    /**
+    * @brief Size of the blocks compressed independently.
+    * @note  Multiple of 4 up to 32768, smaller than the sector size of
+    *        @p nvmp. Also the erase size of this device.
+    */
+    uint32_t block_size;
+    /**
+    * @brief Number of logical blocks.
+    * @details Sized for the expected compression ratio, writes fail once
+    *          the compressed data does not fit into @p nvmp any more.
+    */
+    uint32_t block_num;
+    /**
+    * @brief Block map of @p block_num entries.
+    */
+    NVMCompressEntry* map;
+    /**
+    * @brief Array of one @p NVMCompressSector per device sector.
+    */
+    NVMCompressSector* sectors;
+    /**
+    * @brief Buffer of @p block_size bytes holding the current block.
+    */
+    uint8_t* buffer;
+    /**
+    * @brief Buffer of @p block_size bytes holding compressed data.
+    */
+    uint8_t* cbuffer;
+} NVMCompressConfig;
+
+/**
+ * @brief   @p NVMCompressDriver specific methods.
+ */
+#define _nvm_compress_driver_methods                                          \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMCompressDriver virtual methods table.
+ */
+struct NVMCompressDriverVMT
+{
+    _nvm_compress_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a NVM compression driver.
+ * @details Stores fixed size logical blocks compressed in a log on the
+ *          underlying device. Suited for append style and read mostly
+ *          data like logs and assets.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMCompressDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMCompressConfig* config;
+    /**
+    * @brief Device info of underlying nvm device.
+    */
+    NVMDeviceInfo llnvmdi;
+    /**
+    * @brief Sequence number of the most recently allocated sector.
+    */
+    uint32_t sequence;
+    /**
+    * @brief Sector being written to or @p NVM_COMPRESS_NONE.
+    */
+    uint32_t active;
+    /**
+    * @brief Next free offset within the active sector.
+    */
+    uint32_t next_offset;
+    /**
+    * @brief Number of free sectors.
+    */
+    uint32_t free_num;
+    /**
+    * @brief Block held by @p buffer or @p NVM_COMPRESS_NONE.
+    */
+    uint32_t open;
+    /**
+    * @brief @p buffer holds data not yet stored.
+    */
+    bool dirty;
+    /**
+    * @brief Match finder hash table.
+    */
+    uint16_t hash[1 << NVM_COMPRESS_HASH_BITS];
+#if NVM_COMPRESS_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* NVM_COMPRESS_USE_MUTUAL_EXCLUSION */
+} NVMCompressDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmcompressInit(void);
+    void nvmcompressObjectInit(NVMCompressDriver* nvmcompressp);
+    void nvmcompressStart(NVMCompressDriver* nvmcompressp,
+            const NVMCompressConfig* config);
+    void nvmcompressStop(NVMCompressDriver* nvmcompressp);
+    bool nvmcompressRead(NVMCompressDriver* nvmcompressp, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmcompressWrite(NVMCompressDriver* nvmcompressp, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmcompressErase(NVMCompressDriver* nvmcompressp, uint32_t startaddr,
+            uint32_t n);
+    bool nvmcompressMassErase(NVMCompressDriver* nvmcompressp);
+    bool nvmcompressSync(NVMCompressDriver* nvmcompressp);
+    bool nvmcompressGetInfo(NVMCompressDriver* nvmcompressp,
+            NVMDeviceInfo* nvmdip);
+    void nvmcompressAcquireBus(NVMCompressDriver* nvmcompressp);
+    void nvmcompressReleaseBus(NVMCompressDriver* nvmcompressp);
+    bool nvmcompressWriteProtect(NVMCompressDriver* nvmcompressp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmcompressMassWriteProtect(NVMCompressDriver* nvmcompressp);
+    bool nvmcompressWriteUnprotect(NVMCompressDriver* nvmcompressp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmcompressMassWriteUnprotect(NVMCompressDriver* nvmcompressp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_COMPRESS */
+
+#endif /* _QNVM_COMPRESS_H_ */
+
+/** @} */
@@ -0,0 +1,190 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_dedup.h
+ * @brief   NVM compare before write driver header.
+ *
+ * @addtogroup NVM_DEDUP
+ * @{
+ */
+
+#ifndef _QNVM_DEDUP_H_
+#define _QNVM_DEDUP_H_
+
+#if HAL_USE_NVM_DEDUP || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_DEDUP configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the @p nvmdedupAcquireBus() and @p nvmdedupReleaseBus()
+ *          APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_DEDUP_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define NVM_DEDUP_USE_MUTUAL_EXCLUSION      TRUE
+#endif
+
+/**
+ * @brief   Size of the buffer holding the data read back for comparison.
+ * @note    Must be a multiple of the write alignment of the underlying
+ *          device.
+ */
+#if !defined(NVM_DEDUP_CHUNK_SIZE) || defined(__DOXYGEN__)
+#define NVM_DEDUP_CHUNK_SIZE                64
+#endif
+
+/**
+ * @brief   Shortest run of unchanged bytes splitting a write.
+ * @details Shorter runs between changed bytes are rewritten with their
+ *          current content, saving the overhead of separate writes.
+ */
+#if !defined(NVM_DEDUP_MIN_GAP) || defined(__DOXYGEN__)
+#define NVM_DEDUP_MIN_GAP                   8
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_DEDUP_CHUNK_SIZE < 1
+#error "NVM_DEDUP_CHUNK_SIZE must be at least 1"
+#endif
+
+#if NVM_DEDUP_MIN_GAP < 1
+#error "NVM_DEDUP_MIN_GAP must be at least 1"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM compare before write driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief NVM driver receiving the changed data.
+    */
+    BaseNVMDevice* nvmp;
+} NVMDedupConfig;
+
+/**
+ * @brief   @p NVMDedupDriver specific methods.
+ */
+#define _nvm_dedup_driver_methods                                             \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMDedupDriver virtual methods table.
+ */
+struct NVMDedupDriverVMT
+{
+    _nvm_dedup_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a NVM compare before write driver.
+ * @details Reads back the range of each write and forwards only the spans
+ *          differing from the stored data. Writes of unchanged data, e.g.
+ *          repeated parameter saves, do not reach the underlying device.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMDedupDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMDedupConfig* config;
+    /**
+    * @brief Device info of underlying nvm device.
+    */
+    NVMDeviceInfo llnvmdi;
+    /**
+    * @brief Data read back for comparison.
+    */
+    uint8_t chunk[NVM_DEDUP_CHUNK_SIZE];
+#if NVM_DEDUP_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* NVM_DEDUP_USE_MUTUAL_EXCLUSION */
+} NVMDedupDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmdedupInit(void);
+    void nvmdedupObjectInit(NVMDedupDriver* nvmdedupp);
+    void nvmdedupStart(NVMDedupDriver* nvmdedupp, const NVMDedupConfig* config);
+    void nvmdedupStop(NVMDedupDriver* nvmdedupp);
+    bool nvmdedupRead(NVMDedupDriver* nvmdedupp, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmdedupWrite(NVMDedupDriver* nvmdedupp, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmdedupErase(NVMDedupDriver* nvmdedupp, uint32_t startaddr,
+            uint32_t n);
+    bool nvmdedupMassErase(NVMDedupDriver* nvmdedupp);
+    bool nvmdedupSync(NVMDedupDriver* nvmdedupp);
+    bool nvmdedupGetInfo(NVMDedupDriver* nvmdedupp, NVMDeviceInfo* nvmdip);
+    void nvmdedupAcquireBus(NVMDedupDriver* nvmdedupp);
+    void nvmdedupReleaseBus(NVMDedupDriver* nvmdedupp);
+    bool nvmdedupWriteProtect(NVMDedupDriver* nvmdedupp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmdedupMassWriteProtect(NVMDedupDriver* nvmdedupp);
+    bool nvmdedupWriteUnprotect(NVMDedupDriver* nvmdedupp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmdedupMassWriteUnprotect(NVMDedupDriver* nvmdedupp);
+    bool nvmdedupReadv(NVMDedupDriver* nvmdedupp, const NVMReadSegment* segp,
+            uint32_t segn);
+    bool nvmdedupIsErased(NVMDedupDriver* nvmdedupp, uint32_t startaddr,
+            uint32_t n, bool* erasedp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_DEDUP */
+
+#endif /* _QNVM_DEDUP_H_ */
+
+/** @} */
@@ -47,7 +47,19 @@
 #endif
 
 /**
- * @brief   Sets the number of payload bytes per slot.
+ * @brief   Driver all emulations reside on.
+ * @details Function prefix of the driver, e.g. @p nvmpart or @p flash,
+ *          binds reads, writes, erases and syncs at compile time. With the
+ *          default @p NVM_LLD_DYNAMIC any driver can be used.
+ */
+#if !defined(NVM_FEE_LLD) || defined(__DOXYGEN__)
+#define NVM_FEE_LLD                     NVM_LLD_DYNAMIC
+#endif
+
+/**
+ * @brief   Sets the default and maximum number of payload bytes per slot.
+ * @note    Instances may use smaller slots, see
+ *          @p NVMFeeConfig::slot_payload_size.
  */
 #if !defined(NVM_FEE_SLOT_PAYLOAD_SIZE) || defined(__DOXYGEN__)
 #define NVM_FEE_SLOT_PAYLOAD_SIZE       8
@@ -60,6 +72,122 @@
 #define NVM_FEE_WRITE_UNIT_SIZE         2
 #endif
 
+/**
+ * @brief   Enables the in-RAM slot index.
+ * @details The index maps each payload address to the slot holding its most
+ *          recent copy in the active arena, so reads and lookups no longer
+ *          have to scan the whole arena. The index memory is provided by the
+ *          application through @p NVMFeeConfig.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_FEE_USE_INDEX) || defined(__DOXYGEN__)
+#define NVM_FEE_USE_INDEX               FALSE
+#endif
+
+/**
+ * @brief   Uses 16bit instead of 32bit index entries.
+ * @note    Limits the number of slots per arena to 65534.
+ */
+#if !defined(NVM_FEE_INDEX_COMPACT) || defined(__DOXYGEN__)
+#define NVM_FEE_INDEX_COMPACT           FALSE
+#endif
+
+/**
+ * @brief   Size in bytes of the internal garbage collection bitmap.
+ * @details Each bit tracks one payload address which has already been copied
+ *          to the destination arena. The source arena is walked once per
+ *          8 * @p NVM_FEE_GC_BITMAP_SIZE payload addresses, so sizing the
+ *          bitmap to cover all slots of an arena results in a single pass.
+ * @note    Not used if @p NVMFeeConfig.gc_bitmapp is set or the slot index
+ *          is available.
+ */
+#if !defined(NVM_FEE_GC_BITMAP_SIZE) || defined(__DOXYGEN__)
+#define NVM_FEE_GC_BITMAP_SIZE          64
+#endif
+
+/**
+ * @brief   Maximum number of arenas per fee instance.
+ * @details Each arena requires one slot counter in @p NVMFeeDriver.
+ */
+#if !defined(NVM_FEE_MAX_ARENAS) || defined(__DOXYGEN__)
+#define NVM_FEE_MAX_ARENAS              2
+#endif
+
+/**
+ * @brief   Enables checkpoint records for fast startup.
+ * @details A checkpoint holds the number of used slots per arena and a copy
+ *          of the slot index. It is stored in the metadata sectors reserved
+ *          by @p NVMFeeConfig.sector_header_num. At startup only slots
+ *          written after the most recent checkpoint have to be scanned. If
+ *          no valid checkpoint is found all arenas are scanned as usual.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_FEE_USE_CHECKPOINT) || defined(__DOXYGEN__)
+#define NVM_FEE_USE_CHECKPOINT          FALSE
+#endif
+
+/**
+ * @brief   Number of slots in the write-back cache.
+ * @details Written data is collected per slot in RAM and only stored to the
+ *          underlying device when a cache entry gets evicted or on
+ *          @p nvmfeeSync() and @p nvmfeeStop(). Small sequential writes to
+ *          the same slot are thereby coalesced into a single slot write.
+ * @note    Data not yet written back is lost on power failure.
+ * @note    Zero disables the cache.
+ */
+#if !defined(NVM_FEE_CACHE_SLOTS) || defined(__DOXYGEN__)
+#define NVM_FEE_CACHE_SLOTS             0
+#endif
+
+/**
+ * @brief   Enables the @p nvmfeeTransactionBegin() and
+ *          @p nvmfeeTransactionCommit() APIs.
+ * @details Transactions are collected in the write-back cache and reduce
+ *          the fee size by @p NVM_FEE_CACHE_SLOTS + 1 slots per used arena.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_FEE_USE_TRANSACTION) || defined(__DOXYGEN__)
+#define NVM_FEE_USE_TRANSACTION         FALSE
+#endif
+
+/**
+ * @brief   Size in bytes of the page buffer.
+ * @details Consecutive slot writes are gathered in RAM and programmed with
+ *          a single write to the underlying device once the buffer or the
+ *          flash page given by @p NVMFeeConfig.page_size is full, or on
+ *          @p nvmfeeSync(). All slots of the buffer are validated by one
+ *          more write afterwards. This strongly reduces the number of
+ *          program commands on devices like SPI NOR flashes.
+ * @note    Requires a device which allows programming already programmed
+ *          bytes with unchanged data.
+ * @note    Data not yet programmed is lost on power failure.
+ * @note    Zero disables the page buffer.
+ */
+#if !defined(NVM_FEE_PAGE_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_FEE_PAGE_BUFFER_SIZE        0
+#endif
+
+/**
+ * @brief   Enables the @p nvmfeeGetStats() API.
+ * @details Counts garbage collections, bytes written and writes skipped
+ *          because of unchanged data since @p nvmfeeStart().
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_FEE_USE_STATS) || defined(__DOXYGEN__)
+#define NVM_FEE_USE_STATS               FALSE
+#endif
+
+/**
+ * @brief   Enables erase counters stored in the arena headers.
+ * @details The number of erase cycles of each arena is kept across restarts
+ *          and reported by @p nvmfeeGetStats().
+ * @note    A counter restarts at zero if power fails between erasing the
+ *          arena and writing its new header.
+ */
+#if !defined(NVM_FEE_USE_ERASE_COUNTER) || defined(__DOXYGEN__)
+#define NVM_FEE_USE_ERASE_COUNTER       FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -70,10 +198,121 @@
 #error "payload size + 4 must be a multiple of write unit size."
 #endif
 
+#if NVM_FEE_GC_BITMAP_SIZE < 1
+#error "NVM_FEE_GC_BITMAP_SIZE must be at least 1."
+#endif
+
+#if NVM_FEE_MAX_ARENAS < 2
+#error "NVM_FEE_MAX_ARENAS must be at least 2."
+#endif
+
+#if NVM_FEE_USE_TRANSACTION && NVM_FEE_CACHE_SLOTS == 0
+#error "NVM_FEE_USE_TRANSACTION requires NVM_FEE_CACHE_SLOTS."
+#endif
+
+#if NVM_FEE_USE_ERASE_COUNTER && !NVM_FEE_USE_STATS
+#error "NVM_FEE_USE_ERASE_COUNTER requires NVM_FEE_USE_STATS."
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
 
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a single slot index entry.
+ */
+#if NVM_FEE_INDEX_COMPACT || defined(__DOXYGEN__)
+typedef uint16_t nvmfeeindex_t;
+#else
+typedef uint32_t nvmfeeindex_t;
+#endif
+#endif /* NVM_FEE_USE_INDEX */
+
+#if NVM_FEE_CACHE_SLOTS || defined(__DOXYGEN__)
+/**
+ * @brief   Write-back cache entry.
+ */
+typedef struct
+{
+    /**
+     * @brief Payload address of the cached slot.
+     */
+    uint32_t address;
+    /**
+     * @brief Time of last use.
+     */
+    uint32_t tick;
+    /**
+     * @brief Cached payload.
+     */
+    uint8_t payload[NVM_FEE_SLOT_PAYLOAD_SIZE];
+} nvmfeecacheentry_t;
+#endif /* NVM_FEE_CACHE_SLOTS */
+
+#if NVM_FEE_USE_STATS || defined(__DOXYGEN__)
+/**
+ * @brief   NVM fee statistics.
+ */
+typedef struct
+{
+    /**
+     * @brief Slots in use, including stale ones.
+     */
+    uint32_t slots_used;
+    /**
+     * @brief Unused slots of all arenas.
+     */
+    uint32_t slots_free;
+    /**
+     * @brief Slots holding the current data of an address.
+     */
+    uint32_t slots_live;
+    /**
+     * @brief Used slots which have been superseded or are invalid.
+     */
+    uint32_t slots_stale;
+    /**
+     * @brief Number of garbage collections started.
+     */
+    uint32_t gc_count;
+    /**
+     * @brief Cumulative garbage collection time in system ticks.
+     */
+    uint32_t gc_time;
+    /**
+     * @brief Bytes passed to write and erase operations.
+     */
+    uint32_t bytes_requested;
+    /**
+     * @brief Bytes written to the underlying nvm device.
+     * @note  Divided by @p bytes_requested this yields the write
+     *        amplification.
+     */
+    uint32_t bytes_written;
+    /**
+     * @brief Slot writes skipped because the data was unchanged.
+     */
+    uint32_t writes_skipped;
+#if NVM_FEE_USE_ERASE_COUNTER || defined(__DOXYGEN__)
+    /**
+     * @brief Number of erase cycles per arena.
+     */
+    uint32_t erase_count[NVM_FEE_MAX_ARENAS];
+#endif /* NVM_FEE_USE_ERASE_COUNTER */
+} NVMFeeStats;
+#endif /* NVM_FEE_USE_STATS */
+
+/**
+ * @brief   Garbage collection state.
+ */
+typedef enum
+{
+    NVM_FEE_GC_IDLE = 0,                /**< No collection in progress.      */
+    NVM_FEE_GC_COPYING,                 /**< Copying live slots.             */
+    NVM_FEE_GC_ERASING,                 /**< Erasing the old arena.          */
+} nvmfeegcstate_t;
+
 /**
  * @brief   NVM fee driver configuration structure.
  */
@@ -85,8 +324,88 @@ typedef struct
     BaseNVMDevice* nvmp;
     /*
      * @brief number of sectors to assign to metadata header
+     * @note  Only used for checkpoint records, see
+     *        @p NVM_FEE_USE_CHECKPOINT.
      */
     uint32_t sector_header_num;
+    /**
+     * @brief Number of arenas the underlying nvm device is split into or 0
+     *        for two arenas.
+     * @note  One arena is kept unused for garbage collection, so more arenas
+     *        increase the fee size and decrease the amount of data moved
+     *        per collection. Must not exceed @p NVM_FEE_MAX_ARENAS.
+     */
+    uint32_t arena_num;
+    /**
+     * @brief Number of payload bytes per slot or 0 for
+     *        @p NVM_FEE_SLOT_PAYLOAD_SIZE.
+     * @note  Larger slots reduce the per record overhead for bigger data
+     *        blocks, smaller slots reduce the write amplification of small
+     *        updates. Must not exceed @p NVM_FEE_SLOT_PAYLOAD_SIZE and
+     *        payload size + 4 must be a multiple of the write unit size.
+     */
+    uint32_t slot_payload_size;
+    /**
+     * @brief Program page size of the underlying nvm device or 0 to pack
+     *        slots regardless of pages.
+     * @note  Slots never straddle page boundaries, so each slot is stored
+     *        by a single page program. Must divide the sector size.
+     */
+    uint32_t page_size;
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+    /**
+     * @brief Slot index buffer or @p NULL to disable the index.
+     * @note  Use @p NVM_FEE_INDEX_NUM() to dimension the buffer.
+     */
+    nvmfeeindex_t* indexp;
+    /**
+     * @brief Number of entries in the slot index buffer.
+     */
+    uint32_t index_num;
+    /**
+     * @brief Maximum number of consecutive payload units stored as a single
+     *        run record or 0 or 1 to store each unit in its own slot.
+     * @note  A run record shares one header between all its units. Requires
+     *        the slot index, a page size of 0 and a fee of less than 16MiB.
+     *        At most 255 units.
+     * @note  Changes the storage format.
+     */
+    uint32_t run_units;
+#endif /* NVM_FEE_USE_INDEX */
+    /**
+     * @brief Garbage collection bitmap buffer covering all payload
+     *        addresses or @p NULL to use the internal one of
+     *        @p NVM_FEE_GC_BITMAP_SIZE bytes.
+     * @note  Optional, collects in a single pass over the source arena.
+     *        Use @p NVM_FEE_GC_BITMAP_BYTES() to dimension the buffer.
+     * @note  Not used if the slot index is available.
+     */
+    uint8_t* gc_bitmapp;
+    /**
+     * @brief Size in bytes of the garbage collection bitmap buffer.
+     */
+    uint32_t gc_bitmap_size;
+    /**
+     * @brief Arena fill level in percent starting incremental garbage
+     *        collection or 0 to collect only when the arena is full.
+     * @note  Reduces the fee size by the slots which might be written
+     *        while a collection is running.
+     * @note  Only supported with two arenas.
+     */
+    uint32_t gc_threshold;
+    /**
+     * @brief Number of slots copied per incremental garbage collection
+     *        step or 0 to copy all slots at once.
+     */
+    uint32_t gc_step_slots;
+#if NVM_FEE_USE_CHECKPOINT || defined(__DOXYGEN__)
+    /**
+     * @brief Number of slots written after which @p nvmfeeSync() records a
+     *        checkpoint or 0 to record checkpoints only after garbage
+     *        collection.
+     */
+    uint32_t checkpoint_slots;
+#endif /* NVM_FEE_USE_CHECKPOINT */
 } NVMFeeConfig;
 
 /**
@@ -125,20 +444,120 @@ typedef struct
     * @brief Device info of underlying nvm device.
     */
     NVMDeviceInfo llnvmdi;
+    /**
+     * @brief Underlying nvm device mapped by @p nvmMap() or @p NULL.
+     * @details Slots are inspected in place instead of being read. The
+     *          mapping is dropped by writes and erases and at the start of
+     *          each operation, as the device may be written by others in
+     *          between.
+     */
+    const uint8_t* map;
     /**
     * @brief Current active arena.
     */
     uint32_t arena_active;
+    /**
+    * @brief Oldest arena holding data.
+    */
+    uint32_t arena_tail;
     /**
      * @brief Used slots in arena.
      */
-    uint32_t arena_slots[2];
+    uint32_t arena_slots[NVM_FEE_MAX_ARENAS];
     /**
     * @brief Cached values.
     */
+    uint32_t arena_org;
+    uint32_t arena_num;
     uint32_t arena_num_sectors;
     uint32_t arena_num_slots;
+    uint32_t slot_payload_size;
+    uint32_t slot_size;
+    uint32_t page_slots;
+    uint32_t page_first_slots;
     uint32_t fee_size;
+    uint32_t run_units;
+    /**
+     * @brief Addresses already copied during garbage collection.
+     */
+    uint8_t gc_bitmap[NVM_FEE_GC_BITMAP_SIZE];
+    /**
+     * @brief Incremental garbage collection state.
+     */
+    nvmfeegcstate_t gc_state;
+    /**
+     * @brief Arena being collected.
+     */
+    uint32_t gc_arena;
+    /**
+     * @brief Remaining slots to copy or sectors to erase.
+     */
+    uint32_t gc_cursor;
+    /**
+     * @brief Cached incremental garbage collection parameters.
+     */
+    uint32_t gc_step_slots;
+    uint32_t gc_threshold_slots;
+#if NVM_FEE_USE_CHECKPOINT || defined(__DOXYGEN__)
+    /**
+     * @brief Format sequence number of each arena.
+     */
+    uint32_t arena_sequence[NVM_FEE_MAX_ARENAS];
+    /**
+     * @brief Most recently assigned format sequence number.
+     */
+    uint32_t sequence;
+    /**
+     * @brief Offset of the next free checkpoint record.
+     */
+    uint32_t checkpoint_offset;
+    /**
+     * @brief Slots written since the last checkpoint.
+     */
+    uint32_t checkpoint_pending;
+#endif /* NVM_FEE_USE_CHECKPOINT */
+#if NVM_FEE_CACHE_SLOTS || defined(__DOXYGEN__)
+    /**
+     * @brief Write-back cache.
+     */
+    nvmfeecacheentry_t cache[NVM_FEE_CACHE_SLOTS];
+    /**
+     * @brief Cache usage counter.
+     */
+    uint32_t cache_tick;
+#endif /* NVM_FEE_CACHE_SLOTS */
+#if NVM_FEE_USE_TRANSACTION || defined(__DOXYGEN__)
+    /**
+     * @brief Transaction in progress.
+     */
+    bool transaction;
+#endif /* NVM_FEE_USE_TRANSACTION */
+#if NVM_FEE_PAGE_BUFFER_SIZE || defined(__DOXYGEN__)
+    /**
+     * @brief Images of slots not yet programmed.
+     */
+    uint8_t page_buffer[NVM_FEE_PAGE_BUFFER_SIZE];
+    /**
+     * @brief Slots of the page buffer which have been validated.
+     */
+    uint8_t page_valid[(NVM_FEE_PAGE_BUFFER_SIZE /
+            (2 * NVM_FEE_WRITE_UNIT_SIZE + 5) + 8) / 8];
+    /**
+     * @brief Arena and first slot of the page buffer.
+     */
+    uint32_t page_arena;
+    uint32_t page_slot;
+    /**
+     * @brief Number of slots in the page buffer.
+     */
+    uint32_t page_count;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+#if NVM_FEE_USE_STATS || defined(__DOXYGEN__)
+    /**
+     * @brief Statistics counters.
+     */
+    NVMFeeStats stats;
+#endif /* NVM_FEE_USE_STATS */
 #if NVM_FEE_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
     /**
      * @brief mutex_t protecting the device.
@@ -151,6 +570,61 @@ typedef struct
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns @p true while a garbage collection is in progress.
+ *
+ * @param[in] nvmfeep       pointer to the @p NVMFeeDriver object
+ */
+#define nvmfeeGCIsPending(nvmfeep) ((nvmfeep)->gc_state != NVM_FEE_GC_IDLE)
+
+/**
+ * @brief   Number of slot index entries required for a fee instance.
+ *
+ * @param[in] size          size of the underlying nvm device in bytes
+ * @param[in] arenas        number of arenas
+ */
+#define NVM_FEE_INDEX_NUM_ARENAS(size, arenas)                                \
+    NVM_FEE_INDEX_NUM_EXT(size, arenas, NVM_FEE_SLOT_PAYLOAD_SIZE)
+
+/**
+ * @brief   Number of slot index entries required for a fee instance with
+ *          a custom slot payload size.
+ *
+ * @param[in] size          size of the underlying nvm device in bytes
+ * @param[in] arenas        number of arenas
+ * @param[in] payload       slot payload size in bytes
+ */
+#define NVM_FEE_INDEX_NUM_EXT(size, arenas, payload)                          \
+    (((arenas) - 1) * ((((size) / (arenas)) - 32) /                           \
+            (2 * NVM_FEE_WRITE_UNIT_SIZE + 4 + (payload))))
+
+/**
+ * @brief   Number of slot index entries required for a two arena fee.
+ *
+ * @param[in] size          size of the underlying nvm device in bytes
+ */
+#define NVM_FEE_INDEX_NUM(size) NVM_FEE_INDEX_NUM_ARENAS(size, 2)
+
+/**
+ * @brief   Size in bytes of the garbage collection bitmap required for
+ *          a fee instance with a custom slot payload size.
+ *
+ * @param[in] size          size of the underlying nvm device in bytes
+ * @param[in] arenas        number of arenas
+ * @param[in] payload       slot payload size in bytes
+ */
+#define NVM_FEE_GC_BITMAP_BYTES_EXT(size, arenas, payload)                    \
+    ((NVM_FEE_INDEX_NUM_EXT(size, arenas, payload) + 7) / 8)
+
+/**
+ * @brief   Size in bytes of the garbage collection bitmap required for
+ *          a two arena fee.
+ *
+ * @param[in] size          size of the underlying nvm device in bytes
+ */
+#define NVM_FEE_GC_BITMAP_BYTES(size)                                         \
+    NVM_FEE_GC_BITMAP_BYTES_EXT(size, 2, NVM_FEE_SLOT_PAYLOAD_SIZE)
+
 /** @} */
 
 /*===========================================================================*/
@@ -175,6 +649,15 @@ extern "C" {
     bool nvmfeeSync(NVMFeeDriver* nvmfeep);
     bool nvmfeeGetInfo(NVMFeeDriver* nvmfeep,
             NVMDeviceInfo* nvmdip);
+    bool nvmfeeGCStep(NVMFeeDriver* nvmfeep);
+#if NVM_FEE_USE_STATS || defined(__DOXYGEN__)
+    bool nvmfeeGetStats(NVMFeeDriver* nvmfeep, NVMFeeStats* statsp);
+#endif /* NVM_FEE_USE_STATS */
+#if NVM_FEE_USE_TRANSACTION || defined(__DOXYGEN__)
+    bool nvmfeeTransactionBegin(NVMFeeDriver* nvmfeep);
+    bool nvmfeeTransactionCommit(NVMFeeDriver* nvmfeep);
+    void nvmfeeTransactionAbort(NVMFeeDriver* nvmfeep);
+#endif /* NVM_FEE_USE_TRANSACTION */
     void nvmfeeAcquireBus(NVMFeeDriver* nvmfeep);
     void nvmfeeReleaseBus(NVMFeeDriver* nvmfeep);
     bool nvmfeeWriteProtect(NVMFeeDriver* nvmfeep,
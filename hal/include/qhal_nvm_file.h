@@ -50,12 +50,105 @@
 #if !defined(NVM_FILE_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define NVM_FILE_USE_MUTUAL_EXCLUSION       TRUE
 #endif
+
+/**
+ * @brief   Accesses the file through a shared memory mapping.
+ * @details Reads, writes and erases become memory copies, @p nvmfileSync()
+ *          writes the mapping back to the file.
+ * @note    Requires a POSIX host, not available with @p HAS_FATFS.
+ */
+#if !defined(NVM_FILE_USE_MMAP) || defined(__DOXYGEN__)
+#define NVM_FILE_USE_MMAP                   FALSE
+#endif
+
+/**
+ * @brief   Size of the buffer used to fill the file with erased bytes.
+ */
+#if !defined(NVM_FILE_FILL_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_FILE_FILL_BUFFER_SIZE           512
+#endif
+
+/**
+ * @brief   Milliseconds pending writes may stay unflushed.
+ * @details Pending writes are flushed by the first operation after the
+ *          interval expired. Zero flushes only on @p nvmfileSync().
+ */
+#if !defined(NVM_FILE_SYNC_INTERVAL) || defined(__DOXYGEN__)
+#define NVM_FILE_SYNC_INTERVAL              0
+#endif
+
+/**
+ * @brief   Collects writes in a cluster aligned RAM buffer.
+ * @details A buffered window is written back with a single @p f_write()
+ *          when another window is written or on sync.
+ * @note    Only available with @p HAS_FATFS.
+ */
+#if !defined(NVM_FILE_USE_FATFS_BUFFER) || defined(__DOXYGEN__)
+#define NVM_FILE_USE_FATFS_BUFFER           FALSE
+#endif
+
+/**
+ * @brief   Size of the write buffer in bytes.
+ * @note    Should be the cluster size of the volume or a divider of it.
+ */
+#if !defined(NVM_FILE_FATFS_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_FILE_FATFS_BUFFER_SIZE          4096
+#endif
+
+/**
+ * @brief   Preallocates a new file as one contiguous cluster chain.
+ * @note    Only available with @p HAS_FATFS, requires @p FF_USE_EXPAND.
+ */
+#if !defined(NVM_FILE_USE_FATFS_EXPAND) || defined(__DOXYGEN__)
+#define NVM_FILE_USE_FATFS_EXPAND           FALSE
+#endif
+
+/**
+ * @brief   Number of entries of the FatFS fast seek cluster link map.
+ * @details Each fragment of the file takes two entries plus one for the
+ *          size and one for the terminator, a contiguous file needs four.
+ *          Zero disables fast seek.
+ * @note    Only available with @p HAS_FATFS, requires @p FF_USE_FASTSEEK.
+ */
+#if !defined(NVM_FILE_FATFS_LINKMAP_SIZE) || defined(__DOXYGEN__)
+#define NVM_FILE_FATFS_LINKMAP_SIZE         0
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if NVM_FILE_USE_MMAP && HAS_FATFS
+#error "NVM_FILE_USE_MMAP requires a POSIX host"
+#endif
+
+#if NVM_FILE_FILL_BUFFER_SIZE < 1
+#error "NVM_FILE_FILL_BUFFER_SIZE must be at least 1"
+#endif
+
+#if NVM_FILE_USE_FATFS_BUFFER && !HAS_FATFS
+#error "NVM_FILE_USE_FATFS_BUFFER requires HAS_FATFS"
+#endif
+
+#if NVM_FILE_USE_FATFS_BUFFER && \
+        ((NVM_FILE_FATFS_BUFFER_SIZE < 512) || \
+        (NVM_FILE_FATFS_BUFFER_SIZE % 512 != 0))
+#error "NVM_FILE_FATFS_BUFFER_SIZE must be a multiple of 512"
+#endif
+
+#if NVM_FILE_USE_FATFS_EXPAND && !HAS_FATFS
+#error "NVM_FILE_USE_FATFS_EXPAND requires HAS_FATFS"
+#endif
+
+#if (NVM_FILE_FATFS_LINKMAP_SIZE > 0) && !HAS_FATFS
+#error "NVM_FILE_FATFS_LINKMAP_SIZE requires HAS_FATFS"
+#endif
+
+#if (NVM_FILE_FATFS_LINKMAP_SIZE > 0) && (NVM_FILE_FATFS_LINKMAP_SIZE < 4)
+#error "NVM_FILE_FATFS_LINKMAP_SIZE must be at least 4"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -119,6 +212,42 @@ typedef struct
 #else /* HAS_FATFS */
     FILE* file;
 #endif /* HAS_FATFS */
+#if (NVM_FILE_FATFS_LINKMAP_SIZE > 0) || defined(__DOXYGEN__)
+    /**
+     * @brief Fast seek cluster link map of @p file.
+     */
+    DWORD linkmap[NVM_FILE_FATFS_LINKMAP_SIZE];
+#endif /* NVM_FILE_FATFS_LINKMAP_SIZE > 0 */
+#if NVM_FILE_USE_MMAP || defined(__DOXYGEN__)
+    /**
+     * @brief Shared mapping of the file or @p NULL.
+     */
+    uint8_t* mapping;
+#endif /* NVM_FILE_USE_MMAP */
+    /**
+     * @brief Writes are pending a flush.
+     */
+    bool dirty;
+#if (NVM_FILE_SYNC_INTERVAL > 0) || defined(__DOXYGEN__)
+    /**
+     * @brief System time of the oldest pending write.
+     */
+    systime_t dirty_since;
+#endif /* NVM_FILE_SYNC_INTERVAL > 0 */
+#if NVM_FILE_USE_FATFS_BUFFER || defined(__DOXYGEN__)
+    /**
+     * @brief Write buffer.
+     */
+    uint8_t buffer[NVM_FILE_FATFS_BUFFER_SIZE];
+    /**
+     * @brief File offset of the buffered window or @p UINT32_MAX.
+     */
+    uint32_t buffer_addr;
+    /**
+     * @brief Buffered window differs from the file.
+     */
+    bool buffer_dirty;
+#endif /* NVM_FILE_USE_FATFS_BUFFER */
 #if NVM_FILE_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
     /**
      * @brief mutex_t protecting the device.
@@ -161,6 +290,10 @@ extern "C" {
     bool nvmfileWriteUnprotect(NVMFileDriver* nvmfilep,
             uint32_t startaddr, uint32_t n);
     bool nvmfileMassWriteUnprotect(NVMFileDriver* nvmfilep);
+#if NVM_FILE_USE_MMAP || defined(__DOXYGEN__)
+    bool nvmfileMap(NVMFileDriver* nvmfilep, uint32_t startaddr, uint32_t n,
+            const uint8_t** ptrp);
+#endif /* NVM_FILE_USE_MMAP */
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,254 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qhal_nvm_ftl.h
+ * @brief   NVM flash translation layer block device header.
+ *
+ * @addtogroup NVM_FTL
+ * @{
+ */
+
+#ifndef _QNVM_FTL_H_
+#define _QNVM_FTL_H_
+
+#if HAL_USE_NVM_FTL || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Magic identifying a sector summary.
+ */
+#define NVM_FTL_MAGIC                       0x4c54464eUL
+
+/**
+ * @brief   Size of the fixed part of a sector summary.
+ */
+#define NVM_FTL_SUMMARY_HEADER_SIZE         16
+
+/**
+ * @brief   Unmapped logical block or unused sector marker.
+ */
+#define NVM_FTL_NONE                        0xffffffffUL
+
+/**
+ * @name    Sector flags
+ * @{
+ */
+/**
+ * @brief   The data pages of the sector are erased.
+ */
+#define NVM_FTL_SECTOR_ERASED               0x0001
+/**
+ * @brief   The erase count has been written to the summary.
+ */
+#define NVM_FTL_SECTOR_PREPARED             0x0002
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_FTL configuration options
+ * @{
+ */
+/**
+ * @brief   Erase count difference triggering static wear leveling.
+ * @details Once the most worn sector has been erased this many times more
+ *          than the least worn sector holding data, garbage collection
+ *          relocates the data of the latter.
+ */
+#if !defined(NVM_FTL_WEAR_LEVEL_THRESHOLD) || defined(__DOXYGEN__)
+#define NVM_FTL_WEAR_LEVEL_THRESHOLD        64
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_FTL_WEAR_LEVEL_THRESHOLD < 1
+#error "NVM_FTL_WEAR_LEVEL_THRESHOLD must be at least 1"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Runtime state of a physical sector.
+ */
+typedef struct
+{
+    /**
+    * @brief Number of erase cycles.
+    */
+    uint32_t erase_count;
+    /**
+    * @brief Allocation sequence number or @p NVM_FTL_NONE if free.
+    */
+    uint32_t sequence;
+    /**
+    * @brief Number of pages holding current data.
+    */
+    uint16_t valid;
+    /**
+    * @brief Sector flags.
+    */
+    uint16_t flags;
+} NVMFtlSector;
+
+/**
+ * @brief   NVM flash translation layer driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief Pointer to BaseNVMDevice.
+    */
+    BaseNVMDevice* nvmp;
+    /**
+    * @brief Size of emulated blocks.
+    * @note  Must divide the sector size of the device.
+    */
+    uint32_t block_size;
+    /**
+    * @brief Number of sectors not available for data, at least 2.
+    * @details More spare sectors reduce the garbage collection effort.
+    */
+    uint32_t spare_sectors;
+    /**
+    * @brief Logical to physical map of @p NVM_FTL_BLOCK_NUM() entries.
+    */
+    uint32_t* map;
+    /**
+    * @brief Array of one @p NVMFtlSector per device sector.
+    */
+    NVMFtlSector* sectors;
+    /**
+    * @brief Buffer of @p block_size bytes used for garbage collection.
+    */
+    uint8_t* buffer;
+} NVMFtlConfig;
+
+/**
+ * @brief   @p NVMFtlDriver specific methods.
+ */
+#define _nvm_ftl_driver_methods                                             \
+    _base_block_device_methods
+
+/**
+ * @extends BaseBlockDeviceVMT
+ *
+ * @brief   @p NVMFtlDriver virtual methods table.
+ */
+struct NVMFtlDriverVMT
+{
+    _nvm_ftl_driver_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   Structure representing a NVM flash translation layer driver.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMFtlDriverVMT* vmt;
+    _base_block_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMFtlConfig* config;
+    /**
+    * @brief Number of sectors of the device.
+    */
+    uint32_t sector_num;
+    /**
+    * @brief Number of pages per sector including the summary page.
+    */
+    uint32_t pages;
+    /**
+    * @brief Number of logical blocks.
+    */
+    uint32_t blk_num;
+    /**
+    * @brief Sequence number of the most recently allocated sector.
+    */
+    uint32_t sequence;
+    /**
+    * @brief Sector being written to or @p NVM_FTL_NONE.
+    */
+    uint32_t active;
+    /**
+    * @brief Next free page within the active sector.
+    */
+    uint32_t next_page;
+    /**
+    * @brief Number of free sectors.
+    */
+    uint32_t free_num;
+} NVMFtlDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of logical blocks provided for a device geometry.
+ * @details One page per sector holds the sector summary.
+ */
+#define NVM_FTL_BLOCK_NUM(sector_size, sector_num, block_size, spare)      \
+    (((sector_num) - (spare)) * ((sector_size) / (block_size) - 1))
+
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmftlInit(void);
+    void nvmftlObjectInit(NVMFtlDriver* nvmftlp);
+    void nvmftlStart(NVMFtlDriver* nvmftlp, const NVMFtlConfig* config);
+    void nvmftlStop(NVMFtlDriver* nvmftlp);
+    bool nvmftlRead(NVMFtlDriver* nvmftlp, uint32_t startblk,
+            uint8_t* buffer, uint32_t n);
+    bool nvmftlWrite(NVMFtlDriver* nvmftlp, uint32_t startblk,
+            const uint8_t* buffer, uint32_t n);
+    bool nvmftlDiscard(NVMFtlDriver* nvmftlp, uint32_t startblk, uint32_t n);
+    bool nvmftlSync(NVMFtlDriver* nvmftlp);
+    bool nvmftlGetInfo(NVMFtlDriver* nvmftlp, BlockDeviceInfo* bdip);
+    bool nvmftlIsInserted(NVMFtlDriver* nvmftlp);
+    bool nvmftlIsProtected(NVMFtlDriver* nvmftlp);
+    bool nvmftlConnect(NVMFtlDriver* nvmftlp);
+    bool nvmftlDisconnect(NVMFtlDriver* nvmftlp);
+    bool nvmftlGarbageCollect(NVMFtlDriver* nvmftlp, uint32_t free_num);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_FTL */
+
+#endif /* _QNVM_FTL_H_ */
+
+/** @} */
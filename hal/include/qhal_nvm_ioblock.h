@@ -54,13 +54,22 @@ typedef struct
     * @brief Size of emulated blocks.
     */
     size_t block_size;
+    /**
+    * @brief Optional bitmap of one bit per block or @p NULL.
+    * @details Tracks discarded blocks so sectors discarded in parts get
+    *          erased once no block of them holds data anymore. Without it
+    *          only sectors covered by a single discard are erased.
+    */
+    uint8_t* discard_map;
 } NVMIOBlockConfig;
 
 /**
  * @brief   @p NVMIOBlockDriver specific methods.
  */
 #define _nvm_ioblock_driver_methods                                         \
-    _base_block_device_methods
+    _base_block_device_methods                                              \
+    /* Discards blocks.*/                                                   \
+    bool (*discard)(void *instance, uint32_t startblk, uint32_t n);
 
 /**
  * @extends BaseNVMDeviceVMT
@@ -94,6 +103,22 @@ typedef struct
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Discards blocks no longer holding data.
+ *
+ * @param[in] ip            pointer to a @p NVMIOBlockDriver or derived class
+ * @param[in] startblk      first block to discard
+ * @param[in] n             number of blocks to discard
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+#define blkDiscard(ip, startblk, n)                                         \
+    ((ip)->vmt->discard(ip, startblk, n))
+
 /** @} */
 
 /*===========================================================================*/
@@ -112,6 +137,8 @@ extern "C" {
             uint8_t* buffer, uint32_t n);
     bool nvmioblockWrite(NVMIOBlockDriver* nvmioblockp, uint32_t startblk,
             const uint8_t* buffer, uint32_t n);
+    bool nvmioblockDiscard(NVMIOBlockDriver* nvmioblockp, uint32_t startblk,
+            uint32_t n);
     bool nvmioblockSync(NVMIOBlockDriver* nvmioblockp);
     bool nvmioblockGetInfo(NVMIOBlockDriver* nvmioblockp, BlockDeviceInfo* bdip);
     bool nvmioblockIsInserted(NVMIOBlockDriver* nvmioblockp);
@@ -150,6 +150,10 @@ extern "C" {
     bool nvmmemoryWriteUnprotect(NVMMemoryDriver* nvmmemoryp,
             uint32_t startaddr, uint32_t n);
     bool nvmmemoryMassWriteUnprotect(NVMMemoryDriver* nvmmemoryp);
+    bool nvmmemoryIsErased(NVMMemoryDriver* nvmmemoryp, uint32_t startaddr,
+            uint32_t n, bool* erasedp);
+    bool nvmmemoryMap(NVMMemoryDriver* nvmmemoryp, uint32_t startaddr,
+            uint32_t n, const uint8_t** ptrp);
 #ifdef __cplusplus
 }
 #endif
@@ -25,6 +25,8 @@
 
 #if HAL_USE_NVM_MIRROR || defined(__DOXYGEN__)
 
+#include "qrwlock.h"
+
 /*===========================================================================*/
 /* Driver constants.                                                         */
 /*===========================================================================*/
@@ -44,12 +46,92 @@
 #if !defined(NVM_MIRROR_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define NVM_MIRROR_USE_MUTUAL_EXCLUSION     TRUE
 #endif
+
+/**
+ * @brief   Lets readers share the mirror.
+ * @details The mutex is replaced by a readers-writer lock and the
+ *          @p nvmmirrorAcquireBusShared() and @p nvmmirrorReleaseBusShared()
+ *          APIs are enabled, the lower device is acquired for reading too.
+ */
+#if !defined(NVM_MIRROR_USE_RW_LOCK) || defined(__DOXYGEN__)
+#define NVM_MIRROR_USE_RW_LOCK              FALSE
+#endif
+
+/**
+ * @brief   Size of each of the two buffers used to copy between mirrors.
+ * @details Larger buffers reduce the number of lower level transactions
+ *          during recovery at the cost of data space.
+ */
+#if !defined(NVM_MIRROR_COPY_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_MIRROR_COPY_BUFFER_SIZE         256
+#endif
+
+/**
+ * @brief   Enables the @p nvmmirrorTransactionBegin(),
+ *          @p nvmmirrorTransactionCommit() and
+ *          @p nvmmirrorTransactionAbort() APIs.
+ * @details Within a transaction writes and erases are applied to mirror a
+ *          only and mirror b is updated once on commit.
+ */
+#if !defined(NVM_MIRROR_USE_TRANSACTION) || defined(__DOXYGEN__)
+#define NVM_MIRROR_USE_TRANSACTION          FALSE
+#endif
+
+/**
+ * @brief   Enables background propagation of changes to mirror b.
+ * @details Writes and erases return once mirror a has been stored and the
+ *          state has been set to dirty b. A dedicated thread applies the
+ *          operation to mirror b and sets the state to synced. Following
+ *          operations and @p nvmmirrorSync() wait for it to finish.
+ */
+#if !defined(NVM_MIRROR_USE_ASYNC) || defined(__DOXYGEN__)
+#define NVM_MIRROR_USE_ASYNC                FALSE
+#endif
+
+/**
+ * @brief   Largest write being propagated in the background.
+ * @details Larger writes are applied to mirror b before returning.
+ */
+#if !defined(NVM_MIRROR_ASYNC_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_MIRROR_ASYNC_BUFFER_SIZE        256
+#endif
+
+/**
+ * @brief   Background propagation thread stack size.
+ */
+#if !defined(NVM_MIRROR_ASYNC_THREAD_STACK_SIZE) || defined(__DOXYGEN__)
+#define NVM_MIRROR_ASYNC_THREAD_STACK_SIZE  512
+#endif
+
+/**
+ * @brief   Background propagation thread priority.
+ */
+#if !defined(NVM_MIRROR_ASYNC_THREAD_PRIO) || defined(__DOXYGEN__)
+#define NVM_MIRROR_ASYNC_THREAD_PRIO        LOWPRIO
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if NVM_MIRROR_COPY_BUFFER_SIZE < 8 || (NVM_MIRROR_COPY_BUFFER_SIZE % 8) != 0
+#error "NVM_MIRROR_COPY_BUFFER_SIZE must be a non zero multiple of 8"
+#endif
+
+#if NVM_MIRROR_USE_ASYNC && !defined(_CHIBIOS_RT_)
+#error "NVM_MIRROR_USE_ASYNC requires ChibiOS/RT"
+#endif
+
+#if NVM_MIRROR_USE_RW_LOCK && !NVM_MIRROR_USE_MUTUAL_EXCLUSION
+#error "NVM_MIRROR_USE_RW_LOCK requires NVM_MIRROR_USE_MUTUAL_EXCLUSION"
+#endif
+
+/* Note: Only one reader at a time can wait for the background thread. */
+#if NVM_MIRROR_USE_RW_LOCK && NVM_MIRROR_USE_ASYNC
+#error "NVM_MIRROR_USE_RW_LOCK can not be used with NVM_MIRROR_USE_ASYNC"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -67,6 +149,13 @@ typedef struct
      * @brief number of sectors to assign to metadata header
      */
     uint32_t sector_header_num;
+    /**
+    * @brief Optional separate NVM driver holding mirror b.
+    * @details If set, @p nvmp holds the header and mirror a while mirror b
+    *          starts at address 0 of this device. Both devices must have
+    *          the same sector size. NULL places both mirrors on @p nvmp.
+    */
+    BaseNVMDevice* nvmp_b;
 } NVMMirrorConfig;
 
 /**
@@ -126,6 +215,12 @@ typedef struct
     */
     uint32_t mirror_state_addr;
     /**
+    * @brief First sector and number of sectors which might differ between
+    *        the mirrors while not synced.
+    */
+    uint32_t mirror_dirty_first;
+    uint32_t mirror_dirty_num;
+    /**
     * @brief Mirror size cached for performance.
     */
     uint32_t mirror_size;
@@ -137,11 +232,79 @@ typedef struct
     * @brief Origin address of mirror b cached for performance.
     */
     uint32_t mirror_b_org;
+    /**
+    * @brief Device holding mirror b.
+    */
+    BaseNVMDevice* mirror_b_nvmp;
+    /**
+    * @brief Operations on a separate mirror b device not yet synced.
+    */
+    bool mirror_b_pending;
+    /**
+    * @brief Next read is served from mirror b.
+    */
+    bool mirror_b_read;
+    /**
+    * @brief Buffers for source and destination data while copying.
+    */
+    uint8_t copy_src[NVM_MIRROR_COPY_BUFFER_SIZE];
+    uint8_t copy_dst[NVM_MIRROR_COPY_BUFFER_SIZE];
+#if NVM_MIRROR_USE_TRANSACTION || defined(__DOXYGEN__)
+    /**
+    * @brief Transaction in progress.
+    */
+    bool transaction;
+    /**
+    * @brief First sector and number of sectors changed by the transaction.
+    */
+    uint32_t transaction_first;
+    uint32_t transaction_num;
+#endif /* NVM_MIRROR_USE_TRANSACTION */
+#if NVM_MIRROR_USE_ASYNC || defined(__DOXYGEN__)
+    /**
+    * @brief Pointer to the propagation thread.
+    */
+    thread_reference_t async_tr;
+    /**
+    * @brief Propagation thread while waiting for work or @p NULL.
+    */
+    thread_reference_t async_wait;
+    /**
+    * @brief Thread waiting for propagation to finish or @p NULL.
+    */
+    thread_reference_t async_done;
+    /**
+    * @brief Operation queued for mirror b.
+    */
+    bool async_queued;
+    bool async_erase;
+    uint32_t async_addr;
+    uint32_t async_n;
+    /**
+    * @brief Result of the last propagation.
+    */
+    bool async_result;
+    /**
+    * @brief Data of the queued write.
+    */
+    uint8_t async_buffer[NVM_MIRROR_ASYNC_BUFFER_SIZE];
+    /**
+    * @brief Working area for the propagation thread.
+    */
+    THD_WORKING_AREA(wa_async, NVM_MIRROR_ASYNC_THREAD_STACK_SIZE);
+#endif /* NVM_MIRROR_USE_ASYNC */
 #if NVM_MIRROR_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if NVM_MIRROR_USE_RW_LOCK || defined(__DOXYGEN__)
+    /**
+     * @brief rwlock_t protecting the device.
+     */
+    rwlock_t lock;
+#else
     /**
      * @brief mutex_t protecting the device.
      */
     mutex_t mutex;
+#endif /* NVM_MIRROR_USE_RW_LOCK */
 #endif /* NVM_MIRROR_USE_MUTUAL_EXCLUSION */
 } NVMMirrorDriver;
 
@@ -171,16 +334,31 @@ extern "C" {
             uint32_t n);
     bool nvmmirrorMassErase(NVMMirrorDriver* nvmmirrorp);
     bool nvmmirrorSync(NVMMirrorDriver* nvmmirrorp);
+#if NVM_MIRROR_USE_TRANSACTION || defined(__DOXYGEN__)
+    bool nvmmirrorTransactionBegin(NVMMirrorDriver* nvmmirrorp);
+    bool nvmmirrorTransactionCommit(NVMMirrorDriver* nvmmirrorp);
+    bool nvmmirrorTransactionAbort(NVMMirrorDriver* nvmmirrorp);
+#endif /* NVM_MIRROR_USE_TRANSACTION */
+    bool nvmmirrorGetCopy(NVMMirrorDriver* nvmmirrorp, bool mirror_b,
+            BaseNVMDevice** nvmpp, uint32_t* orgp);
+    bool nvmmirrorRepair(NVMMirrorDriver* nvmmirrorp, uint32_t startaddr,
+            uint32_t n, bool from_b);
     bool nvmmirrorGetInfo(NVMMirrorDriver* nvmmirrorp,
             NVMDeviceInfo* nvmdip);
     void nvmmirrorAcquireBus(NVMMirrorDriver* nvmmirrorp);
     void nvmmirrorReleaseBus(NVMMirrorDriver* nvmmirrorp);
+    void nvmmirrorAcquireBusShared(NVMMirrorDriver* nvmmirrorp);
+    void nvmmirrorReleaseBusShared(NVMMirrorDriver* nvmmirrorp);
     bool nvmmirrorWriteProtect(NVMMirrorDriver* nvmmirrorp,
             uint32_t startaddr, uint32_t n);
     bool nvmmirrorMassWriteProtect(NVMMirrorDriver* nvmmirrorp);
     bool nvmmirrorWriteUnprotect(NVMMirrorDriver* nvmmirrorp,
             uint32_t startaddr, uint32_t n);
     bool nvmmirrorMassWriteUnprotect(NVMMirrorDriver* nvmmirrorp);
+    bool nvmmirrorReadv(NVMMirrorDriver* nvmmirrorp,
+            const NVMReadSegment* segp, uint32_t segn);
+    bool nvmmirrorWritev(NVMMirrorDriver* nvmmirrorp,
+            const NVMWriteSegment* segp, uint32_t segn);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,240 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_nor_sim.h
+ * @brief   NVM simulated NOR flash driver header.
+ *
+ * @addtogroup NVM_NOR_SIM
+ * @{
+ */
+
+#ifndef _QNVM_NOR_SIM_H_
+#define _QNVM_NOR_SIM_H_
+
+#if HAL_USE_NVM_NOR_SIM || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_NOR_SIM configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the @p nvmnorsimAcquireBus() and
+ *          @p nvmnorsimReleaseBus() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_NOR_SIM_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define NVM_NOR_SIM_USE_MUTUAL_EXCLUSION      TRUE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated NOR flash driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief Pointer to memory block holding the flash contents.
+    */
+    uint8_t* memoryp;
+    /**
+     * @brief Smallest erasable sector size in bytes.
+     */
+    uint32_t sector_size;
+    /**
+     * @brief Total number of sectors.
+     */
+    uint32_t sector_num;
+    /**
+     * @brief Page size in bytes, programming is split at page boundaries.
+     */
+    uint32_t page_size;
+    /**
+     * @brief Required write alignment in bytes, 0 for none.
+     */
+    uint32_t write_alignment;
+    /**
+     * @brief Time charged per byte read in ns.
+     */
+    uint32_t read_byte_ns;
+    /**
+     * @brief Time charged per page program in ns.
+     */
+    uint32_t page_program_ns;
+    /**
+     * @brief Time charged per sector erase in ns.
+     */
+    uint32_t sector_erase_ns;
+    /**
+     * @brief Writes setting erased bits fail instead of being ANDed.
+     */
+    bool strict;
+    /**
+     * @brief Optional array of @p sector_num erase counters or @p NULL.
+     */
+    uint32_t* erase_counters;
+    /**
+     * @brief Operations sleep for the charged time.
+     * @details The system time then follows the flash timing, which the
+     *          simulator virtual time mode runs through without waiting.
+     */
+    bool sleep;
+} NVMNorSimConfig;
+
+/**
+ * @brief   Simulated NOR flash statistics.
+ */
+typedef struct
+{
+    /**
+     * @brief Virtual time consumed by all operations in ns.
+     */
+    uint64_t time_ns;
+    /**
+     * @brief Number of reads and bytes read.
+     */
+    uint32_t reads;
+    uint32_t bytes_read;
+    /**
+     * @brief Number of page programs and bytes programmed.
+     */
+    uint32_t page_programs;
+    uint32_t bytes_programmed;
+    /**
+     * @brief Number of sector erases.
+     */
+    uint32_t sector_erases;
+    /**
+     * @brief Writes which tried to set programmed bits.
+     */
+    uint32_t violations;
+} NVMNorSimStats;
+
+/**
+ * @brief   @p NVMNorSimDriver specific methods.
+ */
+#define _nvm_nor_sim_driver_methods                                           \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMNorSimDriver virtual methods table.
+ */
+struct NVMNorSimDriverVMT
+{
+    _nvm_nor_sim_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a simulated NOR flash driver.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMNorSimDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMNorSimConfig* config;
+    /**
+    * @brief Virtual time since start in ns.
+    */
+    uint64_t time_ns;
+    /**
+    * @brief Charged time not slept yet in ns.
+    */
+    uint64_t sleep_ns;
+    /**
+    * @brief Statistics accumulated since start or the last reset.
+    */
+    NVMNorSimStats stats;
+#if NVM_NOR_SIM_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* NVM_NOR_SIM_USE_MUTUAL_EXCLUSION */
+} NVMNorSimDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmnorsimInit(void);
+    void nvmnorsimObjectInit(NVMNorSimDriver* nvmnorsimp);
+    void nvmnorsimStart(NVMNorSimDriver* nvmnorsimp,
+            const NVMNorSimConfig* config);
+    void nvmnorsimStop(NVMNorSimDriver* nvmnorsimp);
+    bool nvmnorsimRead(NVMNorSimDriver* nvmnorsimp, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmnorsimWrite(NVMNorSimDriver* nvmnorsimp, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmnorsimErase(NVMNorSimDriver* nvmnorsimp, uint32_t startaddr,
+            uint32_t n);
+    bool nvmnorsimMassErase(NVMNorSimDriver* nvmnorsimp);
+    bool nvmnorsimSync(NVMNorSimDriver* nvmnorsimp);
+    bool nvmnorsimGetInfo(NVMNorSimDriver* nvmnorsimp,
+            NVMDeviceInfo* nvmdip);
+    void nvmnorsimAcquireBus(NVMNorSimDriver* nvmnorsimp);
+    void nvmnorsimReleaseBus(NVMNorSimDriver* nvmnorsimp);
+    bool nvmnorsimWriteProtect(NVMNorSimDriver* nvmnorsimp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmnorsimMassWriteProtect(NVMNorSimDriver* nvmnorsimp);
+    bool nvmnorsimWriteUnprotect(NVMNorSimDriver* nvmnorsimp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmnorsimMassWriteUnprotect(NVMNorSimDriver* nvmnorsimp);
+    void nvmnorsimGetStats(NVMNorSimDriver* nvmnorsimp,
+            NVMNorSimStats* statsp);
+    void nvmnorsimResetStats(NVMNorSimDriver* nvmnorsimp);
+    uint64_t nvmnorsimGetTime(NVMNorSimDriver* nvmnorsimp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_NOR_SIM */
+
+#endif /* _QNVM_NOR_SIM_H_ */
+
+/** @} */
@@ -25,6 +25,8 @@
 
 #if HAL_USE_NVM_PARTITION || defined(__DOXYGEN__)
 
+#include "qrwlock.h"
+
 /*===========================================================================*/
 /* Driver constants.                                                         */
 /*===========================================================================*/
@@ -44,12 +46,36 @@
 #if !defined(NVM_PARTITION_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define NVM_PARTITION_USE_MUTUAL_EXCLUSION     TRUE
 #endif
+
+/**
+ * @brief   Lets readers share the partition.
+ * @details The mutex is replaced by a readers-writer lock and the
+ *          @p nvmpartAcquireBusShared() and @p nvmpartReleaseBusShared()
+ *          APIs are enabled, the lower device is acquired for reading too.
+ */
+#if !defined(NVM_PARTITION_USE_RW_LOCK) || defined(__DOXYGEN__)
+#define NVM_PARTITION_USE_RW_LOCK              FALSE
+#endif
+
+/**
+ * @brief   Driver all partitions reside on.
+ * @details Function prefix of the driver, e.g. @p flash, binds reads,
+ *          writes, erases and syncs at compile time. With the default
+ *          @p NVM_LLD_DYNAMIC any driver can be used.
+ */
+#if !defined(NVM_PARTITION_LLD) || defined(__DOXYGEN__)
+#define NVM_PARTITION_LLD                      NVM_LLD_DYNAMIC
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if NVM_PARTITION_USE_RW_LOCK && !NVM_PARTITION_USE_MUTUAL_EXCLUSION
+#error "NVM_PARTITION_USE_RW_LOCK requires NVM_PARTITION_USE_MUTUAL_EXCLUSION"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -118,10 +144,17 @@ typedef struct
     */
     uint32_t part_size;
 #if NVM_PARTITION_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if NVM_PARTITION_USE_RW_LOCK || defined(__DOXYGEN__)
+    /**
+     * @brief rwlock_t protecting the device.
+     */
+    rwlock_t lock;
+#else
     /**
      * @brief mutex_t protecting the device.
      */
     mutex_t mutex;
+#endif /* NVM_PARTITION_USE_RW_LOCK */
 #endif /* NVM_PARTITION_USE_MUTUAL_EXCLUSION */
 } NVMPartitionDriver;
 
@@ -154,12 +187,22 @@ extern "C" {
     bool nvmpartGetInfo(NVMPartitionDriver* nvmpartp, NVMDeviceInfo* nvmdip);
     void nvmpartAcquireBus(NVMPartitionDriver* nvmpartp);
     void nvmpartReleaseBus(NVMPartitionDriver* nvmpartp);
+    void nvmpartAcquireBusShared(NVMPartitionDriver* nvmpartp);
+    void nvmpartReleaseBusShared(NVMPartitionDriver* nvmpartp);
     bool nvmpartWriteProtect(NVMPartitionDriver* nvmpartp,
             uint32_t startaddr, uint32_t n);
     bool nvmpartMassWriteProtect(NVMPartitionDriver* nvmpartp);
     bool nvmpartWriteUnprotect(NVMPartitionDriver* nvmpartp,
             uint32_t startaddr, uint32_t n);
     bool nvmpartMassWriteUnprotect(NVMPartitionDriver* nvmpartp);
+    bool nvmpartReadv(NVMPartitionDriver* nvmpartp,
+            const NVMReadSegment* segp, uint32_t segn);
+    bool nvmpartWritev(NVMPartitionDriver* nvmpartp,
+            const NVMWriteSegment* segp, uint32_t segn);
+    bool nvmpartIsErased(NVMPartitionDriver* nvmpartp, uint32_t startaddr,
+            uint32_t n, bool* erasedp);
+    bool nvmpartMap(NVMPartitionDriver* nvmpartp, uint32_t startaddr,
+            uint32_t n, const uint8_t** ptrp);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,254 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_read_ahead.h
+ * @brief   NVM read ahead driver header.
+ *
+ * @addtogroup NVM_READ_AHEAD
+ * @{
+ */
+
+#ifndef _QNVM_READ_AHEAD_H_
+#define _QNVM_READ_AHEAD_H_
+
+#if HAL_USE_NVM_READ_AHEAD || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_READ_AHEAD configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the @p nvmraheadAcquireBus() and @p nvmraheadReleaseBus()
+ *          APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION     TRUE
+#endif
+
+/**
+ * @brief   Size of a read ahead buffer.
+ * @details Limits the largest window being configured.
+ */
+#if !defined(NVM_READ_AHEAD_SIZE) || defined(__DOXYGEN__)
+#define NVM_READ_AHEAD_SIZE                     1024
+#endif
+
+/**
+ * @brief   Fetches the next window in the background.
+ * @details Adds a second buffer. While the application consumes one window
+ *          the next one is read by a request started on the underlying
+ *          device. Underlying devices not serving requests natively are
+ *          read synchronously.
+ */
+#if !defined(NVM_READ_AHEAD_USE_ASYNC) || defined(__DOXYGEN__)
+#define NVM_READ_AHEAD_USE_ASYNC                FALSE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_READ_AHEAD_SIZE < 1
+#error "NVM_READ_AHEAD_SIZE must be at least 1"
+#endif
+
+/**
+ * @brief   Number of read ahead buffers.
+ */
+#if NVM_READ_AHEAD_USE_ASYNC || defined(__DOXYGEN__)
+#define NVM_READ_AHEAD_BUFFERS                  2
+#else
+#define NVM_READ_AHEAD_BUFFERS                  1
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM read ahead driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief NVM driver associated to this read ahead driver.
+    */
+    BaseNVMDevice* nvmp;
+    /**
+    * @brief Number of bytes fetched at once.
+    * @details 0 selects @p NVM_READ_AHEAD_SIZE.
+    */
+    uint32_t window;
+    /**
+    * @brief Consecutive reads detected before reading ahead.
+    * @details A read is consecutive if it starts where the previous read
+    *          ended. 0 reads ahead on any read.
+    */
+    uint32_t trigger;
+} NVMReadAheadConfig;
+
+/**
+ * @brief   Read ahead buffer.
+ */
+typedef struct
+{
+    /**
+    * @brief Address of the first buffered byte.
+    */
+    uint32_t addr;
+    /**
+    * @brief Number of buffered bytes, 0 if empty.
+    */
+    uint32_t n;
+#if NVM_READ_AHEAD_USE_ASYNC || defined(__DOXYGEN__)
+    /**
+    * @brief Buffer is being filled by @p req.
+    */
+    bool pending;
+    /**
+    * @brief Request filling the buffer.
+    */
+    NVMRequest req;
+#endif /* NVM_READ_AHEAD_USE_ASYNC */
+    /**
+    * @brief Buffered data.
+    */
+    uint8_t data[NVM_READ_AHEAD_SIZE];
+} NVMReadAheadBuffer;
+
+/**
+ * @brief   @p NVMReadAheadDriver specific methods.
+ */
+#define _nvm_read_ahead_driver_methods                                        \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMReadAheadDriver virtual methods table.
+ */
+struct NVMReadAheadDriverVMT
+{
+    _nvm_read_ahead_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a NVM read ahead driver.
+ * @details Detects sequential reads and fetches the following data in
+ *          windows, so a stream of small reads results in few large reads
+ *          of the underlying device.
+ * @note    With @p NVM_READ_AHEAD_USE_ASYNC a read of the underlying device
+ *          may be pending between calls. The underlying device must accept
+ *          other operations meanwhile, e.g. when it is only used through
+ *          this driver or is a @p NVMSchedDriver.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMReadAheadDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMReadAheadConfig* config;
+    /**
+    * @brief Device info of underlying nvm device.
+    */
+    NVMDeviceInfo llnvmdi;
+    /**
+    * @brief Device size in bytes.
+    */
+    uint32_t ra_size;
+    /**
+    * @brief Window size cached for performance.
+    */
+    uint32_t ra_window;
+    /**
+    * @brief Address following the previous read.
+    */
+    uint32_t ra_next;
+    /**
+    * @brief Number of consecutive reads so far.
+    */
+    uint32_t ra_seq;
+    /**
+    * @brief Read ahead buffers.
+    */
+    NVMReadAheadBuffer bufs[NVM_READ_AHEAD_BUFFERS];
+#if NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION */
+} NVMReadAheadDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmraheadInit(void);
+    void nvmraheadObjectInit(NVMReadAheadDriver* nvmraheadp);
+    void nvmraheadStart(NVMReadAheadDriver* nvmraheadp,
+            const NVMReadAheadConfig* config);
+    void nvmraheadStop(NVMReadAheadDriver* nvmraheadp);
+    bool nvmraheadRead(NVMReadAheadDriver* nvmraheadp, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmraheadWrite(NVMReadAheadDriver* nvmraheadp, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmraheadErase(NVMReadAheadDriver* nvmraheadp, uint32_t startaddr,
+            uint32_t n);
+    bool nvmraheadMassErase(NVMReadAheadDriver* nvmraheadp);
+    bool nvmraheadSync(NVMReadAheadDriver* nvmraheadp);
+    bool nvmraheadGetInfo(NVMReadAheadDriver* nvmraheadp,
+            NVMDeviceInfo* nvmdip);
+    void nvmraheadAcquireBus(NVMReadAheadDriver* nvmraheadp);
+    void nvmraheadReleaseBus(NVMReadAheadDriver* nvmraheadp);
+    bool nvmraheadWriteProtect(NVMReadAheadDriver* nvmraheadp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmraheadMassWriteProtect(NVMReadAheadDriver* nvmraheadp);
+    bool nvmraheadWriteUnprotect(NVMReadAheadDriver* nvmraheadp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmraheadMassWriteUnprotect(NVMReadAheadDriver* nvmraheadp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_READ_AHEAD */
+
+#endif /* _QNVM_READ_AHEAD_H_ */
+
+/** @} */
@@ -0,0 +1,229 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_sched.h
+ * @brief   NVM I/O scheduler driver header.
+ *
+ * @addtogroup NVM_SCHED
+ * @{
+ */
+
+#ifndef _QNVM_SCHED_H_
+#define _QNVM_SCHED_H_
+
+#if HAL_USE_NVM_SCHED || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_SCHED configuration options
+ * @{
+ */
+/**
+ * @brief   Read batches served in a row while writes or erases wait.
+ * @details Reads take precedence over writes and erases, after this many
+ *          read batches one write or erase step is served.
+ */
+#if !defined(NVM_SCHED_READ_BURST) || defined(__DOXYGEN__)
+#define NVM_SCHED_READ_BURST                8
+#endif
+
+/**
+ * @brief   Worker thread stack size.
+ */
+#if !defined(NVM_SCHED_THREAD_STACK_SIZE) || defined(__DOXYGEN__)
+#define NVM_SCHED_THREAD_STACK_SIZE         512
+#endif
+
+/**
+ * @brief   Worker thread priority.
+ */
+#if !defined(NVM_SCHED_THREAD_PRIO) || defined(__DOXYGEN__)
+#define NVM_SCHED_THREAD_PRIO               NORMALPRIO
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_SCHED_READ_BURST < 1
+#error "NVM_SCHED_READ_BURST must be at least 1"
+#endif
+
+#if !defined(_CHIBIOS_RT_)
+#error "NVM_SCHED requires ChibiOS/RT"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM I/O scheduler driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief NVM driver shared by the clients.
+    */
+    BaseNVMDevice* nvmp;
+} NVMSchedConfig;
+
+/**
+ * @brief   Queue of requests in order of submission.
+ */
+typedef struct
+{
+    NVMRequest* head;
+    NVMRequest* tail;
+} NVMSchedQueue;
+
+/**
+ * @brief   @p NVMSchedDriver specific methods.
+ */
+#define _nvm_sched_driver_methods                                             \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMSchedDriver virtual methods table.
+ */
+struct NVMSchedDriverVMT
+{
+    _nvm_sched_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a NVM I/O scheduler driver.
+ * @details Serves the reads, writes and erases of all clients of a device
+ *          from one worker thread. Adjacent requests are merged into
+ *          vectored calls, reads are served before writes and erases and
+ *          erases are split at sector boundaries so reads can be served in
+ *          between.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMSchedDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMSchedConfig* config;
+    /**
+    * @brief Device info of underlying nvm device.
+    */
+    NVMDeviceInfo llnvmdi;
+    /**
+    * @brief Pointer to the worker thread.
+    */
+    thread_reference_t tr;
+    /**
+    * @brief Worker thread while waiting for requests or @p NULL.
+    */
+    thread_reference_t wait;
+    /**
+    * @brief Pending reads.
+    */
+    NVMSchedQueue reads;
+    /**
+    * @brief Pending writes, erases and syncs, served in order.
+    */
+    NVMSchedQueue writes;
+    /**
+    * @brief Bytes of the erase at the head of @p writes already served.
+    */
+    uint32_t erase_offset;
+    /**
+    * @brief Read batches served since the last write or erase.
+    */
+    uint32_t read_burst;
+    /**
+    * @brief Requests merged into the current batch.
+    */
+    NVMRequest* batch[NVM_SEGMENT_BATCH_SIZE];
+    /**
+    * @brief Segments of the current batch.
+    */
+    union
+    {
+        NVMReadSegment read[NVM_SEGMENT_BATCH_SIZE];
+        NVMWriteSegment write[NVM_SEGMENT_BATCH_SIZE];
+    } segs;
+    /**
+    * @brief Working area for the worker thread.
+    */
+    THD_WORKING_AREA(wa, NVM_SCHED_THREAD_STACK_SIZE);
+} NVMSchedDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmschedInit(void);
+    void nvmschedObjectInit(NVMSchedDriver* nvmschedp);
+    void nvmschedStart(NVMSchedDriver* nvmschedp,
+            const NVMSchedConfig* config);
+    void nvmschedStop(NVMSchedDriver* nvmschedp);
+    bool nvmschedRead(NVMSchedDriver* nvmschedp, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmschedWrite(NVMSchedDriver* nvmschedp, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmschedErase(NVMSchedDriver* nvmschedp, uint32_t startaddr,
+            uint32_t n);
+    bool nvmschedMassErase(NVMSchedDriver* nvmschedp);
+    bool nvmschedSync(NVMSchedDriver* nvmschedp);
+    bool nvmschedGetInfo(NVMSchedDriver* nvmschedp, NVMDeviceInfo* nvmdip);
+    void nvmschedAcquireBus(NVMSchedDriver* nvmschedp);
+    void nvmschedReleaseBus(NVMSchedDriver* nvmschedp);
+    bool nvmschedWriteProtect(NVMSchedDriver* nvmschedp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmschedMassWriteProtect(NVMSchedDriver* nvmschedp);
+    bool nvmschedWriteUnprotect(NVMSchedDriver* nvmschedp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmschedMassWriteUnprotect(NVMSchedDriver* nvmschedp);
+    bool nvmschedReadv(NVMSchedDriver* nvmschedp,
+            const NVMReadSegment* segp, uint32_t segn);
+    bool nvmschedWritev(NVMSchedDriver* nvmschedp,
+            const NVMWriteSegment* segp, uint32_t segn);
+    bool nvmschedStartRequest(NVMSchedDriver* nvmschedp, NVMRequest* reqp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_SCHED */
+
+#endif /* _QNVM_SCHED_H_ */
+
+/** @} */
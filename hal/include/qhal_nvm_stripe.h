@@ -0,0 +1,213 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_stripe.h
+ * @brief   NVM stripe driver header.
+ *
+ * @addtogroup NVM_STRIPE
+ * @{
+ */
+
+#ifndef _QNVM_STRIPE_H_
+#define _QNVM_STRIPE_H_
+
+#if HAL_USE_NVM_STRIPE || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_STRIPE configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the @p nvmstripeAcquireBus() and @p nvmstripeReleaseBus()
+ *          APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_STRIPE_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define NVM_STRIPE_USE_MUTUAL_EXCLUSION     TRUE
+#endif
+
+/**
+ * @brief   Maximum number of devices striped by a single driver.
+ */
+#if !defined(NVM_STRIPE_DEVICES_MAX) || defined(__DOXYGEN__)
+#define NVM_STRIPE_DEVICES_MAX              4
+#endif
+
+/**
+ * @brief   Serves writes and erases through a @p NVMAsyncDriver.
+ * @details Writes and erases are submitted to all devices before waiting
+ *          for any of them. Otherwise they are issued to the devices in
+ *          turn, which overlaps as far as the devices return while busy.
+ */
+#if !defined(NVM_STRIPE_USE_ASYNC) || defined(__DOXYGEN__)
+#define NVM_STRIPE_USE_ASYNC                FALSE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_STRIPE_DEVICES_MAX < 1
+#error "NVM_STRIPE_DEVICES_MAX must be at least 1"
+#endif
+
+#if NVM_STRIPE_USE_ASYNC && !HAL_USE_NVM_ASYNC
+#error "NVM_STRIPE_USE_ASYNC requires HAL_USE_NVM_ASYNC"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Non volatile memory stripe driver configuration structure.
+ * @details Consecutive stripes of @p stripe_size bytes are placed on the
+ *          devices in turn. All devices must report the same geometry.
+ */
+typedef struct
+{
+    /**
+    * @brief NVM drivers being striped.
+    */
+    BaseNVMDevice* const* nvmps;
+    /**
+    * @brief Number of NVM drivers being striped.
+    */
+    uint32_t nvm_num;
+    /**
+     * @brief Stripe size in bytes.
+     * Must be a power of two, either a multiple or a divisor of the sector
+     * size of the devices.
+     */
+    uint32_t stripe_size;
+#if NVM_STRIPE_USE_ASYNC || defined(__DOXYGEN__)
+    /**
+    * @brief Started NVM async driver serving writes and erases or NULL.
+    */
+    NVMAsyncDriver* asyncp;
+#endif /* NVM_STRIPE_USE_ASYNC */
+} NVMStripeConfig;
+
+/**
+ * @brief   @p NVMStripeDriver specific methods.
+ */
+#define _nvm_stripe_driver_methods                                            \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMStripeDriver virtual methods table.
+ */
+struct NVMStripeDriverVMT
+{
+    _nvm_stripe_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a NVM stripe driver.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMStripeDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMStripeConfig* config;
+    /**
+    * @brief Device info of the first underlying nvm device.
+    */
+    NVMDeviceInfo llnvmdi;
+    /**
+    * @brief Sector size of the striped device.
+    */
+    uint32_t sector_size;
+    /**
+    * @brief Total size of the striped device in bytes.
+    */
+    uint32_t size;
+#if NVM_STRIPE_USE_ASYNC || defined(__DOXYGEN__)
+    /**
+    * @brief Requests submitted to the async driver, one per device.
+    */
+    NVMRequest requests[NVM_STRIPE_DEVICES_MAX];
+#endif /* NVM_STRIPE_USE_ASYNC */
+#if NVM_STRIPE_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* NVM_STRIPE_USE_MUTUAL_EXCLUSION */
+} NVMStripeDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmstripeInit(void);
+    void nvmstripeObjectInit(NVMStripeDriver* nvmstripep);
+    void nvmstripeStart(NVMStripeDriver* nvmstripep,
+            const NVMStripeConfig* config);
+    void nvmstripeStop(NVMStripeDriver* nvmstripep);
+    bool nvmstripeRead(NVMStripeDriver* nvmstripep, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmstripeWrite(NVMStripeDriver* nvmstripep, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmstripeErase(NVMStripeDriver* nvmstripep, uint32_t startaddr,
+            uint32_t n);
+    bool nvmstripeMassErase(NVMStripeDriver* nvmstripep);
+    bool nvmstripeSync(NVMStripeDriver* nvmstripep);
+    bool nvmstripeGetInfo(NVMStripeDriver* nvmstripep, NVMDeviceInfo* nvmdip);
+    void nvmstripeAcquireBus(NVMStripeDriver* nvmstripep);
+    void nvmstripeReleaseBus(NVMStripeDriver* nvmstripep);
+    bool nvmstripeWriteProtect(NVMStripeDriver* nvmstripep,
+            uint32_t startaddr, uint32_t n);
+    bool nvmstripeMassWriteProtect(NVMStripeDriver* nvmstripep);
+    bool nvmstripeWriteUnprotect(NVMStripeDriver* nvmstripep,
+            uint32_t startaddr, uint32_t n);
+    bool nvmstripeMassWriteUnprotect(NVMStripeDriver* nvmstripep);
+    bool nvmstripeIsErased(NVMStripeDriver* nvmstripep, uint32_t startaddr,
+            uint32_t n, bool* erasedp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_STRIPE */
+
+#endif /* _QNVM_STRIPE_H_ */
+
+/** @} */
@@ -0,0 +1,238 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_trace.h
+ * @brief   NVM trace driver header.
+ *
+ * @addtogroup NVM_TRACE
+ * @{
+ */
+
+#ifndef _QNVM_TRACE_H_
+#define _QNVM_TRACE_H_
+
+#if HAL_USE_NVM_TRACE || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_TRACE configuration options
+ * @{
+ */
+/**
+ * @brief   Measures latencies in core cycles using the DWT cycle counter.
+ * @details The system tick is used otherwise, which is too coarse for
+ *          operations on memory mapped devices.
+ */
+#if !defined(NVM_TRACE_USE_DWT) || defined(__DOXYGEN__)
+#define NVM_TRACE_USE_DWT                   FALSE
+#endif
+
+/**
+ * @brief   Number of latency histogram bins per operation.
+ * @details Bin 0 counts calls without measurable latency, bin i counts
+ *          latencies from 2^(i-1) up to 2^i - 1 and the last bin counts
+ *          all longer calls.
+ */
+#if !defined(NVM_TRACE_HISTOGRAM_BINS) || defined(__DOXYGEN__)
+#define NVM_TRACE_HISTOGRAM_BINS            16
+#endif
+
+/**
+ * @brief   Right shift applied to latencies before binning.
+ * @details Allows covering long operations when measuring in cycles.
+ */
+#if !defined(NVM_TRACE_HISTOGRAM_SHIFT) || defined(__DOXYGEN__)
+#define NVM_TRACE_HISTOGRAM_SHIFT           0
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_TRACE_HISTOGRAM_BINS < 1 || NVM_TRACE_HISTOGRAM_BINS > 33
+#error "NVM_TRACE_HISTOGRAM_BINS must be within 1 and 33"
+#endif
+
+#if NVM_TRACE_HISTOGRAM_SHIFT < 0 || NVM_TRACE_HISTOGRAM_SHIFT > 31
+#error "NVM_TRACE_HISTOGRAM_SHIFT must be within 0 and 31"
+#endif
+
+#if NVM_TRACE_USE_DWT && !defined(DWT_CTRL_CYCCNTENA_Msk)
+#error "NVM_TRACE_USE_DWT requires a core providing the DWT cycle counter"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM trace driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief NVM driver being traced.
+    */
+    BaseNVMDevice* nvmp;
+} NVMTraceConfig;
+
+/**
+ * @brief   Statistics of a single operation type.
+ */
+typedef struct
+{
+    /**
+     * @brief Number of calls.
+     */
+    uint32_t calls;
+    /**
+     * @brief Number of calls which failed.
+     */
+    uint32_t failures;
+    /**
+     * @brief Bytes passed to the calls.
+     */
+    uint32_t bytes;
+    /**
+     * @brief Cumulative latency in ticks or cycles.
+     */
+    uint64_t time_total;
+    /**
+     * @brief Longest latency in ticks or cycles.
+     */
+    uint32_t time_max;
+    /**
+     * @brief Latency histogram.
+     */
+    uint32_t histogram[NVM_TRACE_HISTOGRAM_BINS];
+} NVMTraceOpStats;
+
+/**
+ * @brief   NVM trace statistics.
+ * @note    Vectored calls are accounted as single calls of the respective
+ *          operation, mass erases are accounted as erases of the whole
+ *          device.
+ */
+typedef struct
+{
+    NVMTraceOpStats read;
+    NVMTraceOpStats write;
+    NVMTraceOpStats erase;
+    NVMTraceOpStats sync;
+} NVMTraceStats;
+
+/**
+ * @brief   @p NVMTraceDriver specific methods.
+ */
+#define _nvm_trace_driver_methods                                             \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMTraceDriver virtual methods table.
+ */
+struct NVMTraceDriverVMT
+{
+    _nvm_trace_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a NVM trace driver.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMTraceDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMTraceConfig* config;
+    /**
+    * @brief Device info of underlying nvm device.
+    */
+    NVMDeviceInfo llnvmdi;
+    /**
+    * @brief Statistics accumulated since start or the last reset.
+    */
+    NVMTraceStats stats;
+} NVMTraceDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmtraceInit(void);
+    void nvmtraceObjectInit(NVMTraceDriver* nvmtracep);
+    void nvmtraceStart(NVMTraceDriver* nvmtracep,
+            const NVMTraceConfig* config);
+    void nvmtraceStop(NVMTraceDriver* nvmtracep);
+    bool nvmtraceRead(NVMTraceDriver* nvmtracep, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmtraceWrite(NVMTraceDriver* nvmtracep, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmtraceErase(NVMTraceDriver* nvmtracep, uint32_t startaddr,
+            uint32_t n);
+    bool nvmtraceMassErase(NVMTraceDriver* nvmtracep);
+    bool nvmtraceSync(NVMTraceDriver* nvmtracep);
+    bool nvmtraceGetInfo(NVMTraceDriver* nvmtracep,
+            NVMDeviceInfo* nvmdip);
+    void nvmtraceAcquireBus(NVMTraceDriver* nvmtracep);
+    void nvmtraceReleaseBus(NVMTraceDriver* nvmtracep);
+    bool nvmtraceWriteProtect(NVMTraceDriver* nvmtracep,
+            uint32_t startaddr, uint32_t n);
+    bool nvmtraceMassWriteProtect(NVMTraceDriver* nvmtracep);
+    bool nvmtraceWriteUnprotect(NVMTraceDriver* nvmtracep,
+            uint32_t startaddr, uint32_t n);
+    bool nvmtraceMassWriteUnprotect(NVMTraceDriver* nvmtracep);
+    bool nvmtraceReadv(NVMTraceDriver* nvmtracep,
+            const NVMReadSegment* segp, uint32_t segn);
+    bool nvmtraceWritev(NVMTraceDriver* nvmtracep,
+            const NVMWriteSegment* segp, uint32_t segn);
+    bool nvmtraceIsErased(NVMTraceDriver* nvmtracep, uint32_t startaddr,
+            uint32_t n, bool* erasedp);
+    void nvmtraceGetStats(NVMTraceDriver* nvmtracep, NVMTraceStats* statsp);
+    void nvmtraceResetStats(NVMTraceDriver* nvmtracep);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_TRACE */
+
+#endif /* _QNVM_TRACE_H_ */
+
+/** @} */
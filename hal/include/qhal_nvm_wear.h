@@ -0,0 +1,251 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_wear.h
+ * @brief   NVM wear monitor driver header.
+ *
+ * @addtogroup NVM_WEAR
+ * @{
+ */
+
+#ifndef _QNVM_WEAR_H_
+#define _QNVM_WEAR_H_
+
+#if HAL_USE_NVM_WEAR || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Magic identifying a snapshot of the erase counters.
+ */
+#define NVM_WEAR_MAGIC                      0x5241454eUL
+
+/**
+ * @brief   Size of a snapshot header.
+ */
+#define NVM_WEAR_HEADER_SIZE                16
+
+/**
+ * @brief   Number of areas holding snapshots.
+ */
+#define NVM_WEAR_AREAS                      2
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_WEAR configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the @p nvmwearAcquireBus() and @p nvmwearReleaseBus()
+ *          APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_WEAR_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define NVM_WEAR_USE_MUTUAL_EXCLUSION       TRUE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM wear monitor driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief NVM driver being monitored.
+    */
+    BaseNVMDevice* nvmp;
+    /**
+    * @brief Erase counters, one per sector of @p nvmp.
+    * @note  Includes the sectors reserved for the snapshots.
+    */
+    uint32_t* counts;
+    /**
+    * @brief Number of counted sector erases before storing a snapshot.
+    * @details 0 stores snapshots on sync only. Counts not yet stored are
+    *          lost on power failure.
+    */
+    uint32_t batch;
+} NVMWearConfig;
+
+/**
+ * @brief   Wear summary.
+ */
+typedef struct
+{
+    /**
+    * @brief Sum of the erase counts of all sectors.
+    */
+    uint64_t total;
+    /**
+    * @brief Lowest erase count.
+    */
+    uint32_t min;
+    /**
+    * @brief Highest erase count.
+    */
+    uint32_t max;
+    /**
+    * @brief First sector having the lowest erase count.
+    */
+    uint32_t coldest;
+    /**
+    * @brief First sector having the highest erase count.
+    */
+    uint32_t hottest;
+    /**
+    * @brief Number of counted sector erases not yet stored.
+    */
+    uint32_t pending;
+} NVMWearStats;
+
+/**
+ * @brief   @p NVMWearDriver specific methods.
+ */
+#define _nvm_wear_driver_methods                                              \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMWearDriver virtual methods table.
+ */
+struct NVMWearDriverVMT
+{
+    _nvm_wear_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a NVM wear monitor driver.
+ * @details Counts the erases of each sector of the underlying device and
+ *          stores the counters in sectors reserved at its end. Wear aware
+ *          layers above use the counters for placing data.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMWearDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMWearConfig* config;
+    /**
+    * @brief Device info of underlying nvm device.
+    */
+    NVMDeviceInfo llnvmdi;
+    /**
+    * @brief Number of sectors available to users.
+    */
+    uint32_t sector_num;
+    /**
+    * @brief Number of sectors of a snapshot area.
+    */
+    uint32_t area_sectors;
+    /**
+    * @brief Size of a snapshot.
+    */
+    uint32_t stride;
+    /**
+    * @brief Area receiving the snapshots.
+    */
+    uint32_t area;
+    /**
+    * @brief Index of the next snapshot within @p area.
+    */
+    uint32_t slot;
+    /**
+    * @brief Sequence number of the most recent snapshot.
+    */
+    uint32_t sequence;
+    /**
+    * @brief Number of counted sector erases not yet stored.
+    */
+    uint32_t pending;
+#if NVM_WEAR_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* NVM_WEAR_USE_MUTUAL_EXCLUSION */
+} NVMWearDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmwearInit(void);
+    void nvmwearObjectInit(NVMWearDriver* nvmwearp);
+    void nvmwearStart(NVMWearDriver* nvmwearp, const NVMWearConfig* config);
+    void nvmwearStop(NVMWearDriver* nvmwearp);
+    bool nvmwearRead(NVMWearDriver* nvmwearp, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmwearWrite(NVMWearDriver* nvmwearp, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmwearErase(NVMWearDriver* nvmwearp, uint32_t startaddr,
+            uint32_t n);
+    bool nvmwearMassErase(NVMWearDriver* nvmwearp);
+    bool nvmwearSync(NVMWearDriver* nvmwearp);
+    bool nvmwearGetInfo(NVMWearDriver* nvmwearp, NVMDeviceInfo* nvmdip);
+    void nvmwearAcquireBus(NVMWearDriver* nvmwearp);
+    void nvmwearReleaseBus(NVMWearDriver* nvmwearp);
+    bool nvmwearWriteProtect(NVMWearDriver* nvmwearp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmwearMassWriteProtect(NVMWearDriver* nvmwearp);
+    bool nvmwearWriteUnprotect(NVMWearDriver* nvmwearp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmwearMassWriteUnprotect(NVMWearDriver* nvmwearp);
+    bool nvmwearReadv(NVMWearDriver* nvmwearp, const NVMReadSegment* segp,
+            uint32_t segn);
+    bool nvmwearWritev(NVMWearDriver* nvmwearp, const NVMWriteSegment* segp,
+            uint32_t segn);
+    bool nvmwearIsErased(NVMWearDriver* nvmwearp, uint32_t startaddr,
+            uint32_t n, bool* erasedp);
+    uint32_t nvmwearGetEraseCount(NVMWearDriver* nvmwearp, uint32_t sector);
+    uint32_t nvmwearFindLeastWorn(NVMWearDriver* nvmwearp, uint32_t first,
+            uint32_t n);
+    void nvmwearGetStats(NVMWearDriver* nvmwearp, NVMWearStats* statsp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_WEAR */
+
+#endif /* _QNVM_WEAR_H_ */
+
+/** @} */
@@ -0,0 +1,203 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_write_buffer.h
+ * @brief   NVM write buffer driver header.
+ *
+ * @addtogroup NVM_WRITE_BUFFER
+ * @{
+ */
+
+#ifndef _QNVM_WRITE_BUFFER_H_
+#define _QNVM_WRITE_BUFFER_H_
+
+#if HAL_USE_NVM_WRITE_BUFFER || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    NVM_WRITE_BUFFER configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the @p nvmwbufAcquireBus() and @p nvmwbufReleaseBus() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
+#define NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION   TRUE
+#endif
+
+/**
+ * @brief   Size of the buffer collecting writes.
+ * @details Limits the largest unit being configured.
+ */
+#if !defined(NVM_WRITE_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_WRITE_BUFFER_SIZE                   256
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_WRITE_BUFFER_SIZE < 1
+#error "NVM_WRITE_BUFFER_SIZE must be at least 1"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM write buffer driver configuration structure.
+ */
+typedef struct
+{
+    /**
+    * @brief NVM driver associated to this write buffer.
+    */
+    BaseNVMDevice* nvmp;
+    /**
+    * @brief Size of the units writes are collected in, e.g. the page size.
+    * @details Must be a multiple of the write alignment of @p nvmp and
+    *          divide its sector size. 0 selects the write alignment.
+    */
+    uint32_t unit_size;
+} NVMWriteBufferConfig;
+
+/**
+ * @brief   @p NVMWriteBufferDriver specific methods.
+ */
+#define _nvm_write_buffer_driver_methods                                      \
+    _base_nvm_device_methods
+
+/**
+ * @extends BaseNVMDeviceVMT
+ *
+ * @brief   @p NVMWriteBufferDriver virtual methods table.
+ */
+struct NVMWriteBufferDriverVMT
+{
+    _nvm_write_buffer_driver_methods
+};
+
+/**
+ * @extends BaseNVMDevice
+ *
+ * @brief   Structure representing a NVM write buffer driver.
+ */
+typedef struct
+{
+    /**
+    * @brief Virtual Methods Table.
+    */
+    const struct NVMWriteBufferDriverVMT* vmt;
+    _base_nvm_device_data
+    /**
+    * @brief Current configuration data.
+    */
+    const NVMWriteBufferConfig* config;
+    /**
+    * @brief Device info of underlying nvm device.
+    */
+    NVMDeviceInfo llnvmdi;
+    /**
+    * @brief Device size in bytes.
+    */
+    uint32_t wbuf_size;
+    /**
+    * @brief Unit size cached for performance.
+    */
+    uint32_t wbuf_unit;
+    /**
+    * @brief Write alignment of the underlying device, at least 1.
+    */
+    uint32_t wbuf_alignment;
+    /**
+    * @brief Address of the unit held by the buffer.
+    */
+    uint32_t wbuf_addr;
+    /**
+    * @brief Buffer holds the unit at @p wbuf_addr.
+    */
+    bool wbuf_valid;
+    /**
+    * @brief Range of buffered bytes not yet written to the device.
+    */
+    uint32_t dirty_lo;
+    uint32_t dirty_hi;
+    /**
+    * @brief Contents of the buffered unit.
+    */
+    uint8_t buffer[NVM_WRITE_BUFFER_SIZE];
+#if NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    /**
+     * @brief mutex_t protecting the device.
+     */
+    mutex_t mutex;
+#endif /* NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION */
+} NVMWriteBufferDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmwbufInit(void);
+    void nvmwbufObjectInit(NVMWriteBufferDriver* nvmwbufp);
+    void nvmwbufStart(NVMWriteBufferDriver* nvmwbufp,
+            const NVMWriteBufferConfig* config);
+    void nvmwbufStop(NVMWriteBufferDriver* nvmwbufp);
+    bool nvmwbufRead(NVMWriteBufferDriver* nvmwbufp, uint32_t startaddr,
+            uint32_t n, uint8_t* buffer);
+    bool nvmwbufWrite(NVMWriteBufferDriver* nvmwbufp, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
+    bool nvmwbufErase(NVMWriteBufferDriver* nvmwbufp, uint32_t startaddr,
+            uint32_t n);
+    bool nvmwbufMassErase(NVMWriteBufferDriver* nvmwbufp);
+    bool nvmwbufSync(NVMWriteBufferDriver* nvmwbufp);
+    bool nvmwbufGetInfo(NVMWriteBufferDriver* nvmwbufp,
+            NVMDeviceInfo* nvmdip);
+    void nvmwbufAcquireBus(NVMWriteBufferDriver* nvmwbufp);
+    void nvmwbufReleaseBus(NVMWriteBufferDriver* nvmwbufp);
+    bool nvmwbufWriteProtect(NVMWriteBufferDriver* nvmwbufp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmwbufMassWriteProtect(NVMWriteBufferDriver* nvmwbufp);
+    bool nvmwbufWriteUnprotect(NVMWriteBufferDriver* nvmwbufp,
+            uint32_t startaddr, uint32_t n);
+    bool nvmwbufMassWriteUnprotect(NVMWriteBufferDriver* nvmwbufp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_NVM_WRITE_BUFFER */
+
+#endif /* _QNVM_WRITE_BUFFER_H_ */
+
+/** @} */
@@ -0,0 +1,269 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qhal_perf.h
+ * @brief   Performance counters header.
+ * @details Named counters and timed regions are defined with
+ *          @p QHAL_PERF_COUNTER() and @p QHAL_PERF_REGION(), the linker
+ *          collects them into one table which can be dumped and reset at
+ *          run time. With @p QHAL_USE_PERF disabled all macros expand to
+ *          nothing.
+ *
+ * @addtogroup HAL
+ * @{
+ */
+
+#ifndef _QHAL_PERF_H_
+#define _QHAL_PERF_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Time sources
+ * @{
+ */
+/**
+ * @brief   Core cycles from the DWT cycle counter.
+ */
+#define QHAL_PERF_CLOCK_CYCLES                  1
+/**
+ * @brief   Nanoseconds from the posix monotonic clock.
+ */
+#define QHAL_PERF_CLOCK_NS                      2
+/**
+ * @brief   System ticks.
+ */
+#define QHAL_PERF_CLOCK_TICKS                   3
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Performance counter configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the performance counters.
+ */
+#if !defined(QHAL_USE_PERF) || defined(__DOXYGEN__)
+#define QHAL_USE_PERF                           FALSE
+#endif
+
+/**
+ * @brief   Time source of the timed regions.
+ * @details Defaults to the DWT cycle counter where the core has one, to the
+ *          monotonic clock on posix and to the system tick otherwise.
+ */
+#if !defined(QHAL_PERF_CLOCK) || defined(__DOXYGEN__)
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+#define QHAL_PERF_CLOCK                         QHAL_PERF_CLOCK_CYCLES
+#elif defined(__unix__)
+#define QHAL_PERF_CLOCK                         QHAL_PERF_CLOCK_NS
+#else
+#define QHAL_PERF_CLOCK                         QHAL_PERF_CLOCK_TICKS
+#endif
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if QHAL_USE_PERF || defined(__DOXYGEN__)
+
+#if QHAL_PERF_CLOCK == QHAL_PERF_CLOCK_CYCLES
+#if !defined(DWT_CTRL_CYCCNTENA_Msk)
+#error "QHAL_PERF_CLOCK_CYCLES requires a core providing the DWT cycle counter"
+#endif
+#define QHAL_PERF_UNIT                          "cycles"
+#elif QHAL_PERF_CLOCK == QHAL_PERF_CLOCK_NS
+#include <time.h>
+#define QHAL_PERF_UNIT                          "ns"
+#elif QHAL_PERF_CLOCK == QHAL_PERF_CLOCK_TICKS
+#define QHAL_PERF_UNIT                          "ticks"
+#else
+#error "invalid QHAL_PERF_CLOCK"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Time stamp of the performance time source.
+ */
+typedef uint32_t qhalperftime_t;
+
+/**
+ * @brief   Statistics of a counter or region.
+ */
+typedef struct
+{
+    /**
+     * @brief Counter value or number of region runs.
+     */
+    uint32_t count;
+    /**
+     * @brief Shortest region run.
+     */
+    qhalperftime_t time_min;
+    /**
+     * @brief Longest region run.
+     */
+    qhalperftime_t time_max;
+    /**
+     * @brief Cumulative time of the region runs.
+     */
+    uint64_t time_total;
+} QHALPerfStats;
+
+/**
+ * @brief   Performance table entry.
+ * @details Defined with @p QHAL_PERF_COUNTER() or @p QHAL_PERF_REGION().
+ */
+typedef struct
+{
+    /**
+     * @brief Name shown in the dump.
+     */
+    const char *name;
+    /**
+     * @brief The entry is a timed region.
+     */
+    bool region;
+    /**
+     * @brief Statistics.
+     */
+    QHALPerfStats *statsp;
+} QHALPerfEntry;
+
+// variables from linker script
+extern const QHALPerfEntry __qhal_perf_start[], __qhal_perf_end[];
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/* The explicit alignment keeps the compiler from padding the table. */
+#define __qhal_perf_define(id, isregion)                                      \
+    static QHALPerfStats __qhal_perf_stats_##id;                              \
+    static const QHALPerfEntry __qhal_perf_##id __attribute__((__used__))     \
+    __attribute__((__section__(".qhal_perf." #id)))                           \
+    __attribute__((__aligned__(sizeof(void *))))                              \
+    = { .name = #id, .region = isregion,                                      \
+        .statsp = &__qhal_perf_stats_##id };
+
+/**
+ * @brief   Defines a counter.
+ * @details The dump lists the entries in the order of their names.
+ *
+ * @param[in] name      unique identifier of the counter
+ */
+#define QHAL_PERF_COUNTER(name) __qhal_perf_define(name, false)
+
+/**
+ * @brief   Defines a timed region.
+ *
+ * @param[in] name      unique identifier of the region
+ */
+#define QHAL_PERF_REGION(name) __qhal_perf_define(name, true)
+
+/**
+ * @brief   Adds to a counter defined in the same file.
+ *
+ * @xclass
+ */
+#define QHAL_PERF_ADD(name, n) qhalPerfAddX(&__qhal_perf_stats_##name, (n))
+
+/**
+ * @brief   Increments a counter defined in the same file.
+ *
+ * @xclass
+ */
+#define QHAL_PERF_INC(name) QHAL_PERF_ADD(name, 1)
+
+/**
+ * @brief   Starts a run of a region defined in the same file.
+ * @details Declares a local variable, the matching @p QHAL_PERF_END() must
+ *          be in the same scope.
+ *
+ * @xclass
+ */
+#define QHAL_PERF_BEGIN(name)                                                 \
+    const qhalperftime_t __qhal_perf_begin_##name = qhalPerfNowX()
+
+/**
+ * @brief   Ends a run of a region.
+ *
+ * @xclass
+ */
+#define QHAL_PERF_END(name)                                                   \
+    qhalPerfAccountX(&__qhal_perf_stats_##name, __qhal_perf_begin_##name)
+
+/**
+ * @brief   Reads the time source.
+ *
+ * @xclass
+ */
+static inline qhalperftime_t qhalPerfNowX(void)
+{
+#if QHAL_PERF_CLOCK == QHAL_PERF_CLOCK_CYCLES
+    return DWT->CYCCNT;
+#elif QHAL_PERF_CLOCK == QHAL_PERF_CLOCK_NS
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (qhalperftime_t)((uint32_t)ts.tv_sec * 1000000000U +
+            (uint32_t)ts.tv_nsec);
+#else
+    return (qhalperftime_t)osalOsGetSystemTimeX();
+#endif
+}
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void qhalPerfInit(void);
+    void qhalPerfAddX(QHALPerfStats *statsp, uint32_t n);
+    void qhalPerfAccountX(QHALPerfStats *statsp, qhalperftime_t begin);
+    void qhalPerfGet(const QHALPerfEntry *entryp, QHALPerfStats *statsp);
+    void qhalPerfReset(void);
+    void qhalPerfDump(BaseSequentialStream *chp);
+    void qhalPerfShellCmd(BaseSequentialStream *chp, int argc, char *argv[]);
+#ifdef __cplusplus
+}
+#endif
+
+#else /* !QHAL_USE_PERF */
+
+#define QHAL_PERF_COUNTER(name)
+#define QHAL_PERF_REGION(name)
+#define QHAL_PERF_ADD(name, n)
+#define QHAL_PERF_INC(name)
+#define QHAL_PERF_BEGIN(name)
+#define QHAL_PERF_END(name)
+
+#endif /* QHAL_USE_PERF */
+
+#endif /* _QHAL_PERF_H_ */
+
+/** @} */
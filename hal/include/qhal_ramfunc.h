@@ -0,0 +1,89 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qhal_ramfunc.h
+ * @brief   RAM resident code placement macros.
+ * @details Functions are placed into the @p .ramfunc section, which the
+ *          linker rules put into the initialized data copied to RAM at
+ *          startup.
+ *
+ * @addtogroup HAL
+ * @{
+ */
+
+#ifndef _QHAL_RAMFUNC_H_
+#define _QHAL_RAMFUNC_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    RAM function configuration options
+ * @{
+ */
+/**
+ * @brief   Executes hot driver code from RAM.
+ * @details Flash program and erase paths and the interrupt handlers marked
+ *          with @p QHAL_HOTFUNC are executed from RAM, avoiding flash wait
+ *          states and stalls while the flash is busy.
+ * @note    The kernel, the vector table and code called from these
+ *          functions still reside in flash unless placed otherwise.
+ */
+#if !defined(QHAL_USE_RAMFUNC) || defined(__DOXYGEN__)
+#define QHAL_USE_RAMFUNC                        FALSE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Places a function in RAM.
+ * @details For code which must not run from flash, independent of
+ *          @p QHAL_USE_RAMFUNC.
+ */
+#define QHAL_RAMFUNC                                                          \
+    __attribute__((section(".ramfunc"), noinline, long_call))
+
+/**
+ * @brief   Places a function in RAM if @p QHAL_USE_RAMFUNC is enabled.
+ */
+#if QHAL_USE_RAMFUNC || defined(__DOXYGEN__)
+#define QHAL_HOTFUNC                            QHAL_RAMFUNC
+#else
+#define QHAL_HOTFUNC
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#endif /* _QHAL_RAMFUNC_H_ */
+
+/** @} */
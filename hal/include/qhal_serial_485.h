@@ -67,6 +67,23 @@
 #if !defined(SERIAL_485_BUFFERS_SIZE) || defined(__DOXYGEN__)
 #define SERIAL_485_BUFFERS_SIZE         16
 #endif
+
+/**
+ * @brief   Enables the frame oriented API.
+ * @details Received frames are delimited by a gap on the line and stored
+ *          in caller provided buffers, frames are sent from the caller's
+ *          buffer without passing through the output queue.
+ */
+#if !defined(SERIAL_485_USE_FRAMES) || defined(__DOXYGEN__)
+#define SERIAL_485_USE_FRAMES           FALSE
+#endif
+
+/**
+ * @brief   Maximum number of receive frame buffers per driver.
+ */
+#if !defined(SERIAL_485_FRAMES_NUM) || defined(__DOXYGEN__)
+#define SERIAL_485_FRAMES_NUM           4
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -77,6 +94,10 @@
 #error "Serial 485 Driver requires CH_CFG_USE_EVENTS"
 #endif
 
+#if SERIAL_485_USE_FRAMES && !CH_CFG_USE_MAILBOXES
+#error "SERIAL_485_USE_FRAMES requires CH_CFG_USE_MAILBOXES"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -95,6 +116,31 @@ typedef enum {
  */
 typedef struct Serial485Driver Serial485Driver;
 
+#if SERIAL_485_USE_FRAMES || defined(__DOXYGEN__)
+/**
+ * @brief   Receive frame buffer.
+ */
+typedef struct {
+  /**
+   * @brief Frame data buffer.
+   */
+  uint8_t                   *buffer;
+  /**
+   * @brief Size of the frame data buffer.
+   */
+  size_t                    size;
+  /**
+   * @brief Number of bytes received.
+   */
+  size_t                    n;
+  /**
+   * @brief Status flags, @p S485D_OVERRUN_ERROR if the frame was longer
+   *        than the buffer.
+   */
+  eventflags_t              flags;
+} Serial485Frame;
+#endif /* SERIAL_485_USE_FRAMES */
+
 #include "qhal_serial_485_lld.h"
 
 /**
@@ -124,6 +170,26 @@ struct Serial485Driver {
   const struct Serial485DriverVMT *vmt;
   _serial_485_driver_data
   const Serial485Config *config;
+#if SERIAL_485_USE_FRAMES || defined(__DOXYGEN__)
+  /** @brief Received data is collected in frames.*/
+  bool                      framemode;
+  /** @brief Frame being received or @p NULL.*/
+  Serial485Frame            *rxframe;
+  /** @brief Free receive frames.*/
+  mailbox_t                 rxfree;
+  /** @brief Received frames.*/
+  mailbox_t                 rxdone;
+  /** @brief Free receive frames mailbox buffer.*/
+  msg_t                     rxfree_buf[SERIAL_485_FRAMES_NUM];
+  /** @brief Received frames mailbox buffer.*/
+  msg_t                     rxdone_buf[SERIAL_485_FRAMES_NUM];
+  /** @brief Next byte of the frame being sent or @p NULL.*/
+  const uint8_t             *txframe;
+  /** @brief Bytes left of the frame being sent.*/
+  size_t                    txframe_n;
+  /** @brief Thread waiting for the frame being sent.*/
+  thread_reference_t        txthread;
+#endif /* SERIAL_485_USE_FRAMES */
 };
 
 /*===========================================================================*/
@@ -300,6 +366,18 @@ extern "C" {
   void s485dStop(Serial485Driver *s485dp);
   void s485dIncomingDataI(Serial485Driver *s485dp, uint8_t b);
   msg_t s485dRequestDataI(Serial485Driver *s485dp);
+#if SERIAL_485_USE_FRAMES || defined(__DOXYGEN__)
+  void s485dFrameModeEnable(Serial485Driver *s485dp, bool enable);
+  void s485dFrameRelease(Serial485Driver *s485dp, Serial485Frame *framep);
+  msg_t s485dFrameReceive(Serial485Driver *s485dp, Serial485Frame **framepp,
+                          systime_t timeout);
+  msg_t s485dSendFrame(Serial485Driver *s485dp, const uint8_t *buffer,
+                       size_t n, systime_t timeout);
+  void s485dFrameDataI(Serial485Driver *s485dp, uint8_t b);
+  void s485dFrameEndI(Serial485Driver *s485dp);
+  msg_t s485dFrameRequestDataI(Serial485Driver *s485dp);
+  void s485dFrameSentI(Serial485Driver *s485dp);
+#endif /* SERIAL_485_USE_FRAMES */
 #ifdef __cplusplus
 }
 #endif
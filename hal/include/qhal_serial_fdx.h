@@ -107,6 +107,89 @@
 #define SFDX_SLAVE_RECEIVE_TIMEOUT_MS 2000
 #endif
 
+/**
+ * @brief   Initial master idle delay in ms.
+ * @details While both sides have nothing to send the master delays its next
+ *          request, the delay doubles with every idle round trip up to
+ *          @p SFDX_MASTER_IDLE_MAX_MS. Writing data wakes the master up.
+ */
+#if !defined(SFDX_MASTER_IDLE_MIN_MS) || defined(__DOXYGEN__)
+#define SFDX_MASTER_IDLE_MIN_MS 1
+#endif
+
+/**
+ * @brief   Maximum master idle delay in ms, @p 0 disables the idle delay.
+ * @details Bounds the latency of data sent by an idle slave and, together
+ *          with @p SFDX_MASTER_RECEIVE_TIMEOUT_MS, the master detection of
+ *          a connection loss.
+ * @note    Must be shorter than @p SFDX_SLAVE_RECEIVE_TIMEOUT_MS.
+ */
+#if !defined(SFDX_MASTER_IDLE_MAX_MS) || defined(__DOXYGEN__)
+#define SFDX_MASTER_IDLE_MAX_MS 250
+#endif
+
+/**
+ * @brief   Enables the @p sfdxdGetStats() API.
+ * @details Counts frames, payload and escape bytes, errors and measures the
+ *          master round trip time.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SERIAL_FDX_USE_STATS) || defined(__DOXYGEN__)
+#define SERIAL_FDX_USE_STATS FALSE
+#endif
+
+/**
+ * @brief   Number of channels multiplexed over the link.
+ * @details Channel 0 is the driver itself, the others are accessed through
+ *          @p sfdxdGetChannel(). Each frame carries data of a single
+ *          channel, lower numbered channels take strict priority.
+ */
+#if !defined(SERIAL_FDX_CHANNELS) || defined(__DOXYGEN__)
+#define SERIAL_FDX_CHANNELS 1
+#endif
+
+/**
+ * @brief   Enables the windowed mode.
+ * @details In windowed mode both sides send frames carrying sequence
+ *          numbers and cumulative acknowledges, several frames may be in
+ *          flight instead of one frame per round trip.
+ */
+#if !defined(SERIAL_FDX_USE_WINDOW) || defined(__DOXYGEN__)
+#define SERIAL_FDX_USE_WINDOW FALSE
+#endif
+
+/**
+ * @brief   Maximum number of frames in flight in windowed mode.
+ * @note    Must be a power of two.
+ */
+#if !defined(SERIAL_FDX_WINDOW_MAX) || defined(__DOXYGEN__)
+#define SERIAL_FDX_WINDOW_MAX 8
+#endif
+
+/**
+ * @brief   Windowed mode receive poll interval in ms while idle.
+ * @details Bounds the latency of data written while waiting for frames.
+ */
+#if !defined(SFDX_WINDOW_POLL_MS) || defined(__DOXYGEN__)
+#define SFDX_WINDOW_POLL_MS 2
+#endif
+
+/**
+ * @brief   Windowed mode retransmission timeout in ms.
+ */
+#if !defined(SFDX_WINDOW_RETRANSMIT_MS) || defined(__DOXYGEN__)
+#define SFDX_WINDOW_RETRANSMIT_MS 100
+#endif
+
+/**
+ * @brief   Windowed mode keep alive interval in ms.
+ * @note    Must be shorter than @p SFDX_SLAVE_RECEIVE_TIMEOUT_MS which
+ *          disconnects in windowed mode.
+ */
+#if !defined(SFDX_WINDOW_KEEPALIVE_MS) || defined(__DOXYGEN__)
+#define SFDX_WINDOW_KEEPALIVE_MS 500
+#endif
+
 /**
  * @brief   Dedicated data pump thread stack size.
  */
@@ -139,6 +222,42 @@
 #error "SERIAL_FDX_MTU must be >= 4"
 #endif
 
+#if (SERIAL_FDX_CHANNELS < 1) || (SERIAL_FDX_CHANNELS > 255)
+#error "SERIAL_FDX_CHANNELS must be between 1 and 255"
+#endif
+
+#if (SERIAL_FDX_CHANNELS > 1) && (SERIAL_FDX_MTU < 6)
+#error "SERIAL_FDX_CHANNELS > 1 requires SERIAL_FDX_MTU >= 6"
+#endif
+
+#if (SERIAL_FDX_CHANNELS > 1) && SERIAL_FDX_USE_WINDOW
+#error "SERIAL_FDX_CHANNELS > 1 is not supported with SERIAL_FDX_USE_WINDOW"
+#endif
+
+#if SFDX_MASTER_IDLE_MAX_MS >= SFDX_SLAVE_RECEIVE_TIMEOUT_MS
+#error "SFDX_MASTER_IDLE_MAX_MS must be < SFDX_SLAVE_RECEIVE_TIMEOUT_MS"
+#endif
+
+#if (SFDX_MASTER_IDLE_MAX_MS > 0) && (SFDX_MASTER_IDLE_MIN_MS < 1)
+#error "SFDX_MASTER_IDLE_MIN_MS must be >= 1"
+#endif
+
+/**
+ * @brief   Smallest MTU in windowed mode, frame delimiters, the escaped
+ *          header and one escaped payload byte.
+ */
+#define SFDX_WINDOW_MTU_MIN 10
+
+#if SERIAL_FDX_USE_WINDOW && (SERIAL_FDX_MTU < SFDX_WINDOW_MTU_MIN)
+#error "SERIAL_FDX_USE_WINDOW requires SERIAL_FDX_MTU >= 10"
+#endif
+
+#if SERIAL_FDX_USE_WINDOW &&                                              \
+    ((SERIAL_FDX_WINDOW_MAX < 1) || (SERIAL_FDX_WINDOW_MAX > 128) ||      \
+     ((SERIAL_FDX_WINDOW_MAX & (SERIAL_FDX_WINDOW_MAX - 1)) != 0))
+#error "SERIAL_FDX_WINDOW_MAX must be a power of two up to 128"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -178,8 +297,85 @@ typedef struct
     BaseAsynchronousChannel* farp;
     /* Type of this driver instance. */
     sfdxdtype_t type;
+    /* Maximum frame size, at most SERIAL_FDX_MTU, 0 for SERIAL_FDX_MTU. */
+    size_t mtu;
+#if SERIAL_FDX_USE_WINDOW || defined(__DOXYGEN__)
+    /* Frames in flight, at most SERIAL_FDX_WINDOW_MAX, 0 for the request
+       and response mode selected by type. */
+    uint8_t window;
+#endif
 } SerialFdxConfig;
 
+#if SERIAL_FDX_USE_STATS || defined(__DOXYGEN__)
+/**
+ * @brief   Serial full duplex driver link statistics.
+ * @note    Payload excludes frame delimiters, escapes, windowed mode
+ *          headers and channel numbers.
+ */
+typedef struct
+{
+    /**
+     * @brief Frames sent.
+     */
+    uint32_t frames_sent;
+    /**
+     * @brief Frames received.
+     */
+    uint32_t frames_received;
+    /**
+     * @brief Frames sent without payload, keep alive and acknowledges.
+     */
+    uint32_t empty_sent;
+    /**
+     * @brief Frames received without payload.
+     */
+    uint32_t empty_received;
+    /**
+     * @brief Payload bytes sent, retransmissions included.
+     */
+    uint32_t payload_sent;
+    /**
+     * @brief Payload bytes received.
+     */
+    uint32_t payload_received;
+    /**
+     * @brief Escape bytes sent.
+     */
+    uint32_t escapes_sent;
+    /**
+     * @brief Escape bytes received.
+     */
+    uint32_t escapes_received;
+    /**
+     * @brief Framing errors, see @p SFDX_FRAMING_ERROR.
+     */
+    uint32_t framing_errors;
+    /**
+     * @brief Input queue overruns, see @p SFDX_OVERRUN_ERROR.
+     */
+    uint32_t overruns;
+    /**
+     * @brief Number of round trips measured.
+     * @note  Only a master outside of the windowed mode measures round
+     *        trips, from the start of a request to the end of the response.
+     */
+    uint32_t rtt_count;
+    /**
+     * @brief Shortest round trip in system ticks.
+     */
+    uint32_t rtt_min;
+    /**
+     * @brief Longest round trip in system ticks.
+     */
+    uint32_t rtt_max;
+    /**
+     * @brief Cumulative round trip time in system ticks.
+     * @note  Divided by @p rtt_count this yields the average.
+     */
+    uint64_t rtt_total;
+} SerialFdxStats;
+#endif /* SERIAL_FDX_USE_STATS */
+
 /**
  * @brief   @p SerialFdxDriver specific data.
  */
@@ -197,6 +393,12 @@ typedef struct
     uint8_t ob[SERIAL_FDX_BUFFER_SIZE];                                   \
     /* Buffer for outgoing message composing.*/                           \
     uint8_t sendbuffer[SERIAL_FDX_MTU];                                   \
+    /* Block read from the far end, decoded in place.*/                 \
+    uint8_t recvbuffer[SERIAL_FDX_MTU];                                   \
+    /* Next byte of the block to be decoded.*/                            \
+    size_t recvpos;                                                       \
+    /* Number of bytes in the block.*/                                    \
+    size_t recvlen;                                                       \
     /* Connection status.*/                                               \
     bool connected;                                                       \
 
@@ -216,6 +418,41 @@ struct SerialFdxDriverVMT
     _serial_fdx_driver_methods
 };
 
+#if (SERIAL_FDX_CHANNELS > 1) || defined(__DOXYGEN__)
+/**
+ * @extends BaseAsynchronousChannel
+ *
+ * @brief   Additional channel of a serial full duplex driver.
+ * @details Connection events are broadcast on every channel.
+ */
+typedef struct
+{
+    /** @brief Virtual Methods Table.*/
+    const struct SerialFdxDriverVMT* vmt;
+    _base_asynchronous_channel_data
+    /**
+     * @brief   Driver carrying this channel.
+     */
+    SerialFdxDriver*              driverp;
+    /**
+     * @brief   Input queue.
+     */
+    symmetric_queue_t             iqueue;
+    /**
+     * @brief   Output queue.
+     */
+    symmetric_queue_t             oqueue;
+    /**
+     * @brief   Input circular buffer.
+     */
+    uint8_t                       ib[SERIAL_FDX_BUFFER_SIZE];
+    /**
+     * @brief   Output circular buffer.
+     */
+    uint8_t                       ob[SERIAL_FDX_BUFFER_SIZE];
+} SerialFdxChannel;
+#endif /* SERIAL_FDX_CHANNELS > 1 */
+
 /**
  * @extends BaseAsynchronousChannel
  *
@@ -242,6 +479,74 @@ struct SerialFdxDriver
      */
     THD_WORKING_AREA(wa_pump, SERIAL_FDX_THREAD_STACK_SIZE);
 #endif
+#if (SFDX_MASTER_IDLE_MAX_MS > 0) || defined(__DOXYGEN__)
+    /**
+     * @brief   Pointer to the thread when it is idle or @p NULL.
+     */
+    thread_reference_t            idle;
+    /**
+     * @brief   Current master idle delay in ms.
+     */
+    uint32_t                      idledelay;
+#endif
+#if SERIAL_FDX_USE_STATS || defined(__DOXYGEN__)
+    /**
+     * @brief   Link statistics.
+     */
+    SerialFdxStats                stats;
+#endif
+#if (SERIAL_FDX_CHANNELS > 1) || defined(__DOXYGEN__)
+    /**
+     * @brief   Channels 1 and above.
+     */
+    SerialFdxChannel              channels[SERIAL_FDX_CHANNELS - 1];
+#endif
+#if SERIAL_FDX_USE_WINDOW || defined(__DOXYGEN__)
+    /**
+     * @brief   Windowed mode, the receive side synchronized to the peer.
+     */
+    bool                          synced;
+    /**
+     * @brief   Windowed mode, a frame must be acknowledged.
+     */
+    bool                          ackpending;
+    /**
+     * @brief   Windowed mode, sequence number of the oldest frame in flight.
+     */
+    uint8_t                       txbase;
+    /**
+     * @brief   Windowed mode, number of frames in flight.
+     */
+    uint8_t                       txcount;
+    /**
+     * @brief   Windowed mode, frames in flight sent in the current pass.
+     */
+    uint8_t                       txsent;
+    /**
+     * @brief   Windowed mode, next expected sequence number.
+     */
+    uint8_t                       rxnext;
+    /**
+     * @brief   Windowed mode, payload sizes of the frames in flight.
+     */
+    size_t                        txlen[SERIAL_FDX_WINDOW_MAX];
+    /**
+     * @brief   Windowed mode, start of the retransmission timeout.
+     */
+    systime_t                     txtime;
+    /**
+     * @brief   Windowed mode, time of the last frame sent.
+     */
+    systime_t                     lasttx;
+    /**
+     * @brief   Windowed mode, time of the last frame received.
+     */
+    systime_t                     lastrx;
+    /**
+     * @brief   Windowed mode, decoded received frame.
+     */
+    uint8_t                       framebuffer[SERIAL_FDX_MTU];
+#endif
 };
 
 /*===========================================================================*/
@@ -282,6 +587,14 @@ extern "C"
     void sfdxdStart(SerialFdxDriver* sfdxdp,
             const SerialFdxConfig* configp);
     void sfdxdStop(SerialFdxDriver* sfdxdp);
+#if SERIAL_FDX_USE_STATS || defined(__DOXYGEN__)
+    void sfdxdGetStats(SerialFdxDriver* sfdxdp, SerialFdxStats* statsp);
+    void sfdxdResetStats(SerialFdxDriver* sfdxdp);
+#endif
+#if (SERIAL_FDX_CHANNELS > 1) || defined(__DOXYGEN__)
+    BaseAsynchronousChannel* sfdxdGetChannel(SerialFdxDriver* sfdxdp,
+            uint8_t id);
+#endif
 #ifdef __cplusplus
 }
 #endif
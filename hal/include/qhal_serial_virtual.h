@@ -99,7 +99,13 @@ typedef struct
     /* Incoming data queue.*/                                                 \
     symmetric_queue_t queue;                                                  \
     /* Input buffer.*/                                                        \
-    uint8_t queuebuf[SERIAL_VIRTUAL_BUFFER_SIZE];
+    uint8_t queuebuf[SERIAL_VIRTUAL_BUFFER_SIZE];                             \
+    /* Thread blocked reading directly from the far end.*/                    \
+    thread_reference_t reader;                                                \
+    /* Where the far end writes for the blocked reader.*/                     \
+    uint8_t *rdbuf;                                                           \
+    /* Bytes still wanted by the blocked reader.*/                            \
+    size_t rdleft;
 
 /**
  * @brief   @p SerialVirtualDriver specific methods.
@@ -0,0 +1,141 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    STM32/CRCv1/qhal_crc_lld.c
+ * @brief   STM32 CRC unit low level driver.
+ *
+ * @addtogroup CRC
+ * @{
+ */
+
+#include "qhal.h"
+#include "qhal_crc_lld.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   CRC32 polynomial in msb first notation.
+ */
+#define CRC_LLD_POLYNOMIAL      0x04c11db7UL
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t crc_lld_rbit(uint32_t x)
+{
+#if (__CORTEX_M >= 3)
+    return __RBIT(x);
+#else
+    x = ((x >> 1) & 0x55555555UL) | ((x & 0x55555555UL) << 1);
+    x = ((x >> 2) & 0x33333333UL) | ((x & 0x33333333UL) << 2);
+    x = ((x >> 4) & 0x0f0f0f0fUL) | ((x & 0x0f0f0f0fUL) << 4);
+    return __REV(x);
+#endif
+}
+
+static void crc_lld_enable_clock(void)
+{
+#if defined(RCC_AHBENR_CRCEN)
+    RCC->AHBENR |= RCC_AHBENR_CRCEN;
+#else
+    RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+#endif
+}
+
+#if !defined(CRC_CR_REV_OUT)
+/**
+ * @brief   Returns the word which moves the freshly reset unit to @p state.
+ * @details Runs the msb first CRC backwards over 32 bits. Used on units
+ *          which lack a programmable initial value.
+ */
+static uint32_t crc_lld_preload(uint32_t state)
+{
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        if (state & 1)
+            state = ((state ^ CRC_LLD_POLYNOMIAL) >> 1) | 0x80000000UL;
+        else
+            state >>= 1;
+    }
+    return state ^ 0xffffffffUL;
+}
+#endif /* !defined(CRC_CR_REV_OUT) */
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Continues a standard CRC32 over a number of words.
+ * @details The result equals the zlib style software CRC32 continued from
+ *          @p crc over the little endian bytes of @p datap. The unit is
+ *          reloaded on every call, so there is no state to share between
+ *          callers.
+ * @note    The unit is used inside a critical zone, keep @p n small.
+ *
+ * @param[in] crc       CRC32 of the preceding data or 0
+ * @param[in] datap     pointer to the words to process
+ * @param[in] n         number of words to process
+ *
+ * @return              The CRC32 including @p datap.
+ *
+ * @notapi
+ */
+uint32_t crc_lld_crc32(uint32_t crc, const uint32_t* datap, uint32_t n)
+{
+    osalSysLock();
+
+    crc_lld_enable_clock();
+
+#if defined(CRC_CR_REV_OUT)
+    /* Note: Let the unit reflect input and output. */
+    CRC->INIT = crc_lld_rbit(~crc);
+    CRC->CR = CRC_CR_REV_IN | CRC_CR_REV_OUT | CRC_CR_RESET;
+    for (uint32_t i = 0; i < n; ++i)
+        CRC->DR = datap[i];
+    crc = ~CRC->DR;
+    CRC->INIT = 0xffffffffUL;
+    CRC->CR = CRC_CR_RESET;
+#else
+    /* Note: Reflect in software and preload the state by data. */
+    CRC->CR = CRC_CR_RESET;
+    CRC->DR = crc_lld_preload(crc_lld_rbit(~crc));
+    for (uint32_t i = 0; i < n; ++i)
+        CRC->DR = crc_lld_rbit(datap[i]);
+    crc = ~crc_lld_rbit(CRC->DR);
+    CRC->CR = CRC_CR_RESET;
+#endif
+
+    osalSysUnlock();
+
+    return crc;
+}
+
+/** @} */
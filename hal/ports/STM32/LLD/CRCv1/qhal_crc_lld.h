@@ -0,0 +1,68 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    STM32/CRCv1/qhal_crc_lld.h
+ * @brief   STM32 CRC unit low level driver header.
+ *
+ * @addtogroup CRC
+ * @{
+ */
+
+#ifndef _QHAL_CRC_LLD_H_
+#define _QHAL_CRC_LLD_H_
+
+#include <stdint.h>
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   The CRC unit computes the standard CRC32 through
+ *          @p crc_lld_crc32().
+ */
+#define CRC_LLD_HAS_CRC32       TRUE
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  uint32_t crc_lld_crc32(uint32_t crc, const uint32_t* datap, uint32_t n);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QHAL_CRC_LLD_H_ */
+
+/** @} */
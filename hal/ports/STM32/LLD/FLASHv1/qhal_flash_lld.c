@@ -124,6 +124,7 @@ FLASHDriver FLASHD;
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_cr_lock(FLASHDriver* flashp)
 {
     flashp->flash->CR |= FLASH_CR_LOCK;
@@ -136,6 +137,7 @@ static void flash_lld_cr_lock(FLASHDriver* flashp)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_cr_unlock(FLASHDriver* flashp)
 {
     static const uint32_t FLASH_UNLOCK_KEY1 = 0x45670123;
@@ -188,6 +190,7 @@ static void flash_lld_optcr_unlock(FLASHDriver* flashp)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_program_16(FLASHDriver* flashp, uint32_t addr,
         uint16_t data)
 {
@@ -343,6 +346,7 @@ static void flash_lld_ob_wrp_write(FLASHDriver* flashp, uint32_t bitmask)
  *
  * @param[in] flashp    pointer to the @p FLASHDriver object
  */
+QHAL_HOTFUNC
 static void serve_flash_irq(FLASHDriver* flashp)
 {
     uint32_t sr;
@@ -350,6 +354,12 @@ static void serve_flash_irq(FLASHDriver* flashp)
 
     sr = f->SR;
     f->SR = FLASH_SR_PGERR | FLASH_SR_WRPRTERR | FLASH_SR_EOP;
+
+#if FLASH_USE_REQUEST
+    _flash_serve_request_isr(flashp, (sr & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR)) != 0);
+#else
+    (void)sr;
+#endif /* FLASH_USE_REQUEST */
 }
 
 /*===========================================================================*/
@@ -516,6 +526,123 @@ void flash_lld_read(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
     memcpy(buffer, (uint8_t*)(FLASH_BASE + startaddr), n);
 }
 
+/**
+ * @brief   Returns the address of flash memory.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ *
+ * @return              The mapped address of @p startaddr.
+ *
+ * @notapi
+ */
+const uint8_t* flash_lld_map(FLASHDriver* flashp, uint32_t startaddr)
+{
+    return (const uint8_t*)(FLASH_BASE + startaddr);
+}
+
+/**
+ * @brief   Checks whether a range of flash is erased.
+ * @details Compares word wise once the address is aligned.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ * @param[in] n         number of bytes to check
+ *
+ * @return              The range state.
+ * @retval true         all bytes are erased.
+ * @retval false        at least one byte is programmed.
+ *
+ * @notapi
+ */
+bool flash_lld_is_erased(FLASHDriver* flashp, uint32_t startaddr, uint32_t n)
+{
+    (void)flashp;
+
+    const uint8_t* p = (const uint8_t*)(FLASH_BASE + startaddr);
+    const uint8_t* end = p + n;
+
+    while (p < end && ((uint32_t)p % sizeof(uint32_t)) != 0)
+        if (*p++ != 0xff)
+            return false;
+
+    while ((uint32_t)(end - p) >= sizeof(uint32_t))
+    {
+        if (*(const uint32_t*)p != 0xffffffff)
+            return false;
+        p += sizeof(uint32_t);
+    }
+
+    while (p < end)
+        if (*p++ != 0xff)
+            return false;
+
+    return true;
+}
+
+/**
+ * @brief   Checks whether a range is located in a bank not used for
+ *          execution.
+ * @note    Supported devices have a single bank.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ * @param[in] n         number of bytes, at least one
+ *
+ * @return              The range state.
+ * @retval true         the range can be modified while code keeps running.
+ * @retval false        the range shares a bank with code or vectors.
+ *
+ * @notapi
+ */
+bool flash_lld_is_other_bank(FLASHDriver* flashp, uint32_t startaddr,
+        uint32_t n)
+{
+    (void)flashp;
+    (void)startaddr;
+    (void)n;
+
+    return false;
+}
+
+/**
+ * @brief   Returns whether an operation is ongoing.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ *
+ * @return              The busy state.
+ *
+ * @notapi
+ */
+bool flash_lld_is_busy(FLASHDriver* flashp)
+{
+    return (flashp->flash->SR & FLASH_SR_BSY) != 0;
+}
+
+/**
+ * @brief   Starts programming the next unit of data.
+ * @details Programs the largest unit supported at @p startaddr without
+ *          waiting for completion.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ * @param[in] n         number of bytes left to write, at least one
+ * @param[in] buffer    pointer to data buffer
+ *
+ * @return              The number of bytes being programmed.
+ *
+ * @notapi
+ */
+QHAL_HOTFUNC
+uint32_t flash_lld_write_unit(FLASHDriver* flashp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    (void)n;
+
+    flash_lld_program_16(flashp, FLASH_BASE + startaddr, *(uint16_t*)buffer);
+    return 2;
+}
+
 /**
  * @brief   Writes data to flash peripheral.
  *
@@ -526,20 +653,17 @@ void flash_lld_read(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_write(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
         const uint8_t* buffer)
 {
     /* Verify that we are writing an even address and size. */
     osalDbgAssert((startaddr & 1) == 0 && (n & 1) == 0, "invalid parameters");
 
-    uint32_t addr = FLASH_BASE + startaddr;
     uint32_t offset = 0;
     while (offset < n)
-    {
-        flash_lld_program_16(flashp, addr, *(uint16_t*)(buffer + offset));
-        addr += 2;
-        offset += 2;
-    }
+        offset += flash_lld_write_unit(flashp, startaddr + offset,
+                n - offset, buffer + offset);
 }
 
 /**
@@ -550,6 +674,7 @@ void flash_lld_write(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_erase_sector(FLASHDriver* flashp, uint32_t startaddr)
 {
     flash_lld_cr_unlock(flashp);
@@ -575,6 +700,7 @@ void flash_lld_erase_sector(FLASHDriver* flashp, uint32_t startaddr)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_erase_mass(FLASHDriver* flashp)
 {
     flash_lld_cr_unlock(flashp);
@@ -597,6 +723,7 @@ void flash_lld_erase_mass(FLASHDriver* flashp)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_sync(FLASHDriver* flashp)
 {
     while (flashp->flash->SR & FLASH_SR_BSY)
@@ -630,6 +757,15 @@ void flash_lld_get_info(FLASHDriver* flashp, NVMDeviceInfo* nvmdip)
      * Also the chip can not write a word which is not 0xffff so
      * we have no way to hide this drawback from the user.*/
     nvmdip->write_alignment = 2;
+    nvmdip->page_size = 2;
+    memset(nvmdip->erase_sizes, 0, sizeof(nvmdip->erase_sizes));
+    nvmdip->erase_sizes[0] = FLASH_SECTOR_SIZE;
+    /* Note: Typical and maximum datasheet values. */
+    nvmdip->timing.program_typ = 53;
+    nvmdip->timing.program_max = 70;
+    nvmdip->timing.erase_typ = 20000;
+    nvmdip->timing.erase_max = 40000;
+    nvmdip->memory_mapped = true;
 }
 
 /**
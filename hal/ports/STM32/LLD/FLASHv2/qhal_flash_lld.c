@@ -30,10 +30,20 @@
 
 /**
  * @todo    - add error propagation
- *          - replace sync polling by synchronization with isr
+ *          - replace program sync polling by synchronization with isr
  *          - add support for OTP area
  */
 
+/**
+ * @note
+ *      - Erase waiting:
+ *        Waiting for a sector or mass erase suspends the calling thread
+ *        until the end of operation interrupt, the kernel stays unlocked.
+ *        The bus still stalls code fetches and reads from the bank being
+ *        erased, code running during the erase has to execute from RAM or
+ *        from the other bank on dual bank devices.
+ */
+
 /*===========================================================================*/
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
@@ -247,6 +257,7 @@ static const struct
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_cr_lock(FLASHDriver* flashp)
 {
     flashp->flash->CR |= FLASH_CR_LOCK;
@@ -259,6 +270,7 @@ static void flash_lld_cr_lock(FLASHDriver* flashp)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_cr_unlock(FLASHDriver* flashp)
 {
     static const uint32_t FLASH_UNLOCK_KEY1 = 0x45670123;
@@ -327,6 +339,7 @@ static __inline__ flash_program_size_e flash_lld_get_psize(void)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_program_64(FLASHDriver* flashp, uint32_t addr,
         uint64_t data)
 {
@@ -356,6 +369,7 @@ static void flash_lld_program_64(FLASHDriver* flashp, uint32_t addr,
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_program_32(FLASHDriver* flashp, uint32_t addr,
         uint32_t data)
 {
@@ -385,6 +399,7 @@ static void flash_lld_program_32(FLASHDriver* flashp, uint32_t addr,
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_program_16(FLASHDriver* flashp, uint32_t addr,
         uint16_t data)
 {
@@ -414,6 +429,7 @@ static void flash_lld_program_16(FLASHDriver* flashp, uint32_t addr,
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_program_8(FLASHDriver* flashp, uint32_t addr,
         uint8_t data)
 {
@@ -538,6 +554,7 @@ static void flash_lld_ob1_wrp_clear(FLASHDriver* flashp, uint16_t wrp)
  *
  * @param[in] flashp    pointer to the @p FLASHDriver object
  */
+QHAL_HOTFUNC
 static void serve_flash_irq(FLASHDriver* flashp)
 {
     uint32_t sr;
@@ -547,6 +564,40 @@ static void serve_flash_irq(FLASHDriver* flashp)
     f->SR = FLASH_SR_PGSERR | FLASH_SR_PGPERR
             | FLASH_SR_PGAERR | FLASH_SR_WRPERR | FLASH_SR_OPERR
             | FLASH_SR_EOP;
+
+    /* Wake up the thread waiting for an erase. */
+    osalSysLockFromISR();
+    osalThreadResumeI(&flashp->wait, MSG_OK);
+    osalSysUnlockFromISR();
+
+#if FLASH_USE_REQUEST
+    _flash_serve_request_isr(flashp, (sr & (FLASH_SR_PGSERR | FLASH_SR_PGPERR | FLASH_SR_PGAERR |
+            FLASH_SR_WRPERR | FLASH_SR_OPERR)) != 0);
+#else
+    (void)sr;
+#endif /* FLASH_USE_REQUEST */
+}
+
+/**
+ * @brief   Returns the bank of an address.
+ *
+ * @param[in] addr      absolute address, flash aliased at zero is accepted
+ *
+ * @return              The bank number or -1 if not located in flash.
+ *
+ * @notapi
+ */
+static int flash_lld_bank(uint32_t addr)
+{
+    if (addr < FLASH_BASE)
+        addr += FLASH_BASE;
+
+    FLASHSectorInfo info;
+    if (flash_lld_addr_to_sector(addr - FLASH_BASE, &info) != HAL_SUCCESS)
+        return -1;
+
+    /* Sectors 12 to 23 form the second bank. */
+    return info.sector >= 12 ? 1 : 0;
 }
 
 /*===========================================================================*/
@@ -580,6 +631,7 @@ void flash_lld_init(void)
 {
     flashObjectInit(&FLASHD);
     FLASHD.flash = FLASH;
+    FLASHD.wait = NULL;
 }
 
 /**
@@ -701,8 +753,159 @@ void flash_lld_read(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
     memcpy(buffer, (uint8_t*)(FLASH_BASE + startaddr), n);
 }
 
+/**
+ * @brief   Returns the address of flash memory.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ *
+ * @return              The mapped address of @p startaddr.
+ *
+ * @notapi
+ */
+const uint8_t* flash_lld_map(FLASHDriver* flashp, uint32_t startaddr)
+{
+    return (const uint8_t*)(FLASH_BASE + startaddr);
+}
+
+/**
+ * @brief   Checks whether a range of flash is erased.
+ * @details Compares word wise once the address is aligned.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ * @param[in] n         number of bytes to check
+ *
+ * @return              The range state.
+ * @retval true         all bytes are erased.
+ * @retval false        at least one byte is programmed.
+ *
+ * @notapi
+ */
+bool flash_lld_is_erased(FLASHDriver* flashp, uint32_t startaddr, uint32_t n)
+{
+    (void)flashp;
+
+    const uint8_t* p = (const uint8_t*)(FLASH_BASE + startaddr);
+    const uint8_t* end = p + n;
+
+    while (p < end && ((uint32_t)p % sizeof(uint32_t)) != 0)
+        if (*p++ != 0xff)
+            return false;
+
+    while ((uint32_t)(end - p) >= sizeof(uint32_t))
+    {
+        if (*(const uint32_t*)p != 0xffffffff)
+            return false;
+        p += sizeof(uint32_t);
+    }
+
+    while (p < end)
+        if (*p++ != 0xff)
+            return false;
+
+    return true;
+}
+
+/**
+ * @brief   Checks whether a range is located in a bank not used for
+ *          execution.
+ * @details The range must neither share a bank with the vector table nor
+ *          with this driver, the code is assumed to reside in a single bank.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ * @param[in] n         number of bytes, at least one
+ *
+ * @return              The range state.
+ * @retval true         the range can be modified while code keeps running.
+ * @retval false        the range shares a bank with code or vectors.
+ *
+ * @notapi
+ */
+bool flash_lld_is_other_bank(FLASHDriver* flashp, uint32_t startaddr,
+        uint32_t n)
+{
+    (void)flashp;
+
+    int bank = flash_lld_bank(FLASH_BASE + startaddr);
+    if (bank < 0 || bank != flash_lld_bank(FLASH_BASE + startaddr + n - 1))
+        return false;
+
+    return bank != flash_lld_bank(SCB->VTOR)
+            && bank != flash_lld_bank((uint32_t)&flash_lld_is_other_bank);
+}
+
+/**
+ * @brief   Returns whether an operation is ongoing.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ *
+ * @return              The busy state.
+ *
+ * @notapi
+ */
+bool flash_lld_is_busy(FLASHDriver* flashp)
+{
+    return (flashp->flash->SR & FLASH_SR_BSY) != 0;
+}
+
+/**
+ * @brief   Starts programming the next unit of data.
+ * @details Programs the largest unit supported at @p startaddr without
+ *          waiting for completion.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ * @param[in] n         number of bytes left to write, at least one
+ * @param[in] buffer    pointer to data buffer
+ *
+ * @return              The number of bytes being programmed.
+ *
+ * @notapi
+ */
+QHAL_HOTFUNC
+uint32_t flash_lld_write_unit(FLASHDriver* flashp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    uint32_t addr = FLASH_BASE + startaddr;
+
+    switch (flash_lld_get_psize())
+    {
+    case PSIZE_8:
+        if (addr % 8 == 0 && n >= 8)
+        {
+            flash_lld_program_64(flashp, addr, *(uint64_t*)buffer);
+            return 8;
+        }
+        /* fall through */
+    case PSIZE_4:
+        if (addr % 4 == 0 && n >= 4)
+        {
+            flash_lld_program_32(flashp, addr, *(uint32_t*)buffer);
+            return 4;
+        }
+        /* fall through */
+    case PSIZE_2:
+        if (addr % 2 == 0 && n >= 2)
+        {
+            flash_lld_program_16(flashp, addr, *(uint16_t*)buffer);
+            return 2;
+        }
+        /* fall through */
+    case PSIZE_1:
+    default:
+        flash_lld_program_8(flashp, addr, *buffer);
+        return 1;
+    }
+}
+
 /**
  * @brief   Writes data to flash peripheral.
+ * @details The program size is determined once. Unaligned head and tail
+ *          bytes are programmed unit by unit, the aligned middle is
+ *          programmed with @p PG held set, only waiting for @p BSY between
+ *          the words.
  *
  * @param[in] flashp    pointer to the @p FLASHDriver object
  * @param[in] startaddr relative address to start of flash
@@ -711,52 +914,98 @@ void flash_lld_read(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_write(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
         const uint8_t* buffer)
 {
-    uint32_t addr = FLASH_BASE + startaddr;
+    flash_program_size_e psize = flash_lld_get_psize();
+    uint32_t width;
+    switch (psize)
+    {
+    case PSIZE_8:
+        width = 8;
+        break;
+    case PSIZE_4:
+        width = 4;
+        break;
+    case PSIZE_2:
+        width = 2;
+        break;
+    case PSIZE_1:
+    default:
+        width = 1;
+        break;
+    }
+
+    /* Unaligned head. */
     uint32_t offset = 0;
-    while (offset < n)
+    while (offset < n && (FLASH_BASE + startaddr + offset) % width != 0)
+        offset += flash_lld_write_unit(flashp, startaddr + offset,
+                n - offset, buffer + offset);
+
+    /* Aligned middle. */
+    uint32_t end = offset + (n - offset) / width * width;
+    if (offset < end)
     {
-        switch (flash_lld_get_psize())
+        flash_lld_sync(flashp);
+
+        flash_lld_cr_unlock(flashp);
+
+        /* Set psize. */
+        flashp->flash->CR &= ~(FLASH_CR_PSIZE_1 | FLASH_CR_PSIZE_0);
+        flashp->flash->CR |= psize;
+
+        /* Set operation to perform. */
+        flashp->flash->CR &= ~(FLASH_CR_MER | FLASH_CR_SER | FLASH_CR_PG);
+        flashp->flash->CR |= FLASH_CR_PG;
+
+        flash_lld_cr_lock(flashp);
+
+        /* The buffer may be unaligned, data is copied to a local first. */
+        uint32_t addr = FLASH_BASE + startaddr;
+        switch (width)
         {
-        case PSIZE_8:
-            if (addr % 8 == 0 && (n - offset) >= 8)
+        case 8:
+            for (; offset < end; offset += 8)
             {
-                flash_lld_program_64(flashp, addr, *(uint64_t*)(buffer + offset));
-                addr += 8;
-                offset += 8;
-                break;
+                uint64_t data;
+                memcpy(&data, buffer + offset, 8);
+                *(__O uint64_t*)(addr + offset) = data;
+                while (flashp->flash->SR & FLASH_SR_BSY);
             }
-            /* fall through */
-        case PSIZE_4:
-            if (addr % 4 == 0 && (n - offset) >= 4)
+            break;
+        case 4:
+            for (; offset < end; offset += 4)
             {
-                flash_lld_program_32(flashp, addr, *(uint32_t*)(buffer + offset));
-                addr += 4;
-                offset += 4;
-                break;
+                uint32_t data;
+                memcpy(&data, buffer + offset, 4);
+                *(__O uint32_t*)(addr + offset) = data;
+                while (flashp->flash->SR & FLASH_SR_BSY);
             }
-            /* fall through */
-        case PSIZE_2:
-            if (addr % 2 == 0 && (n - offset) >= 2)
+            break;
+        case 2:
+            for (; offset < end; offset += 2)
             {
-                flash_lld_program_16(flashp, addr, *(uint16_t*)(buffer + offset));
-                addr += 2;
-                offset += 2;
-                break;
+                uint16_t data;
+                memcpy(&data, buffer + offset, 2);
+                *(__O uint16_t*)(addr + offset) = data;
+                while (flashp->flash->SR & FLASH_SR_BSY);
             }
-            /* fall through */
-        case PSIZE_1:
-            if ((n - offset) >= 1)
+            break;
+        default:
+            for (; offset < end; offset++)
             {
-                flash_lld_program_8(flashp, addr, *(uint8_t*)(buffer + offset));
-                addr += 1;
-                offset += 1;
-                break;
+                *(__O uint8_t*)(addr + offset) = buffer[offset];
+                while (flashp->flash->SR & FLASH_SR_BSY);
             }
+            break;
         }
     }
+
+    /* Unaligned tail. */
+    while (offset < n)
+        offset += flash_lld_write_unit(flashp, startaddr + offset,
+                n - offset, buffer + offset);
 }
 
 /**
@@ -767,6 +1016,7 @@ void flash_lld_write(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_erase_sector(FLASHDriver* flashp, uint32_t startaddr)
 {
     FLASHSectorInfo info;
@@ -802,6 +1052,7 @@ void flash_lld_erase_sector(FLASHDriver* flashp, uint32_t startaddr)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_erase_mass(FLASHDriver* flashp)
 {
     flash_lld_cr_unlock(flashp);
@@ -823,15 +1074,26 @@ void flash_lld_erase_mass(FLASHDriver* flashp)
 
 /**
  * @brief   Waits for FLASH peripheral to become idle.
+ * @details Erases are waited for by suspending the calling thread until the
+ *          end of operation interrupt, programming is polled.
+ * @note    Must be called from thread context while erasing.
  *
  * @param[in] flashp    pointer to the @p FLASHDriver object
  *
- * @notapi
+ * @sclass
  */
+QHAL_HOTFUNC
 void flash_lld_sync(FLASHDriver* flashp)
 {
     while (flashp->flash->SR & FLASH_SR_BSY)
     {
+        if ((flashp->flash->CR & (FLASH_CR_SER | FLASH_CR_MER)) != 0)
+        {
+            /* The interrupt is pending until the kernel is unlocked. */
+            osalThreadSuspendS(&flashp->wait);
+            continue;
+        }
+
 #if FLASH_NICE_WAITING
         /* Trying to be nice with the other threads. */
         osalSysUnlock();
@@ -862,6 +1124,17 @@ void flash_lld_get_info(FLASHDriver* flashp, NVMDeviceInfo* nvmdip)
     nvmdip->identification[2] = '2';
     /* Note: This chip can be written byte by byte. */
     nvmdip->write_alignment = 0;
+    nvmdip->page_size = 0;
+    nvmdip->erase_sizes[0] = 16 * 1024;
+    nvmdip->erase_sizes[1] = 64 * 1024;
+    nvmdip->erase_sizes[2] = 128 * 1024;
+    /* Note: Typical and maximum datasheet values for x32 parallelism
+     * and a 16k sector. */
+    nvmdip->timing.program_typ = 16;
+    nvmdip->timing.program_max = 100;
+    nvmdip->timing.erase_typ = 400000;
+    nvmdip->timing.erase_max = 800000;
+    nvmdip->memory_mapped = true;
 }
 
 /**
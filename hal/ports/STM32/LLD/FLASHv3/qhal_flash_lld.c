@@ -60,6 +60,18 @@
 #define FLASH_SECTOR_SIZE 2048
 #endif
 
+/**
+ * @brief   Flash fast programming row size
+ */
+#define FLASH_ROW_SIZE 256
+
+/**
+ * @brief   Flash programming error flags
+ */
+#define FLASH_SR_PROGRAM_ERRORS (FLASH_SR_FASTERR | FLASH_SR_MISERR |       \
+        FLASH_SR_PGSERR | FLASH_SR_SIZERR | FLASH_SR_PGAERR |               \
+        FLASH_SR_WRPERR | FLASH_SR_PROGERR | FLASH_SR_OPERR)
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -84,6 +96,7 @@ FLASHDriver FLASHD;
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_cr_lock(FLASHDriver* flashp)
 {
     flashp->flash->CR |= FLASH_CR_LOCK;
@@ -96,6 +109,7 @@ static void flash_lld_cr_lock(FLASHDriver* flashp)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_cr_unlock(FLASHDriver* flashp)
 {
     static const uint32_t FLASH_UNLOCK_KEY1 = 0x45670123;
@@ -148,6 +162,7 @@ static void flash_lld_optcr_unlock(FLASHDriver* flashp)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 static void flash_lld_program_64(FLASHDriver* flashp, uint32_t addr,
         uint64_t data)
 {
@@ -166,6 +181,86 @@ static void flash_lld_program_64(FLASHDriver* flashp, uint32_t addr,
     flash_lld_cr_lock(flashp);
 }
 
+/**
+ * @brief   Fast programs a row of flash memory.
+ * @details Runs from RAM with all interrupts masked, the flash memory must
+ *          not be accessed until the whole row has been programmed.
+ * @pre     The CR register is unlocked and the flash memory is idle.
+ *
+ * @param[in] fp        pointer to the FLASH registers block
+ * @param[in] addr      absolute address, aligned to @p FLASH_ROW_SIZE
+ * @param[in] data      row data located in RAM
+ *
+ * @return              The error flags of the operation.
+ *
+ * @notapi
+ */
+QHAL_RAMFUNC
+static uint32_t flash_lld_program_row_ram(FLASH_TypeDef* fp, uint32_t addr,
+        const uint32_t* data)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    fp->SR = FLASH_SR_PROGRAM_ERRORS;
+
+    /* Set operation to perform. */
+    fp->CR &= ~(FLASH_CR_FSTPG | FLASH_CR_MER2 | FLASH_CR_PNB |
+            FLASH_CR_MER1 | FLASH_CR_PER | FLASH_CR_PG);
+    fp->CR |= FLASH_CR_FSTPG;
+
+    for (uint32_t i = 0; i < FLASH_ROW_SIZE / 4; i++)
+        ((__IO uint32_t*)addr)[i] = data[i];
+
+    while (fp->SR & FLASH_SR_BSY);
+
+    uint32_t sr = fp->SR;
+    fp->CR &= ~FLASH_CR_FSTPG;
+
+    __set_PRIMASK(primask);
+
+    return sr & FLASH_SR_PROGRAM_ERRORS;
+}
+
+/**
+ * @brief   Programs an erased row of flash memory.
+ * @details Uses fast programming. If the controller refuses it, e.g. when
+ *          the bank was not mass erased before, the double words left erased
+ *          are programmed the standard way.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] addr      absolute address, aligned to @p FLASH_ROW_SIZE
+ * @param[in] buffer    pointer to data buffer
+ *
+ * @notapi
+ */
+QHAL_HOTFUNC
+static void flash_lld_program_row(FLASHDriver* flashp, uint32_t addr,
+        const uint8_t* buffer)
+{
+    /* The source may be located in flash memory itself. */
+    uint32_t row[FLASH_ROW_SIZE / 4];
+    memcpy(row, buffer, FLASH_ROW_SIZE);
+
+    flash_lld_sync(flashp);
+
+    flash_lld_cr_unlock(flashp);
+    uint32_t errors = flash_lld_program_row_ram(flashp->flash, addr, row);
+    flash_lld_cr_lock(flashp);
+
+    if (errors == 0)
+        return;
+
+    for (uint32_t offset = 0; offset < FLASH_ROW_SIZE; offset += 8)
+    {
+        uint64_t data;
+        memcpy(&data, (const uint8_t*)row + offset, 8);
+        if (*(__I uint64_t*)(addr + offset) == 0xffffffffffffffffULL &&
+                data != 0xffffffffffffffffULL)
+            flash_lld_program_64(flashp, addr + offset, data);
+    }
+}
+
 #if 0
 /**
  * @brief   Programs a 32bit word of data to option flash memory
@@ -313,6 +408,7 @@ static void flash_lld_ob_wrp_write(FLASHDriver* flashp, uint32_t bitmask)
  *
  * @param[in] flashp    pointer to the @p FLASHDriver object
  */
+QHAL_HOTFUNC
 static void serve_flash_irq(FLASHDriver* flashp)
 {
     uint32_t sr;
@@ -323,6 +419,41 @@ static void serve_flash_irq(FLASHDriver* flashp)
             FLASH_SR_MISERR | FLASH_SR_PGSERR | FLASH_SR_SIZERR |
             FLASH_SR_PGAERR | FLASH_SR_WRPERR | FLASH_SR_PROGERR |
             FLASH_SR_OPERR | FLASH_SR_EOP;
+
+#if FLASH_USE_REQUEST
+    _flash_serve_request_isr(flashp, (sr & (FLASH_SR_OPTVERR | FLASH_SR_RDERR | FLASH_SR_FASTERR |
+            FLASH_SR_MISERR | FLASH_SR_PGSERR | FLASH_SR_SIZERR |
+            FLASH_SR_PGAERR | FLASH_SR_WRPERR | FLASH_SR_PROGERR |
+            FLASH_SR_OPERR)) != 0);
+#else
+    (void)sr;
+#endif /* FLASH_USE_REQUEST */
+}
+
+/**
+ * @brief   Returns the bank of an address.
+ *
+ * @param[in] addr      absolute address, flash aliased at zero is accepted
+ *
+ * @return              The bank number or -1 if not located in flash.
+ *
+ * @notapi
+ */
+static int flash_lld_bank(uint32_t addr)
+{
+    if (addr < FLASH_BASE)
+        addr += FLASH_BASE;
+
+    uint32_t size =
+            (uint32_t)(*((__I uint16_t*)FLASH_SIZE_REGISTER_ADDRESS)) * 1024;
+    if (addr - FLASH_BASE >= size)
+        return -1;
+
+    /* 1MB devices are always dual bank, smaller ones by option. */
+    if (size < 1024 * 1024 && (FLASH->OPTR & FLASH_OPTR_DUALBANK) == 0)
+        return 0;
+
+    return addr - FLASH_BASE >= size / 2 ? 1 : 0;
 }
 
 /*===========================================================================*/
@@ -467,8 +598,131 @@ void flash_lld_read(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
     memcpy(buffer, (uint8_t*)(FLASH_BASE + startaddr), n);
 }
 
+/**
+ * @brief   Returns the address of flash memory.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ *
+ * @return              The mapped address of @p startaddr.
+ *
+ * @notapi
+ */
+const uint8_t* flash_lld_map(FLASHDriver* flashp, uint32_t startaddr)
+{
+    return (const uint8_t*)(FLASH_BASE + startaddr);
+}
+
+/**
+ * @brief   Checks whether a range of flash is erased.
+ * @details Compares word wise once the address is aligned.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ * @param[in] n         number of bytes to check
+ *
+ * @return              The range state.
+ * @retval true         all bytes are erased.
+ * @retval false        at least one byte is programmed.
+ *
+ * @notapi
+ */
+bool flash_lld_is_erased(FLASHDriver* flashp, uint32_t startaddr, uint32_t n)
+{
+    (void)flashp;
+
+    const uint8_t* p = (const uint8_t*)(FLASH_BASE + startaddr);
+    const uint8_t* end = p + n;
+
+    while (p < end && ((uint32_t)p % sizeof(uint32_t)) != 0)
+        if (*p++ != 0xff)
+            return false;
+
+    while ((uint32_t)(end - p) >= sizeof(uint32_t))
+    {
+        if (*(const uint32_t*)p != 0xffffffff)
+            return false;
+        p += sizeof(uint32_t);
+    }
+
+    while (p < end)
+        if (*p++ != 0xff)
+            return false;
+
+    return true;
+}
+
+/**
+ * @brief   Checks whether a range is located in a bank not used for
+ *          execution.
+ * @details The range must neither share a bank with the vector table nor
+ *          with this driver, the code is assumed to reside in a single bank.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ * @param[in] n         number of bytes, at least one
+ *
+ * @return              The range state.
+ * @retval true         the range can be modified while code keeps running.
+ * @retval false        the range shares a bank with code or vectors.
+ *
+ * @notapi
+ */
+bool flash_lld_is_other_bank(FLASHDriver* flashp, uint32_t startaddr,
+        uint32_t n)
+{
+    (void)flashp;
+
+    int bank = flash_lld_bank(FLASH_BASE + startaddr);
+    if (bank < 0 || bank != flash_lld_bank(FLASH_BASE + startaddr + n - 1))
+        return false;
+
+    return bank != flash_lld_bank(SCB->VTOR)
+            && bank != flash_lld_bank((uint32_t)&flash_lld_is_other_bank);
+}
+
+/**
+ * @brief   Returns whether an operation is ongoing.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ *
+ * @return              The busy state.
+ *
+ * @notapi
+ */
+bool flash_lld_is_busy(FLASHDriver* flashp)
+{
+    return (flashp->flash->SR & FLASH_SR_BSY) != 0;
+}
+
+/**
+ * @brief   Starts programming the next unit of data.
+ * @details Programs the largest unit supported at @p startaddr without
+ *          waiting for completion.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr relative address to start of flash
+ * @param[in] n         number of bytes left to write, at least one
+ * @param[in] buffer    pointer to data buffer
+ *
+ * @return              The number of bytes being programmed.
+ *
+ * @notapi
+ */
+QHAL_HOTFUNC
+uint32_t flash_lld_write_unit(FLASHDriver* flashp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    (void)n;
+
+    flash_lld_program_64(flashp, FLASH_BASE + startaddr, *(uint64_t*)buffer);
+    return 8;
+}
+
 /**
  * @brief   Writes data to flash peripheral.
+ * @details Whole rows which are erased are fast programmed, everything else
+ *          is programmed double word by double word.
  *
  * @param[in] flashp    pointer to the @p FLASHDriver object
  * @param[in] startaddr relative address to start of flash
@@ -477,19 +731,28 @@ void flash_lld_read(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_write(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
         const uint8_t* buffer)
 {
     /* Verify that we are writing properly bounded address and size. */
     osalDbgAssert((startaddr % 8) == 0 && (n % 8) == 0, "invalid parameters");
 
-    uint32_t addr = FLASH_BASE + startaddr;
     uint32_t offset = 0;
     while (offset < n)
     {
-        flash_lld_program_64(flashp, addr, *(uint64_t*)(buffer + offset));
-        addr += 8;
-        offset += 8;
+        uint32_t addr = FLASH_BASE + startaddr + offset;
+        if (addr % FLASH_ROW_SIZE == 0 && n - offset >= FLASH_ROW_SIZE &&
+                flash_lld_is_erased(flashp, startaddr + offset,
+                        FLASH_ROW_SIZE))
+        {
+            flash_lld_program_row(flashp, addr, buffer + offset);
+            offset += FLASH_ROW_SIZE;
+            continue;
+        }
+
+        offset += flash_lld_write_unit(flashp, startaddr + offset,
+                n - offset, buffer + offset);
     }
 }
 
@@ -501,6 +764,7 @@ void flash_lld_write(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_erase_sector(FLASHDriver* flashp, uint32_t startaddr)
 {
     flash_lld_cr_unlock(flashp);
@@ -523,6 +787,7 @@ void flash_lld_erase_sector(FLASHDriver* flashp, uint32_t startaddr)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_erase_mass(FLASHDriver* flashp)
 {
     flash_lld_cr_unlock(flashp);
@@ -545,6 +810,7 @@ void flash_lld_erase_mass(FLASHDriver* flashp)
  *
  * @notapi
  */
+QHAL_HOTFUNC
 void flash_lld_sync(FLASHDriver* flashp)
 {
     while (flashp->flash->SR & FLASH_SR_BSY)
@@ -578,6 +844,15 @@ void flash_lld_get_info(FLASHDriver* flashp, NVMDeviceInfo* nvmdip)
      * Also the chip can not write a word which is not 0xffffffffffffffff so
      * we have no way to hide this drawback from the user.*/
     nvmdip->write_alignment = 8;
+    nvmdip->page_size = 8;
+    memset(nvmdip->erase_sizes, 0, sizeof(nvmdip->erase_sizes));
+    nvmdip->erase_sizes[0] = FLASH_SECTOR_SIZE;
+    /* Note: Typical and maximum datasheet values. */
+    nvmdip->timing.program_typ = 82;
+    nvmdip->timing.program_max = 91;
+    nvmdip->timing.erase_typ = 22020;
+    nvmdip->timing.erase_max = 24470;
+    nvmdip->memory_mapped = true;
 }
 
 /**
@@ -233,7 +233,12 @@ typedef struct
      */
     FLASH_TypeDef* flash;
 #if FLASH_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
-#if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
+#if FLASH_USE_RW_LOCK || defined(__DOXYGEN__)
+    /**
+     * @brief rwlock_t protecting the device.
+     */
+    rwlock_t lock;
+#elif CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
     /**
      * @brief mutex_t protecting the device.
      */
@@ -242,6 +247,16 @@ typedef struct
     semaphore_t semaphore;
 #endif
 #endif /* FLASH_USE_MUTUAL_EXCLUSION */
+#if FLASH_USE_REQUEST || defined(__DOXYGEN__)
+    /**
+     * @brief Request in progress or @p NULL.
+     */
+    NVMRequest* request;
+    /**
+     * @brief Bytes of the request in progress already started.
+     */
+    uint32_t request_offset;
+#endif /* FLASH_USE_REQUEST */
 } FLASHDriver;
 
 typedef struct
@@ -271,6 +286,14 @@ extern "C" {
     bool flash_lld_addr_to_sector(uint32_t addr, FLASHSectorInfo* sinfo);
     void flash_lld_read(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
             uint8_t* buffer);
+    bool flash_lld_is_erased(FLASHDriver* flashp, uint32_t startaddr,
+            uint32_t n);
+    bool flash_lld_is_other_bank(FLASHDriver* flashp, uint32_t startaddr,
+            uint32_t n);
+    bool flash_lld_is_busy(FLASHDriver* flashp);
+    const uint8_t* flash_lld_map(FLASHDriver* flashp, uint32_t startaddr);
+    uint32_t flash_lld_write_unit(FLASHDriver* flashp, uint32_t startaddr,
+            uint32_t n, const uint8_t* buffer);
     void flash_lld_write(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
             const uint8_t* buffer);
     void flash_lld_erase_sector(FLASHDriver* flashp, uint32_t startaddr);
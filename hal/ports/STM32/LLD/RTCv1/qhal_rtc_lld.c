@@ -48,6 +48,32 @@
 /* Driver exported functions.                                                */
 /*===========================================================================*/
 
+/**
+ * @brief   Gets the RTC time in microseconds since 1970-01-01.
+ * @details The resolution is one RTCCLK period. The value only goes back
+ *          when the RTC time is set.
+ *
+ * @param[in] rtcp          pointer to RTC driver structure
+ * @return                  The timestamp.
+ *
+ * @xclass
+ */
+uint64_t rtcGetTimestampUsX(RTCDriver *rtcp)
+{
+    uint32_t cnt, div;
+
+    /* The counter halves and the divider are read separately, repeats if
+       the counter moved meanwhile.*/
+    do
+    {
+        cnt = ((uint32_t)rtcp->rtc->CNTH << 16) + rtcp->rtc->CNTL;
+        div = ((uint32_t)rtcp->rtc->DIVH << 16) + rtcp->rtc->DIVL;
+    } while (cnt != ((uint32_t)rtcp->rtc->CNTH << 16) + rtcp->rtc->CNTL);
+
+    return (uint64_t)cnt * 1000000 +
+            (uint64_t)(STM32_RTCCLK - 1 - div) * 1000000 / STM32_RTCCLK;
+}
+
 #endif /* HAL_USE_RTC */
 
 /** @} */
@@ -42,6 +42,24 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns the days from 1970-01-01 to a date.
+ * @note    Proleptic Gregorian calendar, valid for the years of the RTC.
+ */
+static uint32_t rtc_days_from_civil(uint32_t year, uint32_t month, uint32_t day)
+{
+    /* Years starting in March put the leap day at the end.*/
+    if (month <= 2)
+        year -= 1;
+
+    uint32_t era = year / 400;
+    uint32_t yoe = year - era * 400;
+    uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + doe - 719468;
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -50,6 +68,60 @@
 /* Driver exported functions.                                                */
 /*===========================================================================*/
 
+/**
+ * @brief   Gets the RTC time in microseconds since 1970-01-01.
+ * @details Reads the calendar and the sub-second registers without waiting
+ *          for the shadow registers to resynchronize, the value may lag the
+ *          RTC by two RTCCLK periods. The resolution is one period of the
+ *          synchronous prescaler output. The value only goes back when the
+ *          RTC time is set.
+ * @note    The RTC must run in 24 hour format, as set by the HAL driver.
+ *
+ * @param[in] rtcp          pointer to RTC driver structure
+ * @return                  The timestamp.
+ *
+ * @xclass
+ */
+uint64_t rtcGetTimestampUsX(RTCDriver *rtcp)
+{
+    uint32_t ssr = 0, tr, dr;
+
+    /* Reading SSR locks TR and DR until DR is read.*/
+    syssts_t sts = osalSysGetStatusAndLockX();
+#if STM32_RTC_HAS_SUBSECONDS
+    ssr = rtcp->rtc->SSR;
+#endif
+    tr = rtcp->rtc->TR;
+    dr = rtcp->rtc->DR;
+    osalSysRestoreStatusX(sts);
+
+    uint32_t year = 2000 + ((dr >> 20) & 0xf) * 10 + ((dr >> 16) & 0xf);
+    uint32_t month = ((dr >> 12) & 0x1) * 10 + ((dr >> 8) & 0xf);
+    uint32_t day = ((dr >> 4) & 0x3) * 10 + (dr & 0xf);
+    uint32_t seconds = (((tr >> 20) & 0x3) * 10 + ((tr >> 16) & 0xf)) * 3600 +
+            (((tr >> 12) & 0x7) * 10 + ((tr >> 8) & 0xf)) * 60 +
+            ((tr >> 4) & 0x7) * 10 + (tr & 0xf);
+
+    uint64_t us = ((uint64_t)rtc_days_from_civil(year, month, day) * 86400 +
+            seconds) * 1000000;
+
+#if STM32_RTC_HAS_SUBSECONDS
+    uint32_t prediv_s = rtcp->rtc->PRER & RTC_PRER_PREDIV_S;
+    uint32_t ticks = prediv_s - ssr;
+
+    /* After a shift operation SSR may exceed PREDIV_S, the calendar is then
+       one second ahead.*/
+    if (ssr > prediv_s)
+    {
+        us -= 1000000;
+        ticks += prediv_s + 1;
+    }
+    us += (uint64_t)ticks * 1000000 / (prediv_s + 1);
+#endif
+
+    return us;
+}
+
 /**
  * @brief     Gets status of the periodic wake-up flag.
  *
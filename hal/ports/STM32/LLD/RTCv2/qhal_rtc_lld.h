@@ -56,6 +56,7 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+  uint64_t rtcGetTimestampUsX(RTCDriver *rtcp);
 #if STM32_RTC_HAS_PERIODIC_WAKEUPS
   bool rtcGetPeriodicWakeupFlag_v2(RTCDriver *rtcp);
   void rtcClearPeriodicWakeupFlag_v2(RTCDriver *rtcp);
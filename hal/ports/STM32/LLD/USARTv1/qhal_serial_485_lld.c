@@ -76,6 +76,9 @@ Serial485Driver S485D8;
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+/* Interrupt service time of all channels.*/
+QHAL_PERF_REGION(s485_isr)
+
 /** @brief Driver default configuration.*/
 static const Serial485Config default_config =
 {
@@ -111,12 +114,42 @@ static void usart_init(Serial485Driver *s485dp, const Serial485Config *config) {
   else
     u->BRR = STM32_PCLK1 / config->speed;
 
+#if STM32_SERIAL_485_USE_DMA
+  /* Circular reception, restarted from the buffer origin.*/
+  dmaStreamDisable(s485dp->dmarx);
+  dmaStreamDisable(s485dp->dmatx);
+  s485dp->rxdmapos = 0;
+  s485dp->txdmasize = 0;
+  s485dp->txdmaframe = false;
+  dmaStreamSetPeripheral(s485dp->dmarx, &u->DR);
+  dmaStreamSetMemory0(s485dp->dmarx, s485dp->rxdmabuf);
+  dmaStreamSetTransactionSize(s485dp->dmarx,
+                              STM32_SERIAL_485_RX_DMA_BUFFER_SIZE);
+  dmaStreamSetMode(s485dp->dmarx, s485dp->rxdmamode);
+  dmaStreamEnable(s485dp->dmarx);
+  dmaStreamSetPeripheral(s485dp->dmatx, &u->DR);
+
+  /* Note that some bits are enforced.*/
+  u->CR2 = config->cr2 | USART_CR2_LBDIE;
+  u->CR3 = config->cr3 | USART_CR3_EIE | USART_CR3_DMAR | USART_CR3_DMAT;
+  u->CR1 = config->cr1 | USART_CR1_UE | USART_CR1_PEIE |
+                         USART_CR1_IDLEIE | USART_CR1_TE |
+                         USART_CR1_RE;
+#else
   /* Note that some bits are enforced.*/
   u->CR2 = config->cr2 | USART_CR2_LBDIE;
   u->CR3 = config->cr3 | USART_CR3_EIE;
+#if SERIAL_485_USE_FRAMES
+  /* Idle line ends received frames.*/
+  u->CR1 = config->cr1 | USART_CR1_UE | USART_CR1_PEIE |
+                         USART_CR1_RXNEIE | USART_CR1_IDLEIE |
+                         USART_CR1_TE | USART_CR1_RE;
+#else
   u->CR1 = config->cr1 | USART_CR1_UE | USART_CR1_PEIE |
                          USART_CR1_RXNEIE | USART_CR1_TE |
                          USART_CR1_RE;
+#endif
+#endif /* STM32_SERIAL_485_USE_DMA */
   u->SR = 0;
   (void)u->SR;  /* SR reset step 1.*/
   (void)u->DR;  /* SR reset step 2.*/
@@ -155,15 +188,210 @@ static void set_error(Serial485Driver *s485dp, uint16_t sr) {
   chnAddFlagsI(s485dp, sts);
 }
 
+#if STM32_SERIAL_485_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   Moves received bytes from the DMA buffer to the input queue.
+ * @details In frame mode the bytes are moved to the frame being received.
+ * @note    Must be called with the kernel locked.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ */
+static void rx_dma_drain(Serial485Driver *s485dp) {
+  size_t pos = STM32_SERIAL_485_RX_DMA_BUFFER_SIZE -
+               dmaStreamGetTransactionSize(s485dp->dmarx);
+  uint8_t mask = 0xff;
+
+  if (pos >= STM32_SERIAL_485_RX_DMA_BUFFER_SIZE)
+    pos = 0;
+  if (pos == s485dp->rxdmapos)
+    return;
+
+  /* Mask parity bit according to configuration. */
+  if ((s485dp->usart->CR1 & (USART_CR1_PCE | USART_CR1_M)) == USART_CR1_PCE)
+    mask = 0x7f;
+
+#if SERIAL_485_USE_FRAMES
+  if (s485dp->framemode) {
+    while (s485dp->rxdmapos != pos) {
+      s485dFrameDataI(s485dp, s485dp->rxdmabuf[s485dp->rxdmapos] & mask);
+      if (++s485dp->rxdmapos >= STM32_SERIAL_485_RX_DMA_BUFFER_SIZE)
+        s485dp->rxdmapos = 0;
+    }
+    return;
+  }
+#endif
+
+  if (iqIsEmptyI(&s485dp->iqueue))
+    chnAddFlagsI(s485dp, CHN_INPUT_AVAILABLE);
+  while (s485dp->rxdmapos != pos) {
+    if (iqPutI(&s485dp->iqueue,
+               s485dp->rxdmabuf[s485dp->rxdmapos] & mask) < Q_OK)
+      chnAddFlagsI(s485dp, S485D_OVERRUN_ERROR);
+    if (++s485dp->rxdmapos >= STM32_SERIAL_485_RX_DMA_BUFFER_SIZE)
+      s485dp->rxdmapos = 0;
+  }
+}
+
+/**
+ * @brief   Starts transmitting the contiguous span of the output queue.
+ * @details A pending frame is sent first, directly from its buffer.
+ * @note    Must be called with the kernel locked and no transmission in
+ *          progress.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ */
+static void tx_dma_start(Serial485Driver *s485dp) {
+  output_queue_t *oqp = &s485dp->oqueue;
+  USART_TypeDef *u = s485dp->usart;
+  const uint8_t *bp = oqp->q_rdptr;
+  size_t n;
+
+#if SERIAL_485_USE_FRAMES
+  s485dp->txdmaframe = (s485dp->txframe != NULL) && (s485dp->txframe_n > 0);
+  if (s485dp->txdmaframe) {
+    bp = s485dp->txframe;
+    n = s485dp->txframe_n;
+    s485dp->txframe += n;
+    s485dp->txframe_n = 0;
+  }
+  else
+#endif
+  {
+    n = oqGetFullI(oqp);
+    if (n == 0)
+      return;
+    if (n > (size_t)(oqp->q_top - oqp->q_rdptr))
+      n = (size_t)(oqp->q_top - oqp->q_rdptr);
+  }
+  s485dp->txdmasize = n;
+
+  /* Disable RX and pending transmission end, set driver enable pad. */
+  u->CR1 &= ~(USART_CR1_RE | USART_CR1_TCIE);
+  if (s485dp->config->ssport != NULL)
+    palSetPad(s485dp->config->ssport, s485dp->config->sspad);
+  u->SR = ~USART_SR_TC;
+
+  dmaStreamSetMemory0(s485dp->dmatx, bp);
+  dmaStreamSetTransactionSize(s485dp->dmatx, n);
+  dmaStreamSetMode(s485dp->dmatx, s485dp->txdmamode);
+  dmaStreamEnable(s485dp->dmatx);
+}
+
+/**
+ * @brief   RX DMA half and full buffer handler.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[in] flags     pre-shifted content of the ISR register
+ */
+QHAL_HOTFUNC
+static void serve_rx_dma_interrupt(Serial485Driver *s485dp, uint32_t flags) {
+
+  (void)flags;
+
+  osalSysLockFromISR();
+  rx_dma_drain(s485dp);
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   TX DMA end handler.
+ * @details Releases the transmitted span from the output queue and starts
+ *          the next one, waits for the physical transmission end otherwise.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[in] flags     pre-shifted content of the ISR register
+ */
+QHAL_HOTFUNC
+static void serve_tx_dma_interrupt(Serial485Driver *s485dp, uint32_t flags) {
+  output_queue_t *oqp = &s485dp->oqueue;
+
+  (void)flags;
+
+  dmaStreamDisable(s485dp->dmatx);
+
+  osalSysLockFromISR();
+#if SERIAL_485_USE_FRAMES
+  if (s485dp->txdmaframe) {
+    /* Frame buffer done, the sender is woken at the transmission end.*/
+    s485dp->txdmasize = 0;
+    s485dp->txdmaframe = false;
+    s485dp->usart->CR1 |= USART_CR1_TCIE;
+    osalSysUnlockFromISR();
+    return;
+  }
+#endif
+  oqp->q_rdptr += s485dp->txdmasize;
+  if (oqp->q_rdptr >= oqp->q_top)
+    oqp->q_rdptr = oqp->q_buffer;
+  oqp->q_counter += s485dp->txdmasize;
+  s485dp->txdmasize = 0;
+  osalThreadDequeueAllI(&oqp->q_waiting, Q_OK);
+
+  if (oqIsEmptyI(oqp)) {
+    chnAddFlagsI(s485dp, CHN_OUTPUT_EMPTY);
+    s485dp->usart->CR1 |= USART_CR1_TCIE;
+  }
+  else
+    tx_dma_start(s485dp);
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Output queue notification in DMA mode.
+ *
+ * @param[in] qp        the output queue
+ */
+static void notify_dma(io_queue_t *qp) {
+  Serial485Driver *s485dp = qp->q_link;
+
+  if ((s485dp->state == S485D_READY) && (s485dp->txdmasize == 0))
+    tx_dma_start(s485dp);
+}
+
+/**
+ * @brief   Initializes the DMA related driver fields.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[in] rxid      RX DMA stream identifier
+ * @param[in] rxchmsk   RX DMA channels mask
+ * @param[in] txid      TX DMA stream identifier
+ * @param[in] txchmsk   TX DMA channels mask
+ */
+static void dma_object_init(Serial485Driver *s485dp, uint32_t rxid,
+                            uint32_t rxchmsk, uint32_t txid,
+                            uint32_t txchmsk) {
+
+  uint32_t rxch = STM32_DMA_GETCHANNEL(rxid, rxchmsk);
+  uint32_t txch = STM32_DMA_GETCHANNEL(txid, txchmsk);
+
+  s485dp->dmarx = STM32_DMA_STREAM(rxid);
+  s485dp->dmatx = STM32_DMA_STREAM(txid);
+  s485dp->rxdmamode = STM32_DMA_CR_CHSEL(rxch) |
+                      STM32_DMA_CR_PL(STM32_SERIAL_485_DMA_PRIORITY) |
+                      STM32_DMA_CR_DIR_P2M | STM32_DMA_CR_MINC |
+                      STM32_DMA_CR_CIRC | STM32_DMA_CR_HTIE |
+                      STM32_DMA_CR_TCIE;
+  s485dp->txdmamode = STM32_DMA_CR_CHSEL(txch) |
+                      STM32_DMA_CR_PL(STM32_SERIAL_485_DMA_PRIORITY) |
+                      STM32_DMA_CR_DIR_M2P | STM32_DMA_CR_MINC |
+                      STM32_DMA_CR_TCIE;
+  s485dp->rxdmapos = 0;
+  s485dp->txdmasize = 0;
+  s485dp->txdmaframe = false;
+}
+#endif /* STM32_SERIAL_485_USE_DMA */
+
 /**
  * @brief   Common IRQ handler.
  *
  * @param[in] s485dp    communication channel associated to the USART
  */
+QHAL_HOTFUNC
 static void serve_interrupt(Serial485Driver *s485dp) {
   USART_TypeDef *u = s485dp->usart;
   uint16_t cr1 = u->CR1;
   uint16_t sr = u->SR;
+  QHAL_PERF_BEGIN(s485_isr);
 
   /* Special case, LIN break detection.*/
   if (sr & USART_SR_LBD) {
@@ -173,6 +401,24 @@ static void serve_interrupt(Serial485Driver *s485dp) {
     osalSysUnlockFromISR();
   }
 
+#if STM32_SERIAL_485_USE_DMA
+  /* Idle line or errors, the data is fetched by the DMA.*/
+  if (sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_NE | USART_SR_FE |
+            USART_SR_PE)) {
+    osalSysLockFromISR();
+    if (sr & (USART_SR_ORE | USART_SR_NE | USART_SR_FE | USART_SR_PE))
+      set_error(s485dp, sr);
+    /* SR reset step 2, step 1 was reading SR above.*/
+    if (!(sr & USART_SR_RXNE))
+      (void)u->DR;
+    rx_dma_drain(s485dp);
+#if SERIAL_485_USE_FRAMES
+    if ((sr & USART_SR_IDLE) && s485dp->framemode)
+      s485dFrameEndI(s485dp);
+#endif
+    osalSysUnlockFromISR();
+  }
+#else
   /* Data available.*/
   osalSysLockFromISR();
   while (sr & (USART_SR_RXNE | USART_SR_ORE | USART_SR_NE | USART_SR_FE |
@@ -196,11 +442,25 @@ static void serve_interrupt(Serial485Driver *s485dp) {
       default:
           break;
       }
+#if SERIAL_485_USE_FRAMES
+      if (s485dp->framemode)
+        s485dFrameDataI(s485dp, (uint8_t)b);
+      else
+#endif
       s485dIncomingDataI(s485dp, b);
     }
     sr = u->SR;
   }
+#if SERIAL_485_USE_FRAMES
+  /* Idle line, end of frame. SR reset step 2, step 1 was reading SR.*/
+  if (sr & USART_SR_IDLE) {
+    (void)u->DR;
+    if (s485dp->framemode)
+      s485dFrameEndI(s485dp);
+  }
+#endif
   osalSysUnlockFromISR();
+#endif /* STM32_SERIAL_485_USE_DMA */
 
   /* Physical transmission end.
    * Note: This must be handled before TXE to prevent a startup glitch
@@ -215,6 +475,14 @@ static void serve_interrupt(Serial485Driver *s485dp) {
       chnAddFlagsI(s485dp, CHN_TRANSMISSION_END);
     u->CR1 = (cr1 & ~USART_CR1_TCIE) | USART_CR1_RE;
     u->SR = ~USART_SR_TC;
+#if SERIAL_485_USE_FRAMES
+    s485dFrameSentI(s485dp);
+#if STM32_SERIAL_485_USE_DMA
+    /* Queue data written while the frame was being sent.*/
+    if ((s485dp->txdmasize == 0) && !oqIsEmptyI(&s485dp->oqueue))
+      tx_dma_start(s485dp);
+#endif
+#endif
     osalSysUnlockFromISR();
   }
 
@@ -222,6 +490,11 @@ static void serve_interrupt(Serial485Driver *s485dp) {
   if ((cr1 & USART_CR1_TXEIE) && (sr & USART_SR_TXE)) {
     msg_t b;
     osalSysLockFromISR();
+#if SERIAL_485_USE_FRAMES
+    /* A pending frame goes first, then the output queue.*/
+    if ((s485dp->txframe == NULL) ||
+        ((b = s485dFrameRequestDataI(s485dp)) < Q_OK))
+#endif
     b = oqGetI(&s485dp->oqueue);
     if (b < Q_OK) {
       chnAddFlagsI(s485dp, CHN_OUTPUT_EMPTY);
@@ -239,8 +512,11 @@ static void serve_interrupt(Serial485Driver *s485dp) {
     }
     osalSysUnlockFromISR();
   }
+
+  QHAL_PERF_END(s485_isr);
 }
 
+#if !STM32_SERIAL_485_USE_DMA || defined(__DOXYGEN__)
 #if STM32_SERIAL_485_USE_USART1 || defined(__DOXYGEN__)
 static void notify1(io_queue_t *qp) {
 
@@ -304,6 +580,7 @@ static void notify8(io_queue_t *qp) {
   UART8->CR1 |= USART_CR1_TXEIE;
 }
 #endif
+#endif /* !STM32_SERIAL_485_USE_DMA */
 
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
@@ -473,42 +750,98 @@ OSAL_IRQ_HANDLER(STM32_UART8_HANDLER) {
 void s485d_lld_init(void) {
 
 #if STM32_SERIAL_485_USE_USART1
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D1, NULL, notify_dma);
+  dma_object_init(&S485D1,
+                  STM32_SERIAL_485_USART1_RX_DMA_STREAM, STM32_USART1_RX_DMA_CHN,
+                  STM32_SERIAL_485_USART1_TX_DMA_STREAM, STM32_USART1_TX_DMA_CHN);
+#else
   s485dObjectInit(&S485D1, NULL, notify1);
+#endif
   S485D1.usart = USART1;
 #endif
 
 #if STM32_SERIAL_485_USE_USART2
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D2, NULL, notify_dma);
+  dma_object_init(&S485D2,
+                  STM32_SERIAL_485_USART2_RX_DMA_STREAM, STM32_USART2_RX_DMA_CHN,
+                  STM32_SERIAL_485_USART2_TX_DMA_STREAM, STM32_USART2_TX_DMA_CHN);
+#else
   s485dObjectInit(&S485D2, NULL, notify2);
+#endif
   S485D2.usart = USART2;
 #endif
 
 #if STM32_SERIAL_485_USE_USART3
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D3, NULL, notify_dma);
+  dma_object_init(&S485D3,
+                  STM32_SERIAL_485_USART3_RX_DMA_STREAM, STM32_USART3_RX_DMA_CHN,
+                  STM32_SERIAL_485_USART3_TX_DMA_STREAM, STM32_USART3_TX_DMA_CHN);
+#else
   s485dObjectInit(&S485D3, NULL, notify3);
+#endif
   S485D3.usart = USART3;
 #endif
 
 #if STM32_SERIAL_485_USE_UART4
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D4, NULL, notify_dma);
+  dma_object_init(&S485D4,
+                  STM32_SERIAL_485_UART4_RX_DMA_STREAM, STM32_UART4_RX_DMA_CHN,
+                  STM32_SERIAL_485_UART4_TX_DMA_STREAM, STM32_UART4_TX_DMA_CHN);
+#else
   s485dObjectInit(&S485D4, NULL, notify4);
+#endif
   S485D4.usart = UART4;
 #endif
 
 #if STM32_SERIAL_485_USE_UART5
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D5, NULL, notify_dma);
+  dma_object_init(&S485D5,
+                  STM32_SERIAL_485_UART5_RX_DMA_STREAM, STM32_UART5_RX_DMA_CHN,
+                  STM32_SERIAL_485_UART5_TX_DMA_STREAM, STM32_UART5_TX_DMA_CHN);
+#else
   s485dObjectInit(&S485D5, NULL, notify5);
+#endif
   S485D5.usart = UART5;
 #endif
 
 #if STM32_SERIAL_485_USE_USART6
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D6, NULL, notify_dma);
+  dma_object_init(&S485D6,
+                  STM32_SERIAL_485_USART6_RX_DMA_STREAM, STM32_USART6_RX_DMA_CHN,
+                  STM32_SERIAL_485_USART6_TX_DMA_STREAM, STM32_USART6_TX_DMA_CHN);
+#else
   s485dObjectInit(&S485D6, NULL, notify6);
+#endif
   S485D6.usart = USART6;
 #endif
 
 #if STM32_SERIAL_485_USE_UART7
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D7, NULL, notify_dma);
+  dma_object_init(&S485D7,
+                  STM32_SERIAL_485_UART7_RX_DMA_STREAM, STM32_UART7_RX_DMA_CHN,
+                  STM32_SERIAL_485_UART7_TX_DMA_STREAM, STM32_UART7_TX_DMA_CHN);
+#else
   s485dObjectInit(&S485D7, NULL, notify7);
+#endif
   S485D7.usart = UART7;
 #endif
 
 #if STM32_SERIAL_485_USE_UART8
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D8, NULL, notify_dma);
+  dma_object_init(&S485D8,
+                  STM32_SERIAL_485_UART8_RX_DMA_STREAM, STM32_UART8_RX_DMA_CHN,
+                  STM32_SERIAL_485_UART8_TX_DMA_STREAM, STM32_UART8_TX_DMA_CHN);
+#else
   s485dObjectInit(&S485D8, NULL, notify8);
+#endif
   S485D8.usart = UART8;
 #endif
 }
@@ -576,6 +909,21 @@ void s485d_lld_start(Serial485Driver *s485dp, const Serial485Config *config) {
       rccEnableUART8(true);
       nvicEnableVector(STM32_UART8_NUMBER, STM32_SERIAL_485_UART8_PRIORITY);
     }
+#endif
+#if STM32_SERIAL_485_USE_DMA
+    {
+      bool b;
+      b = dmaStreamAllocate(s485dp->dmarx,
+                            STM32_SERIAL_485_DMA_IRQ_PRIORITY,
+                            (stm32_dmaisr_t)serve_rx_dma_interrupt,
+                            (void *)s485dp);
+      osalDbgAssert(!b, "stream already allocated");
+      b = dmaStreamAllocate(s485dp->dmatx,
+                            STM32_SERIAL_485_DMA_IRQ_PRIORITY,
+                            (stm32_dmaisr_t)serve_tx_dma_interrupt,
+                            (void *)s485dp);
+      osalDbgAssert(!b, "stream already allocated");
+    }
 #endif
     /* Clear driver enable pad. */
     if (s485dp->config->ssport != NULL)
@@ -597,6 +945,13 @@ void s485d_lld_stop(Serial485Driver *s485dp) {
 
   if (s485dp->state == S485D_READY) {
     usart_deinit(s485dp->usart);
+#if STM32_SERIAL_485_USE_DMA
+    dmaStreamDisable(s485dp->dmarx);
+    dmaStreamDisable(s485dp->dmatx);
+    dmaStreamRelease(s485dp->dmarx);
+    dmaStreamRelease(s485dp->dmatx);
+    s485dp->txdmasize = 0;
+#endif
 #if STM32_SERIAL_485_USE_USART1
     if (&S485D1 == s485dp) {
       rccDisableUSART1();
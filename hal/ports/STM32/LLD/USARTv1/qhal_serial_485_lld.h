@@ -164,6 +164,149 @@
 #if !defined(STM32_SERIAL_UART8_PRIORITY) || defined(__DOXYGEN__)
 #define STM32_SERIAL_485_UART8_PRIORITY     12
 #endif
+/**
+ * @brief   Serves reception and transmission by DMA.
+ * @details Reception runs a circular DMA buffer which is drained into the
+ *          input queue on idle line, half and full buffer interrupts.
+ *          Transmission sends contiguous spans of the output queue.
+ * @note    Only frames of up to 8 bits are supported in this mode.
+ */
+#if !defined(STM32_SERIAL_485_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USE_DMA            FALSE
+#endif
+
+/**
+ * @brief   Size of the circular reception DMA buffer.
+ */
+#if !defined(STM32_SERIAL_485_RX_DMA_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_RX_DMA_BUFFER_SIZE 64
+#endif
+
+/**
+ * @brief   DMA streams priority level setting.
+ */
+#if !defined(STM32_SERIAL_485_DMA_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_DMA_PRIORITY       1
+#endif
+
+/**
+ * @brief   DMA streams interrupt priority level setting.
+ */
+#if !defined(STM32_SERIAL_485_DMA_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_DMA_IRQ_PRIORITY   12
+#endif
+
+/**
+ * @brief   USART1 DMA stream used for RX operations.
+ */
+#if !defined(STM32_SERIAL_485_USART1_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART1_RX_DMA_STREAM    STM32_DMA_STREAM_ID(2, 5)
+#endif
+
+/**
+ * @brief   USART1 DMA stream used for TX operations.
+ */
+#if !defined(STM32_SERIAL_485_USART1_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART1_TX_DMA_STREAM    STM32_DMA_STREAM_ID(2, 7)
+#endif
+
+/**
+ * @brief   USART2 DMA stream used for RX operations.
+ */
+#if !defined(STM32_SERIAL_485_USART2_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART2_RX_DMA_STREAM    STM32_DMA_STREAM_ID(1, 5)
+#endif
+
+/**
+ * @brief   USART2 DMA stream used for TX operations.
+ */
+#if !defined(STM32_SERIAL_485_USART2_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART2_TX_DMA_STREAM    STM32_DMA_STREAM_ID(1, 6)
+#endif
+
+/**
+ * @brief   USART3 DMA stream used for RX operations.
+ */
+#if !defined(STM32_SERIAL_485_USART3_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART3_RX_DMA_STREAM    STM32_DMA_STREAM_ID(1, 1)
+#endif
+
+/**
+ * @brief   USART3 DMA stream used for TX operations.
+ */
+#if !defined(STM32_SERIAL_485_USART3_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART3_TX_DMA_STREAM    STM32_DMA_STREAM_ID(1, 3)
+#endif
+
+/**
+ * @brief   UART4 DMA stream used for RX operations.
+ */
+#if !defined(STM32_SERIAL_485_UART4_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART4_RX_DMA_STREAM     STM32_DMA_STREAM_ID(1, 2)
+#endif
+
+/**
+ * @brief   UART4 DMA stream used for TX operations.
+ */
+#if !defined(STM32_SERIAL_485_UART4_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART4_TX_DMA_STREAM     STM32_DMA_STREAM_ID(1, 4)
+#endif
+
+/**
+ * @brief   UART5 DMA stream used for RX operations.
+ */
+#if !defined(STM32_SERIAL_485_UART5_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART5_RX_DMA_STREAM     STM32_DMA_STREAM_ID(1, 0)
+#endif
+
+/**
+ * @brief   UART5 DMA stream used for TX operations.
+ */
+#if !defined(STM32_SERIAL_485_UART5_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART5_TX_DMA_STREAM     STM32_DMA_STREAM_ID(1, 7)
+#endif
+
+/**
+ * @brief   USART6 DMA stream used for RX operations.
+ */
+#if !defined(STM32_SERIAL_485_USART6_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART6_RX_DMA_STREAM    STM32_DMA_STREAM_ID(2, 2)
+#endif
+
+/**
+ * @brief   USART6 DMA stream used for TX operations.
+ */
+#if !defined(STM32_SERIAL_485_USART6_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART6_TX_DMA_STREAM    STM32_DMA_STREAM_ID(2, 7)
+#endif
+
+/**
+ * @brief   UART7 DMA stream used for RX operations.
+ */
+#if !defined(STM32_SERIAL_485_UART7_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART7_RX_DMA_STREAM     STM32_DMA_STREAM_ID(1, 3)
+#endif
+
+/**
+ * @brief   UART7 DMA stream used for TX operations.
+ */
+#if !defined(STM32_SERIAL_485_UART7_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART7_TX_DMA_STREAM     STM32_DMA_STREAM_ID(1, 1)
+#endif
+
+/**
+ * @brief   UART8 DMA stream used for RX operations.
+ */
+#if !defined(STM32_SERIAL_485_UART8_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART8_RX_DMA_STREAM     STM32_DMA_STREAM_ID(1, 6)
+#endif
+
+/**
+ * @brief   UART8 DMA stream used for TX operations.
+ */
+#if !defined(STM32_SERIAL_485_UART8_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART8_TX_DMA_STREAM     STM32_DMA_STREAM_ID(1, 0)
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -248,6 +391,76 @@
 #error "Invalid IRQ priority assigned to UART8"
 #endif
 
+#if STM32_SERIAL_485_USE_DMA
+#if STM32_SERIAL_485_USE_USART1 &&                                             \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART1_RX_DMA_STREAM,             \
+            STM32_USART1_RX_DMA_MSK) ||                                        \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART1_TX_DMA_STREAM,             \
+            STM32_USART1_TX_DMA_MSK))
+#error "invalid DMA stream associated to USART1"
+#endif
+
+#if STM32_SERIAL_485_USE_USART2 &&                                             \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART2_RX_DMA_STREAM,             \
+            STM32_USART2_RX_DMA_MSK) ||                                        \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART2_TX_DMA_STREAM,             \
+            STM32_USART2_TX_DMA_MSK))
+#error "invalid DMA stream associated to USART2"
+#endif
+
+#if STM32_SERIAL_485_USE_USART3 &&                                             \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART3_RX_DMA_STREAM,             \
+            STM32_USART3_RX_DMA_MSK) ||                                        \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART3_TX_DMA_STREAM,             \
+            STM32_USART3_TX_DMA_MSK))
+#error "invalid DMA stream associated to USART3"
+#endif
+
+#if STM32_SERIAL_485_USE_UART4 &&                                              \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART4_RX_DMA_STREAM,              \
+            STM32_UART4_RX_DMA_MSK) ||                                         \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART4_TX_DMA_STREAM,              \
+            STM32_UART4_TX_DMA_MSK))
+#error "invalid DMA stream associated to UART4"
+#endif
+
+#if STM32_SERIAL_485_USE_UART5 &&                                              \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART5_RX_DMA_STREAM,              \
+            STM32_UART5_RX_DMA_MSK) ||                                         \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART5_TX_DMA_STREAM,              \
+            STM32_UART5_TX_DMA_MSK))
+#error "invalid DMA stream associated to UART5"
+#endif
+
+#if STM32_SERIAL_485_USE_USART6 &&                                             \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART6_RX_DMA_STREAM,             \
+            STM32_USART6_RX_DMA_MSK) ||                                        \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART6_TX_DMA_STREAM,             \
+            STM32_USART6_TX_DMA_MSK))
+#error "invalid DMA stream associated to USART6"
+#endif
+
+#if STM32_SERIAL_485_USE_UART7 &&                                              \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART7_RX_DMA_STREAM,              \
+            STM32_UART7_RX_DMA_MSK) ||                                         \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART7_TX_DMA_STREAM,              \
+            STM32_UART7_TX_DMA_MSK))
+#error "invalid DMA stream associated to UART7"
+#endif
+
+#if STM32_SERIAL_485_USE_UART8 &&                                              \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART8_RX_DMA_STREAM,              \
+            STM32_UART8_RX_DMA_MSK) ||                                         \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART8_TX_DMA_STREAM,              \
+            STM32_UART8_TX_DMA_MSK))
+#error "invalid DMA stream associated to UART8"
+#endif
+
+#if !defined(STM32_DMA_REQUIRED)
+#define STM32_DMA_REQUIRED
+#endif
+#endif /* STM32_SERIAL_485_USE_DMA */
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -288,6 +501,31 @@ typedef struct {
   uint16_t                  sspad;
 } Serial485Config;
 
+#if STM32_SERIAL_485_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   @p Serial485Driver DMA specific data.
+ */
+#define _serial_485_driver_dma_data                                         \
+  /* Receive DMA stream.*/                                                  \
+  const stm32_dma_stream_t  *dmarx;                                         \
+  /* Transmit DMA stream.*/                                                 \
+  const stm32_dma_stream_t  *dmatx;                                         \
+  /* RX DMA mode bit mask.*/                                                \
+  uint32_t                  rxdmamode;                                      \
+  /* TX DMA mode bit mask.*/                                                \
+  uint32_t                  txdmamode;                                      \
+  /* Circular reception DMA buffer.*/                                       \
+  uint8_t                   rxdmabuf[STM32_SERIAL_485_RX_DMA_BUFFER_SIZE];  \
+  /* Next position in the reception DMA buffer to be drained.*/             \
+  size_t                    rxdmapos;                                       \
+  /* Size of the transmission in progress, zero if idle.*/                  \
+  size_t                    txdmasize;                                      \
+  /* The transmission in progress is sent from a frame buffer.*/            \
+  bool                      txdmaframe;
+#else
+#define _serial_485_driver_dma_data
+#endif /* STM32_SERIAL_485_USE_DMA */
+
 /**
  * @brief   @p Serial485Driver specific data.
  */
@@ -305,7 +543,8 @@ typedef struct {
   uint8_t                   ob[SERIAL_BUFFERS_SIZE];                        \
   /* End of the mandatory fields.*/                                         \
   /* Pointer to the USART registers block.*/                                \
-  USART_TypeDef             *usart;
+  USART_TypeDef             *usart;                                         \
+  _serial_485_driver_dma_data
 
 /*===========================================================================*/
 /* Driver macros.                                                            */
@@ -52,6 +52,16 @@
 #define UART5                               USART5
 #endif
 
+/* DMA request channel selection, only on devices with advanced DMA.*/
+#if STM32_SERIAL_485_USE_DMA
+#if STM32_ADVANCED_DMA
+#define S485_DMA_CHSEL(id, chmsk)                                           \
+  STM32_DMA_CR_CHSEL(STM32_DMA_GETCHANNEL(id, chmsk))
+#else
+#define S485_DMA_CHSEL(id, chmsk)           0U
+#endif
+#endif /* STM32_SERIAL_485_USE_DMA */
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -105,6 +115,9 @@ Serial485Driver LPS485D1;
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+/* Interrupt service time of all channels.*/
+QHAL_PERF_REGION(s485_isr)
+
 /** @brief Driver default configuration.*/
 static const Serial485Config default_config =
 {
@@ -140,12 +153,77 @@ static void usart_init(Serial485Driver *s485dp, const Serial485Config *config) {
 #endif
   u->BRR = (uint32_t)(s485dp->clock / config->speed);
 
+  /* Mask parity bit according to configuration. */
+  switch (config->cr1 & (USART_CR1_PCE | USART_CR1_M1 | USART_CR1_M0))
+  {
+  case USART_CR1_PCE:
+      s485dp->rxmask = 0x007f;
+      break;
+  case USART_CR1_PCE | USART_CR1_M1:
+      s485dp->rxmask = 0x00ff;
+      break;
+  case USART_CR1_PCE | USART_CR1_M0:
+      s485dp->rxmask = 0x01ff;
+      break;
+  default:
+      s485dp->rxmask = 0xffff;
+      break;
+  }
+
+  /* Hardware driver enable timing.*/
+  uint32_t cr1 = config->cr1;
+  if (config->cr3 & USART_CR3_DEM)
+    cr1 = (cr1 & ~(USART_CR1_DEAT | USART_CR1_DEDT)) |
+          (((uint32_t)config->deat * USART_CR1_DEAT_0) & USART_CR1_DEAT) |
+          (((uint32_t)config->dedt * USART_CR1_DEDT_0) & USART_CR1_DEDT);
+
+  /* Frame end detection, receiver timeout if available or idle line.*/
+  uint32_t cr2 = config->cr2;
+#if SERIAL_485_USE_FRAMES
+  bool rto = config->rto != 0;
+#if STM32_SERIAL_485_USE_LPUART1
+  if (s485dp == &LPS485D1)
+    rto = false;
+#endif
+  if (rto) {
+    u->RTOR = config->rto & USART_RTOR_RTO;
+    cr2 |= USART_CR2_RTOEN;
+    cr1 |= USART_CR1_RTOIE;
+  }
+  else
+    cr1 |= USART_CR1_IDLEIE;
+#endif
+
+#if STM32_SERIAL_485_USE_DMA
+  /* Circular reception, restarted from the buffer origin.*/
+  dmaStreamDisable(s485dp->dmarx);
+  dmaStreamDisable(s485dp->dmatx);
+  s485dp->rxdmapos = 0;
+  s485dp->txdmasize = 0;
+  s485dp->txdmaframe = false;
+  dmaStreamSetPeripheral(s485dp->dmarx, &u->RDR);
+  dmaStreamSetMemory0(s485dp->dmarx, s485dp->rxdmabuf);
+  dmaStreamSetTransactionSize(s485dp->dmarx,
+                              STM32_SERIAL_485_RX_DMA_BUFFER_SIZE);
+  dmaStreamSetMode(s485dp->dmarx, s485dp->rxdmamode);
+  dmaStreamEnable(s485dp->dmarx);
+  dmaStreamSetPeripheral(s485dp->dmatx, &u->TDR);
+
+  /* Note that some bits are enforced, the idle line drains the DMA
+     buffer.*/
+  u->CR2 = cr2 | USART_CR2_LBDIE;
+  u->CR3 = config->cr3 | USART_CR3_EIE | USART_CR3_DMAR | USART_CR3_DMAT;
+  u->CR1 = cr1 | USART_CR1_UE | USART_CR1_PEIE |
+                 USART_CR1_IDLEIE | USART_CR1_TE |
+                 USART_CR1_RE;
+#else
   /* Note that some bits are enforced.*/
-  u->CR2 = config->cr2 | USART_CR2_LBDIE;
+  u->CR2 = cr2 | USART_CR2_LBDIE;
   u->CR3 = config->cr3 | USART_CR3_EIE;
-  u->CR1 = config->cr1 | USART_CR1_UE | USART_CR1_PEIE |
+  u->CR1 = cr1 | USART_CR1_UE | USART_CR1_PEIE |
                          USART_CR1_RXNEIE | USART_CR1_TE |
                          USART_CR1_RE;
+#endif /* STM32_SERIAL_485_USE_DMA */
   u->ICR = 0xFFFFFFFFU;
 }
 
@@ -184,15 +262,206 @@ static void set_error(Serial485Driver *s485dp, uint32_t isr) {
   osalSysUnlockFromISR();
 }
 
+#if STM32_SERIAL_485_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   Moves received bytes from the DMA buffer to the input queue.
+ * @details In frame mode the bytes are moved to the frame being received.
+ * @note    Must be called with the kernel locked.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ */
+static void rx_dma_drain(Serial485Driver *s485dp) {
+  size_t pos = STM32_SERIAL_485_RX_DMA_BUFFER_SIZE -
+               dmaStreamGetTransactionSize(s485dp->dmarx);
+  uint8_t mask = (uint8_t)s485dp->rxmask;
+  bool overrun = false;
+
+  if (pos >= STM32_SERIAL_485_RX_DMA_BUFFER_SIZE)
+    pos = 0;
+  if (pos == s485dp->rxdmapos)
+    return;
+
+#if SERIAL_485_USE_FRAMES
+  if (s485dp->framemode) {
+    while (s485dp->rxdmapos != pos) {
+      s485dFrameDataI(s485dp, s485dp->rxdmabuf[s485dp->rxdmapos] & mask);
+      if (++s485dp->rxdmapos >= STM32_SERIAL_485_RX_DMA_BUFFER_SIZE)
+        s485dp->rxdmapos = 0;
+    }
+    return;
+  }
+#endif
+
+  if (iqIsEmptyI(&s485dp->iqueue))
+    chnAddFlagsI(s485dp, CHN_INPUT_AVAILABLE);
+  while (s485dp->rxdmapos != pos) {
+    if (iqPutI(&s485dp->iqueue,
+               s485dp->rxdmabuf[s485dp->rxdmapos] & mask) < Q_OK)
+      overrun = true;
+    if (++s485dp->rxdmapos >= STM32_SERIAL_485_RX_DMA_BUFFER_SIZE)
+      s485dp->rxdmapos = 0;
+  }
+  if (overrun)
+    chnAddFlagsI(s485dp, S485D_OVERRUN_ERROR);
+}
+
+/**
+ * @brief   Starts transmitting the contiguous span of the output queue.
+ * @details A pending frame is sent first, directly from its buffer.
+ * @note    Must be called with the kernel locked and no transmission in
+ *          progress.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ */
+static void tx_dma_start(Serial485Driver *s485dp) {
+  output_queue_t *oqp = &s485dp->oqueue;
+  USART_TypeDef *u = s485dp->usart;
+  const uint8_t *bp = oqp->q_rdptr;
+  size_t n;
+
+#if SERIAL_485_USE_FRAMES
+  s485dp->txdmaframe = (s485dp->txframe != NULL) && (s485dp->txframe_n > 0);
+  if (s485dp->txdmaframe) {
+    bp = s485dp->txframe;
+    n = s485dp->txframe_n;
+    s485dp->txframe += n;
+    s485dp->txframe_n = 0;
+  }
+  else
+#endif
+  {
+    n = oqGetFullI(oqp);
+    if (n == 0)
+      return;
+    if (n > (size_t)(oqp->q_top - oqp->q_rdptr))
+      n = (size_t)(oqp->q_top - oqp->q_rdptr);
+  }
+  s485dp->txdmasize = n;
+
+  /* Disable RX and pending transmission end, set driver enable pad. */
+  u->CR1 &= ~(USART_CR1_RE | USART_CR1_TCIE);
+  if (s485dp->config->ssport != NULL)
+    palSetPad(s485dp->config->ssport, s485dp->config->sspad);
+  u->ICR = USART_ICR_TCCF;
+
+  dmaStreamSetMemory0(s485dp->dmatx, bp);
+  dmaStreamSetTransactionSize(s485dp->dmatx, n);
+  dmaStreamSetMode(s485dp->dmatx, s485dp->txdmamode);
+  dmaStreamEnable(s485dp->dmatx);
+}
+
+/**
+ * @brief   RX DMA half and full buffer handler.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[in] flags     pre-shifted content of the ISR register
+ */
+QHAL_HOTFUNC
+static void serve_rx_dma_interrupt(Serial485Driver *s485dp, uint32_t flags) {
+
+  (void)flags;
+
+  osalSysLockFromISR();
+  rx_dma_drain(s485dp);
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   TX DMA end handler.
+ * @details Releases the transmitted span from the output queue and starts
+ *          the next one, waits for the physical transmission end otherwise.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[in] flags     pre-shifted content of the ISR register
+ */
+QHAL_HOTFUNC
+static void serve_tx_dma_interrupt(Serial485Driver *s485dp, uint32_t flags) {
+  output_queue_t *oqp = &s485dp->oqueue;
+
+  (void)flags;
+
+  dmaStreamDisable(s485dp->dmatx);
+
+  osalSysLockFromISR();
+#if SERIAL_485_USE_FRAMES
+  if (s485dp->txdmaframe) {
+    /* Frame buffer done, the sender is woken at the transmission end.*/
+    s485dp->txdmasize = 0;
+    s485dp->txdmaframe = false;
+    s485dp->usart->CR1 |= USART_CR1_TCIE;
+    osalSysUnlockFromISR();
+    return;
+  }
+#endif
+  oqp->q_rdptr += s485dp->txdmasize;
+  if (oqp->q_rdptr >= oqp->q_top)
+    oqp->q_rdptr = oqp->q_buffer;
+  oqp->q_counter += s485dp->txdmasize;
+  s485dp->txdmasize = 0;
+  osalThreadDequeueAllI(&oqp->q_waiting, Q_OK);
+
+  if (oqIsEmptyI(oqp)) {
+    chnAddFlagsI(s485dp, CHN_OUTPUT_EMPTY);
+    s485dp->usart->CR1 |= USART_CR1_TCIE;
+  }
+  else
+    tx_dma_start(s485dp);
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Output queue notification in DMA mode.
+ *
+ * @param[in] qp        the output queue
+ */
+static void notify_dma(io_queue_t *qp) {
+  Serial485Driver *s485dp = qp->q_link;
+
+  if ((s485dp->state == S485D_READY) && (s485dp->txdmasize == 0))
+    tx_dma_start(s485dp);
+}
+
+/**
+ * @brief   Initializes the DMA related driver fields.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[in] rxid      RX DMA stream identifier
+ * @param[in] rxchsel   RX DMA channel selection mode bits
+ * @param[in] txid      TX DMA stream identifier
+ * @param[in] txchsel   TX DMA channel selection mode bits
+ */
+static void dma_object_init(Serial485Driver *s485dp, uint32_t rxid,
+                            uint32_t rxchsel, uint32_t txid,
+                            uint32_t txchsel) {
+
+  s485dp->dmarx = STM32_DMA_STREAM(rxid);
+  s485dp->dmatx = STM32_DMA_STREAM(txid);
+  s485dp->rxdmamode = rxchsel |
+                      STM32_DMA_CR_PL(STM32_SERIAL_485_DMA_PRIORITY) |
+                      STM32_DMA_CR_DIR_P2M | STM32_DMA_CR_MINC |
+                      STM32_DMA_CR_CIRC | STM32_DMA_CR_HTIE |
+                      STM32_DMA_CR_TCIE;
+  s485dp->txdmamode = txchsel |
+                      STM32_DMA_CR_PL(STM32_SERIAL_485_DMA_PRIORITY) |
+                      STM32_DMA_CR_DIR_M2P | STM32_DMA_CR_MINC |
+                      STM32_DMA_CR_TCIE;
+  s485dp->rxdmapos = 0;
+  s485dp->txdmasize = 0;
+  s485dp->txdmaframe = false;
+}
+#endif /* STM32_SERIAL_485_USE_DMA */
+
 /**
  * @brief   Common IRQ handler.
  *
  * @param[in] s485dp    communication channel associated to the USART
  */
+QHAL_HOTFUNC
 static void serve_interrupt(Serial485Driver *s485dp) {
   USART_TypeDef *u = s485dp->usart;
   uint32_t cr1 = u->CR1;
   uint32_t isr;
+  QHAL_PERF_BEGIN(s485_isr);
 
   /* Reading and clearing status.*/
   isr = u->ISR;
@@ -209,29 +478,63 @@ static void serve_interrupt(Serial485Driver *s485dp) {
     osalSysUnlockFromISR();
   }
 
-  /* Data available.*/
+#if STM32_SERIAL_485_USE_DMA
+  /* Idle line or errors, the data is fetched by the DMA.*/
+  if (isr & (USART_ISR_IDLE | USART_ISR_ORE | USART_ISR_NE | USART_ISR_FE |
+             USART_ISR_PE)) {
+    osalSysLockFromISR();
+    rx_dma_drain(s485dp);
+    osalSysUnlockFromISR();
+  }
+
+#if SERIAL_485_USE_FRAMES
+  /* End of frame, on the receiver timeout if enabled else on idle line.*/
+  if (isr & ((u->CR2 & USART_CR2_RTOEN) ? USART_ISR_RTOF : USART_ISR_IDLE)) {
+    osalSysLockFromISR();
+    rx_dma_drain(s485dp);
+    if (s485dp->framemode)
+      s485dFrameEndI(s485dp);
+    osalSysUnlockFromISR();
+  }
+#endif
+#else
+  /* Data available, drained as long as more keeps arriving.*/
   if (isr & USART_ISR_RXNE) {
+    bool overrun = false;
     osalSysLockFromISR();
-    /* Mask parity bit according to configuration. */
-    uint16_t b = u->RDR;
-    switch (u->CR1 & (USART_CR1_PCE | USART_CR1_M1 | USART_CR1_M0))
+#if SERIAL_485_USE_FRAMES
+    if (s485dp->framemode) {
+      do {
+        s485dFrameDataI(s485dp, (uint8_t)(u->RDR & s485dp->rxmask));
+      } while (u->ISR & USART_ISR_RXNE);
+    }
+    else
+#endif
     {
-    case USART_CR1_PCE:
-        b &= 0x007f;
-        break;
-    case USART_CR1_PCE | USART_CR1_M1:
-        b &= 0x00ff;
-        break;
-    case USART_CR1_PCE | USART_CR1_M0:
-        b &= 0x01ff;
-        break;
-    default:
-        break;
+      if (iqIsEmptyI(&s485dp->iqueue))
+        chnAddFlagsI(s485dp, CHN_INPUT_AVAILABLE);
+      do {
+        uint8_t b = (uint8_t)(u->RDR & s485dp->rxmask);
+        if (iqPutI(&s485dp->iqueue, b) < Q_OK)
+          overrun = true;
+      } while (u->ISR & USART_ISR_RXNE);
     }
-    sdIncomingDataI(s485dp, b);
+    if (overrun)
+      chnAddFlagsI(s485dp, S485D_OVERRUN_ERROR);
     osalSysUnlockFromISR();
   }
 
+#if SERIAL_485_USE_FRAMES
+  /* Gap on the line, end of frame.*/
+  if (isr & (USART_ISR_RTOF | USART_ISR_IDLE)) {
+    osalSysLockFromISR();
+    if (s485dp->framemode)
+      s485dFrameEndI(s485dp);
+    osalSysUnlockFromISR();
+  }
+#endif
+#endif /* STM32_SERIAL_485_USE_DMA */
+
   /* Physical transmission end.*/
   if (isr & USART_ISR_TC) {
     /* Clear driver enable pad. */
@@ -240,7 +543,15 @@ static void serve_interrupt(Serial485Driver *s485dp) {
     osalSysLockFromISR();
     if (oqIsEmptyI(&s485dp->oqueue))
       chnAddFlagsI(s485dp, CHN_TRANSMISSION_END);
-    u->CR1 = cr1 & ~USART_CR1_TCIE;
+#if SERIAL_485_USE_FRAMES
+    s485dFrameSentI(s485dp);
+#endif
+    u->CR1 = (cr1 & ~USART_CR1_TCIE) | USART_CR1_RE;
+#if SERIAL_485_USE_FRAMES && STM32_SERIAL_485_USE_DMA
+    /* Queue data written while the frame was being sent.*/
+    if ((s485dp->txdmasize == 0) && !oqIsEmptyI(&s485dp->oqueue))
+      tx_dma_start(s485dp);
+#endif
     osalSysUnlockFromISR();
   }
 
@@ -248,6 +559,11 @@ static void serve_interrupt(Serial485Driver *s485dp) {
   if ((cr1 & USART_CR1_TXEIE) && (isr & USART_ISR_TXE)) {
     msg_t b;
     osalSysLockFromISR();
+#if SERIAL_485_USE_FRAMES
+    /* A pending frame goes first, then the output queue.*/
+    if ((s485dp->txframe == NULL) ||
+        ((b = s485dFrameRequestDataI(s485dp)) < Q_OK))
+#endif
     b = oqGetI(&s485dp->oqueue);
     if (b < Q_OK) {
       chnAddFlagsI(s485dp, CHN_OUTPUT_EMPTY);
@@ -265,8 +581,11 @@ static void serve_interrupt(Serial485Driver *s485dp) {
     }
     osalSysUnlockFromISR();
   }
+
+  QHAL_PERF_END(s485_isr);
 }
 
+#if !STM32_SERIAL_485_USE_DMA || defined(__DOXYGEN__)
 #if STM32_SERIAL_485_USE_USART1 || defined(__DOXYGEN__)
 static void notify1(io_queue_t *qp) {
 
@@ -338,6 +657,7 @@ static void notifylp1(io_queue_t *qp) {
   LPUART1->CR1 |= USART_CR1_TXEIE;
 }
 #endif
+#endif /* !STM32_SERIAL_485_USE_DMA */
 
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
@@ -560,7 +880,18 @@ OSAL_IRQ_HANDLER(STM32_LPUART1_HANDLER) {
 void s485d_lld_init(void) {
 
 #if STM32_SERIAL_485_USE_USART1
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D1, NULL, notify_dma);
+  dma_object_init(&S485D1,
+                  STM32_SERIAL_485_USART1_RX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_USART1_RX_DMA_STREAM,
+                                 STM32_USART1_RX_DMA_CHN),
+                  STM32_SERIAL_485_USART1_TX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_USART1_TX_DMA_STREAM,
+                                 STM32_USART1_TX_DMA_CHN));
+#else
   s485dObjectInit(&S485D1, NULL, notify1);
+#endif
   S485D1.usart = USART1;
   S485D1.clock = STM32_USART1CLK;
 #if defined(STM32_USART1_NUMBER)
@@ -569,7 +900,18 @@ void s485d_lld_init(void) {
 #endif
 
 #if STM32_SERIAL_485_USE_USART2
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D2, NULL, notify_dma);
+  dma_object_init(&S485D2,
+                  STM32_SERIAL_485_USART2_RX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_USART2_RX_DMA_STREAM,
+                                 STM32_USART2_RX_DMA_CHN),
+                  STM32_SERIAL_485_USART2_TX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_USART2_TX_DMA_STREAM,
+                                 STM32_USART2_TX_DMA_CHN));
+#else
   s485dObjectInit(&S485D2, NULL, notify2);
+#endif
   S485D2.usart = USART2;
   S485D2.clock = STM32_USART2CLK;
 #if defined(STM32_USART2_NUMBER)
@@ -578,7 +920,18 @@ void s485d_lld_init(void) {
 #endif
 
 #if STM32_SERIAL_485_USE_USART3
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D3, NULL, notify_dma);
+  dma_object_init(&S485D3,
+                  STM32_SERIAL_485_USART3_RX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_USART3_RX_DMA_STREAM,
+                                 STM32_USART3_RX_DMA_CHN),
+                  STM32_SERIAL_485_USART3_TX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_USART3_TX_DMA_STREAM,
+                                 STM32_USART3_TX_DMA_CHN));
+#else
   s485dObjectInit(&S485D3, NULL, notify3);
+#endif
   S485D3.usart = USART3;
   S485D3.clock = STM32_USART3CLK;
 #if defined(STM32_USART3_NUMBER)
@@ -587,7 +940,18 @@ void s485d_lld_init(void) {
 #endif
 
 #if STM32_SERIAL_485_USE_UART4
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D4, NULL, notify_dma);
+  dma_object_init(&S485D4,
+                  STM32_SERIAL_485_UART4_RX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_UART4_RX_DMA_STREAM,
+                                 STM32_UART4_RX_DMA_CHN),
+                  STM32_SERIAL_485_UART4_TX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_UART4_TX_DMA_STREAM,
+                                 STM32_UART4_TX_DMA_CHN));
+#else
   s485dObjectInit(&S485D4, NULL, notify4);
+#endif
   S485D4.usart = UART4;
   S485D4.clock = STM32_UART4CLK;
 #if defined(STM32_UART4_NUMBER)
@@ -596,7 +960,18 @@ void s485d_lld_init(void) {
 #endif
 
 #if STM32_SERIAL_485_USE_UART5
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D5, NULL, notify_dma);
+  dma_object_init(&S485D5,
+                  STM32_SERIAL_485_UART5_RX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_UART5_RX_DMA_STREAM,
+                                 STM32_UART5_RX_DMA_CHN),
+                  STM32_SERIAL_485_UART5_TX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_UART5_TX_DMA_STREAM,
+                                 STM32_UART5_TX_DMA_CHN));
+#else
   s485dObjectInit(&S485D5, NULL, notify5);
+#endif
   S485D5.usart = UART5;
   S485D5.clock = STM32_UART5CLK;
 #if defined(STM32_UART5_NUMBER)
@@ -605,7 +980,18 @@ void s485d_lld_init(void) {
 #endif
 
 #if STM32_SERIAL_485_USE_USART6
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D6, NULL, notify_dma);
+  dma_object_init(&S485D6,
+                  STM32_SERIAL_485_USART6_RX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_USART6_RX_DMA_STREAM,
+                                 STM32_USART6_RX_DMA_CHN),
+                  STM32_SERIAL_485_USART6_TX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_USART6_TX_DMA_STREAM,
+                                 STM32_USART6_TX_DMA_CHN));
+#else
   s485dObjectInit(&S485D6, NULL, notify6);
+#endif
   S485D6.usart = USART6;
   S485D6.clock = STM32_USART6CLK;
 #if defined(STM32_USART6_NUMBER)
@@ -614,7 +1000,18 @@ void s485d_lld_init(void) {
 #endif
 
 #if STM32_SERIAL_485_USE_UART7
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D7, NULL, notify_dma);
+  dma_object_init(&S485D7,
+                  STM32_SERIAL_485_UART7_RX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_UART7_RX_DMA_STREAM,
+                                 STM32_UART7_RX_DMA_CHN),
+                  STM32_SERIAL_485_UART7_TX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_UART7_TX_DMA_STREAM,
+                                 STM32_UART7_TX_DMA_CHN));
+#else
   s485dObjectInit(&S485D7, NULL, notify7);
+#endif
   S485D7.usart = UART7;
   S485D7.clock = STM32_UART7CLK;
 #if defined(STM32_UART7_NUMBER)
@@ -623,7 +1020,18 @@ void s485d_lld_init(void) {
 #endif
 
 #if STM32_SERIAL_485_USE_UART8
+#if STM32_SERIAL_485_USE_DMA
+  s485dObjectInit(&S485D8, NULL, notify_dma);
+  dma_object_init(&S485D8,
+                  STM32_SERIAL_485_UART8_RX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_UART8_RX_DMA_STREAM,
+                                 STM32_UART8_RX_DMA_CHN),
+                  STM32_SERIAL_485_UART8_TX_DMA_STREAM,
+                  S485_DMA_CHSEL(STM32_SERIAL_485_UART8_TX_DMA_STREAM,
+                                 STM32_UART8_TX_DMA_CHN));
+#else
   s485dObjectInit(&S485D8, NULL, notify8);
+#endif
   S485D8.usart = UART8;
   S485D8.clock = STM32_UART8CLK;
 #if defined(STM32_UART8_NUMBER)
@@ -664,6 +1072,13 @@ void s485d_lld_start(Serial485Driver *s485dp, const Serial485Config *config) {
   if (config == NULL)
     config = &default_config;
 
+  osalDbgAssert(!(config->cr3 & USART_CR3_DEM) || (config->ssport == NULL),
+                "driver enable pad controlled twice");
+#if STM32_SERIAL_485_USE_DMA
+  osalDbgAssert((config->cr1 & (USART_CR1_PCE | USART_CR1_M0)) !=
+                USART_CR1_M0, "9 bits data not supported in DMA mode");
+#endif
+
   if (s485dp->state == S485D_STOP) {
 #if STM32_SERIAL_485_USE_USART1
     if (&S485D1 == s485dp) {
@@ -709,6 +1124,21 @@ void s485d_lld_start(Serial485Driver *s485dp, const Serial485Config *config) {
     if (&LPS485D1 == s485dp) {
       rccEnableLPUART1(true);
     }
+#endif
+#if STM32_SERIAL_485_USE_DMA
+    {
+      bool b;
+      b = dmaStreamAllocate(s485dp->dmarx,
+                            STM32_SERIAL_485_DMA_IRQ_PRIORITY,
+                            (stm32_dmaisr_t)serve_rx_dma_interrupt,
+                            (void *)s485dp);
+      osalDbgAssert(!b, "stream already allocated");
+      b = dmaStreamAllocate(s485dp->dmatx,
+                            STM32_SERIAL_485_DMA_IRQ_PRIORITY,
+                            (stm32_dmaisr_t)serve_tx_dma_interrupt,
+                            (void *)s485dp);
+      osalDbgAssert(!b, "stream already allocated");
+    }
 #endif
   }
   usart_init(s485dp, config);
@@ -728,6 +1158,13 @@ void s485d_lld_stop(Serial485Driver *s485dp) {
   if (s485dp->state == S485D_READY) {
     /* UART is de-initialized then clocks are disabled.*/
     usart_deinit(s485dp->usart);
+#if STM32_SERIAL_485_USE_DMA
+    dmaStreamDisable(s485dp->dmarx);
+    dmaStreamDisable(s485dp->dmatx);
+    dmaStreamRelease(s485dp->dmarx);
+    dmaStreamRelease(s485dp->dmatx);
+    s485dp->txdmasize = 0;
+#endif
 
 #if STM32_SERIAL_485_USE_USART1
     if (&S485D1 == s485dp) {
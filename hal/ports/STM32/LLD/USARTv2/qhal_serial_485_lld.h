@@ -188,6 +188,183 @@
 #if !defined(STM32_SERIAL_485_LPUART1_PRIORITY) || defined(__DOXYGEN__)
 #define STM32_SERIAL_485_LPUART1_PRIORITY       12
 #endif
+
+/**
+ * @brief   Serves reception and transmission by DMA.
+ * @details Reception runs a circular DMA buffer which is drained into the
+ *          input queue on idle line, half and full buffer interrupts.
+ *          Transmission sends contiguous spans of the output queue.
+ * @note    Only frames of up to 8 bits are supported in this mode.
+ * @note    LPUART1 is not supported in this mode.
+ */
+#if !defined(STM32_SERIAL_485_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USE_DMA                FALSE
+#endif
+
+/**
+ * @brief   Size of the circular reception DMA buffer.
+ */
+#if !defined(STM32_SERIAL_485_RX_DMA_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_RX_DMA_BUFFER_SIZE     64
+#endif
+
+/**
+ * @brief   DMA streams priority level setting.
+ */
+#if !defined(STM32_SERIAL_485_DMA_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_DMA_PRIORITY           1
+#endif
+
+/**
+ * @brief   DMA streams interrupt priority level setting.
+ */
+#if !defined(STM32_SERIAL_485_DMA_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_DMA_IRQ_PRIORITY       12
+#endif
+
+/**
+ * @brief   USART1 DMA stream used for RX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_USART1_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART1_RX_DMA_STREAM STM32_UART_USART1_RX_DMA_STREAM
+#endif
+
+/**
+ * @brief   USART1 DMA stream used for TX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_USART1_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART1_TX_DMA_STREAM STM32_UART_USART1_TX_DMA_STREAM
+#endif
+
+/**
+ * @brief   USART2 DMA stream used for RX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_USART2_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART2_RX_DMA_STREAM STM32_UART_USART2_RX_DMA_STREAM
+#endif
+
+/**
+ * @brief   USART2 DMA stream used for TX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_USART2_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART2_TX_DMA_STREAM STM32_UART_USART2_TX_DMA_STREAM
+#endif
+
+/**
+ * @brief   USART3 DMA stream used for RX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_USART3_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART3_RX_DMA_STREAM STM32_UART_USART3_RX_DMA_STREAM
+#endif
+
+/**
+ * @brief   USART3 DMA stream used for TX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_USART3_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART3_TX_DMA_STREAM STM32_UART_USART3_TX_DMA_STREAM
+#endif
+
+/**
+ * @brief   UART4 DMA stream used for RX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_UART4_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART4_RX_DMA_STREAM  STM32_UART_UART4_RX_DMA_STREAM
+#endif
+
+/**
+ * @brief   UART4 DMA stream used for TX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_UART4_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART4_TX_DMA_STREAM  STM32_UART_UART4_TX_DMA_STREAM
+#endif
+
+/**
+ * @brief   UART5 DMA stream used for RX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_UART5_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART5_RX_DMA_STREAM  STM32_UART_UART5_RX_DMA_STREAM
+#endif
+
+/**
+ * @brief   UART5 DMA stream used for TX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_UART5_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART5_TX_DMA_STREAM  STM32_UART_UART5_TX_DMA_STREAM
+#endif
+
+/**
+ * @brief   USART6 DMA stream used for RX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_USART6_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART6_RX_DMA_STREAM STM32_UART_USART6_RX_DMA_STREAM
+#endif
+
+/**
+ * @brief   USART6 DMA stream used for TX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_USART6_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_USART6_TX_DMA_STREAM STM32_UART_USART6_TX_DMA_STREAM
+#endif
+
+/**
+ * @brief   UART7 DMA stream used for RX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_UART7_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART7_RX_DMA_STREAM  STM32_UART_UART7_RX_DMA_STREAM
+#endif
+
+/**
+ * @brief   UART7 DMA stream used for TX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_UART7_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART7_TX_DMA_STREAM  STM32_UART_UART7_TX_DMA_STREAM
+#endif
+
+/**
+ * @brief   UART8 DMA stream used for RX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_UART8_RX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART8_RX_DMA_STREAM  STM32_UART_UART8_RX_DMA_STREAM
+#endif
+
+/**
+ * @brief   UART8 DMA stream used for TX operations.
+ * @note    Defaults to the stream assigned to the UART driver in mcuconf.h,
+ *          the assignments differ between the USARTv2 families.
+ */
+#if !defined(STM32_SERIAL_485_UART8_TX_DMA_STREAM) || defined(__DOXYGEN__)
+#define STM32_SERIAL_485_UART8_TX_DMA_STREAM  STM32_UART_UART8_TX_DMA_STREAM
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -283,6 +460,84 @@
 #error "Invalid IRQ priority assigned to LPUART1"
 #endif
 
+#if STM32_SERIAL_485_USE_DMA
+#if STM32_SERIAL_485_USE_USART1 &&                                           \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART1_RX_DMA_STREAM,           \
+            STM32_USART1_RX_DMA_MSK) ||                                      \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART1_TX_DMA_STREAM,           \
+            STM32_USART1_TX_DMA_MSK))
+#error "invalid DMA stream associated to USART1"
+#endif
+
+#if STM32_SERIAL_485_USE_USART2 &&                                           \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART2_RX_DMA_STREAM,           \
+            STM32_USART2_RX_DMA_MSK) ||                                      \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART2_TX_DMA_STREAM,           \
+            STM32_USART2_TX_DMA_MSK))
+#error "invalid DMA stream associated to USART2"
+#endif
+
+#if STM32_SERIAL_485_USE_USART3 &&                                           \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART3_RX_DMA_STREAM,           \
+            STM32_USART3_RX_DMA_MSK) ||                                      \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART3_TX_DMA_STREAM,           \
+            STM32_USART3_TX_DMA_MSK))
+#error "invalid DMA stream associated to USART3"
+#endif
+
+#if STM32_SERIAL_485_USE_UART4 &&                                            \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART4_RX_DMA_STREAM,            \
+            STM32_UART4_RX_DMA_MSK) ||                                       \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART4_TX_DMA_STREAM,            \
+            STM32_UART4_TX_DMA_MSK))
+#error "invalid DMA stream associated to UART4"
+#endif
+
+#if STM32_SERIAL_485_USE_UART5 &&                                            \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART5_RX_DMA_STREAM,            \
+            STM32_UART5_RX_DMA_MSK) ||                                       \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART5_TX_DMA_STREAM,            \
+            STM32_UART5_TX_DMA_MSK))
+#error "invalid DMA stream associated to UART5"
+#endif
+
+#if STM32_SERIAL_485_USE_USART6 &&                                           \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART6_RX_DMA_STREAM,           \
+            STM32_USART6_RX_DMA_MSK) ||                                      \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_USART6_TX_DMA_STREAM,           \
+            STM32_USART6_TX_DMA_MSK))
+#error "invalid DMA stream associated to USART6"
+#endif
+
+#if STM32_SERIAL_485_USE_UART7 &&                                            \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART7_RX_DMA_STREAM,            \
+            STM32_UART7_RX_DMA_MSK) ||                                       \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART7_TX_DMA_STREAM,            \
+            STM32_UART7_TX_DMA_MSK))
+#error "invalid DMA stream associated to UART7"
+#endif
+
+#if STM32_SERIAL_485_USE_UART8 &&                                            \
+    (!STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART8_RX_DMA_STREAM,            \
+            STM32_UART8_RX_DMA_MSK) ||                                       \
+     !STM32_DMA_IS_VALID_ID(STM32_SERIAL_485_UART8_TX_DMA_STREAM,            \
+            STM32_UART8_TX_DMA_MSK))
+#error "invalid DMA stream associated to UART8"
+#endif
+
+#if STM32_SERIAL_485_USE_LPUART1
+#error "LPUART1 not supported in DMA mode"
+#endif
+
+#if STM32_DMA_SUPPORTS_DMAMUX
+#error "DMA mode not supported on devices with a DMAMUX"
+#endif
+
+#if !defined(STM32_DMA_REQUIRED)
+#define STM32_DMA_REQUIRED
+#endif
+#endif /* STM32_SERIAL_485_USE_DMA */
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -311,18 +566,62 @@ typedef struct {
   uint32_t                  cr2;
   /**
    * @brief Initialization value for the CR3 register.
+   * @note  With @p USART_CR3_DEM set the transceiver driver enable line is
+   *        controlled by the peripheral, the pad must be configured as
+   *        the USART DE alternate function and @p ssport left @p NULL.
    */
   uint32_t                  cr3;
   /**
-   * @brief The chip select line port.
+   * @brief The chip select line port or @p NULL.
    */
   ioportid_t                ssport;
   /**
    * @brief The chip select line pad number.
    */
   uint16_t                  sspad;
+  /**
+   * @brief Hardware driver enable assertion time in sample time units.
+   */
+  uint8_t                   deat;
+  /**
+   * @brief Hardware driver enable deassertion time in sample time units.
+   */
+  uint8_t                   dedt;
+#if SERIAL_485_USE_FRAMES || defined(__DOXYGEN__)
+  /**
+   * @brief Receiver timeout ending a frame in bit times, @p 0 ends frames
+   *        on an idle line.
+   * @note  Ignored on LPUART1 which has no receiver timeout.
+   */
+  uint32_t                  rto;
+#endif
 } Serial485Config;
 
+#if STM32_SERIAL_485_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   @p Serial485Driver DMA specific data.
+ */
+#define _serial_485_driver_dma_data                                         \
+  /* Receive DMA stream.*/                                                  \
+  const stm32_dma_stream_t  *dmarx;                                         \
+  /* Transmit DMA stream.*/                                                 \
+  const stm32_dma_stream_t  *dmatx;                                         \
+  /* RX DMA mode bit mask.*/                                                \
+  uint32_t                  rxdmamode;                                      \
+  /* TX DMA mode bit mask.*/                                                \
+  uint32_t                  txdmamode;                                      \
+  /* Circular reception DMA buffer.*/                                       \
+  uint8_t                   rxdmabuf[STM32_SERIAL_485_RX_DMA_BUFFER_SIZE];  \
+  /* Next position in the reception DMA buffer to be drained.*/             \
+  size_t                    rxdmapos;                                       \
+  /* Size of the transmission in progress, zero if idle.*/                  \
+  size_t                    txdmasize;                                      \
+  /* The transmission in progress is sent from a frame buffer.*/            \
+  bool                      txdmaframe;
+#else
+#define _serial_485_driver_dma_data
+#endif /* STM32_SERIAL_485_USE_DMA */
+
 /**
  * @brief   @p Serial485Driver specific data.
  */
@@ -342,7 +641,10 @@ typedef struct {
   /* Pointer to the USART registers block.*/                                \
   USART_TypeDef             *usart;                                         \
   /* Clock frequency for the associated USART/UART.*/                       \
-  uint32_t                  clock;
+  uint32_t                  clock;                                          \
+  /* Mask applied to received data, strips the parity bit.*/               \
+  uint16_t                  rxmask;                                         \
+  _serial_485_driver_dma_data
 
 /*===========================================================================*/
 /* Driver macros.                                                            */
@@ -9,10 +9,12 @@ QHAL_STM32F0XX_DIR := $(dir $(lastword $(MAKEFILE_LIST)))
 CSRC += $(wildcard $(QHAL_STM32F0XX_DIR)/*.c)
 CSRC += $(wildcard $(QHAL_STM32F0XX_DIR)/../LLD/FLASHv1/*.c)
 CSRC += $(wildcard $(QHAL_STM32F0XX_DIR)/../LLD/RTCv2/*.c)
+CSRC += $(wildcard $(QHAL_STM32F0XX_DIR)/../LLD/CRCv1/*.c)
 
 EXTRAINCDIRS += $(QHAL_STM32F0XX_DIR)
 EXTRAINCDIRS += $(QHAL_STM32F0XX_DIR)/../LLD/FLASHv1
 EXTRAINCDIRS += $(QHAL_STM32F0XX_DIR)/../LLD/RTCv2
+EXTRAINCDIRS += $(QHAL_STM32F0XX_DIR)/../LLD/CRCv1
 
 # ChibiOS
 include $(CHIBIOS_DIR)/os/common/startup/ARMCMx/compilers/GCC/mk/startup_stm32f0xx.mk
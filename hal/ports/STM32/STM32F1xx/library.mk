@@ -10,11 +10,13 @@ CSRC += $(wildcard $(QHAL_STM32F1XX_DIR)/*.c)
 CSRC += $(wildcard $(QHAL_STM32F1XX_DIR)/../LLD/FLASHv1/*.c)
 CSRC += $(wildcard $(QHAL_STM32F1XX_DIR)/../LLD/USARTv1/*.c)
 CSRC += $(wildcard $(QHAL_STM32F1XX_DIR)/../LLD/RTCv1/*.c)
+CSRC += $(wildcard $(QHAL_STM32F1XX_DIR)/../LLD/CRCv1/*.c)
 
 EXTRAINCDIRS += $(QHAL_STM32F1XX_DIR)
 EXTRAINCDIRS += $(QHAL_STM32F1XX_DIR)/../LLD/FLASHv1
 EXTRAINCDIRS += $(QHAL_STM32F1XX_DIR)/../LLD/USARTv1
 EXTRAINCDIRS += $(QHAL_STM32F1XX_DIR)/../LLD/RTCv1
+EXTRAINCDIRS += $(QHAL_STM32F1XX_DIR)/../LLD/CRCv1
 
 # ChibiOS
 include $(CHIBIOS_DIR)/os/common/startup/ARMCMx/compilers/GCC/mk/startup_stm32f1xx.mk
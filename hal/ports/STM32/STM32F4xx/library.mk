@@ -10,11 +10,13 @@ CSRC += $(wildcard $(QHAL_STM32F4XX_DIR)/*.c)
 CSRC += $(wildcard $(QHAL_STM32F4XX_DIR)/../LLD/FLASHv2/*.c)
 CSRC += $(wildcard $(QHAL_STM32F4XX_DIR)/../LLD/USARTv1/*.c)
 CSRC += $(wildcard $(QHAL_STM32F4XX_DIR)/../LLD/RTCv2/*.c)
+CSRC += $(wildcard $(QHAL_STM32F4XX_DIR)/../LLD/CRCv1/*.c)
 
 EXTRAINCDIRS += $(QHAL_STM32F4XX_DIR)
 EXTRAINCDIRS += $(QHAL_STM32F4XX_DIR)/../LLD/FLASHv2
 EXTRAINCDIRS += $(QHAL_STM32F4XX_DIR)/../LLD/USARTv1
 EXTRAINCDIRS += $(QHAL_STM32F4XX_DIR)/../LLD/RTCv2
+EXTRAINCDIRS += $(QHAL_STM32F4XX_DIR)/../LLD/CRCv1
 
 # ChibiOS
 include $(CHIBIOS_DIR)/os/common/startup/ARMCMx/compilers/GCC/mk/startup_stm32f4xx.mk
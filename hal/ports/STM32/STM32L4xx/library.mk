@@ -10,11 +10,13 @@ CSRC += $(wildcard $(QHAL_STM32L4XX_DIR)/*.c)
 CSRC += $(wildcard $(QHAL_STM32L4XX_DIR)/../LLD/FLASHv3/*.c)
 CSRC += $(wildcard $(QHAL_STM32L4XX_DIR)/../LLD/USARTv2/*.c)
 CSRC += $(wildcard $(QHAL_STM32L4XX_DIR)/../LLD/RTCv2/*.c)
+CSRC += $(wildcard $(QHAL_STM32L4XX_DIR)/../LLD/CRCv1/*.c)
 
 EXTRAINCDIRS += $(QHAL_STM32L4XX_DIR)
 EXTRAINCDIRS += $(QHAL_STM32L4XX_DIR)/../LLD/FLASHv3
 EXTRAINCDIRS += $(QHAL_STM32L4XX_DIR)/../LLD/USARTv2
 EXTRAINCDIRS += $(QHAL_STM32L4XX_DIR)/../LLD/RTCv2
+EXTRAINCDIRS += $(QHAL_STM32L4XX_DIR)/../LLD/CRCv1
 
 # ChibiOS
 include $(CHIBIOS_DIR)/os/common/startup/ARMCMx/compilers/GCC/mk/startup_stm32l4xx.mk
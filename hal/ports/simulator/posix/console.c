@@ -18,13 +18,24 @@
  * @{
  */
 
-#include <stdio.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
 
 #include "ch.h"
 #include "hal.h"
+#include "qsymqueue.h"
 #include "console.h"
 
+/*
+ * Output is buffered in a queue and written to stdout by a writer thread,
+ * once CONSOLE_FLUSH_THRESHOLD bytes are queued or CONSOLE_FLUSH_INTERVAL
+ * after the first byte. Input is read when stdin signals readable data,
+ * or when a reader finds the input queue empty, so no thread polls.
+ */
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -38,45 +49,234 @@ BaseChannel CD1;
 /* Driver local variables.                                                   */
 /*===========================================================================*/
 
+static uint8_t con_ob[CONSOLE_OUTPUT_BUFFER_SIZE];
+static uint8_t con_ib[CONSOLE_INPUT_BUFFER_SIZE];
+static symmetric_queue_t con_oq;
+static symmetric_queue_t con_iq;
+
+/* Serializes writes to stdout */
+static mutex_t con_mtx;
+/* Writer thread, created by the first write */
+static thread_t *con_writer;
+/* Writer thread while waiting for output */
+static thread_reference_t con_writer_wait;
+/* Writer thread waits for the first byte */
+static bool con_writer_idle;
+/* stdin reached end of file */
+static bool con_eof;
+
+static THD_WORKING_AREA(con_writer_wa, 256);
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
-static size_t _write(void *ip, const uint8_t *bp, size_t n) {
-  size_t ret;
-  (void)ip;
+/**
+ * @brief   Writes to stdout, retrying interrupted and partial writes.
+ */
+static void con_output(const uint8_t *bp, size_t n) {
+
+  while (n > 0) {
+    ssize_t ret = write(STDOUT_FILENO, bp, n);
+    if (ret < 0) {
+      if (errno == EAGAIN) {
+        struct pollfd pfd = { .fd = STDOUT_FILENO, .events = POLLOUT };
+        (void)poll(&pfd, 1, -1);
+      }
+      else if (errno != EINTR)
+        return;
+      continue;
+    }
+    bp += ret;
+    n -= (size_t)ret;
+  }
+}
 
-  do
-  {
-    ret = fwrite(bp, 1, n, stdout);
-    if (errno == EAGAIN || errno == EINTR)
-      chThdSleepMilliseconds(1);
-  } while (ret == 0 && errno == EAGAIN);
+/**
+ * @brief   Writes all queued output to stdout.
+ */
+static void con_drain(void) {
+  uint8_t *p;
+  size_t span;
+
+  chMtxLock(&con_mtx);
+  chSysLock();
+  while ((span = chSymQReadPeekI(&con_oq, &p)) > 0) {
+    chSysUnlock();
+    con_output(p, span);
+    chSysLock();
+    chSymQReadConsumeI(&con_oq, span);
+  }
+  chSchRescheduleS();
+  chSysUnlock();
+  chMtxUnlock(&con_mtx);
+}
 
-  fflush(stdout);
+static THD_FUNCTION(con_writer_thread, arg) {
+  (void)arg;
 
-  return ret;
+  chRegSetThreadName("console");
+
+  while (true) {
+    chSysLock();
+    if (chSymQIsEmptyI(&con_oq)) {
+      con_writer_idle = true;
+      chThdSuspendS(&con_writer_wait);
+      con_writer_idle = false;
+    }
+    if (chSymQGetFullI(&con_oq) < CONSOLE_FLUSH_THRESHOLD)
+      (void)chThdSuspendTimeoutS(&con_writer_wait, CONSOLE_FLUSH_INTERVAL);
+    chSysUnlock();
+
+    con_drain();
+  }
 }
 
-static size_t _read(void *ip, uint8_t *bp, size_t n) {
-  size_t ret;
+/**
+ * @brief   Wakes the writer thread on the first byte or at the threshold.
+ */
+static void con_kick_i(void) {
+
+  if (con_writer_idle ||
+      chSymQGetFullI(&con_oq) >= CONSOLE_FLUSH_THRESHOLD)
+    chThdResumeI(&con_writer_wait, MSG_OK);
+}
+
+static size_t con_write(const uint8_t *bp, size_t n, sysinterval_t timeout) {
+  size_t w = 0;
+
+  chSysLock();
+
+  /* Creates the writer thread. Note, it is created only once.*/
+  if (con_writer == NULL) {
+    thread_descriptor_t descriptor = {
+      "console",
+      THD_WORKING_AREA_BASE(con_writer_wa),
+      THD_WORKING_AREA_END(con_writer_wa),
+      CONSOLE_WRITER_PRIO,
+      con_writer_thread,
+      NULL
+    };
+    con_writer = chThdCreateI(&descriptor);
+  }
+
+  while (w < n) {
+    w += chSymQWriteI(&con_oq, bp + w, n - w);
+    con_kick_i();
+    if (w == n)
+      break;
+
+    /* Full, waits for the writer to free space. */
+    if (chSymQPutTimeoutS(&con_oq, bp[w], timeout) != Q_OK)
+      break;
+    ++w;
+  }
+
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return w;
+}
+
+/**
+ * @brief   Moves data readable on stdin to the input queue.
+ *
+ * @iclass
+ */
+static void con_fill_i(void) {
+  struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+  uint8_t *p;
+
+  size_t space = chSymQWriteReserveI(&con_iq, &p, CONSOLE_INPUT_BUFFER_SIZE);
+  if (con_eof || space == 0 || poll(&pfd, 1, 0) <= 0)
+    return;
+
+  ssize_t ret = read(STDIN_FILENO, p, space);
+  if (ret > 0)
+    chSymQWriteCommitI(&con_iq, (size_t)ret);
+  else if (ret == 0) {
+    /* Wakes readers waiting on the empty queue. */
+    con_eof = true;
+    if (chSymQIsEmptyI(&con_iq))
+      chSymQResetI(&con_iq);
+  }
+}
+
+static size_t con_read(uint8_t *bp, size_t n, sysinterval_t timeout) {
+  size_t r = 0;
+
+  chSysLock();
+  while (r < n) {
+    if (chSymQIsEmptyI(&con_iq)) {
+      con_fill_i();
+      if (con_eof)
+        break;
+    }
+
+    msg_t b = chSymQGetTimeoutS(&con_iq, timeout);
+    if (b < Q_OK)
+      break;
+    bp[r++] = (uint8_t)b;
+  }
+  chSysUnlock();
+
+  return r;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Console input vector.
+ * @details Raised when stdin becomes readable.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(con_input_handler) {
+  OSAL_IRQ_PROLOGUE();
+
+  osalSysLockFromISR();
+  con_fill_i();
+  osalSysUnlockFromISR();
+
+  OSAL_IRQ_EPILOGUE();
+}
+
+static void con_input_signal_handler(int arg) {
+  (void)arg;
+
+  if (con_input_handler() == true) {
+#if CH_DBG_SYSTEM_STATE_CHECK
+    _dbg_check_lock();
+#endif
+    chSchDoReschedule();
+#if CH_DBG_SYSTEM_STATE_CHECK
+    _dbg_check_unlock();
+#endif
+  }
+}
+
+/*===========================================================================*/
+/* Driver channel methods.                                                   */
+/*===========================================================================*/
+
+static size_t _write(void *ip, const uint8_t *bp, size_t n) {
   (void)ip;
 
-  do
-  {
-      ret = fread(bp, 1, n, stdin);
-      if (errno == EAGAIN || errno == EINTR)
-        chThdSleepMilliseconds(1);
-  } while (ret == 0 &&
-      (errno == EAGAIN || errno == EINTR));
+  return con_write(bp, n, TIME_INFINITE);
+}
+
+static size_t _read(void *ip, uint8_t *bp, size_t n) {
+  (void)ip;
 
-  return ret;
+  return con_read(bp, n, TIME_INFINITE);
 }
 
 static msg_t _put(void *ip, uint8_t b) {
   (void)ip;
 
-  if (_write(ip, &b, 1) == 1)
+  if (con_write(&b, 1, TIME_INFINITE) == 1)
     return MSG_OK;
   else
     return MSG_RESET;
@@ -86,50 +286,28 @@ static msg_t _get(void *ip) {
   (void)ip;
 
   uint8_t b;
-  if (_read(ip, &b, 1) == 1)
-    return MSG_OK;
+  if (con_read(&b, 1, TIME_INFINITE) == 1)
+    return b;
   else
     return MSG_RESET;
 }
 
 static size_t _writet(void *ip, const uint8_t *bp, size_t n, sysinterval_t timeout) {
-  systime_t start = chVTGetSystemTimeX();
-  size_t ret;
-
-  do
-  {
-    if (chVTTimeElapsedSinceX(start) > timeout)
-      return MSG_TIMEOUT;
-    ret = fwrite(bp, 1, n, stdout);
-    if (errno == EAGAIN || errno == EINTR)
-      chThdSleepMilliseconds(1);
-  } while (ret == 0 &&
-      (errno == EAGAIN || errno == EINTR));
+  (void)ip;
 
-  return ret;
+  return con_write(bp, n, timeout);
 }
 
 static size_t _readt(void *ip, uint8_t *bp, size_t n, sysinterval_t timeout) {
-    systime_t start = chVTGetSystemTimeX();
-  size_t ret;
-
-  do
-  {
-    if (chVTTimeElapsedSinceX(start) > timeout)
-      return MSG_TIMEOUT;
-    ret = fread(bp, 1, n, stdin);
-    if (errno == EAGAIN || errno == EINTR)
-      chThdSleepMilliseconds(1);
-  } while (ret == 0 &&
-      (errno == EAGAIN || errno == EINTR));
+  (void)ip;
 
-  return ret;
+  return con_read(bp, n, timeout);
 }
 
 static msg_t _putt(void *ip, uint8_t b, sysinterval_t timeout) {
   (void)ip;
 
-  if (_writet(ip, &b, 1, timeout) == 1)
+  if (con_write(&b, 1, timeout) == 1)
     return MSG_OK;
   else
     return MSG_TIMEOUT;
@@ -139,7 +317,7 @@ static msg_t _gett(void *ip, sysinterval_t timeout) {
   (void)ip;
 
   uint8_t b;
-  if (_readt(ip, &b, 1, timeout) == 1)
+  if (con_read(&b, 1, timeout) == 1)
     return b;
   else
     return MSG_TIMEOUT;
@@ -161,17 +339,47 @@ static const struct BaseChannelVMT vmt = {
   _ctl
 };
 
-/*===========================================================================*/
-/* Driver interrupt handlers.                                                */
-/*===========================================================================*/
-
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
 
+/**
+ * @brief   Console initialization.
+ * @details stdin is switched to signal driven I/O, if it does not support
+ *          it, e.g. a regular file, input is read on demand.
+ */
 void conInit(void) {
+  struct sigaction sigio = {
+    .sa_flags = 0,
+    .sa_handler = con_input_signal_handler,
+  };
+
+  chSymQObjectInit(&con_oq, con_ob, sizeof(con_ob));
+  chSymQObjectInit(&con_iq, con_ib, sizeof(con_ib));
+  chMtxObjectInit(&con_mtx);
+  con_eof = false;
+
+  /* The timer signal stays masked like in the tick handler. */
+  if (sigemptyset(&sigio.sa_mask) < 0 ||
+      sigaddset(&sigio.sa_mask, SIGIO) < 0 ||
+      sigaddset(&sigio.sa_mask, PORT_TIMER_SIGNAL) < 0 ||
+      sigaction(SIGIO, &sigio, NULL) < 0)
+    chSysHalt("sigaction() failed");
+
+  int flags = fcntl(STDIN_FILENO, F_GETFL);
+  if (flags >= 0 && fcntl(STDIN_FILENO, F_SETOWN, getpid()) == 0)
+    (void)fcntl(STDIN_FILENO, F_SETFL, flags | O_ASYNC);
 
   CD1.vmt = &vmt;
 }
 
+/**
+ * @brief   Writes all buffered output to stdout.
+ * @details Used before exiting or when output must not be delayed.
+ */
+void conFlush(void) {
+
+  con_drain();
+}
+
 /** @} */
@@ -29,10 +29,58 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Configuration options
+ * @{
+ */
+
+/**
+ * @brief   Output buffer size.
+ * @details Writers block while the buffer is full.
+ */
+#if !defined(CONSOLE_OUTPUT_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define CONSOLE_OUTPUT_BUFFER_SIZE      4096
+#endif
+
+/**
+ * @brief   Input buffer size.
+ */
+#if !defined(CONSOLE_INPUT_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define CONSOLE_INPUT_BUFFER_SIZE       256
+#endif
+
+/**
+ * @brief   Buffered output bytes which wake the writer thread.
+ */
+#if !defined(CONSOLE_FLUSH_THRESHOLD) || defined(__DOXYGEN__)
+#define CONSOLE_FLUSH_THRESHOLD         (CONSOLE_OUTPUT_BUFFER_SIZE / 2)
+#endif
+
+/**
+ * @brief   Longest time output stays buffered.
+ */
+#if !defined(CONSOLE_FLUSH_INTERVAL) || defined(__DOXYGEN__)
+#define CONSOLE_FLUSH_INTERVAL          TIME_MS2I(20)
+#endif
+
+/**
+ * @brief   Writer thread priority.
+ */
+#if !defined(CONSOLE_WRITER_PRIO) || defined(__DOXYGEN__)
+#define CONSOLE_WRITER_PRIO             NORMALPRIO
+#endif
+
+/** @} */
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CONSOLE_FLUSH_THRESHOLD < 1) ||                                        \
+    (CONSOLE_FLUSH_THRESHOLD > CONSOLE_OUTPUT_BUFFER_SIZE)
+#error "CONSOLE_FLUSH_THRESHOLD must be within 1 and the output buffer size"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -51,6 +99,7 @@ extern BaseChannel CD1;
 extern "C" {
 #endif
   void conInit(void);
+  void conFlush(void);
 #ifdef __cplusplus
 }
 #endif
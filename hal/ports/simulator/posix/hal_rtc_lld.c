@@ -79,6 +79,7 @@ void rtc_lld_set_time(RTCDriver *rtcp, const RTCDateTime *timespec)
 
 /**
  * @brief   Get current time.
+ * @note    Follows the virtual time with @p PORT_VIRTUAL_TIME.
  *
  * @param[in] rtcp      pointer to RTC driver structure
  * @param[out] timespec pointer to a @p RTCTime structure
@@ -88,11 +89,15 @@ void rtc_lld_set_time(RTCDriver *rtcp, const RTCDateTime *timespec)
 void rtc_lld_get_time(RTCDriver *rtcp, RTCDateTime *timespec)
 {
     (void)rtcp;
-    time_t timestamp;
-    time(&timestamp);
+    struct timespec ts;
+#if PORT_VIRTUAL_TIME
+    st_lld_get_realtime(&ts);
+#else
+    clock_gettime(CLOCK_REALTIME, &ts);
+#endif
     struct tm tm;
-    gmtime_r(&timestamp, &tm);
-    rtcConvertStructTmToDateTime(&tm, 0, timespec);
+    gmtime_r(&ts.tv_sec, &tm);
+    rtcConvertStructTmToDateTime(&tm, ts.tv_nsec / 1000000, timespec);
 }
 
 /**
@@ -23,6 +23,8 @@
 #include "hal.h"
 
 #include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
 
 #if (OSAL_ST_MODE != OSAL_ST_MODE_NONE) || defined(__DOXYGEN__)
 
@@ -32,10 +34,14 @@
 
 #if OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING
 
-#error "Posix port doesn't support free-running timer yet."
+#define NSEC_PER_SEC                    1000000000U
 
 #endif /* OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING */
 
+#if PORT_VIRTUAL_TIME && (OSAL_ST_MODE != OSAL_ST_MODE_FREERUNNING)
+#error "PORT_VIRTUAL_TIME requires the free-running mode"
+#endif
+
 #if OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC
 
 #endif /* OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC */
@@ -44,6 +50,23 @@
 /* Driver exported variables.                                                */
 /*===========================================================================*/
 
+#if (OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING) || defined(__DOXYGEN__)
+/**
+ * @brief   Monotonic clock ticks at counter zero.
+ */
+uint64_t st_lld_epoch;
+
+/**
+ * @brief   Current alarm time.
+ */
+systime_t st_lld_alarm;
+
+/**
+ * @brief   Alarm armed.
+ */
+bool st_lld_alarm_active;
+#endif /* OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING */
+
 /*===========================================================================*/
 /* Driver local types.                                                       */
 /*===========================================================================*/
@@ -52,23 +75,82 @@
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
-/*===========================================================================*/
-/* Driver local functions.                                                   */
-/*===========================================================================*/
+#if OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING
+/* One-shot alarm timer */
+static timer_t st_timer;
+#if PORT_VIRTUAL_TIME
+/* Ticks skipped by idle jumps */
+static uint64_t st_skew;
+#endif /* PORT_VIRTUAL_TIME */
+#endif /* OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING */
 
 /*===========================================================================*/
-/* Driver interrupt handlers.                                                */
+/* Driver local functions.                                                   */
 /*===========================================================================*/
 
-#if (OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING) || defined(__DOXYGEN__)
+#if OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING
+/**
+ * @brief   Programs the alarm timer to expire at a counter value.
+ * @details Alarm times up to half the counter range ahead are treated as
+ *          future, earlier ones as already passed and fire immediately.
+ */
+static void st_timer_program(systime_t alarm_time)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    uint64_t now = st_lld_timespec_to_ticks(&ts) - st_lld_epoch;
+    systime_t delta = (systime_t)(alarm_time - (systime_t)now);
+
+    if (delta > (systime_t)-1 / 2)
+        delta = 0;
+
+    /* Rounds the expiry up so the counter reached the alarm when it fires. */
+    uint64_t ticks = st_lld_epoch + now + delta;
+    struct itimerspec its = {
+        .it_interval = { 0, 0 },
+        .it_value = {
+            .tv_sec = ticks / OSAL_ST_FREQUENCY,
+            .tv_nsec = ((ticks % OSAL_ST_FREQUENCY) * NSEC_PER_SEC +
+                    OSAL_ST_FREQUENCY - 1) / OSAL_ST_FREQUENCY,
+        },
+    };
 
+    if (timer_settime(st_timer, TIMER_ABSTIME, &its, NULL) < 0)
+        chSysHalt("timer_settime() failed");
+}
 #endif /* OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING */
 
-#if (OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC) || defined(__DOXYGEN__)
+/**
+ * @brief   Installs the handler of the timer signal.
+ */
+static void st_signal_init(void (*handler)(int))
+{
+    struct sigaction sigtick = {
+        .sa_flags = 0,
+        .sa_handler = handler,
+    };
+
+    /* Set timer signal to be auto masked when entering handler.
+     * On exit it will be automatically unmasked as well. */
+    if (sigemptyset(&sigtick.sa_mask) < 0)
+        chSysHalt("sigemptyset() failed");
+
+    if (sigaddset(&sigtick.sa_mask, PORT_TIMER_SIGNAL) < 0)
+        chSysHalt("sigaddset() failed");
+
+    if (sigaction(PORT_TIMER_SIGNAL, &sigtick, NULL) < 0)
+        chSysHalt("sigaction() failed");
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
 
 /**
  * @brief   System Timer vector.
- * @details This interrupt is used for system tick in periodic mode.
+ * @details This interrupt is used for system tick in periodic mode and for
+ *          the alarm in free-running mode.
  *
  * @isr
  */
@@ -97,8 +179,6 @@ static void port_tick_signal_handler_stub(int arg)
     }
 }
 
-#endif /* OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC */
-
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -110,29 +190,29 @@ static void port_tick_signal_handler_stub(int arg)
  */
 void st_lld_init(void)
 {
+    st_signal_init(port_tick_signal_handler_stub);
+
 #if OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING
     /* Free running counter mode. */
-
-#endif /* OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING */
-
-#if OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC
-    /* Periodic systick mode. */
-    struct sigaction sigtick = {
-        .sa_flags = 0,
-        .sa_handler = port_tick_signal_handler_stub,
+    struct sigevent sev = {
+        .sigev_notify = SIGEV_SIGNAL,
+        .sigev_signo = PORT_TIMER_SIGNAL,
     };
 
-    /* Set timer signal to be auto masked when entering handler.
-     * On exit it will be automatically unmasked as well. */
-    if (sigemptyset(&sigtick.sa_mask) < 0)
-        chSysHalt("sigemptyset() failed");
+    if (timer_create(CLOCK_MONOTONIC, &sev, &st_timer) < 0)
+        chSysHalt("timer_create() failed");
 
-    if (sigaddset(&sigtick.sa_mask, PORT_TIMER_SIGNAL) < 0)
-        chSysHalt("sigaddset() failed");
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
 
-    if (sigaction(PORT_TIMER_SIGNAL, &sigtick, NULL) < 0)
-        chSysHalt("sigaction() failed");
+    /* The counter starts at zero. */
+    st_lld_epoch = st_lld_timespec_to_ticks(&ts);
+    st_lld_alarm = 0;
+    st_lld_alarm_active = false;
+#endif /* OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING */
 
+#if OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC
+    /* Periodic systick mode. */
     const suseconds_t usecs = 1000000 / CH_CFG_ST_FREQUENCY;
     struct itimerval itimer, oitimer;
 
@@ -154,6 +234,112 @@ void st_lld_init(void)
 #endif /* OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC */
 }
 
+#if (OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the alarm.
+ * @note    Makes sure that no spurious alarms are triggered after
+ *          this call.
+ *
+ * @param[in] alarm_time    the time to be set for the first alarm
+ *
+ * @notapi
+ */
+void st_lld_start_alarm(systime_t alarm_time)
+{
+    st_lld_alarm = alarm_time;
+    st_lld_alarm_active = true;
+    st_timer_program(alarm_time);
+}
+
+/**
+ * @brief   Stops the alarm interrupt.
+ *
+ * @notapi
+ */
+void st_lld_stop_alarm(void)
+{
+    const struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+
+    st_lld_alarm_active = false;
+
+    if (timer_settime(st_timer, 0, &its, NULL) < 0)
+        chSysHalt("timer_settime() failed");
+}
+
+/**
+ * @brief   Sets the alarm time.
+ *
+ * @param[in] alarm_time    the time to be set for the next alarm
+ *
+ * @notapi
+ */
+void st_lld_set_alarm(systime_t alarm_time)
+{
+    st_lld_alarm = alarm_time;
+    st_timer_program(alarm_time);
+}
+
+/**
+ * @brief   Waits for the next timer signal while all threads are idle.
+ * @details With @p PORT_VIRTUAL_TIME the system time first jumps to the
+ *          pending alarm, which then fires immediately.
+ *
+ * @notapi
+ */
+void st_lld_wait_for_interrupt(void)
+{
+#if PORT_VIRTUAL_TIME
+    chSysLock();
+
+    if (st_lld_alarm_active)
+    {
+        systime_t delta = (systime_t)(st_lld_alarm - st_lld_get_counter());
+
+        if (delta <= (systime_t)-1 / 2)
+        {
+            /* Moves the counter forward, the alarm is due now. */
+            st_lld_epoch -= delta;
+            st_skew += delta;
+            st_timer_program(st_lld_alarm);
+        }
+
+        /* The signal is delivered on unlock or shortly after. */
+        chSysUnlock();
+        return;
+    }
+
+    chSysUnlock();
+#endif /* PORT_VIRTUAL_TIME */
+
+    pause();
+}
+
+#if PORT_VIRTUAL_TIME || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the wall clock time following the virtual time.
+ * @details The host time plus all ticks skipped by idle jumps.
+ *
+ * @param[out] tsp      pointer to the time
+ *
+ * @notapi
+ */
+void st_lld_get_realtime(struct timespec *tsp)
+{
+    chSysLock();
+    uint64_t skew = st_skew;
+    chSysUnlock();
+
+    clock_gettime(CLOCK_REALTIME, tsp);
+
+    uint64_t nsec = tsp->tv_nsec +
+            (skew % OSAL_ST_FREQUENCY) * NSEC_PER_SEC / OSAL_ST_FREQUENCY;
+
+    tsp->tv_sec += skew / OSAL_ST_FREQUENCY + nsec / NSEC_PER_SEC;
+    tsp->tv_nsec = nsec % NSEC_PER_SEC;
+}
+#endif /* PORT_VIRTUAL_TIME */
+#endif /* OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING */
+
 #endif /* OSAL_ST_MODE != OSAL_ST_MODE_NONE */
 
 /** @} */
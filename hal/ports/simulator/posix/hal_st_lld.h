@@ -25,6 +25,8 @@
 #ifndef _ST_LLD_H_
 #define _ST_LLD_H_
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 
 /*===========================================================================*/
@@ -42,6 +44,8 @@
 
 /**
  * @brief   Typer time to be used to generate systick interrupt.
+ * @note    Only used in periodic mode, the free-running mode always uses a
+ *          @p CLOCK_MONOTONIC POSIX timer.
  * @details ITIMER_REAL
  *            Decrements in real time, and delivers SIGALRM upon expiration.
  *            This timer will fail when using debug breakpoints.
@@ -70,6 +74,16 @@
 #define PORT_TIMER_SIGNAL               SIGALRM
 #endif
 
+/**
+ * @brief   Accelerated virtual time.
+ * @details When all threads are idle the system time jumps straight to the
+ *          next timer deadline instead of waiting for the host clock. The
+ *          RTC follows the same clock. Requires the free-running mode.
+ */
+#if !defined(PORT_VIRTUAL_TIME) || defined(__DOXYGEN__)
+#define PORT_VIRTUAL_TIME               FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -84,14 +98,36 @@
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Converts a @p CLOCK_MONOTONIC time to system ticks.
+ *
+ * @param[in] tsp       pointer to the time
+ *
+ * @notapi
+ */
+#define st_lld_timespec_to_ticks(tsp)                                       \
+  ((uint64_t)(tsp)->tv_sec * OSAL_ST_FREQUENCY +                            \
+   (uint64_t)(tsp)->tv_nsec * OSAL_ST_FREQUENCY / 1000000000U)
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
 
+extern uint64_t st_lld_epoch;
+extern systime_t st_lld_alarm;
+extern bool st_lld_alarm_active;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
   void st_lld_init(void);
+  void st_lld_start_alarm(systime_t alarm_time);
+  void st_lld_stop_alarm(void);
+  void st_lld_set_alarm(systime_t alarm_time);
+  void st_lld_wait_for_interrupt(void);
+#if PORT_VIRTUAL_TIME || defined(__DOXYGEN__)
+  void st_lld_get_realtime(struct timespec *tsp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -102,6 +138,8 @@ extern "C" {
 
 /**
  * @brief   Returns the time counter value.
+ * @details The counter runs on @p CLOCK_MONOTONIC at @p OSAL_ST_FREQUENCY
+ *          and starts at zero in @p st_lld_init().
  *
  * @return              The counter value.
  *
@@ -110,44 +148,9 @@ extern "C" {
 static inline systime_t st_lld_get_counter(void) {
 
   struct timespec ts;
-  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
-
-  return (systime_t)ts.tv_nsec;
-}
-
-/**
- * @brief   Starts the alarm.
- * @note    Makes sure that no spurious alarms are triggered after
- *          this call.
- *
- * @param[in] alarm_time    the time to be set for the first alarm
- *
- * @notapi
- */
-static inline void st_lld_start_alarm(systime_t alarm_time) {
-
-  (void)alarm_time;
-}
-
-/**
- * @brief   Stops the alarm interrupt.
- *
- * @notapi
- */
-static inline void st_lld_stop_alarm(void) {
-
-}
-
-/**
- * @brief   Sets the alarm time.
- *
- * @param[in] alarm_time    the time to be set for the next alarm
- *
- * @notapi
- */
-static inline void st_lld_set_alarm(systime_t alarm_time) {
+  clock_gettime(CLOCK_MONOTONIC, &ts);
 
-  (void)alarm_time;
+  return (systime_t)(st_lld_timespec_to_ticks(&ts) - st_lld_epoch);
 }
 
 /**
@@ -159,7 +162,7 @@ static inline void st_lld_set_alarm(systime_t alarm_time) {
  */
 static inline systime_t st_lld_get_alarm(void) {
 
-  return (systime_t)0;
+  return st_lld_alarm;
 }
 
 /**
@@ -173,7 +176,7 @@ static inline systime_t st_lld_get_alarm(void) {
  */
 static inline bool st_lld_is_alarm_active(void) {
 
-  return false;
+  return st_lld_alarm_active;
 }
 
 #endif /* _ST_LLD_H_ */
@@ -59,6 +59,173 @@ static uint32_t convert_color(color_t color)
 #endif
 }
 
+/**
+ * @brief   Image words of the low and high color bytes.
+ * @details RGB565 expands bitwise, so a pixel word is the OR of the entries
+ *          of its two bytes.
+ */
+#if (GD_COLORFORMAT == GD_COLORFORMAT_RGB565) || defined(__DOXYGEN__)
+static uint32_t lut_low[256];
+static uint32_t lut_high[256];
+#endif
+
+/**
+ * @brief   Image byte order differs from the host byte order.
+ */
+static bool image_swap;
+
+/**
+ * @brief   Prepares span conversion for an image byte order.
+ */
+static void convert_init(uint8_t byte_order)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    image_swap = (byte_order != XCB_IMAGE_ORDER_MSB_FIRST);
+#else
+    image_swap = (byte_order == XCB_IMAGE_ORDER_MSB_FIRST);
+#endif
+
+#if GD_COLORFORMAT == GD_COLORFORMAT_RGB565
+    for (unsigned i = 0; i < 256; ++i)
+    {
+        lut_low[i] = convert_color(i);
+        lut_high[i] = convert_color(i << 8);
+        if (image_swap)
+        {
+            lut_low[i] = __builtin_bswap32(lut_low[i]);
+            lut_high[i] = __builtin_bswap32(lut_high[i]);
+        }
+    }
+#endif
+}
+
+/**
+ * @brief   Converts a span of colors to image words.
+ */
+static void convert_span(uint32_t* p, const color_t data[], coord_t n)
+{
+#if GD_COLORFORMAT == GD_COLORFORMAT_RGB565
+    for (coord_t i = 0; i < n; ++i)
+        p[i] = lut_low[data[i] & 0xff] | lut_high[data[i] >> 8];
+#else
+    if (image_swap)
+    {
+        for (coord_t i = 0; i < n; ++i)
+            p[i] = __builtin_bswap32(convert_color(data[i]));
+    }
+    else
+    {
+        for (coord_t i = 0; i < n; ++i)
+            p[i] = convert_color(data[i]);
+    }
+#endif
+}
+
+/**
+ * @brief   Returns the image location of a pixel.
+ */
+static uint32_t* pixel_ptr(GDSimDriver* gdsimp, coord_t x, coord_t y)
+{
+    return (uint32_t*)(gdsimp->xcb_image->data +
+            y * gdsimp->xcb_image->stride) + x;
+}
+
+/**
+ * @brief   Pushes memory rows of the image to display rows of the window.
+ * @details The area is uploaded once into the backing pixmap and copied from
+ *          there into the window.
+ * @note    Called with the lock held.
+ */
+static void damage_put(GDSimDriver* gdsimp, coord_t left, coord_t top,
+        coord_t width, coord_t height, coord_t display_top)
+{
+    if (height == 0)
+        return;
+
+    /* Create subimage for to be flushed area. */
+    xcb_image_t* sub_image = xcb_image_subimage(
+            gdsimp->xcb_image,
+            left,
+            top,
+            width,
+            height,
+            0,
+            0,
+            0);
+
+    /* Convert subimage to connection native format. */
+    xcb_image_t* native_image =
+            xcb_image_native(gdsimp->xcb_connection,
+                    sub_image,
+                    1);
+
+    /* Draw it into the pixmap (for restoring the window). */
+    xcb_image_put(gdsimp->xcb_connection,
+            gdsimp->xcb_pixmap,
+            gdsimp->xcb_gcontext,
+            native_image,
+            left,
+            display_top,
+            0);
+
+    /* Copy it into the window. */
+    xcb_copy_area(gdsimp->xcb_connection, gdsimp->xcb_pixmap,
+            gdsimp->xcb_window, gdsimp->xcb_gcontext,
+            left, display_top,
+            left, display_top,
+            width, height);
+
+    if (native_image != sub_image)
+        xcb_image_destroy(native_image);
+    xcb_image_destroy(sub_image);
+}
+
+/**
+ * @brief   Pushes an area of the image to the window.
+ * @details Rows of the scrolling area are shown rotated by the scroll start,
+ *          splitting the area into up to four parts.
+ * @note    Called with the lock held.
+ */
+static void damage_flush(GDSimDriver* gdsimp, coord_t left, coord_t top,
+        coord_t width, coord_t height)
+{
+    const coord_t bottom = top + height;
+    const coord_t scroll_top = gdsimp->scroll_top;
+    const coord_t scroll_bottom = scroll_top + gdsimp->scroll_height;
+    const coord_t start = gdsimp->scroll_start;
+
+    if ((gdsimp->scroll_height == 0) || (bottom <= scroll_top) ||
+            (top >= scroll_bottom))
+    {
+        damage_put(gdsimp, left, top, width, height, top);
+        return;
+    }
+
+    /* Fixed rows above and below. */
+    if (top < scroll_top)
+    {
+        damage_put(gdsimp, left, top, width, scroll_top - top, top);
+        top = scroll_top;
+    }
+    if (bottom > scroll_bottom)
+        damage_put(gdsimp, left, scroll_bottom, width,
+                bottom - scroll_bottom, scroll_bottom);
+
+    /* Memory rows from the start on are shown first, the ones before it
+       wrap around below them. */
+    coord_t end = (bottom < scroll_bottom) ? bottom : scroll_bottom;
+    if (top < start)
+    {
+        coord_t part = ((end < start) ? end : start) - top;
+        damage_put(gdsimp, left, top, width, part,
+                top + scroll_bottom - start);
+        top += part;
+    }
+    if (top < end)
+        damage_put(gdsimp, left, top, width, end - top,
+                scroll_top + top - start);
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers and threads.                                    */
 /*===========================================================================*/
@@ -98,7 +265,6 @@ static void gdsim_lld_pump(void* p)
                             ee->x, ee->y,
                             ee->x, ee->y,
                             ee->width, ee->height);
-                    xcb_flush(gdsimp->xcb_connection);
                     break;
                 }
                 default:
@@ -110,9 +276,19 @@ static void gdsim_lld_pump(void* p)
             /* Free the generic event. */
             free(e);
         }
+
+        /* Pushes the area drawn since the last frame in one go. */
+        if (gdsimp->dirty_right > gdsimp->dirty_left)
+        {
+            damage_flush(gdsimp, gdsimp->dirty_left, gdsimp->dirty_top,
+                    gdsimp->dirty_right - gdsimp->dirty_left,
+                    gdsimp->dirty_bottom - gdsimp->dirty_top);
+            gdsimp->dirty_right = gdsimp->dirty_left;
+        }
+        xcb_flush(gdsimp->xcb_connection);
         osalSysUnlock();
 
-        osalThreadSleepMilliseconds(10);
+        osalThreadSleepMicroseconds(1000000 / GD_SIM_FRAME_RATE);
     }
 }
 
@@ -136,6 +312,14 @@ void gdsim_lld_init(void)
  */
 void gdsim_lld_object_init(GDSimDriver* gdsimp)
 {
+    gdsimp->dirty_left = 0;
+    gdsimp->dirty_top = 0;
+    gdsimp->dirty_right = 0;
+    gdsimp->dirty_bottom = 0;
+    gdsimp->scroll_top = 0;
+    gdsimp->scroll_height = 0;
+    gdsimp->scroll_start = 0;
+
 #if defined(_CHIBIOS_RT_)
     gdsimp->tr = NULL;
     gdsimp->wait = NULL;
@@ -227,7 +411,9 @@ void gdsim_lld_start(GDSimDriver* gdsimp)
         /* Make sure commands are sent before we pause, so window is shown. */
         xcb_flush(gdsimp->xcb_connection);
 
-        /* Create image. */
+        /* Create image in the server byte order, so flushing needs no
+           conversion. */
+        const xcb_setup_t* setup = xcb_get_setup(gdsimp->xcb_connection);
         gdsimp->xcb_image = xcb_image_create(
                 gdsimp->config->size_x,
                 gdsimp->config->size_y,
@@ -236,11 +422,12 @@ void gdsim_lld_start(GDSimDriver* gdsimp)
                 24,
                 32,
                 32,
-                XCB_IMAGE_ORDER_MSB_FIRST,
-                XCB_IMAGE_ORDER_MSB_FIRST,
+                setup->image_byte_order,
+                setup->bitmap_format_bit_order,
                 NULL,
                 0,
                 NULL);
+        convert_init(gdsimp->xcb_image->byte_order);
 
 #if defined(_CHIBIOS_RT_)
         /* Creates the data pump thread. Note, it is created only once.*/
@@ -295,7 +482,7 @@ void gdsim_lld_pixel_set(GDSimDriver* gdsimp, coord_t x, coord_t y,
 {
     osalSysLock();
 
-    xcb_image_put_pixel(gdsimp->xcb_image, x, y, convert_color(color));
+    convert_span(pixel_ptr(gdsimp, x, y), &color, 1);
 
     osalSysUnlock();
 }
@@ -314,93 +501,152 @@ void gdsim_lld_pixel_set(GDSimDriver* gdsimp, coord_t x, coord_t y,
  */
 void gdsim_lld_rect_fill(GDSimDriver* gdsimp, coord_t left, coord_t top,
         coord_t width, coord_t height, color_t color)
+{
+    for (coord_t y = top; y < top + height; ++y)
+        gdsim_lld_span_fill(gdsimp, left, y, color, width);
+}
+
+/**
+ * @brief   Writes a horizontal span of pixels.
+ *
+ * @param[in] gdsimp    pointer to the @p GDSimDriver object
+ * @param[in] x         x coordinate of the first pixel
+ * @param[in] y         y coordinate of the span
+ * @param[in] data[]    array of @p n pixel colors
+ * @param[in] n         number of pixels
+ *
+ * @notapi
+ */
+void gdsim_lld_span_write(GDSimDriver* gdsimp, coord_t x, coord_t y,
+        const color_t data[], coord_t n)
 {
     osalSysLock();
 
-    for (coord_t y = top; y < top + height; ++y)
-        for (size_t x = left; x < left + width; ++x)
-            xcb_image_put_pixel(gdsimp->xcb_image, x, y, convert_color(color));
+    convert_span(pixel_ptr(gdsimp, x, y), data, n);
 
     osalSysUnlock();
 }
 
 /**
- * @brief   Returns device info.
- *
- * @param[in] gdsimp        pointer to the @p GDSimDriver object
- * @param[out] gddip        pointer to a @p GDDeviceInfo structure
+ * @brief   Fills a horizontal span of pixels with a color.
  *
- * @return                  The operation status.
- * @retval HAL_SUCCESS      the operation succeeded.
- * @retval HAL_FAILED       the operation failed.
+ * @param[in] gdsimp    pointer to the @p GDSimDriver object
+ * @param[in] x         x coordinate of the first pixel
+ * @param[in] y         y coordinate of the span
+ * @param[in] color     color to fill the span with
+ * @param[in] n         number of pixels
  *
- * @api
+ * @notapi
  */
-bool gdsim_lld_get_info(GDSimDriver* gdsimp, GDDeviceInfo* gddip)
+void gdsim_lld_span_fill(GDSimDriver* gdsimp, coord_t x, coord_t y,
+        color_t color, coord_t n)
 {
-    gddip->size_x = gdsimp->config->size_x;
-    gddip->size_y = gdsimp->config->size_y;
-    gddip->id[0] = 'S';
-    gddip->id[1] = 'I';
-    gddip->id[2] = 'M';
+    osalSysLock();
 
-    return HAL_SUCCESS;
+    uint32_t* p = pixel_ptr(gdsimp, x, y);
+    if (n > 0)
+    {
+        convert_span(p, &color, 1);
+        for (coord_t i = 1; i < n; ++i)
+            p[i] = p[0];
+    }
+
+    osalSysUnlock();
 }
 
 /**
- * @brief   Flushes the the x client buffer.
+ * @brief   Marks an area to be flushed by the pump thread.
+ * @details The area is merged into the pending dirty rectangle, which the
+ *          pump thread pushes to the window once per frame.
  *
  * @param[in] gdsimp    pointer to the @p GDSimDriver object
+ * @param[in] left      left area border coordinate
+ * @param[in] top       top area border coordinate
+ * @param[in] width     width of the area
+ * @param[in] height    height of the area
  *
  * @notapi
  */
-void gdsim_lld_flush(GDSimDriver* gdsimp, coord_t left, coord_t top,
+void gdsim_lld_invalidate(GDSimDriver* gdsimp, coord_t left, coord_t top,
         coord_t width, coord_t height)
 {
+    if ((width == 0) || (height == 0))
+        return;
+
     osalSysLock();
 
-    /* Create subimage for to be flushed area. */
-    xcb_image_t* sub_image = xcb_image_subimage(
-            gdsimp->xcb_image,
-            left,
-            top,
-            width,
-            height,
-            0,
-            0,
-            0);
+    if (gdsimp->dirty_right <= gdsimp->dirty_left)
+    {
+        gdsimp->dirty_left = left;
+        gdsimp->dirty_top = top;
+        gdsimp->dirty_right = left + width;
+        gdsimp->dirty_bottom = top + height;
+    }
+    else
+    {
+        if (left < gdsimp->dirty_left)
+            gdsimp->dirty_left = left;
+        if (top < gdsimp->dirty_top)
+            gdsimp->dirty_top = top;
+        if (left + width > gdsimp->dirty_right)
+            gdsimp->dirty_right = left + width;
+        if (top + height > gdsimp->dirty_bottom)
+            gdsimp->dirty_bottom = top + height;
+    }
 
-    /* Convert subimage to connection native format. */
-    xcb_image_t* native_image =
-            xcb_image_native(gdsimp->xcb_connection,
-                    sub_image,
-                    1);
+    osalSysUnlock();
+}
 
-    /* Draw it into the window. */
-    xcb_image_put(gdsimp->xcb_connection,
-            gdsimp->xcb_window,
-            gdsimp->xcb_gcontext,
-            native_image,
-            left,
-            top,
-            0);
+/**
+ * @brief   Sets the vertical scrolling area.
+ * @details The area is redrawn by the pump thread.
+ *
+ * @param[in] gdsimp    pointer to the @p GDSimDriver object
+ * @param[in] top       first row of the area
+ * @param[in] height    height of the area, 0 disables scrolling
+ * @param[in] start     memory row shown at the top of the area
+ *
+ * @notapi
+ */
+void gdsim_lld_scroll(GDSimDriver* gdsimp, coord_t top, coord_t height,
+        coord_t start)
+{
+    osalSysLock();
 
-    /* Draw it into the pixmap (for restoring the window). */
-    xcb_image_put(gdsimp->xcb_connection,
-            gdsimp->xcb_pixmap,
-            gdsimp->xcb_gcontext,
-            native_image,
-            left,
-            top,
-            0);
+    const coord_t old_top = gdsimp->scroll_top;
+    const coord_t old_height = gdsimp->scroll_height;
+    gdsimp->scroll_top = top;
+    gdsimp->scroll_height = height;
+    gdsimp->scroll_start = start;
 
-    /* Flush out all requests. */
-    xcb_flush(gdsimp->xcb_connection);
+    osalSysUnlock();
 
-    xcb_image_destroy(sub_image);
-    xcb_image_destroy(native_image);
+    gdsim_lld_invalidate(gdsimp, 0, old_top, gdsimp->config->size_x,
+            old_height);
+    gdsim_lld_invalidate(gdsimp, 0, top, gdsimp->config->size_x, height);
+}
 
-    osalSysUnlock();
+/**
+ * @brief   Returns device info.
+ *
+ * @param[in] gdsimp        pointer to the @p GDSimDriver object
+ * @param[out] gddip        pointer to a @p GDDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool gdsim_lld_get_info(GDSimDriver* gdsimp, GDDeviceInfo* gddip)
+{
+    gddip->size_x = gdsimp->config->size_x;
+    gddip->size_y = gdsimp->config->size_y;
+    gddip->id[0] = 'S';
+    gddip->id[1] = 'I';
+    gddip->id[2] = 'M';
+
+    return HAL_SUCCESS;
 }
 
 #endif /* HAL_USE_GD_SIM */
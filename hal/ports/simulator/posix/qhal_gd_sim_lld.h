@@ -50,6 +50,13 @@
 #define GD_SIM_THREAD_STACK_SIZE            2048
 #endif
 
+/**
+ * @brief   Rate in Hz at which drawn areas are pushed to the window.
+ */
+#if !defined(GD_SIM_FRAME_RATE) || defined(__DOXYGEN__)
+#define GD_SIM_FRAME_RATE                   60
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -58,6 +65,10 @@
 #error "GD_SIM requires ChibiOS RT"
 #endif
 
+#if (GD_SIM_FRAME_RATE < 1) || (GD_SIM_FRAME_RATE > 1000)
+#error "GD_SIM_FRAME_RATE must be within 1 and 1000"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -146,6 +157,21 @@ typedef struct
     coord_t stream_width;
     coord_t stream_height;
     size_t stream_pos;
+    /**
+     * @brief   Area drawn but not flushed yet, empty if @p dirty_right is
+     *          not greater than @p dirty_left.
+     */
+    coord_t dirty_left;
+    coord_t dirty_top;
+    coord_t dirty_right;
+    coord_t dirty_bottom;
+    /**
+     * @brief   Vertical scrolling area, disabled if @p scroll_height is 0.
+     * @details Memory row @p scroll_start is shown at @p scroll_top.
+     */
+    coord_t scroll_top;
+    coord_t scroll_height;
+    coord_t scroll_start;
 } GDSimDriver;
 
 /*===========================================================================*/
@@ -165,11 +191,17 @@ extern "C" {
     void gdsim_lld_stop(GDSimDriver* gdsimp);
     void gdsim_lld_pixel_set(GDSimDriver* gdsimp, coord_t x, coord_t y,
             color_t color);
+    void gdsim_lld_span_write(GDSimDriver* gdsimp, coord_t x, coord_t y,
+            const color_t data[], coord_t n);
+    void gdsim_lld_span_fill(GDSimDriver* gdsimp, coord_t x, coord_t y,
+            color_t color, coord_t n);
     void gdsim_lld_rect_fill(GDSimDriver* gdsimp, coord_t left, coord_t top,
             coord_t width, coord_t height, color_t color);
-    bool gdsim_lld_get_info(GDSimDriver* gdsimp, GDDeviceInfo* gddip);
-    void gdsim_lld_flush(GDSimDriver* gdsimp, coord_t left, coord_t top,
+    void gdsim_lld_invalidate(GDSimDriver* gdsimp, coord_t left, coord_t top,
             coord_t width, coord_t height);
+    void gdsim_lld_scroll(GDSimDriver* gdsimp, coord_t top, coord_t height,
+            coord_t start);
+    bool gdsim_lld_get_info(GDSimDriver* gdsimp, GDDeviceInfo* gddip);
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,28 @@
 /* Driver exported functions.                                                */
 /*===========================================================================*/
 
+/**
+ * @brief   Gets the RTC time in microseconds since 1970-01-01.
+ * @note    Follows the virtual time with @p PORT_VIRTUAL_TIME.
+ *
+ * @param[in] rtcp          pointer to RTC driver structure
+ * @return                  The timestamp.
+ *
+ * @xclass
+ */
+uint64_t rtcGetTimestampUsX(RTCDriver *rtcp)
+{
+    (void)rtcp;
+    struct timespec ts;
+#if PORT_VIRTUAL_TIME
+    st_lld_get_realtime(&ts);
+#else
+    clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
 #endif /* HAL_USE_RTC */
 
 /** @} */
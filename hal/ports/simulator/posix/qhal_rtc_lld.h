@@ -54,6 +54,7 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+  uint64_t rtcGetTimestampUsX(RTCDriver *rtcp);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,620 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    serial_socket.c
+ * @brief   Simulator serial driver over UNIX domain sockets code.
+ *
+ * @addtogroup SERIAL_SOCKET
+ * @{
+ */
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE                     /* F_SETSIG */
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "hal.h"
+#include "serial_socket.h"
+
+/*
+ * The sockets are non-blocking and signal driven. The signal handler moves
+ * received data to the input queue and queued output to the socket, like
+ * the interrupt handler of a UART. Writers send directly while nothing is
+ * queued ahead, readers refill the input queue before waiting, so data
+ * left in the socket while the queue was full is not missed.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/* Started drivers */
+static SerialSocketDriver *sdsocket_list;
+/* Signal handler installed */
+static bool sdsocket_signal_ready;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Handles a disconnected peer.
+ * @details Pending output is dropped, received data stays readable.
+ *
+ * @iclass
+ */
+static void sdsocket_closed_i(SerialSocketDriver *sdsp)
+{
+    sdsp->state = SDSOCKET_CLOSED;
+    chSymQResetI(&sdsp->oqueue);
+    if (chSymQIsEmptyI(&sdsp->iqueue))
+        chSymQResetI(&sdsp->iqueue);
+    chnAddFlagsI(sdsp, CHN_DISCONNECTED);
+}
+
+/**
+ * @brief   Moves received data to the input queue.
+ *
+ * @iclass
+ */
+static void sdsocket_receive_i(SerialSocketDriver *sdsp)
+{
+    bool empty = chSymQIsEmptyI(&sdsp->iqueue);
+    uint8_t *p;
+    size_t span;
+
+    while ((sdsp->state == SDSOCKET_READY) &&
+            ((span = chSymQWriteReserveI(&sdsp->iqueue, &p, SIZE_MAX)) > 0))
+    {
+        ssize_t ret = recv(sdsp->fd, p, span, 0);
+
+        if (ret > 0)
+        {
+            chSymQWriteCommitI(&sdsp->iqueue, (size_t)ret);
+            /* Continues only at the buffer end.*/
+            if ((size_t)ret < span)
+                break;
+        }
+        else if (ret == 0)
+            sdsocket_closed_i(sdsp);
+        else if (errno != EINTR)
+            break;
+    }
+
+    if ((empty == TRUE) && (chSymQIsEmptyI(&sdsp->iqueue) == FALSE))
+        chnAddFlagsI(sdsp, CHN_INPUT_AVAILABLE);
+}
+
+/**
+ * @brief   Sends queued output until the socket is full.
+ * @details A full socket raises the signal once it accepts data again.
+ *
+ * @iclass
+ */
+static void sdsocket_transmit_i(SerialSocketDriver *sdsp)
+{
+    bool empty = chSymQIsEmptyI(&sdsp->oqueue);
+    uint8_t *p;
+    size_t span;
+
+    while ((sdsp->state == SDSOCKET_READY) &&
+            ((span = chSymQReadPeekI(&sdsp->oqueue, &p)) > 0))
+    {
+        ssize_t ret = send(sdsp->fd, p, span, MSG_NOSIGNAL);
+
+        if (ret > 0)
+        {
+            chSymQReadConsumeI(&sdsp->oqueue, (size_t)ret);
+            if ((size_t)ret < span)
+                break;
+        }
+        else if (errno == EPIPE || errno == ECONNRESET)
+            sdsocket_closed_i(sdsp);
+        else if (errno != EINTR)
+            break;
+    }
+
+    if ((empty == FALSE) && (chSymQIsEmptyI(&sdsp->oqueue) == TRUE))
+        chnAddFlagsI(sdsp, CHN_OUTPUT_EMPTY);
+}
+
+/**
+ * @brief   Calculates the remaining time of an operation.
+ *
+ * @return              The remaining time or @p TIME_IMMEDIATE if expired.
+ */
+static sysinterval_t sdsocket_remaining(systime_t start, sysinterval_t timeout)
+{
+    if (timeout == TIME_IMMEDIATE || timeout == TIME_INFINITE)
+        return timeout;
+    if (chVTTimeElapsedSinceX(start) >= timeout)
+        return TIME_IMMEDIATE;
+
+    return timeout - chVTTimeElapsedSinceX(start);
+}
+
+/**
+ * @brief   Writes data to the far end.
+ *
+ * @param[in] sdsp      pointer to a @p SerialSocketDriver object
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the amount of data to be transferred
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @param[out] wp       number of bytes transferred
+ * @return              The operation status.
+ *
+ * @sclass
+ */
+static msg_t sdsocket_writeS(SerialSocketDriver *sdsp, const uint8_t *bp,
+        size_t n, sysinterval_t timeout, size_t *wp)
+{
+    systime_t start = osalOsGetSystemTimeX();
+    msg_t result = Q_OK;
+    size_t w = 0;
+
+    while (true)
+    {
+        if (sdsp->state != SDSOCKET_READY)
+        {
+            result = Q_RESET;
+            break;
+        }
+
+        /* Sends directly while nothing is queued ahead. */
+        if (chSymQIsEmptyI(&sdsp->oqueue) == TRUE)
+        {
+            ssize_t ret = send(sdsp->fd, bp + w, n - w, MSG_NOSIGNAL);
+            if (ret > 0)
+                w += (size_t)ret;
+            else if (ret < 0 && (errno == EPIPE || errno == ECONNRESET))
+                sdsocket_closed_i(sdsp);
+        }
+
+        w += chSymQWriteI(&sdsp->oqueue, bp + w, n - w);
+        sdsocket_transmit_i(sdsp);
+        if (w == n)
+            break;
+
+        /* Waits for the signal handler to free space. */
+        sysinterval_t this_timeout = sdsocket_remaining(start, timeout);
+        if (this_timeout == TIME_IMMEDIATE)
+        {
+            result = Q_TIMEOUT;
+            break;
+        }
+        result = chSymQPutTimeoutS(&sdsp->oqueue, bp[w], this_timeout);
+        if (result != Q_OK)
+            break;
+        w++;
+    }
+
+    *wp = w;
+    return result;
+}
+
+/**
+ * @brief   Reads data from the far end.
+ *
+ * @param[in] sdsp      pointer to a @p SerialSocketDriver object
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the amount of data to be transferred
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @param[out] rp       number of bytes transferred
+ * @return              The operation status.
+ *
+ * @sclass
+ */
+static msg_t sdsocket_readS(SerialSocketDriver *sdsp, uint8_t *bp,
+        size_t n, sysinterval_t timeout, size_t *rp)
+{
+    systime_t start = osalOsGetSystemTimeX();
+    msg_t result = Q_OK;
+    size_t r = 0;
+
+    while (r < n)
+    {
+        sdsocket_receive_i(sdsp);
+
+        size_t q = chSymQGetFullI(&sdsp->iqueue);
+        if (q > 0)
+        {
+            if (q > n - r)
+                q = n - r;
+            r += chSymQReadTimeoutS(&sdsp->iqueue, bp + r, q, TIME_IMMEDIATE);
+            continue;
+        }
+
+        if (sdsp->state != SDSOCKET_READY)
+        {
+            result = Q_RESET;
+            break;
+        }
+
+        /* Waits for the signal handler to receive data. */
+        sysinterval_t this_timeout = sdsocket_remaining(start, timeout);
+        if (this_timeout == TIME_IMMEDIATE)
+        {
+            result = Q_TIMEOUT;
+            break;
+        }
+        msg_t b = chSymQGetTimeoutS(&sdsp->iqueue, this_timeout);
+        if (b < Q_OK)
+        {
+            result = b;
+            break;
+        }
+        bp[r++] = (uint8_t)b;
+    }
+
+    *rp = r;
+    return result;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Socket I/O vector.
+ * @details Serves all started drivers.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(sdsocket_handler)
+{
+    OSAL_IRQ_PROLOGUE();
+
+    osalSysLockFromISR();
+    for (SerialSocketDriver *sdsp = sdsocket_list; sdsp != NULL;
+            sdsp = sdsp->next)
+    {
+        sdsocket_receive_i(sdsp);
+        sdsocket_transmit_i(sdsp);
+    }
+    osalSysUnlockFromISR();
+
+    OSAL_IRQ_EPILOGUE();
+}
+
+static void sdsocket_signal_handler(int arg)
+{
+    (void)arg;
+
+    if (sdsocket_handler() == true)
+    {
+#if CH_DBG_SYSTEM_STATE_CHECK
+        _dbg_check_lock();
+#endif
+        chSchDoReschedule();
+#if CH_DBG_SYSTEM_STATE_CHECK
+        _dbg_check_unlock();
+#endif
+    }
+}
+
+/*
+ * Interface implementation, the following functions just invoke the driver
+ * transfer functions.
+ */
+
+static size_t _write(void *ip, const uint8_t *bp, size_t n)
+{
+    size_t w;
+
+    osalSysLock();
+    (void)sdsocket_writeS((SerialSocketDriver*)ip, bp, n, TIME_INFINITE, &w);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return w;
+}
+
+static size_t _read(void *ip, uint8_t *bp, size_t n)
+{
+    size_t r;
+
+    osalSysLock();
+    (void)sdsocket_readS((SerialSocketDriver*)ip, bp, n, TIME_INFINITE, &r);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return r;
+}
+
+static msg_t _put(void *ip, uint8_t b)
+{
+    size_t w;
+
+    osalSysLock();
+    msg_t result = sdsocket_writeS((SerialSocketDriver*)ip, &b, 1,
+            TIME_INFINITE, &w);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return result;
+}
+
+static msg_t _get(void *ip)
+{
+    uint8_t b;
+    size_t r;
+
+    osalSysLock();
+    msg_t result = sdsocket_readS((SerialSocketDriver*)ip, &b, 1,
+            TIME_INFINITE, &r);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return (r == 1) ? (msg_t)b : result;
+}
+
+static msg_t _putt(void *ip, uint8_t b, sysinterval_t timeout)
+{
+    size_t w;
+
+    osalSysLock();
+    msg_t result = sdsocket_writeS((SerialSocketDriver*)ip, &b, 1,
+            timeout, &w);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return result;
+}
+
+static msg_t _gett(void *ip, sysinterval_t timeout)
+{
+    uint8_t b;
+    size_t r;
+
+    osalSysLock();
+    msg_t result = sdsocket_readS((SerialSocketDriver*)ip, &b, 1,
+            timeout, &r);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return (r == 1) ? (msg_t)b : result;
+}
+
+static size_t _writet(void *ip, const uint8_t *bp, size_t n,
+        sysinterval_t timeout)
+{
+    size_t w;
+
+    osalSysLock();
+    (void)sdsocket_writeS((SerialSocketDriver*)ip, bp, n, timeout, &w);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return w;
+}
+
+static size_t _readt(void *ip, uint8_t *bp, size_t n, sysinterval_t timeout)
+{
+    size_t r;
+
+    osalSysLock();
+    (void)sdsocket_readS((SerialSocketDriver*)ip, bp, n, timeout, &r);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return r;
+}
+
+static const struct SerialSocketDriverVMT vmt =
+{
+    (size_t)0,
+    _write, _read, _put, _get,
+    _putt, _gett, _writet, _readt
+};
+
+/**
+ * @brief   Opens the connection to the peer.
+ *
+ * @return              The connected socket or -1.
+ */
+static int sdsocket_connect(const SerialSocketConfig *configp)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    int fd;
+
+    strncpy(addr.sun_path, configp->path, sizeof(addr.sun_path) - 1);
+
+    if (configp->listen)
+    {
+        int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (lfd < 0)
+            return -1;
+
+        (void)unlink(configp->path);
+        if (bind(lfd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+                listen(lfd, 1) < 0)
+        {
+            close(lfd);
+            return -1;
+        }
+
+        /* The tick signal interrupts the wait. */
+        do
+            fd = accept(lfd, NULL, NULL);
+        while (fd < 0 && errno == EINTR);
+
+        close(lfd);
+        (void)unlink(configp->path);
+
+        return fd;
+    }
+
+    while (true)
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0)
+            return fd;
+
+        int error = errno;
+        close(fd);
+
+        /* Retries until the peer listens. */
+        if (error != ENOENT && error != ECONNREFUSED && error != EINTR)
+            return -1;
+        chThdSleep(SERIAL_SOCKET_CONNECT_INTERVAL);
+    }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a generic full duplex driver object.
+ *
+ * @param[out] sdsocketp    pointer to a @p SerialSocketDriver structure
+ *
+ * @init
+ */
+void sdsocketObjectInit(SerialSocketDriver *sdsocketp)
+{
+    sdsocketp->vmt = &vmt;
+    osalEventObjectInit(&sdsocketp->event);
+    sdsocketp->state = SDSOCKET_STOP;
+    sdsocketp->fd = -1;
+    chSymQObjectInit(&sdsocketp->iqueue, sdsocketp->ib,
+            sizeof(sdsocketp->ib));
+    chSymQObjectInit(&sdsocketp->oqueue, sdsocketp->ob,
+            sizeof(sdsocketp->ob));
+    sdsocketp->next = NULL;
+}
+
+/**
+ * @brief   Connects and starts the driver.
+ * @details A listening driver waits until its peer connects, otherwise the
+ *          connection is retried until the peer listens.
+ *
+ * @param[in] sdsocketp     pointer to a @p SerialSocketDriver object
+ * @param[in] configp       pointer to the @p SerialSocketConfig object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the socket could not be connected.
+ *
+ * @api
+ */
+bool sdsocketStart(SerialSocketDriver *sdsocketp,
+        const SerialSocketConfig *configp)
+{
+    osalDbgCheck(sdsocketp != NULL && configp != NULL &&
+            configp->path != NULL);
+    osalDbgAssert(sdsocketp->state == SDSOCKET_STOP, "invalid state");
+
+    if (sdsocket_signal_ready == false)
+    {
+        struct sigaction sigsocket = {
+            .sa_flags = 0,
+            .sa_handler = sdsocket_signal_handler,
+        };
+
+        /* The timer signal stays masked like in the tick handler. */
+        if (sigemptyset(&sigsocket.sa_mask) < 0 ||
+                sigaddset(&sigsocket.sa_mask, SERIAL_SOCKET_SIGNAL) < 0 ||
+                sigaddset(&sigsocket.sa_mask, PORT_TIMER_SIGNAL) < 0 ||
+                sigaction(SERIAL_SOCKET_SIGNAL, &sigsocket, NULL) < 0)
+            chSysHalt("sigaction() failed");
+
+        sdsocket_signal_ready = true;
+    }
+
+    int fd = sdsocket_connect(configp);
+    if (fd < 0)
+        return HAL_FAILED;
+
+    if (fcntl(fd, F_SETOWN, getpid()) < 0 ||
+            fcntl(fd, F_SETSIG, SERIAL_SOCKET_SIGNAL) < 0 ||
+            fcntl(fd, F_SETFL, O_NONBLOCK | O_ASYNC) < 0)
+    {
+        close(fd);
+        return HAL_FAILED;
+    }
+
+    osalSysLock();
+    sdsocketp->configp = configp;
+    sdsocketp->fd = fd;
+    sdsocketp->state = SDSOCKET_READY;
+    sdsocketp->next = sdsocket_list;
+    sdsocket_list = sdsocketp;
+    chnAddFlagsI(sdsocketp, CHN_CONNECTED);
+    /* Data may have arrived before the signal was set up. */
+    sdsocket_receive_i(sdsocketp);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Stops the driver and closes the socket.
+ * @details Any thread waiting on the driver's queues will be awakened with
+ *          the message @p Q_RESET.
+ *
+ * @param[in] sdsocketp     pointer to a @p SerialSocketDriver object
+ *
+ * @api
+ */
+void sdsocketStop(SerialSocketDriver *sdsocketp)
+{
+    osalDbgCheck(sdsocketp != NULL);
+
+    osalSysLock();
+
+    if (sdsocketp->state != SDSOCKET_STOP)
+    {
+        for (SerialSocketDriver **pp = &sdsocket_list; *pp != NULL;
+                pp = &(*pp)->next)
+        {
+            if (*pp == sdsocketp)
+            {
+                *pp = sdsocketp->next;
+                break;
+            }
+        }
+
+        close(sdsocketp->fd);
+        sdsocketp->fd = -1;
+        sdsocketp->state = SDSOCKET_STOP;
+        chSymQResetI(&sdsocketp->iqueue);
+        chSymQResetI(&sdsocketp->oqueue);
+        chnAddFlagsI(sdsocketp, CHN_DISCONNECTED);
+    }
+
+    osalOsRescheduleS();
+    osalSysUnlock();
+}
+
+/** @} */
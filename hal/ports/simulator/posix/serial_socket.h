@@ -0,0 +1,180 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    serial_socket.h
+ * @brief   Simulator serial driver over UNIX domain sockets header.
+ *
+ * @addtogroup SERIAL_SOCKET
+ * @{
+ */
+
+#ifndef _SERIAL_SOCKET_H_
+#define _SERIAL_SOCKET_H_
+
+#include "qsymqueue.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Socket serial configuration options
+ * @{
+ */
+
+/**
+ * @brief   Size of the receive and of the transmit buffer.
+ */
+#if !defined(SERIAL_SOCKET_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define SERIAL_SOCKET_BUFFER_SIZE       1024
+#endif
+
+/**
+ * @brief   Signal raised when a socket is ready for I/O.
+ * @details A real-time signal, so that it does not interfere with the
+ *          console input signal.
+ */
+#if !defined(SERIAL_SOCKET_SIGNAL) || defined(__DOXYGEN__)
+#define SERIAL_SOCKET_SIGNAL            (SIGRTMIN + 1)
+#endif
+
+/**
+ * @brief   Interval between connection attempts to a listening peer.
+ */
+#if !defined(SERIAL_SOCKET_CONNECT_INTERVAL) || defined(__DOXYGEN__)
+#define SERIAL_SOCKET_CONNECT_INTERVAL  TIME_MS2I(10)
+#endif
+
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_EVENTS
+#error "Socket serial driver requires CH_CFG_USE_EVENTS"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief Driver state machine possible states.
+ */
+typedef enum
+{
+    SDSOCKET_UNINIT = 0,                /**< Not initialized.                */
+    SDSOCKET_STOP = 1,                  /**< Stopped.                        */
+    SDSOCKET_READY = 2,                 /**< Connected.                      */
+    SDSOCKET_CLOSED = 3                 /**< Peer disconnected.              */
+} sdsocketstate_t;
+
+/**
+ * @brief   Structure representing a socket serial driver.
+ */
+typedef struct SerialSocketDriver SerialSocketDriver;
+
+/**
+ * @brief   Socket serial driver configuration structure.
+ * @details An instance of this structure must be passed to @p sdsocketStart()
+ *          in order to configure and start the driver operations.
+ */
+typedef struct
+{
+    /* Path of the UNIX domain socket. */
+    const char *path;
+    /* Creates the socket and waits for the peer instead of connecting. */
+    bool listen;
+} SerialSocketConfig;
+
+/**
+ * @brief   @p SerialSocketDriver specific data.
+ */
+#define _serial_socket_driver_data                                            \
+    _base_asynchronous_channel_data                                           \
+    /* Driver state. */                                                       \
+    sdsocketstate_t state;                                                    \
+    /* Connected socket or -1. */                                             \
+    int fd;                                                                   \
+    /* Received data queue.*/                                                 \
+    symmetric_queue_t iqueue;                                                 \
+    /* Input buffer.*/                                                        \
+    uint8_t ib[SERIAL_SOCKET_BUFFER_SIZE];                                    \
+    /* Data queue the socket did not accept yet.*/                            \
+    symmetric_queue_t oqueue;                                                 \
+    /* Output buffer.*/                                                       \
+    uint8_t ob[SERIAL_SOCKET_BUFFER_SIZE];                                    \
+    /* Next started driver served by the signal handler.*/                    \
+    SerialSocketDriver *next;
+
+/**
+ * @brief   @p SerialSocketDriver specific methods.
+ */
+#define _serial_socket_driver_methods                                         \
+    _base_asynchronous_channel_methods
+
+/**
+ * @extends BaseAsynchronousChannelVMT
+ *
+ * @brief   @p SerialSocketDriver virtual methods table.
+ */
+struct SerialSocketDriverVMT
+{
+    _serial_socket_driver_methods
+};
+
+/**
+ * @extends BaseAsynchronousChannel
+ *
+ * @brief   Serial driver connecting simulator processes.
+ * @details The far end is a @p SerialSocketDriver of another simulator
+ *          instance, reached over a UNIX domain stream socket. Transfers
+ *          bypass the queues while the socket keeps up.
+ */
+struct SerialSocketDriver
+{
+    /** @brief Virtual Methods Table.*/
+    const struct SerialSocketDriverVMT *vmt;
+    _serial_socket_driver_data
+    const SerialSocketConfig *configp;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void sdsocketObjectInit(SerialSocketDriver *sdsocketp);
+    bool sdsocketStart(SerialSocketDriver *sdsocketp,
+            const SerialSocketConfig *configp);
+    void sdsocketStop(SerialSocketDriver *sdsocketp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SERIAL_SOCKET_H_ */
+
+/** @} */
@@ -53,12 +53,19 @@ void qhalInit(void)
 {
     qhal_lld_init();
 
+#if QHAL_USE_PERF || defined(__DOXYGEN__)
+    qhalPerfInit();
+#endif
+
 #if HAL_USE_SERIAL_485 || defined(__DOXYGEN__)
     s485dInit();
 #endif
 #if HAL_USE_FLASH_JEDEC_SPI || defined(__DOXYGEN__)
     fjsInit();
 #endif
+#if HAL_USE_FLASH_JEDEC_QSPI || defined(__DOXYGEN__)
+    fjqInit();
+#endif
 #if HAL_USE_NVM_PARTITION || defined(__DOXYGEN__)
     nvmpartInit();
 #endif
@@ -77,18 +84,60 @@ void qhalInit(void)
 #if HAL_USE_NVM_IOBLOCK || defined(__DOXYGEN__)
     nvmioblockInit();
 #endif
+#if HAL_USE_NVM_FTL || defined(__DOXYGEN__)
+    nvmftlInit();
+#endif
+#if HAL_USE_NVM_ASYNC || defined(__DOXYGEN__)
+    nvmasyncInit();
+#endif
+#if HAL_USE_NVM_SCHED || defined(__DOXYGEN__)
+    nvmschedInit();
+#endif
+#if HAL_USE_NVM_STRIPE || defined(__DOXYGEN__)
+    nvmstripeInit();
+#endif
+#if HAL_USE_NVM_CACHE || defined(__DOXYGEN__)
+    nvmcacheInit();
+#endif
+#if HAL_USE_NVM_WRITE_BUFFER || defined(__DOXYGEN__)
+    nvmwbufInit();
+#endif
+#if HAL_USE_NVM_READ_AHEAD || defined(__DOXYGEN__)
+    nvmraheadInit();
+#endif
+#if HAL_USE_NVM_COMPRESS || defined(__DOXYGEN__)
+    nvmcompressInit();
+#endif
+#if HAL_USE_NVM_WEAR || defined(__DOXYGEN__)
+    nvmwearInit();
+#endif
+#if HAL_USE_NVM_DEDUP || defined(__DOXYGEN__)
+    nvmdedupInit();
+#endif
+#if HAL_USE_NVM_TRACE || defined(__DOXYGEN__)
+    nvmtraceInit();
+#endif
+#if HAL_USE_NVM_NOR_SIM || defined(__DOXYGEN__)
+    nvmnorsimInit();
+#endif
 #if HAL_USE_FLASH || defined(__DOXYGEN__)
     flashInit();
 #endif
 #if HAL_USE_LED || defined(__DOXYGEN__)
     ledInit();
 #endif
+#if HAL_USE_LED_GROUP || defined(__DOXYGEN__)
+    ledgroupInit();
+#endif
 #if HAL_USE_GD_SIM || defined(__DOXYGEN__)
     gdsimInit();
 #endif
 #if HAL_USE_GD_ILI9341 || defined(__DOXYGEN__)
     gdili9341Init();
 #endif
+#if HAL_USE_GD_FRAMEBUFFER || defined(__DOXYGEN__)
+    gdfbInit();
+#endif
 #if HAL_USE_MS5541 || defined(__DOXYGEN__)
     ms5541Init();
 #endif
@@ -104,6 +153,9 @@ void qhalInit(void)
 #if HAL_USE_BQ275XX || defined(__DOXYGEN__)
     bq275xxInit();
 #endif
+#if HAL_USE_I2C_SCHED || defined(__DOXYGEN__)
+    i2cschedInit();
+#endif
 }
 
 /** @} */
@@ -13,6 +13,7 @@
 
 #include "nelems.h"
 
+#include <stddef.h>
 #include <string.h>
 
 /*===========================================================================*/
@@ -75,6 +76,48 @@ enum cntl_subcommand_e
     CNTL_RESET = 0x0041,
 };
 
+/**
+ * @brief   Register and scaling of the battery data fields, in field order.
+ */
+static const struct
+{
+    uint8_t reg;
+    uint8_t offset;
+    float divisor;
+    float bias;
+} FIELDS[BQ275XX_FIELDS] =
+{
+    { REG_TEMP, offsetof(bq275xx_bat_data_s, temperature), 10.0f, -273.15f },
+    { REG_VOLT, offsetof(bq275xx_bat_data_s, voltage), 1000.0f, 0.0f },
+    { REG_NAC, offsetof(bq275xx_bat_data_s, nom_available_capacity),
+            1000.0f, 0.0f },
+    { REG_FAC, offsetof(bq275xx_bat_data_s, full_available_capacity),
+            1000.0f, 0.0f },
+    { REG_RM, offsetof(bq275xx_bat_data_s, remaining_capacity),
+            1000.0f, 0.0f },
+    { REG_FCC, offsetof(bq275xx_bat_data_s, full_charge_capacity),
+            1000.0f, 0.0f },
+    { REG_AI, offsetof(bq275xx_bat_data_s, effective_current),
+            1000.0f, 0.0f },
+    { REG_SOC, offsetof(bq275xx_bat_data_s, state_of_charge),
+            100.0f, 0.0f },
+    { REG_INTTEMP, offsetof(bq275xx_bat_data_s, internal_temperature),
+            10.0f, -273.15f },
+    { REG_UFRM, offsetof(bq275xx_bat_data_s, rem_capacity_unfiltered),
+            1000.0f, 0.0f },
+    { REG_FRM, offsetof(bq275xx_bat_data_s, rem_capacity_filtered),
+            1000.0f, 0.0f },
+    { REG_UFFCC, offsetof(bq275xx_bat_data_s,
+            full_charge_capacity_unfiltered), 1000.0f, 0.0f },
+    { REG_FFCC, offsetof(bq275xx_bat_data_s, full_charge_capacity_filtered),
+            1000.0f, 0.0f },
+    { REG_UFSOC, offsetof(bq275xx_bat_data_s, state_of_charge_unfiltered),
+            100.0f, 0.0f },
+    { REG_TTE, offsetof(bq275xx_bat_data_s, time_to_empty), 60.0f, 0.0f },
+    { REG_STTE, offsetof(bq275xx_bat_data_s, standby_time_to_empty),
+            60.0f, 0.0f },
+};
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -87,11 +130,13 @@ enum cntl_subcommand_e
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
-static bool register_read(BQ275XXDriver* bq275xxp, enum reg_addr_e reg,
-        uint16_t *valuep)
+/**
+ * @brief   Reads consecutive registers in one auto incrementing transfer.
+ */
+static bool registers_read(BQ275XXDriver* bq275xxp, enum reg_addr_e reg,
+        uint8_t* rxbuf, size_t n)
 {
     const uint8_t txbuf[] = { reg };
-    uint8_t rxbuf[] = { 0x00, 0x00, };
 
     msg_t result;
     result = i2cMasterTransmitTimeout(bq275xxp->configp->i2cp,
@@ -99,7 +144,7 @@ static bool register_read(BQ275XXDriver* bq275xxp, enum reg_addr_e reg,
             txbuf,
             sizeof(txbuf),
             rxbuf,
-            sizeof(rxbuf),
+            n,
             bq275xxp->configp->i2c_timeout);
 
 #if BQ275XX_NICE_WAITING
@@ -108,13 +153,30 @@ static bool register_read(BQ275XXDriver* bq275xxp, enum reg_addr_e reg,
     osalSysPolledDelayX(OSAL_US2RTC(STM32_HCLK, 66));
 #endif /* BQ275XX_NICE_WAITING */
 
-    if (result == MSG_OK)
-    {
-        *valuep = ((uint16_t)rxbuf[1] << 8) | ((uint16_t)rxbuf[0] << 0);
-        return true;
-    }
-    else
+    return result == MSG_OK;
+}
+
+/**
+ * @brief   Decodes a register from a buffer read starting at @p base.
+ */
+static int16_t register_decode(const uint8_t* rxbuf, enum reg_addr_e base,
+        enum reg_addr_e reg)
+{
+    const uint8_t* p = rxbuf + (reg - base);
+
+    return (int16_t)(((uint16_t)p[1] << 8) | ((uint16_t)p[0] << 0));
+}
+
+static bool register_read(BQ275XXDriver* bq275xxp, enum reg_addr_e reg,
+        uint16_t *valuep)
+{
+    uint8_t rxbuf[] = { 0x00, 0x00, };
+
+    if (registers_read(bq275xxp, reg, rxbuf, sizeof(rxbuf)) != true)
         return false;
+
+    *valuep = register_decode(rxbuf, reg, reg);
+    return true;
 }
 
 static bool register_write(BQ275XXDriver* bq275xxp, enum reg_addr_e reg,
@@ -167,6 +229,67 @@ static bool register_write(BQ275XXDriver* bq275xxp, enum reg_addr_e reg,
     return true;
 }
 
+/**
+ * @brief   Reads stale fields into the cache.
+ * @details The standard commands up to INTTEMP and the extended commands
+ *          from UFRM are read in one burst each, covering just the span of
+ *          the stale fields. All fields transferred are cached.
+ */
+static bool cache_refresh(BQ275XXDriver* bq275xxp, uint32_t stale)
+{
+    uint8_t rxbuf[REG_INTTEMP + 2 - REG_TEMP];
+
+    /* Check if device finished initialization. */
+    uint16_t status;
+    if (register_write(bq275xxp, REG_CNTL, CNTL_STATUS) != true)
+        return false;
+    if (register_read(bq275xxp, REG_CNTL, &status) == false)
+        return false;
+    if ((status & 0x0080) == 0x0000)
+        return false;
+
+    for (uint8_t extended = 0; extended < 2; ++extended)
+    {
+        uint8_t first = 0xff;
+        uint8_t last = 0x00;
+
+        for (uint8_t i = 0; i < BQ275XX_FIELDS; ++i)
+        {
+            if ((stale & (1u << i)) == 0 ||
+                    (FIELDS[i].reg >= REG_UFRM) != extended)
+                continue;
+            if (FIELDS[i].reg < first)
+                first = FIELDS[i].reg;
+            if (FIELDS[i].reg > last)
+                last = FIELDS[i].reg;
+        }
+
+        if (first > last)
+            continue;
+
+        if (registers_read(bq275xxp, first, rxbuf, last + 2 - first) != true)
+            return false;
+
+        systime_t now = osalOsGetSystemTimeX();
+
+        for (uint8_t i = 0; i < BQ275XX_FIELDS; ++i)
+        {
+            if (FIELDS[i].reg < first || FIELDS[i].reg > last)
+                continue;
+
+            float* valuep = (float*)((uint8_t*)&bq275xxp->cache +
+                    FIELDS[i].offset);
+            *valuep = register_decode(rxbuf, first, FIELDS[i].reg) /
+                    FIELDS[i].divisor + FIELDS[i].bias;
+
+            bq275xxp->cache_time[i] = now;
+            bq275xxp->cache_valid |= 1u << i;
+        }
+    }
+
+    return true;
+}
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -193,6 +316,7 @@ void bq275xxObjectInit(BQ275XXDriver* bq275xxp)
 {
     bq275xxp->state = BQ275XX_STOP;
     bq275xxp->configp = NULL;
+    bq275xxp->cache_valid = 0;
 #if BQ275XX_USE_MUTUAL_EXCLUSION
 #if CH_USE_MUTEXES
     chMtxInit(&bq275xxp->mutex);
@@ -218,6 +342,7 @@ void bq275xxStart(BQ275XXDriver* bq275xxp, const BQ275XXConfig* configp)
             "invalid state");
 
     bq275xxp->configp = configp;
+    bq275xxp->cache_valid = 0;
 
     /* Verify device identification. */
     {
@@ -354,94 +479,63 @@ void bq275xxReleaseBus(BQ275XXDriver* bq275xxp)
  */
 bool bq275xxReadData(BQ275XXDriver* bq275xxp, bq275xx_bat_data_s* datap)
 {
-    osalDbgCheck(bq275xxp != NULL);
+    return bq275xxReadFields(bq275xxp, datap, BQ275XX_FIELD_ALL);
+}
+
+/**
+ * @brief   Reads selected battery data from gauge.
+ * @details Fields read less than @p max_age of the configuration ago are
+ *          returned from the cache without bus traffic. Fields not selected
+ *          are left untouched in @p datap.
+ *
+ * @param[in] bq275xxp  pointer to the @p BQ275XXDriver object
+ * @param[out] datap    pointer to @p bq275xx_bat_data_s structure
+ * @param[in] fields    mask of @p BQ275XX_FIELD_* values to read
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool bq275xxReadFields(BQ275XXDriver* bq275xxp, bq275xx_bat_data_s* datap,
+        uint32_t fields)
+{
+    osalDbgCheck((bq275xxp != NULL) && (datap != NULL));
     /* Verify device status. */
     osalDbgAssert(bq275xxp->state == BQ275XX_READY,
             "invalid state");
 
     bq275xxp->state = BQ275XX_ACTIVE;
 
-    /* Check if device finished initialization. */
-    uint16_t status;
-    if (register_write(bq275xxp, REG_CNTL, CNTL_STATUS) != true)
-        goto out_failed;
-    if (register_read(bq275xxp, REG_CNTL, &status) == false)
-        goto out_failed;
-    if ((status & 0x0080) == 0x0000)
-        goto out_failed;
-
-    int16_t temp;
-
-    if (register_read(bq275xxp, REG_TEMP, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->temperature = temp / 10 - 273.15f;
-
-    if (register_read(bq275xxp, REG_VOLT, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->voltage = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_NAC, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->nom_available_capacity = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_FAC, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->full_available_capacity = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_RM, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->remaining_capacity = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_FCC, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->full_charge_capacity = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_AI, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->effective_current = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_SOC, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->state_of_charge = temp / 100.0f;
-
-    if (register_read(bq275xxp, REG_INTTEMP, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->internal_temperature = temp / 10 - 273.15f;
-
-    if (register_read(bq275xxp, REG_UFRM, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->rem_capacity_unfiltered = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_FRM, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->rem_capacity_filtered = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_UFFCC, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->full_charge_capacity_unfiltered = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_FFCC, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->full_charge_capacity_filtered = temp / 1000.0f;
-
-    if (register_read(bq275xxp, REG_UFSOC, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->state_of_charge_unfiltered = temp / 100.0f;
+    uint32_t stale = 0;
+    for (uint8_t i = 0; i < BQ275XX_FIELDS; ++i)
+    {
+        if ((fields & (1u << i)) == 0)
+            continue;
+        if ((bq275xxp->cache_valid & (1u << i)) == 0 ||
+                chVTTimeElapsedSinceX(bq275xxp->cache_time[i]) >=
+                bq275xxp->configp->max_age)
+            stale |= 1u << i;
+    }
 
-    if (register_read(bq275xxp, REG_TTE, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->time_to_empty = temp / 60.0f;
+    if (stale != 0 && cache_refresh(bq275xxp, stale) != true)
+    {
+        bq275xxp->state = BQ275XX_READY;
+        return HAL_FAILED;
+    }
 
-    if (register_read(bq275xxp, REG_STTE, (uint16_t*)&temp) != true)
-        goto out_failed;
-    datap->standby_time_to_empty = temp / 60.0f;
+    for (uint8_t i = 0; i < BQ275XX_FIELDS; ++i)
+    {
+        if ((fields & (1u << i)) == 0)
+            continue;
+        memcpy((uint8_t*)datap + FIELDS[i].offset,
+                (const uint8_t*)&bq275xxp->cache + FIELDS[i].offset,
+                sizeof(float));
+    }
 
     bq275xxp->state = BQ275XX_READY;
     return HAL_SUCCESS;
-
-out_failed:
-    bq275xxp->state = BQ275XX_READY;
-    return HAL_FAILED;
 }
 
 /**
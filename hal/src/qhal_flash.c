@@ -34,6 +34,16 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+#if FLASH_USE_REQUEST
+/**
+ * @brief   Verifies that no request is in progress.
+ */
+#define flash_check_no_request(flashp)                                        \
+    chDbgAssert((flashp)->request == NULL, "request in progress")
+#else
+#define flash_check_no_request(flashp)
+#endif /* FLASH_USE_REQUEST */
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -42,6 +52,10 @@
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+/* Time of program and erase calls, including waits for the flash. */
+QHAL_PERF_REGION(flash_write)
+QHAL_PERF_REGION(flash_erase)
+
 /**
  * @brief   Virtual methods table.
  */
@@ -60,12 +74,89 @@ static const struct FLASHDriverVMT flash_vmt =
     .mass_writeprotect = (bool (*)(void*))flashMassWriteProtect,
     .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))flashWriteUnprotect,
     .mass_writeunprotect = (bool (*)(void*))flashMassWriteUnprotect,
+    .is_erased = (bool (*)(void*, uint32_t, uint32_t, bool*))flashIsErased,
+    .map = (bool (*)(void*, uint32_t, uint32_t, const uint8_t**))flashMap,
+#if FLASH_USE_RW_LOCK
+    .acquire_shared = (void (*)(void*))flashAcquireBusShared,
+    .release_shared = (void (*)(void*))flashReleaseBusShared,
+#endif /* FLASH_USE_RW_LOCK */
+#if FLASH_USE_REQUEST
+    .start_request = (bool (*)(void*, NVMRequest*))flashStartRequest,
+#endif /* FLASH_USE_REQUEST */
 };
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Waits for an operation in a bank not used for execution.
+ * @details The calling thread sleeps, the code keeps running meanwhile.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ *
+ * @sclass
+ */
+static void flash_sync_other_bank(FLASHDriver* flashp)
+{
+    while (flash_lld_is_busy(flashp))
+        osalThreadSleepS(1);
+}
+
+#if FLASH_USE_REQUEST || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the next operation of the request in progress.
+ * @details Programs the next unit of a write or erases the next sector.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation has been started.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @iclass
+ */
+static bool flash_request_next(FLASHDriver* flashp)
+{
+    NVMRequest* reqp = flashp->request;
+    uint32_t addr = reqp->startaddr + flashp->request_offset;
+
+    if (reqp->op == NVM_REQUEST_WRITE)
+    {
+        flashp->request_offset += flash_lld_write_unit(flashp, addr,
+                reqp->n - flashp->request_offset,
+                reqp->buffer.write + flashp->request_offset);
+        return HAL_SUCCESS;
+    }
+
+    FLASHSectorInfo sector;
+    if (flash_lld_addr_to_sector(addr, &sector) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    flash_lld_erase_sector(flashp, sector.origin);
+    flashp->request_offset = sector.origin + sector.size - reqp->startaddr;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Completes the request in progress.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] result    operation result
+ *
+ * @iclass
+ */
+static void flash_request_complete(FLASHDriver* flashp, bool result)
+{
+    NVMRequest* reqp = flashp->request;
+
+    flashp->request = NULL;
+    flashp->state = NVM_READY;
+    nvmRequestCompleteI(reqp, result);
+}
+#endif /* FLASH_USE_REQUEST */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -95,8 +186,16 @@ void flashObjectInit(FLASHDriver* flashp)
     flashp->state = NVM_STOP;
     flashp->config = NULL;
 #if FLASH_USE_MUTUAL_EXCLUSION
+#if FLASH_USE_RW_LOCK
+    chRWLockObjectInit(&flashp->lock);
+#else
     chMtxObjectInit(&flashp->mutex);
+#endif /* FLASH_USE_RW_LOCK */
 #endif /* FLASH_USE_MUTUAL_EXCLUSION */
+#if FLASH_USE_REQUEST
+    flashp->request = NULL;
+    flashp->request_offset = 0;
+#endif /* FLASH_USE_REQUEST */
 }
 
 /**
@@ -164,6 +263,7 @@ bool flashRead(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
     chDbgCheck(flashp != NULL);
     /* Verify device status. */
     chDbgAssert(flashp->state >= NVM_READY, "invalid state");
+    flash_check_no_request(flashp);
     /* Verify range is within chip size. */
     chDbgAssert(
             flash_lld_addr_to_sector(startaddr, NULL) == HAL_SUCCESS
@@ -186,6 +286,9 @@ bool flashRead(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
 
 /**
  * @brief   Writes data crossing sector boundaries if required.
+ * @details Data in a bank not used for execution is written in chunks of
+ *          @p FLASH_OTHER_BANK_CHUNK_SIZE bytes, other threads run between
+ *          them.
  *
  * @param[in] flashp    pointer to the @p FLASHDriver object
  * @param[in] startaddr address to start writing to
@@ -204,6 +307,7 @@ bool flashWrite(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
     chDbgCheck(flashp != NULL);
     /* Verify device status. */
     chDbgAssert(flashp->state >= NVM_READY, "invalid state");
+    flash_check_no_request(flashp);
     /* Verify range is within chip size. */
     chDbgAssert(
             flash_lld_addr_to_sector(startaddr, NULL) == HAL_SUCCESS
@@ -212,17 +316,43 @@ bool flashWrite(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
 
     /* Write operation in progress. */
     flashp->state = NVM_WRITING;
+    QHAL_PERF_BEGIN(flash_write);
+
+    if (n != 0 && flash_lld_is_other_bank(flashp, startaddr, n))
+    {
+        uint32_t offset = 0;
+        while (offset < n)
+        {
+            uint32_t chunk = FLASH_OTHER_BANK_CHUNK_SIZE -
+                    (startaddr + offset) % FLASH_OTHER_BANK_CHUNK_SIZE;
+            if (chunk > n - offset)
+                chunk = n - offset;
+
+            chSysLock();
+            flash_sync_other_bank(flashp);
+            flash_lld_write(flashp, startaddr + offset, chunk, buffer + offset);
+            chSysUnlock();
+
+            offset += chunk;
+        }
+        QHAL_PERF_END(flash_write);
+        return HAL_SUCCESS;
+    }
 
     chSysLock();
     flash_lld_sync(flashp);
     flash_lld_write(flashp, startaddr, n, buffer);
     chSysUnlock();
 
+    QHAL_PERF_END(flash_write);
     return HAL_SUCCESS;
 }
 
 /**
  * @brief   Erases one or more sectors.
+ * @details Sectors in a bank not used for execution are waited for by
+ *          sleeping, other threads run meanwhile. With
+ *          @p FLASH_ERASE_SKIP_BLANK blank sectors are not erased again.
  *
  * @param[in] flashp    pointer to the @p FLASHDriver object
  * @param[in] startaddr address within to be erased sector
@@ -239,6 +369,7 @@ bool flashErase(FLASHDriver* flashp, uint32_t startaddr, uint32_t n)
     chDbgCheck(flashp != NULL);
     /* Verify device status. */
     chDbgAssert(flashp->state >= NVM_READY, "invalid state");
+    flash_check_no_request(flashp);
     /* Verify range is within chip size. */
     chDbgAssert(
             flash_lld_addr_to_sector(startaddr, NULL) == HAL_SUCCESS
@@ -247,7 +378,9 @@ bool flashErase(FLASHDriver* flashp, uint32_t startaddr, uint32_t n)
 
     /* Erase operation in progress. */
     flashp->state = NVM_ERASING;
+    QHAL_PERF_BEGIN(flash_erase);
 
+    bool other_bank = n != 0 && flash_lld_is_other_bank(flashp, startaddr, n);
     FLASHSectorInfo sector;
 
     for (sector.origin = startaddr;
@@ -255,14 +388,35 @@ bool flashErase(FLASHDriver* flashp, uint32_t startaddr, uint32_t n)
             sector.origin += sector.size)
     {
         if (flash_lld_addr_to_sector(sector.origin, &sector) != HAL_SUCCESS)
+        {
+            QHAL_PERF_END(flash_erase);
             return HAL_FAILED;
+        }
 
         chSysLock();
-        flash_lld_sync(flashp);
-        flash_lld_erase_sector(flashp, sector.origin);
+        if (other_bank)
+            flash_sync_other_bank(flashp);
+        else
+            flash_lld_sync(flashp);
+#if FLASH_ERASE_SKIP_BLANK
+        /* The blank check does not need the kernel locked. */
+        chSysUnlock();
+        bool erased = flash_lld_is_erased(flashp, sector.origin, sector.size);
+        chSysLock();
+        if (!erased)
+#endif /* FLASH_ERASE_SKIP_BLANK */
+            flash_lld_erase_sector(flashp, sector.origin);
+        chSysUnlock();
+    }
+
+    if (other_bank)
+    {
+        chSysLock();
+        flash_sync_other_bank(flashp);
         chSysUnlock();
     }
 
+    QHAL_PERF_END(flash_erase);
     return HAL_SUCCESS;
 }
 
@@ -282,6 +436,7 @@ bool flashMassErase(FLASHDriver* flashp)
     chDbgCheck(flashp != NULL);
     /* Verify device status. */
     chDbgAssert(flashp->state >= NVM_READY, "invalid state");
+    flash_check_no_request(flashp);
 
     /* Erase operation in progress. */
     flashp->state = NVM_ERASING;
@@ -310,6 +465,7 @@ bool flashSync(FLASHDriver* flashp)
     chDbgCheck(flashp != NULL);
     /* Verify device status. */
     chDbgAssert(flashp->state >= NVM_READY, "invalid state");
+    flash_check_no_request(flashp);
 
     if (flashp->state == NVM_READY)
         return HAL_SUCCESS;
@@ -364,7 +520,11 @@ void flashAcquireBus(FLASHDriver* flashp)
     chDbgCheck(flashp != NULL);
 
 #if FLASH_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if FLASH_USE_RW_LOCK
+    chRWLockAcquire(&flashp->lock);
+#else
     chMtxLock(&flashp->mutex);
+#endif /* FLASH_USE_RW_LOCK */
 #endif /* FLASH_USE_MUTUAL_EXCLUSION */
 }
 
@@ -382,10 +542,50 @@ void flashReleaseBus(FLASHDriver* flashp)
     chDbgCheck(flashp != NULL);
 
 #if FLASH_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if FLASH_USE_RW_LOCK
+    chRWLockRelease(&flashp->lock);
+#else
     chMtxUnlock(&flashp->mutex);
+#endif /* FLASH_USE_RW_LOCK */
 #endif /* FLASH_USE_MUTUAL_EXCLUSION */
 }
 
+#if FLASH_USE_RW_LOCK || defined(__DOXYGEN__)
+/**
+ * @brief   Gains shared access to the flash device for reading.
+ * @details Other readers may use the device at the same time, writers are
+ *          queued.
+ * @pre     In order to use this function the option
+ *          @p FLASH_USE_RW_LOCK must be enabled.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ *
+ * @api
+ */
+void flashAcquireBusShared(FLASHDriver* flashp)
+{
+    chDbgCheck(flashp != NULL);
+
+    chRWLockAcquireShared(&flashp->lock);
+}
+
+/**
+ * @brief   Releases shared access to the flash device.
+ * @pre     In order to use this function the option
+ *          @p FLASH_USE_RW_LOCK must be enabled.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ *
+ * @api
+ */
+void flashReleaseBusShared(FLASHDriver* flashp)
+{
+    chDbgCheck(flashp != NULL);
+
+    chRWLockReleaseShared(&flashp->lock);
+}
+#endif /* FLASH_USE_RW_LOCK */
+
 /**
  * @brief   Write protects one or more sectors.
  *
@@ -520,6 +720,172 @@ bool flashMassWriteUnprotect(FLASHDriver* flashp)
     return HAL_SUCCESS;
 }
 
+/**
+ * @brief   Checks whether a range is erased.
+ * @details The flash is memory mapped, which allows scanning it directly
+ *          instead of copying it through a buffer.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr first address to check
+ * @param[in] n         number of bytes to check
+ * @param[out] erasedp  set to @p true if all bytes are erased
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool flashIsErased(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
+        bool* erasedp)
+{
+    chDbgCheck((flashp != NULL) && (erasedp != NULL));
+    /* Verify device status. */
+    chDbgAssert(flashp->state >= NVM_READY, "invalid state");
+    flash_check_no_request(flashp);
+    /* Verify range is within chip size. */
+    chDbgAssert(n == 0 || (
+            flash_lld_addr_to_sector(startaddr, NULL) == HAL_SUCCESS
+            && flash_lld_addr_to_sector(startaddr + n - 1, NULL) == HAL_SUCCESS),
+            "invalid parameters");
+
+    chSysLock();
+    flash_lld_sync(flashp);
+    chSysUnlock();
+
+    *erasedp = flash_lld_is_erased(flashp, startaddr, n);
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Maps a range for direct reads.
+ * @details Waits for pending operations and returns the address of the
+ *          range within the memory mapped flash.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] startaddr first address to map
+ * @param[in] n         number of bytes to map
+ * @param[out] ptrp     receives the address of @p startaddr
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool flashMap(FLASHDriver* flashp, uint32_t startaddr, uint32_t n,
+        const uint8_t** ptrp)
+{
+    chDbgCheck((flashp != NULL) && (ptrp != NULL));
+    /* Verify device status. */
+    chDbgAssert(flashp->state >= NVM_READY, "invalid state");
+    flash_check_no_request(flashp);
+    /* Verify range is within chip size. */
+    chDbgAssert(n == 0 || (
+            flash_lld_addr_to_sector(startaddr, NULL) == HAL_SUCCESS
+            && flash_lld_addr_to_sector(startaddr + n - 1, NULL) == HAL_SUCCESS),
+            "invalid parameters");
+
+    chSysLock();
+    flash_lld_sync(flashp);
+    chSysUnlock();
+
+    *ptrp = flash_lld_map(flashp, startaddr);
+
+    return HAL_SUCCESS;
+}
+
+#if FLASH_USE_REQUEST || defined(__DOXYGEN__)
+/**
+ * @brief   Starts an asynchronous request.
+ * @details Reads complete immediately. Writes and erases are advanced from
+ *          the end of operation interrupt, the device must not be used
+ *          otherwise until the request completed.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] reqp      pointer to an initialized @p NVMRequest
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the request has been started.
+ * @retval HAL_FAILED   the request could not be started.
+ *
+ * @api
+ */
+bool flashStartRequest(FLASHDriver* flashp, NVMRequest* reqp)
+{
+    chDbgCheck((flashp != NULL) && (reqp != NULL));
+    /* Verify device status. */
+    chDbgAssert(flashp->state >= NVM_READY, "invalid state");
+    flash_check_no_request(flashp);
+    /* Verify range is within chip size. */
+    chDbgAssert(reqp->n == 0 || (
+            flash_lld_addr_to_sector(reqp->startaddr, NULL) == HAL_SUCCESS
+            && flash_lld_addr_to_sector(reqp->startaddr + reqp->n - 1,
+                    NULL) == HAL_SUCCESS),
+            "invalid parameters");
+
+    reqp->nvmp = (BaseNVMDevice*)flashp;
+    reqp->done = false;
+
+    chSysLock();
+    flash_lld_sync(flashp);
+
+    if (reqp->op == NVM_REQUEST_READ || reqp->n == 0)
+    {
+        if (reqp->op == NVM_REQUEST_READ)
+            flash_lld_read(flashp, reqp->startaddr, reqp->n,
+                    reqp->buffer.read);
+        flashp->state = NVM_READY;
+        nvmRequestCompleteI(reqp, HAL_SUCCESS);
+        chSchRescheduleS();
+        chSysUnlock();
+        return HAL_SUCCESS;
+    }
+
+    flashp->request = reqp;
+    flashp->request_offset = 0;
+    flashp->state =
+            (reqp->op == NVM_REQUEST_WRITE) ? NVM_WRITING : NVM_ERASING;
+
+    if (flash_request_next(flashp) != HAL_SUCCESS)
+    {
+        flash_request_complete(flashp, HAL_FAILED);
+        chSchRescheduleS();
+    }
+    chSysUnlock();
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Advances the request in progress.
+ * @details To be called by the low level driver on end of operation and on
+ *          error interrupts.
+ *
+ * @param[in] flashp    pointer to the @p FLASHDriver object
+ * @param[in] failed    the last operation failed
+ *
+ * @notapi
+ */
+void _flash_serve_request_isr(FLASHDriver* flashp, bool failed)
+{
+    chSysLockFromISR();
+
+    if (flashp->request != NULL)
+    {
+        if (failed)
+            flash_request_complete(flashp, HAL_FAILED);
+        else if (flashp->request_offset >= flashp->request->n)
+            flash_request_complete(flashp, HAL_SUCCESS);
+        else if (flash_request_next(flashp) != HAL_SUCCESS)
+            flash_request_complete(flashp, HAL_FAILED);
+    }
+
+    chSysUnlockFromISR();
+}
+#endif /* FLASH_USE_REQUEST */
+
 #endif /* HAL_USE_FLASH */
 
 /** @} */
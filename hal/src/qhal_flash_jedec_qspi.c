@@ -0,0 +1,833 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qflash_jedec_qspi.c
+ * @brief   FLASH JEDEC over quad SPI driver code.
+ *
+ * @addtogroup FLASH_JEDEC_QSPI
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_FLASH_JEDEC_QSPI || defined(__DOXYGEN__)
+
+#include "nelems.h"
+
+#include <string.h>
+
+/**
+ * @todo    - add block protection support
+ *          - add error detection and handling
+ */
+
+/**
+ * @note
+ *      - Commands are always sent on one line, address and data use the
+ *        lines selected by the configured read and program modes.
+ *      - The quad enable bit is non volatile on most parts, it is only
+ *        written if found cleared.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+#define FLASH_JEDEC_WREN 0x06
+#define FLASH_JEDEC_RDID 0x9f
+#define FLASH_JEDEC_RDSR 0x05
+#define FLASH_JEDEC_RDSR2 0x35
+#define FLASH_JEDEC_WRSR 0x01
+#define FLASH_JEDEC_WRSR2 0x31
+#define FLASH_JEDEC_MASS_ERASE 0xc7
+#define FLASH_JEDEC_PAGE_PROGRAM 0x02
+#define FLASH_JEDEC_QUAD_PAGE_PROGRAM 0x32
+#define FLASH_JEDEC_FAST_READ 0x0b
+#define FLASH_JEDEC_DUAL_OUTPUT_READ 0x3b
+#define FLASH_JEDEC_QUAD_OUTPUT_READ 0x6b
+#define FLASH_JEDEC_QUAD_IO_READ 0xeb
+
+/**
+ * @brief   Largest read per command, bounded by the DMA transfer size.
+ */
+#define FLASH_JEDEC_QSPI_MAX_TRANSFER 0x8000
+
+/**
+ * @brief   Mode byte sent with quad I/O reads.
+ * @note    Keeps the chip out of continuous read mode.
+ */
+#define FLASH_JEDEC_QSPI_MODE_BYTE 0xff
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct FlashJedecQSPIDriverVMT flash_jedec_qspi_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))fjqRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))fjqWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))fjqErase,
+    .mass_erase = (bool (*)(void*))fjqMassErase,
+    .sync = (bool (*)(void*))fjqSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))fjqGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))fjqAcquireBus,
+    .release = (void (*)(void*))fjqReleaseBus,
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED
+    .map = (bool (*)(void*, uint32_t, uint32_t, const uint8_t**))fjqMap,
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t flash_jedec_qspi_addr_size(FlashJedecQSPIDriver* fjqp)
+{
+    if (fjqp->config->addrbytes_num == 4)
+        return WSPI_CFG_ADDR_SIZE_32;
+
+    return WSPI_CFG_ADDR_SIZE_24;
+}
+
+/**
+ * @brief   Leaves memory mapped mode for an indirect command.
+ */
+static void flash_jedec_qspi_unmap(FlashJedecQSPIDriver* fjqp)
+{
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED
+    if (fjqp->mapped != NULL)
+    {
+        wspiUnmapFlash(fjqp->config->wspip);
+        fjqp->mapped = NULL;
+    }
+#else /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+    (void)fjqp;
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+}
+
+static void flash_jedec_qspi_command(FlashJedecQSPIDriver* fjqp,
+        uint8_t cmd)
+{
+    osalDbgCheck((fjqp != NULL));
+
+    flash_jedec_qspi_unmap(fjqp);
+
+    const wspi_command_t command =
+    {
+        .cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_NONE |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_NONE,
+        .cmd = cmd,
+        .addr = 0,
+        .alt = 0,
+        .dummy = 0,
+    };
+
+    wspiCommand(fjqp->config->wspip, &command);
+}
+
+static uint8_t flash_jedec_qspi_sr_read(FlashJedecQSPIDriver* fjqp,
+        uint8_t cmd)
+{
+    osalDbgCheck((fjqp != NULL));
+
+    flash_jedec_qspi_unmap(fjqp);
+
+    const wspi_command_t command =
+    {
+        .cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_NONE |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_ONE_LINE,
+        .cmd = cmd,
+        .addr = 0,
+        .alt = 0,
+        .dummy = 0,
+    };
+
+    uint8_t in;
+    wspiReceive(fjqp->config->wspip, &command, sizeof(in), &in);
+
+    return in;
+}
+
+static void flash_jedec_qspi_wait_busy(FlashJedecQSPIDriver* fjqp)
+{
+    osalDbgCheck((fjqp != NULL));
+
+    uint8_t in;
+    for (uint8_t i = 0; i < 16; ++i)
+    {
+        in = flash_jedec_qspi_sr_read(fjqp, FLASH_JEDEC_RDSR);
+        if ((in & 0x01) == 0x00)
+            return;
+    }
+
+    /* Looks like it is a long wait. */
+    while ((in & 0x01) != 0x00)
+    {
+#if FLASH_JEDEC_QSPI_NICE_WAITING
+        /* Trying to be nice with the other threads. */
+        osalThreadSleep(1);
+#endif
+        in = flash_jedec_qspi_sr_read(fjqp, FLASH_JEDEC_RDSR);
+    }
+}
+
+static void flash_jedec_qspi_sr_write(FlashJedecQSPIDriver* fjqp,
+        uint8_t cmd, uint8_t sr)
+{
+    osalDbgCheck((fjqp != NULL));
+
+    flash_jedec_qspi_wait_busy(fjqp);
+
+    flash_jedec_qspi_command(fjqp, FLASH_JEDEC_WREN);
+
+    const wspi_command_t command =
+    {
+        .cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_NONE |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_ONE_LINE,
+        .cmd = cmd,
+        .addr = 0,
+        .alt = 0,
+        .dummy = 0,
+    };
+
+    wspiSend(fjqp->config->wspip, &command, sizeof(sr), &sr);
+}
+
+static bool flash_jedec_qspi_needs_quad(FlashJedecQSPIDriver* fjqp)
+{
+    return fjqp->config->read_mode == FLASH_JEDEC_QSPI_READ_1_1_4 ||
+            fjqp->config->read_mode == FLASH_JEDEC_QSPI_READ_1_4_4 ||
+            fjqp->config->program_mode == FLASH_JEDEC_QSPI_PROGRAM_1_1_4;
+}
+
+static void flash_jedec_qspi_quad_enable(FlashJedecQSPIDriver* fjqp)
+{
+    osalDbgCheck((fjqp != NULL));
+
+    flash_jedec_qspi_wait_busy(fjqp);
+
+    switch (fjqp->config->qe_mode)
+    {
+    case FLASH_JEDEC_QSPI_QE_SR1_BIT6:
+    {
+        const uint8_t sr = flash_jedec_qspi_sr_read(fjqp, FLASH_JEDEC_RDSR);
+        if ((sr & 0x40) == 0x00)
+            flash_jedec_qspi_sr_write(fjqp, FLASH_JEDEC_WRSR, sr | 0x40);
+        break;
+    }
+    case FLASH_JEDEC_QSPI_QE_SR2_BIT1:
+    {
+        const uint8_t sr = flash_jedec_qspi_sr_read(fjqp, FLASH_JEDEC_RDSR2);
+        if ((sr & 0x02) == 0x00)
+            flash_jedec_qspi_sr_write(fjqp, FLASH_JEDEC_WRSR2, sr | 0x02);
+        break;
+    }
+    default:
+        break;
+    }
+
+    flash_jedec_qspi_wait_busy(fjqp);
+}
+
+static void flash_jedec_qspi_read_command(FlashJedecQSPIDriver* fjqp,
+        uint32_t startaddr, wspi_command_t* commandp)
+{
+    osalDbgCheck((fjqp != NULL) && (commandp != NULL));
+
+    const uint32_t addr_size = flash_jedec_qspi_addr_size(fjqp);
+
+    commandp->addr = startaddr;
+    commandp->alt = 0;
+    commandp->dummy = fjqp->config->read_dummy_cycles;
+
+    switch (fjqp->config->read_mode)
+    {
+    case FLASH_JEDEC_QSPI_READ_1_1_2:
+        commandp->cmd = FLASH_JEDEC_DUAL_OUTPUT_READ;
+        commandp->cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_ONE_LINE | addr_size |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_TWO_LINES;
+        break;
+    case FLASH_JEDEC_QSPI_READ_1_1_4:
+        commandp->cmd = FLASH_JEDEC_QUAD_OUTPUT_READ;
+        commandp->cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_ONE_LINE | addr_size |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_FOUR_LINES;
+        break;
+    case FLASH_JEDEC_QSPI_READ_1_4_4:
+        commandp->cmd = FLASH_JEDEC_QUAD_IO_READ;
+        commandp->alt = FLASH_JEDEC_QSPI_MODE_BYTE;
+        commandp->cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_FOUR_LINES | addr_size |
+                WSPI_CFG_ALT_MODE_FOUR_LINES | WSPI_CFG_ALT_SIZE_8 |
+                WSPI_CFG_DATA_MODE_FOUR_LINES;
+        break;
+    default:
+        commandp->cmd = FLASH_JEDEC_FAST_READ;
+        commandp->cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_ONE_LINE | addr_size |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_ONE_LINE;
+        break;
+    }
+}
+
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED
+/**
+ * @brief   Enters memory mapped mode.
+ * @pre     The chip is idle.
+ */
+static void flash_jedec_qspi_remap(FlashJedecQSPIDriver* fjqp)
+{
+    if (fjqp->mapped != NULL)
+        return;
+
+    wspi_command_t command;
+    flash_jedec_qspi_read_command(fjqp, 0, &command);
+
+    wspiMapFlash(fjqp->config->wspip, &command, &fjqp->mapped);
+}
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+
+static void flash_jedec_qspi_page_program(FlashJedecQSPIDriver* fjqp,
+        uint32_t startaddr, uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(fjqp != NULL);
+
+    flash_jedec_qspi_wait_busy(fjqp);
+
+    flash_jedec_qspi_command(fjqp, FLASH_JEDEC_WREN);
+
+    wspi_command_t command =
+    {
+        .cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_ONE_LINE |
+                flash_jedec_qspi_addr_size(fjqp) |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_ONE_LINE,
+        .cmd = FLASH_JEDEC_PAGE_PROGRAM,
+        .addr = startaddr,
+        .alt = 0,
+        .dummy = 0,
+    };
+
+    if (fjqp->config->program_mode == FLASH_JEDEC_QSPI_PROGRAM_1_1_4)
+    {
+        command.cmd = FLASH_JEDEC_QUAD_PAGE_PROGRAM;
+        command.cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_ONE_LINE |
+                flash_jedec_qspi_addr_size(fjqp) |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_FOUR_LINES;
+    }
+
+    wspiSend(fjqp->config->wspip, &command, n, buffer);
+}
+
+static void flash_jedec_qspi_sector_erase(FlashJedecQSPIDriver* fjqp,
+        uint32_t startaddr)
+{
+    osalDbgCheck(fjqp != NULL);
+
+    flash_jedec_qspi_wait_busy(fjqp);
+
+    flash_jedec_qspi_command(fjqp, FLASH_JEDEC_WREN);
+
+    const wspi_command_t command =
+    {
+        .cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_ONE_LINE |
+                flash_jedec_qspi_addr_size(fjqp) |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_NONE,
+        .cmd = fjqp->config->cmd_sector_erase,
+        .addr = startaddr,
+        .alt = 0,
+        .dummy = 0,
+    };
+
+    wspiCommand(fjqp->config->wspip, &command);
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   FLASH JEDEC over quad SPI driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void fjqInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] fjqp     pointer to the @p FlashJedecQSPIDriver object
+ *
+ * @init
+ */
+void fjqObjectInit(FlashJedecQSPIDriver* fjqp)
+{
+    fjqp->vmt = &flash_jedec_qspi_vmt;
+    fjqp->state = NVM_STOP;
+    fjqp->config = NULL;
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED
+    fjqp->mapped = NULL;
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+#if FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&fjqp->mutex);
+#endif /* FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the FLASH peripheral.
+ * @details Sets the quad enable bit if a quad mode is configured.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ * @param[in] config    pointer to the @p FlashJedecQSPIConfig object.
+ *
+ * @api
+ */
+void fjqStart(FlashJedecQSPIDriver* fjqp, const FlashJedecQSPIConfig* config)
+{
+    osalDbgCheck((fjqp != NULL) && (config != NULL));
+    /* Verify device status. */
+    osalDbgAssert((fjqp->state == NVM_STOP) || (fjqp->state == NVM_READY),
+            "invalid state");
+
+#define IS_POW2(x) ((((x) != 0) && !((x) & ((x) - 1))))
+
+    /* Sanity check configuration. */
+    osalDbgAssert(
+            IS_POW2(config->sector_num) &&
+            IS_POW2(config->sector_size) &&
+            IS_POW2(config->page_size) &&
+            (config->addrbytes_num == 3 || config->addrbytes_num == 4),
+            "invalid config");
+
+    fjqp->config = config;
+
+    if (fjqp->config->wspi_cfgp != NULL)
+        wspiStart(fjqp->config->wspip, fjqp->config->wspi_cfgp);
+
+    if (flash_jedec_qspi_needs_quad(fjqp))
+        flash_jedec_qspi_quad_enable(fjqp);
+
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED
+    flash_jedec_qspi_wait_busy(fjqp);
+    flash_jedec_qspi_remap(fjqp);
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+
+    fjqp->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the FLASH peripheral.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ *
+ * @api
+ */
+void fjqStop(FlashJedecQSPIDriver* fjqp)
+{
+    osalDbgCheck(fjqp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((fjqp->state == NVM_STOP) || (fjqp->state == NVM_READY),
+            "invalid state");
+
+    if (fjqp->state == NVM_READY)
+        flash_jedec_qspi_unmap(fjqp);
+
+    fjqp->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ * @param[in] startaddr address to start reading from
+ * @param[in] n         number of bytes to read
+ * @param[in] buffer    pointer to data buffer
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjqRead(FlashJedecQSPIDriver* fjqp, uint32_t startaddr, uint32_t n,
+        uint8_t* buffer)
+{
+    osalDbgCheck(fjqp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(fjqp->state >= NVM_READY, "invalid state");
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= fjqp->config->sector_size * fjqp->config->sector_num),
+            "invalid parameters");
+
+    if (fjqSync(fjqp) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    /* Read operation in progress. */
+    fjqp->state = NVM_READING;
+
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED
+    memcpy(buffer, fjqp->mapped + startaddr, n);
+#else /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+    wspi_command_t command;
+    uint32_t done = 0;
+
+    while (done < n)
+    {
+        const uint32_t chunk = (n - done < FLASH_JEDEC_QSPI_MAX_TRANSFER) ?
+                n - done : FLASH_JEDEC_QSPI_MAX_TRANSFER;
+
+        flash_jedec_qspi_read_command(fjqp, startaddr + done, &command);
+
+        /* Receive data. */
+        wspiReceive(fjqp->config->wspip, &command, chunk, buffer + done);
+
+        done += chunk;
+    }
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+
+    /* Read operation finished. */
+    fjqp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes data crossing sector boundaries if required.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ * @param[in] startaddr address to start writing to
+ * @param[in] n         number of bytes to write
+ * @param[in] buffer    pointer to data buffer
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjqWrite(FlashJedecQSPIDriver* fjqp, uint32_t startaddr, uint32_t n,
+        const uint8_t* buffer)
+{
+    osalDbgCheck(fjqp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(fjqp->state >= NVM_READY, "invalid state");
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= fjqp->config->sector_size * fjqp->config->sector_num),
+            "invalid parameters");
+
+    /* Write operation in progress. */
+    fjqp->state = NVM_WRITING;
+
+    uint32_t written = 0;
+
+    while (written < n)
+    {
+        uint32_t n_chunk =
+                fjqp->config->page_size - ((startaddr + written) % fjqp->config->page_size);
+        if (n_chunk > n - written)
+            n_chunk = n - written;
+
+        flash_jedec_qspi_page_program(fjqp, startaddr + written,
+                n_chunk, buffer + written);
+
+        written += n_chunk;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ * @param[in] startaddr address within to be erased sector
+ * @param[in] n         number of bytes to erase
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjqErase(FlashJedecQSPIDriver* fjqp, uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(fjqp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(fjqp->state >= NVM_READY, "invalid state");
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= fjqp->config->sector_size * fjqp->config->sector_num),
+            "invalid parameters");
+
+    /* Erase operation in progress. */
+    fjqp->state = NVM_ERASING;
+
+    uint32_t first_sector_addr =
+            startaddr - (startaddr % fjqp->config->sector_size);
+
+    for (uint32_t addr = first_sector_addr;
+            addr < startaddr + n;
+            addr += fjqp->config->sector_size)
+    {
+        flash_jedec_qspi_sector_erase(fjqp, addr);
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases whole chip.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjqMassErase(FlashJedecQSPIDriver* fjqp)
+{
+    osalDbgCheck(fjqp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(fjqp->state >= NVM_READY, "invalid state");
+
+    /* Erase operation in progress. */
+    fjqp->state = NVM_ERASING;
+
+    flash_jedec_qspi_wait_busy(fjqp);
+
+    flash_jedec_qspi_command(fjqp, FLASH_JEDEC_WREN);
+
+    flash_jedec_qspi_command(fjqp, FLASH_JEDEC_MASS_ERASE);
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Waits for idle condition.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjqSync(FlashJedecQSPIDriver* fjqp)
+{
+    osalDbgCheck(fjqp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(fjqp->state >= NVM_READY, "invalid state");
+
+    if (fjqp->state == NVM_READY)
+    {
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED
+        /* Note: Info requests leave the mapped mode on an idle chip. */
+        flash_jedec_qspi_remap(fjqp);
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+        return HAL_SUCCESS;
+    }
+
+    flash_jedec_qspi_wait_busy(fjqp);
+
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED
+    flash_jedec_qspi_remap(fjqp);
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+
+    /* No more operation in progress. */
+    fjqp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns media info.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ * @param[out] nvmdip   pointer to a @p NVMDeviceInfo structure
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjqGetInfo(FlashJedecQSPIDriver* fjqp, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(fjqp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(fjqp->state >= NVM_READY, "invalid state");
+
+    flash_jedec_qspi_wait_busy(fjqp);
+
+    nvmdip->sector_num = fjqp->config->sector_num;
+    nvmdip->sector_size = fjqp->config->sector_size;
+    nvmdip->write_alignment = 0;
+    nvmdip->page_size = fjqp->config->page_size;
+    nvmdip->erase_sizes[0] = fjqp->config->sector_size;
+    nvmdip->erase_sizes[1] = 0;
+    nvmdip->erase_sizes[2] = 0;
+    nvmdip->timing = fjqp->config->timing;
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED
+    nvmdip->memory_mapped = true;
+#else /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+    nvmdip->memory_mapped = false;
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+
+    const wspi_command_t command =
+    {
+        .cfg = WSPI_CFG_CMD_MODE_ONE_LINE |
+                WSPI_CFG_ADDR_MODE_NONE |
+                WSPI_CFG_ALT_MODE_NONE |
+                WSPI_CFG_DATA_MODE_ONE_LINE,
+        .cmd = FLASH_JEDEC_RDID,
+        .addr = 0,
+        .alt = 0,
+        .dummy = 0,
+    };
+
+    /* Note: The id is clocked in at once, room for continuation codes. */
+    uint8_t in[8];
+    flash_jedec_qspi_unmap(fjqp);
+    wspiReceive(fjqp->config->wspip, &command, sizeof(in), in);
+
+    /* Skip JEDEC continuation id. */
+    uint32_t first = 0;
+    while (first < NELEMS(in) - NELEMS(nvmdip->identification) &&
+            in[first] == 0x7f)
+        ++first;
+
+    for (uint32_t i = 0; i < NELEMS(nvmdip->identification); ++i)
+        nvmdip->identification[i] = in[first + i];
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Gains exclusive access to the flash device.
+ * @details This function tries to gain ownership to the flash device, if the
+ *          device is already being used then the invoking thread is queued.
+ * @pre     In order to use this function the option
+ *          @p FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ *
+ * @api
+ */
+void fjqAcquireBus(FlashJedecQSPIDriver* fjqp)
+{
+    osalDbgCheck(fjqp != NULL);
+
+#if FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&fjqp->mutex);
+
+#if WSPI_USE_MUTUAL_EXCLUSION
+    /* Acquire the underlying device as well. */
+    wspiAcquireBus(fjqp->config->wspip);
+#endif /* WSPI_USE_MUTUAL_EXCLUSION */
+#endif /* FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the flash device.
+ * @pre     In order to use this function the option
+ *          @p FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ *
+ * @api
+ */
+void fjqReleaseBus(FlashJedecQSPIDriver* fjqp)
+{
+    osalDbgCheck(fjqp != NULL);
+
+#if FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&fjqp->mutex);
+
+#if WSPI_USE_MUTUAL_EXCLUSION
+    /* Release the underlying device as well. */
+    wspiReleaseBus(fjqp->config->wspip);
+#endif /* WSPI_USE_MUTUAL_EXCLUSION */
+#endif /* FLASH_JEDEC_QSPI_USE_MUTUAL_EXCLUSION */
+}
+
+#if FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED || defined(__DOXYGEN__)
+/**
+ * @brief   Maps a range for direct reads.
+ * @details Waits for pending operations and enters memory mapped mode.
+ * @note    The pointer is valid until the next write or erase.
+ *
+ * @param[in] fjqp      pointer to the @p FlashJedecQSPIDriver object
+ * @param[in] startaddr first address to map
+ * @param[in] n         number of bytes to map
+ * @param[out] ptrp     receives the address of @p startaddr
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjqMap(FlashJedecQSPIDriver* fjqp, uint32_t startaddr, uint32_t n,
+        const uint8_t** ptrp)
+{
+    osalDbgCheck((fjqp != NULL) && (ptrp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(fjqp->state >= NVM_READY, "invalid state");
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= fjqp->config->sector_size * fjqp->config->sector_num),
+            "invalid parameters");
+
+    if (fjqSync(fjqp) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    *ptrp = fjqp->mapped + startaddr;
+
+    return HAL_SUCCESS;
+}
+#endif /* FLASH_JEDEC_QSPI_USE_MEMORY_MAPPED */
+
+#endif /* HAL_USE_FLASH_JEDEC_QSPI */
+
+/** @} */
@@ -27,6 +27,8 @@
 #include "static_assert.h"
 #include "nelems.h"
 
+#include <string.h>
+
 /**
  * @todo    - add efficient use of AAI writing for chips which support it
  *          - add error detection and handling
@@ -42,6 +44,12 @@
  *          completion of write operation.
  *        - SST25VF032: the write enable latch bit must be manually reset on
  *          completion of AAI write operation.
+ *      - Suspend:
+ *        Reads arriving while the chip is busy suspend the pending erase or
+ *        program if @p cmd_suspend is set. The range under erase reads
+ *        undefined data even while suspended, so reads overlapping it
+ *        complete the erase first. Parts require some time between resume
+ *        and the next suspend, back to back reads delay the erase.
  */
 
 /*===========================================================================*/
@@ -55,6 +63,12 @@
 #define FLASH_JEDEC_WRSR 0x01
 #define FLASH_JEDEC_FAST_READ 0x0b
 #define FLASH_JEDEC_MASS_ERASE 0xc7
+#define FLASH_JEDEC_PAGE_PROGRAM 0x02
+#define FLASH_JEDEC_RDSFDP 0x5a
+#define FLASH_JEDEC_EN4B 0xb7
+
+/* Basic flash parameter table double words used by discovery. */
+#define FLASH_JEDEC_SFDP_BFPT_DWORDS 13
 
 /*===========================================================================*/
 /* Driver exported variables.                                                */
@@ -83,8 +97,17 @@ static const struct FlashJedecSPIDriverVMT flash_jedec_spi_vmt =
     .mass_writeprotect = (bool (*)(void*))fjsMassWriteProtect,
     .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))fjsWriteUnprotect,
     .mass_writeunprotect = (bool (*)(void*))fjsMassWriteUnprotect,
+    .readv = (bool (*)(void*, const NVMReadSegment*, uint32_t))fjsReadv,
+    .writev = (bool (*)(void*, const NVMWriteSegment*, uint32_t))fjsWritev,
+    .is_erased = (bool (*)(void*, uint32_t, uint32_t, bool*))fjsIsErased,
 };
 
+/**
+ * @brief   Erased bytes sent as padding and dummy data.
+ * @note    Kept in RAM so any DMA channel can read it.
+ */
+static uint8_t flash_jedec_spi_erased[FLASH_JEDEC_SPI_ERASED_BLOCK_SIZE];
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -96,6 +119,54 @@ static void flash_jedec_spi_reconfigure(FlashJedecSPIDriver* fjsp)
         spiStart(fjsp->config->spip, fjsp->config->spi_cfgp);
 }
 
+static void flash_jedec_spi_reconfigure_read(FlashJedecSPIDriver* fjsp)
+{
+    /* Set read specific bus configuration if defined. */
+    if (fjsp->config->spi_read_cfgp)
+        spiStart(fjsp->config->spip, fjsp->config->spi_read_cfgp);
+    else
+        flash_jedec_spi_reconfigure(fjsp);
+}
+
+/**
+ * @brief   Sends a command byte followed by the address bytes.
+ * @details The whole header is sent by a single transfer.
+ */
+static void flash_jedec_spi_send_command(FlashJedecSPIDriver* fjsp,
+        uint8_t cmd, uint32_t addr, bool dummy)
+{
+    osalDbgAssert(fjsp->config->addrbytes_num <= 4, "invalid address bytes");
+
+    uint8_t out[1 + 4 + 1];
+    size_t len = 0;
+
+    out[len++] = cmd;
+    for (uint32_t i = fjsp->config->addrbytes_num; i > 0; --i)
+        out[len++] = (addr >> ((i - 1) * 8)) & 0xff;
+    /* Dummy byte required for timing. */
+    if (dummy == true)
+        out[len++] = 0x00;
+
+    spiSend(fjsp->config->spip, len, out);
+}
+
+/**
+ * @brief   Sends @p n erased bytes.
+ */
+static void flash_jedec_spi_send_erased(FlashJedecSPIDriver* fjsp,
+        uint32_t n)
+{
+    while (n > 0)
+    {
+        const uint32_t chunk = (n < sizeof(flash_jedec_spi_erased)) ?
+                n : sizeof(flash_jedec_spi_erased);
+
+        spiSend(fjsp->config->spip, chunk, flash_jedec_spi_erased);
+
+        n -= chunk;
+    }
+}
+
 static void flash_jedec_spi_write_enable(FlashJedecSPIDriver* fjsp)
 {
     osalDbgCheck((fjsp != NULL));
@@ -130,9 +201,89 @@ static void flash_jedec_spi_write_disable(FlashJedecSPIDriver* fjsp)
     spiUnselect(fjsp->config->spip);
 }
 
+/**
+ * @brief   Records the start of an operation keeping the chip busy.
+ */
+static void flash_jedec_spi_busy_begin(FlashJedecSPIDriver* fjsp,
+        fjsbusy_t op)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    fjsp->busy_op = op;
+    fjsp->busy_start = osalOsGetSystemTimeX();
+}
+
+static FlashJedecSPIBusyStats* flash_jedec_spi_busy_stats(
+        FlashJedecSPIDriver* fjsp, fjsbusy_t op)
+{
+    switch (op)
+    {
+    case FLASH_JEDEC_SPI_BUSY_PROGRAM:
+        return &fjsp->stats.program;
+    case FLASH_JEDEC_SPI_BUSY_ERASE:
+        return &fjsp->stats.erase;
+    case FLASH_JEDEC_SPI_BUSY_BLOCK_ERASE:
+        return &fjsp->stats.block_erase;
+    case FLASH_JEDEC_SPI_BUSY_MASS_ERASE:
+        return &fjsp->stats.mass_erase;
+    case FLASH_JEDEC_SPI_BUSY_WRITE_STATUS:
+        return &fjsp->stats.write_status;
+    default:
+        return NULL;
+    }
+}
+
+#if FLASH_JEDEC_SPI_NICE_WAITING || defined(__DOXYGEN__)
+/**
+ * @brief   Expected busy time of an operation in system ticks.
+ * @details The measured average if available, the configured typical time
+ *          rounded down otherwise.
+ */
+static uint32_t flash_jedec_spi_busy_expected(FlashJedecSPIDriver* fjsp,
+        fjsbusy_t op)
+{
+    const FlashJedecSPIBusyStats* statsp = flash_jedec_spi_busy_stats(fjsp, op);
+
+    if (statsp == NULL)
+        return 0;
+
+    if (statsp->calls > 0)
+        return statsp->time_total / statsp->calls;
+
+    uint32_t typ_us = 0;
+    if (op == FLASH_JEDEC_SPI_BUSY_PROGRAM)
+        typ_us = fjsp->config->timing.program_typ;
+    else if (op == FLASH_JEDEC_SPI_BUSY_ERASE ||
+            op == FLASH_JEDEC_SPI_BUSY_BLOCK_ERASE)
+        typ_us = fjsp->config->timing.erase_typ;
+
+    return ((uint64_t)typ_us * OSAL_ST_FREQUENCY) / 1000000;
+}
+#endif /* FLASH_JEDEC_SPI_NICE_WAITING */
+
 static void flash_jedec_spi_wait_busy(FlashJedecSPIDriver* fjsp)
 {
     osalDbgCheck((fjsp != NULL));
+
+    const fjsbusy_t op = fjsp->busy_op;
+    fjsp->busy_op = FLASH_JEDEC_SPI_BUSY_NONE;
+
+    bool fine = false;
+#if FLASH_JEDEC_SPI_NICE_WAITING
+    if (op != FLASH_JEDEC_SPI_BUSY_NONE)
+    {
+        /* Sleep through the expected part of the operation. */
+        const uint32_t expected = flash_jedec_spi_busy_expected(fjsp, op);
+        const uint32_t elapsed = (systime_t)(osalOsGetSystemTimeX() -
+                fjsp->busy_start);
+
+        if (expected > elapsed)
+            osalThreadSleep(expected - elapsed);
+
+        fine = true;
+    }
+#endif /* FLASH_JEDEC_SPI_NICE_WAITING */
+
     spiSelect(fjsp->config->spip);
 
     static const uint8_t out[] =
@@ -142,13 +293,18 @@ static void flash_jedec_spi_wait_busy(FlashJedecSPIDriver* fjsp)
 
     spiSend(fjsp->config->spip, NELEMS(out), out);
 
+    /* Poll without delay, around the expected completion for up to one
+     * tick. */
+    const systime_t fine_start = osalOsGetSystemTimeX();
+    uint32_t polls = 0;
     uint8_t in;
-    for (uint8_t i = 0; i < 16; ++i)
+    do
     {
         spiReceive(fjsp->config->spip, sizeof(in), &in);
-        if ((in & 0x01) == 0x00)
-            break;
-    }
+        ++polls;
+    } while ((in & 0x01) != 0x00 &&
+            (polls < 16 ||
+            (fine == true && osalOsGetSystemTimeX() == fine_start)));
 
     /* Looks like it is a long wait. */
     while ((in & 0x01) != 0x00)
@@ -158,9 +314,26 @@ static void flash_jedec_spi_wait_busy(FlashJedecSPIDriver* fjsp)
         osalThreadSleep(1);
 #endif
         spiReceive(fjsp->config->spip, sizeof(in), &in);
+        ++polls;
     }
 
     spiUnselect(fjsp->config->spip);
+
+    /* Account the busy time. */
+    FlashJedecSPIBusyStats* statsp = flash_jedec_spi_busy_stats(fjsp, op);
+    if (statsp != NULL)
+    {
+        const uint32_t elapsed = (systime_t)(osalOsGetSystemTimeX() -
+                fjsp->busy_start);
+
+        osalSysLock();
+        ++statsp->calls;
+        statsp->polls += polls;
+        statsp->time_total += elapsed;
+        if (elapsed > statsp->time_max)
+            statsp->time_max = elapsed;
+        osalSysUnlock();
+    }
 }
 
 static uint8_t flash_jedec_spi_sr_read(FlashJedecSPIDriver* fjsp)
@@ -205,10 +378,12 @@ static void flash_jedec_spi_sr_write(FlashJedecSPIDriver* fjsp, uint8_t sr)
     spiSend(fjsp->config->spip, NELEMS(out), out);
 
     spiUnselect(fjsp->config->spip);
+
+    flash_jedec_spi_busy_begin(fjsp, FLASH_JEDEC_SPI_BUSY_WRITE_STATUS);
 }
 
-static void flash_jedec_spi_page_program(FlashJedecSPIDriver* fjsp,
-        uint32_t startaddr, uint32_t n, const uint8_t* buffer)
+static void flash_jedec_spi_page_program_begin(FlashJedecSPIDriver* fjsp,
+        uint32_t startaddr)
 {
     osalDbgCheck(fjsp != NULL);
 
@@ -217,50 +392,34 @@ static void flash_jedec_spi_page_program(FlashJedecSPIDriver* fjsp,
     flash_jedec_spi_write_enable(fjsp);
 
     uint32_t pre_pad = 0;
-    uint32_t post_pad = 0;
     if (fjsp->config->page_alignment > 0)
-    {
         pre_pad = startaddr % fjsp->config->page_alignment;
-        post_pad = (startaddr + n) % fjsp->config->page_alignment;
-    }
 
     spiSelect(fjsp->config->spip);
 
-    const uint8_t out[] =
-    {
-        fjsp->config->cmd_page_program,
-        ((startaddr - pre_pad) >> 24) & 0xff,
-        ((startaddr - pre_pad) >> 16) & 0xff,
-        ((startaddr - pre_pad) >> 8) & 0xff,
-        ((startaddr - pre_pad) >> 0) & 0xff,
-    };
-
-    /* command byte */
-    spiSend(fjsp->config->spip, 1, &out[0]);
-
-    /* address bytes */
-    spiSend(fjsp->config->spip, fjsp->config->addrbytes_num,
-            &out[NELEMS(out) - fjsp->config->addrbytes_num]);
+    flash_jedec_spi_send_command(fjsp, fjsp->config->cmd_page_program,
+            startaddr - pre_pad, false);
 
     /* pre_pad */
-    {
-        static const uint8_t erased = 0xff;
-        for (uint32_t i = 0; i < pre_pad; ++i)
-            spiSend(fjsp->config->spip, sizeof(erased), &erased);
-    }
+    flash_jedec_spi_send_erased(fjsp, pre_pad);
+}
 
-    /* data buffer */
-    spiSend(fjsp->config->spip, n, buffer);
+static void flash_jedec_spi_page_program_end(FlashJedecSPIDriver* fjsp,
+        uint32_t endaddr)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    uint32_t post_pad = 0;
+    if (fjsp->config->page_alignment > 0)
+        post_pad = endaddr % fjsp->config->page_alignment;
 
     /* post_pad */
-    {
-        static const uint8_t erased = 0xff;
-        for (uint32_t i = 0; i < post_pad; ++i)
-            spiSend(fjsp->config->spip, sizeof(erased), &erased);
-    }
+    flash_jedec_spi_send_erased(fjsp, post_pad);
 
     spiUnselect(fjsp->config->spip);
 
+    flash_jedec_spi_busy_begin(fjsp, FLASH_JEDEC_SPI_BUSY_PROGRAM);
+
     /* note: This is required to terminate AAI programming on some chips. */
     if (fjsp->config->cmd_page_program == 0xad)
     {
@@ -269,34 +428,49 @@ static void flash_jedec_spi_page_program(FlashJedecSPIDriver* fjsp,
     }
 }
 
-static void flash_jedec_spi_sector_erase(FlashJedecSPIDriver* fjsp,
+static void flash_jedec_spi_page_program(FlashJedecSPIDriver* fjsp,
+        uint32_t startaddr, uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    flash_jedec_spi_page_program_begin(fjsp, startaddr);
+
+    /* data buffer */
+    spiSend(fjsp->config->spip, n, buffer);
+
+    flash_jedec_spi_page_program_end(fjsp, startaddr + n);
+}
+
+static void flash_jedec_spi_read_begin(FlashJedecSPIDriver* fjsp,
         uint32_t startaddr)
 {
     osalDbgCheck(fjsp != NULL);
 
+    spiSelect(fjsp->config->spip);
+
+    flash_jedec_spi_send_command(fjsp, fjsp->config->cmd_read, startaddr,
+            fjsp->config->cmd_read == FLASH_JEDEC_FAST_READ);
+}
+
+static void flash_jedec_spi_sector_erase(FlashJedecSPIDriver* fjsp,
+        uint8_t cmd, uint32_t startaddr)
+{
+    osalDbgCheck(fjsp != NULL);
+
     flash_jedec_spi_wait_busy(fjsp);
 
     flash_jedec_spi_write_enable(fjsp);
 
     spiSelect(fjsp->config->spip);
 
-    const uint8_t out[] =
-    {
-        fjsp->config->cmd_sector_erase, /* Erase command is chip specific. */
-        (startaddr >> 24) & 0xff,
-        (startaddr >> 16) & 0xff,
-        (startaddr >> 8) & 0xff,
-        (startaddr >> 0) & 0xff,
-    };
-
-    /* command byte */
-    spiSend(fjsp->config->spip, 1, &out[0]);
-
-    /* address bytes */
-    spiSend(fjsp->config->spip, fjsp->config->addrbytes_num,
-            &out[NELEMS(out) - fjsp->config->addrbytes_num]);
+    /* Erase command is chip specific. */
+    flash_jedec_spi_send_command(fjsp, cmd, startaddr, false);
 
     spiUnselect(fjsp->config->spip);
+
+    flash_jedec_spi_busy_begin(fjsp,
+            cmd == fjsp->config->cmd_sector_erase ?
+            FLASH_JEDEC_SPI_BUSY_ERASE : FLASH_JEDEC_SPI_BUSY_BLOCK_ERASE);
 }
 
 static void flash_jedec_spi_page_program_ff(FlashJedecSPIDriver* fjsp,
@@ -310,29 +484,16 @@ static void flash_jedec_spi_page_program_ff(FlashJedecSPIDriver* fjsp,
 
     spiSelect(fjsp->config->spip);
 
-    const uint8_t out[] =
-    {
-        fjsp->config->cmd_page_program,
-        (startaddr >> 24) & 0xff,
-        (startaddr >> 16) & 0xff,
-        (startaddr >> 8) & 0xff,
-        (startaddr >> 0) & 0xff,
-    };
-
-    /* command byte */
-    spiSend(fjsp->config->spip, 1, &out[0]);
-
-    /* address bytes */
-    spiSend(fjsp->config->spip, fjsp->config->addrbytes_num,
-            &out[NELEMS(out) - fjsp->config->addrbytes_num]);
+    flash_jedec_spi_send_command(fjsp, fjsp->config->cmd_page_program,
+            startaddr, false);
 
     /* dummy data */
-    static const uint8_t erased = 0xff;
-    for (uint32_t i = 0; i < fjsp->config->page_size; ++i)
-        spiSend(fjsp->config->spip, sizeof(erased), &erased);
+    flash_jedec_spi_send_erased(fjsp, fjsp->config->page_size);
 
     spiUnselect(fjsp->config->spip);
 
+    flash_jedec_spi_busy_begin(fjsp, FLASH_JEDEC_SPI_BUSY_PROGRAM);
+
     /* note: This is required to terminate AAI programming on some chips. */
     if (fjsp->config->cmd_page_program == 0xad)
     {
@@ -360,6 +521,180 @@ static void flash_jedec_spi_mass_erase(FlashJedecSPIDriver* fjsp)
     spiSend(fjsp->config->spip, 1, &out[0]);
 
     spiUnselect(fjsp->config->spip);
+
+    flash_jedec_spi_busy_begin(fjsp, FLASH_JEDEC_SPI_BUSY_MASS_ERASE);
+}
+
+static void flash_jedec_spi_send_opcode(FlashJedecSPIDriver* fjsp,
+        uint8_t cmd)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    spiSelect(fjsp->config->spip);
+
+    /* command byte */
+    spiSend(fjsp->config->spip, 1, &cmd);
+
+    spiUnselect(fjsp->config->spip);
+}
+
+/**
+ * @brief   Starts erasing the next unit of the pending erase.
+ * @details Uses the largest block erase which is aligned and fits into the
+ *          remaining range, a sector erase otherwise.
+ */
+static void flash_jedec_spi_erase_step(FlashJedecSPIDriver* fjsp)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    const uint32_t addr = fjsp->erase_next;
+
+    fjsp->erase_start = addr;
+
+    /* Check if device supports erase command. */
+    if (fjsp->config->cmd_sector_erase != 0x00)
+    {
+        uint8_t cmd = fjsp->config->cmd_sector_erase;
+        uint32_t size = fjsp->config->sector_size;
+
+        for (uint32_t i = 0; i < FLASH_JEDEC_SPI_BLOCK_ERASE_NUM; ++i)
+        {
+            const uint32_t block_size = fjsp->config->block_erase_sizes[i];
+
+            if (block_size > size &&
+                    addr % block_size == 0 &&
+                    fjsp->erase_end - addr >= block_size)
+            {
+                cmd = fjsp->config->cmd_block_erase[i];
+                size = block_size;
+            }
+        }
+
+        fjsp->erase_next += size;
+
+        /* Execute erase command. */
+        flash_jedec_spi_sector_erase(fjsp, cmd, addr);
+    }
+    else
+    {
+        fjsp->erase_next += fjsp->config->sector_size;
+
+        /* Emulate erase by writing 0xff. */
+        for (uint32_t i = addr;
+                i < addr + fjsp->config->sector_size;
+                i += fjsp->config->page_size)
+        {
+            flash_jedec_spi_page_program_ff(fjsp, i);
+        }
+    }
+}
+
+/**
+ * @brief   Starts erasing all remaining sectors of the pending erase.
+ */
+static void flash_jedec_spi_erase_complete(FlashJedecSPIDriver* fjsp)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    while (fjsp->erase_next < fjsp->erase_end)
+        flash_jedec_spi_erase_step(fjsp);
+}
+
+/**
+ * @brief   Finishes a pending erase overlapping a range about to be read.
+ * @details Sectors still to be erased or being erased would read stale or
+ *          undefined data, suspending does not help for them.
+ *
+ * @param[in] fjsp      pointer to the @p FlashJedecSPIDriver object
+ * @param[in] startaddr first address to be read
+ * @param[in] n         number of bytes to be read
+ */
+static void flash_jedec_spi_erase_settle(FlashJedecSPIDriver* fjsp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    if (fjsp->state != NVM_ERASING || n == 0 ||
+            startaddr + n <= fjsp->erase_start ||
+            startaddr >= fjsp->erase_end)
+        return;
+
+    flash_jedec_spi_reconfigure(fjsp);
+
+    flash_jedec_spi_erase_complete(fjsp);
+
+    flash_jedec_spi_wait_busy(fjsp);
+
+    /* No more operation in progress. */
+    fjsp->state = NVM_READY;
+}
+
+/**
+ * @brief   Makes the chip readable while an operation is pending.
+ * @details A busy chip is suspended if supported, waited for otherwise.
+ *          The bus is left configured for reading. An erase overlapping
+ *          the range to be read has to be settled before by
+ *          @p flash_jedec_spi_erase_settle().
+ *
+ * @return              Whether the pending operation has been suspended.
+ */
+static bool flash_jedec_spi_read_prepare(FlashJedecSPIDriver* fjsp)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    if (fjsp->state == NVM_READY)
+    {
+        flash_jedec_spi_reconfigure_read(fjsp);
+        return false;
+    }
+
+    /* Status polls and suspend use the command configuration. */
+    flash_jedec_spi_reconfigure(fjsp);
+
+    bool suspended = false;
+
+    if (fjsp->config->cmd_suspend != 0x00 &&
+            (flash_jedec_spi_sr_read(fjsp) & 0x01) != 0x00)
+    {
+        flash_jedec_spi_send_opcode(fjsp, fjsp->config->cmd_suspend);
+
+        /* The suspended operation is not accounted. */
+        fjsp->busy_op = FLASH_JEDEC_SPI_BUSY_NONE;
+
+        suspended = true;
+    }
+
+    /* Note: The busy flag clears once the chip is suspended. */
+    flash_jedec_spi_wait_busy(fjsp);
+
+    if (fjsp->config->spi_read_cfgp)
+        spiStart(fjsp->config->spip, fjsp->config->spi_read_cfgp);
+
+    return suspended;
+}
+
+/**
+ * @brief   Lets a pending operation continue after a read.
+ *
+ * @param[in] fjsp      pointer to the @p FlashJedecSPIDriver object
+ * @param[in] suspended result of @p flash_jedec_spi_read_prepare()
+ */
+static void flash_jedec_spi_read_finish(FlashJedecSPIDriver* fjsp,
+        bool suspended)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    if (suspended == false && fjsp->erase_next >= fjsp->erase_end)
+        return;
+
+    /* Back to the command configuration. */
+    if (fjsp->config->spi_read_cfgp)
+        flash_jedec_spi_reconfigure(fjsp);
+
+    if (suspended == true)
+        flash_jedec_spi_send_opcode(fjsp, fjsp->config->cmd_resume);
+    else
+        flash_jedec_spi_erase_step(fjsp);
 }
 
 /**
@@ -401,6 +736,175 @@ static uint32_t flash_jedec_spi_bp_to_address(FlashJedecSPIDriver* fjsp, uint8_t
     return first_protected_address;
 }
 
+#if FLASH_JEDEC_SPI_USE_SFDP || defined(__DOXYGEN__)
+/**
+ * @brief   Reads SFDP data.
+ * @note    SFDP always uses 3 address bytes and 8 dummy clocks.
+ */
+static void flash_jedec_spi_sfdp_read(FlashJedecSPIDriver* fjsp,
+        uint32_t addr, uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    spiSelect(fjsp->config->spip);
+
+    const uint8_t out[] =
+    {
+        FLASH_JEDEC_RDSFDP,
+        (addr >> 16) & 0xff,
+        (addr >> 8) & 0xff,
+        addr & 0xff,
+        0x00,
+    };
+
+    spiSend(fjsp->config->spip, NELEMS(out), out);
+
+    spiReceive(fjsp->config->spip, n, buffer);
+
+    spiUnselect(fjsp->config->spip);
+}
+
+/**
+ * @brief   Completes a configuration from the SFDP basic flash parameter
+ *          table.
+ *
+ * @param[in] fjsp      pointer to the @p FlashJedecSPIDriver object
+ * @param[out] cfgp     configuration to complete
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the configuration was completed.
+ * @retval HAL_FAILED   no usable SFDP, @p cfgp is unchanged.
+ *
+ * @notapi
+ */
+static bool flash_jedec_spi_sfdp_discover(FlashJedecSPIDriver* fjsp,
+        FlashJedecSPIConfig* cfgp)
+{
+    /* SFDP header followed by the first parameter header which is always
+     * the basic flash parameter table. */
+    uint8_t header[16];
+    flash_jedec_spi_sfdp_read(fjsp, 0, sizeof(header), header);
+
+    if (memcmp(header, "SFDP", 4) != 0 || header[5] != 0x01 ||
+            header[8] != 0x00 || header[10] != 0x01 || header[11] < 9)
+        return HAL_FAILED;
+
+    const uint32_t bfpt_len = header[11] < FLASH_JEDEC_SFDP_BFPT_DWORDS ?
+            header[11] : FLASH_JEDEC_SFDP_BFPT_DWORDS;
+    const uint32_t bfpt_addr = header[12] | (header[13] << 8) |
+            (header[14] << 16);
+
+    uint8_t raw[FLASH_JEDEC_SFDP_BFPT_DWORDS * 4];
+    flash_jedec_spi_sfdp_read(fjsp, bfpt_addr, bfpt_len * 4, raw);
+
+    uint32_t dw[FLASH_JEDEC_SFDP_BFPT_DWORDS] = { 0 };
+    for (uint32_t i = 0; i < bfpt_len; ++i)
+        dw[i] = raw[i * 4] | (raw[i * 4 + 1] << 8) |
+                (raw[i * 4 + 2] << 16) | ((uint32_t)raw[i * 4 + 3] << 24);
+
+    /* 3 byte, 3 or 4 byte and 4 byte addressing are defined. */
+    const uint32_t addr_mode = (dw[0] >> 17) & 0x03;
+    if (addr_mode == 0x03)
+        return HAL_FAILED;
+
+    /* Density in bits, chips above 4 GiB are not addressable. */
+    uint32_t size;
+    if (dw[1] & 0x80000000)
+    {
+        const uint32_t exp = dw[1] & 0x7fffffff;
+        if (exp < 3 || exp > 34)
+            return HAL_FAILED;
+        size = (uint32_t)1 << (exp - 3);
+    }
+    else
+    {
+        size = (dw[1] >> 3) + 1;
+    }
+
+    /* Erase types sorted by ascending size. */
+    uint32_t erase_sizes[4];
+    uint8_t erase_cmds[4];
+    uint32_t erase_num = 0;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        const uint32_t type = dw[7 + i / 2] >> ((i % 2) * 16);
+        const uint8_t exp = type & 0xff;
+        if (exp == 0 || exp > 31)
+            continue;
+
+        uint32_t j = erase_num++;
+        for (; j > 0 && erase_sizes[j - 1] > ((uint32_t)1 << exp); --j)
+        {
+            erase_sizes[j] = erase_sizes[j - 1];
+            erase_cmds[j] = erase_cmds[j - 1];
+        }
+        erase_sizes[j] = (uint32_t)1 << exp;
+        erase_cmds[j] = (type >> 8) & 0xff;
+    }
+
+    /* Fall back to the 4 KiB erase of the first double word. */
+    if (erase_num == 0 && (dw[0] & 0x03) == 0x01)
+    {
+        erase_sizes[0] = 4096;
+        erase_cmds[0] = (dw[0] >> 8) & 0xff;
+        erase_num = 1;
+    }
+
+    if (erase_num == 0 || erase_sizes[0] > size || size % erase_sizes[0])
+        return HAL_FAILED;
+
+    cfgp->sector_size = erase_sizes[0];
+    cfgp->sector_num = size / erase_sizes[0];
+    cfgp->cmd_sector_erase = erase_cmds[0];
+
+    /* Keep the largest block erases. */
+    const uint32_t first_block = erase_num > FLASH_JEDEC_SPI_BLOCK_ERASE_NUM ?
+            erase_num - FLASH_JEDEC_SPI_BLOCK_ERASE_NUM : 1;
+    for (uint32_t i = 0; i < FLASH_JEDEC_SPI_BLOCK_ERASE_NUM; ++i)
+    {
+        const uint32_t type = first_block + i;
+        cfgp->block_erase_sizes[i] = type < erase_num ? erase_sizes[type] : 0;
+        cfgp->cmd_block_erase[i] = type < erase_num ? erase_cmds[type] : 0x00;
+    }
+
+    /* Page size, JESD216A and later. */
+    if (bfpt_len >= 11)
+        cfgp->page_size = (uint32_t)1 << ((dw[10] >> 4) & 0x0f);
+    if (cfgp->page_alignment > cfgp->page_size)
+        cfgp->page_alignment = cfgp->page_size;
+    if (cfgp->cmd_page_program == 0x00)
+        cfgp->cmd_page_program = FLASH_JEDEC_PAGE_PROGRAM;
+
+    /* Multi I/O reads are not available on a plain SPI bus, FAST READ
+     * is the fastest read all SFDP parts support. */
+    cfgp->cmd_read = FLASH_JEDEC_FAST_READ;
+
+    /* Erase suspend and resume, JESD216A and later. */
+    if (bfpt_len >= 13)
+    {
+        const bool supported = (dw[11] & 0x80000000) == 0;
+        cfgp->cmd_suspend = supported ? (dw[12] >> 24) & 0xff : 0x00;
+        cfgp->cmd_resume = supported ? (dw[12] >> 16) & 0xff : 0x00;
+    }
+
+    /* 3 or 4 byte parts enter 4 byte mode if larger than 16 MiB. */
+    cfgp->addrbytes_num = 3;
+    if (addr_mode == 0x02)
+    {
+        cfgp->addrbytes_num = 4;
+    }
+    else if (addr_mode == 0x01 && size > ((uint32_t)1 << 24))
+    {
+        flash_jedec_spi_write_enable(fjsp);
+        flash_jedec_spi_send_opcode(fjsp, FLASH_JEDEC_EN4B);
+        flash_jedec_spi_write_disable(fjsp);
+        cfgp->addrbytes_num = 4;
+    }
+
+    return HAL_SUCCESS;
+}
+#endif /* FLASH_JEDEC_SPI_USE_SFDP */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -414,6 +918,7 @@ static uint32_t flash_jedec_spi_bp_to_address(FlashJedecSPIDriver* fjsp, uint8_t
  */
 void fjsInit(void)
 {
+    memset(flash_jedec_spi_erased, 0xff, sizeof(flash_jedec_spi_erased));
 }
 
 /**
@@ -428,6 +933,12 @@ void fjsObjectInit(FlashJedecSPIDriver* fjsp)
     fjsp->vmt = &flash_jedec_spi_vmt;
     fjsp->state = NVM_STOP;
     fjsp->config = NULL;
+    fjsp->erase_start = 0;
+    fjsp->erase_next = 0;
+    fjsp->erase_end = 0;
+    fjsp->busy_op = FLASH_JEDEC_SPI_BUSY_NONE;
+    fjsp->busy_start = 0;
+    memset(&fjsp->stats, 0, sizeof(fjsp->stats));
 #if FLASH_JEDEC_SPI_USE_MUTUAL_EXCLUSION
     osalMutexObjectInit(&fjsp->mutex);
 #endif /* FLASH_JEDEC_SPI_USE_MUTUAL_EXCLUSION */
@@ -448,6 +959,27 @@ void fjsStart(FlashJedecSPIDriver* fjsp, const FlashJedecSPIConfig* config)
     osalDbgAssert((fjsp->state == NVM_STOP) || (fjsp->state == NVM_READY),
             "invalid state");
 
+#if FLASH_JEDEC_SPI_USE_SFDP
+    /* Complete a copy of the configuration from the chip. */
+    fjsp->sfdp_config = *config;
+    fjsp->config = &fjsp->sfdp_config;
+
+#if SPI_USE_MUTUAL_EXCLUSION
+    spiAcquireBus(config->spip);
+#endif /* SPI_USE_MUTUAL_EXCLUSION */
+
+    flash_jedec_spi_reconfigure(fjsp);
+
+    flash_jedec_spi_wait_busy(fjsp);
+
+    if (flash_jedec_spi_sfdp_discover(fjsp, &fjsp->sfdp_config) == HAL_SUCCESS)
+        config = &fjsp->sfdp_config;
+
+#if SPI_USE_MUTUAL_EXCLUSION
+    spiReleaseBus(config->spip);
+#endif /* SPI_USE_MUTUAL_EXCLUSION */
+#endif /* FLASH_JEDEC_SPI_USE_SFDP */
+
 #define IS_POW2(x) ((((x) != 0) && !((x) & ((x) - 1))))
 
     /* Sanity check configuration. */
@@ -458,10 +990,33 @@ void fjsStart(FlashJedecSPIDriver* fjsp, const FlashJedecSPIConfig* config)
             IS_POW2(config->page_alignment) &&
             (config->page_alignment <= config->page_size) &&
             config->bpbits_num <= 3 &&
-            config->cmd_read != 0x00,
+            config->cmd_read != 0x00 &&
+            (config->spi_read_cfgp == NULL || config->spi_cfgp != NULL),
             "invalid config");
 
+    /* Block erase sizes ascend in multiples of the sector size. */
+    uint32_t erase_size = config->sector_size;
+    for (uint32_t i = 0; i < FLASH_JEDEC_SPI_BLOCK_ERASE_NUM; ++i)
+    {
+        if (config->block_erase_sizes[i] == 0)
+            continue;
+
+        osalDbgAssert(
+                IS_POW2(config->block_erase_sizes[i]) &&
+                config->block_erase_sizes[i] > erase_size &&
+                config->cmd_block_erase[i] != 0x00 &&
+                config->cmd_sector_erase != 0x00,
+                "invalid config");
+
+        erase_size = config->block_erase_sizes[i];
+    }
+
     fjsp->config = config;
+    fjsp->erase_start = 0;
+    fjsp->erase_next = 0;
+    fjsp->erase_end = 0;
+    fjsp->busy_op = FLASH_JEDEC_SPI_BUSY_NONE;
+    memset(&fjsp->stats, 0, sizeof(fjsp->stats));
     fjsp->state = NVM_READY;
 }
 
@@ -506,46 +1061,26 @@ bool fjsRead(FlashJedecSPIDriver* fjsp, uint32_t startaddr, uint32_t n,
     osalDbgAssert((startaddr + n <= fjsp->config->sector_size * fjsp->config->sector_num),
             "invalid parameters");
 
-    if (fjsSync(fjsp) != HAL_SUCCESS)
-        return HAL_FAILED;
+    /* Note: Only reads of other sectors may suspend the erase. */
+    flash_jedec_spi_erase_settle(fjsp, startaddr, n);
+
+    const nvmstate_t pending = fjsp->state;
+    const bool suspended = flash_jedec_spi_read_prepare(fjsp);
 
     /* Read operation in progress. */
     fjsp->state = NVM_READING;
 
-    flash_jedec_spi_reconfigure(fjsp);
-
-    spiSelect(fjsp->config->spip);
-
-    const uint8_t out[] =
-    {
-        fjsp->config->cmd_read,
-        (startaddr >> 24) & 0xff,
-        (startaddr >> 16) & 0xff,
-        (startaddr >> 8) & 0xff,
-        (startaddr >> 0) & 0xff,
-    };
-
-    /* command byte */
-    spiSend(fjsp->config->spip, 1, &out[0]);
-
-    /* address bytes */
-    spiSend(fjsp->config->spip, fjsp->config->addrbytes_num,
-            &out[NELEMS(out) - fjsp->config->addrbytes_num]);
-
-    if (fjsp->config->cmd_read == FLASH_JEDEC_FAST_READ)
-    {
-        /* Dummy byte required for timing. */
-        static const uint8_t dummy = 0x00;
-        spiSend(fjsp->config->spip, sizeof(dummy), &dummy);
-    }
+    flash_jedec_spi_read_begin(fjsp, startaddr);
 
     /* Receive data. */
     spiReceive(fjsp->config->spip, n, buffer);
 
     spiUnselect(fjsp->config->spip);
 
-    /* Read operation finished. */
-    fjsp->state = NVM_READY;
+    flash_jedec_spi_read_finish(fjsp, suspended);
+
+    /* Read operation finished, pending operations go on. */
+    fjsp->state = pending;
 
     return HAL_SUCCESS;
 }
@@ -574,11 +1109,14 @@ bool fjsWrite(FlashJedecSPIDriver* fjsp, uint32_t startaddr, uint32_t n,
     osalDbgAssert((startaddr + n <= fjsp->config->sector_size * fjsp->config->sector_num),
             "invalid parameters");
 
+    flash_jedec_spi_reconfigure(fjsp);
+
+    /* Note: Writes keep their order with a pending erase. */
+    flash_jedec_spi_erase_complete(fjsp);
+
     /* Write operation in progress. */
     fjsp->state = NVM_WRITING;
 
-    flash_jedec_spi_reconfigure(fjsp);
-
     uint32_t written = 0;
 
     while (written < n)
@@ -597,6 +1135,143 @@ bool fjsWrite(FlashJedecSPIDriver* fjsp, uint32_t startaddr, uint32_t n,
     return HAL_SUCCESS;
 }
 
+/**
+ * @brief   Reads multiple segments.
+ * @details Contiguous segments are served by a single read command.
+ *
+ * @param[in] fjsp      pointer to the @p FlashJedecSPIDriver object
+ * @param[in] segp      pointer to an array of @p NVMReadSegment
+ * @param[in] segn      number of segments
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjsReadv(FlashJedecSPIDriver* fjsp, const NVMReadSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((fjsp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(fjsp->state >= NVM_READY, "invalid state");
+
+    for (uint32_t i = 0; i < segn; ++i)
+    {
+        /* Verify range is within chip size. */
+        osalDbgAssert((segp[i].startaddr + segp[i].n <=
+                fjsp->config->sector_size * fjsp->config->sector_num),
+                "invalid parameters");
+
+        /* Note: Only reads of other sectors may suspend the erase. */
+        flash_jedec_spi_erase_settle(fjsp, segp[i].startaddr, segp[i].n);
+    }
+
+    const nvmstate_t pending = fjsp->state;
+    const bool suspended = flash_jedec_spi_read_prepare(fjsp);
+
+    /* Read operation in progress. */
+    fjsp->state = NVM_READING;
+
+    for (uint32_t i = 0; i < segn; ++i)
+    {
+        /* Continue previous command if contiguous. */
+        if (i == 0 || segp[i].startaddr != segp[i - 1].startaddr + segp[i - 1].n)
+        {
+            if (i > 0)
+                spiUnselect(fjsp->config->spip);
+            flash_jedec_spi_read_begin(fjsp, segp[i].startaddr);
+        }
+
+        /* Receive data. */
+        spiReceive(fjsp->config->spip, segp[i].n, segp[i].buffer);
+    }
+
+    if (segn > 0)
+        spiUnselect(fjsp->config->spip);
+
+    flash_jedec_spi_read_finish(fjsp, suspended);
+
+    /* Read operation finished, pending operations go on. */
+    fjsp->state = pending;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes multiple segments.
+ * @details Contiguous segments within a page are programmed by a single
+ *          page program command.
+ *
+ * @param[in] fjsp      pointer to the @p FlashJedecSPIDriver object
+ * @param[in] segp      pointer to an array of @p NVMWriteSegment
+ * @param[in] segn      number of segments
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjsWritev(FlashJedecSPIDriver* fjsp, const NVMWriteSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((fjsp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(fjsp->state >= NVM_READY, "invalid state");
+
+    flash_jedec_spi_reconfigure(fjsp);
+
+    /* Note: Writes keep their order with a pending erase. */
+    flash_jedec_spi_erase_complete(fjsp);
+
+    /* Write operation in progress. */
+    fjsp->state = NVM_WRITING;
+
+    bool open = false;
+    uint32_t open_end = 0;
+
+    for (uint32_t i = 0; i < segn; ++i)
+    {
+        /* Verify range is within chip size. */
+        osalDbgAssert((segp[i].startaddr + segp[i].n <=
+                fjsp->config->sector_size * fjsp->config->sector_num),
+                "invalid parameters");
+
+        uint32_t written = 0;
+
+        while (written < segp[i].n)
+        {
+            const uint32_t addr = segp[i].startaddr + written;
+            uint32_t n_chunk =
+                    fjsp->config->page_size - (addr % fjsp->config->page_size);
+            if (n_chunk > segp[i].n - written)
+                n_chunk = segp[i].n - written;
+
+            /* Continue page program command if contiguous within page. */
+            if (open == false || addr != open_end ||
+                    (addr % fjsp->config->page_size) == 0)
+            {
+                if (open == true)
+                    flash_jedec_spi_page_program_end(fjsp, open_end);
+                flash_jedec_spi_page_program_begin(fjsp, addr);
+                open = true;
+            }
+
+            /* data buffer */
+            spiSend(fjsp->config->spip, n_chunk, segp[i].buffer + written);
+
+            open_end = addr + n_chunk;
+            written += n_chunk;
+        }
+    }
+
+    if (open == true)
+        flash_jedec_spi_page_program_end(fjsp, open_end);
+
+    return HAL_SUCCESS;
+}
+
 /**
  * @brief   Erases one or more sectors.
  *
@@ -619,35 +1294,23 @@ bool fjsErase(FlashJedecSPIDriver* fjsp, uint32_t startaddr, uint32_t n)
     osalDbgAssert((startaddr + n <= fjsp->config->sector_size * fjsp->config->sector_num),
             "invalid parameters");
 
+    flash_jedec_spi_reconfigure(fjsp);
+
+    flash_jedec_spi_erase_complete(fjsp);
+
     /* Erase operation in progress. */
     fjsp->state = NVM_ERASING;
 
-    flash_jedec_spi_reconfigure(fjsp);
+    /* Note: Only the first unit is started here, reads step through the
+       remaining ones and a sync completes them. */
+    fjsp->erase_next = startaddr - (startaddr % fjsp->config->sector_size);
+    fjsp->erase_end = startaddr + n +
+            (fjsp->config->sector_size -
+            (startaddr + n) % fjsp->config->sector_size) %
+            fjsp->config->sector_size;
 
-    uint32_t first_sector_addr =
-            startaddr - (startaddr % fjsp->config->sector_size);
-
-    for (uint32_t addr = first_sector_addr;
-            addr < startaddr + n;
-            addr += fjsp->config->sector_size)
-    {
-        /* Check if device supports erase command. */
-        if (fjsp->config->cmd_sector_erase != 0x00)
-        {
-            /* Execute erase sector command. */
-            flash_jedec_spi_sector_erase(fjsp, addr);
-        }
-        else
-        {
-            /* Emulate erase by writing 0xff. */
-            for (uint32_t i = addr;
-                    i < addr + fjsp->config->sector_size;
-                    i += fjsp->config->page_size)
-            {
-                flash_jedec_spi_page_program_ff(fjsp, i);
-            }
-        }
-    }
+    if (fjsp->erase_next < fjsp->erase_end)
+        flash_jedec_spi_erase_step(fjsp);
 
     return HAL_SUCCESS;
 }
@@ -677,6 +1340,11 @@ bool fjsMassErase(FlashJedecSPIDriver* fjsp)
     /* Check if device supports erase command. */
     if (fjsp->config->cmd_sector_erase != 0x00)
     {
+        /* Covers a pending erase as well. */
+        fjsp->erase_start = 0;
+        fjsp->erase_end = fjsp->config->sector_size * fjsp->config->sector_num;
+        fjsp->erase_next = fjsp->erase_end;
+
         /* Yes, so we assume there is mass erase as well. */
         flash_jedec_spi_mass_erase(fjsp);
     }
@@ -712,6 +1380,8 @@ bool fjsSync(FlashJedecSPIDriver* fjsp)
 
     flash_jedec_spi_reconfigure(fjsp);
 
+    flash_jedec_spi_erase_complete(fjsp);
+
     flash_jedec_spi_wait_busy(fjsp);
 
     /* No more operation in progress. */
@@ -748,6 +1418,12 @@ bool fjsGetInfo(FlashJedecSPIDriver* fjsp, NVMDeviceInfo* nvmdip)
      * This makes sense here as you actually CAN write the chip
      * on a byte by byte basis by padding with 0xff. */
     nvmdip->write_alignment = 0;
+    nvmdip->page_size = fjsp->config->page_size;
+    nvmdip->erase_sizes[0] = fjsp->config->sector_size;
+    for (uint32_t i = 0; i < FLASH_JEDEC_SPI_BLOCK_ERASE_NUM; ++i)
+        nvmdip->erase_sizes[1 + i] = fjsp->config->block_erase_sizes[i];
+    nvmdip->timing = fjsp->config->timing;
+    nvmdip->memory_mapped = false;
 
     spiSelect(fjsp->config->spip);
 
@@ -850,6 +1526,8 @@ bool fjsWriteProtect(FlashJedecSPIDriver* fjsp, uint32_t startaddr,
 
     flash_jedec_spi_reconfigure(fjsp);
 
+    flash_jedec_spi_erase_complete(fjsp);
+
     flash_jedec_spi_wait_busy(fjsp);
 
     uint8_t bp_mask = (1 << fjsp->config->bpbits_num) - 1;
@@ -898,6 +1576,8 @@ bool fjsMassWriteProtect(FlashJedecSPIDriver* fjsp)
 
     flash_jedec_spi_reconfigure(fjsp);
 
+    flash_jedec_spi_erase_complete(fjsp);
+
     /* set BP3 ... BP0 */
     flash_jedec_spi_sr_write(fjsp, 0x07 << 2);
 
@@ -936,6 +1616,8 @@ bool fjsWriteUnprotect(FlashJedecSPIDriver* fjsp, uint32_t startaddr,
 
     flash_jedec_spi_reconfigure(fjsp);
 
+    flash_jedec_spi_erase_complete(fjsp);
+
     flash_jedec_spi_wait_busy(fjsp);
 
     uint8_t bp_mask = (1 << fjsp->config->bpbits_num) - 1;
@@ -984,11 +1666,126 @@ bool fjsMassWriteUnprotect(FlashJedecSPIDriver* fjsp)
 
     flash_jedec_spi_reconfigure(fjsp);
 
+    flash_jedec_spi_erase_complete(fjsp);
+
     flash_jedec_spi_sr_write(fjsp, 0x00);
 
     return HAL_SUCCESS;
 }
 
+/**
+ * @brief   Checks whether a range is erased.
+ * @details The range is clocked in by a single read command and compared
+ *          chunk wise, the command is ended at the first programmed byte.
+ *
+ * @param[in] fjsp      pointer to the @p FlashJedecSPIDriver object
+ * @param[in] startaddr first address to check
+ * @param[in] n         number of bytes to check
+ * @param[out] erasedp  set to @p true if all bytes are erased
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool fjsIsErased(FlashJedecSPIDriver* fjsp, uint32_t startaddr, uint32_t n,
+        bool* erasedp)
+{
+    osalDbgCheck((fjsp != NULL) && (erasedp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(fjsp->state >= NVM_READY, "invalid state");
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= fjsp->config->sector_size * fjsp->config->sector_num),
+            "invalid parameters");
+
+    *erasedp = false;
+
+    if (n == 0)
+    {
+        *erasedp = true;
+        return HAL_SUCCESS;
+    }
+
+    /* Note: Only reads of other sectors may suspend the erase. */
+    flash_jedec_spi_erase_settle(fjsp, startaddr, n);
+
+    const nvmstate_t pending = fjsp->state;
+    const bool suspended = flash_jedec_spi_read_prepare(fjsp);
+
+    /* Read operation in progress. */
+    fjsp->state = NVM_READING;
+
+    flash_jedec_spi_read_begin(fjsp, startaddr);
+
+    uint8_t buffer[NVM_BLANK_CHECK_BUFFER_SIZE];
+    bool erased = true;
+
+    for (uint32_t offset = 0; offset < n && erased == true;
+            offset += sizeof(buffer))
+    {
+        const uint32_t chunk = (n - offset < sizeof(buffer)) ?
+                n - offset : sizeof(buffer);
+
+        /* Receive data. */
+        spiReceive(fjsp->config->spip, chunk, buffer);
+
+        for (uint32_t i = 0; i < chunk; ++i)
+        {
+            if (buffer[i] != 0xff)
+            {
+                erased = false;
+                break;
+            }
+        }
+    }
+
+    spiUnselect(fjsp->config->spip);
+
+    flash_jedec_spi_read_finish(fjsp, suspended);
+
+    /* Read operation finished, pending operations go on. */
+    fjsp->state = pending;
+
+    *erasedp = erased;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns a consistent snapshot of the busy time statistics.
+ *
+ * @param[in] fjsp      pointer to the @p FlashJedecSPIDriver object
+ * @param[out] statsp   pointer to a @p FlashJedecSPIStats structure
+ *
+ * @api
+ */
+void fjsGetStats(FlashJedecSPIDriver* fjsp, FlashJedecSPIStats* statsp)
+{
+    osalDbgCheck((fjsp != NULL) && (statsp != NULL));
+
+    osalSysLock();
+    *statsp = fjsp->stats;
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Resets all busy time statistics to zero.
+ * @note    Busy waits expect the configured timing again until measured.
+ *
+ * @param[in] fjsp      pointer to the @p FlashJedecSPIDriver object
+ *
+ * @api
+ */
+void fjsResetStats(FlashJedecSPIDriver* fjsp)
+{
+    osalDbgCheck(fjsp != NULL);
+
+    osalSysLock();
+    memset(&fjsp->stats, 0, sizeof(fjsp->stats));
+    osalSysUnlock();
+}
+
 #endif /* HAL_USE_FLASH_JEDEC_SPI */
 
 /** @} */
@@ -0,0 +1,527 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qgraphics_display.c
+ * @brief   Graphics display devices generic code.
+ *
+ * @addtogroup GRAPHICS_DISPLAY
+ * @{
+ */
+
+#include "qhal.h"
+
+#include <string.h>
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/* Decode and transfer time of streamed images. */
+QHAL_PERF_REGION(gd_stream_image)
+
+/**
+ * @brief   Run length encoded image decoder state.
+ */
+typedef struct
+{
+    BaseGDDevice* ip;
+    /**
+     * @brief Pixels left in the window.
+     */
+    size_t left;
+    /**
+     * @brief Pixels left in the current packet.
+     */
+    size_t count;
+    /**
+     * @brief Current packet is a run.
+     */
+    bool run;
+    /**
+     * @brief First byte of a color split across inputs, or -1.
+     */
+    int16_t low;
+    /**
+     * @brief Literal colors collected.
+     */
+    coord_t n;
+    color_t chunk[GD_BLIT_CHUNK_SIZE];
+} gd_image_decoder_t;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Converts a RGB565 pixel.
+ */
+static inline color_t gd_from_rgb565(uint16_t pixel)
+{
+#if GD_COLORFORMAT == GD_COLORFORMAT_RGB565
+    return pixel;
+#elif (GD_COLORFORMAT == GD_COLORFORMAT_ARGB8888) || \
+        (GD_COLORFORMAT == GD_COLORFORMAT_RGB888)
+    uint32_t r = (pixel >> 11) & 0x1f;
+    uint32_t g = (pixel >> 5) & 0x3f;
+    uint32_t b = pixel & 0x1f;
+
+    return ((GD_COLORFORMAT == GD_COLORFORMAT_ARGB8888) ? 0xff000000 : 0) |
+            (((r << 3) | (r >> 2)) << 16) |
+            (((g << 2) | (g >> 4)) << 8) |
+            ((b << 3) | (b >> 2));
+#else
+#error "Unsupported pixel color format"
+#endif
+}
+
+/**
+ * @brief   Converts a ARGB8888 pixel.
+ */
+static inline color_t gd_from_argb8888(uint32_t pixel)
+{
+#if GD_COLORFORMAT == GD_COLORFORMAT_RGB565
+    return ((pixel >> 8) & 0xf800) | ((pixel >> 5) & 0x07e0) |
+            ((pixel >> 3) & 0x001f);
+#elif GD_COLORFORMAT == GD_COLORFORMAT_ARGB8888
+    return pixel;
+#elif GD_COLORFORMAT == GD_COLORFORMAT_RGB888
+    return pixel & 0x00ffffff;
+#else
+#error "Unsupported pixel color format"
+#endif
+}
+
+static void gd_image_flush(gd_image_decoder_t* decp)
+{
+    if (decp->n > 0)
+    {
+        gdStreamWrite(decp->ip, decp->chunk, decp->n);
+        decp->n = 0;
+    }
+}
+
+/**
+ * @brief   Decodes a part of a run length encoded image.
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the data is valid so far.
+ * @retval HAL_FAILED   the data overruns the window.
+ */
+static bool gd_image_feed(gd_image_decoder_t* decp, const uint8_t* p,
+        size_t n)
+{
+    const uint8_t* end = p + n;
+
+    while (p < end)
+    {
+        if (decp->count == 0)
+        {
+            decp->run = (*p & GD_IMAGE_RUN) != 0;
+            decp->count = (*p++ & GD_IMAGE_COUNT_MASK) + 1;
+            if (decp->count > decp->left)
+                return HAL_FAILED;
+            decp->left -= decp->count;
+            continue;
+        }
+
+        /* Assembles the next color. */
+        uint16_t pixel;
+        if (decp->low >= 0)
+        {
+            pixel = (uint16_t)decp->low | ((uint16_t)*p++ << 8);
+            decp->low = -1;
+        }
+        else if (end - p >= 2)
+        {
+            pixel = p[0] | ((uint16_t)p[1] << 8);
+            p += 2;
+        }
+        else
+        {
+            decp->low = *p++;
+            break;
+        }
+
+        if (decp->run)
+        {
+            gd_image_flush(decp);
+            gdStreamColor(decp->ip, gd_from_rgb565(pixel),
+                    (uint16_t)decp->count);
+            decp->count = 0;
+        }
+        else
+        {
+            decp->chunk[decp->n++] = gd_from_rgb565(pixel);
+            if (decp->n == GD_BLIT_CHUNK_SIZE)
+                gd_image_flush(decp);
+            --decp->count;
+        }
+    }
+
+    return HAL_SUCCESS;
+}
+
+static void gd_image_start(gd_image_decoder_t* decp, BaseGDDevice* ip,
+        coord_t left, coord_t top, coord_t width, coord_t height)
+{
+    decp->ip = ip;
+    decp->left = (size_t)width * height;
+    decp->count = 0;
+    decp->run = false;
+    decp->low = -1;
+    decp->n = 0;
+
+    gdStreamStart(ip, left, top, width, height);
+}
+
+static bool gd_image_end(gd_image_decoder_t* decp, bool result)
+{
+    gd_image_flush(decp);
+    gdStreamEnd(decp->ip);
+
+    if ((decp->left != 0) || (decp->count != 0) || (decp->low >= 0))
+        return HAL_FAILED;
+
+    return result;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Converts a part of a bitmap row.
+ * @details Masks are expanded a byte at a time through a two entry color
+ *          table.
+ *
+ * @param[in] srcp      pointer to the @p GDBlitSource bitmap
+ * @param[in] row       row of the bitmap
+ * @param[in] col       first column relative to @p x of the bitmap
+ * @param[in] n         number of pixels
+ * @param[out] data[]   array receiving @p n colors
+ *
+ * @api
+ */
+void gdBlitConvert(const GDBlitSource* srcp, coord_t row, coord_t col,
+        coord_t n, color_t data[])
+{
+    const uint8_t* p = (const uint8_t*)srcp->data + (size_t)row * srcp->stride;
+    const size_t x = (size_t)srcp->x + col;
+
+    switch (srcp->format)
+    {
+        case GD_BLIT_MASK1:
+        {
+            const color_t lut[2] = { srcp->bg, srcp->fg };
+            unsigned bit = 7 - (x & 7);
+
+            p += x >> 3;
+            /* Leading bits up to a byte boundary. */
+            while ((n > 0) && (bit != 7))
+            {
+                *data++ = lut[(*p >> bit) & 1];
+                --n;
+                if (bit-- == 0)
+                {
+                    bit = 7;
+                    ++p;
+                }
+            }
+            /* Whole bytes. */
+            for (; n >= 8; n -= 8, data += 8)
+            {
+                const uint8_t b = *p++;
+
+                data[0] = lut[(b >> 7) & 1];
+                data[1] = lut[(b >> 6) & 1];
+                data[2] = lut[(b >> 5) & 1];
+                data[3] = lut[(b >> 4) & 1];
+                data[4] = lut[(b >> 3) & 1];
+                data[5] = lut[(b >> 2) & 1];
+                data[6] = lut[(b >> 1) & 1];
+                data[7] = lut[b & 1];
+            }
+            /* Trailing bits. */
+            for (unsigned i = 0; i < n; ++i)
+                data[i] = lut[(*p >> (7 - i)) & 1];
+            break;
+        }
+        case GD_BLIT_RGB565:
+        {
+            const uint16_t* src = (const uint16_t*)p + x;
+#if GD_COLORFORMAT == GD_COLORFORMAT_RGB565
+            memcpy(data, src, (size_t)n * sizeof(color_t));
+#else
+            for (coord_t i = 0; i < n; ++i)
+                data[i] = gd_from_rgb565(src[i]);
+#endif
+            break;
+        }
+        case GD_BLIT_ARGB8888:
+        {
+            const uint32_t* src = (const uint32_t*)p + x;
+            for (coord_t i = 0; i < n; ++i)
+                data[i] = gd_from_argb8888(src[i]);
+            break;
+        }
+        default:
+            osalDbgAssert(false, "invalid format");
+            break;
+    }
+}
+
+/**
+ * @brief   Counts the leading pixels of a converted row part that are drawn
+ *          or skipped.
+ *
+ * @param[in] srcp      pointer to the @p GDBlitSource bitmap
+ * @param[in] data[]    array of converted colors
+ * @param[in] n         number of colors
+ * @param[in] opaque    counts drawn pixels if @p true, skipped ones otherwise
+ *
+ * @return              The length of the run.
+ *
+ * @api
+ */
+coord_t gdBlitRun(const GDBlitSource* srcp, const color_t data[], coord_t n,
+        bool opaque)
+{
+    if (!srcp->transparent)
+        return opaque ? n : 0;
+
+    const color_t key = (srcp->format == GD_BLIT_MASK1) ? srcp->bg :
+            srcp->key;
+    coord_t i = 0;
+
+    while ((i < n) && ((data[i] != key) == opaque))
+        ++i;
+
+    return i;
+}
+
+/**
+ * @brief   Draws a bitmap through the stream methods.
+ * @details Opaque bitmaps are streamed into a single window, transparent ones
+ *          into a window per run of drawn pixels.
+ *
+ * @param[in] ip        pointer to a @p BaseGDDevice or derived class
+ * @param[in] left      left rectangle border coordinate
+ * @param[in] top       top rectangle border coordinate
+ * @param[in] width     width of the rectangle
+ * @param[in] height    height of the rectangle
+ * @param[in] srcp      pointer to the @p GDBlitSource bitmap
+ *
+ * @api
+ */
+void gdGenericBlit(BaseGDDevice* ip, coord_t left, coord_t top,
+        coord_t width, coord_t height, const GDBlitSource* srcp)
+{
+    color_t chunk[GD_BLIT_CHUNK_SIZE];
+
+    osalDbgCheck((ip != NULL) && (srcp != NULL));
+
+    if (!srcp->transparent)
+        gdStreamStart(ip, left, top, width, height);
+
+    for (coord_t row = 0; row < height; ++row)
+    {
+        for (coord_t col = 0; col < width;)
+        {
+            coord_t n = width - col;
+            if (n > GD_BLIT_CHUNK_SIZE)
+                n = GD_BLIT_CHUNK_SIZE;
+            gdBlitConvert(srcp, row, col, n, chunk);
+
+            if (!srcp->transparent)
+            {
+                gdStreamWrite(ip, chunk, n);
+                col += n;
+                continue;
+            }
+
+            for (coord_t i = 0; i < n;)
+            {
+                i += gdBlitRun(srcp, chunk + i, n - i, false);
+
+                coord_t run = gdBlitRun(srcp, chunk + i, n - i, true);
+                if (run > 0)
+                {
+                    gdStreamStart(ip, left + col + i, top + row, run, 1);
+                    gdStreamWrite(ip, chunk + i, run);
+                    gdStreamEnd(ip);
+                    i += run;
+                }
+            }
+            col += n;
+        }
+    }
+
+    if (!srcp->transparent)
+        gdStreamEnd(ip);
+}
+
+/**
+ * @brief   Run length encodes an image.
+ * @details Repeated colors are stored as runs, all others as literals.
+ *
+ * @param[in] pixels[]  array of RGB565 colors, row by row
+ * @param[in] n         number of pixels
+ * @param[out] buffer   pointer to the output buffer
+ * @param[in] size      size of the output buffer
+ *
+ * @return              The size of the encoded image, 0 if it does not fit.
+ *
+ * @api
+ */
+size_t gdImageEncode(const uint16_t pixels[], size_t n, uint8_t* buffer,
+        size_t size)
+{
+    size_t pos = 0;
+    size_t i = 0;
+
+    osalDbgCheck((pixels != NULL) || (n == 0));
+
+    while (i < n)
+    {
+        size_t count = 1;
+        while ((i + count < n) && (count < GD_IMAGE_PACKET_MAX) &&
+                (pixels[i + count] == pixels[i]))
+            ++count;
+
+        if (count >= 2)
+        {
+            if (pos + 3 > size)
+                return 0;
+            buffer[pos++] = GD_IMAGE_RUN | (uint8_t)(count - 1);
+            buffer[pos++] = (uint8_t)pixels[i];
+            buffer[pos++] = (uint8_t)(pixels[i] >> 8);
+        }
+        else
+        {
+            /* Literal up to the next repeated color. */
+            while ((i + count < n) && (count < GD_IMAGE_PACKET_MAX) &&
+                    !((i + count + 1 < n) &&
+                    (pixels[i + count + 1] == pixels[i + count])))
+                ++count;
+
+            if (pos + 1 + 2 * count > size)
+                return 0;
+            buffer[pos++] = (uint8_t)(count - 1);
+            for (size_t j = 0; j < count; ++j)
+            {
+                buffer[pos++] = (uint8_t)pixels[i + j];
+                buffer[pos++] = (uint8_t)(pixels[i + j] >> 8);
+            }
+        }
+        i += count;
+    }
+
+    return pos;
+}
+
+/**
+ * @brief   Streams a run length encoded image into a window.
+ * @details Runs are written with the @p stream_color method, literals with
+ *          @p stream_write.
+ *
+ * @param[in] ip        pointer to a @p BaseGDDevice or derived class
+ * @param[in] left      left window border coordinate
+ * @param[in] top       top window border coordinate
+ * @param[in] width     width of the window
+ * @param[in] height    height of the window
+ * @param[in] data      pointer to the encoded image
+ * @param[in] size      size of the encoded image
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   the image does not match the window.
+ *
+ * @api
+ */
+bool gdStreamImage(BaseGDDevice* ip, coord_t left, coord_t top,
+        coord_t width, coord_t height, const uint8_t* data, size_t size)
+{
+    gd_image_decoder_t dec;
+
+    osalDbgCheck((ip != NULL) && ((data != NULL) || (size == 0)));
+
+    QHAL_PERF_BEGIN(gd_stream_image);
+    gd_image_start(&dec, ip, left, top, width, height);
+    bool result = gd_image_end(&dec, gd_image_feed(&dec, data, size));
+    QHAL_PERF_END(gd_stream_image);
+
+    return result;
+}
+
+/**
+ * @brief   Streams a run length encoded image stored in a NVM device.
+ * @details Memory mapped devices are decoded in place, all others are read
+ *          a chunk at a time.
+ *
+ * @param[in] ip        pointer to a @p BaseGDDevice or derived class
+ * @param[in] left      left window border coordinate
+ * @param[in] top       top window border coordinate
+ * @param[in] width     width of the window
+ * @param[in] height    height of the window
+ * @param[in] nvmp      pointer to a @p BaseNVMDevice or derived class
+ * @param[in] startaddr address of the encoded image
+ * @param[in] size      size of the encoded image
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   the image can not be read or does not match the
+ *                      window.
+ *
+ * @api
+ */
+bool gdStreamImageNVM(BaseGDDevice* ip, coord_t left, coord_t top,
+        coord_t width, coord_t height, BaseNVMDevice* nvmp,
+        uint32_t startaddr, uint32_t size)
+{
+    const uint8_t* data;
+
+    osalDbgCheck((ip != NULL) && (nvmp != NULL));
+
+    if (nvmMap(nvmp, startaddr, size, &data) == HAL_SUCCESS)
+        return gdStreamImage(ip, left, top, width, height, data, size);
+
+    gd_image_decoder_t dec;
+    uint8_t buffer[GD_BLIT_CHUNK_SIZE];
+    bool result = HAL_SUCCESS;
+
+    gd_image_start(&dec, ip, left, top, width, height);
+    while ((size > 0) && (result == HAL_SUCCESS))
+    {
+        uint32_t n = (size < sizeof(buffer)) ? size : sizeof(buffer);
+
+        result = nvmRead(nvmp, startaddr, n, buffer);
+        if (result == HAL_SUCCESS)
+            result = gd_image_feed(&dec, buffer, n);
+        startaddr += n;
+        size -= n;
+    }
+
+    return gd_image_end(&dec, result);
+}
+
+/** @} */
@@ -0,0 +1,591 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qgd_framebuffer.c
+ * @brief   Graphics display RAM framebuffer code.
+ *
+ * @addtogroup GD_FRAMEBUFFER
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_GD_FRAMEBUFFER || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct GDFramebufferDriverVMT gd_framebuffer_vmt =
+{
+    (size_t)0,
+    .pixel_set = (void (*)(void*, coord_t, coord_t, color_t))gdfbPixelSet,
+    .stream_start = (void (*)(void*, coord_t, coord_t, coord_t, coord_t))
+            gdfbStreamStart,
+    .stream_write =
+            (void (*)(void*, const color_t[], size_t))gdfbStreamWrite,
+    .stream_color =
+            (void (*)(void*, const color_t, uint16_t))gdfbStreamColor,
+    .stream_end = (void (*)(void*))gdfbStreamEnd,
+    .rect_fill = (void (*)(void*, coord_t, coord_t, coord_t, coord_t, color_t))
+            gdfbRectFill,
+    .get_info = (bool (*)(void*, GDDeviceInfo*))gdfbGetInfo,
+    .blit = (void (*)(void*, coord_t, coord_t, coord_t, coord_t,
+            const GDBlitSource*))gdfbBlit,
+    .acquire = (void (*)(void*))gdfbAcquireBus,
+    .release = (void (*)(void*))gdfbReleaseBus,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the framebuffer location of a pixel.
+ */
+static color_t* gdfb_pixel(GDFramebufferDriver* gdfbp, coord_t x, coord_t y)
+{
+    return gdfbp->config->buffer + (size_t)y * gdfbp->gddi.size_x + x;
+}
+
+static uint32_t gdfb_area(const gdfbrect_t* rp)
+{
+    return (uint32_t)(rp->right - rp->left) * (rp->bottom - rp->top);
+}
+
+static void gdfb_union(gdfbrect_t* rp, const gdfbrect_t* otherp)
+{
+    if (otherp->left < rp->left)
+        rp->left = otherp->left;
+    if (otherp->top < rp->top)
+        rp->top = otherp->top;
+    if (otherp->right > rp->right)
+        rp->right = otherp->right;
+    if (otherp->bottom > rp->bottom)
+        rp->bottom = otherp->bottom;
+}
+
+/**
+ * @brief   Evaluates to @p true if two rectangles overlap or touch and their
+ *          bounding box is not larger than both together.
+ */
+static bool gdfb_mergeable(const gdfbrect_t* ap, const gdfbrect_t* bp)
+{
+    if ((ap->left > bp->right) || (bp->left > ap->right) ||
+            (ap->top > bp->bottom) || (bp->top > ap->bottom))
+        return false;
+
+    gdfbrect_t merged = *ap;
+    gdfb_union(&merged, bp);
+
+    return gdfb_area(&merged) <= gdfb_area(ap) + gdfb_area(bp);
+}
+
+static void gdfb_dirty_remove(GDFramebufferDriver* gdfbp, uint8_t i)
+{
+    gdfbp->dirty[i] = gdfbp->dirty[--gdfbp->dirty_n];
+}
+
+/**
+ * @brief   Adds an area to the dirty rectangles.
+ * @details The area absorbs the rectangles it can be merged with without
+ *          sending extra pixels. With all entries in use it is merged into
+ *          the one growing the least.
+ */
+static void gdfb_invalidate(GDFramebufferDriver* gdfbp, coord_t left,
+        coord_t top, coord_t width, coord_t height)
+{
+    if ((width == 0) || (height == 0))
+        return;
+
+    gdfbrect_t rect = { left, top, left + width, top + height };
+
+    while (true)
+    {
+        uint8_t i = 0;
+        while (i < gdfbp->dirty_n)
+        {
+            if (gdfb_mergeable(&rect, &gdfbp->dirty[i]))
+            {
+                /* The union may touch entries already checked. */
+                gdfb_union(&rect, &gdfbp->dirty[i]);
+                gdfb_dirty_remove(gdfbp, i);
+                i = 0;
+            }
+            else
+                ++i;
+        }
+
+        if (gdfbp->dirty_n < GD_FRAMEBUFFER_DIRTY_RECTS)
+            break;
+
+        uint8_t best = 0;
+        uint32_t best_growth = UINT32_MAX;
+        for (i = 0; i < gdfbp->dirty_n; ++i)
+        {
+            gdfbrect_t merged = rect;
+            gdfb_union(&merged, &gdfbp->dirty[i]);
+
+            uint32_t growth = gdfb_area(&merged) - gdfb_area(&gdfbp->dirty[i]);
+            if (growth < best_growth)
+            {
+                best = i;
+                best_growth = growth;
+            }
+        }
+        gdfb_union(&rect, &gdfbp->dirty[best]);
+        gdfb_dirty_remove(gdfbp, best);
+    }
+
+    gdfbp->dirty[gdfbp->dirty_n++] = rect;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Graphics display framebuffer initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void gdfbInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] gdfbp    pointer to the @p GDFramebufferDriver object
+ *
+ * @init
+ */
+void gdfbObjectInit(GDFramebufferDriver* gdfbp)
+{
+    gdfbp->vmt = &gd_framebuffer_vmt;
+    gdfbp->state = GD_STOP;
+    gdfbp->config = NULL;
+    gdfbp->dirty_n = 0;
+#if GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&gdfbp->mutex);
+#endif /* GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the graphics display framebuffer.
+ * @details The framebuffer contents are kept, nothing is presented until
+ *          drawn.
+ * @pre     The underlying display is started.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ * @param[in] config    pointer to the @p GDFramebufferConfig object.
+ *
+ * @api
+ */
+void gdfbStart(GDFramebufferDriver* gdfbp, const GDFramebufferConfig* config)
+{
+    osalDbgCheck((gdfbp != NULL) && (config != NULL));
+    osalDbgCheck((config->gdp != NULL) && (config->buffer != NULL));
+    /* Verify device status. */
+    osalDbgAssert((gdfbp->state == GD_STOP) || (gdfbp->state == GD_READY),
+            "invalid state");
+
+    gdfbp->config = config;
+    gdfbp->dirty_n = 0;
+    gdGetInfo(config->gdp, &gdfbp->gddi);
+    gdfbp->state = GD_READY;
+}
+
+/**
+ * @brief   Disables the graphics display framebuffer.
+ * @details Areas drawn since the last present are dropped.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ *
+ * @api
+ */
+void gdfbStop(GDFramebufferDriver* gdfbp)
+{
+    osalDbgCheck(gdfbp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((gdfbp->state == GD_STOP) || (gdfbp->state == GD_READY),
+            "invalid state");
+
+    gdfbp->dirty_n = 0;
+    gdfbp->state = GD_STOP;
+}
+
+/**
+ * @brief   Sets pixel color.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ * @param[in] x         x coordinate
+ * @param[in] y         y coordinate
+ * @param[in] color     desired pixel color
+ *
+ * @api
+ */
+void gdfbPixelSet(GDFramebufferDriver* gdfbp, coord_t x, coord_t y,
+        color_t color)
+{
+    osalDbgCheck(gdfbp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(gdfbp->state >= GD_READY, "invalid state");
+    osalDbgAssert((x < gdfbp->gddi.size_x) && (y < gdfbp->gddi.size_y),
+            "out of bounds");
+
+    *gdfb_pixel(gdfbp, x, y) = color;
+    gdfb_invalidate(gdfbp, x, y, 1, 1);
+}
+
+/**
+ * @brief   Starts streamed writing into a window.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ * @param[in] left      left window border coordinate
+ * @param[in] top       top window border coordinate
+ * @param[in] width     width of the window
+ * @param[in] height    height of the window
+ *
+ * @api
+ */
+void gdfbStreamStart(GDFramebufferDriver* gdfbp, coord_t left, coord_t top,
+        coord_t width, coord_t height)
+{
+    osalDbgCheck(gdfbp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(gdfbp->state >= GD_READY, "invalid state");
+    osalDbgAssert((left + width <= gdfbp->gddi.size_x) &&
+            (top + height <= gdfbp->gddi.size_y), "out of bounds");
+
+    gdfbp->state = GD_ACTIVE;
+
+    gdfbp->stream_left = left;
+    gdfbp->stream_top = top;
+    gdfbp->stream_width = width;
+    gdfbp->stream_height = height;
+    gdfbp->stream_pos = 0;
+
+    gdfb_invalidate(gdfbp, left, top, width, height);
+}
+
+/**
+ * @brief   Write a chunk of data in stream mode.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ * @param[in] data[]    array of color_t data
+ * @param[in] n         number of array elements
+ *
+ * @api
+ */
+void gdfbStreamWrite(GDFramebufferDriver* gdfbp, const color_t data[],
+        size_t n)
+{
+    osalDbgCheck(gdfbp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(gdfbp->state >= GD_ACTIVE, "invalid state");
+    osalDbgAssert(gdfbp->stream_pos + n <=
+            (size_t)gdfbp->stream_width * gdfbp->stream_height,
+            "out of bounds");
+
+    coord_t x = gdfbp->stream_pos % gdfbp->stream_width;
+    coord_t y = gdfbp->stream_pos / gdfbp->stream_width;
+
+    gdfbp->stream_pos += n;
+    while (n > 0)
+    {
+        coord_t span = gdfbp->stream_width - x;
+        if ((size_t)span > n)
+            span = n;
+
+        memcpy(gdfb_pixel(gdfbp, gdfbp->stream_left + x,
+                gdfbp->stream_top + y), data, span * sizeof(color_t));
+        data += span;
+        n -= span;
+        x = 0;
+        ++y;
+    }
+}
+
+/**
+ * @brief   Write a color n times in stream mode.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ * @param[in] color     color to write
+ * @param[in] n         number of times to write color
+ *
+ * @api
+ */
+void gdfbStreamColor(GDFramebufferDriver* gdfbp, const color_t color,
+        uint16_t n)
+{
+    osalDbgCheck(gdfbp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(gdfbp->state >= GD_ACTIVE, "invalid state");
+    osalDbgAssert(gdfbp->stream_pos + n <=
+            (size_t)gdfbp->stream_width * gdfbp->stream_height,
+            "out of bounds");
+
+    coord_t x = gdfbp->stream_pos % gdfbp->stream_width;
+    coord_t y = gdfbp->stream_pos / gdfbp->stream_width;
+
+    gdfbp->stream_pos += n;
+    while (n > 0)
+    {
+        coord_t span = gdfbp->stream_width - x;
+        if (span > n)
+            span = n;
+
+        color_t* p = gdfb_pixel(gdfbp, gdfbp->stream_left + x,
+                gdfbp->stream_top + y);
+        for (coord_t i = 0; i < span; ++i)
+            p[i] = color;
+        n -= span;
+        x = 0;
+        ++y;
+    }
+}
+
+/**
+ * @brief   End stream mode writing.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ *
+ * @api
+ */
+void gdfbStreamEnd(GDFramebufferDriver* gdfbp)
+{
+    osalDbgCheck(gdfbp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(gdfbp->state >= GD_ACTIVE, "invalid state");
+
+    gdfbp->state = GD_READY;
+}
+
+/**
+ * @brief   Fills a rectangle with a color.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ * @param[in] left      left rectangle border coordinate
+ * @param[in] top       top rectangle border coordinate
+ * @param[in] width     width of the rectangle
+ * @param[in] height    height of the rectangle
+ * @param[in] color     color to fill the rect with
+ *
+ * @api
+ */
+void gdfbRectFill(GDFramebufferDriver* gdfbp, coord_t left, coord_t top,
+        coord_t width, coord_t height, color_t color)
+{
+    osalDbgCheck(gdfbp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(gdfbp->state >= GD_READY, "invalid state");
+    osalDbgAssert((left + width <= gdfbp->gddi.size_x) &&
+            (top + height <= gdfbp->gddi.size_y), "out of bounds");
+
+    if ((width == 0) || (height == 0))
+        return;
+
+    /* Fills the first row, the others are copies of it. */
+    color_t* first = gdfb_pixel(gdfbp, left, top);
+    for (coord_t i = 0; i < width; ++i)
+        first[i] = color;
+    for (coord_t y = 1; y < height; ++y)
+        memcpy(gdfb_pixel(gdfbp, left, top + y), first,
+                width * sizeof(color_t));
+
+    gdfb_invalidate(gdfbp, left, top, width, height);
+}
+
+/**
+ * @brief   Returns device info.
+ * @details The info is the one of the underlying display.
+ *
+ * @param[in] gdfbp         pointer to the @p GDFramebufferDriver object
+ * @param[out] gddip        pointer to a @p GDDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool gdfbGetInfo(GDFramebufferDriver* gdfbp, GDDeviceInfo* gddip)
+{
+    osalDbgCheck(gdfbp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(gdfbp->state >= GD_READY, "invalid state");
+
+    memcpy(gddip, &gdfbp->gddi, sizeof(*gddip));
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Draws a bitmap into a rectangle.
+ * @details Opaque bitmaps are converted straight into the framebuffer rows.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ * @param[in] left      left rectangle border coordinate
+ * @param[in] top       top rectangle border coordinate
+ * @param[in] width     width of the rectangle
+ * @param[in] height    height of the rectangle
+ * @param[in] srcp      pointer to the @p GDBlitSource bitmap
+ *
+ * @api
+ */
+void gdfbBlit(GDFramebufferDriver* gdfbp, coord_t left, coord_t top,
+        coord_t width, coord_t height, const GDBlitSource* srcp)
+{
+    color_t chunk[GD_BLIT_CHUNK_SIZE];
+
+    osalDbgCheck((gdfbp != NULL) && (srcp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(gdfbp->state >= GD_READY, "invalid state");
+    osalDbgAssert((left + width <= gdfbp->gddi.size_x) &&
+            (top + height <= gdfbp->gddi.size_y), "out of bounds");
+
+    for (coord_t row = 0; row < height; ++row)
+    {
+        color_t* p = gdfb_pixel(gdfbp, left, top + row);
+
+        if (!srcp->transparent)
+        {
+            gdBlitConvert(srcp, row, 0, width, p);
+            continue;
+        }
+
+        for (coord_t col = 0; col < width; col += GD_BLIT_CHUNK_SIZE)
+        {
+            coord_t n = width - col;
+            if (n > GD_BLIT_CHUNK_SIZE)
+                n = GD_BLIT_CHUNK_SIZE;
+            gdBlitConvert(srcp, row, col, n, chunk);
+
+            for (coord_t i = 0; i < n;)
+            {
+                i += gdBlitRun(srcp, chunk + i, n - i, false);
+
+                coord_t run = gdBlitRun(srcp, chunk + i, n - i, true);
+                memcpy(p + col + i, chunk + i, run * sizeof(color_t));
+                i += run;
+            }
+        }
+    }
+
+    gdfb_invalidate(gdfbp, left, top, width, height);
+}
+
+/**
+ * @brief   Gains exclusive access to the graphics display framebuffer.
+ * @details This function tries to gain ownership to the graphics display
+ *          framebuffer, if the framebuffer is already being used then the
+ *          invoking thread is queued.
+ * @pre     In order to use this function the option
+ *          @p GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ *
+ * @api
+ */
+void gdfbAcquireBus(GDFramebufferDriver* gdfbp)
+{
+    osalDbgCheck(gdfbp != NULL);
+
+#if GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&gdfbp->mutex);
+#endif /* GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the graphics display framebuffer.
+ * @pre     In order to use this function the option
+ *          @p GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ *
+ * @api
+ */
+void gdfbReleaseBus(GDFramebufferDriver* gdfbp)
+{
+    osalDbgCheck(gdfbp != NULL);
+
+#if GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&gdfbp->mutex);
+#endif /* GD_FRAMEBUFFER_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Pushes the areas drawn since the last present to the display.
+ * @details Each dirty rectangle is sent as one stream transfer, rectangles
+ *          spanning the whole display width in a single write.
+ *
+ * @param[in] gdfbp     pointer to the @p GDFramebufferDriver object
+ *
+ * @api
+ */
+void gdfbPresent(GDFramebufferDriver* gdfbp)
+{
+    osalDbgCheck(gdfbp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(gdfbp->state == GD_READY, "invalid state");
+
+    BaseGDDevice* gdp = gdfbp->config->gdp;
+
+    if (gdfbp->dirty_n == 0)
+        return;
+
+    gdAcquire(gdp);
+    for (uint8_t i = 0; i < gdfbp->dirty_n; ++i)
+    {
+        const gdfbrect_t* rp = &gdfbp->dirty[i];
+        const coord_t width = rp->right - rp->left;
+
+        gdStreamStart(gdp, rp->left, rp->top, width, rp->bottom - rp->top);
+        if (width == gdfbp->gddi.size_x)
+        {
+            gdStreamWrite(gdp, gdfb_pixel(gdfbp, 0, rp->top),
+                    gdfb_area(rp));
+        }
+        else
+        {
+            for (coord_t y = rp->top; y < rp->bottom; ++y)
+                gdStreamWrite(gdp, gdfb_pixel(gdfbp, rp->left, y), width);
+        }
+        gdStreamEnd(gdp);
+    }
+    gdRelease(gdp);
+
+    gdfbp->dirty_n = 0;
+}
+
+#endif /* HAL_USE_GD_FRAMEBUFFER */
+
+/** @} */
@@ -57,6 +57,8 @@ static const struct GDILI9341DriverVMT gd_sim_vmt =
     .rect_fill = (void (*)(void*, coord_t, coord_t, coord_t, coord_t, color_t))
             gdili9341RectFill,
     .get_info = (bool (*)(void*, GDDeviceInfo*))gdili9341GetInfo,
+    .blit = (void (*)(void*, coord_t, coord_t, coord_t, coord_t,
+            const GDBlitSource*))gdili9341Blit,
     .acquire = (void (*)(void*))gdili9341AcquireBus,
     .release = (void (*)(void*))gdili9341ReleaseBus,
 };
@@ -65,6 +67,19 @@ static const struct GDILI9341DriverVMT gd_sim_vmt =
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if GD_ILI9341_USE_ASYNC
+/**
+ * @brief   Waits for the transfer in progress to end.
+ */
+static void ili9341_async_wait(GDILI9341Driver* gdili9341p)
+{
+    osalSysLock();
+    while (gdili9341p->busy)
+        osalThreadSuspendS(&gdili9341p->thread);
+    osalSysUnlock();
+}
+#endif /* GD_ILI9341_USE_ASYNC */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -95,6 +110,11 @@ void gdili9341ObjectInit(GDILI9341Driver* gdili9341p)
 #if GD_ILI9341_USE_MUTUAL_EXCLUSION
     osalMutexObjectInit(&gdili9341p->mutex);
 #endif /* GD_ILI9341_USE_MUTUAL_EXCLUSION */
+#if GD_ILI9341_USE_ASYNC
+    gdili9341p->buffer_index = 0;
+    gdili9341p->busy = false;
+    gdili9341p->thread = NULL;
+#endif /* GD_ILI9341_USE_ASYNC */
 }
 
 /**
@@ -287,6 +307,9 @@ void gdili9341StreamStart(GDILI9341Driver* gdili9341p, coord_t left, coord_t top
 
 /**
  * @brief   Write a chunk of data in stream mode.
+ * @details With @p GD_ILI9341_USE_ASYNC the data is copied into the free
+ *          pixel buffer and sent in background, the function returns as soon
+ *          as the last chunk has been handed over.
  *
  * @param[in] gdili9341p    pointer to the @p GDILI9341Driver object
  * @param[in] data[]        array of color_t data
@@ -301,7 +324,22 @@ void gdili9341StreamWrite(GDILI9341Driver* gdili9341p, const color_t data[],
     /* Verify device status. */
     osalDbgAssert(gdili9341p->state >= GD_ACTIVE, "invalid state");
 
+#if GD_ILI9341_USE_ASYNC
+    while (n > 0)
+    {
+        size_t size;
+        color_t* buffer = gdili9341StreamBuffer(gdili9341p, &size);
+
+        if (size > n)
+            size = n;
+        memcpy(buffer, data, size * sizeof(color_t));
+        gdili9341StreamSubmit(gdili9341p, size);
+        data += size;
+        n -= size;
+    }
+#else
     gdili9341p->config->write_mem_cb(data, n);
+#endif /* GD_ILI9341_USE_ASYNC */
 }
 
 /**
@@ -320,11 +358,16 @@ void gdili9341StreamColor(GDILI9341Driver* gdili9341p, const color_t color,
     /* Verify device status. */
     osalDbgAssert(gdili9341p->state >= GD_ACTIVE, "invalid state");
 
+#if GD_ILI9341_USE_ASYNC
+    ili9341_async_wait(gdili9341p);
+#endif /* GD_ILI9341_USE_ASYNC */
+
     gdili9341p->config->write_color_cb(color, n);
 }
 
 /**
  * @brief   End stream mode writing.
+ * @details Waits for the last asynchronous transfer to end.
  *
  * @param[in] gdili9341p    pointer to the @p GDILI9341Driver object
  *
@@ -336,9 +379,94 @@ void gdili9341StreamEnd(GDILI9341Driver* gdili9341p)
     /* Verify device status. */
     osalDbgAssert(gdili9341p->state >= GD_ACTIVE, "invalid state");
 
+#if GD_ILI9341_USE_ASYNC
+    ili9341_async_wait(gdili9341p);
+#endif /* GD_ILI9341_USE_ASYNC */
+
     gdili9341Unselect(gdili9341p);
 }
 
+#if GD_ILI9341_USE_ASYNC || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the pixel buffer to render the next chunk into.
+ * @details The buffer is not being sent and may be filled while the other
+ *          one is transferred.
+ * @pre     In order to use this function the option
+ *          @p GD_ILI9341_USE_ASYNC must be enabled.
+ *
+ * @param[in] gdili9341p    pointer to the @p GDILI9341Driver object
+ * @param[out] np           size of the buffer in pixels
+ *
+ * @return                  Pointer to the buffer.
+ *
+ * @api
+ */
+color_t* gdili9341StreamBuffer(GDILI9341Driver* gdili9341p, size_t* np)
+{
+    osalDbgCheck((gdili9341p != NULL) && (np != NULL));
+    /* Verify device status. */
+    osalDbgAssert(gdili9341p->state >= GD_ACTIVE, "invalid state");
+
+    *np = gdili9341p->config->buffer_size;
+
+    return gdili9341p->config->buffer[gdili9341p->buffer_index];
+}
+
+/**
+ * @brief   Sends the rendered pixel buffer in stream mode.
+ * @details Waits for the previous transfer to end, starts sending the
+ *          buffer returned by @p gdili9341StreamBuffer() and swaps the
+ *          buffers.
+ * @pre     In order to use this function the option
+ *          @p GD_ILI9341_USE_ASYNC must be enabled.
+ *
+ * @param[in] gdili9341p    pointer to the @p GDILI9341Driver object
+ * @param[in] n             number of pixels rendered into the buffer
+ *
+ * @api
+ */
+void gdili9341StreamSubmit(GDILI9341Driver* gdili9341p, size_t n)
+{
+    osalDbgCheck(gdili9341p != NULL);
+    osalDbgCheck(n <= gdili9341p->config->buffer_size);
+    /* Verify device status. */
+    osalDbgAssert(gdili9341p->state >= GD_ACTIVE, "invalid state");
+
+    if (n == 0)
+        return;
+
+    const color_t* buffer =
+            gdili9341p->config->buffer[gdili9341p->buffer_index];
+
+    osalSysLock();
+    while (gdili9341p->busy)
+        osalThreadSuspendS(&gdili9341p->thread);
+    gdili9341p->busy = true;
+    osalSysUnlock();
+
+    gdili9341p->buffer_index ^= 1;
+    gdili9341p->config->start_mem_cb(buffer, n);
+}
+
+/**
+ * @brief   Reports the end of a transfer started by @p start_mem_cb.
+ * @pre     In order to use this function the option
+ *          @p GD_ILI9341_USE_ASYNC must be enabled.
+ *
+ * @param[in] gdili9341p    pointer to the @p GDILI9341Driver object
+ *
+ * @iclass
+ */
+void gdili9341TransferCompleteI(GDILI9341Driver* gdili9341p)
+{
+    osalDbgCheckClassI();
+    osalDbgCheck(gdili9341p != NULL);
+
+    gdili9341p->busy = false;
+    osalThreadResumeI(&gdili9341p->thread, MSG_OK);
+}
+#endif /* GD_ILI9341_USE_ASYNC */
+
 /**
  * @brief   Fills a rectangle with a color.
  *
@@ -372,6 +500,131 @@ void gdili9341RectFill(GDILI9341Driver* gdili9341p, coord_t left, coord_t top,
     gdili9341StreamEnd(gdili9341p);
 }
 
+/**
+ * @brief   Draws a bitmap into a rectangle.
+ * @details Opaque bitmaps are streamed into a single window, with
+ *          @p GD_ILI9341_USE_ASYNC they are converted straight into the
+ *          pixel buffers. Transparent bitmaps are written a window per run
+ *          of drawn pixels.
+ *
+ * @param[in] gdili9341p    pointer to the @p GDILI9341Driver object
+ * @param[in] left          left rectangle border coordinate
+ * @param[in] top           top rectangle border coordinate
+ * @param[in] width         width of the rectangle
+ * @param[in] height        height of the rectangle
+ * @param[in] srcp          pointer to the @p GDBlitSource bitmap
+ *
+ * @api
+ */
+void gdili9341Blit(GDILI9341Driver* gdili9341p, coord_t left, coord_t top,
+        coord_t width, coord_t height, const GDBlitSource* srcp)
+{
+    osalDbgCheck((gdili9341p != NULL) && (srcp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(gdili9341p->state >= GD_READY, "invalid state");
+
+#if GD_ILI9341_USE_ASYNC
+    if (!srcp->transparent)
+    {
+        size_t size;
+        size_t used = 0;
+
+        gdili9341StreamStart(gdili9341p, left, top, width, height);
+        color_t* buffer = gdili9341StreamBuffer(gdili9341p, &size);
+
+        for (coord_t row = 0; row < height; ++row)
+        {
+            for (coord_t col = 0; col < width;)
+            {
+                coord_t n = width - col;
+                if (n > size - used)
+                    n = size - used;
+                gdBlitConvert(srcp, row, col, n, buffer + used);
+                used += n;
+                col += n;
+
+                if (used == size)
+                {
+                    gdili9341StreamSubmit(gdili9341p, used);
+                    buffer = gdili9341StreamBuffer(gdili9341p, &size);
+                    used = 0;
+                }
+            }
+        }
+
+        gdili9341StreamSubmit(gdili9341p, used);
+        gdili9341StreamEnd(gdili9341p);
+        return;
+    }
+#endif /* GD_ILI9341_USE_ASYNC */
+
+    gdGenericBlit((BaseGDDevice*)gdili9341p, left, top, width, height, srcp);
+}
+
+/**
+ * @brief   Defines the vertical scrolling area.
+ * @details The three parts cover all @p GD_ILI9341_SCROLL_LINES lines of the
+ *          frame memory.
+ *
+ * @param[in] gdili9341p    pointer to the @p GDILI9341Driver object
+ * @param[in] top_fixed     lines fixed at the top
+ * @param[in] scroll_height lines of the scrolling area
+ * @param[in] bottom_fixed  lines fixed at the bottom
+ *
+ * @api
+ */
+void gdili9341ScrollDefine(GDILI9341Driver* gdili9341p, coord_t top_fixed,
+        coord_t scroll_height, coord_t bottom_fixed)
+{
+    osalDbgCheck(gdili9341p != NULL);
+    osalDbgCheck(top_fixed + scroll_height + bottom_fixed ==
+            GD_ILI9341_SCROLL_LINES);
+    /* Verify device status. */
+    osalDbgAssert(gdili9341p->state >= GD_READY, "invalid state");
+
+    const uint8_t data[] =
+    {
+        top_fixed >> 8,
+        top_fixed >> 0,
+        scroll_height >> 8,
+        scroll_height >> 0,
+        bottom_fixed >> 8,
+        bottom_fixed >> 0,
+    };
+
+    gdili9341Select(gdili9341p);
+    gdili9341WriteCommand(gdili9341p, GD_ILI9341_SET_VSCROLL);
+    gdili9341p->config->write_parm_cb(data, NELEMS(data));
+    gdili9341Unselect(gdili9341p);
+}
+
+/**
+ * @brief   Sets the memory line shown at the top of the scrolling area.
+ * @details Scrolling by a line costs this command and the new line only.
+ *
+ * @param[in] gdili9341p    pointer to the @p GDILI9341Driver object
+ * @param[in] start         memory line within the scrolling area
+ *
+ * @api
+ */
+void gdili9341ScrollSet(GDILI9341Driver* gdili9341p, coord_t start)
+{
+    osalDbgCheck(gdili9341p != NULL);
+    /* Verify device status. */
+    osalDbgAssert(gdili9341p->state >= GD_READY, "invalid state");
+
+    const uint8_t data[] =
+    {
+        start >> 8,
+        start >> 0,
+    };
+
+    gdili9341Select(gdili9341p);
+    gdili9341WriteCommand(gdili9341p, GD_ILI9341_SET_VSCROLL_ADDR);
+    gdili9341p->config->write_parm_cb(data, NELEMS(data));
+    gdili9341Unselect(gdili9341p);
+}
+
 /**
  * @brief   Returns device info.
  *
@@ -58,6 +58,8 @@ static const struct GDSimDriverVMT gd_sim_vmt =
     .rect_fill = (void (*)(void*, coord_t, coord_t, coord_t, coord_t, color_t))
             gdsimRectFill,
     .get_info = (bool (*)(void*, GDDeviceInfo*))gdsimGetInfo,
+    .blit = (void (*)(void*, coord_t, coord_t, coord_t, coord_t,
+            const GDBlitSource*))gdsimBlit,
     .acquire = (void (*)(void*))gdsimAcquireBus,
     .release = (void (*)(void*))gdsimReleaseBus,
 };
@@ -160,7 +162,7 @@ void gdsimPixelSet(GDSimDriver* gdsimp, coord_t x, coord_t y, color_t color)
     osalDbgAssert(gdsimp->state >= GD_READY, "invalid state");
 
     gdsim_lld_pixel_set(gdsimp, x, y, color);
-    gdsim_lld_flush(gdsimp, x, y, 1, 1);
+    gdsim_lld_invalidate(gdsimp, x, y, 1, 1);
 }
 
 /**
@@ -205,14 +207,22 @@ void gdsimStreamWrite(GDSimDriver* gdsimp, const color_t data[], size_t n)
     /* Verify device status. */
     osalDbgAssert(gdsimp->state >= GD_ACTIVE, "invalid state");
 
-    for (size_t i = 0; i < n; ++i)
-    {
-        gdsim_lld_pixel_set(gdsimp,
-                gdsimp->stream_left + gdsimp->stream_pos % gdsimp->stream_width,
-                gdsimp->stream_top + gdsimp->stream_pos / gdsimp->stream_width,
-                data[i]);
+    coord_t x = gdsimp->stream_pos % gdsimp->stream_width;
+    coord_t y = gdsimp->stream_pos / gdsimp->stream_width;
 
-        ++gdsimp->stream_pos;
+    gdsimp->stream_pos += n;
+    while (n > 0)
+    {
+        coord_t span = gdsimp->stream_width - x;
+        if ((size_t)span > n)
+            span = n;
+
+        gdsim_lld_span_write(gdsimp, gdsimp->stream_left + x,
+                gdsimp->stream_top + y, data, span);
+        data += span;
+        n -= span;
+        x = 0;
+        ++y;
     }
 }
 
@@ -231,14 +241,21 @@ void gdsimStreamColor(GDSimDriver* gdsimp, const color_t color, uint16_t n)
     /* Verify device status. */
     osalDbgAssert(gdsimp->state >= GD_ACTIVE, "invalid state");
 
-    for (size_t i = 0; i < n; ++i)
-    {
-        gdsim_lld_pixel_set(gdsimp,
-                gdsimp->stream_left + gdsimp->stream_pos % gdsimp->stream_width,
-                gdsimp->stream_top + gdsimp->stream_pos / gdsimp->stream_width,
-                color);
+    coord_t x = gdsimp->stream_pos % gdsimp->stream_width;
+    coord_t y = gdsimp->stream_pos / gdsimp->stream_width;
 
-        ++gdsimp->stream_pos;
+    gdsimp->stream_pos += n;
+    while (n > 0)
+    {
+        coord_t span = gdsimp->stream_width - x;
+        if (span > n)
+            span = n;
+
+        gdsim_lld_span_fill(gdsimp, gdsimp->stream_left + x,
+                gdsimp->stream_top + y, color, span);
+        n -= span;
+        x = 0;
+        ++y;
     }
 }
 
@@ -255,7 +272,7 @@ void gdsimStreamEnd(GDSimDriver* gdsimp)
     /* Verify device status. */
     osalDbgAssert(gdsimp->state >= GD_ACTIVE, "invalid state");
 
-    gdsim_lld_flush(gdsimp, gdsimp->stream_left, gdsimp->stream_top,
+    gdsim_lld_invalidate(gdsimp, gdsimp->stream_left, gdsimp->stream_top,
             gdsimp->stream_width, gdsimp->stream_height);
 
     gdsimp->state = GD_READY;
@@ -281,7 +298,101 @@ void gdsimRectFill(GDSimDriver* gdsimp, coord_t left, coord_t top,
     osalDbgAssert(gdsimp->state >= GD_READY, "invalid state");
 
     gdsim_lld_rect_fill(gdsimp, left, top, width, height, color);
-    gdsim_lld_flush(gdsimp, left, top, width, height);
+    gdsim_lld_invalidate(gdsimp, left, top, width, height);
+}
+
+/**
+ * @brief   Draws a bitmap into a rectangle.
+ * @details Rows are converted in chunks and written as spans into the image,
+ *          the rectangle is flushed once.
+ *
+ * @param[in] gdsimp        pointer to the @p GDSimDriver object
+ * @param[in] left          left rectangle border coordinate
+ * @param[in] top           top rectangle border coordinate
+ * @param[in] width         width of the rectangle
+ * @param[in] height        height of the rectangle
+ * @param[in] srcp          pointer to the @p GDBlitSource bitmap
+ *
+ * @api
+ */
+void gdsimBlit(GDSimDriver* gdsimp, coord_t left, coord_t top,
+        coord_t width, coord_t height, const GDBlitSource* srcp)
+{
+    color_t chunk[GD_BLIT_CHUNK_SIZE];
+
+    osalDbgCheck((gdsimp != NULL) && (srcp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(gdsimp->state >= GD_READY, "invalid state");
+
+    for (coord_t row = 0; row < height; ++row)
+    {
+        for (coord_t col = 0; col < width; col += GD_BLIT_CHUNK_SIZE)
+        {
+            coord_t n = width - col;
+            if (n > GD_BLIT_CHUNK_SIZE)
+                n = GD_BLIT_CHUNK_SIZE;
+            gdBlitConvert(srcp, row, col, n, chunk);
+
+            for (coord_t i = 0; i < n;)
+            {
+                i += gdBlitRun(srcp, chunk + i, n - i, false);
+
+                coord_t run = gdBlitRun(srcp, chunk + i, n - i, true);
+                if (run > 0)
+                {
+                    gdsim_lld_span_write(gdsimp, left + col + i, top + row,
+                            chunk + i, run);
+                    i += run;
+                }
+            }
+        }
+    }
+
+    gdsim_lld_invalidate(gdsimp, left, top, width, height);
+}
+
+/**
+ * @brief   Defines the vertical scrolling area.
+ * @details Emulates the vertical scrolling of display controllers, the
+ *          scroll start is reset to the top of the area.
+ *
+ * @param[in] gdsimp        pointer to the @p GDSimDriver object
+ * @param[in] top_fixed     rows fixed at the top
+ * @param[in] scroll_height rows of the scrolling area
+ * @param[in] bottom_fixed  rows fixed at the bottom
+ *
+ * @api
+ */
+void gdsimScrollDefine(GDSimDriver* gdsimp, coord_t top_fixed,
+        coord_t scroll_height, coord_t bottom_fixed)
+{
+    osalDbgCheck(gdsimp != NULL);
+    osalDbgCheck(top_fixed + scroll_height + bottom_fixed ==
+            gdsimp->config->size_y);
+    /* Verify device status. */
+    osalDbgAssert(gdsimp->state >= GD_READY, "invalid state");
+
+    gdsim_lld_scroll(gdsimp, top_fixed, scroll_height, top_fixed);
+}
+
+/**
+ * @brief   Sets the memory row shown at the top of the scrolling area.
+ *
+ * @param[in] gdsimp        pointer to the @p GDSimDriver object
+ * @param[in] start         memory row within the scrolling area
+ *
+ * @api
+ */
+void gdsimScrollSet(GDSimDriver* gdsimp, coord_t start)
+{
+    osalDbgCheck(gdsimp != NULL);
+    osalDbgCheck((start >= gdsimp->scroll_top) &&
+            (start < gdsimp->scroll_top + gdsimp->scroll_height));
+    /* Verify device status. */
+    osalDbgAssert(gdsimp->state >= GD_READY, "invalid state");
+
+    gdsim_lld_scroll(gdsimp, gdsimp->scroll_top, gdsimp->scroll_height,
+            start);
 }
 
 /**
@@ -0,0 +1,394 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qi2c_sched.c
+ * @brief   I2C bus transaction scheduler code.
+ *
+ * @addtogroup I2C_SCHED
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_I2C_SCHED || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Checks whether system time @p a is before @p b.
+ * @note    Times must be less than half the system time range apart.
+ */
+static bool time_before(systime_t a, systime_t b)
+{
+    systime_t d = b - a;
+
+    return d != 0 && d <= ((systime_t)-1) / 2;
+}
+
+/**
+ * @brief   Checks whether transaction @p a is scheduled before @p b.
+ */
+static bool transaction_before(const I2CTransaction* a,
+        const I2CTransaction* b)
+{
+    if (a->priority != b->priority)
+        return a->priority > b->priority;
+
+    if (a->has_deadline == false)
+        return false;
+    if (b->has_deadline == false)
+        return true;
+
+    return time_before(a->deadline, b->deadline);
+}
+
+/**
+ * @brief   Runs a transaction on the bus.
+ */
+static msg_t i2c_sched_transfer(I2CDriver* i2cp, I2CTransaction* tp)
+{
+    msg_t result;
+
+    if (tp->txbytes > 0)
+        result = i2cMasterTransmitTimeout(i2cp, tp->addr, tp->txbuf,
+                tp->txbytes, tp->rxbuf, tp->rxbytes, tp->timeout);
+    else
+        result = i2cMasterReceiveTimeout(i2cp, tp->addr, tp->rxbuf,
+                tp->rxbytes, tp->timeout);
+
+    /* A timed out bus is locked until the driver is restarted, do not let
+       one device block all others. */
+    if (result == MSG_TIMEOUT)
+        i2cStart(i2cp, i2cp->config);
+
+    return result;
+}
+
+/**
+ * @brief   Worker thread serving the queued transactions.
+ * @details The bus is held from the first queued transaction until the
+ *          queue drains, so transactions run back to back.
+ */
+static void i2c_sched_worker(void* parameters)
+{
+    I2CSchedDriver* i2cschedp = (I2CSchedDriver*)parameters;
+
+    chRegSetThreadName("i2c_sched");
+
+    while (true)
+    {
+        /* Nothing to do, going to sleep. */
+        osalSysLock();
+        while (i2cschedp->queue == NULL)
+            osalThreadSuspendS(&i2cschedp->wait);
+        osalSysUnlock();
+
+        I2CDriver* i2cp = i2cschedp->config->i2cp;
+
+#if I2C_USE_MUTUAL_EXCLUSION
+        i2cAcquireBus(i2cp);
+#endif /* I2C_USE_MUTUAL_EXCLUSION */
+
+        while (true)
+        {
+            osalSysLock();
+            I2CTransaction* tp = i2cschedp->queue;
+            if (tp == NULL)
+            {
+                osalSysUnlock();
+                break;
+            }
+            i2cschedp->queue = tp->next;
+            if (tp->has_deadline &&
+                    time_before(tp->deadline, osalOsGetSystemTimeX()))
+                ++i2cschedp->missed;
+            osalSysUnlock();
+
+            msg_t result = i2c_sched_transfer(i2cp, tp);
+
+            osalSysLock();
+            tp->result = result;
+            tp->done = true;
+            if (tp->callback != NULL)
+                tp->callback(tp);
+            osalThreadResumeI(&tp->thread, MSG_OK);
+            osalOsRescheduleS();
+            osalSysUnlock();
+        }
+
+#if I2C_USE_MUTUAL_EXCLUSION
+        i2cReleaseBus(i2cp);
+#endif /* I2C_USE_MUTUAL_EXCLUSION */
+    }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   I2C bus scheduler driver initialization.
+ * @note    This function is implicitly invoked by @p qhalInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void i2cschedInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] i2cschedp    pointer to the @p I2CSchedDriver object
+ *
+ * @init
+ */
+void i2cschedObjectInit(I2CSchedDriver* i2cschedp)
+{
+    i2cschedp->state = I2C_SCHED_STOP;
+    i2cschedp->config = NULL;
+    i2cschedp->tr = NULL;
+    i2cschedp->wait = NULL;
+    i2cschedp->queue = NULL;
+    i2cschedp->missed = 0;
+
+    /* Filling the thread working area here because the function
+       @p chThdCreateI() does not do it.*/
+#if CH_DBG_FILL_THREADS
+    {
+        _thread_memfill((uint8_t*)THD_WORKING_AREA_BASE(i2cschedp->wa),
+            (uint8_t*)THD_WORKING_AREA_END(i2cschedp->wa),
+            CH_DBG_STACK_FILL_VALUE);
+    }
+#endif /* CH_DBG_FILL_THREADS */
+}
+
+/**
+ * @brief   Configures the scheduler and activates the worker thread.
+ *
+ * @param[in] i2cschedp     pointer to the @p I2CSchedDriver object
+ * @param[in] config        pointer to the @p I2CSchedConfig object
+ *
+ * @api
+ */
+void i2cschedStart(I2CSchedDriver* i2cschedp, const I2CSchedConfig* config)
+{
+    osalDbgCheck((i2cschedp != NULL) && (config != NULL));
+    /* Verify device status. */
+    osalDbgAssert((i2cschedp->state == I2C_SCHED_STOP) ||
+            (i2cschedp->state == I2C_SCHED_READY), "invalid state");
+    osalDbgAssert(i2cschedp->queue == NULL, "transactions queued");
+
+    i2cschedp->config = config;
+
+    /* Creates the worker thread. Note, it is created only once.*/
+    osalSysLock();
+    if (i2cschedp->tr == NULL)
+    {
+        thread_descriptor_t descriptor = {
+          "i2c_sched",
+          THD_WORKING_AREA_BASE(i2cschedp->wa),
+          THD_WORKING_AREA_END(i2cschedp->wa),
+          I2C_SCHED_THREAD_PRIO,
+          i2c_sched_worker,
+          (void*)i2cschedp
+        };
+        i2cschedp->tr = chThdCreateI(&descriptor);
+        osalOsRescheduleS();
+    }
+    osalSysUnlock();
+
+    i2cschedp->state = I2C_SCHED_READY;
+}
+
+/**
+ * @brief   Disables the scheduler.
+ * @note    All submitted transactions must have completed.
+ *
+ * @param[in] i2cschedp     pointer to the @p I2CSchedDriver object
+ *
+ * @api
+ */
+void i2cschedStop(I2CSchedDriver* i2cschedp)
+{
+    osalDbgCheck(i2cschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((i2cschedp->state == I2C_SCHED_STOP) ||
+            (i2cschedp->state == I2C_SCHED_READY), "invalid state");
+    osalDbgAssert(i2cschedp->queue == NULL, "transactions queued");
+
+    i2cschedp->state = I2C_SCHED_STOP;
+}
+
+/**
+ * @brief   Queues a transaction.
+ * @details Transactions run highest @p priority first. Within a priority
+ *          those with the earliest deadline run first, then those without
+ *          deadline in order of submission.
+ *
+ * @param[in] i2cschedp     pointer to the @p I2CSchedDriver object
+ * @param[in] tp            pointer to an initialized @p I2CTransaction
+ * @param[in] priority      scheduling priority, higher first
+ * @param[in] deadline      time from now the transfer should start by or
+ *                          @p TIME_INFINITE
+ *
+ * @api
+ */
+void i2cschedSubmit(I2CSchedDriver* i2cschedp, I2CTransaction* tp,
+        uint8_t priority, sysinterval_t deadline)
+{
+    osalSysLock();
+    i2cschedSubmitI(i2cschedp, tp, priority, deadline);
+    osalOsRescheduleS();
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Queues a transaction.
+ * @details See @p i2cschedSubmit().
+ *
+ * @param[in] i2cschedp     pointer to the @p I2CSchedDriver object
+ * @param[in] tp            pointer to an initialized @p I2CTransaction
+ * @param[in] priority      scheduling priority, higher first
+ * @param[in] deadline      time from now the transfer should start by or
+ *                          @p TIME_INFINITE
+ *
+ * @iclass
+ */
+void i2cschedSubmitI(I2CSchedDriver* i2cschedp, I2CTransaction* tp,
+        uint8_t priority, sysinterval_t deadline)
+{
+    osalDbgCheckClassI();
+    osalDbgCheck((i2cschedp != NULL) && (tp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(i2cschedp->state == I2C_SCHED_READY, "invalid state");
+
+    tp->priority = priority;
+    tp->has_deadline = (deadline != TIME_INFINITE);
+    tp->deadline = osalOsGetSystemTimeX() + deadline;
+    tp->thread = NULL;
+    tp->result = MSG_RESET;
+    tp->done = false;
+
+    /* Insert behind all transactions not scheduled after it. */
+    I2CTransaction** pp = &i2cschedp->queue;
+    while (*pp != NULL && !transaction_before(tp, *pp))
+        pp = &(*pp)->next;
+    tp->next = *pp;
+    *pp = tp;
+
+    osalThreadResumeI(&i2cschedp->wait, MSG_OK);
+}
+
+/**
+ * @brief   Queues a transaction and waits for it to complete.
+ *
+ * @param[in] i2cschedp     pointer to the @p I2CSchedDriver object
+ * @param[in] tp            pointer to an initialized @p I2CTransaction
+ * @param[in] priority      scheduling priority, higher first
+ * @param[in] deadline      time from now the transfer should start by or
+ *                          @p TIME_INFINITE
+ *
+ * @return                  The result of @p i2cMasterTransmitTimeout().
+ *
+ * @api
+ */
+msg_t i2cschedTransfer(I2CSchedDriver* i2cschedp, I2CTransaction* tp,
+        uint8_t priority, sysinterval_t deadline)
+{
+    i2cschedSubmit(i2cschedp, tp, priority, deadline);
+
+    return i2cTransactionWait(tp);
+}
+
+/**
+ * @brief   Initializes a transaction.
+ *
+ * @param[out] tp       pointer to the @p I2CTransaction object
+ * @param[in] addr      slave address, 7 bits right aligned
+ * @param[in] txbuf     bytes to transmit or @p NULL
+ * @param[in] txbytes   number of bytes to transmit
+ * @param[in] rxbuf     buffer for received bytes or @p NULL
+ * @param[in] rxbytes   number of bytes to receive
+ * @param[in] timeout   bus timeout of the transfer
+ * @param[in] callback  completion callback or @p NULL
+ * @param[in] arg       callback argument
+ *
+ * @init
+ */
+void i2cTransactionInit(I2CTransaction* tp, i2caddr_t addr,
+        const uint8_t* txbuf, size_t txbytes, uint8_t* rxbuf,
+        size_t rxbytes, sysinterval_t timeout,
+        i2ctransactioncb_t callback, void* arg)
+{
+    osalDbgCheck(tp != NULL);
+    osalDbgCheck((txbytes > 0) || (rxbytes > 0));
+
+    tp->addr = addr;
+    tp->txbuf = txbuf;
+    tp->txbytes = txbytes;
+    tp->rxbuf = rxbuf;
+    tp->rxbytes = rxbytes;
+    tp->timeout = timeout;
+    tp->callback = callback;
+    tp->arg = arg;
+    tp->priority = 0;
+    tp->has_deadline = false;
+    tp->deadline = 0;
+    tp->next = NULL;
+    tp->thread = NULL;
+    tp->result = MSG_RESET;
+    tp->done = false;
+}
+
+/**
+ * @brief   Waits for a transaction to complete.
+ *
+ * @param[in] tp        pointer to a submitted @p I2CTransaction object
+ *
+ * @return              The result of @p i2cMasterTransmitTimeout().
+ *
+ * @api
+ */
+msg_t i2cTransactionWait(I2CTransaction* tp)
+{
+    osalDbgCheck(tp != NULL);
+
+    osalSysLock();
+    if (tp->done == false)
+        osalThreadSuspendS(&tp->thread);
+    osalSysUnlock();
+
+    return tp->result;
+}
+
+#endif /* HAL_USE_I2C_SCHED */
+
+/** @} */
@@ -0,0 +1,278 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qio_nvm.c
+ * @brief   I/O non volatile memory devices generic code.
+ *
+ * @addtogroup IO_NVM
+ * @{
+ */
+
+#include "qhal.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes the fields common to all requests.
+ *
+ * @notapi
+ */
+static void nvm_request_init(NVMRequest* reqp, nvmrequestop_t op,
+        uint32_t startaddr, uint32_t n, nvmrequestcb_t callback, void* arg)
+{
+    reqp->op = op;
+    reqp->startaddr = startaddr;
+    reqp->n = n;
+    reqp->callback = callback;
+    reqp->arg = arg;
+    reqp->nvmp = NULL;
+    reqp->next = NULL;
+    reqp->thread = NULL;
+    reqp->result = HAL_FAILED;
+    reqp->done = false;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Reads multiple segments using individual reads.
+ *
+ * @param[in] nvmp      pointer to a @p BaseNVMDevice or derived class
+ * @param[in] segp      pointer to an array of @p NVMReadSegment
+ * @param[in] segn      number of segments
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool nvmGenericReadv(BaseNVMDevice* nvmp, const NVMReadSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmp != NULL) && (segp != NULL || segn == 0));
+
+    for (uint32_t i = 0; i < segn; ++i)
+    {
+        bool result = nvmRead(nvmp, segp[i].startaddr, segp[i].n,
+                segp[i].buffer);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes multiple segments using individual writes.
+ *
+ * @param[in] nvmp      pointer to a @p BaseNVMDevice or derived class
+ * @param[in] segp      pointer to an array of @p NVMWriteSegment
+ * @param[in] segn      number of segments
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool nvmGenericWritev(BaseNVMDevice* nvmp, const NVMWriteSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmp != NULL) && (segp != NULL || segn == 0));
+
+    for (uint32_t i = 0; i < segn; ++i)
+    {
+        bool result = nvmWrite(nvmp, segp[i].startaddr, segp[i].n,
+                segp[i].buffer);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Checks whether a range is erased using reads.
+ *
+ * @param[in] nvmp      pointer to a @p BaseNVMDevice or derived class
+ * @param[in] startaddr first address to check
+ * @param[in] n         number of bytes to check
+ * @param[out] erasedp  set to @p true if all bytes are erased
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool nvmGenericIsErased(BaseNVMDevice* nvmp, uint32_t startaddr,
+        uint32_t n, bool* erasedp)
+{
+    osalDbgCheck((nvmp != NULL) && (erasedp != NULL));
+
+    uint8_t buffer[NVM_BLANK_CHECK_BUFFER_SIZE];
+
+    *erasedp = false;
+
+    for (uint32_t offset = 0; offset < n;
+            offset += NVM_BLANK_CHECK_BUFFER_SIZE)
+    {
+        const uint32_t chunk = (n - offset < NVM_BLANK_CHECK_BUFFER_SIZE) ?
+                n - offset : NVM_BLANK_CHECK_BUFFER_SIZE;
+
+        bool result = nvmRead(nvmp, startaddr + offset, chunk, buffer);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        for (uint32_t i = 0; i < chunk; ++i)
+            if (buffer[i] != 0xff)
+                return HAL_SUCCESS;
+    }
+
+    *erasedp = true;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Initializes a read request.
+ *
+ * @param[out] reqp     pointer to the @p NVMRequest object
+ * @param[in] startaddr first address to read
+ * @param[in] n         number of bytes to read
+ * @param[out] buffer   pointer to the read buffer
+ * @param[in] callback  completion callback or @p NULL
+ * @param[in] arg       callback argument
+ *
+ * @init
+ */
+void nvmRequestReadInit(NVMRequest* reqp, uint32_t startaddr, uint32_t n,
+        uint8_t* buffer, nvmrequestcb_t callback, void* arg)
+{
+    osalDbgCheck((reqp != NULL) && (buffer != NULL || n == 0));
+
+    nvm_request_init(reqp, NVM_REQUEST_READ, startaddr, n, callback, arg);
+    reqp->buffer.read = buffer;
+}
+
+/**
+ * @brief   Initializes a write request.
+ *
+ * @param[out] reqp     pointer to the @p NVMRequest object
+ * @param[in] startaddr first address to write
+ * @param[in] n         number of bytes to write
+ * @param[in] buffer    pointer to the write buffer
+ * @param[in] callback  completion callback or @p NULL
+ * @param[in] arg       callback argument
+ *
+ * @init
+ */
+void nvmRequestWriteInit(NVMRequest* reqp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer, nvmrequestcb_t callback,
+        void* arg)
+{
+    osalDbgCheck((reqp != NULL) && (buffer != NULL || n == 0));
+
+    nvm_request_init(reqp, NVM_REQUEST_WRITE, startaddr, n, callback, arg);
+    reqp->buffer.write = buffer;
+}
+
+/**
+ * @brief   Initializes an erase request.
+ *
+ * @param[out] reqp     pointer to the @p NVMRequest object
+ * @param[in] startaddr address within the first sector to erase
+ * @param[in] n         number of bytes to erase
+ * @param[in] callback  completion callback or @p NULL
+ * @param[in] arg       callback argument
+ *
+ * @init
+ */
+void nvmRequestEraseInit(NVMRequest* reqp, uint32_t startaddr,
+        uint32_t n, nvmrequestcb_t callback, void* arg)
+{
+    osalDbgCheck(reqp != NULL);
+
+    nvm_request_init(reqp, NVM_REQUEST_ERASE, startaddr, n, callback, arg);
+    reqp->buffer.write = NULL;
+}
+
+/**
+ * @brief   Signals completion of a request.
+ * @details Stores the result, invokes the callback and wakes up a thread
+ *          waiting in @p nvmRequestWait(). To be used by drivers serving
+ *          requests.
+ *
+ * @param[in] reqp      pointer to the @p NVMRequest object
+ * @param[in] result    operation result
+ *
+ * @iclass
+ */
+void nvmRequestCompleteI(NVMRequest* reqp, bool result)
+{
+    osalDbgCheckClassI();
+    osalDbgCheck(reqp != NULL);
+    osalDbgAssert(reqp->done == false, "already completed");
+
+    reqp->result = result;
+    reqp->done = true;
+
+    if (reqp->callback != NULL)
+        reqp->callback(reqp);
+
+    osalThreadResumeI(&reqp->thread, MSG_OK);
+}
+
+/**
+ * @brief   Waits for a request to complete.
+ *
+ * @param[in] reqp      pointer to a started @p NVMRequest object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool nvmRequestWait(NVMRequest* reqp)
+{
+    osalDbgCheck(reqp != NULL);
+
+    osalSysLock();
+    if (reqp->done == false)
+        osalThreadSuspendS(&reqp->thread);
+    osalSysUnlock();
+
+    return reqp->result;
+}
+
+/** @} */
@@ -0,0 +1,371 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qled_group.c
+ * @brief   Driver for groups of LEDs sharing one pattern timer.
+ * @details A single engine steps the patterns and software PWM of all LEDs
+ *          of a group, so the kernel timer list holds one timer per group
+ *          instead of one per blinking LED. The timer is only armed while
+ *          a LED plays a pattern or is dimmed.
+ *
+ * @addtogroup LED_GROUP
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_LED_GROUP || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static void led_drive(const LedConfig* ledcp, ledchannel_t* chp, bool lit)
+{
+    if (chp->lit == lit)
+        return;
+
+    chp->lit = lit;
+
+    if ((ledcp->drive == LED_ACTIVE_HIGH) == lit)
+        palSetPad(ledcp->ledport, ledcp->ledpad);
+    else
+        palClearPad(ledcp->ledport, ledcp->ledpad);
+}
+
+/**
+ * @brief   Returns whether a channel needs engine ticks.
+ */
+static bool channel_active(const ledchannel_t* chp)
+{
+    return (chp->pattern != NULL) ||
+            ((chp->level > 0) && (chp->level < LED_GROUP_PWM_LEVELS));
+}
+
+/**
+ * @brief   Advances the pattern of a channel by one tick.
+ */
+static void channel_step(ledchannel_t* chp)
+{
+    const LedPattern* pattern = chp->pattern;
+
+    if (pattern == NULL || --chp->remaining > 0)
+        return;
+
+    if (++chp->step >= pattern->n)
+    {
+        chp->step = 0;
+
+        if (chp->loop > 0 && --chp->loop == 0)
+        {
+            chp->pattern = NULL;
+            chp->level = 0;
+            return;
+        }
+    }
+
+    chp->level = pattern->steps[chp->step].level;
+    chp->remaining = pattern->steps[chp->step].ticks;
+}
+
+/**
+ * @brief   Steps all channels and updates the pins.
+ *
+ * @return              Whether further ticks are needed.
+ */
+static bool group_step(LedGroupDriver* lgp)
+{
+    const LedGroupConfig* config = lgp->config;
+    bool active = false;
+
+    if (++lgp->phase >= LED_GROUP_PWM_LEVELS)
+        lgp->phase = 0;
+
+    for (uint16_t i = 0; i < config->n; ++i)
+    {
+        ledchannel_t* chp = &config->channels[i];
+
+        channel_step(chp);
+        led_drive(&config->leds[i], chp, chp->level > lgp->phase);
+
+        if (channel_active(chp))
+            active = true;
+    }
+
+    return active;
+}
+
+static void group_timer_cb(void *par)
+{
+    LedGroupDriver* lgp = (LedGroupDriver*)par;
+
+    osalSysLockFromISR();
+
+    if (lgp->state == LED_GROUP_READY && group_step(lgp))
+        chVTSetI(&lgp->vt, lgp->config->interval, group_timer_cb, lgp);
+
+    osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Applies a changed channel and arms the engine timer if needed.
+ */
+static void channel_update(LedGroupDriver* lgp, uint16_t index)
+{
+    ledchannel_t* chp = &lgp->config->channels[index];
+
+    led_drive(&lgp->config->leds[index], chp, chp->level > lgp->phase);
+
+    if (channel_active(chp) && lgp->config->interval != TIME_IMMEDIATE &&
+            !chVTIsArmedI(&lgp->vt))
+        chVTSetI(&lgp->vt, lgp->config->interval, group_timer_cb, lgp);
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   LED group driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void ledgroupInit(void)
+{
+}
+
+/**
+ * @brief   Initializes a generic driver object.
+ *
+ * @param[out] lgp      pointer to a @p LedGroupDriver structure
+ *
+ * @init
+ */
+void ledgroupObjectInit(LedGroupDriver* lgp)
+{
+    osalDbgCheck(lgp != NULL);
+
+    lgp->state = LED_GROUP_STOP;
+    lgp->config = NULL;
+    lgp->phase = 0;
+    chVTObjectInit(&lgp->vt);
+}
+
+/**
+ * @brief   Configures and starts the driver.
+ * @details All LEDs of the group are switched off.
+ *
+ * @param[in] lgp       pointer to a @p LedGroupDriver object
+ * @param[in] config    led group driver configuration
+ *
+ * @api
+ */
+void ledgroupStart(LedGroupDriver* lgp, const LedGroupConfig* config)
+{
+    osalDbgCheck(lgp != NULL);
+    osalDbgCheck(config != NULL);
+    osalDbgCheck(config->leds != NULL && config->channels != NULL);
+
+    osalSysLock();
+
+    osalDbgAssert((lgp->state == LED_GROUP_STOP) ||
+            (lgp->state == LED_GROUP_READY), "invalid state");
+
+    chVTResetI(&lgp->vt);
+
+    lgp->config = config;
+    lgp->phase = 0;
+
+    for (uint16_t i = 0; i < config->n; ++i)
+    {
+        ledchannel_t* chp = &config->channels[i];
+
+        chp->pattern = NULL;
+        chp->level = 0;
+        /* Forces the pin to be driven. */
+        chp->lit = true;
+        led_drive(&config->leds[i], chp, false);
+    }
+
+    lgp->state = LED_GROUP_READY;
+
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Stops the driver.
+ * @details All LEDs of the group are switched off.
+ *
+ * @param[in] lgp       pointer to a @p LedGroupDriver object
+ *
+ * @api
+ */
+void ledgroupStop(LedGroupDriver* lgp)
+{
+    osalDbgCheck(lgp != NULL);
+
+    osalSysLock();
+
+    osalDbgAssert((lgp->state == LED_GROUP_STOP) ||
+            (lgp->state == LED_GROUP_READY), "invalid state");
+
+    /* Reset engine timer in case it is armed. */
+    chVTResetI(&lgp->vt);
+
+    if (lgp->state == LED_GROUP_READY)
+    {
+        for (uint16_t i = 0; i < lgp->config->n; ++i)
+            led_drive(&lgp->config->leds[i], &lgp->config->channels[i],
+                    false);
+    }
+
+    /* Driver in stopped state. */
+    lgp->state = LED_GROUP_STOP;
+
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Sets a LED to a constant brightness.
+ * @details A pattern played by the LED is cancelled.
+ *
+ * @param[in] lgp       pointer to a @p LedGroupDriver object
+ * @param[in] index     LED index within the group
+ * @param[in] level     brightness, 0 to @p LED_GROUP_PWM_LEVELS
+ *
+ * @api
+ */
+void ledgroupSet(LedGroupDriver* lgp, uint16_t index, uint8_t level)
+{
+    osalSysLock();
+    ledgroupSetI(lgp, index, level);
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Sets a LED to a constant brightness.
+ * @details A pattern played by the LED is cancelled.
+ *
+ * @param[in] lgp       pointer to a @p LedGroupDriver object
+ * @param[in] index     LED index within the group
+ * @param[in] level     brightness, 0 to @p LED_GROUP_PWM_LEVELS
+ *
+ * @iclass
+ */
+void ledgroupSetI(LedGroupDriver* lgp, uint16_t index, uint8_t level)
+{
+    osalDbgCheck(lgp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(lgp->state >= LED_GROUP_READY, "invalid state");
+    /* Verify parameters. */
+    osalDbgAssert(index < lgp->config->n && level <= LED_GROUP_PWM_LEVELS,
+            "invalid parameters");
+
+    ledchannel_t* chp = &lgp->config->channels[index];
+
+    chp->pattern = NULL;
+    chp->level = level;
+
+    channel_update(lgp, index);
+}
+
+/**
+ * @brief   Plays a pattern on a LED.
+ * @details The first step starts immediately.
+ *
+ * @param[in] lgp       pointer to a @p LedGroupDriver object
+ * @param[in] index     LED index within the group
+ * @param[in] pattern   pattern to play, must stay valid while played
+ *
+ * @api
+ */
+void ledgroupPattern(LedGroupDriver* lgp, uint16_t index,
+        const LedPattern* pattern)
+{
+    osalSysLock();
+    ledgroupPatternI(lgp, index, pattern);
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Plays a pattern on a LED.
+ * @details The first step starts immediately.
+ *
+ * @param[in] lgp       pointer to a @p LedGroupDriver object
+ * @param[in] index     LED index within the group
+ * @param[in] pattern   pattern to play, must stay valid while played
+ *
+ * @iclass
+ */
+void ledgroupPatternI(LedGroupDriver* lgp, uint16_t index,
+        const LedPattern* pattern)
+{
+    osalDbgCheck(lgp != NULL);
+    osalDbgCheck(pattern != NULL && pattern->steps != NULL);
+    /* Verify device status. */
+    osalDbgAssert(lgp->state >= LED_GROUP_READY, "invalid state");
+    /* Verify parameters. */
+    osalDbgAssert(index < lgp->config->n && pattern->n > 0,
+            "invalid parameters");
+
+    ledchannel_t* chp = &lgp->config->channels[index];
+
+    chp->pattern = pattern;
+    chp->loop = pattern->loop <= 0 ? -1 : pattern->loop;
+    chp->step = 0;
+    chp->level = pattern->steps[0].level;
+    chp->remaining = pattern->steps[0].ticks;
+
+    channel_update(lgp, index);
+}
+
+/**
+ * @brief   Advances the engine by one tick.
+ * @details Only used with an interval of @p TIME_IMMEDIATE, where it is
+ *          called periodically by the application, e.g. from a hardware
+ *          timer callback.
+ *
+ * @param[in] lgp       pointer to a @p LedGroupDriver object
+ *
+ * @iclass
+ */
+void ledgroupTickI(LedGroupDriver* lgp)
+{
+    osalDbgCheckClassI();
+    osalDbgCheck(lgp != NULL);
+    osalDbgAssert(lgp->state != LED_GROUP_READY ||
+            lgp->config->interval == TIME_IMMEDIATE, "internal timer used");
+
+    if (lgp->state == LED_GROUP_READY)
+        (void)group_step(lgp);
+}
+
+#endif /* HAL_USE_LED_GROUP */
+
+/** @} */
@@ -66,10 +66,252 @@ enum
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+#if MS58XX_USE_SEQUENCER || defined(__DOXYGEN__)
+/**
+ * @brief   Maximum conversion time in microseconds, indexed by osr / 2.
+ */
+static const uint16_t conversion_us[] = { 600, 1170, 2280, 4540, 9040, 18080 };
+#endif /* MS58XX_USE_SEQUENCER */
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+static msg_t ms58xx_command(MS58XXDriver* ms58xxp, uint8_t command)
+{
+    const uint8_t txbuf[] = { command };
+
+    return i2cMasterTransmitTimeout(ms58xxp->configp->i2cp,
+            ms58xxp->configp->i2c_address >> 1,
+            txbuf,
+            sizeof(txbuf),
+            NULL,
+            0,
+            ms58xxp->configp->i2c_timeout);
+}
+
+static msg_t ms58xx_read_adc(MS58XXDriver* ms58xxp, uint32_t* valuep)
+{
+    const uint8_t txbuf[] = { MS58XX_COMMAND_READ_ADC };
+    uint8_t rxbuf[] = { 0x00, 0x00, 0x00 };
+
+    msg_t result;
+    result = i2cMasterTransmitTimeout(ms58xxp->configp->i2cp,
+            ms58xxp->configp->i2c_address >> 1,
+            txbuf,
+            sizeof(txbuf),
+            rxbuf,
+            sizeof(rxbuf),
+            ms58xxp->configp->i2c_timeout);
+
+    if (result == MSG_OK)
+        *valuep = (rxbuf[0] << 16) | (rxbuf[1] << 8) | (rxbuf[2] << 0);
+
+    return result;
+}
+
+/**
+ * @brief   Compensated temperature in degree C * 100 of the last readings.
+ */
+static int32_t ms58xx_temperature(const MS58XXDriver* ms58xxp)
+{
+    /* dT is the difference between current adc value and
+     * adc value at factory calibration (20 degree celsius). */
+    int32_t dT = (int32_t)ms58xxp->last_d2 -
+            ((int32_t)ms58xxp->calibration[MS58XX_CAL_5_TREF] << 8);
+
+    /* TEMP is the temperature in degree celsius * 100. */
+    int32_t TEMP = 2000 +
+            (((int64_t)dT * ms58xxp->calibration[MS58XX_CAL_6_TEMPSENS]) >> 23);
+
+    /* Apply second order temperature compensation. */
+    if (TEMP < 2000)
+    {
+        int32_t T2 = ((int64_t)3 * dT * dT) >> 33;
+        TEMP -= T2;
+    }
+    else
+    {
+        int32_t T2 = ((int64_t)7 * dT * dT) >> 37;
+        TEMP -= T2;
+    }
+
+    return TEMP;
+}
+
+/**
+ * @brief   Compensated pressure in bar * 10000 of the last readings.
+ */
+static int32_t ms58xx_pressure(const MS58XXDriver* ms58xxp)
+{
+    /* dT is the difference between current adc value and
+     * adc value at factory calibration (20 degree celsius). */
+    int32_t dT = (int32_t)ms58xxp->last_d2 -
+            ((int32_t)ms58xxp->calibration[MS58XX_CAL_5_TREF] << 8);
+
+    /* TEMP is the temperature in degree celsius * 100. */
+    int32_t TEMP = 2000 +
+            (((int64_t)dT * ms58xxp->calibration[MS58XX_CAL_6_TEMPSENS]) >> 23);
+
+    /* OFF is pressure adc offset at the current temperature. */
+    int64_t OFF = ((int64_t)ms58xxp->calibration[MS58XX_CAL_2_OFFT1] << 16) +
+            (((int64_t)ms58xxp->calibration[MS58XX_CAL_4_TCO] * dT) >> 7);
+
+    /* SENS is pressure adc sensitivity at the current temperature. */
+    int64_t SENS = ((int64_t)ms58xxp->calibration[MS58XX_CAL_1_SENST1] << 15) +
+            (((int64_t)ms58xxp->calibration[MS58XX_CAL_3_TCS] * dT) >> 8);
+
+    /* Apply second order temperature compensation. */
+    if (TEMP < 2000)
+    {
+        int64_t OFF2 = (3 * (TEMP - 2000) * (TEMP - 2000)) >> 1;
+        int64_t SENS2 = (5 * (TEMP - 2000) * (TEMP - 2000)) >> 3;
+
+        if (TEMP < -1500)
+        {
+            OFF2 += 7 * (TEMP + 1500) * (TEMP + 1500);
+            SENS2 += 4 * (TEMP + 1500) * (TEMP + 1500);
+        }
+
+        OFF -= OFF2;
+        SENS -= SENS2;
+    }
+    else
+    {
+        int64_t OFF2 = (1 * (TEMP - 2000) * (TEMP - 2000)) >> 4;
+
+        OFF -= OFF2;
+    }
+
+    /* P is the pressure in bar * 10000. */
+    return (((ms58xxp->last_d1 * SENS) >> 21) - OFF) >> 13;
+}
+
+#if MS58XX_USE_SEQUENCER || defined(__DOXYGEN__)
+static void ms58xx_timer_cb(void *par)
+{
+    MS58XXDriver* ms58xxp = (MS58XXDriver*)par;
+
+    osalSysLockFromISR();
+    osalThreadResumeI(&ms58xxp->wait, MSG_OK);
+    osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Runs a conversion and reads its result.
+ * @details The thread sleeps for the conversion time of the oversampling,
+ *          even after a failed transfer, so errors do not spin the bus.
+ */
+static msg_t ms58xx_convert(MS58XXDriver* ms58xxp, uint8_t command,
+        uint32_t* valuep)
+{
+    I2CDriver* i2cp = ms58xxp->configp->i2cp;
+    msg_t result;
+
+#if I2C_USE_MUTUAL_EXCLUSION
+    i2cAcquireBus(i2cp);
+#endif /* I2C_USE_MUTUAL_EXCLUSION */
+    result = ms58xx_command(ms58xxp, command + ms58xxp->osr);
+#if I2C_USE_MUTUAL_EXCLUSION
+    i2cReleaseBus(i2cp);
+#endif /* I2C_USE_MUTUAL_EXCLUSION */
+
+    /* The extra tick covers the already elapsed part of the current one. */
+    osalSysLock();
+    chVTSetI(&ms58xxp->vt, TIME_US2I(conversion_us[ms58xxp->osr >> 1]) + 1,
+            ms58xx_timer_cb, ms58xxp);
+    osalThreadSuspendS(&ms58xxp->wait);
+    osalSysUnlock();
+
+    if (result != MSG_OK)
+        return result;
+
+#if I2C_USE_MUTUAL_EXCLUSION
+    i2cAcquireBus(i2cp);
+#endif /* I2C_USE_MUTUAL_EXCLUSION */
+    result = ms58xx_read_adc(ms58xxp, valuep);
+#if I2C_USE_MUTUAL_EXCLUSION
+    i2cReleaseBus(i2cp);
+#endif /* I2C_USE_MUTUAL_EXCLUSION */
+
+    return result;
+}
+
+/**
+ * @brief   Sequencer thread converting and publishing samples.
+ */
+static void ms58xx_sequencer(void* parameters)
+{
+    MS58XXDriver* ms58xxp = (MS58XXDriver*)parameters;
+    uint16_t countdown = 0;
+    uint16_t decimated = 0;
+    int64_t temperature_sum = 0;
+    int64_t pressure_sum = 0;
+
+    chRegSetThreadName("ms58xx");
+
+    while (true)
+    {
+        /* Stopped, report it and wait for the next start. */
+        osalSysLock();
+        while (!ms58xxp->running)
+        {
+            ms58xxp->state = MS58XX_READY;
+            osalThreadResumeI(&ms58xxp->stopper, MSG_OK);
+            osalThreadSuspendS(&ms58xxp->wait);
+            countdown = 0;
+            decimated = 0;
+            temperature_sum = 0;
+            pressure_sum = 0;
+        }
+        osalSysUnlock();
+
+        /* Temperature changes slowly, refresh it at a reduced rate. */
+        if (countdown == 0)
+        {
+            if (ms58xx_convert(ms58xxp, MS58XX_COMMAND_ACQUIRE_D2,
+                    &ms58xxp->last_d2) != MSG_OK)
+            {
+                ++ms58xxp->errors;
+                continue;
+            }
+            countdown = ms58xxp->temperature_divider;
+        }
+
+        if (ms58xx_convert(ms58xxp, MS58XX_COMMAND_ACQUIRE_D1,
+                &ms58xxp->last_d1) != MSG_OK)
+        {
+            ++ms58xxp->errors;
+            continue;
+        }
+        --countdown;
+
+        /* Average blocks of conversions, a first order CIC decimator. */
+        temperature_sum += ms58xx_temperature(ms58xxp);
+        pressure_sum += ms58xx_pressure(ms58xxp);
+        if (++decimated < ms58xxp->decimation)
+            continue;
+
+        ms58xxsample_t sample;
+        sample.temperature = temperature_sum / decimated;
+        sample.pressure = pressure_sum / decimated;
+        sample.timestamp = osalOsGetSystemTimeX();
+
+        decimated = 0;
+        temperature_sum = 0;
+        pressure_sum = 0;
+
+        osalSysLock();
+        sample.sequence = ++ms58xxp->ring_head;
+        ms58xxp->ring[(sample.sequence - 1) % MS58XX_SEQUENCER_RING_SIZE] =
+                sample;
+        osalEventBroadcastFlagsI(&ms58xxp->event, MS58XX_EVENT_SAMPLE);
+        osalOsRescheduleS();
+        osalSysUnlock();
+    }
+}
+#endif /* MS58XX_USE_SEQUENCER */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -102,6 +344,26 @@ void ms58xxObjectInit(MS58XXDriver* ms58xxp)
 #if MS58XX_USE_MUTUAL_EXCLUSION
     osalMutexObjectInit(&ms58xxp->mutex);
 #endif /* MS58XX_USE_MUTUAL_EXCLUSION */
+#if MS58XX_USE_SEQUENCER
+    ms58xxp->tr = NULL;
+    ms58xxp->wait = NULL;
+    ms58xxp->stopper = NULL;
+    ms58xxp->running = false;
+    ms58xxp->ring_head = 0;
+    ms58xxp->errors = 0;
+    chVTObjectInit(&ms58xxp->vt);
+    osalEventObjectInit(&ms58xxp->event);
+
+    /* Filling the thread working area here because the function
+       @p chThdCreateI() does not do it.*/
+#if CH_DBG_FILL_THREADS
+    {
+        _thread_memfill((uint8_t*)THD_WORKING_AREA_BASE(ms58xxp->wa),
+            (uint8_t*)THD_WORKING_AREA_END(ms58xxp->wa),
+            CH_DBG_STACK_FILL_VALUE);
+    }
+#endif /* CH_DBG_FILL_THREADS */
+#endif /* MS58XX_USE_SEQUENCER */
 }
 
 /**
@@ -322,18 +584,7 @@ bool ms58xxTemperatureStart(MS58XXDriver* ms58xxp, enum ms58xx_osr_e osr)
     ms58xxp->state = MS58XX_ACTIVE;
 
     /* Initiate temperature conversion. */
-    const uint8_t txbuf[] = { MS58XX_COMMAND_ACQUIRE_D2 + osr };
-
-    msg_t result;
-    result = i2cMasterTransmitTimeout(ms58xxp->configp->i2cp,
-            ms58xxp->configp->i2c_address >> 1,
-            txbuf,
-            sizeof(txbuf),
-            NULL,
-            0,
-            ms58xxp->configp->i2c_timeout);
-
-    if (result != MSG_OK)
+    if (ms58xx_command(ms58xxp, MS58XX_COMMAND_ACQUIRE_D2 + osr) != MSG_OK)
         return HAL_FAILED;
 
     return HAL_SUCCESS;
@@ -353,61 +604,46 @@ bool ms58xxTemperatureStart(MS58XXDriver* ms58xxp, enum ms58xx_osr_e osr)
  */
 bool ms58xxTemperatureResult(MS58XXDriver* ms58xxp, float *resultp)
 {
-    osalDbgCheck(ms58xxp != NULL);
-    /* Verify device status. */
-    osalDbgAssert(ms58xxp->state == MS58XX_ACTIVE, "invalid state");
+    int32_t temperature;
 
-    /* Read result from chip. */
-    {
-        const uint8_t txbuf[] = { MS58XX_COMMAND_READ_ADC };
-        uint8_t rxbuf[] = { 0x00, 0x00, 0x00 };
+    if (ms58xxTemperatureResultInt(ms58xxp, &temperature) != HAL_SUCCESS)
+        return HAL_FAILED;
 
-        msg_t result;
-        result = i2cMasterTransmitTimeout(ms58xxp->configp->i2cp,
-                ms58xxp->configp->i2c_address >> 1,
-                txbuf,
-                sizeof(txbuf),
-                rxbuf,
-                sizeof(rxbuf),
-                ms58xxp->configp->i2c_timeout);
+    if (resultp != NULL)
+        *resultp = temperature / 100.0f;
 
-        if (result != MSG_OK)
-        {
-            /* Reset driver state. */
-            ms58xxp->state = MS58XX_READY;
+    return HAL_SUCCESS;
+}
 
-            return HAL_FAILED;
-        }
+/**
+ * @brief   Finishes a temperature conversion without floating point.
+ *
+ * @param[in] ms58xxp   pointer to the @p MS58XXDriver object
+ * @param[out] resultp  pointer to temperature result in degree C * 100
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool ms58xxTemperatureResultInt(MS58XXDriver* ms58xxp, int32_t *resultp)
+{
+    osalDbgCheck(ms58xxp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(ms58xxp->state == MS58XX_ACTIVE, "invalid state");
 
-        ms58xxp->last_d2 = (rxbuf[0] << 16) | (rxbuf[1] << 8) | (rxbuf[2] << 0);
-    }
+    /* Read result from chip. */
+    msg_t result = ms58xx_read_adc(ms58xxp, &ms58xxp->last_d2);
 
     /* Reset driver state. */
     ms58xxp->state = MS58XX_READY;
 
-    /* dT is the difference between current adc value and
-     * adc value at factory calibration (20 degree celsius). */
-    int32_t dT = (int32_t)ms58xxp->last_d2 -
-            ((int32_t)ms58xxp->calibration[MS58XX_CAL_5_TREF] << 8);
-
-    /* TEMP is the temperature in degree celsius * 100. */
-    int32_t TEMP = 2000 +
-            (((int64_t)dT * ms58xxp->calibration[MS58XX_CAL_6_TEMPSENS]) >> 23);
-
-    /* Apply second order temperature compensation. */
-    if (TEMP < 2000)
-    {
-        int32_t T2 = ((int64_t)3 * dT * dT) >> 33;
-        TEMP -= T2;
-    }
-    else
-    {
-        int32_t T2 = ((int64_t)7 * dT * dT) >> 37;
-        TEMP -= T2;
-    }
+    if (result != MSG_OK)
+        return HAL_FAILED;
 
     if (resultp != NULL)
-        *resultp = TEMP / 100.0f;
+        *resultp = ms58xx_temperature(ms58xxp);
 
     return HAL_SUCCESS;
 }
@@ -433,18 +669,7 @@ bool ms58xxPressureStart(MS58XXDriver* ms58xxp, enum ms58xx_osr_e osr)
     ms58xxp->state = MS58XX_ACTIVE;
 
     /* Initiate pressure conversion. */
-    const uint8_t txbuf[] = { MS58XX_COMMAND_ACQUIRE_D1 + osr };
-
-    msg_t result;
-    result = i2cMasterTransmitTimeout(ms58xxp->configp->i2cp,
-            ms58xxp->configp->i2c_address >> 1,
-            txbuf,
-            sizeof(txbuf),
-            NULL,
-            0,
-            ms58xxp->configp->i2c_timeout);
-
-    if (result != MSG_OK)
+    if (ms58xx_command(ms58xxp, MS58XX_COMMAND_ACQUIRE_D1 + osr) != MSG_OK)
         return HAL_FAILED;
 
     return HAL_SUCCESS;
@@ -463,86 +688,224 @@ bool ms58xxPressureStart(MS58XXDriver* ms58xxp, enum ms58xx_osr_e osr)
  * @api
  */
 bool ms58xxPressureResult(MS58XXDriver* ms58xxp, float *resultp)
+{
+    int32_t pressure;
+
+    if (ms58xxPressureResultInt(ms58xxp, &pressure) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    if (resultp != NULL)
+        *resultp = pressure / 10000.0f;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Finishes a pressure conversion without floating point.
+ *
+ * @param[in] ms58xxp   pointer to the @p MS58XXDriver object
+ * @param[out] resultp  pointer to pressure result in bar * 10000
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool ms58xxPressureResultInt(MS58XXDriver* ms58xxp, int32_t *resultp)
 {
     osalDbgCheck(ms58xxp != NULL);
     /* Verify device status. */
     osalDbgAssert(ms58xxp->state == MS58XX_ACTIVE, "invalid state");
 
     /* Read result from chip. */
-    {
-        const uint8_t txbuf[] = { MS58XX_COMMAND_READ_ADC };
-        uint8_t rxbuf[] = { 0x00, 0x00, 0x00 };
+    msg_t result = ms58xx_read_adc(ms58xxp, &ms58xxp->last_d1);
 
-        msg_t result;
-        result = i2cMasterTransmitTimeout(ms58xxp->configp->i2cp,
-                ms58xxp->configp->i2c_address >> 1,
-                txbuf,
-                sizeof(txbuf),
-                rxbuf,
-                sizeof(rxbuf),
-                ms58xxp->configp->i2c_timeout);
+    /* Reset driver state. */
+    ms58xxp->state = MS58XX_READY;
 
-        if (result != MSG_OK)
-        {
-            /* Reset driver state. */
-            ms58xxp->state = MS58XX_READY;
+    if (result != MSG_OK)
+        return HAL_FAILED;
 
-            return HAL_FAILED;
-        }
+    if (resultp != NULL)
+        *resultp = ms58xx_pressure(ms58xxp);
+
+    return HAL_SUCCESS;
+}
+
+#if MS58XX_USE_SEQUENCER || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the measurement sequencer.
+ * @details The sequencer thread converts pressure back to back and
+ *          temperature once every @p temperature_divider pressure
+ *          conversions, waiting on a timer sized to @p osr. The compensated
+ *          results of @p decimation pressure conversions are averaged into
+ *          a timestamped sample, published for @p ms58xxSampleGet() and
+ *          @p ms58xxSamplesRead() and announced with
+ *          @p MS58XX_EVENT_SAMPLE. The conversion APIs must not be used
+ *          while the sequencer runs.
+ *
+ * @param[in] ms58xxp   pointer to the @p MS58XXDriver object
+ * @param[in] osr       oversampling of all conversions
+ * @param[in] temperature_divider   pressure conversions per temperature
+ *                      conversion, at least 1
+ * @param[in] decimation    pressure conversions per sample, at least 1
+ *
+ * @api
+ */
+void ms58xxSequencerStart(MS58XXDriver* ms58xxp, enum ms58xx_osr_e osr,
+        uint16_t temperature_divider, uint16_t decimation)
+{
+    osalDbgCheck(ms58xxp != NULL);
+    osalDbgCheck(temperature_divider > 0 && osr <= MS58XX_OSR_8192);
+    osalDbgCheck(decimation > 0);
+    /* Verify device status. */
+    osalDbgAssert(ms58xxp->state == MS58XX_READY, "invalid state");
+
+    ms58xxp->osr = osr;
+    ms58xxp->temperature_divider = temperature_divider;
+    ms58xxp->decimation = decimation;
+
+    osalSysLock();
 
-        ms58xxp->last_d1 = (rxbuf[0] << 16) | (rxbuf[1] << 8) | (rxbuf[2] << 0);
+    ms58xxp->state = MS58XX_ACTIVE;
+    ms58xxp->running = true;
+
+    /* Creates the sequencer thread. Note, it is created only once.*/
+    if (ms58xxp->tr == NULL)
+    {
+        thread_descriptor_t descriptor = {
+          "ms58xx",
+          THD_WORKING_AREA_BASE(ms58xxp->wa),
+          THD_WORKING_AREA_END(ms58xxp->wa),
+          MS58XX_SEQUENCER_PRIO,
+          ms58xx_sequencer,
+          (void*)ms58xxp
+        };
+        ms58xxp->tr = chThdCreateI(&descriptor);
     }
+    else
+    {
+        osalThreadResumeI(&ms58xxp->wait, MSG_OK);
+    }
+    osalOsRescheduleS();
 
-    /* Reset driver state. */
-    ms58xxp->state = MS58XX_READY;
+    osalSysUnlock();
+}
 
-    /* dT is the difference between current adc value and
-     * adc value at factory calibration (20 degree celsius). */
-    int32_t dT = (int32_t)ms58xxp->last_d2 -
-            ((int32_t)ms58xxp->calibration[MS58XX_CAL_5_TREF] << 8);
+/**
+ * @brief   Stops the measurement sequencer.
+ * @details Waits for the conversion in progress to complete. The last
+ *          published sample stays available.
+ *
+ * @param[in] ms58xxp   pointer to the @p MS58XXDriver object
+ *
+ * @api
+ */
+void ms58xxSequencerStop(MS58XXDriver* ms58xxp)
+{
+    osalDbgCheck(ms58xxp != NULL);
 
-    /* TEMP is the temperature in degree celsius * 100. */
-    int32_t TEMP = 2000 +
-            (((int64_t)dT * ms58xxp->calibration[MS58XX_CAL_6_TEMPSENS]) >> 23);
+    osalSysLock();
 
-    /* OFF is pressure adc offset at the current temperature. */
-    int64_t OFF = ((int64_t)ms58xxp->calibration[MS58XX_CAL_2_OFFT1] << 16) +
-            (((int64_t)ms58xxp->calibration[MS58XX_CAL_4_TCO] * dT) >> 7);
+    /* Verify device status. */
+    osalDbgAssert(ms58xxp->state == MS58XX_ACTIVE && ms58xxp->running,
+            "invalid state");
 
-    /* SENS is pressure adc sensitivity at the current temperature. */
-    int64_t SENS = ((int64_t)ms58xxp->calibration[MS58XX_CAL_1_SENST1] << 15) +
-            (((int64_t)ms58xxp->calibration[MS58XX_CAL_3_TCS] * dT) >> 8);
+    ms58xxp->running = false;
+    osalThreadSuspendS(&ms58xxp->stopper);
 
-    /* Apply second order temperature compensation. */
-    if (TEMP < 2000)
-    {
-        int64_t OFF2 = (3 * (TEMP - 2000) * (TEMP - 2000)) >> 1;
-        int64_t SENS2 = (5 * (TEMP - 2000) * (TEMP - 2000)) >> 3;
+    osalSysUnlock();
+}
 
-        if (TEMP < -1500)
-        {
-            OFF2 += 7 * (TEMP + 1500) * (TEMP + 1500);
-            SENS2 += 4 * (TEMP + 1500) * (TEMP + 1500);
-        }
+/**
+ * @brief   Gets the last sample published by the sequencer.
+ *
+ * @param[in] ms58xxp   pointer to the @p MS58XXDriver object
+ * @param[out] samplep  pointer to the sample copy
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   no sample published yet.
+ *
+ * @api
+ */
+bool ms58xxSampleGet(MS58XXDriver* ms58xxp, ms58xxsample_t* samplep)
+{
+    osalDbgCheck(ms58xxp != NULL && samplep != NULL);
 
-        OFF -= OFF2;
-        SENS -= SENS2;
-    }
-    else
+    osalSysLock();
+
+    uint32_t head = ms58xxp->ring_head;
+    if (head != 0)
+        *samplep = ms58xxp->ring[(head - 1) % MS58XX_SEQUENCER_RING_SIZE];
+
+    osalSysUnlock();
+
+    return head != 0 ? HAL_SUCCESS : HAL_FAILED;
+}
+
+/**
+ * @brief   Reads the samples published after a given one.
+ * @details Samples are returned oldest first. Samples already overwritten
+ *          in the ring are skipped, which shows as a gap in their
+ *          @p sequence numbers.
+ *
+ * @param[in] ms58xxp       pointer to the @p MS58XXDriver object
+ * @param[out] samples[]    array receiving up to @p n samples
+ * @param[in] n             size of @p samples
+ * @param[in,out] sequencep number of the last sample read, 0 initially,
+ *                          updated to the last sample returned
+ *
+ * @return                  Number of samples read.
+ *
+ * @api
+ */
+size_t ms58xxSamplesRead(MS58XXDriver* ms58xxp, ms58xxsample_t samples[],
+        size_t n, uint32_t* sequencep)
+{
+    osalDbgCheck(ms58xxp != NULL && samples != NULL && sequencep != NULL);
+
+    uint32_t last = *sequencep;
+    size_t count = 0;
+
+    osalSysLock();
+    while (count < n && last != ms58xxp->ring_head)
     {
-        int64_t OFF2 = (1 * (TEMP - 2000) * (TEMP - 2000)) >> 4;
+        /* Resynchronize on the oldest sample still in the ring. */
+        if (ms58xxp->ring_head - last > MS58XX_SEQUENCER_RING_SIZE)
+            last = ms58xxp->ring_head - MS58XX_SEQUENCER_RING_SIZE;
 
-        OFF -= OFF2;
+        samples[count++] = ms58xxp->ring[last % MS58XX_SEQUENCER_RING_SIZE];
+        ++last;
+
+        /* Keep the critical zone short on long reads. */
+        osalSysUnlock();
+        osalSysLock();
     }
+    osalSysUnlock();
 
-    /* P is the pressure in bar * 10000. */
-    int32_t P = (((ms58xxp->last_d1 * SENS) >> 21) - OFF) >> 13;
+    *sequencep = last;
 
-    if (resultp != NULL)
-        *resultp = P / 10000.0f;
+    return count;
+}
 
-    return HAL_SUCCESS;
+/**
+ * @brief   Returns the event source broadcasting new samples.
+ *
+ * @param[in] ms58xxp   pointer to the @p MS58XXDriver object
+ *
+ * @return              Event source flagging @p MS58XX_EVENT_SAMPLE.
+ *
+ * @api
+ */
+event_source_t* ms58xxGetEventSource(MS58XXDriver* ms58xxp)
+{
+    osalDbgCheck(ms58xxp != NULL);
+
+    return &ms58xxp->event;
 }
+#endif /* MS58XX_USE_SEQUENCER */
 
 #endif /* HAL_USE_MS58XX */
 
@@ -0,0 +1,345 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_async.c
+ * @brief   NVM asynchronous request driver code.
+ *
+ * @addtogroup NVM_ASYNC
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_ASYNC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Moves queued requests of idle devices to free slots.
+ *
+ * @param[in] nvmasyncp     pointer to the @p NVMAsyncDriver object
+ *
+ * @return                  The number of active requests.
+ *
+ * @sclass
+ */
+static uint32_t nvm_async_activate_s(NVMAsyncDriver* nvmasyncp)
+{
+    NVMRequest** reqpp = &nvmasyncp->queue_head;
+    NVMRequest* prevp = NULL;
+    uint32_t active = 0;
+
+    for (uint32_t i = 0; i < NVM_ASYNC_DEVICES_MAX; ++i)
+        if (nvmasyncp->slots[i].reqp != NULL)
+            ++active;
+
+    while (*reqpp != NULL && active < NVM_ASYNC_DEVICES_MAX)
+    {
+        NVMRequest* reqp = *reqpp;
+
+        /* Requests of the same device are served in order. */
+        bool busy = false;
+        for (uint32_t i = 0; i < NVM_ASYNC_DEVICES_MAX; ++i)
+            if (nvmasyncp->slots[i].reqp != NULL &&
+                    nvmasyncp->slots[i].reqp->nvmp == reqp->nvmp)
+                busy = true;
+        if (busy == true)
+        {
+            prevp = reqp;
+            reqpp = &reqp->next;
+            continue;
+        }
+
+        /* Unlink from queue. */
+        *reqpp = reqp->next;
+        if (nvmasyncp->queue_tail == reqp)
+            nvmasyncp->queue_tail = prevp;
+        reqp->next = NULL;
+
+        for (uint32_t i = 0; i < NVM_ASYNC_DEVICES_MAX; ++i)
+        {
+            if (nvmasyncp->slots[i].reqp == NULL)
+            {
+                nvmasyncp->slots[i].reqp = reqp;
+                nvmasyncp->slots[i].offset = 0;
+                nvmasyncp->slots[i].sector_size = 0;
+                nvmasyncp->slots[i].result = HAL_SUCCESS;
+                break;
+            }
+        }
+        ++active;
+    }
+
+    return active;
+}
+
+/**
+ * @brief   Starts the next step of an active request.
+ * @details Reads are served at once, writes and erases up to the next
+ *          sector boundary. Does not wait for the device to finish.
+ *
+ * @param[in] slotp         pointer to the @p NVMAsyncSlot
+ *
+ * @notapi
+ */
+static void nvm_async_step(NVMAsyncSlot* slotp)
+{
+    NVMRequest* reqp = slotp->reqp;
+    BaseNVMDevice* nvmp = reqp->nvmp;
+
+    if (slotp->offset >= reqp->n)
+        return;
+
+    if (reqp->op == NVM_REQUEST_READ)
+    {
+        slotp->result = nvmRead(nvmp, reqp->startaddr, reqp->n,
+                reqp->buffer.read);
+        slotp->offset = reqp->n;
+        return;
+    }
+
+    if (slotp->sector_size == 0)
+    {
+        NVMDeviceInfo di;
+        slotp->result = nvmGetInfo(nvmp, &di);
+        if (slotp->result != HAL_SUCCESS)
+            return;
+        slotp->sector_size = di.sector_size;
+    }
+
+    uint32_t addr = reqp->startaddr + slotp->offset;
+    uint32_t n = slotp->sector_size - (addr % slotp->sector_size);
+    if (n > reqp->n - slotp->offset)
+        n = reqp->n - slotp->offset;
+
+    if (reqp->op == NVM_REQUEST_WRITE)
+        slotp->result = nvmWrite(nvmp, addr, n,
+                reqp->buffer.write + slotp->offset);
+    else
+        slotp->result = nvmErase(nvmp, addr, n);
+
+    slotp->offset += n;
+}
+
+/**
+ * @brief   Worker thread serving the queued requests.
+ */
+static void nvm_async_worker(void* parameters)
+{
+    NVMAsyncDriver* nvmasyncp = (NVMAsyncDriver*)parameters;
+
+    chRegSetThreadName("nvm_async");
+
+    while (true)
+    {
+        /* Nothing to do, going to sleep. */
+        osalSysLock();
+        while (nvm_async_activate_s(nvmasyncp) == 0)
+            osalThreadSuspendS(&nvmasyncp->wait);
+        osalSysUnlock();
+
+        /* Start one step on every active device. */
+        for (uint32_t i = 0; i < NVM_ASYNC_DEVICES_MAX; ++i)
+        {
+            NVMAsyncSlot* slotp = &nvmasyncp->slots[i];
+            if (slotp->reqp == NULL)
+                continue;
+            nvmAcquire(slotp->reqp->nvmp);
+            nvm_async_step(slotp);
+        }
+
+        /* Wait for the devices and complete finished requests. Devices are
+           released in reverse order of acquisition. */
+        for (uint32_t i = NVM_ASYNC_DEVICES_MAX; i-- > 0;)
+        {
+            NVMAsyncSlot* slotp = &nvmasyncp->slots[i];
+            if (slotp->reqp == NULL)
+                continue;
+
+            NVMRequest* reqp = slotp->reqp;
+            if (slotp->result == HAL_SUCCESS)
+                slotp->result = nvmSync(reqp->nvmp);
+            nvmRelease(reqp->nvmp);
+
+            if (slotp->result != HAL_SUCCESS || slotp->offset >= reqp->n)
+            {
+                osalSysLock();
+                slotp->reqp = NULL;
+                nvmRequestCompleteI(reqp, slotp->result);
+                osalOsRescheduleS();
+                osalSysUnlock();
+            }
+        }
+    }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM asynchronous request driver initialization.
+ * @note    This function is implicitly invoked by @p qhalInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmasyncInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmasyncp    pointer to the @p NVMAsyncDriver object
+ *
+ * @init
+ */
+void nvmasyncObjectInit(NVMAsyncDriver* nvmasyncp)
+{
+    nvmasyncp->state = NVM_STOP;
+    nvmasyncp->tr = NULL;
+    nvmasyncp->wait = NULL;
+    nvmasyncp->queue_head = NULL;
+    nvmasyncp->queue_tail = NULL;
+    for (uint32_t i = 0; i < NVM_ASYNC_DEVICES_MAX; ++i)
+        nvmasyncp->slots[i].reqp = NULL;
+
+    /* Filling the thread working area here because the function
+       @p chThdCreateI() does not do it.*/
+#if CH_DBG_FILL_THREADS
+    {
+        _thread_memfill((uint8_t*)THD_WORKING_AREA_BASE(nvmasyncp->wa),
+            (uint8_t*)THD_WORKING_AREA_END(nvmasyncp->wa),
+            CH_DBG_STACK_FILL_VALUE);
+    }
+#endif /* CH_DBG_FILL_THREADS */
+}
+
+/**
+ * @brief   Activates the worker thread.
+ *
+ * @param[in] nvmasyncp     pointer to the @p NVMAsyncDriver object
+ *
+ * @api
+ */
+void nvmasyncStart(NVMAsyncDriver* nvmasyncp)
+{
+    osalDbgCheck(nvmasyncp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmasyncp->state == NVM_STOP) ||
+            (nvmasyncp->state == NVM_READY), "invalid state");
+
+    /* Creates the worker thread. Note, it is created only once.*/
+    osalSysLock();
+    if (nvmasyncp->tr == NULL)
+    {
+        thread_descriptor_t descriptor = {
+          "nvm_async",
+          THD_WORKING_AREA_BASE(nvmasyncp->wa),
+          THD_WORKING_AREA_END(nvmasyncp->wa),
+          NVM_ASYNC_THREAD_PRIO,
+          nvm_async_worker,
+          (void*)nvmasyncp
+        };
+        nvmasyncp->tr = chThdCreateI(&descriptor);
+        osalOsRescheduleS();
+    }
+    osalSysUnlock();
+
+    nvmasyncp->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the driver.
+ * @note    All submitted requests must have completed.
+ *
+ * @param[in] nvmasyncp     pointer to the @p NVMAsyncDriver object
+ *
+ * @api
+ */
+void nvmasyncStop(NVMAsyncDriver* nvmasyncp)
+{
+    osalDbgCheck(nvmasyncp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmasyncp->state == NVM_STOP) ||
+            (nvmasyncp->state == NVM_READY), "invalid state");
+    osalDbgAssert(nvmasyncp->queue_head == NULL, "requests queued");
+
+    nvmasyncp->state = NVM_STOP;
+}
+
+/**
+ * @brief   Submits a request for a device.
+ * @details Devices serving requests natively are handed the request
+ *          directly, all others are served by the worker thread. Requests
+ *          of the same device complete in order of submission.
+ * @note    A device must not be used otherwise while it has requests
+ *          pending.
+ *
+ * @param[in] nvmasyncp     pointer to the @p NVMAsyncDriver object
+ * @param[in] nvmp          pointer to a @p BaseNVMDevice or derived class
+ * @param[in] reqp          pointer to an initialized @p NVMRequest
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the request has been accepted.
+ * @retval HAL_FAILED       the request could not be started.
+ *
+ * @api
+ */
+bool nvmasyncSubmit(NVMAsyncDriver* nvmasyncp, BaseNVMDevice* nvmp,
+        NVMRequest* reqp)
+{
+    osalDbgCheck((nvmasyncp != NULL) && (nvmp != NULL) && (reqp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmasyncp->state == NVM_READY, "invalid state");
+
+    if (nvmp->vmt->start_request != NULL)
+        return nvmStartRequest(nvmp, reqp);
+
+    reqp->nvmp = nvmp;
+    reqp->next = NULL;
+    reqp->done = false;
+
+    osalSysLock();
+    if (nvmasyncp->queue_tail != NULL)
+        nvmasyncp->queue_tail->next = reqp;
+    else
+        nvmasyncp->queue_head = reqp;
+    nvmasyncp->queue_tail = reqp;
+    osalThreadResumeS(&nvmasyncp->wait, MSG_OK);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return HAL_SUCCESS;
+}
+
+#endif /* HAL_USE_NVM_ASYNC */
+
+/** @} */
@@ -0,0 +1,734 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_cache.c
+ * @brief   NVM cache driver code.
+ *
+ * @addtogroup NVM_CACHE
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_CACHE || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          The device is divided into lines of NVM_CACHE_LINE_SIZE bytes.
+ *          Reads are served from cached lines, missing lines are loaded as
+ *          a whole replacing the least recently used one.
+ *          Write through passes writes on and updates cached lines.
+ *          Write back only updates the lines and writes the modified range
+ *          of a line on sync, eviction or invalidation.
+ *          Erases drop all lines within the erased sectors.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMCacheDriverVMT nvm_cache_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmcacheRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmcacheWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmcacheErase,
+    .mass_erase = (bool (*)(void*))nvmcacheMassErase,
+    .sync = (bool (*)(void*))nvmcacheSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmcacheGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))nvmcacheAcquireBus,
+    .release = (void (*)(void*))nvmcacheReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmcacheWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmcacheMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmcacheWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmcacheMassWriteUnprotect,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static NVMCacheLine* nvm_cache_lookup(NVMCacheDriver* nvmcachep,
+        uint32_t addr)
+{
+    for (uint32_t i = 0; i < NVM_CACHE_LINE_NUM; ++i)
+    {
+        NVMCacheLine* linep = &nvmcachep->lines[i];
+        if (linep->valid == true && linep->addr == addr)
+            return linep;
+    }
+
+    return NULL;
+}
+
+static void nvm_cache_touch(NVMCacheDriver* nvmcachep, NVMCacheLine* linep)
+{
+    linep->stamp = ++nvmcachep->cache_stamp;
+}
+
+static bool nvm_cache_writeback(NVMCacheDriver* nvmcachep,
+        NVMCacheLine* linep)
+{
+    if (linep->dirty_hi <= linep->dirty_lo)
+        return HAL_SUCCESS;
+
+    uint32_t lo = linep->dirty_lo;
+    uint32_t hi = linep->dirty_hi;
+
+    /* Widen range to write alignment of the device. */
+    uint32_t alignment = nvmcachep->llnvmdi.write_alignment;
+    if (alignment > 1)
+    {
+        lo -= lo % alignment;
+        hi += (alignment - (hi % alignment)) % alignment;
+    }
+
+    bool result = nvmWrite(nvmcachep->config->nvmp, linep->addr + lo,
+            hi - lo, linep->data + lo);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    linep->dirty_lo = 0;
+    linep->dirty_hi = 0;
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_cache_flush(NVMCacheDriver* nvmcachep)
+{
+    for (uint32_t i = 0; i < NVM_CACHE_LINE_NUM; ++i)
+    {
+        NVMCacheLine* linep = &nvmcachep->lines[i];
+        if (linep->valid == false)
+            continue;
+
+        bool result = nvm_cache_writeback(nvmcachep, linep);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Assigns a line to an address.
+ * @details Takes an unused line or evicts the least recently used one.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ * @param[in] addr          line aligned address
+ * @param[in] fill          load line contents from the device
+ *
+ * @return                  Pointer to the line or @p NULL on failure.
+ *
+ * @notapi
+ */
+static NVMCacheLine* nvm_cache_alloc(NVMCacheDriver* nvmcachep,
+        uint32_t addr, bool fill)
+{
+    NVMCacheLine* linep = &nvmcachep->lines[0];
+
+    for (uint32_t i = 0; i < NVM_CACHE_LINE_NUM; ++i)
+    {
+        NVMCacheLine* candidatep = &nvmcachep->lines[i];
+        if (candidatep->valid == false)
+        {
+            linep = candidatep;
+            break;
+        }
+        /* Wrap safe comparison of stamps. */
+        if ((int32_t)(candidatep->stamp - linep->stamp) < 0)
+            linep = candidatep;
+    }
+
+    if (linep->valid == true)
+    {
+        if (nvm_cache_writeback(nvmcachep, linep) != HAL_SUCCESS)
+            return NULL;
+        linep->valid = false;
+    }
+
+    if (fill == true)
+    {
+        if (nvmRead(nvmcachep->config->nvmp, addr, NVM_CACHE_LINE_SIZE,
+                linep->data) != HAL_SUCCESS)
+            return NULL;
+    }
+
+    linep->addr = addr;
+    linep->dirty_lo = 0;
+    linep->dirty_hi = 0;
+    linep->valid = true;
+    nvm_cache_touch(nvmcachep, linep);
+
+    return linep;
+}
+
+/**
+ * @brief   Drops all lines overlapping a range without writing them.
+ *
+ * @notapi
+ */
+static void nvm_cache_drop(NVMCacheDriver* nvmcachep, uint32_t startaddr,
+        uint32_t n)
+{
+    for (uint32_t i = 0; i < NVM_CACHE_LINE_NUM; ++i)
+    {
+        NVMCacheLine* linep = &nvmcachep->lines[i];
+        if (linep->valid == true &&
+                linep->addr < startaddr + n &&
+                linep->addr + NVM_CACHE_LINE_SIZE > startaddr)
+        {
+            linep->valid = false;
+            linep->dirty_lo = 0;
+            linep->dirty_hi = 0;
+        }
+    }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM cache driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmcacheInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmcachep    pointer to the @p NVMCacheDriver object
+ *
+ * @init
+ */
+void nvmcacheObjectInit(NVMCacheDriver* nvmcachep)
+{
+    nvmcachep->vmt = &nvm_cache_vmt;
+    nvmcachep->state = NVM_STOP;
+    nvmcachep->config = NULL;
+    nvmcachep->cache_size = 0;
+    nvmcachep->cache_stamp = 0;
+    for (uint32_t i = 0; i < NVM_CACHE_LINE_NUM; ++i)
+    {
+        nvmcachep->lines[i].valid = false;
+        nvmcachep->lines[i].dirty_lo = 0;
+        nvmcachep->lines[i].dirty_hi = 0;
+    }
+#if NVM_CACHE_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&nvmcachep->mutex);
+#endif /* NVM_CACHE_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the NVM cache.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ * @param[in] config        pointer to the @p NVMCacheConfig object.
+ *
+ * @api
+ */
+void nvmcacheStart(NVMCacheDriver* nvmcachep, const NVMCacheConfig* config)
+{
+    osalDbgCheck((nvmcachep != NULL) && (config != NULL));
+    /* Verify device status. */
+    osalDbgAssert((nvmcachep->state == NVM_STOP) || (nvmcachep->state == NVM_READY),
+            "invalid state");
+
+    nvmcachep->config = config;
+
+    /* Calculate and cache often reused values. */
+    nvmGetInfo(nvmcachep->config->nvmp, &nvmcachep->llnvmdi);
+    nvmcachep->cache_size =
+            nvmcachep->llnvmdi.sector_size * nvmcachep->llnvmdi.sector_num;
+
+    /* Lines must tile the device and respect its write alignment. */
+    osalDbgAssert((nvmcachep->cache_size % NVM_CACHE_LINE_SIZE) == 0,
+            "line size mismatch");
+    osalDbgAssert(nvmcachep->llnvmdi.write_alignment <= 1 ||
+            (NVM_CACHE_LINE_SIZE % nvmcachep->llnvmdi.write_alignment) == 0,
+            "line size mismatch");
+
+    nvm_cache_drop(nvmcachep, 0, 0xffffffff);
+
+    nvmcachep->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the NVM cache.
+ * @note    Pending write back data must have been synced before.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ *
+ * @api
+ */
+void nvmcacheStop(NVMCacheDriver* nvmcachep)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmcachep->state == NVM_STOP) || (nvmcachep->state == NVM_READY),
+            "invalid state");
+
+    nvm_cache_drop(nvmcachep, 0, 0xffffffff);
+
+    nvmcachep->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheRead(NVMCacheDriver* nvmcachep, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert((startaddr + n <= nvmcachep->cache_size), "invalid parameters");
+
+    nvmstate_t state = nvmcachep->state;
+
+    /* Read operation in progress. */
+    nvmcachep->state = NVM_READING;
+
+    while (n > 0)
+    {
+        uint32_t offset = startaddr % NVM_CACHE_LINE_SIZE;
+        uint32_t addr = startaddr - offset;
+        uint32_t len = NVM_CACHE_LINE_SIZE - offset;
+        if (len > n)
+            len = n;
+
+        NVMCacheLine* linep = nvm_cache_lookup(nvmcachep, addr);
+        if (linep == NULL)
+        {
+            linep = nvm_cache_alloc(nvmcachep, addr, true);
+            if (linep == NULL)
+                return HAL_FAILED;
+        }
+        else
+        {
+            nvm_cache_touch(nvmcachep, linep);
+        }
+
+        memcpy(buffer, linep->data + offset, len);
+
+        startaddr += len;
+        buffer += len;
+        n -= len;
+    }
+
+    /* Read operation finished. */
+    nvmcachep->state = state;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes data crossing sector boundaries if required.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheWrite(NVMCacheDriver* nvmcachep, uint32_t startaddr,
+       uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert((startaddr + n <= nvmcachep->cache_size), "invalid parameters");
+
+    /* Write operation in progress. */
+    nvmcachep->state = NVM_WRITING;
+
+    bool write_back = (nvmcachep->config->mode == NVM_CACHE_WRITE_BACK);
+
+    if (write_back == false)
+    {
+        bool result = nvmWrite(nvmcachep->config->nvmp, startaddr, n, buffer);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    while (n > 0)
+    {
+        uint32_t offset = startaddr % NVM_CACHE_LINE_SIZE;
+        uint32_t addr = startaddr - offset;
+        uint32_t len = NVM_CACHE_LINE_SIZE - offset;
+        if (len > n)
+            len = n;
+
+        NVMCacheLine* linep = nvm_cache_lookup(nvmcachep, addr);
+        if (linep == NULL && write_back == true)
+        {
+            /* No need to load lines being overwritten completely. */
+            linep = nvm_cache_alloc(nvmcachep, addr,
+                    len != NVM_CACHE_LINE_SIZE);
+            if (linep == NULL)
+                return HAL_FAILED;
+        }
+
+        if (linep != NULL)
+        {
+            memcpy(linep->data + offset, buffer, len);
+            nvm_cache_touch(nvmcachep, linep);
+
+            if (write_back == true)
+            {
+                if (linep->dirty_hi <= linep->dirty_lo)
+                {
+                    linep->dirty_lo = offset;
+                    linep->dirty_hi = offset + len;
+                }
+                else
+                {
+                    if (offset < linep->dirty_lo)
+                        linep->dirty_lo = offset;
+                    if (offset + len > linep->dirty_hi)
+                        linep->dirty_hi = offset + len;
+                }
+            }
+        }
+
+        startaddr += len;
+        buffer += len;
+        n -= len;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ * @details Cached lines within the erased sectors are dropped.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ * @param[in] startaddr     address within to be erased sector
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheErase(NVMCacheDriver* nvmcachep, uint32_t startaddr,
+        uint32_t n)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert((startaddr + n <= nvmcachep->cache_size), "invalid parameters");
+
+    /* Erase operation in progress. */
+    nvmcachep->state = NVM_ERASING;
+
+    /* Whole sectors are being erased. */
+    uint32_t sector_size = nvmcachep->llnvmdi.sector_size;
+    uint32_t first = startaddr - (startaddr % sector_size);
+    uint32_t end = startaddr + n;
+    end += (sector_size - (end % sector_size)) % sector_size;
+    nvm_cache_drop(nvmcachep, first, end - first);
+
+    return nvmErase(nvmcachep->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Erases all sectors.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheMassErase(NVMCacheDriver* nvmcachep)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+
+    /* Erase operation in progress. */
+    nvmcachep->state = NVM_ERASING;
+
+    nvm_cache_drop(nvmcachep, 0, 0xffffffff);
+
+    return nvmMassErase(nvmcachep->config->nvmp);
+}
+
+/**
+ * @brief   Waits for idle condition.
+ * @details Writes back all modified lines first.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheSync(NVMCacheDriver* nvmcachep)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+
+    /* Lines evicted by reads leave the device busy in write back mode. */
+    if (nvmcachep->state == NVM_READY &&
+            nvmcachep->config->mode == NVM_CACHE_WRITE_THROUGH)
+        return HAL_SUCCESS;
+
+    bool result = nvm_cache_flush(nvmcachep);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    result = nvmSync(nvmcachep->config->nvmp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* No more operation in progress. */
+    nvmcachep->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns media info.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheGetInfo(NVMCacheDriver* nvmcachep, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+
+    memcpy(nvmdip, &nvmcachep->llnvmdi, sizeof(*nvmdip));
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Gains exclusive access to the nvm cache device.
+ * @details This function tries to gain ownership to the nvm cache device,
+ *          if the device is already being used then the invoking thread
+ *          is queued.
+ * @pre     In order to use this function the option
+ *          @p NVM_CACHE_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ *
+ * @api
+ */
+void nvmcacheAcquireBus(NVMCacheDriver* nvmcachep)
+{
+    osalDbgCheck(nvmcachep != NULL);
+
+#if NVM_CACHE_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&nvmcachep->mutex);
+
+    /* Lock the underlying device as well. */
+    nvmAcquire(nvmcachep->config->nvmp);
+#endif /* NVM_CACHE_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the nvm cache device.
+ * @pre     In order to use this function the option
+ *          @p NVM_CACHE_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ *
+ * @api
+ */
+void nvmcacheReleaseBus(NVMCacheDriver* nvmcachep)
+{
+    osalDbgCheck(nvmcachep != NULL);
+
+#if NVM_CACHE_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&nvmcachep->mutex);
+
+    /* Release the underlying device as well. */
+    nvmRelease(nvmcachep->config->nvmp);
+#endif /* NVM_CACHE_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Write protects one or more sectors.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ * @param[in] startaddr     address within to be protected sector
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheWriteProtect(NVMCacheDriver* nvmcachep,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+
+    return nvmWriteProtect(nvmcachep->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write protects the whole device.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheMassWriteProtect(NVMCacheDriver* nvmcachep)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteProtect(nvmcachep->config->nvmp);
+}
+
+/**
+ * @brief   Write unprotects one or more sectors.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ * @param[in] startaddr     address within to be unprotected sector
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheWriteUnprotect(NVMCacheDriver* nvmcachep,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+
+    return nvmWriteUnprotect(nvmcachep->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheMassWriteUnprotect(NVMCacheDriver* nvmcachep)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteUnprotect(nvmcachep->config->nvmp);
+}
+
+/**
+ * @brief   Drops all cached lines.
+ * @details Modified lines are written back first. To be used when the
+ *          underlying device has been changed bypassing the cache.
+ *
+ * @param[in] nvmcachep     pointer to the @p NVMCacheDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcacheInvalidate(NVMCacheDriver* nvmcachep)
+{
+    osalDbgCheck(nvmcachep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcachep->state >= NVM_READY, "invalid state");
+
+    bool result = nvm_cache_flush(nvmcachep);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    nvm_cache_drop(nvmcachep, 0, 0xffffffff);
+
+    return HAL_SUCCESS;
+}
+
+#endif /* HAL_USE_NVM_CACHE */
+
+/** @} */
@@ -0,0 +1,1407 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_compress.c
+ * @brief   NVM compression driver code.
+ *
+ * @addtogroup NVM_COMPRESS
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_COMPRESS || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          The logical address space is split into blocks which are
+ *          compressed independently. Each block is appended as a record
+ *          to the active sector of the underlying device, the block map
+ *          in RAM points to the most recent record of each block.
+ *          A record consists of a header holding the block number and the
+ *          length of the stored data followed by the data padded to four
+ *          bytes. Blocks not getting smaller are stored uncompressed,
+ *          erased blocks are stored as records without data. The data is
+ *          programmed before the header, so a record is valid once its
+ *          header is.
+ *          A sector starts with a header holding a magic, the erase count
+ *          and the allocation sequence number. On start the map is rebuilt
+ *          by replaying the records of all sectors in allocation order.
+ *          When the active sector is full a free one is allocated, keeping
+ *          one free sector for garbage collection which relocates the
+ *          current records of the sector holding the least current data.
+ *          One block is held in a buffer. Writes are collected there until
+ *          the end of the block has been written, another block is
+ *          accessed or on sync, reads of parts of a block decompress it
+ *          there once.
+ *          Compression is LZ77 with a format similar to LZ4 blocks. Each
+ *          sequence starts with a token holding the number of literals in
+ *          the upper and the match length minus 4 in the lower nibble, a
+ *          nibble of 15 is continued by bytes adding up to 255 each. The
+ *          literals and the little endian match offset follow. The last
+ *          sequence has no match.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Offsets within the sector header.
+ */
+#define NVM_COMPRESS_OFFSET_MAGIC           0
+#define NVM_COMPRESS_OFFSET_ERASE_COUNT     4
+#define NVM_COMPRESS_OFFSET_SEQUENCE        8
+
+/**
+ * @brief   Shortest match being encoded.
+ */
+#define NVM_COMPRESS_MIN_MATCH              4
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMCompressDriverVMT nvm_compress_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmcompressRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmcompressWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmcompressErase,
+    .mass_erase = (bool (*)(void*))nvmcompressMassErase,
+    .sync = (bool (*)(void*))nvmcompressSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmcompressGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))nvmcompressAcquireBus,
+    .release = (void (*)(void*))nvmcompressReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmcompressWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmcompressMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmcompressWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmcompressMassWriteUnprotect,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t nvm_compress_padded(uint32_t length)
+{
+    return (length + 3) & ~3UL;
+}
+
+static uint32_t nvm_compress_record_size(uint32_t length)
+{
+    return NVM_COMPRESS_RECORD_HEADER_SIZE + nvm_compress_padded(length);
+}
+
+static uint32_t nvm_compress_sector_addr(NVMCompressDriver* nvmcompressp,
+        uint32_t sector)
+{
+    return sector * nvmcompressp->llnvmdi.sector_size;
+}
+
+static uint32_t nvm_compress_entry(uint32_t blk)
+{
+    return blk | ((~blk & 0xffff) << 16);
+}
+
+/**
+ * @brief   Decodes a record header.
+ *
+ * @return                  The logical block or @p NVM_COMPRESS_NONE if the
+ *                          header is not valid.
+ */
+static uint32_t nvm_compress_header_blk(NVMCompressDriver* nvmcompressp,
+        const uint32_t* header, uint32_t* lengthp)
+{
+    const uint32_t blk = header[0] & 0xffff;
+    const uint32_t length = header[1] & 0xffff;
+
+    if (header[0] != nvm_compress_entry(blk) ||
+            blk >= nvmcompressp->config->block_num ||
+            header[1] != nvm_compress_entry(length) ||
+            length > nvmcompressp->config->block_size)
+        return NVM_COMPRESS_NONE;
+
+    *lengthp = length;
+
+    return blk;
+}
+
+static bool nvm_compress_write_word(NVMCompressDriver* nvmcompressp,
+        uint32_t addr, uint32_t value)
+{
+    return nvmWrite(nvmcompressp->config->nvmp, addr, sizeof(value),
+            (const uint8_t*)&value);
+}
+
+static uint32_t nvm_compress_put_length(uint8_t* dst, uint32_t op,
+        uint32_t n)
+{
+    while (n >= 255)
+    {
+        dst[op++] = 255;
+        n -= 255;
+    }
+    dst[op++] = (uint8_t)n;
+
+    return op;
+}
+
+/**
+ * @brief   Appends a sequence to the compressed data.
+ *
+ * @return                  The new compressed length or
+ *                          @p NVM_COMPRESS_NONE if exceeding @p limit.
+ */
+static uint32_t nvm_compress_sequence(uint8_t* dst, uint32_t op,
+        uint32_t limit, const uint8_t* literals, uint32_t literal_n,
+        uint32_t offset, uint32_t match_n)
+{
+    const uint32_t match = (offset != 0) ?
+            match_n - NVM_COMPRESS_MIN_MATCH : 0;
+
+    /* Note: Rejects sequences which would just fit as well. */
+    if (op + 1 + literal_n / 255 + 1 + literal_n + 2 + match / 255 + 1 > limit)
+        return NVM_COMPRESS_NONE;
+
+    dst[op++] = (uint8_t)((((literal_n < 15) ? literal_n : 15) << 4) |
+            ((match < 15) ? match : 15));
+    if (literal_n >= 15)
+        op = nvm_compress_put_length(dst, op, literal_n - 15);
+    memcpy(dst + op, literals, literal_n);
+    op += literal_n;
+
+    if (offset != 0)
+    {
+        dst[op++] = (uint8_t)offset;
+        dst[op++] = (uint8_t)(offset >> 8);
+        if (match >= 15)
+            op = nvm_compress_put_length(dst, op, match - 15);
+    }
+
+    return op;
+}
+
+/**
+ * @brief   Compresses a block.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[in] src           data to compress
+ * @param[in] n             number of bytes to compress
+ * @param[out] dst          compressed data
+ * @param[in] limit         size of @p dst
+ *
+ * @return                  The compressed length or @p NVM_COMPRESS_NONE
+ *                          if not fitting into @p limit bytes.
+ *
+ * @notapi
+ */
+static uint32_t nvm_compress_encode(NVMCompressDriver* nvmcompressp,
+        const uint8_t* src, uint32_t n, uint8_t* dst, uint32_t limit)
+{
+    uint16_t* table = nvmcompressp->hash;
+    uint32_t ip = 0;
+    uint32_t anchor = 0;
+    uint32_t op = 0;
+
+    /* Positions are stored plus one, zero marks an empty slot. */
+    memset(table, 0, sizeof(nvmcompressp->hash));
+
+    while (ip + NVM_COMPRESS_MIN_MATCH <= n)
+    {
+        uint32_t seq;
+        memcpy(&seq, src + ip, sizeof(seq));
+
+        const uint32_t h = (uint32_t)(seq * 2654435761U) >>
+                (32 - NVM_COMPRESS_HASH_BITS);
+        uint32_t ref = table[h];
+        table[h] = (uint16_t)(ip + 1);
+
+        if (ref == 0 || memcmp(src + ref - 1, &seq, sizeof(seq)) != 0)
+        {
+            ++ip;
+            continue;
+        }
+        ref -= 1;
+
+        uint32_t len = NVM_COMPRESS_MIN_MATCH;
+        while (ip + len < n && src[ref + len] == src[ip + len])
+            ++len;
+
+        op = nvm_compress_sequence(dst, op, limit, src + anchor, ip - anchor,
+                ip - ref, len);
+        if (op == NVM_COMPRESS_NONE)
+            return NVM_COMPRESS_NONE;
+
+        ip += len;
+        anchor = ip;
+    }
+
+    return nvm_compress_sequence(dst, op, limit, src + anchor, n - anchor,
+            0, 0);
+}
+
+static bool nvm_compress_get_length(const uint8_t* src, uint32_t n,
+        uint32_t* ipp, uint32_t* lenp)
+{
+    uint8_t b;
+
+    do
+    {
+        if (*ipp >= n)
+            return HAL_FAILED;
+        b = src[(*ipp)++];
+        *lenp += b;
+    } while (b == 255);
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Decompresses a block.
+ *
+ * @param[in] src           compressed data
+ * @param[in] n             compressed length
+ * @param[out] dst          decompressed data
+ * @param[in] size          expected decompressed length
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the data is corrupt.
+ *
+ * @notapi
+ */
+static bool nvm_compress_decode(const uint8_t* src, uint32_t n,
+        uint8_t* dst, uint32_t size)
+{
+    uint32_t ip = 0;
+    uint32_t op = 0;
+
+    while (ip < n)
+    {
+        const uint8_t token = src[ip++];
+
+        uint32_t literal_n = token >> 4;
+        if (literal_n == 15 &&
+                nvm_compress_get_length(src, n, &ip, &literal_n) != HAL_SUCCESS)
+            return HAL_FAILED;
+        if (literal_n > n - ip || literal_n > size - op)
+            return HAL_FAILED;
+        memcpy(dst + op, src + ip, literal_n);
+        ip += literal_n;
+        op += literal_n;
+
+        /* Last sequence. */
+        if (ip == n)
+            break;
+
+        if (n - ip < 2)
+            return HAL_FAILED;
+        const uint32_t offset = src[ip] | ((uint32_t)src[ip + 1] << 8);
+        ip += 2;
+
+        uint32_t match_n = token & 15;
+        if (match_n == 15 &&
+                nvm_compress_get_length(src, n, &ip, &match_n) != HAL_SUCCESS)
+            return HAL_FAILED;
+        match_n += NVM_COMPRESS_MIN_MATCH;
+        if (offset == 0 || offset > op || match_n > size - op)
+            return HAL_FAILED;
+
+        /* Note: Matches may overlap the bytes being produced. */
+        for (uint32_t i = 0; i < match_n; ++i, ++op)
+            dst[op] = dst[op - offset];
+    }
+
+    return (op == size) ? HAL_SUCCESS : HAL_FAILED;
+}
+
+/**
+ * @brief   Erases a free sector and records its erase count.
+ */
+static bool nvm_compress_erase(NVMCompressDriver* nvmcompressp,
+        uint32_t sector)
+{
+    NVMCompressSector* sp = &nvmcompressp->config->sectors[sector];
+    const uint32_t addr = nvm_compress_sector_addr(nvmcompressp, sector);
+
+    sp->flags = 0;
+
+    if (nvmErase(nvmcompressp->config->nvmp, addr,
+            nvmcompressp->llnvmdi.sector_size) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    sp->erase_count += 1;
+    sp->flags = NVM_COMPRESS_SECTOR_ERASED;
+
+    if (nvm_compress_write_word(nvmcompressp,
+            addr + NVM_COMPRESS_OFFSET_ERASE_COUNT,
+            sp->erase_count) != HAL_SUCCESS ||
+            nvm_compress_write_word(nvmcompressp,
+            addr + NVM_COMPRESS_OFFSET_MAGIC,
+            NVM_COMPRESS_MAGIC) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    sp->flags |= NVM_COMPRESS_SECTOR_PREPARED;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Takes the least worn free sector into use.
+ */
+static bool nvm_compress_allocate(NVMCompressDriver* nvmcompressp)
+{
+    NVMCompressSector* sectors = nvmcompressp->config->sectors;
+    uint32_t sector = NVM_COMPRESS_NONE;
+
+    for (uint32_t i = 0; i < nvmcompressp->llnvmdi.sector_num; ++i)
+    {
+        if (sectors[i].sequence != NVM_COMPRESS_NONE)
+            continue;
+        if (sector == NVM_COMPRESS_NONE ||
+                sectors[i].erase_count < sectors[sector].erase_count)
+            sector = i;
+    }
+
+    if (sector == NVM_COMPRESS_NONE)
+        return HAL_FAILED;
+
+    NVMCompressSector* sp = &sectors[sector];
+    const uint32_t addr = nvm_compress_sector_addr(nvmcompressp, sector);
+
+    if ((sp->flags & NVM_COMPRESS_SECTOR_ERASED) == 0)
+    {
+        if (nvm_compress_erase(nvmcompressp, sector) != HAL_SUCCESS)
+            return HAL_FAILED;
+    }
+    else if ((sp->flags & NVM_COMPRESS_SECTOR_PREPARED) == 0)
+    {
+        if (nvm_compress_write_word(nvmcompressp,
+                addr + NVM_COMPRESS_OFFSET_ERASE_COUNT,
+                sp->erase_count) != HAL_SUCCESS ||
+                nvm_compress_write_word(nvmcompressp,
+                addr + NVM_COMPRESS_OFFSET_MAGIC,
+                NVM_COMPRESS_MAGIC) != HAL_SUCCESS)
+            return HAL_FAILED;
+    }
+
+    if (nvm_compress_write_word(nvmcompressp,
+            addr + NVM_COMPRESS_OFFSET_SEQUENCE,
+            nvmcompressp->sequence + 1) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvmcompressp->sequence += 1;
+    sp->sequence = nvmcompressp->sequence;
+    sp->live = 0;
+    sp->flags = 0;
+
+    nvmcompressp->active = sector;
+    nvmcompressp->next_offset = NVM_COMPRESS_SECTOR_HEADER_SIZE;
+    nvmcompressp->free_num -= 1;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Unmaps a logical block.
+ */
+static void nvm_compress_unmap(NVMCompressDriver* nvmcompressp, uint32_t blk)
+{
+    NVMCompressEntry* ep = &nvmcompressp->config->map[blk];
+
+    if (ep->addr == NVM_COMPRESS_NONE)
+        return;
+
+    nvmcompressp->config->sectors[ep->addr /
+            nvmcompressp->llnvmdi.sector_size].live -=
+            nvm_compress_record_size(ep->length);
+    ep->addr = NVM_COMPRESS_NONE;
+}
+
+/**
+ * @brief   Appends a record to the active sector.
+ * @note    Allocates a new sector from the free sectors if required
+ *          without collecting garbage.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[in] blk           logical block
+ * @param[in] data          stored data padded to four bytes
+ * @param[in] length        stored data length
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @notapi
+ */
+static bool nvm_compress_program(NVMCompressDriver* nvmcompressp,
+        uint32_t blk, const uint8_t* data, uint32_t length)
+{
+    const uint32_t size = nvm_compress_record_size(length);
+
+    if (nvmcompressp->active == NVM_COMPRESS_NONE ||
+            nvmcompressp->next_offset + size >
+            nvmcompressp->llnvmdi.sector_size)
+    {
+        nvmcompressp->active = NVM_COMPRESS_NONE;
+        if (nvm_compress_allocate(nvmcompressp) != HAL_SUCCESS)
+            return HAL_FAILED;
+    }
+
+    const uint32_t sector = nvmcompressp->active;
+    const uint32_t addr = nvm_compress_sector_addr(nvmcompressp, sector) +
+            nvmcompressp->next_offset;
+    const uint32_t header[2] =
+    {
+        nvm_compress_entry(blk),
+        nvm_compress_entry(length),
+    };
+
+    /* Note: The space is used up even if programming fails. */
+    nvmcompressp->next_offset += size;
+
+    /* Note: The header goes last to validate the data. */
+    if ((length > 0 && nvmWrite(nvmcompressp->config->nvmp,
+            addr + NVM_COMPRESS_RECORD_HEADER_SIZE,
+            nvm_compress_padded(length), data) != HAL_SUCCESS) ||
+            nvmWrite(nvmcompressp->config->nvmp, addr, sizeof(header),
+            (const uint8_t*)header) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvm_compress_unmap(nvmcompressp, blk);
+    nvmcompressp->config->map[blk].addr = addr;
+    nvmcompressp->config->map[blk].length = (uint16_t)length;
+    nvmcompressp->config->sectors[sector].live += size;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Picks the sector holding the least current data.
+ *
+ * @return                  The sector or @p NVM_COMPRESS_NONE if no sector
+ *                          holds enough stale data.
+ */
+static uint32_t nvm_compress_victim(NVMCompressDriver* nvmcompressp)
+{
+    const NVMCompressSector* sectors = nvmcompressp->config->sectors;
+    uint32_t victim = NVM_COMPRESS_NONE;
+
+    for (uint32_t i = 0; i < nvmcompressp->llnvmdi.sector_num; ++i)
+    {
+        if (sectors[i].sequence == NVM_COMPRESS_NONE ||
+                i == nvmcompressp->active)
+            continue;
+        /* Note: Ties go to the less worn sector. */
+        if (victim == NVM_COMPRESS_NONE ||
+                sectors[i].live < sectors[victim].live ||
+                (sectors[i].live == sectors[victim].live &&
+                sectors[i].erase_count < sectors[victim].erase_count))
+            victim = i;
+    }
+
+    /* Relocating a sector without room for another block gains nothing. */
+    if (victim != NVM_COMPRESS_NONE && sectors[victim].live +
+            nvm_compress_record_size(nvmcompressp->config->block_size) >
+            nvmcompressp->llnvmdi.sector_size -
+            NVM_COMPRESS_SECTOR_HEADER_SIZE)
+        return NVM_COMPRESS_NONE;
+
+    return victim;
+}
+
+/**
+ * @brief   Relocates the current records of a sector and frees it.
+ * @note    Uses the block buffer, which must not hold data not yet stored.
+ */
+static bool nvm_compress_reclaim(NVMCompressDriver* nvmcompressp,
+        uint32_t sector)
+{
+    NVMCompressSector* sp = &nvmcompressp->config->sectors[sector];
+    const uint32_t base = nvm_compress_sector_addr(nvmcompressp, sector);
+    uint32_t offset = NVM_COMPRESS_SECTOR_HEADER_SIZE;
+
+    osalDbgAssert(nvmcompressp->dirty == false, "buffer in use");
+    nvmcompressp->open = NVM_COMPRESS_NONE;
+
+    while (sp->live > 0 && offset + NVM_COMPRESS_RECORD_HEADER_SIZE <=
+            nvmcompressp->llnvmdi.sector_size)
+    {
+        uint32_t header[2];
+        uint32_t length;
+
+        if (nvmRead(nvmcompressp->config->nvmp, base + offset,
+                sizeof(header), (uint8_t*)header) != HAL_SUCCESS)
+            return HAL_FAILED;
+
+        const uint32_t blk = nvm_compress_header_blk(nvmcompressp, header,
+                &length);
+        if (blk == NVM_COMPRESS_NONE)
+            break;
+
+        if (nvmcompressp->config->map[blk].addr == base + offset)
+        {
+            if ((length > 0 && nvmRead(nvmcompressp->config->nvmp,
+                    base + offset + NVM_COMPRESS_RECORD_HEADER_SIZE,
+                    nvm_compress_padded(length),
+                    nvmcompressp->config->buffer) != HAL_SUCCESS) ||
+                    nvm_compress_program(nvmcompressp, blk,
+                    nvmcompressp->config->buffer, length) != HAL_SUCCESS)
+                return HAL_FAILED;
+        }
+
+        offset += nvm_compress_record_size(length);
+    }
+
+    osalDbgAssert(sp->live == 0, "map inconsistent");
+
+    sp->sequence = NVM_COMPRESS_NONE;
+    sp->flags = 0;
+    nvmcompressp->free_num += 1;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Appends a record, collecting garbage if the free sectors run
+ *          out.
+ */
+static bool nvm_compress_append(NVMCompressDriver* nvmcompressp,
+        uint32_t blk, const uint8_t* data, uint32_t length)
+{
+    /* Keep one free sector for relocations. */
+    if (nvmcompressp->active == NVM_COMPRESS_NONE ||
+            nvmcompressp->next_offset + nvm_compress_record_size(length) >
+            nvmcompressp->llnvmdi.sector_size)
+    {
+        for (uint32_t i = 0; nvmcompressp->free_num < 2; ++i)
+        {
+            /* Relocations not gaining a sector mean the device is full. */
+            if (i >= nvmcompressp->llnvmdi.sector_num)
+                return HAL_FAILED;
+
+            const uint32_t victim = nvm_compress_victim(nvmcompressp);
+            if (victim == NVM_COMPRESS_NONE ||
+                    nvm_compress_reclaim(nvmcompressp, victim) != HAL_SUCCESS)
+                return HAL_FAILED;
+        }
+    }
+
+    return nvm_compress_program(nvmcompressp, blk, data, length);
+}
+
+/**
+ * @brief   Rebuilds the map from the records of the sectors in use.
+ */
+static bool nvm_compress_mount(NVMCompressDriver* nvmcompressp)
+{
+    const NVMCompressConfig* config = nvmcompressp->config;
+    const uint32_t sector_size = nvmcompressp->llnvmdi.sector_size;
+    uint32_t header[3];
+
+    for (uint32_t blk = 0; blk < config->block_num; ++blk)
+    {
+        config->map[blk].addr = NVM_COMPRESS_NONE;
+        config->map[blk].length = 0;
+    }
+
+    nvmcompressp->sequence = 0;
+    nvmcompressp->active = NVM_COMPRESS_NONE;
+    nvmcompressp->next_offset = 0;
+    nvmcompressp->free_num = 0;
+
+    for (uint32_t sector = 0; sector < nvmcompressp->llnvmdi.sector_num;
+            ++sector)
+    {
+        NVMCompressSector* sp = &config->sectors[sector];
+
+        if (nvmRead(config->nvmp,
+                nvm_compress_sector_addr(nvmcompressp, sector),
+                sizeof(header), (uint8_t*)header) != HAL_SUCCESS)
+            return HAL_FAILED;
+
+        sp->live = 0;
+
+        if (header[0] == NVM_COMPRESS_MAGIC)
+        {
+            sp->erase_count = header[1];
+            sp->sequence = header[2];
+            sp->flags = NVM_COMPRESS_SECTOR_ERASED |
+                    NVM_COMPRESS_SECTOR_PREPARED;
+        }
+        else
+        {
+            bool erased;
+            if (nvmIsErased(config->nvmp,
+                    nvm_compress_sector_addr(nvmcompressp, sector),
+                    sector_size, &erased) != HAL_SUCCESS)
+                return HAL_FAILED;
+
+            /* Note: The erase count of a sector without header is lost. */
+            sp->erase_count = 0;
+            sp->sequence = NVM_COMPRESS_NONE;
+            sp->flags = (erased == true) ? NVM_COMPRESS_SECTOR_ERASED : 0;
+        }
+
+        if (sp->sequence == NVM_COMPRESS_NONE)
+            nvmcompressp->free_num += 1;
+        else if (sp->sequence > nvmcompressp->sequence)
+            nvmcompressp->sequence = sp->sequence;
+    }
+
+    /* Replay the sectors in allocation order. */
+    uint32_t last = 0;
+
+    while (true)
+    {
+        uint32_t sector = NVM_COMPRESS_NONE;
+
+        for (uint32_t i = 0; i < nvmcompressp->llnvmdi.sector_num; ++i)
+        {
+            const uint32_t sequence = config->sectors[i].sequence;
+
+            if (sequence == NVM_COMPRESS_NONE || sequence <= last)
+                continue;
+            if (sector == NVM_COMPRESS_NONE ||
+                    sequence < config->sectors[sector].sequence)
+                sector = i;
+        }
+
+        if (sector == NVM_COMPRESS_NONE)
+            break;
+
+        last = config->sectors[sector].sequence;
+
+        const uint32_t base = nvm_compress_sector_addr(nvmcompressp, sector);
+        uint32_t offset = NVM_COMPRESS_SECTOR_HEADER_SIZE;
+
+        while (offset + NVM_COMPRESS_RECORD_HEADER_SIZE <= sector_size)
+        {
+            uint32_t length;
+
+            if (nvmRead(config->nvmp, base + offset,
+                    NVM_COMPRESS_RECORD_HEADER_SIZE,
+                    (uint8_t*)header) != HAL_SUCCESS)
+                return HAL_FAILED;
+
+            /* Erased or interrupted header ends the sector. */
+            const uint32_t blk = nvm_compress_header_blk(nvmcompressp,
+                    header, &length);
+            const uint32_t size = nvm_compress_record_size(length);
+            if (blk == NVM_COMPRESS_NONE || offset + size > sector_size)
+                break;
+
+            nvm_compress_unmap(nvmcompressp, blk);
+            config->map[blk].addr = base + offset;
+            config->map[blk].length = (uint16_t)length;
+            config->sectors[sector].live += size;
+
+            offset += size;
+        }
+    }
+
+    /* Note: Sectors in use are not appended to after starting as records
+     * of an interrupted write may have been programmed partly. */
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Reads a whole logical block.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[in] blk           logical block
+ * @param[out] buffer       receives the block
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @notapi
+ */
+static bool nvm_compress_fetch(NVMCompressDriver* nvmcompressp,
+        uint32_t blk, uint8_t* buffer)
+{
+    const NVMCompressEntry* ep = &nvmcompressp->config->map[blk];
+    const uint32_t block_size = nvmcompressp->config->block_size;
+
+    if (ep->addr == NVM_COMPRESS_NONE || ep->length == 0)
+    {
+        memset(buffer, 0xff, block_size);
+        return HAL_SUCCESS;
+    }
+
+    const uint32_t addr = ep->addr + NVM_COMPRESS_RECORD_HEADER_SIZE;
+
+    if (ep->length == block_size)
+        return nvmRead(nvmcompressp->config->nvmp, addr, block_size, buffer);
+
+    if (nvmRead(nvmcompressp->config->nvmp, addr,
+            nvm_compress_padded(ep->length),
+            nvmcompressp->config->cbuffer) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    return nvm_compress_decode(nvmcompressp->config->cbuffer, ep->length,
+            buffer, block_size);
+}
+
+/**
+ * @brief   Stores the buffered block if modified.
+ */
+static bool nvm_compress_commit(NVMCompressDriver* nvmcompressp)
+{
+    if (nvmcompressp->dirty == false)
+        return HAL_SUCCESS;
+
+    const uint32_t block_size = nvmcompressp->config->block_size;
+    uint8_t* cbuffer = nvmcompressp->config->cbuffer;
+
+    /* Store uncompressed unless at least one word is saved. */
+    uint32_t length = nvm_compress_encode(nvmcompressp,
+            nvmcompressp->config->buffer, block_size, cbuffer,
+            block_size - sizeof(uint32_t));
+    if (length == NVM_COMPRESS_NONE)
+    {
+        memcpy(cbuffer, nvmcompressp->config->buffer, block_size);
+        length = block_size;
+    }
+    else
+    {
+        memset(cbuffer + length, 0xff, nvm_compress_padded(length) - length);
+    }
+
+    /* Note: The buffer may be reused by garbage collection now. */
+    nvmcompressp->dirty = false;
+
+    bool result = nvm_compress_append(nvmcompressp, nvmcompressp->open,
+            cbuffer, length);
+    if (result != HAL_SUCCESS)
+        nvmcompressp->open = NVM_COMPRESS_NONE;
+
+    return result;
+}
+
+/**
+ * @brief   Takes a block into the buffer.
+ */
+static bool nvm_compress_load(NVMCompressDriver* nvmcompressp, uint32_t blk)
+{
+    if (nvmcompressp->open == blk)
+        return HAL_SUCCESS;
+
+    bool result = nvm_compress_commit(nvmcompressp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    nvmcompressp->open = NVM_COMPRESS_NONE;
+    result = nvm_compress_fetch(nvmcompressp, blk,
+            nvmcompressp->config->buffer);
+    if (result != HAL_SUCCESS)
+        return result;
+    nvmcompressp->open = blk;
+
+    return HAL_SUCCESS;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM compression driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmcompressInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmcompressp pointer to the @p NVMCompressDriver object
+ *
+ * @init
+ */
+void nvmcompressObjectInit(NVMCompressDriver* nvmcompressp)
+{
+    nvmcompressp->vmt = &nvm_compress_vmt;
+    nvmcompressp->state = NVM_STOP;
+    nvmcompressp->config = NULL;
+    nvmcompressp->sequence = 0;
+    nvmcompressp->active = NVM_COMPRESS_NONE;
+    nvmcompressp->next_offset = 0;
+    nvmcompressp->free_num = 0;
+    nvmcompressp->open = NVM_COMPRESS_NONE;
+    nvmcompressp->dirty = false;
+#if NVM_COMPRESS_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&nvmcompressp->mutex);
+#endif /* NVM_COMPRESS_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the NVM compression driver.
+ * @details Rebuilds the block map from the records on the device.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[in] config        pointer to the @p NVMCompressConfig object.
+ *
+ * @api
+ */
+void nvmcompressStart(NVMCompressDriver* nvmcompressp,
+        const NVMCompressConfig* config)
+{
+    osalDbgCheck((nvmcompressp != NULL) && (config != NULL));
+    osalDbgCheck((config->map != NULL) && (config->sectors != NULL) &&
+            (config->buffer != NULL) && (config->cbuffer != NULL));
+    /* Verify device status. */
+    osalDbgAssert((nvmcompressp->state == NVM_STOP) ||
+            (nvmcompressp->state == NVM_READY), "invalid state");
+
+    nvmcompressp->config = config;
+
+    /* Calculate and cache often reused values. */
+    nvmGetInfo(nvmcompressp->config->nvmp, &nvmcompressp->llnvmdi);
+
+    osalDbgAssert(nvmcompressp->llnvmdi.write_alignment <= sizeof(uint32_t),
+            "unsupported write alignment");
+    osalDbgAssert(config->block_size % sizeof(uint32_t) == 0 &&
+            config->block_size <= 0x8000 &&
+            NVM_COMPRESS_SECTOR_HEADER_SIZE +
+            nvm_compress_record_size(config->block_size) <=
+            nvmcompressp->llnvmdi.sector_size, "invalid block size");
+    osalDbgAssert(config->block_num <= 0xffff, "too many blocks");
+    /* One sector is kept free next to the active one. */
+    osalDbgAssert(nvmcompressp->llnvmdi.sector_num >= 3,
+            "too few sectors");
+
+    nvmcompressp->open = NVM_COMPRESS_NONE;
+    nvmcompressp->dirty = false;
+
+    if (nvm_compress_mount(nvmcompressp) != HAL_SUCCESS)
+    {
+        nvmcompressp->state = NVM_STOP;
+        return;
+    }
+
+    nvmcompressp->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the NVM compression driver.
+ * @details The buffered block is stored first.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ *
+ * @api
+ */
+void nvmcompressStop(NVMCompressDriver* nvmcompressp)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmcompressp->state == NVM_STOP) ||
+            (nvmcompressp->state == NVM_READY), "invalid state");
+
+    if (nvmcompressp->state == NVM_READY &&
+            nvm_compress_commit(nvmcompressp) == HAL_SUCCESS)
+        nvmSync(nvmcompressp->config->nvmp);
+
+    nvmcompressp->open = NVM_COMPRESS_NONE;
+    nvmcompressp->dirty = false;
+
+    nvmcompressp->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing block boundaries if required.
+ * @note    Data never written reads as erased.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressRead(NVMCompressDriver* nvmcompressp, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert(startaddr + n <= nvmcompressp->config->block_size *
+            nvmcompressp->config->block_num, "invalid parameters");
+
+    nvmstate_t state = nvmcompressp->state;
+
+    /* Read operation in progress. */
+    nvmcompressp->state = NVM_READING;
+
+    const uint32_t block_size = nvmcompressp->config->block_size;
+    bool result = HAL_SUCCESS;
+
+    while (n > 0 && result == HAL_SUCCESS)
+    {
+        const uint32_t blk = startaddr / block_size;
+        const uint32_t offset = startaddr % block_size;
+        uint32_t len = block_size - offset;
+        if (len > n)
+            len = n;
+
+        if (len == block_size && nvmcompressp->open != blk)
+        {
+            /* Whole blocks bypass the buffer. */
+            result = nvm_compress_fetch(nvmcompressp, blk, buffer);
+        }
+        else
+        {
+            result = nvm_compress_load(nvmcompressp, blk);
+            if (result == HAL_SUCCESS)
+                memcpy(buffer, nvmcompressp->config->buffer + offset, len);
+        }
+
+        startaddr += len;
+        buffer += len;
+        n -= len;
+    }
+
+    /* Read operation finished. */
+    nvmcompressp->state = state;
+
+    return result;
+}
+
+/**
+ * @brief   Writes data crossing block boundaries if required.
+ * @details Data is collected in the block buffer and stored once the end
+ *          of the block has been written or another block is accessed.
+ * @note    Unlike flash memory, written data replaces the former data.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressWrite(NVMCompressDriver* nvmcompressp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert(startaddr + n <= nvmcompressp->config->block_size *
+            nvmcompressp->config->block_num, "invalid parameters");
+
+    /* Write operation in progress. */
+    nvmcompressp->state = NVM_WRITING;
+
+    const uint32_t block_size = nvmcompressp->config->block_size;
+
+    while (n > 0)
+    {
+        bool result;
+        const uint32_t blk = startaddr / block_size;
+        const uint32_t offset = startaddr % block_size;
+        uint32_t len = block_size - offset;
+        if (len > n)
+            len = n;
+
+        if (len == block_size && nvmcompressp->open != blk)
+        {
+            /* Whole blocks need not be loaded. */
+            result = nvm_compress_commit(nvmcompressp);
+            nvmcompressp->open = blk;
+        }
+        else
+        {
+            result = nvm_compress_load(nvmcompressp, blk);
+        }
+        if (result != HAL_SUCCESS)
+            return result;
+
+        memcpy(nvmcompressp->config->buffer + offset, buffer, len);
+        nvmcompressp->dirty = true;
+
+        /* End of block reached, no more writes expected. */
+        if (offset + len == block_size)
+        {
+            result = nvm_compress_commit(nvmcompressp);
+            if (result != HAL_SUCCESS)
+                return result;
+        }
+
+        startaddr += len;
+        buffer += len;
+        n -= len;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases one or more blocks.
+ * @details Erased blocks are recorded without data.
+ * @note    If recording fails, the blocks read as erased but may return
+ *          their former data after starting again.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[in] startaddr     address within to be erased block
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressErase(NVMCompressDriver* nvmcompressp, uint32_t startaddr,
+        uint32_t n)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert(startaddr + n <= nvmcompressp->config->block_size *
+            nvmcompressp->config->block_num, "invalid parameters");
+
+    if (n == 0)
+        return HAL_SUCCESS;
+
+    /* Erase operation in progress. */
+    nvmcompressp->state = NVM_ERASING;
+
+    const uint32_t block_size = nvmcompressp->config->block_size;
+    const uint32_t first = startaddr / block_size;
+    const uint32_t last = (startaddr + n - 1) / block_size;
+    NVMCompressEntry* map = nvmcompressp->config->map;
+
+    /* Note: Garbage collection may use the buffer. */
+    if (nvmcompressp->open >= first && nvmcompressp->open <= last)
+    {
+        nvmcompressp->open = NVM_COMPRESS_NONE;
+        nvmcompressp->dirty = false;
+    }
+    bool result = nvm_compress_commit(nvmcompressp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Unmapping all blocks first lets a full device collect the erased
+     * data before recording the erase. */
+    for (uint32_t blk = first; blk <= last; ++blk)
+    {
+        if (map[blk].addr == NVM_COMPRESS_NONE || map[blk].length == 0)
+            continue;
+        nvm_compress_unmap(nvmcompressp, blk);
+        map[blk].length = 1;
+    }
+
+    for (uint32_t blk = first; blk <= last; ++blk)
+    {
+        if (map[blk].addr != NVM_COMPRESS_NONE || map[blk].length == 0)
+            continue;
+        result = nvm_compress_append(nvmcompressp, blk, NULL, 0);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases all blocks.
+ * @details Erases the whole underlying device.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressMassErase(NVMCompressDriver* nvmcompressp)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+
+    /* Erase operation in progress. */
+    nvmcompressp->state = NVM_ERASING;
+
+    nvmcompressp->open = NVM_COMPRESS_NONE;
+    nvmcompressp->dirty = false;
+
+    bool result = nvmMassErase(nvmcompressp->config->nvmp);
+    if (result != HAL_SUCCESS)
+        return result;
+    result = nvmSync(nvmcompressp->config->nvmp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Erase counts are kept, the sector headers are written on use. */
+    for (uint32_t i = 0; i < nvmcompressp->llnvmdi.sector_num; ++i)
+    {
+        NVMCompressSector* sp = &nvmcompressp->config->sectors[i];
+        if (sp->sequence != NVM_COMPRESS_NONE ||
+                (sp->flags & NVM_COMPRESS_SECTOR_ERASED) == 0)
+            sp->erase_count += 1;
+        sp->sequence = NVM_COMPRESS_NONE;
+        sp->live = 0;
+        sp->flags = NVM_COMPRESS_SECTOR_ERASED;
+    }
+    for (uint32_t blk = 0; blk < nvmcompressp->config->block_num; ++blk)
+    {
+        nvmcompressp->config->map[blk].addr = NVM_COMPRESS_NONE;
+        nvmcompressp->config->map[blk].length = 0;
+    }
+
+    nvmcompressp->sequence = 0;
+    nvmcompressp->active = NVM_COMPRESS_NONE;
+    nvmcompressp->next_offset = 0;
+    nvmcompressp->free_num = nvmcompressp->llnvmdi.sector_num;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Waits for idle condition.
+ * @details Stores the buffered block first.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressSync(NVMCompressDriver* nvmcompressp)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+
+    bool result = nvm_compress_commit(nvmcompressp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    result = nvmSync(nvmcompressp->config->nvmp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* No more operation in progress. */
+    nvmcompressp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns media info.
+ * @note    Reports the blocks as sectors without write alignment.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressGetInfo(NVMCompressDriver* nvmcompressp,
+        NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+
+    memset(nvmdip, 0, sizeof(*nvmdip));
+    nvmdip->sector_size = nvmcompressp->config->block_size;
+    nvmdip->sector_num = nvmcompressp->config->block_num;
+    memcpy(nvmdip->identification, nvmcompressp->llnvmdi.identification,
+            sizeof(nvmdip->identification));
+    nvmdip->erase_sizes[0] = nvmcompressp->config->block_size;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Gains exclusive access to the nvm compression device.
+ * @details This function tries to gain ownership to the nvm compression
+ *          device, if the device is already being used then the invoking
+ *          thread is queued.
+ * @pre     In order to use this function the option
+ *          @p NVM_COMPRESS_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ *
+ * @api
+ */
+void nvmcompressAcquireBus(NVMCompressDriver* nvmcompressp)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+
+#if NVM_COMPRESS_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&nvmcompressp->mutex);
+
+    /* Lock the underlying device as well. */
+    nvmAcquire(nvmcompressp->config->nvmp);
+#endif /* NVM_COMPRESS_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the nvm compression device.
+ * @pre     In order to use this function the option
+ *          @p NVM_COMPRESS_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ *
+ * @api
+ */
+void nvmcompressReleaseBus(NVMCompressDriver* nvmcompressp)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+
+#if NVM_COMPRESS_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&nvmcompressp->mutex);
+
+    /* Release the underlying device as well. */
+    nvmRelease(nvmcompressp->config->nvmp);
+#endif /* NVM_COMPRESS_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Write protects one or more blocks.
+ * @note    Blocks are spread over the whole device, ranges are not
+ *          supported.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[in] startaddr     address within to be protected block
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressWriteProtect(NVMCompressDriver* nvmcompressp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+
+    (void)startaddr;
+    (void)n;
+
+    return HAL_FAILED;
+}
+
+/**
+ * @brief   Write protects the whole device.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressMassWriteProtect(NVMCompressDriver* nvmcompressp)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteProtect(nvmcompressp->config->nvmp);
+}
+
+/**
+ * @brief   Write unprotects one or more blocks.
+ * @note    Blocks are spread over the whole device, ranges are not
+ *          supported.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ * @param[in] startaddr     address within to be unprotected block
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressWriteUnprotect(NVMCompressDriver* nvmcompressp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+
+    (void)startaddr;
+    (void)n;
+
+    return HAL_FAILED;
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ *
+ * @param[in] nvmcompressp  pointer to the @p NVMCompressDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmcompressMassWriteUnprotect(NVMCompressDriver* nvmcompressp)
+{
+    osalDbgCheck(nvmcompressp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmcompressp->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteUnprotect(nvmcompressp->config->nvmp);
+}
+
+#endif /* HAL_USE_NVM_COMPRESS */
+
+/** @} */
@@ -0,0 +1,583 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_dedup.c
+ * @brief   NVM compare before write driver code.
+ *
+ * @addtogroup NVM_DEDUP
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_DEDUP || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          Writes read back the target range in chunks of
+ *          NVM_DEDUP_CHUNK_SIZE bytes and compare it with the new data.
+ *          Spans of changed bytes are widened to the write alignment of the
+ *          underlying device and forwarded, unchanged spans are dropped.
+ *          Spans separated by less than NVM_DEDUP_MIN_GAP unchanged bytes
+ *          are merged into a single write. Writing unchanged data, including
+ *          all 0xFF over an erased range, therefore does not reach the
+ *          underlying device at all.
+ *          All other operations are passed on unchanged. Vectored writes
+ *          are split into single writes by the generic implementation.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMDedupDriverVMT nvm_dedup_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmdedupRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmdedupWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmdedupErase,
+    .mass_erase = (bool (*)(void*))nvmdedupMassErase,
+    .sync = (bool (*)(void*))nvmdedupSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmdedupGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))nvmdedupAcquireBus,
+    .release = (void (*)(void*))nvmdedupReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmdedupWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmdedupMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmdedupWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmdedupMassWriteUnprotect,
+    .readv = (bool (*)(void*, const NVMReadSegment*, uint32_t))nvmdedupReadv,
+    .is_erased = (bool (*)(void*, uint32_t, uint32_t, bool*))nvmdedupIsErased,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Rounds an address down to the write alignment.
+ *
+ * @notapi
+ */
+static uint32_t nvm_dedup_align_down(NVMDedupDriver* nvmdedupp,
+        uint32_t addr)
+{
+    const uint32_t alignment = nvmdedupp->llnvmdi.write_alignment;
+    if (alignment > 1)
+        addr -= addr % alignment;
+
+    return addr;
+}
+
+/**
+ * @brief   Rounds an address up to the write alignment.
+ *
+ * @notapi
+ */
+static uint32_t nvm_dedup_align_up(NVMDedupDriver* nvmdedupp,
+        uint32_t addr)
+{
+    const uint32_t alignment = nvmdedupp->llnvmdi.write_alignment;
+    if (alignment > 1)
+        addr += (alignment - (addr % alignment)) % alignment;
+
+    return addr;
+}
+
+/**
+ * @brief   Forwards a span of changed bytes.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[in] startaddr     address the write started at
+ * @param[in] n             number of bytes of the write
+ * @param[in] buffer        data of the write
+ * @param[in] lo            first changed address
+ * @param[in] hi            address following the last changed byte
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @notapi
+ */
+static bool nvm_dedup_forward(NVMDedupDriver* nvmdedupp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer, uint32_t lo, uint32_t hi)
+{
+    /* Widen span to write alignment of the device. */
+    lo = nvm_dedup_align_down(nvmdedupp, lo);
+    hi = nvm_dedup_align_up(nvmdedupp, hi);
+    if (lo < startaddr)
+        lo = startaddr;
+    if (hi > startaddr + n)
+        hi = startaddr + n;
+
+    return nvmWrite(nvmdedupp->config->nvmp, lo, hi - lo,
+            buffer + (lo - startaddr));
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM compare before write driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmdedupInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmdedupp    pointer to the @p NVMDedupDriver object
+ *
+ * @init
+ */
+void nvmdedupObjectInit(NVMDedupDriver* nvmdedupp)
+{
+    nvmdedupp->vmt = &nvm_dedup_vmt;
+    nvmdedupp->state = NVM_STOP;
+    nvmdedupp->config = NULL;
+#if NVM_DEDUP_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&nvmdedupp->mutex);
+#endif /* NVM_DEDUP_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the NVM compare before write driver.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[in] config        pointer to the @p NVMDedupConfig object.
+ *
+ * @api
+ */
+void nvmdedupStart(NVMDedupDriver* nvmdedupp, const NVMDedupConfig* config)
+{
+    osalDbgCheck((nvmdedupp != NULL) && (config != NULL));
+    /* Verify device status. */
+    osalDbgAssert((nvmdedupp->state == NVM_STOP) ||
+            (nvmdedupp->state == NVM_READY), "invalid state");
+
+    nvmdedupp->config = config;
+
+    nvmGetInfo(nvmdedupp->config->nvmp, &nvmdedupp->llnvmdi);
+
+    osalDbgAssert(nvmdedupp->llnvmdi.write_alignment <= 1 ||
+            (NVM_DEDUP_CHUNK_SIZE % nvmdedupp->llnvmdi.write_alignment) == 0,
+            "chunk size not aligned");
+
+    nvmdedupp->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the NVM compare before write driver.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ *
+ * @api
+ */
+void nvmdedupStop(NVMDedupDriver* nvmdedupp)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmdedupp->state == NVM_STOP) ||
+            (nvmdedupp->state == NVM_READY), "invalid state");
+
+    nvmdedupp->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupRead(NVMDedupDriver* nvmdedupp, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmRead(nvmdedupp->config->nvmp, startaddr, n, buffer);
+}
+
+/**
+ * @brief   Writes the bytes differing from the stored data.
+ * @details Unchanged spans are not written, a write of unchanged data
+ *          completes after reading it back.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupWrite(NVMDedupDriver* nvmdedupp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck((nvmdedupp != NULL) && (buffer != NULL || n == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    bool result;
+
+    /* Pending span of changed bytes, empty if lo equals hi. */
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+
+    uint32_t len;
+    for (uint32_t offset = 0; offset < n; offset += len)
+    {
+        len = n - offset;
+        if (len > NVM_DEDUP_CHUNK_SIZE)
+            len = NVM_DEDUP_CHUNK_SIZE;
+
+        result = nvmRead(nvmdedupp->config->nvmp, startaddr + offset, len,
+                nvmdedupp->chunk);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (memcmp(nvmdedupp->chunk, buffer + offset, len) == 0)
+            continue;
+
+        for (uint32_t i = 0; i < len; ++i)
+        {
+            if (nvmdedupp->chunk[i] == buffer[offset + i])
+                continue;
+
+            const uint32_t addr = startaddr + offset + i;
+
+            /* Split off the pending span if the gap is long enough and both
+               spans do not share an aligned unit. */
+            if (hi != lo && addr - hi >= NVM_DEDUP_MIN_GAP &&
+                    nvm_dedup_align_up(nvmdedupp, hi) <=
+                    nvm_dedup_align_down(nvmdedupp, addr))
+            {
+                result = nvm_dedup_forward(nvmdedupp, startaddr, n, buffer,
+                        lo, hi);
+                if (result != HAL_SUCCESS)
+                    return result;
+
+                hi = lo;
+            }
+
+            if (hi == lo)
+                lo = addr;
+            hi = addr + 1;
+        }
+    }
+
+    if (hi != lo)
+        return nvm_dedup_forward(nvmdedupp, startaddr, n, buffer, lo, hi);
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[in] startaddr     address within to be erased sector
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupErase(NVMDedupDriver* nvmdedupp, uint32_t startaddr,
+        uint32_t n)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmErase(nvmdedupp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Erases all sectors.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupMassErase(NVMDedupDriver* nvmdedupp)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmMassErase(nvmdedupp->config->nvmp);
+}
+
+/**
+ * @brief   Waits for idle condition.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupSync(NVMDedupDriver* nvmdedupp)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmSync(nvmdedupp->config->nvmp);
+}
+
+/**
+ * @brief   Returns media info.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupGetInfo(NVMDedupDriver* nvmdedupp, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmGetInfo(nvmdedupp->config->nvmp, nvmdip);
+}
+
+/**
+ * @brief   Gains exclusive access to the nvm compare before write device.
+ * @details This function tries to gain ownership to the nvm compare before
+ *          write device, if the device is already being used then the
+ *          invoking thread is queued.
+ * @pre     In order to use this function the option
+ *          @p NVM_DEDUP_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ *
+ * @api
+ */
+void nvmdedupAcquireBus(NVMDedupDriver* nvmdedupp)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+
+#if NVM_DEDUP_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&nvmdedupp->mutex);
+
+    /* Lock the underlying device as well. */
+    nvmAcquire(nvmdedupp->config->nvmp);
+#endif /* NVM_DEDUP_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the nvm compare before write device.
+ * @pre     In order to use this function the option
+ *          @p NVM_DEDUP_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ *
+ * @api
+ */
+void nvmdedupReleaseBus(NVMDedupDriver* nvmdedupp)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+
+#if NVM_DEDUP_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&nvmdedupp->mutex);
+
+    /* Release the underlying device as well. */
+    nvmRelease(nvmdedupp->config->nvmp);
+#endif /* NVM_DEDUP_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Write protects one or more sectors.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[in] startaddr     address within to be protected sector
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupWriteProtect(NVMDedupDriver* nvmdedupp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmWriteProtect(nvmdedupp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write protects the whole device.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupMassWriteProtect(NVMDedupDriver* nvmdedupp)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteProtect(nvmdedupp->config->nvmp);
+}
+
+/**
+ * @brief   Write unprotects one or more sectors.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[in] startaddr     address within to be unprotected sector
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupWriteUnprotect(NVMDedupDriver* nvmdedupp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmWriteUnprotect(nvmdedupp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupMassWriteUnprotect(NVMDedupDriver* nvmdedupp)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteUnprotect(nvmdedupp->config->nvmp);
+}
+
+/**
+ * @brief   Reads multiple segments.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[in] segp          pointer to an array of @p NVMReadSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupReadv(NVMDedupDriver* nvmdedupp, const NVMReadSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmdedupp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmReadv(nvmdedupp->config->nvmp, segp, segn);
+}
+
+/**
+ * @brief   Checks whether a range is erased.
+ *
+ * @param[in] nvmdedupp     pointer to the @p NVMDedupDriver object
+ * @param[in] startaddr     first address to check
+ * @param[in] n             number of bytes to check
+ * @param[out] erasedp      set to @p true if all bytes are erased
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmdedupIsErased(NVMDedupDriver* nvmdedupp, uint32_t startaddr,
+        uint32_t n, bool* erasedp)
+{
+    osalDbgCheck(nvmdedupp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmdedupp->state >= NVM_READY, "invalid state");
+
+    return nvmIsErased(nvmdedupp->config->nvmp, startaddr, n, erasedp);
+}
+
+#endif /* HAL_USE_NVM_DEDUP */
+
+/** @} */
@@ -34,18 +34,32 @@
  *          Data consistency is guaranteed as long as there is no
  *          hardware defect. The device can be written up to 100% of its
  *          reported size. Garbage collection is performed automatically when
- *          necessary. The number of writes is minimized by comparing to be
- *          written data with current content prior to executing writes to the
- *          underlying device.
+ *          necessary, optionally in small steps starting at a configurable
+ *          arena fill level to bound the latency of writes. The number of
+ *          writes is minimized by comparing to be written data with current
+ *          content prior to executing writes to the underlying device.
  *
  *          The memory partitioning is:
- *          - arena a
+ *          - arena 0
  *            - arena header
  *            - slots
- *          - arena b
+ *          - ...
+ *          - arena n - 1
  *            - arena header
  *            - slots
  *
+ *          Arenas are used as a ring. New slots are appended to the newest
+ *          arena. Once it is full the next unused arena is opened, and when
+ *          only one unused arena is left the oldest arena is collected into
+ *          it. Using more than two arenas reduces the amount of memory which
+ *          has to be kept unused for garbage collection and the amount of
+ *          data moved per collection.
+ *
+ *          With the slot index, consecutive payload units written together
+ *          can be stored as a single run record. Its header carries the
+ *          unit count in the top address byte and is followed by the
+ *          payload of all units, spanning as many slots as needed.
+ *
  * @todo    - add write protection pass-through to lower level driver
  *
  */
@@ -56,8 +70,14 @@
 
 static const uint32_t nvm_fee_magic =
         0x86618c51UL +
+        (((NVM_FEE_WRITE_UNIT_SIZE - 2) & 0xff) << 8);
+
+#if NVM_FEE_USE_CHECKPOINT || defined(__DOXYGEN__)
+static const uint32_t nvm_fee_checkpoint_magic =
+        0x3c9d0e27UL +
         (((NVM_FEE_WRITE_UNIT_SIZE - 2) & 0xff) << 8) +
         ((NVM_FEE_SLOT_PAYLOAD_SIZE & 0xff) << 0);
+#endif /* NVM_FEE_USE_CHECKPOINT */
 
 /*===========================================================================*/
 /* Driver exported variables.                                                */
@@ -145,11 +165,13 @@ struct __attribute__((__packed__)) arena_header
     uint32_t magic2;
 #endif
     write_unit_t state_mark[2];
+    /* Format sequence number, zero if checkpoints are disabled. */
+    uint32_t sequence;
+    /* Number of erase cycles, zero if not counted. */
+    uint32_t erase_count;
     /* Pad to 32 bytes. */
-#if NVM_FEE_WRITE_UNIT_SIZE == 8
-    uint8_t unused[32 - sizeof(uint32_t) - sizeof(uint32_t) - 2 * sizeof(write_unit_t)];
-#else
-    uint8_t unused[32 - sizeof(uint32_t) - 2 * sizeof(write_unit_t)];
+#if NVM_FEE_WRITE_UNIT_SIZE != 8
+    uint8_t unused[32 - sizeof(uint32_t) - 2 * sizeof(write_unit_t) - 2 * sizeof(uint32_t)];
 #endif
 };
 
@@ -163,9 +185,198 @@ struct __attribute__((__packed__)) slot
     uint8_t payload[NVM_FEE_SLOT_PAYLOAD_SIZE];
 };
 
+#if NVM_FEE_USE_STATS || defined(__DOXYGEN__)
+/**
+ * @brief   Adds @p n to a statistics counter.
+ */
+#define NVM_FEE_STATS_ADD(nvmfeep, counter, n)                                \
+    ((nvmfeep)->stats.counter += (n))
+#else
+#define NVM_FEE_STATS_ADD(nvmfeep, counter, n) ((void)0)
+#endif /* NVM_FEE_USE_STATS */
+
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+/**
+ * @brief   Index entry value of addresses without a valid slot.
+ */
+#define NVM_FEE_INDEX_EMPTY             ((nvmfeeindex_t)-1)
+#endif /* NVM_FEE_USE_INDEX */
+
+#if NVM_FEE_CACHE_SLOTS || defined(__DOXYGEN__)
+/**
+ * @brief   Address of unused cache entries.
+ */
+#define NVM_FEE_CACHE_EMPTY             0xffffffffUL
+#endif /* NVM_FEE_CACHE_SLOTS */
+
+#if NVM_FEE_USE_TRANSACTION || defined(__DOXYGEN__)
+/**
+ * @brief   Address tag of transaction commit marks.
+ * @details The lower bits of the address hold the number of transaction
+ *          slots directly preceding the mark.
+ */
+#define NVM_FEE_TRANSACTION_MARK        0xff000000UL
+#define NVM_FEE_TRANSACTION_MASK        0xff000000UL
+#endif /* NVM_FEE_USE_TRANSACTION */
+
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+/**
+ * @brief   Unit count field of run record addresses.
+ * @details The top byte of the address holds the number of payload units
+ *          minus one. Unwritten addresses and transaction commit marks
+ *          have all bits of the field set and cover a single unit.
+ */
+#define NVM_FEE_RUN_MASK                0xff000000UL
+#define NVM_FEE_RUN_SHIFT               24
+
+/**
+ * @brief   Maximum number of payload units of a run record.
+ */
+#define NVM_FEE_RUN_MAX                 255
+
+/**
+ * @brief   Payload source of a record write.
+ */
+struct record_source
+{
+    /* Payload of all units of the record or NULL to fill with pattern. */
+    const uint8_t* buffer;
+    uint8_t pattern;
+    /* Take the current data of each unit instead. */
+    bool current;
+};
+#endif /* NVM_FEE_USE_INDEX */
+
+#if NVM_FEE_USE_CHECKPOINT || defined(__DOXYGEN__)
+/**
+ * @brief   Header structure at the beginning of each checkpoint record.
+ * @details The header is followed by a @p checkpoint_arena entry per arena
+ *          and @p index_num slot index entries. Records are padded to a
+ *          multiple of 8 bytes.
+ */
+struct __attribute__((__packed__)) checkpoint_header
+{
+    uint32_t magic;
+    /* CRC32 over the record following this field. */
+    uint32_t crc;
+    uint32_t arena_num;
+    uint32_t index_num;
+};
+
+/**
+ * @brief   Per arena state stored in a checkpoint record.
+ */
+struct __attribute__((__packed__)) checkpoint_arena
+{
+    uint32_t sequence;
+    uint32_t slots;
+};
+#endif /* NVM_FEE_USE_CHECKPOINT */
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
+static uint32_t nvm_fee_record_units(NVMFeeDriver* nvmfeep, uint32_t address)
+{
+#if NVM_FEE_USE_INDEX
+    if (nvmfeep->run_units > 1 &&
+            (address & NVM_FEE_RUN_MASK) != NVM_FEE_RUN_MASK)
+        return (address >> NVM_FEE_RUN_SHIFT) + 1;
+#else
+    (void)nvmfeep;
+    (void)address;
+#endif /* NVM_FEE_USE_INDEX */
+
+    return 1;
+}
+
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+static uint32_t nvm_fee_record_address(NVMFeeDriver* nvmfeep,
+        uint32_t address)
+{
+    if (nvmfeep->run_units > 1 &&
+            (address & NVM_FEE_RUN_MASK) != NVM_FEE_RUN_MASK)
+        return address & ~NVM_FEE_RUN_MASK;
+
+    return address;
+}
+#endif /* NVM_FEE_USE_INDEX */
+
+static uint32_t nvm_fee_record_slots(NVMFeeDriver* nvmfeep, uint32_t units)
+{
+    /* The payload of all units directly follows the header. */
+    return (offsetof(struct slot, payload) +
+            units * nvmfeep->slot_payload_size + nvmfeep->slot_size - 1) /
+            nvmfeep->slot_size;
+}
+
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+static void nvm_fee_index_clear(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck(nvmfeep != NULL);
+
+    if (nvmfeep->config->indexp == NULL)
+        return;
+
+    const uint32_t index_num = nvmfeep->fee_size / nvmfeep->slot_payload_size;
+    for (uint32_t i = 0; i < index_num; ++i)
+        nvmfeep->config->indexp[i] = NVM_FEE_INDEX_EMPTY;
+}
+
+static void nvm_fee_index_update(NVMFeeDriver* nvmfeep, uint32_t address,
+        nvmfeeindex_t entry)
+{
+    osalDbgCheck(nvmfeep != NULL);
+
+    if (nvmfeep->config->indexp == NULL)
+        return;
+
+    /* A run record covers several consecutive addresses. */
+    const uint32_t units = nvm_fee_record_units(nvmfeep, address);
+    address = nvm_fee_record_address(nvmfeep, address);
+
+    for (uint32_t i = 0; i < units; ++i)
+    {
+        /* Ignore addresses outside of the fee, e.g. from broken slots. */
+        if (address >= nvmfeep->fee_size)
+            return;
+
+        nvmfeep->config->indexp[address / nvmfeep->slot_payload_size] = entry;
+        address += nvmfeep->slot_payload_size;
+    }
+}
+#endif /* NVM_FEE_USE_INDEX */
+
+static uint32_t nvm_fee_arena_next(NVMFeeDriver* nvmfeep, uint32_t arena)
+{
+    return (arena + 1 == nvmfeep->arena_num) ? 0 : arena + 1;
+}
+
+static uint32_t nvm_fee_arena_prev(NVMFeeDriver* nvmfeep, uint32_t arena)
+{
+    return (arena == 0) ? nvmfeep->arena_num - 1 : arena - 1;
+}
+
+static uint32_t nvm_fee_arena_unused_num(NVMFeeDriver* nvmfeep)
+{
+    const uint32_t used = (nvmfeep->arena_active + nvmfeep->arena_num -
+            nvmfeep->arena_tail) % nvmfeep->arena_num + 1;
+
+    return nvmfeep->arena_num - used;
+}
+
+static uint32_t nvm_fee_arena_magic(NVMFeeDriver* nvmfeep)
+{
+    /* Two arena layouts without page alignment and run records stay
+     * compatible to older versions. */
+    return (nvm_fee_magic +
+            (((nvmfeep->arena_num - 2) & 0xff) << 16) +
+            ((nvmfeep->slot_payload_size & 0xff) << 0)) ^
+            (nvmfeep->config->page_size * 0x9e3779b1UL) ^
+            ((nvmfeep->slot_payload_size >> 8) * 0x85ebca6bUL) ^
+            ((nvmfeep->run_units > 1) ? 0x27d4eb2fUL : 0);
+}
+
 static enum slot_state nvm_fee_mark_2_slot_state(const write_unit_t markp[])
 {
     if (markp[0] == (write_unit_t)0xffffffffffffffffULL &&
@@ -181,42 +392,304 @@ static enum slot_state nvm_fee_mark_2_slot_state(const write_unit_t markp[])
     return SLOT_STATE_UNKNOWN;
 }
 
+static bool nvm_fee_device_write(NVMFeeDriver* nvmfeep, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    NVM_FEE_STATS_ADD(nvmfeep, bytes_written, n);
+    nvmfeep->map = NULL;
+
+    return nvmLldWrite(NVM_FEE_LLD, nvmfeep->config->nvmp, startaddr, n,
+            buffer);
+}
+
+static bool nvm_fee_device_erase(NVMFeeDriver* nvmfeep, uint32_t startaddr,
+        uint32_t n)
+{
+    nvmfeep->map = NULL;
+
+    return nvmLldErase(NVM_FEE_LLD, nvmfeep->config->nvmp, startaddr, n);
+}
+
+static uint32_t nvm_fee_slot_addr(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t slot)
+{
+    uint32_t offset = sizeof(struct arena_header) + slot * nvmfeep->slot_size;
+
+    if (nvmfeep->page_slots != 0 && slot >= nvmfeep->page_first_slots)
+    {
+        /* The first page is shared with the arena header, each following
+         * page holds a whole number of slots. */
+        slot -= nvmfeep->page_first_slots;
+        offset = (1 + slot / nvmfeep->page_slots) * nvmfeep->config->page_size +
+                (slot % nvmfeep->page_slots) * nvmfeep->slot_size;
+    }
+
+    return nvmfeep->arena_org + arena *
+            nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size + offset;
+}
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+static struct slot* nvm_fee_page_find(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t slot)
+{
+    if (nvmfeep->page_count == 0 || arena != nvmfeep->page_arena ||
+            slot < nvmfeep->page_slot ||
+            slot >= nvmfeep->page_slot + nvmfeep->page_count)
+        return NULL;
+
+    return (struct slot*)(nvmfeep->page_buffer +
+            (slot - nvmfeep->page_slot) * nvmfeep->slot_size);
+}
+
+static bool nvm_fee_page_valid_get(NVMFeeDriver* nvmfeep, uint32_t slot)
+{
+    const uint32_t i = slot - nvmfeep->page_slot;
+
+    return (nvmfeep->page_valid[i / 8] & (1 << (i % 8))) != 0;
+}
+
+static bool nvm_fee_page_flush(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    if (nvmfeep->page_count == 0)
+        return HAL_SUCCESS;
+
+    const uint32_t addr = nvm_fee_slot_addr(nvmfeep, nvmfeep->page_arena,
+            nvmfeep->page_slot);
+    const uint32_t count = nvmfeep->page_count;
+
+    nvmfeep->page_count = 0;
+
+    bool result;
+
+    /* Program all gathered slots in dirty state. */
+    result = nvm_fee_device_write(nvmfeep, addr,
+            count * nvmfeep->slot_size, nvmfeep->page_buffer);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Collect range of slots to validate. */
+    uint32_t first = count;
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (nvm_fee_page_valid_get(nvmfeep, nvmfeep->page_slot + i) == false)
+            continue;
+
+        struct slot* slotp = (struct slot*)(nvmfeep->page_buffer +
+                i * nvmfeep->slot_size);
+        slotp->state_mark[1] = (write_unit_t)0x0000000000000000ULL;
+
+        if (first == count)
+            first = i;
+        last = i;
+    }
+
+    if (first == count)
+        return HAL_SUCCESS;
+
+    /* Set slots to valid with a single write of the unchanged range. */
+    result = nvm_fee_device_write(nvmfeep,
+            addr + first * nvmfeep->slot_size,
+            (last - first + 1) * nvmfeep->slot_size,
+            nvmfeep->page_buffer + first * nvmfeep->slot_size);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_page_program(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t slot, const struct slot* slotp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    const uint32_t count = nvmfeep->page_count;
+
+    /* Only consecutive slots of the same page can be gathered. */
+    if (count == 0 || arena != nvmfeep->page_arena ||
+            slot != nvmfeep->page_slot + count ||
+            (count + 1) * nvmfeep->slot_size > NVM_FEE_PAGE_BUFFER_SIZE ||
+            (nvmfeep->page_slots != 0 &&
+                    nvm_fee_slot_addr(nvmfeep, arena, slot) /
+                            nvmfeep->config->page_size !=
+                    nvm_fee_slot_addr(nvmfeep, arena, nvmfeep->page_slot) /
+                            nvmfeep->config->page_size))
+    {
+        bool result = nvm_fee_page_flush(nvmfeep);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        nvmfeep->page_arena = arena;
+        nvmfeep->page_slot = slot;
+        memset(nvmfeep->page_valid, 0, sizeof(nvmfeep->page_valid));
+    }
+
+    struct slot* imagep = (struct slot*)(nvmfeep->page_buffer +
+            nvmfeep->page_count * nvmfeep->slot_size);
+    memcpy(imagep, slotp, nvmfeep->slot_size);
+    imagep->state_mark[0] = (write_unit_t)0x0000000000000000ULL;
+    imagep->state_mark[1] = (write_unit_t)0xffffffffffffffffULL;
+    ++nvmfeep->page_count;
+
+    return HAL_SUCCESS;
+}
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
 static bool nvm_fee_slot_read(NVMFeeDriver* nvmfeep, uint32_t arena,
         uint32_t slot, struct slot* slotp)
 {
     osalDbgCheck(nvmfeep != NULL);
 
-    const uint32_t addr = arena *
-            nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size +
-            sizeof(struct arena_header) + slot * sizeof(struct slot);
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Slots not yet programmed are served from the page buffer. */
+    const struct slot* imagep = nvm_fee_page_find(nvmfeep, arena, slot);
+    if (imagep != NULL)
+    {
+        memcpy(slotp, imagep, nvmfeep->slot_size);
+        if (nvm_fee_page_valid_get(nvmfeep, slot) == true)
+            slotp->state_mark[1] = (write_unit_t)0x0000000000000000ULL;
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
+    const uint32_t addr = nvm_fee_slot_addr(nvmfeep, arena, slot);
 
-    bool result = nvmRead(nvmfeep->config->nvmp, addr,
-            sizeof(*slotp), (uint8_t*)slotp);
+    bool result = nvmLldRead(NVM_FEE_LLD, nvmfeep->config->nvmp, addr,
+            nvmfeep->slot_size, (uint8_t*)slotp);
     if (result != HAL_SUCCESS)
         return result;
 
     return HAL_SUCCESS;
 }
 
+/**
+ * @brief   Returns a slot for inspection.
+ * @details On memory mapped devices the slot is returned in place, all
+ *          others read it into @p bufp.
+ * @note    The slot returned is valid until the next device write or
+ *          erase, copy it before writing it elsewhere.
+ */
+static bool nvm_fee_slot_map(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t slot, struct slot* bufp, const struct slot** imagepp)
+{
+    osalDbgCheck(nvmfeep != NULL);
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Slots not yet programmed are in RAM only. */
+    if (nvm_fee_page_find(nvmfeep, arena, slot) == NULL)
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+    {
+        if (nvmfeep->map == NULL && nvmfeep->llnvmdi.memory_mapped == true)
+        {
+            const uint8_t* map;
+            if (nvmMap(nvmfeep->config->nvmp, 0,
+                    nvmfeep->llnvmdi.sector_num * nvmfeep->llnvmdi.sector_size,
+                    &map) == HAL_SUCCESS)
+                nvmfeep->map = map;
+        }
+
+        if (nvmfeep->map != NULL)
+        {
+            *imagepp = (const struct slot*)(nvmfeep->map +
+                    nvm_fee_slot_addr(nvmfeep, arena, slot));
+            return HAL_SUCCESS;
+        }
+    }
+
+    *imagepp = bufp;
+
+    return nvm_fee_slot_read(nvmfeep, arena, slot, bufp);
+}
+
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the payload of the unit at @p address of a record.
+ * @details On memory mapped devices the payload is returned in place, all
+ *          others read it into @p bufp.
+ * @note    The payload returned is valid until the next device write or
+ *          erase.
+ */
+static bool nvm_fee_unit_map(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t slot, uint32_t address, struct slot* bufp,
+        const uint8_t** payloadpp)
+{
+    osalDbgCheck(nvmfeep != NULL);
+
+    const struct slot* imagep;
+    bool result = nvm_fee_slot_map(nvmfeep, arena, slot, bufp, &imagep);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    const uint32_t unit = (address -
+            nvm_fee_record_address(nvmfeep, imagep->address)) /
+            nvmfeep->slot_payload_size;
+    if (unit == 0)
+    {
+        *payloadpp = imagep->payload;
+        return HAL_SUCCESS;
+    }
+
+    /* Following units of a run are stored behind the first one. */
+    const uint32_t addr = nvm_fee_slot_addr(nvmfeep, arena, slot) +
+            offsetof(struct slot, payload) +
+            unit * nvmfeep->slot_payload_size;
+
+    if (imagep != bufp)
+    {
+        *payloadpp = nvmfeep->map + addr;
+        return HAL_SUCCESS;
+    }
+
+    *payloadpp = bufp->payload;
+
+    return nvmLldRead(NVM_FEE_LLD, nvmfeep->config->nvmp, addr,
+            nvmfeep->slot_payload_size, bufp->payload);
+}
+#endif /* NVM_FEE_USE_INDEX */
+
+static uint32_t nvm_fee_record_extent(NVMFeeDriver* nvmfeep, uint32_t slot,
+        const struct slot* imagep)
+{
+    if (nvm_fee_mark_2_slot_state(imagep->state_mark) == SLOT_STATE_UNUSED)
+        return 1;
+
+    uint32_t extent = nvm_fee_record_slots(nvmfeep,
+            nvm_fee_record_units(nvmfeep, imagep->address));
+
+    /* A broken header must not reach beyond the arena. */
+    if (extent > nvmfeep->arena_num_slots - slot)
+        extent = nvmfeep->arena_num_slots - slot;
+
+    return extent;
+}
+
 static bool nvm_fee_slot_state_update(NVMFeeDriver* nvmfeep, uint32_t arena,
         uint32_t slot, enum slot_state state)
 {
     osalDbgCheck(nvmfeep != NULL);
     osalDbgCheck(state == SLOT_STATE_DIRTY || state == SLOT_STATE_VALID);
 
-    const uint32_t addr = arena *
-            nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size +
-            sizeof(struct arena_header) + slot * sizeof(struct slot);
+    const uint32_t addr = nvm_fee_slot_addr(nvmfeep, arena, slot);
 
     static const write_unit_t zero_mark;
 
     bool result = false;
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Keep order of device writes. */
+    result = nvm_fee_page_flush(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
     if (state == SLOT_STATE_DIRTY)
-        result= nvmWrite(nvmfeep->config->nvmp,
+        result= nvm_fee_device_write(nvmfeep,
                 addr + offsetof(struct slot, state_mark[0]),
                 sizeof(zero_mark), (uint8_t*)&zero_mark);
     else if (state == SLOT_STATE_VALID)
-        result= nvmWrite(nvmfeep->config->nvmp,
+        result= nvm_fee_device_write(nvmfeep,
                 addr + offsetof(struct slot, state_mark[1]),
                 sizeof(zero_mark), (uint8_t*)&zero_mark);
 
@@ -226,14 +699,18 @@ static bool nvm_fee_slot_state_update(NVMFeeDriver* nvmfeep, uint32_t arena,
     return HAL_SUCCESS;
 }
 
-static bool nvm_fee_slot_write(NVMFeeDriver* nvmfeep, uint32_t arena,
+static bool nvm_fee_slot_program(NVMFeeDriver* nvmfeep, uint32_t arena,
         uint32_t slot, const struct slot* slotp)
 {
     osalDbgCheck((nvmfeep != NULL));
 
-    const uint32_t addr = arena *
-            nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size +
-            sizeof(struct arena_header) + slot * sizeof(struct slot);
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Gather single unit slots in page buffer. */
+    if (nvm_fee_record_units(nvmfeep, slotp->address) == 1)
+        return nvm_fee_page_program(nvmfeep, arena, slot, slotp);
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
+    const uint32_t addr = nvm_fee_slot_addr(nvmfeep, arena, slot);
 
     bool result;
 
@@ -244,15 +721,66 @@ static bool nvm_fee_slot_write(NVMFeeDriver* nvmfeep, uint32_t arena,
         return result;
 
     /* Write new slot. */
-    result = nvmWrite(nvmfeep->config->nvmp, addr + offsetof(struct slot, address),
-            sizeof(*slotp) - offsetof(struct slot, address),
+    result = nvm_fee_device_write(nvmfeep, addr + offsetof(struct slot, address),
+            nvmfeep->slot_size - offsetof(struct slot, address),
             (uint8_t*)slotp + offsetof(struct slot, address));
     if (result != HAL_SUCCESS)
         return result;
 
-    /* Set slot to valid.*/
-    result = nvm_fee_slot_state_update(nvmfeep, arena,
-            slot, SLOT_STATE_VALID);
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_slot_validate(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t slot, uint32_t address)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    if (nvm_fee_page_find(nvmfeep, arena, slot) != NULL)
+    {
+        /* Validated together with the whole page buffer. */
+        const uint32_t i = slot - nvmfeep->page_slot;
+        nvmfeep->page_valid[i / 8] |= 1 << (i % 8);
+    }
+    else
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+    {
+        /* Set slot to valid.*/
+        result = nvm_fee_slot_state_update(nvmfeep, arena,
+                slot, SLOT_STATE_VALID);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+#if NVM_FEE_USE_INDEX
+    /* Newest slot of an address always supersedes older ones. */
+    nvm_fee_index_update(nvmfeep, address,
+            arena * nvmfeep->arena_num_slots + slot);
+#else
+    (void)address;
+#endif /* NVM_FEE_USE_INDEX */
+
+#if NVM_FEE_USE_CHECKPOINT
+    ++nvmfeep->checkpoint_pending;
+#endif /* NVM_FEE_USE_CHECKPOINT */
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_slot_write(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t slot, const struct slot* slotp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+
+    result = nvm_fee_slot_program(nvmfeep, arena, slot, slotp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    result = nvm_fee_slot_validate(nvmfeep, arena, slot, slotp->address);
     if (result != HAL_SUCCESS)
         return result;
 
@@ -266,25 +794,26 @@ static bool nvm_fee_slot_lookup(NVMFeeDriver* nvmfeep, uint32_t arena,
 
     *foundp = false;
 
-    /* Walk through active slots. */
+    /* Walk through used slots. */
     for (uint32_t slot = 0;
-            slot < nvmfeep->arena_slots[nvmfeep->arena_active];
+            slot < nvmfeep->arena_slots[arena];
             ++slot)
     {
         struct slot temp_slot;
+        const struct slot* imagep;
         bool result;
 
         /* Read slot. */
-        result = nvm_fee_slot_read(nvmfeep, arena, slot, &temp_slot);
+        result = nvm_fee_slot_map(nvmfeep, arena, slot, &temp_slot, &imagep);
         if (result != HAL_SUCCESS)
             return result;
 
         /* Skip if slot is not in valid state. */
-        if (nvm_fee_mark_2_slot_state(temp_slot.state_mark) != SLOT_STATE_VALID)
+        if (nvm_fee_mark_2_slot_state(imagep->state_mark) != SLOT_STATE_VALID)
             continue;
 
         /* Check if slot's address matches. */
-        if (temp_slot.address == address)
+        if (imagep->address == address)
         {
             *foundp = true;
             *slotp = slot;
@@ -294,50 +823,258 @@ static bool nvm_fee_slot_lookup(NVMFeeDriver* nvmfeep, uint32_t arena,
     return HAL_SUCCESS;
 }
 
-static enum slot_state nvm_fee_mark_2_arena_state(const write_unit_t markp[])
-{
-    return (enum arena_state)nvm_fee_mark_2_slot_state(markp);
-}
-
-static enum arena_state nvm_fee_arena_state_get(NVMFeeDriver* nvmfeep,
-        uint32_t arena)
+static bool nvm_fee_lookup_newer(NVMFeeDriver* nvmfeep, uint32_t oldest,
+        uint32_t address, uint32_t* arenap, uint32_t* slotp, bool* foundp)
 {
     osalDbgCheck((nvmfeep != NULL));
 
-    const uint32_t addr = arena *
-            nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size;
+    *foundp = false;
 
-    struct arena_header header;
+    /* Walk from the newest arena down to the oldest one of interest. */
+    uint32_t arena = nvmfeep->arena_active;
+    while (true)
+    {
+        bool result = nvm_fee_slot_lookup(nvmfeep, arena, address,
+                slotp, foundp);
+        if (result != HAL_SUCCESS)
+            return result;
 
-    bool result = nvmRead(nvmfeep->config->nvmp, addr,
-            sizeof(header), (uint8_t*)&header);
-    if (result != HAL_SUCCESS)
-        return ARENA_STATE_UNKNOWN;
+        if (*foundp == true)
+        {
+            *arenap = arena;
+            return HAL_SUCCESS;
+        }
 
-    if (header.magic != nvm_fee_magic)
-        return ARENA_STATE_UNKNOWN;
+        if (arena == oldest)
+            break;
 
-    return nvm_fee_mark_2_arena_state(header.state_mark);
+        arena = nvm_fee_arena_prev(nvmfeep, arena);
+    }
+
+    return HAL_SUCCESS;
 }
 
-static bool nvm_fee_arena_state_update(NVMFeeDriver* nvmfeep, uint32_t arena,
-        enum arena_state state)
+static bool nvm_fee_lookup(NVMFeeDriver* nvmfeep, uint32_t address,
+        uint32_t* arenap, uint32_t* slotp, bool* foundp)
 {
     osalDbgCheck((nvmfeep != NULL));
-    osalDbgCheck(state == ARENA_STATE_ACTIVE || state == ARENA_STATE_FROZEN);
 
-    const uint32_t addr = arena *
+    *foundp = false;
+
+#if NVM_FEE_USE_INDEX
+    if (nvmfeep->config->indexp != NULL)
+    {
+        const nvmfeeindex_t entry =
+                nvmfeep->config->indexp[address / nvmfeep->slot_payload_size];
+        if (entry != NVM_FEE_INDEX_EMPTY)
+        {
+            *foundp = true;
+            *arenap = entry / nvmfeep->arena_num_slots;
+            *slotp = entry % nvmfeep->arena_num_slots;
+        }
+
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_FEE_USE_INDEX */
+
+    return nvm_fee_lookup_newer(nvmfeep, nvmfeep->arena_tail, address,
+            arenap, slotp, foundp);
+}
+
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+static bool nvm_fee_record_unit(NVMFeeDriver* nvmfeep,
+        const struct record_source* srcp, uint32_t address, uint32_t unit,
+        uint8_t* payload)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    if (srcp->current == true)
+    {
+        bool result;
+        bool found;
+        uint32_t arena;
+        uint32_t slot;
+
+        result = nvm_fee_lookup(nvmfeep, address, &arena, &slot, &found);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (found == false)
+        {
+            memset(payload, 0xff, nvmfeep->slot_payload_size);
+            return HAL_SUCCESS;
+        }
+
+        struct slot temp_slot;
+        const uint8_t* payloadp;
+        result = nvm_fee_unit_map(nvmfeep, arena, slot, address, &temp_slot,
+                &payloadp);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        memcpy(payload, payloadp, nvmfeep->slot_payload_size);
+    }
+    else if (srcp->buffer != NULL)
+    {
+        memcpy(payload, srcp->buffer + unit * nvmfeep->slot_payload_size,
+                nvmfeep->slot_payload_size);
+    }
+    else
+    {
+        memset(payload, srcp->pattern, nvmfeep->slot_payload_size);
+    }
+
+    return HAL_SUCCESS;
+}
+
+/*
+ * @brief   Writes a record covering @p units consecutive payload units.
+ *
+ *          - Program the first slot holding the header and the first unit.
+ *          - Program the following slots with the remaining units.
+ *          - Mark the record valid.
+ *
+ *          A record interrupted while programming its first slot leaves the
+ *          following slots blank, so the arena can still be walked.
+ */
+static bool nvm_fee_record_write(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t slot, uint32_t address, uint32_t units,
+        const struct record_source* srcp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+    osalDbgCheck((units >= 1) && (units <= nvmfeep->run_units));
+
+    const uint32_t header_size = offsetof(struct slot, payload);
+    const uint32_t payload_size = units * nvmfeep->slot_payload_size;
+
+    bool result;
+    struct slot temp_slot;
+    uint8_t payload[NVM_FEE_SLOT_PAYLOAD_SIZE];
+
+    /* Program first slot. */
+    temp_slot.state_mark[0] = (write_unit_t)0x0000000000000000ULL;
+    temp_slot.state_mark[1] = (write_unit_t)0x0000000000000000ULL;
+    temp_slot.address = address + ((units - 1) << NVM_FEE_RUN_SHIFT);
+    result = nvm_fee_record_unit(nvmfeep, srcp, address, 0,
+            temp_slot.payload);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    result = nvm_fee_slot_program(nvmfeep, arena, slot, &temp_slot);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Program following slots, each one with a single aligned write. */
+    for (uint32_t i = 1; i < nvm_fee_record_slots(nvmfeep, units); ++i)
+    {
+        uint8_t* chunk = (uint8_t*)&temp_slot;
+        memset(chunk, 0xff, nvmfeep->slot_size);
+
+        /* Payload range of this slot. */
+        uint32_t pos = i * nvmfeep->slot_size - header_size;
+        uint32_t end = pos + nvmfeep->slot_size;
+        if (end > payload_size)
+            end = payload_size;
+
+        while (pos < end)
+        {
+            const uint32_t unit = pos / nvmfeep->slot_payload_size;
+            const uint32_t offset = pos % nvmfeep->slot_payload_size;
+            uint32_t n = nvmfeep->slot_payload_size - offset;
+            if (n > end - pos)
+                n = end - pos;
+
+            result = nvm_fee_record_unit(nvmfeep, srcp,
+                    address + unit * nvmfeep->slot_payload_size, unit,
+                    payload);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            memcpy(chunk + header_size + pos - i * nvmfeep->slot_size,
+                    payload + offset, n);
+            pos += n;
+        }
+
+        result = nvm_fee_device_write(nvmfeep,
+                nvm_fee_slot_addr(nvmfeep, arena, slot + i),
+                nvmfeep->slot_size, chunk);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    /* Set record valid, the index then points all units to it. */
+    result = nvm_fee_slot_validate(nvmfeep, arena, slot,
+            address + ((units - 1) << NVM_FEE_RUN_SHIFT));
+    if (result != HAL_SUCCESS)
+        return result;
+
+    return HAL_SUCCESS;
+}
+#endif /* NVM_FEE_USE_INDEX */
+
+static enum slot_state nvm_fee_mark_2_arena_state(const write_unit_t markp[])
+{
+    return (enum arena_state)nvm_fee_mark_2_slot_state(markp);
+}
+
+static enum arena_state nvm_fee_arena_state_get(NVMFeeDriver* nvmfeep,
+        uint32_t arena)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    const uint32_t addr = nvmfeep->arena_org + arena *
+            nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size;
+
+    struct arena_header header;
+
+    bool result = nvmLldRead(NVM_FEE_LLD, nvmfeep->config->nvmp, addr,
+            sizeof(header), (uint8_t*)&header);
+    if (result != HAL_SUCCESS)
+        return ARENA_STATE_UNKNOWN;
+
+    if (header.magic != nvm_fee_arena_magic(nvmfeep))
+        return ARENA_STATE_UNKNOWN;
+
+#if NVM_FEE_USE_CHECKPOINT
+    /* Remember sequence number to validate checkpoints. */
+    nvmfeep->arena_sequence[arena] = header.sequence;
+    if ((int32_t)(header.sequence - nvmfeep->sequence) > 0)
+        nvmfeep->sequence = header.sequence;
+#endif /* NVM_FEE_USE_CHECKPOINT */
+
+#if NVM_FEE_USE_ERASE_COUNTER
+    nvmfeep->stats.erase_count[arena] = header.erase_count;
+#endif /* NVM_FEE_USE_ERASE_COUNTER */
+
+    return nvm_fee_mark_2_arena_state(header.state_mark);
+}
+
+static bool nvm_fee_arena_state_update(NVMFeeDriver* nvmfeep, uint32_t arena,
+        enum arena_state state)
+{
+    osalDbgCheck((nvmfeep != NULL));
+    osalDbgCheck(state == ARENA_STATE_ACTIVE || state == ARENA_STATE_FROZEN);
+
+    const uint32_t addr = nvmfeep->arena_org + arena *
             nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size;
 
     static const write_unit_t zero_mark;
 
     bool result = false;
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Keep order of device writes. */
+    result = nvm_fee_page_flush(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
     if (state == ARENA_STATE_ACTIVE)
-        result = nvmWrite(nvmfeep->config->nvmp,
+        result = nvm_fee_device_write(nvmfeep,
                     addr + offsetof(struct arena_header, state_mark[0]),
                     sizeof(zero_mark), (uint8_t*)&zero_mark);
     else if (state == ARENA_STATE_FROZEN)
-        result = nvmWrite(nvmfeep->config->nvmp,
+        result = nvm_fee_device_write(nvmfeep,
                     addr + offsetof(struct arena_header, state_mark[1]),
                     sizeof(zero_mark), (uint8_t*)&zero_mark);
 
@@ -347,63 +1084,156 @@ static bool nvm_fee_arena_state_update(NVMFeeDriver* nvmfeep, uint32_t arena,
     return HAL_SUCCESS;
 }
 
-static bool nvm_fee_arena_load(NVMFeeDriver* nvmfeep, uint32_t arena)
+static bool nvm_fee_arena_load(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t first_slot)
 {
     osalDbgCheck((nvmfeep != NULL));
 
-    nvmfeep->arena_slots[arena] = 0;
+    nvmfeep->arena_slots[arena] = first_slot;
 
     bool result;
+    uint32_t extent = 1;
 
-    /* Walk through active slots. */
-    for (uint32_t slot = 0;
+    /* Walk through active slots, a run record takes several ones. */
+    for (uint32_t slot = first_slot;
             slot < nvmfeep->arena_num_slots;
-            ++slot)
+            slot += extent)
     {
         struct slot temp_slot;
+        const struct slot* imagep;
 
         /* Read slot. */
-        result = nvm_fee_slot_read(nvmfeep, arena, slot, &temp_slot);
+        result = nvm_fee_slot_map(nvmfeep, arena, slot, &temp_slot, &imagep);
         if (result != HAL_SUCCESS)
             return result;
 
-        if (nvm_fee_mark_2_slot_state(temp_slot.state_mark) !=
-                SLOT_STATE_UNUSED)
+        const enum slot_state state =
+                nvm_fee_mark_2_slot_state(imagep->state_mark);
+        extent = nvm_fee_record_extent(nvmfeep, slot, imagep);
+
+        if (state != SLOT_STATE_UNUSED)
+        {
+            nvmfeep->arena_slots[arena] = slot + extent;
+        }
+#if NVM_FEE_USE_CHECKPOINT
+        else if (first_slot != 0)
+        {
+            /* Slots are appended in order, so when replaying the slots
+             * written after a checkpoint the first unused one ends the
+             * arena. */
+            break;
+        }
+#endif /* NVM_FEE_USE_CHECKPOINT */
+
+#if NVM_FEE_USE_INDEX
+        /* Arenas are loaded from oldest to newest. */
+        if (state == SLOT_STATE_VALID)
+            nvm_fee_index_update(nvmfeep, imagep->address,
+                    arena * nvmfeep->arena_num_slots + slot);
+#endif /* NVM_FEE_USE_INDEX */
+
+#if NVM_FEE_USE_TRANSACTION
+        /* A valid commit mark completes the preceding transaction slots. */
+        if (state == SLOT_STATE_VALID &&
+                (imagep->address & NVM_FEE_TRANSACTION_MASK) ==
+                        NVM_FEE_TRANSACTION_MARK)
         {
-            nvmfeep->arena_slots[arena] = slot + 1;
+            const uint32_t num = imagep->address & ~NVM_FEE_TRANSACTION_MASK;
+
+            for (uint32_t i = (num < slot) ? slot - num : 0; i < slot; ++i)
+            {
+                struct slot txn_slot;
+                const struct slot* txnp;
+                result = nvm_fee_slot_map(nvmfeep, arena, i, &txn_slot, &txnp);
+                if (result != HAL_SUCCESS)
+                    return result;
+
+                if (nvm_fee_mark_2_slot_state(txnp->state_mark) !=
+                        SLOT_STATE_DIRTY)
+                    continue;
+
+                result = nvm_fee_slot_validate(nvmfeep, arena, i,
+                        txnp->address);
+                if (result != HAL_SUCCESS)
+                    return result;
+            }
         }
+#endif /* NVM_FEE_USE_TRANSACTION */
     }
 
     return HAL_SUCCESS;
 }
 
-static bool nvm_fee_arena_erase(NVMFeeDriver* nvmfeep, uint32_t arena)
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+static bool nvm_fee_index_rebuild(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    if (nvmfeep->config->indexp == NULL)
+        return HAL_SUCCESS;
+
+    nvm_fee_index_clear(nvmfeep);
+
+    /* Load arenas from oldest to newest. */
+    for (uint32_t arena = nvmfeep->arena_tail; ;
+            arena = nvm_fee_arena_next(nvmfeep, arena))
+    {
+        bool result = nvm_fee_arena_load(nvmfeep, arena, 0);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (arena == nvmfeep->arena_active)
+            break;
+    }
+
+    return HAL_SUCCESS;
+}
+#endif /* NVM_FEE_USE_INDEX */
+
+static bool nvm_fee_arena_format(NVMFeeDriver* nvmfeep, uint32_t arena)
 {
     osalDbgCheck((nvmfeep != NULL));
 
-    const uint32_t addr = arena *
+    const uint32_t addr = nvmfeep->arena_org + arena *
             nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size;
 
     bool result;
 
-    /* Mass erase underlying nvm device. */
-    result = nvmErase(nvmfeep->config->nvmp, addr,
-            nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size);
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Keep order of device writes. */
+    result = nvm_fee_page_flush(nvmfeep);
     if (result != HAL_SUCCESS)
         return result;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
+#if NVM_FEE_USE_CHECKPOINT
+    /* Each format invalidates checkpoints referring to this arena. */
+    nvmfeep->arena_sequence[arena] = ++nvmfeep->sequence;
+#endif /* NVM_FEE_USE_CHECKPOINT */
+
+#if NVM_FEE_USE_ERASE_COUNTER
+    /* Each format follows an erase of the arena. */
+    ++nvmfeep->stats.erase_count[arena];
+#endif /* NVM_FEE_USE_ERASE_COUNTER */
 
     /* Set magic. */
     const struct arena_header header =
     {
-        .magic = nvm_fee_magic,
+        .magic = nvm_fee_arena_magic(nvmfeep),
 #if NVM_FEE_WRITE_UNIT_SIZE == 8
-        .magic2 = nvm_fee_magic,
+        .magic2 = nvm_fee_arena_magic(nvmfeep),
 #endif
         .state_mark[0] = (write_unit_t)0xffffffffffffffffULL,
         .state_mark[1] = (write_unit_t)0xffffffffffffffffULL,
+#if NVM_FEE_USE_CHECKPOINT
+        .sequence = nvmfeep->arena_sequence[arena],
+#endif /* NVM_FEE_USE_CHECKPOINT */
+#if NVM_FEE_USE_ERASE_COUNTER
+        .erase_count = nvmfeep->stats.erase_count[arena],
+#endif /* NVM_FEE_USE_ERASE_COUNTER */
     };
 
-    result = nvmWrite(nvmfeep->config->nvmp, addr,
+    result = nvm_fee_device_write(nvmfeep, addr,
             sizeof(header), (uint8_t*)&header);
     if (result != HAL_SUCCESS)
         return result;
@@ -413,166 +1243,1724 @@ static bool nvm_fee_arena_erase(NVMFeeDriver* nvmfeep, uint32_t arena)
     return HAL_SUCCESS;
 }
 
-static bool nvm_fee_gc(NVMFeeDriver* nvmfeep, uint32_t omit_addr)
+static bool nvm_fee_arena_erase(NVMFeeDriver* nvmfeep, uint32_t arena)
 {
     osalDbgCheck((nvmfeep != NULL));
 
-    uint32_t src_arena;
-    uint32_t dst_arena;
+    const uint32_t addr = nvmfeep->arena_org + arena *
+            nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size;
+
+    bool result;
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Keep order of device writes. */
+    result = nvm_fee_page_flush(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
 
-    if (nvmfeep->arena_active == 0)
+    /* Erase sectors of the arena which are not blank already. */
+    for (uint32_t i = 0; i < nvmfeep->arena_num_sectors; ++i)
     {
-        src_arena = 0;
-        dst_arena = 1;
+        const uint32_t sector_addr = addr + i * nvmfeep->llnvmdi.sector_size;
+        bool erased;
+
+        result = nvmIsErased(nvmfeep->config->nvmp, sector_addr,
+                nvmfeep->llnvmdi.sector_size, &erased);
+        if (result != HAL_SUCCESS)
+            return result;
+        if (erased == true)
+            continue;
+
+        result = nvm_fee_device_erase(nvmfeep, sector_addr,
+                nvmfeep->llnvmdi.sector_size);
+        if (result != HAL_SUCCESS)
+            return result;
     }
-    else
+
+    result = nvm_fee_arena_format(nvmfeep, arena);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_arena_advance(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+    osalDbgAssert(nvm_fee_arena_unused_num(nvmfeep) > 1, "no unused arena");
+
+    const uint32_t arena = nvm_fee_arena_next(nvmfeep, nvmfeep->arena_active);
+
+    /* Open the next unused arena without collecting anything. */
+    bool result = nvm_fee_arena_state_update(nvmfeep, arena,
+            ARENA_STATE_ACTIVE);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    nvmfeep->arena_active = arena;
+
+    return HAL_SUCCESS;
+}
+
+#if NVM_FEE_USE_CHECKPOINT || defined(__DOXYGEN__)
+static uint32_t nvm_fee_crc32(uint32_t crc, const uint8_t* datap, uint32_t n)
+{
+    crc = ~crc;
+    while (n--)
     {
-        src_arena = 1;
-        dst_arena = 0;
+        crc ^= *datap++;
+        for (uint32_t i = 0; i < 8; ++i)
+            crc = (crc >> 1) ^ (0xedb88320UL & -(crc & 1));
     }
+    return ~crc;
+}
 
-    nvmfeep->arena_slots[dst_arena] = 0;
+static uint32_t nvm_fee_checkpoint_index_num(NVMFeeDriver* nvmfeep)
+{
+#if NVM_FEE_USE_INDEX
+    if (nvmfeep->config->indexp != NULL)
+        return nvmfeep->fee_size / nvmfeep->slot_payload_size;
+#endif /* NVM_FEE_USE_INDEX */
 
-    bool result;
+    return 0;
+}
 
-    /* stage 1: Freeze source arena. */
-    result = nvm_fee_arena_state_update(nvmfeep, src_arena, ARENA_STATE_FROZEN);
+static uint32_t nvm_fee_checkpoint_size(NVMFeeDriver* nvmfeep)
+{
+    uint32_t size = sizeof(struct checkpoint_header) +
+            nvmfeep->arena_num * sizeof(struct checkpoint_arena);
+#if NVM_FEE_USE_INDEX
+    size += nvm_fee_checkpoint_index_num(nvmfeep) * sizeof(nvmfeeindex_t);
+#endif /* NVM_FEE_USE_INDEX */
+
+    return (size + 7) & ~7UL;
+}
+
+static bool nvm_fee_checkpoint_clear(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    nvmfeep->checkpoint_offset = 0;
+
+    if (nvmfeep->arena_org == 0)
+        return HAL_SUCCESS;
+
+    bool result = nvm_fee_device_erase(nvmfeep, 0, nvmfeep->arena_org);
     if (result != HAL_SUCCESS)
         return result;
 
-    /* stage 2: Copy active slots to destination arena. */
-    for (uint32_t addr = 0;
-            addr < nvmfeep->fee_size;
-            addr += NVM_FEE_SLOT_PAYLOAD_SIZE)
-    {
-        /* Skip one slot to allow full write. */
-        if (addr == omit_addr)
-            continue;
+    return HAL_SUCCESS;
+}
 
-        /* Look for existing slot. */
-        bool found;
-        uint32_t slot;
+static bool nvm_fee_checkpoint_write(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    /* Checkpoints are disabled without metadata sectors. */
+    if (nvmfeep->arena_org == 0)
+        return HAL_SUCCESS;
+
+    bool result;
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Checkpoints must not refer to slots which are not programmed. */
+    result = nvm_fee_page_flush(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
 
-        result = nvm_fee_slot_lookup(nvmfeep, src_arena, addr, &slot, &found);
+    const uint32_t size = nvm_fee_checkpoint_size(nvmfeep);
+
+    /* Start over once the metadata sectors are exhausted. */
+    if (nvmfeep->checkpoint_offset + size > nvmfeep->arena_org)
+    {
+        result = nvm_fee_checkpoint_clear(nvmfeep);
         if (result != HAL_SUCCESS)
             return result;
+    }
 
-        if (found)
-        {
-            /* Read slot. */
-            struct slot temp_slot;
-            result = nvm_fee_slot_read(nvmfeep, src_arena, slot, &temp_slot);
-            if (result != HAL_SUCCESS)
-                return result;
-
-            /* Write new slot. */
-            result = nvm_fee_slot_write(nvmfeep, dst_arena,
-                    nvmfeep->arena_slots[dst_arena], &temp_slot);
-            if (result != HAL_SUCCESS)
-                return result;
+    struct checkpoint_header header =
+    {
+        .magic = nvm_fee_checkpoint_magic,
+        .crc = 0,
+        .arena_num = nvmfeep->arena_num,
+        .index_num = nvm_fee_checkpoint_index_num(nvmfeep),
+    };
 
-            ++nvmfeep->arena_slots[dst_arena];
-        }
+    struct checkpoint_arena arenas[NVM_FEE_MAX_ARENAS];
+    for (uint32_t arena = 0; arena < nvmfeep->arena_num; ++arena)
+    {
+        arenas[arena].sequence = nvmfeep->arena_sequence[arena];
+        arenas[arena].slots = nvmfeep->arena_slots[arena];
     }
 
-    /* stage 3: Activate destination arena. */
-    result = nvm_fee_arena_state_update(nvmfeep, dst_arena, ARENA_STATE_ACTIVE);
+    const uint32_t arenas_size =
+            nvmfeep->arena_num * sizeof(struct checkpoint_arena);
+    const uint8_t* indexp = NULL;
+    uint32_t index_size = 0;
+#if NVM_FEE_USE_INDEX
+    indexp = (const uint8_t*)nvmfeep->config->indexp;
+    index_size = header.index_num * sizeof(nvmfeeindex_t);
+#endif /* NVM_FEE_USE_INDEX */
+
+    /* Keep writes aligned by moving the index tail into a padded buffer. */
+    const uint32_t index_bulk = index_size & ~7UL;
+    uint8_t tail[8];
+    memset(tail, 0xff, sizeof(tail));
+    memcpy(tail, indexp + index_bulk, index_size - index_bulk);
+    const uint32_t tail_size = size - sizeof(header) - arenas_size - index_bulk;
+
+    header.crc = nvm_fee_crc32(0,
+            (const uint8_t*)&header + offsetof(struct checkpoint_header,
+                    arena_num),
+            sizeof(header) - offsetof(struct checkpoint_header, arena_num));
+    header.crc = nvm_fee_crc32(header.crc, (const uint8_t*)arenas,
+            arenas_size);
+    header.crc = nvm_fee_crc32(header.crc, indexp, index_bulk);
+    header.crc = nvm_fee_crc32(header.crc, tail, tail_size);
+
+    uint32_t addr = nvmfeep->checkpoint_offset;
+
+    result = nvm_fee_device_write(nvmfeep, addr,
+            sizeof(header), (const uint8_t*)&header);
     if (result != HAL_SUCCESS)
         return result;
+    addr += sizeof(header);
 
-    /* stage 4: Reinit source arena. */
-    result = nvm_fee_arena_erase(nvmfeep, src_arena);
+    result = nvm_fee_device_write(nvmfeep, addr,
+            arenas_size, (const uint8_t*)arenas);
     if (result != HAL_SUCCESS)
         return result;
+    addr += arenas_size;
+
+    if (index_bulk != 0)
+    {
+        result = nvm_fee_device_write(nvmfeep, addr, index_bulk, indexp);
+        if (result != HAL_SUCCESS)
+            return result;
+        addr += index_bulk;
+    }
+
+    if (tail_size != 0)
+    {
+        result = nvm_fee_device_write(nvmfeep, addr, tail_size, tail);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    nvmfeep->checkpoint_offset += size;
+    nvmfeep->checkpoint_pending = 0;
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_checkpoint_restore(NVMFeeDriver* nvmfeep,
+        uint32_t first_slots[])
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    for (uint32_t arena = 0; arena < nvmfeep->arena_num; ++arena)
+        first_slots[arena] = 0;
+
+    nvmfeep->checkpoint_offset = 0;
+    nvmfeep->checkpoint_pending = 0;
+
+    /* Checkpoints are disabled without metadata sectors. */
+    if (nvmfeep->arena_org == 0)
+        return HAL_SUCCESS;
+
+    bool result;
+
+    const uint32_t size = nvm_fee_checkpoint_size(nvmfeep);
+
+    /* Find most recent record. */
+    bool found = false;
+    uint32_t record = 0;
+    while (nvmfeep->checkpoint_offset + size <= nvmfeep->arena_org)
+    {
+        uint32_t magic;
+        result = nvmLldRead(NVM_FEE_LLD, nvmfeep->config->nvmp,
+                nvmfeep->checkpoint_offset, sizeof(magic), (uint8_t*)&magic);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (magic == 0xffffffffUL)
+            break;
+
+        if (magic != nvm_fee_checkpoint_magic)
+        {
+            found = false;
+            break;
+        }
+
+        found = true;
+        record = nvmfeep->checkpoint_offset;
+        nvmfeep->checkpoint_offset += size;
+    }
+
+    if (found == true)
+    {
+        struct checkpoint_header header;
+        result = nvmLldRead(NVM_FEE_LLD, nvmfeep->config->nvmp, record,
+                sizeof(header), (uint8_t*)&header);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        struct checkpoint_arena arenas[NVM_FEE_MAX_ARENAS];
+        const uint32_t arenas_size =
+                nvmfeep->arena_num * sizeof(struct checkpoint_arena);
+        result = nvmLldRead(NVM_FEE_LLD, nvmfeep->config->nvmp,
+                record + sizeof(header), arenas_size, (uint8_t*)arenas);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        uint32_t crc = nvm_fee_crc32(0,
+                (const uint8_t*)&header + offsetof(struct checkpoint_header,
+                        arena_num),
+                sizeof(header) - offsetof(struct checkpoint_header, arena_num));
+        crc = nvm_fee_crc32(crc, (const uint8_t*)arenas, arenas_size);
+
+        /* Record has to match current layout and arena instances. */
+        found = header.arena_num == nvmfeep->arena_num &&
+                header.index_num == nvm_fee_checkpoint_index_num(nvmfeep);
+        for (uint32_t arena = 0; found == true && arena < nvmfeep->arena_num;
+                ++arena)
+            found = arenas[arena].sequence == nvmfeep->arena_sequence[arena] &&
+                    arenas[arena].slots <= nvmfeep->arena_num_slots;
+
+        if (found == true)
+        {
+            uint32_t addr = record + sizeof(header) + arenas_size;
+            uint32_t remaining = size - sizeof(header) - arenas_size;
+
+#if NVM_FEE_USE_INDEX
+            if (header.index_num != 0)
+            {
+                /* Read index snapshot in place. */
+                const uint32_t index_bulk =
+                        (header.index_num * sizeof(nvmfeeindex_t)) & ~7UL;
+                uint8_t* indexp = (uint8_t*)nvmfeep->config->indexp;
+
+                result = nvmLldRead(NVM_FEE_LLD, nvmfeep->config->nvmp, addr,
+                        index_bulk, indexp);
+                if (result != HAL_SUCCESS)
+                    return result;
+
+                crc = nvm_fee_crc32(crc, indexp, index_bulk);
+                addr += index_bulk;
+                remaining -= index_bulk;
+
+                uint8_t tail[8];
+                result = nvmLldRead(NVM_FEE_LLD, nvmfeep->config->nvmp, addr,
+                        remaining, tail);
+                if (result != HAL_SUCCESS)
+                    return result;
+
+                crc = nvm_fee_crc32(crc, tail, remaining);
+                memcpy(indexp + index_bulk, tail,
+                        header.index_num * sizeof(nvmfeeindex_t) - index_bulk);
+                remaining = 0;
+            }
+#endif /* NVM_FEE_USE_INDEX */
+
+            if (remaining != 0)
+            {
+                uint8_t tail[8];
+                result = nvmLldRead(NVM_FEE_LLD, nvmfeep->config->nvmp, addr,
+                        remaining, tail);
+                if (result != HAL_SUCCESS)
+                    return result;
+
+                crc = nvm_fee_crc32(crc, tail, remaining);
+            }
+
+            found = crc == header.crc;
+        }
+
+        if (found == true)
+        {
+            for (uint32_t arena = 0; arena < nvmfeep->arena_num; ++arena)
+                first_slots[arena] = arenas[arena].slots;
+
+            return HAL_SUCCESS;
+        }
+
+#if NVM_FEE_USE_INDEX
+        /* Drop partially restored index. */
+        nvm_fee_index_clear(nvmfeep);
+#endif /* NVM_FEE_USE_INDEX */
+    }
+
+    /* Without a usable record the metadata sectors might hold garbage. */
+    if (found == false && nvmfeep->checkpoint_offset != 0)
+    {
+        result = nvm_fee_checkpoint_clear(nvmfeep);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+#endif /* NVM_FEE_USE_CHECKPOINT */
+
+static bool nvm_fee_slot_is_stale(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t slot, const struct slot* slotp, bool* stalep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+#if NVM_FEE_USE_INDEX
+    if (nvmfeep->config->indexp != NULL)
+    {
+        *stalep = nvmfeep->config->indexp[slotp->address /
+                nvmfeep->slot_payload_size] !=
+                arena * nvmfeep->arena_num_slots + slot;
+
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_FEE_USE_INDEX */
+
+    *stalep = false;
+
+    /* Slot is the newest copy if no newer arena holds its address. */
+    if (arena == nvmfeep->arena_active)
+        return HAL_SUCCESS;
+
+    uint32_t newer_arena;
+    uint32_t newer_slot;
+
+    return nvm_fee_lookup_newer(nvmfeep, nvm_fee_arena_next(nvmfeep, arena),
+            slotp->address, &newer_arena, &newer_slot, stalep);
+}
+
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+static bool nvm_fee_unit_is_live(NVMFeeDriver* nvmfeep, uint32_t address,
+        nvmfeeindex_t entry)
+{
+    return address < nvmfeep->fee_size &&
+            nvmfeep->config->indexp[address / nvmfeep->slot_payload_size] ==
+                    entry;
+}
+
+/**
+ * @brief   Copies the live units of a run record.
+ * @details Live units are copied as runs of consecutive units. If these
+ *          take more slots than the whole record, the record is copied as a
+ *          whole with the current data of its superseded units instead. The
+ *          copy thus never takes more slots than the record nor than its
+ *          live units, so a collection always fits into the destination
+ *          arena.
+ */
+static bool nvm_fee_gc_copy_record(NVMFeeDriver* nvmfeep, uint32_t src_arena,
+        uint32_t slot, uint32_t dst_arena, uint32_t omit_addr,
+        uint32_t* extentp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+
+    /* Read slot. */
+    struct slot temp_slot;
+    const struct slot* imagep;
+    result = nvm_fee_slot_map(nvmfeep, src_arena, slot, &temp_slot, &imagep);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    *extentp = nvm_fee_record_extent(nvmfeep, slot, imagep);
+
+    /* Skip if slot is not in valid state. */
+    if (nvm_fee_mark_2_slot_state(imagep->state_mark) != SLOT_STATE_VALID)
+        return HAL_SUCCESS;
+
+    const uint32_t address = nvm_fee_record_address(nvmfeep, imagep->address);
+    const nvmfeeindex_t entry = src_arena * nvmfeep->arena_num_slots + slot;
+    const uint32_t step = nvmfeep->slot_payload_size;
+    if (address >= nvmfeep->fee_size)
+        return HAL_SUCCESS;
+
+    /* Units outside of the fee are dropped. */
+    uint32_t units = nvm_fee_record_units(nvmfeep, imagep->address);
+    if (units > (nvmfeep->fee_size - address) / step)
+        units = (nvmfeep->fee_size - address) / step;
+
+    /* Slots taken by the live units, the omitted one is about to be
+     * written. */
+    uint32_t live_slots = 0;
+    for (uint32_t i = 0, n = 0; i <= units; ++i)
+    {
+        if (i < units && address + i * step != omit_addr &&
+                nvm_fee_unit_is_live(nvmfeep, address + i * step, entry))
+        {
+            ++n;
+            continue;
+        }
+
+        if (n != 0)
+            live_slots += nvm_fee_record_slots(nvmfeep, n);
+        n = 0;
+    }
+    if (live_slots == 0)
+        return HAL_SUCCESS;
+
+    const bool whole = nvm_fee_record_slots(nvmfeep, units) < live_slots;
+    const struct record_source source = { .current = true };
+
+    for (uint32_t i = 0; i < units; )
+    {
+        /* Find next run of units to copy. */
+        uint32_t n = 0;
+        while (i + n < units && (whole == true ||
+                (address + (i + n) * step != omit_addr &&
+                 nvm_fee_unit_is_live(nvmfeep, address + (i + n) * step,
+                         entry))))
+            ++n;
+
+        if (n == 0)
+        {
+            ++i;
+            continue;
+        }
+
+        const uint32_t extent = nvm_fee_record_slots(nvmfeep, n);
+
+        osalDbgAssert(nvmfeep->arena_slots[dst_arena] + extent <=
+                nvmfeep->arena_num_slots, "arena overflow");
+        if (nvmfeep->arena_slots[dst_arena] + extent >
+                nvmfeep->arena_num_slots)
+            return HAL_FAILED;
+
+        /* Write new record. */
+        result = nvm_fee_record_write(nvmfeep, dst_arena,
+                nvmfeep->arena_slots[dst_arena], address + i * step, n,
+                &source);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        nvmfeep->arena_slots[dst_arena] += extent;
+        i += n;
+    }
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_gc_copy_indexed(NVMFeeDriver* nvmfeep, uint32_t src_arena,
+        uint32_t dst_arena, uint32_t omit_addr)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    if (nvmfeep->run_units > 1)
+    {
+        /* A run record covers several addresses, walk the records. */
+        uint32_t extent;
+        for (uint32_t slot = 0;
+                slot < nvmfeep->arena_slots[src_arena];
+                slot += extent)
+        {
+            bool result = nvm_fee_gc_copy_record(nvmfeep, src_arena, slot,
+                    dst_arena, omit_addr, &extent);
+            if (result != HAL_SUCCESS)
+                return result;
+        }
+
+        return HAL_SUCCESS;
+    }
+
+    /* The index already knows the newest slot of each address. */
+    for (uint32_t addr = 0;
+            addr < nvmfeep->fee_size;
+            addr += nvmfeep->slot_payload_size)
+    {
+        /* Skip one slot to allow full write. */
+        if (addr == omit_addr)
+            continue;
+
+        const nvmfeeindex_t entry =
+                nvmfeep->config->indexp[addr / nvmfeep->slot_payload_size];
+        if (entry == NVM_FEE_INDEX_EMPTY)
+            continue;
+
+        /* Only slots of the collected arena have to be moved. */
+        if (entry / nvmfeep->arena_num_slots != src_arena)
+            continue;
+
+        bool result;
+
+        /* Read slot. */
+        struct slot temp_slot;
+        result = nvm_fee_slot_read(nvmfeep, src_arena,
+                entry % nvmfeep->arena_num_slots, &temp_slot);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        /* Write new slot. */
+        result = nvm_fee_slot_write(nvmfeep, dst_arena,
+                nvmfeep->arena_slots[dst_arena], &temp_slot);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        ++nvmfeep->arena_slots[dst_arena];
+    }
+
+    return HAL_SUCCESS;
+}
+#endif /* NVM_FEE_USE_INDEX */
+
+static bool nvm_fee_gc_copy(NVMFeeDriver* nvmfeep, uint32_t src_arena,
+        uint32_t dst_arena, uint32_t omit_addr)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    /* A configured bitmap covers all addresses, see nvmfeeStart(). */
+    uint8_t* bitmap = nvmfeep->config->gc_bitmapp;
+    uint32_t bitmap_size = nvmfeep->config->gc_bitmap_size;
+    if (bitmap == NULL)
+    {
+        bitmap = nvmfeep->gc_bitmap;
+        bitmap_size = sizeof(nvmfeep->gc_bitmap);
+    }
+    const uint32_t window = bitmap_size * 8;
+
+    /* Each pass covers as many addresses as the bitmap can track. */
+    for (uint32_t first = 0;
+            first < nvmfeep->fee_size / nvmfeep->slot_payload_size;
+            first += window)
+    {
+        memset(bitmap, 0, bitmap_size);
+
+        /* Walk from newest to oldest slot so the first hit is the one to keep. */
+        for (uint32_t slot = nvmfeep->arena_slots[src_arena]; slot-- > 0; )
+        {
+            bool result;
+
+            /* Read slot. */
+            struct slot temp_slot;
+            const struct slot* imagep;
+            result = nvm_fee_slot_map(nvmfeep, src_arena, slot, &temp_slot,
+                    &imagep);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            /* Skip if slot is not in valid state. */
+            if (nvm_fee_mark_2_slot_state(imagep->state_mark) !=
+                    SLOT_STATE_VALID)
+                continue;
+
+            /* Skip one slot to allow full write. */
+            if (imagep->address == omit_addr)
+                continue;
+
+            /* Skip addresses outside of this pass or the fee. */
+            const uint32_t unit =
+                    imagep->address / nvmfeep->slot_payload_size;
+            if (imagep->address >= nvmfeep->fee_size ||
+                    unit < first || unit - first >= window)
+                continue;
+
+            /* Skip stale slot if a newer one has already been copied. */
+            const uint32_t bit = unit - first;
+            if (bitmap[bit / 8] & (1 << (bit % 8)))
+                continue;
+            bitmap[bit / 8] |= (1 << (bit % 8));
+
+            /* Skip slot superseded by a newer arena. */
+            bool stale;
+            result = nvm_fee_slot_is_stale(nvmfeep, src_arena, slot,
+                    imagep, &stale);
+            if (result != HAL_SUCCESS)
+                return result;
+            if (stale == true)
+                continue;
+
+            /* A mapped slot does not survive the write. */
+            if (imagep != &temp_slot)
+                memcpy(&temp_slot, imagep, nvmfeep->slot_size);
+
+            /* Write new slot. */
+            result = nvm_fee_slot_write(nvmfeep, dst_arena,
+                    nvmfeep->arena_slots[dst_arena], &temp_slot);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            ++nvmfeep->arena_slots[dst_arena];
+        }
+    }
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_gc(NVMFeeDriver* nvmfeep, const struct slot* slotp,
+        bool* writtenp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+    osalDbgCheck((slotp == NULL) || (writtenp != NULL));
+    osalDbgAssert(nvmfeep->gc_state == NVM_FEE_GC_IDLE, "invalid gc state");
+
+    /* The address of a pending slot write is not copied. */
+    const uint32_t omit_addr = (slotp != NULL) ? slotp->address : 0xffffffff;
+
+#if NVM_FEE_USE_STATS
+    const systime_t start = osalOsGetSystemTimeX();
+    ++nvmfeep->stats.gc_count;
+#endif /* NVM_FEE_USE_STATS */
+
+    /* Move the oldest arena into the spare one following the newest. */
+    const uint32_t src_arena = nvmfeep->arena_tail;
+    const uint32_t dst_arena = nvm_fee_arena_next(nvmfeep,
+            nvmfeep->arena_active);
+
+    osalDbgAssert(dst_arena != src_arena, "no unused arena");
+
+    nvmfeep->arena_slots[dst_arena] = 0;
+
+    bool result;
+
+    /* stage 1: Freeze source arena. */
+    result = nvm_fee_arena_state_update(nvmfeep, src_arena, ARENA_STATE_FROZEN);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* stage 2: Copy active slots to destination arena. */
+#if NVM_FEE_USE_INDEX
+    if (nvmfeep->config->indexp != NULL)
+        result = nvm_fee_gc_copy_indexed(nvmfeep, src_arena, dst_arena,
+                omit_addr);
+    else
+#endif /* NVM_FEE_USE_INDEX */
+        result = nvm_fee_gc_copy(nvmfeep, src_arena, dst_arena, omit_addr);
+    if (result != HAL_SUCCESS)
+        goto out_abort;
+
+#if NVM_FEE_USE_INDEX
+    /* The omitted address is about to be written. */
+    if (nvmfeep->config->indexp != NULL && omit_addr < nvmfeep->fee_size &&
+            nvmfeep->config->indexp[omit_addr / nvmfeep->slot_payload_size] /
+                    nvmfeep->arena_num_slots == src_arena)
+        nvm_fee_index_update(nvmfeep, omit_addr, NVM_FEE_INDEX_EMPTY);
+#endif /* NVM_FEE_USE_INDEX */
+
+    /* Write the pending slot before the omitted one gets erased. */
+    if (slotp != NULL)
+    {
+        *writtenp = false;
+        if (nvmfeep->arena_slots[dst_arena] < nvmfeep->arena_num_slots)
+        {
+            result = nvm_fee_slot_write(nvmfeep, dst_arena,
+                    nvmfeep->arena_slots[dst_arena], slotp);
+            if (result != HAL_SUCCESS)
+                goto out_abort;
+
+            ++nvmfeep->arena_slots[dst_arena];
+            *writtenp = true;
+        }
+    }
+
+    /* stage 3: Activate destination arena. */
+    result = nvm_fee_arena_state_update(nvmfeep, dst_arena, ARENA_STATE_ACTIVE);
+    if (result != HAL_SUCCESS)
+        goto out_abort;
+
+    /* Update driver state. */
+    nvmfeep->arena_active = dst_arena;
+    nvmfeep->arena_tail = nvm_fee_arena_next(nvmfeep, src_arena);
+
+    /* stage 4: Reinit source arena. */
+    result = nvm_fee_arena_erase(nvmfeep, src_arena);
+    if (result != HAL_SUCCESS)
+        return result;
+
+#if NVM_FEE_USE_CHECKPOINT
+    /* Previous checkpoints refer to the erased arena. */
+    result = nvm_fee_checkpoint_write(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_FEE_USE_CHECKPOINT */
+
+#if NVM_FEE_USE_STATS
+    nvmfeep->stats.gc_time += osalOsGetSystemTimeX() - start;
+#endif /* NVM_FEE_USE_STATS */
+
+    return HAL_SUCCESS;
+
+out_abort:
+    /* The source arena stays the oldest one. Drop the partial copy so a
+     * retry starts on a blank arena. */
+    (void)nvm_fee_arena_erase(nvmfeep, dst_arena);
+#if NVM_FEE_USE_INDEX
+    /* Copied slots have already been entered into the index. */
+    (void)nvm_fee_index_rebuild(nvmfeep);
+#endif /* NVM_FEE_USE_INDEX */
+
+    return result;
+}
+
+/*
+ * @brief   Incremental garbage collection.
+ *
+ *          The same four stages as in @p nvm_fee_gc() are executed, but the
+ *          work is split into bounded steps:
+ *          - begin: Freeze the active arena and redirect all new writes to
+ *            the empty destination arena.
+ *          - copying: Walk the frozen arena from newest to oldest slot and
+ *            copy every slot whose address is not yet present in the
+ *            destination arena. Activate the destination arena when done.
+ *          - erasing: Erase the frozen arena one sector per step, last
+ *            sector first so the header is destroyed last, and reinit it.
+ *
+ *          Interrupted copying is resumed by @p nvmfeeStart() because
+ *          slots already present in the destination arena are skipped.
+ *          Incremental collection is only available with two arenas.
+ */
+static bool nvm_fee_gc_begin(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+    osalDbgAssert(nvmfeep->gc_state == NVM_FEE_GC_IDLE, "invalid gc state");
+    osalDbgAssert(nvmfeep->arena_tail == nvmfeep->arena_active,
+            "invalid arena");
+
+    const uint32_t src_arena = nvmfeep->arena_active;
+    const uint32_t dst_arena = nvm_fee_arena_next(nvmfeep, src_arena);
+
+    osalDbgAssert(nvmfeep->arena_slots[dst_arena] == 0, "arena not empty");
+
+    bool result;
+
+    /* stage 1: Freeze source arena. */
+    result = nvm_fee_arena_state_update(nvmfeep, src_arena, ARENA_STATE_FROZEN);
+    if (result != HAL_SUCCESS)
+        return result;
+
+#if NVM_FEE_USE_STATS
+    ++nvmfeep->stats.gc_count;
+#endif /* NVM_FEE_USE_STATS */
+
+    /* New writes already go to the destination arena. */
+    nvmfeep->gc_arena = src_arena;
+    nvmfeep->gc_cursor = nvmfeep->arena_slots[src_arena];
+    nvmfeep->gc_state = NVM_FEE_GC_COPYING;
+    nvmfeep->arena_active = dst_arena;
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_gc_step(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+    osalDbgAssert(nvmfeep->gc_state != NVM_FEE_GC_IDLE, "invalid gc state");
+
+    const uint32_t src_arena = nvmfeep->gc_arena;
+    const uint32_t dst_arena = nvmfeep->arena_active;
+
+#if NVM_FEE_USE_STATS
+    const systime_t start = osalOsGetSystemTimeX();
+#endif /* NVM_FEE_USE_STATS */
+
+    bool result;
+
+    if (nvmfeep->gc_state == NVM_FEE_GC_COPYING)
+    {
+        /* stage 2: Copy a bounded number of slots. */
+#if NVM_FEE_USE_INDEX
+        /* A run record covers several addresses, walk the records oldest
+         * first and let the index tell which units are still live. */
+        for (uint32_t i = 0;
+                nvmfeep->run_units > 1 &&
+                i < nvmfeep->gc_step_slots && nvmfeep->gc_cursor > 0; )
+        {
+            const uint32_t slot =
+                    nvmfeep->arena_slots[src_arena] - nvmfeep->gc_cursor;
+
+            uint32_t extent;
+            result = nvm_fee_gc_copy_record(nvmfeep, src_arena, slot,
+                    dst_arena, UINT32_MAX, &extent);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            if (extent > nvmfeep->gc_cursor)
+                extent = nvmfeep->gc_cursor;
+            nvmfeep->gc_cursor -= extent;
+            i += extent;
+        }
+#endif /* NVM_FEE_USE_INDEX */
+
+        for (uint32_t i = 0;
+                nvmfeep->run_units == 1 &&
+                i < nvmfeep->gc_step_slots && nvmfeep->gc_cursor > 0;
+                ++i)
+        {
+            const uint32_t slot = --nvmfeep->gc_cursor;
+
+            /* Read slot. */
+            struct slot temp_slot;
+            const struct slot* imagep;
+            result = nvm_fee_slot_map(nvmfeep, src_arena, slot, &temp_slot,
+                    &imagep);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            /* Skip if slot is not in valid state. */
+            if (nvm_fee_mark_2_slot_state(imagep->state_mark) !=
+                    SLOT_STATE_VALID)
+                continue;
+
+            /* Skip addresses outside of the fee. */
+            if (imagep->address >= nvmfeep->fee_size)
+                continue;
+
+            /* Skip if slot has been superseded. */
+            bool stale;
+            result = nvm_fee_slot_is_stale(nvmfeep, src_arena, slot,
+                    imagep, &stale);
+            if (result != HAL_SUCCESS)
+                return result;
+            if (stale == true)
+                continue;
+
+            /* A mapped slot does not survive the write. */
+            if (imagep != &temp_slot)
+                memcpy(&temp_slot, imagep, nvmfeep->slot_size);
+
+            osalDbgAssert(nvmfeep->arena_slots[dst_arena] <
+                    nvmfeep->arena_num_slots, "arena overflow");
+            if (nvmfeep->arena_slots[dst_arena] == nvmfeep->arena_num_slots)
+                return HAL_FAILED;
+
+            /* Write new slot. */
+            result = nvm_fee_slot_write(nvmfeep, dst_arena,
+                    nvmfeep->arena_slots[dst_arena], &temp_slot);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            ++nvmfeep->arena_slots[dst_arena];
+        }
+
+        if (nvmfeep->gc_cursor == 0)
+        {
+            /* stage 3: Activate destination arena. */
+            result = nvm_fee_arena_state_update(nvmfeep, dst_arena,
+                    ARENA_STATE_ACTIVE);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            nvmfeep->arena_tail = nvm_fee_arena_next(nvmfeep, src_arena);
+            nvmfeep->gc_state = NVM_FEE_GC_ERASING;
+            nvmfeep->gc_cursor = nvmfeep->arena_num_sectors;
+        }
+    }
+    else if (nvmfeep->gc_state == NVM_FEE_GC_ERASING)
+    {
+        /* stage 4: Erase one sector of the source arena. */
+        const uint32_t sector = --nvmfeep->gc_cursor;
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+        /* Keep order of device writes. */
+        result = nvm_fee_page_flush(nvmfeep);
+        if (result != HAL_SUCCESS)
+            return result;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
+        result = nvm_fee_device_erase(nvmfeep,
+                nvmfeep->arena_org +
+                (src_arena * nvmfeep->arena_num_sectors + sector) *
+                nvmfeep->llnvmdi.sector_size,
+                nvmfeep->llnvmdi.sector_size);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (sector == 0)
+        {
+            /* Reinit source arena. */
+            result = nvm_fee_arena_format(nvmfeep, src_arena);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            nvmfeep->gc_state = NVM_FEE_GC_IDLE;
+
+#if NVM_FEE_USE_CHECKPOINT
+            /* Previous checkpoints refer to the erased arena. */
+            result = nvm_fee_checkpoint_write(nvmfeep);
+            if (result != HAL_SUCCESS)
+                return result;
+#endif /* NVM_FEE_USE_CHECKPOINT */
+        }
+    }
+
+#if NVM_FEE_USE_STATS
+    nvmfeep->stats.gc_time += osalOsGetSystemTimeX() - start;
+#endif /* NVM_FEE_USE_STATS */
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_gc_finish(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    while (nvmfeep->gc_state != NVM_FEE_GC_IDLE)
+    {
+        bool result = nvm_fee_gc_step(nvmfeep);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_gc_schedule(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    /* Advance running collection. */
+    if (nvmfeep->gc_state != NVM_FEE_GC_IDLE)
+        return nvm_fee_gc_step(nvmfeep);
+
+    /* Start collection when fill threshold has been reached. */
+    if (nvmfeep->gc_threshold_slots != 0 &&
+            nvmfeep->arena_slots[nvmfeep->arena_active] >=
+                    nvmfeep->gc_threshold_slots)
+        return nvm_fee_gc_begin(nvmfeep);
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_read_arena(NVMFeeDriver* nvmfeep, uint32_t arena,
+        uint32_t startaddr, uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    const uint32_t first_slot_addr = startaddr -
+            (startaddr % nvmfeep->slot_payload_size);
+    const uint32_t last_slot_addr = (startaddr + n) -
+            ((startaddr + n) % nvmfeep->slot_payload_size);
+    const uint32_t pre_pad = startaddr % nvmfeep->slot_payload_size;
+    const uint32_t post_pad = nvmfeep->slot_payload_size -
+            ((startaddr + n) % nvmfeep->slot_payload_size);
+
+    /* Walk through used slots. */
+    for (uint32_t slot = 0;
+            slot < nvmfeep->arena_slots[arena];
+            ++slot)
+    {
+        bool result;
+
+        /* Read slot. */
+        struct slot temp_slot;
+        const struct slot* imagep;
+        result = nvm_fee_slot_map(nvmfeep, arena, slot, &temp_slot, &imagep);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        /* Skip if slot is not valid. */
+        if (nvm_fee_mark_2_slot_state(imagep->state_mark) !=
+                SLOT_STATE_VALID)
+            continue;
+
+        /* Check if slot's data is within our desired range. */
+        const uint32_t address = imagep->address;
+        if (address == first_slot_addr)
+        {
+            /* First (partial) slot */
+            uint32_t n_slot = nvmfeep->slot_payload_size - pre_pad;
+            if (n_slot > n)
+                n_slot = n;
+            memcpy(buffer,
+                    imagep->payload + pre_pad,
+                    n_slot);
+        }
+        else if (address == last_slot_addr)
+        {
+            /* Last (partial) slot */
+            memcpy(buffer + n - (nvmfeep->slot_payload_size - post_pad),
+                    imagep->payload,
+                    nvmfeep->slot_payload_size - post_pad);
+        }
+        else if (address > first_slot_addr &&
+                address < last_slot_addr)
+        {
+            /* Full slot */
+            memcpy(buffer + address - startaddr,
+                    imagep->payload,
+                    nvmfeep->slot_payload_size);
+        }
+    }
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_read(NVMFeeDriver* nvmfeep,
+        uint32_t startaddr, uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    /* Initially set all content to 0xff. */
+    for (uint32_t i = 0; i < n; ++i)
+        buffer[i] = 0xff;
+
+#if NVM_FEE_USE_INDEX
+    if (nvmfeep->config->indexp != NULL)
+    {
+        const uint32_t first_slot_addr = startaddr -
+                (startaddr % nvmfeep->slot_payload_size);
+
+        /* Only visit slots covering the desired range. */
+        for (uint32_t slot_addr = first_slot_addr;
+                slot_addr < startaddr + n;
+                slot_addr += nvmfeep->slot_payload_size)
+        {
+            const nvmfeeindex_t entry = nvmfeep->config->indexp[
+                    slot_addr / nvmfeep->slot_payload_size];
+            if (entry == NVM_FEE_INDEX_EMPTY)
+                continue;
+
+            /* Read unit. */
+            struct slot temp_slot;
+            const uint8_t* payloadp;
+            bool result = nvm_fee_unit_map(nvmfeep,
+                    entry / nvmfeep->arena_num_slots,
+                    entry % nvmfeep->arena_num_slots, slot_addr, &temp_slot,
+                    &payloadp);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            const uint32_t from = (slot_addr < startaddr) ?
+                    startaddr : slot_addr;
+            uint32_t to = slot_addr + nvmfeep->slot_payload_size;
+            if (to > startaddr + n)
+                to = startaddr + n;
+
+            memcpy(buffer + (from - startaddr),
+                    payloadp + (from - slot_addr),
+                    to - from);
+        }
+
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_FEE_USE_INDEX */
+
+    /* Overlay arenas from oldest to newest so newer data wins. */
+    uint32_t arena = nvmfeep->arena_tail;
+    while (true)
+    {
+        bool result = nvm_fee_read_arena(nvmfeep, arena,
+                startaddr, n, buffer);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (arena == nvmfeep->arena_active)
+            break;
+
+        arena = nvm_fee_arena_next(nvmfeep, arena);
+    }
+
+    return HAL_SUCCESS;
+}
+
+static int memtst(const void* block, int c, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+        if (((uint8_t*)block)[i] != c)
+            return 1;
+    return 0;
+}
+
+static bool nvm_fee_slot_fetch(NVMFeeDriver* nvmfeep, uint32_t address,
+        struct slot* slotp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+    bool found;
+    uint32_t arena;
+    uint32_t slot;
+
+    /* Look for existing slot. */
+    result = nvm_fee_lookup(nvmfeep, address, &arena, &slot, &found);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    if (found == true)
+    {
+#if NVM_FEE_USE_INDEX
+        if (nvmfeep->run_units > 1)
+        {
+            /* Existing unit may be part of a run so read it alone. */
+            const uint8_t* payloadp;
+            result = nvm_fee_unit_map(nvmfeep, arena, slot, address, slotp,
+                    &payloadp);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            if (payloadp != slotp->payload)
+                memcpy(slotp->payload, payloadp, nvmfeep->slot_payload_size);
+            slotp->state_mark[0] = (write_unit_t)0x0000000000000000ULL;
+            slotp->state_mark[1] = (write_unit_t)0x0000000000000000ULL;
+            slotp->address = address;
+
+            return HAL_SUCCESS;
+        }
+#endif /* NVM_FEE_USE_INDEX */
+
+        /* Existing slot so read it. */
+        result = nvm_fee_slot_read(nvmfeep, arena, slot, slotp);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+    else
+    {
+        /* No existing slot so initialize a pristine one with state valid. */
+        slotp->state_mark[0] = (write_unit_t)0x0000000000000000ULL;
+        slotp->state_mark[1] = (write_unit_t)0x0000000000000000ULL;
+        slotp->address = address;
+        memset(slotp->payload, 0xff, nvmfeep->slot_payload_size);
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Makes room for a slot in the active arena.
+ * @details A garbage collection freeing the space might write the pending
+ *          @p slotp itself, @p writtenp tells if it did.
+ */
+static bool nvm_fee_slot_room(NVMFeeDriver* nvmfeep,
+        const struct slot* slotp, bool* writtenp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+
+    *writtenp = false;
+
+    /* Advance or start incremental garbage collection. */
+    result = nvm_fee_gc_schedule(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Check if arena is full and execute garbage collection. */
+    if (nvmfeep->arena_slots[nvmfeep->arena_active] ==
+            nvmfeep->arena_num_slots)
+    {
+        result = nvm_fee_gc_finish(nvmfeep);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    /* Collecting an arena without stale slots does not free any space so
+     * repeat until one with stale slots or the omitted slot is found. */
+    while (nvmfeep->arena_slots[nvmfeep->arena_active] ==
+            nvmfeep->arena_num_slots)
+    {
+        if (nvm_fee_arena_unused_num(nvmfeep) > 1)
+            result = nvm_fee_arena_advance(nvmfeep);
+        else
+            result = nvm_fee_gc(nvmfeep, slotp, writtenp);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (*writtenp == true)
+            return HAL_SUCCESS;
+    }
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_slot_append(NVMFeeDriver* nvmfeep,
+        const struct slot* slotp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+    bool written;
+
+    result = nvm_fee_slot_room(nvmfeep, slotp, &written);
+    if (result != HAL_SUCCESS || written == true)
+        return result;
+
+    /* Write new slot. */
+    result = nvm_fee_slot_write(nvmfeep, nvmfeep->arena_active,
+            nvmfeep->arena_slots[nvmfeep->arena_active], slotp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    ++nvmfeep->arena_slots[nvmfeep->arena_active];
+
+    return HAL_SUCCESS;
+}
+
+#if NVM_FEE_CACHE_SLOTS || defined(__DOXYGEN__)
+static nvmfeecacheentry_t* nvm_fee_cache_find(NVMFeeDriver* nvmfeep,
+        uint32_t address)
+{
+    for (uint32_t i = 0; i < NELEMS(nvmfeep->cache); ++i)
+        if (nvmfeep->cache[i].address == address)
+            return &nvmfeep->cache[i];
+
+    return NULL;
+}
+
+static bool nvm_fee_cache_flush_entry(NVMFeeDriver* nvmfeep,
+        nvmfeecacheentry_t* entryp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    if (entryp->address == NVM_FEE_CACHE_EMPTY)
+        return HAL_SUCCESS;
+
+    bool result;
+
+    struct slot temp_slot;
+    result = nvm_fee_slot_fetch(nvmfeep, entryp->address, &temp_slot);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Compare slot data, the cached data might have been reverted. */
+    if (memcmp(temp_slot.payload, entryp->payload,
+            nvmfeep->slot_payload_size) != 0)
+    {
+        memcpy(temp_slot.payload, entryp->payload, nvmfeep->slot_payload_size);
+
+        result = nvm_fee_slot_append(nvmfeep, &temp_slot);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+    else
+    {
+        NVM_FEE_STATS_ADD(nvmfeep, writes_skipped, 1);
+    }
+
+    entryp->address = NVM_FEE_CACHE_EMPTY;
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_cache_flush(NVMFeeDriver* nvmfeep, bool* flushedp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    *flushedp = false;
+
+    for (uint32_t i = 0; i < NELEMS(nvmfeep->cache); ++i)
+    {
+        if (nvmfeep->cache[i].address == NVM_FEE_CACHE_EMPTY)
+            continue;
+
+        bool result = nvm_fee_cache_flush_entry(nvmfeep, &nvmfeep->cache[i]);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        *flushedp = true;
+    }
+
+    return HAL_SUCCESS;
+}
+
+static void nvm_fee_cache_clear(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    for (uint32_t i = 0; i < NELEMS(nvmfeep->cache); ++i)
+        nvmfeep->cache[i].address = NVM_FEE_CACHE_EMPTY;
+}
+
+static void nvm_fee_cache_read(NVMFeeDriver* nvmfeep,
+        uint32_t startaddr, uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    /* Cached data is newer than anything stored in the arenas. */
+    for (uint32_t i = 0; i < NELEMS(nvmfeep->cache); ++i)
+    {
+        const nvmfeecacheentry_t* entryp = &nvmfeep->cache[i];
+
+        if (entryp->address == NVM_FEE_CACHE_EMPTY ||
+                entryp->address + nvmfeep->slot_payload_size <= startaddr ||
+                entryp->address >= startaddr + n)
+            continue;
+
+        const uint32_t from = (entryp->address < startaddr) ?
+                startaddr : entryp->address;
+        uint32_t to = entryp->address + nvmfeep->slot_payload_size;
+        if (to > startaddr + n)
+            to = startaddr + n;
+
+        memcpy(buffer + (from - startaddr),
+                entryp->payload + (from - entryp->address),
+                to - from);
+    }
+}
+#endif /* NVM_FEE_CACHE_SLOTS */
+
+#if NVM_FEE_USE_TRANSACTION || defined(__DOXYGEN__)
+static bool nvm_fee_reserve(NVMFeeDriver* nvmfeep, uint32_t num)
+{
+    osalDbgCheck((nvmfeep != NULL));
+    osalDbgAssert(num <= nvmfeep->arena_num_slots, "invalid parameters");
+
+    bool result;
+
+    result = nvm_fee_gc_finish(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Make room for consecutive slots in the active arena. */
+    while (nvmfeep->arena_num_slots -
+            nvmfeep->arena_slots[nvmfeep->arena_active] < num)
+    {
+        if (nvm_fee_arena_unused_num(nvmfeep) > 1)
+            result = nvm_fee_arena_advance(nvmfeep);
+        else
+            result = nvm_fee_gc(nvmfeep, NULL, NULL);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/*
+ * @brief   Writes all cached slots as a single transaction.
+ *
+ *          - Program all changed slots without marking them valid.
+ *          - Write a commit mark counting these slots.
+ *          - Mark all slots valid.
+ *
+ *          Slots of a transaction interrupted before the commit mark is
+ *          valid stay dirty and are ignored. Otherwise the remaining slots
+ *          are marked valid by @p nvm_fee_arena_load().
+ */
+static bool nvm_fee_transaction_commit(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+    uint32_t num = 0;
+
+    /* Drop unchanged slots. */
+    for (uint32_t i = 0; i < NELEMS(nvmfeep->cache); ++i)
+    {
+        nvmfeecacheentry_t* entryp = &nvmfeep->cache[i];
+
+        if (entryp->address == NVM_FEE_CACHE_EMPTY)
+            continue;
+
+        struct slot temp_slot;
+        result = nvm_fee_slot_fetch(nvmfeep, entryp->address, &temp_slot);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (memcmp(temp_slot.payload, entryp->payload,
+                nvmfeep->slot_payload_size) == 0)
+        {
+            entryp->address = NVM_FEE_CACHE_EMPTY;
+            NVM_FEE_STATS_ADD(nvmfeep, writes_skipped, 1);
+        }
+        else
+            ++num;
+    }
+
+    if (num == 0)
+        return HAL_SUCCESS;
+
+    result = nvm_fee_reserve(nvmfeep, num + 1);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    const uint32_t arena = nvmfeep->arena_active;
+    const uint32_t first_slot = nvmfeep->arena_slots[arena];
+
+    struct slot temp_slot;
+    temp_slot.state_mark[0] = (write_unit_t)0x0000000000000000ULL;
+    temp_slot.state_mark[1] = (write_unit_t)0x0000000000000000ULL;
+
+    /* Program transaction slots. */
+    for (uint32_t i = 0; i < NELEMS(nvmfeep->cache); ++i)
+    {
+        const nvmfeecacheentry_t* entryp = &nvmfeep->cache[i];
+
+        if (entryp->address == NVM_FEE_CACHE_EMPTY)
+            continue;
+
+        temp_slot.address = entryp->address;
+        memcpy(temp_slot.payload, entryp->payload, nvmfeep->slot_payload_size);
+
+        result = nvm_fee_slot_program(nvmfeep, arena,
+                nvmfeep->arena_slots[arena], &temp_slot);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        ++nvmfeep->arena_slots[arena];
+    }
+
+    /* Write commit mark. */
+    temp_slot.address = NVM_FEE_TRANSACTION_MARK + num;
+    memset(temp_slot.payload, 0xff, nvmfeep->slot_payload_size);
+
+    result = nvm_fee_slot_write(nvmfeep, arena,
+            nvmfeep->arena_slots[arena], &temp_slot);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    ++nvmfeep->arena_slots[arena];
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Commit mark has to be valid before any transaction slot. */
+    result = nvm_fee_page_flush(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
+    /* Mark transaction slots valid. */
+    uint32_t slot = first_slot;
+    for (uint32_t i = 0; i < NELEMS(nvmfeep->cache); ++i)
+    {
+        nvmfeecacheentry_t* entryp = &nvmfeep->cache[i];
+
+        if (entryp->address == NVM_FEE_CACHE_EMPTY)
+            continue;
+
+        result = nvm_fee_slot_validate(nvmfeep, arena, slot++,
+                entryp->address);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        entryp->address = NVM_FEE_CACHE_EMPTY;
+    }
+
+    return HAL_SUCCESS;
+}
+#endif /* NVM_FEE_USE_TRANSACTION */
+
+static bool nvm_fee_slot_get(NVMFeeDriver* nvmfeep, uint32_t address,
+        struct slot* slotp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+#if NVM_FEE_CACHE_SLOTS
+    const nvmfeecacheentry_t* entryp = nvm_fee_cache_find(nvmfeep, address);
+    if (entryp != NULL)
+    {
+        slotp->state_mark[0] = (write_unit_t)0x0000000000000000ULL;
+        slotp->state_mark[1] = (write_unit_t)0x0000000000000000ULL;
+        slotp->address = address;
+        memcpy(slotp->payload, entryp->payload, nvmfeep->slot_payload_size);
+
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_FEE_CACHE_SLOTS */
+
+    return nvm_fee_slot_fetch(nvmfeep, address, slotp);
+}
+
+static bool nvm_fee_slot_put(NVMFeeDriver* nvmfeep, const struct slot* slotp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+#if NVM_FEE_CACHE_SLOTS
+    nvmfeecacheentry_t* entryp = nvm_fee_cache_find(nvmfeep, slotp->address);
+    if (entryp == NULL)
+    {
+        /* Evict least recently used entry. */
+        entryp = &nvmfeep->cache[0];
+        for (uint32_t i = 0; i < NELEMS(nvmfeep->cache); ++i)
+        {
+            if (nvmfeep->cache[i].address == NVM_FEE_CACHE_EMPTY)
+            {
+                entryp = &nvmfeep->cache[i];
+                break;
+            }
+            if ((int32_t)(nvmfeep->cache[i].tick - entryp->tick) < 0)
+                entryp = &nvmfeep->cache[i];
+        }
+
+#if NVM_FEE_USE_TRANSACTION
+        /* Transaction data has to stay in the cache until commit. */
+        if (nvmfeep->transaction == true &&
+                entryp->address != NVM_FEE_CACHE_EMPTY)
+            return HAL_FAILED;
+#endif /* NVM_FEE_USE_TRANSACTION */
+
+        bool result = nvm_fee_cache_flush_entry(nvmfeep, entryp);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        entryp->address = slotp->address;
+    }
+
+    entryp->tick = ++nvmfeep->cache_tick;
+    memcpy(entryp->payload, slotp->payload, nvmfeep->slot_payload_size);
+
+    return HAL_SUCCESS;
+#else
+    return nvm_fee_slot_append(nvmfeep, slotp);
+#endif /* NVM_FEE_CACHE_SLOTS */
+}
+
+#if NVM_FEE_USE_INDEX || defined(__DOXYGEN__)
+static bool nvm_fee_run_enabled(NVMFeeDriver* nvmfeep)
+{
+#if NVM_FEE_USE_TRANSACTION
+    /* Transaction data has to go through the cache. */
+    if (nvmfeep->transaction == true)
+        return false;
+#endif /* NVM_FEE_USE_TRANSACTION */
+
+    return nvmfeep->run_units > 1;
+}
+
+/**
+ * @brief   Appends a run record of up to @p units units.
+ * @details The record is cut to the space left in the active arena. While
+ *          an incremental garbage collection is in progress only single
+ *          units are written, so each write takes no more than one slot
+ *          of the reserve. @p writtenp returns the number of units written.
+ */
+static bool nvm_fee_run_append(NVMFeeDriver* nvmfeep, uint32_t address,
+        uint32_t units, const struct record_source* srcp, uint32_t* writtenp)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+    bool written;
+
+    /* A garbage collection might write the first unit on its own. */
+    struct slot temp_slot;
+    temp_slot.state_mark[0] = (write_unit_t)0x0000000000000000ULL;
+    temp_slot.state_mark[1] = (write_unit_t)0x0000000000000000ULL;
+    temp_slot.address = address;
+    result = nvm_fee_record_unit(nvmfeep, srcp, address, 0,
+            temp_slot.payload);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    result = nvm_fee_slot_room(nvmfeep, &temp_slot, &written);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    if (written == true)
+    {
+        *writtenp = 1;
+    }
+    else
+    {
+        const uint32_t arena = nvmfeep->arena_active;
+        const uint32_t space = nvmfeep->arena_num_slots -
+                nvmfeep->arena_slots[arena];
+
+        uint32_t num = (space * nvmfeep->slot_size -
+                offsetof(struct slot, payload)) / nvmfeep->slot_payload_size;
+        if (num > units)
+            num = units;
+        if (nvmfeep->gc_state != NVM_FEE_GC_IDLE)
+            num = 1;
+
+        /* Write new record. */
+        result = nvm_fee_record_write(nvmfeep, arena,
+                nvmfeep->arena_slots[arena], address, num, srcp);
+        if (result != HAL_SUCCESS)
+            return result;
 
-    /* Update driver state. */
-    nvmfeep->arena_active = dst_arena;
+        nvmfeep->arena_slots[arena] += nvm_fee_record_slots(nvmfeep, num);
+        *writtenp = num;
+    }
+
+#if NVM_FEE_CACHE_SLOTS
+    /* Cached data of the units written is superseded. */
+    for (uint32_t i = 0; i < *writtenp; ++i)
+    {
+        nvmfeecacheentry_t* entryp = nvm_fee_cache_find(nvmfeep,
+                address + i * nvmfeep->slot_payload_size);
+        if (entryp != NULL)
+            entryp->address = NVM_FEE_CACHE_EMPTY;
+    }
+#endif /* NVM_FEE_CACHE_SLOTS */
 
     return HAL_SUCCESS;
 }
 
-static bool nvm_fee_read(NVMFeeDriver* nvmfeep, uint32_t arena,
-        uint32_t startaddr, uint32_t n, uint8_t* buffer)
+/*
+ * @brief   Writes @p units full units starting at @p address.
+ *
+ *          Units already holding the data are skipped, consecutive changed
+ *          ones are written as run records.
+ */
+static bool nvm_fee_run_put(NVMFeeDriver* nvmfeep, uint32_t address,
+        uint32_t units, const struct record_source* srcp)
 {
     osalDbgCheck((nvmfeep != NULL));
 
-    const uint32_t first_slot_addr = startaddr -
-            (startaddr % NVM_FEE_SLOT_PAYLOAD_SIZE);
-    const uint32_t last_slot_addr = (startaddr + n) -
-            ((startaddr + n) % NVM_FEE_SLOT_PAYLOAD_SIZE);
-    const uint32_t pre_pad = startaddr % NVM_FEE_SLOT_PAYLOAD_SIZE;
-    const uint32_t post_pad = NVM_FEE_SLOT_PAYLOAD_SIZE -
-            ((startaddr + n) % NVM_FEE_SLOT_PAYLOAD_SIZE);
-
-    /* Initially set all content to 0xff. */
-    for (uint32_t i = 0; i < n; ++i)
-        buffer[i] = 0xff;
+    bool result;
+    uint32_t first = 0;
+    uint32_t num = 0;
 
-    /* Walk through active slots. */
-    for (uint32_t slot = 0;
-            slot < nvmfeep->arena_slots[nvmfeep->arena_active];
-            ++slot)
+    for (uint32_t i = 0; i <= units; ++i)
     {
-        bool result;
+        bool changed = false;
+        if (i < units)
+        {
+            struct slot temp_slot;
+            uint8_t payload[NVM_FEE_SLOT_PAYLOAD_SIZE];
 
-        /* Read slot. */
-        struct slot temp_slot;
-        result = nvm_fee_slot_read(nvmfeep, arena, slot, &temp_slot);
-        if (result != HAL_SUCCESS)
-            return result;
+            result = nvm_fee_slot_get(nvmfeep,
+                    address + i * nvmfeep->slot_payload_size, &temp_slot);
+            if (result != HAL_SUCCESS)
+                return result;
 
-        /* Skip if slot is not valid. */
-        if (nvm_fee_mark_2_slot_state(temp_slot.state_mark) !=
-                SLOT_STATE_VALID)
-            continue;
+            result = nvm_fee_record_unit(nvmfeep, srcp,
+                    address + i * nvmfeep->slot_payload_size, i, payload);
+            if (result != HAL_SUCCESS)
+                return result;
 
-        /* Check if slot's data is within our desired range. */
-        if (temp_slot.address == first_slot_addr)
+            /* Compare slot data. */
+            changed = memcmp(temp_slot.payload, payload,
+                    nvmfeep->slot_payload_size) != 0;
+            if (changed == false)
+                NVM_FEE_STATS_ADD(nvmfeep, writes_skipped, 1);
+        }
+
+        if (changed == true && num < nvmfeep->run_units)
         {
-            /* First (partial) slot */
-            uint32_t n_slot = NVM_FEE_SLOT_PAYLOAD_SIZE - pre_pad;
-            if (n_slot > n)
-                n_slot = n;
-            memcpy(buffer,
-                    temp_slot.payload + pre_pad,
-                    n_slot);
+            if (num == 0)
+                first = i;
+            ++num;
+            continue;
         }
-        else if (temp_slot.address == last_slot_addr)
+
+        /* Write pending run. */
+        while (num != 0)
         {
-            /* Last (partial) slot */
-            memcpy(buffer + n - (NVM_FEE_SLOT_PAYLOAD_SIZE - post_pad),
-                    temp_slot.payload,
-                    NVM_FEE_SLOT_PAYLOAD_SIZE - post_pad);
+            struct record_source source = *srcp;
+            if (source.buffer != NULL)
+                source.buffer += first * nvmfeep->slot_payload_size;
+
+            uint32_t written;
+            result = nvm_fee_run_append(nvmfeep,
+                    address + first * nvmfeep->slot_payload_size, num,
+                    &source, &written);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            first += written;
+            num -= written;
         }
-        else if (temp_slot.address > first_slot_addr &&
-                temp_slot.address < last_slot_addr)
+
+        if (changed == true)
         {
-            /* Full slot */
-            memcpy(buffer + temp_slot.address - startaddr,
-                    temp_slot.payload,
-                    NVM_FEE_SLOT_PAYLOAD_SIZE);
+            first = i;
+            num = 1;
         }
     }
 
     return HAL_SUCCESS;
 }
+#endif /* NVM_FEE_USE_INDEX */
 
-static int memtst(const void* block, int c, size_t size)
-{
-    for (size_t i = 0; i < size; ++i)
-        if (((uint8_t*)block)[i] != c)
-            return 1;
-    return 0;
-}
-
-static bool nvm_fee_write(NVMFeeDriver* nvmfeep, uint32_t arena,
+static bool nvm_fee_write(NVMFeeDriver* nvmfeep,
         uint32_t startaddr, uint32_t n, const uint8_t* buffer)
 {
     osalDbgCheck((nvmfeep != NULL));
 
     const uint32_t first_slot_addr = startaddr -
-            (startaddr % NVM_FEE_SLOT_PAYLOAD_SIZE);
-    const uint32_t pre_pad = startaddr % NVM_FEE_SLOT_PAYLOAD_SIZE;
+            (startaddr % nvmfeep->slot_payload_size);
+    const uint32_t pre_pad = startaddr % nvmfeep->slot_payload_size;
 
     bool result;
     uint32_t n_remaining = n;
@@ -581,33 +2969,13 @@ static bool nvm_fee_write(NVMFeeDriver* nvmfeep, uint32_t arena,
     /* First (partial) slot */
     if (pre_pad)
     {
-        /* Look for existing slot. */
         struct slot temp_slot;
-        bool found;
-        uint32_t slot;
 
-        result = nvm_fee_slot_lookup(nvmfeep, arena, first_slot_addr,
-                &slot, &found);
+        result = nvm_fee_slot_get(nvmfeep, first_slot_addr, &temp_slot);
         if (result != HAL_SUCCESS)
             return result;
 
-        if (found == true)
-        {
-            /* Existing slot so read it. */
-            result = nvm_fee_slot_read(nvmfeep, arena, slot, &temp_slot);
-            if (result != HAL_SUCCESS)
-                return result;
-        }
-        else
-        {
-            /* No existing slot so initialize a pristine one with state valid. */
-            temp_slot.state_mark[0] = (write_unit_t)0x0000000000000000ULL;
-            temp_slot.state_mark[1] = (write_unit_t)0x0000000000000000ULL;
-            temp_slot.address = first_slot_addr;
-            memset(temp_slot.payload, 0xff, sizeof(temp_slot.payload));
-        }
-
-        uint32_t n_slot = NVM_FEE_SLOT_PAYLOAD_SIZE - pre_pad;
+        uint32_t n_slot = nvmfeep->slot_payload_size - pre_pad;
         if (n_slot > n_remaining)
             n_slot = n_remaining;
 
@@ -617,58 +2985,48 @@ static bool nvm_fee_write(NVMFeeDriver* nvmfeep, uint32_t arena,
             /* Update slot data. */
             memcpy(temp_slot.payload + pre_pad, buffer, n_slot);
 
-            /* Check if arena is full and execute garbage collection. */
-            if (nvmfeep->arena_slots[nvmfeep->arena_active] ==
-                    nvmfeep->arena_num_slots)
-            {
-                result = nvm_fee_gc(nvmfeep, temp_slot.address);
-                if (result != HAL_SUCCESS)
-                    return result;
-            }
-
-            /* Write new slot. */
-            result = nvm_fee_slot_write(nvmfeep, nvmfeep->arena_active,
-                    nvmfeep->arena_slots[nvmfeep->arena_active], &temp_slot);
+            result = nvm_fee_slot_put(nvmfeep, &temp_slot);
             if (result != HAL_SUCCESS)
                 return result;
-
-            ++nvmfeep->arena_slots[nvmfeep->arena_active];
+        }
+        else
+        {
+            NVM_FEE_STATS_ADD(nvmfeep, writes_skipped, 1);
         }
 
         addr += n_slot;
         n_remaining -= n_slot;
     }
 
+#if NVM_FEE_USE_INDEX
+    /* Full slots as run records */
+    if (nvm_fee_run_enabled(nvmfeep) == true &&
+            n_remaining >= nvmfeep->slot_payload_size)
+    {
+        const struct record_source source = {
+            .buffer = buffer + (addr - startaddr),
+        };
+        const uint32_t units = n_remaining / nvmfeep->slot_payload_size;
+
+        result = nvm_fee_run_put(nvmfeep, addr, units, &source);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        addr += units * nvmfeep->slot_payload_size;
+        n_remaining -= units * nvmfeep->slot_payload_size;
+    }
+#endif /* NVM_FEE_USE_INDEX */
+
     /* Full slots */
-    while (n_remaining >= NVM_FEE_SLOT_PAYLOAD_SIZE)
+    while (n_remaining >= nvmfeep->slot_payload_size)
     {
-        /* Look for existing slot. */
         struct slot temp_slot;
-        bool found;
-        uint32_t slot;
 
-        result = nvm_fee_slot_lookup(nvmfeep, arena, addr,
-                &slot, &found);
+        result = nvm_fee_slot_get(nvmfeep, addr, &temp_slot);
         if (result != HAL_SUCCESS)
             return result;
 
-        if (found == true)
-        {
-            /* Existing slot so read it. */
-            result = nvm_fee_slot_read(nvmfeep, arena, slot, &temp_slot);
-            if (result != HAL_SUCCESS)
-                return result;
-        }
-        else
-        {
-            /* No existing slot so initialize a pristine one with state valid. */
-            temp_slot.state_mark[0] = (write_unit_t)0x0000000000000000ULL;
-            temp_slot.state_mark[1] = (write_unit_t)0x0000000000000000ULL;
-            temp_slot.address = addr;
-            memset(temp_slot.payload, 0xff, sizeof(temp_slot.payload));
-        }
-
-        uint32_t n_slot = NVM_FEE_SLOT_PAYLOAD_SIZE;
+        uint32_t n_slot = nvmfeep->slot_payload_size;
 
         /* Compare slot data. */
         if (memcmp(temp_slot.payload, buffer + (addr - startaddr), n_slot) != 0)
@@ -676,22 +3034,13 @@ static bool nvm_fee_write(NVMFeeDriver* nvmfeep, uint32_t arena,
             /* Update slot data. */
             memcpy(temp_slot.payload, buffer + (addr - startaddr), n_slot);
 
-            /* Check if arena is full and execute garbage collection. */
-            if (nvmfeep->arena_slots[nvmfeep->arena_active] ==
-                    nvmfeep->arena_num_slots)
-            {
-                result = nvm_fee_gc(nvmfeep, temp_slot.address);
-                if (result != HAL_SUCCESS)
-                    return result;
-            }
-
-            /* Write new slot. */
-            result = nvm_fee_slot_write(nvmfeep, nvmfeep->arena_active,
-                    nvmfeep->arena_slots[nvmfeep->arena_active], &temp_slot);
+            result = nvm_fee_slot_put(nvmfeep, &temp_slot);
             if (result != HAL_SUCCESS)
                 return result;
-
-            ++nvmfeep->arena_slots[nvmfeep->arena_active];
+        }
+        else
+        {
+            NVM_FEE_STATS_ADD(nvmfeep, writes_skipped, 1);
         }
 
         addr += n_slot;
@@ -701,29 +3050,12 @@ static bool nvm_fee_write(NVMFeeDriver* nvmfeep, uint32_t arena,
     /* Last (partial) slot */
     if (n_remaining)
     {
-        /* Look for existing slot. */
         struct slot temp_slot;
-        bool found;
-        uint32_t slot;
 
-        result = nvm_fee_slot_lookup(nvmfeep, arena, addr, &slot, &found);
+        result = nvm_fee_slot_get(nvmfeep, addr, &temp_slot);
         if (result != HAL_SUCCESS)
             return result;
 
-        if (found == true)
-        {
-            /* Existing slot so read it. */
-            result = nvm_fee_slot_read(nvmfeep, arena, slot, &temp_slot);
-            if (result != HAL_SUCCESS)
-                return result;
-        }
-        else
-        {
-            /* No existing slot so initialize a pristine one. */
-            temp_slot.address = addr;
-            memset(temp_slot.payload, 0xff, sizeof(temp_slot.payload));
-        }
-
         uint32_t n_slot = n_remaining;
 
         /* Compare slot data. */
@@ -732,22 +3064,13 @@ static bool nvm_fee_write(NVMFeeDriver* nvmfeep, uint32_t arena,
             /* Update slot data. */
             memcpy(temp_slot.payload, buffer + (addr - startaddr), n_slot);
 
-            /* Check if arena is full and execute garbage collection. */
-            if (nvmfeep->arena_slots[nvmfeep->arena_active] ==
-                    nvmfeep->arena_num_slots)
-            {
-                result = nvm_fee_gc(nvmfeep, temp_slot.address);
-                if (result != HAL_SUCCESS)
-                    return result;
-            }
-
-            /* Write new slot. */
-            result = nvm_fee_slot_write(nvmfeep, nvmfeep->arena_active,
-                    nvmfeep->arena_slots[nvmfeep->arena_active], &temp_slot);
+            result = nvm_fee_slot_put(nvmfeep, &temp_slot);
             if (result != HAL_SUCCESS)
                 return result;
-
-            ++nvmfeep->arena_slots[nvmfeep->arena_active];
+        }
+        else
+        {
+            NVM_FEE_STATS_ADD(nvmfeep, writes_skipped, 1);
         }
 
         addr += n_slot;
@@ -757,14 +3080,14 @@ static bool nvm_fee_write(NVMFeeDriver* nvmfeep, uint32_t arena,
     return HAL_SUCCESS;
 }
 
-static bool nvm_fee_write_pattern(NVMFeeDriver* nvmfeep, uint32_t arena,
+static bool nvm_fee_write_pattern(NVMFeeDriver* nvmfeep,
         uint32_t startaddr, uint32_t n, uint8_t pattern)
 {
     osalDbgCheck((nvmfeep != NULL));
 
     const uint32_t first_slot_addr = startaddr -
-            (startaddr % NVM_FEE_SLOT_PAYLOAD_SIZE);
-    const uint32_t pre_pad = startaddr % NVM_FEE_SLOT_PAYLOAD_SIZE;
+            (startaddr % nvmfeep->slot_payload_size);
+    const uint32_t pre_pad = startaddr % nvmfeep->slot_payload_size;
 
     bool result;
     uint32_t n_remaining = n;
@@ -773,31 +3096,13 @@ static bool nvm_fee_write_pattern(NVMFeeDriver* nvmfeep, uint32_t arena,
     /* First (partial) slot */
     if (pre_pad)
     {
-        /* Look for existing slot. */
         struct slot temp_slot;
-        bool found;
-        uint32_t slot;
 
-        result = nvm_fee_slot_lookup(nvmfeep, arena, first_slot_addr,
-                &slot, &found);
+        result = nvm_fee_slot_get(nvmfeep, first_slot_addr, &temp_slot);
         if (result != HAL_SUCCESS)
             return result;
 
-        if (found == true)
-        {
-            /* Existing slot so read it. */
-            result = nvm_fee_slot_read(nvmfeep, arena, slot, &temp_slot);
-            if (result != HAL_SUCCESS)
-                return result;
-        }
-        else
-        {
-            /* No existing slot so initialize a pristine one. */
-            temp_slot.address = first_slot_addr;
-            memset(temp_slot.payload, 0xff, sizeof(temp_slot.payload));
-        }
-
-        uint32_t n_slot = NVM_FEE_SLOT_PAYLOAD_SIZE - pre_pad;
+        uint32_t n_slot = nvmfeep->slot_payload_size - pre_pad;
         if (n_slot > n_remaining)
             n_slot = n_remaining;
 
@@ -807,56 +3112,78 @@ static bool nvm_fee_write_pattern(NVMFeeDriver* nvmfeep, uint32_t arena,
             /* Update slot data. */
             memset(temp_slot.payload + pre_pad, pattern, n_slot);
 
-            /* Check if arena is full and execute garbage collection. */
-            if (nvmfeep->arena_slots[nvmfeep->arena_active] ==
-                    nvmfeep->arena_num_slots)
-            {
-                result = nvm_fee_gc(nvmfeep, temp_slot.address);
-                if (result != HAL_SUCCESS)
-                    return result;
-            }
-
-            /* Write new slot. */
-            result = nvm_fee_slot_write(nvmfeep, nvmfeep->arena_active,
-                    nvmfeep->arena_slots[nvmfeep->arena_active], &temp_slot);
+            result = nvm_fee_slot_put(nvmfeep, &temp_slot);
             if (result != HAL_SUCCESS)
                 return result;
-
-            ++nvmfeep->arena_slots[nvmfeep->arena_active];
+        }
+        else
+        {
+            NVM_FEE_STATS_ADD(nvmfeep, writes_skipped, 1);
         }
 
         addr += n_slot;
         n_remaining -= n_slot;
     }
 
+#if NVM_FEE_USE_INDEX
+    /* Full slots as run records */
+    if (nvm_fee_run_enabled(nvmfeep) == true &&
+            n_remaining >= nvmfeep->slot_payload_size)
+    {
+        const struct record_source source = {
+            .pattern = pattern,
+        };
+        const uint32_t units = n_remaining / nvmfeep->slot_payload_size;
+
+        result = nvm_fee_run_put(nvmfeep, addr, units, &source);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        addr += units * nvmfeep->slot_payload_size;
+        n_remaining -= units * nvmfeep->slot_payload_size;
+    }
+#endif /* NVM_FEE_USE_INDEX */
+
     /* Full slots */
-    while (n_remaining >= NVM_FEE_SLOT_PAYLOAD_SIZE)
+    while (n_remaining >= nvmfeep->slot_payload_size)
     {
-        /* Look for existing slot. */
         struct slot temp_slot;
-        bool found;
-        uint32_t slot;
 
-        result = nvm_fee_slot_lookup(nvmfeep, arena, addr,
-                &slot, &found);
+        result = nvm_fee_slot_get(nvmfeep, addr, &temp_slot);
         if (result != HAL_SUCCESS)
             return result;
 
-        if (found == true)
+        uint32_t n_slot = nvmfeep->slot_payload_size;
+
+        /* Compare slot data. */
+        if (memtst(temp_slot.payload, pattern, n_slot) != 0)
         {
-            /* Existing slot so read it. */
-            result = nvm_fee_slot_read(nvmfeep, arena, slot, &temp_slot);
+            /* Update slot data. */
+            memset(temp_slot.payload, pattern, n_slot);
+
+            result = nvm_fee_slot_put(nvmfeep, &temp_slot);
             if (result != HAL_SUCCESS)
                 return result;
         }
         else
         {
-            /* No existing slot so initialize a pristine one. */
-            temp_slot.address = addr;
-            memset(temp_slot.payload, 0xff, sizeof(temp_slot.payload));
+            NVM_FEE_STATS_ADD(nvmfeep, writes_skipped, 1);
         }
 
-        uint32_t n_slot = NVM_FEE_SLOT_PAYLOAD_SIZE;
+        addr += n_slot;
+        n_remaining -= n_slot;
+    }
+
+    /* Last (partial) slot */
+    if (n_remaining)
+    {
+        struct slot temp_slot;
+
+        result = nvm_fee_slot_get(nvmfeep, addr, &temp_slot);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        uint32_t n_slot = n_remaining;
 
         /* Compare slot data. */
         if (memtst(temp_slot.payload, pattern, n_slot) != 0)
@@ -864,83 +3191,218 @@ static bool nvm_fee_write_pattern(NVMFeeDriver* nvmfeep, uint32_t arena,
             /* Update slot data. */
             memset(temp_slot.payload, pattern, n_slot);
 
-            /* Check if arena is full and execute garbage collection. */
-            if (nvmfeep->arena_slots[nvmfeep->arena_active] ==
-                    nvmfeep->arena_num_slots)
-            {
-                result = nvm_fee_gc(nvmfeep, temp_slot.address);
-                if (result != HAL_SUCCESS)
-                    return result;
-            }
-
-            /* Write new slot. */
-            result = nvm_fee_slot_write(nvmfeep, nvmfeep->arena_active,
-                    nvmfeep->arena_slots[nvmfeep->arena_active], &temp_slot);
+            result = nvm_fee_slot_put(nvmfeep, &temp_slot);
             if (result != HAL_SUCCESS)
                 return result;
-
-            ++nvmfeep->arena_slots[nvmfeep->arena_active];
+        }
+        else
+        {
+            NVM_FEE_STATS_ADD(nvmfeep, writes_skipped, 1);
         }
 
         addr += n_slot;
         n_remaining -= n_slot;
     }
 
-    /* Last (partial) slot */
-    if (n_remaining)
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_format(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Gathered slots are wiped anyway. */
+    nvmfeep->page_count = 0;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
+#if NVM_FEE_USE_CHECKPOINT
+    result = nvm_fee_checkpoint_clear(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_FEE_USE_CHECKPOINT */
+
+    for (uint32_t arena = 0; arena < nvmfeep->arena_num; ++arena)
     {
-        /* Look for existing slot. */
-        struct slot temp_slot;
-        bool found;
-        uint32_t slot;
+        result = nvm_fee_arena_erase(nvmfeep, arena);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    result = nvm_fee_arena_state_update(nvmfeep, 0, ARENA_STATE_ACTIVE);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    nvmfeep->arena_active = 0;
+    nvmfeep->arena_tail = 0;
+    nvmfeep->gc_state = NVM_FEE_GC_IDLE;
+
+#if NVM_FEE_USE_INDEX
+    nvm_fee_index_clear(nvmfeep);
+#endif /* NVM_FEE_USE_INDEX */
+
+#if NVM_FEE_CACHE_SLOTS
+    nvm_fee_cache_clear(nvmfeep);
+#endif /* NVM_FEE_CACHE_SLOTS */
+
+#if NVM_FEE_USE_TRANSACTION
+    nvmfeep->transaction = false;
+#endif /* NVM_FEE_USE_TRANSACTION */
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_fee_recover(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck((nvmfeep != NULL));
+
+    bool result;
+
+    /* Examine all arenas.
+     *
+     * Arenas are used as a ring. Consistent states are:
+     *
+     * - A contiguous run of active arenas from the oldest (tail) to the
+     *   newest (head) arena, all other arenas are unused.
+     * - Same as above with the tail arena frozen while being collected. The
+     *   arena following the head is either unused and receives the
+     *   collected slots, or the run covers all arenas and the frozen arena
+     *   is left to be erased.
+     *
+     * Arenas in unknown state got interrupted while being erased or are
+     * pristine, both can simply be erased.
+     */
+    enum arena_state states[NVM_FEE_MAX_ARENAS];
+    uint32_t frozen_num = 0;
+    uint32_t active_num = 0;
+    uint32_t tail = 0;
+
+    /* Read all headers before erasing anything so that newly assigned
+     * sequence numbers are unique. */
+    for (uint32_t arena = 0; arena < nvmfeep->arena_num; ++arena)
+        states[arena] = nvm_fee_arena_state_get(nvmfeep, arena);
+
+    for (uint32_t arena = 0; arena < nvmfeep->arena_num; ++arena)
+    {
+        if (states[arena] == ARENA_STATE_UNKNOWN)
+        {
+            result = nvm_fee_arena_erase(nvmfeep, arena);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            states[arena] = ARENA_STATE_UNUSED;
+        }
+        else if (states[arena] == ARENA_STATE_FROZEN)
+        {
+            ++frozen_num;
+            tail = arena;
+        }
+        else if (states[arena] == ARENA_STATE_ACTIVE)
+        {
+            ++active_num;
+        }
+    }
+
+    /* Pristine or totally broken memory. */
+    if (frozen_num > 1 || frozen_num + active_num == 0)
+        return nvm_fee_format(nvmfeep);
+
+    /* Find tail. */
+    if (frozen_num == 0)
+    {
+        for (tail = 0; tail < nvmfeep->arena_num; ++tail)
+            if (states[tail] == ARENA_STATE_ACTIVE &&
+                    states[nvm_fee_arena_prev(nvmfeep, tail)] !=
+                            ARENA_STATE_ACTIVE)
+                break;
+
+        if (tail == nvmfeep->arena_num)
+            return nvm_fee_format(nvmfeep);
+    }
+
+    /* Find head. */
+    uint32_t head = tail;
+    while (nvm_fee_arena_next(nvmfeep, head) != tail &&
+            states[nvm_fee_arena_next(nvmfeep, head)] == ARENA_STATE_ACTIVE)
+        head = nvm_fee_arena_next(nvmfeep, head);
+
+    /* Everything outside of the run has to be unused. */
+    for (uint32_t arena = nvm_fee_arena_next(nvmfeep, head);
+            arena != tail;
+            arena = nvm_fee_arena_next(nvmfeep, arena))
+        if (states[arena] != ARENA_STATE_UNUSED)
+            return nvm_fee_format(nvmfeep);
+
+    nvmfeep->arena_tail = tail;
+    nvmfeep->arena_active = head;
+
+    if (frozen_num != 0 && nvm_fee_arena_next(nvmfeep, head) == tail)
+    {
+        /* Copying finished, the frozen arena is left to be erased. */
+        result = nvm_fee_arena_erase(nvmfeep, tail);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        nvmfeep->arena_tail = nvm_fee_arena_next(nvmfeep, tail);
+    }
+
+    /* Slots to skip per arena because they are covered by a checkpoint. */
+    uint32_t first_slots[NVM_FEE_MAX_ARENAS] = { 0 };
+#if NVM_FEE_USE_CHECKPOINT
+    result = nvm_fee_checkpoint_restore(nvmfeep, first_slots);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_FEE_USE_CHECKPOINT */
 
-        result = nvm_fee_slot_lookup(nvmfeep, arena, addr,
-                &slot, &found);
+    /* Load arenas from oldest to newest. */
+    for (uint32_t arena = nvmfeep->arena_tail; ;
+            arena = nvm_fee_arena_next(nvmfeep, arena))
+    {
+        result = nvm_fee_arena_load(nvmfeep, arena, first_slots[arena]);
         if (result != HAL_SUCCESS)
             return result;
 
-        if (found == true)
+        if (arena == head)
+            break;
+    }
+
+    if (frozen_num != 0 && nvmfeep->arena_tail == tail)
+    {
+        const uint32_t dst_arena = nvm_fee_arena_next(nvmfeep, head);
+
+        if (nvmfeep->gc_threshold_slots != 0)
         {
-            /* Existing slot so read it. */
-            result = nvm_fee_slot_read(nvmfeep, arena, slot, &temp_slot);
+            /* The destination arena might already hold slots written while
+             * an incremental collection was running, keep them. */
+            result = nvm_fee_arena_load(nvmfeep, dst_arena,
+                    first_slots[dst_arena]);
             if (result != HAL_SUCCESS)
                 return result;
-        }
-        else
-        {
-            /* No existing slot so initialize a pristine one. */
-            temp_slot.address = addr;
-            memset(temp_slot.payload, 0xff, sizeof(temp_slot.payload));
-        }
 
-        uint32_t n_slot = n_remaining;
+            /* Resume collection. */
+            nvmfeep->arena_active = dst_arena;
+            nvmfeep->gc_arena = tail;
+            nvmfeep->gc_cursor = nvmfeep->arena_slots[tail];
+            nvmfeep->gc_state = NVM_FEE_GC_COPYING;
 
-        /* Compare slot data. */
-        if (memtst(temp_slot.payload, pattern, n_slot) != 0)
+            result = nvm_fee_gc_finish(nvmfeep);
+            if (result != HAL_SUCCESS)
+                return result;
+        }
+        else
         {
-            /* Update slot data. */
-            memset(temp_slot.payload, pattern, n_slot);
-
-            /* Check if arena is full and execute garbage collection. */
-            if (nvmfeep->arena_slots[nvmfeep->arena_active] ==
-                    nvmfeep->arena_num_slots)
-            {
-                result = nvm_fee_gc(nvmfeep, temp_slot.address);
-                if (result != HAL_SUCCESS)
-                    return result;
-            }
-
-            /* Write new slot. */
-            result = nvm_fee_slot_write(nvmfeep, nvmfeep->arena_active,
-                    nvmfeep->arena_slots[nvmfeep->arena_active], &temp_slot);
+            /* Clear destination arena. */
+            result = nvm_fee_arena_erase(nvmfeep, dst_arena);
             if (result != HAL_SUCCESS)
                 return result;
 
-            ++nvmfeep->arena_slots[nvmfeep->arena_active];
+            /* Restart garbage collection without omitting any address. */
+            result = nvm_fee_gc(nvmfeep, NULL, NULL);
+            if (result != HAL_SUCCESS)
+                return result;
         }
-
-        addr += n_slot;
-        n_remaining -= n_slot;
     }
 
     return HAL_SUCCESS;
@@ -973,12 +3435,25 @@ void nvmfeeObjectInit(NVMFeeDriver* nvmfeep)
     nvmfeep->vmt = &nvm_fee_vmt;
     nvmfeep->state = NVM_STOP;
     nvmfeep->config = NULL;
+    nvmfeep->map = NULL;
 #if NVM_FEE_USE_MUTUAL_EXCLUSION
     osalMutexObjectInit(&nvmfeep->mutex);
 #endif /* NVM_JEDEC_SPI_USE_MUTUAL_EXCLUSION */
     nvmfeep->arena_active = 0;
-    nvmfeep->arena_slots[0] = 0;
-    nvmfeep->arena_slots[1] = 0;
+    nvmfeep->arena_tail = 0;
+    for (uint32_t i = 0; i < NELEMS(nvmfeep->arena_slots); ++i)
+        nvmfeep->arena_slots[i] = 0;
+    nvmfeep->gc_state = NVM_FEE_GC_IDLE;
+#if NVM_FEE_CACHE_SLOTS
+    nvm_fee_cache_clear(nvmfeep);
+    nvmfeep->cache_tick = 0;
+#endif /* NVM_FEE_CACHE_SLOTS */
+#if NVM_FEE_USE_TRANSACTION
+    nvmfeep->transaction = false;
+#endif /* NVM_FEE_USE_TRANSACTION */
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    nvmfeep->page_count = 0;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
 }
 
 /**
@@ -998,107 +3473,169 @@ void nvmfeeStart(NVMFeeDriver* nvmfeep, const NVMFeeConfig* config)
 
     nvmfeep->config = config;
 
+#if NVM_FEE_CACHE_SLOTS
+    /* Data not flushed by nvmfeeStop() is discarded. */
+    nvm_fee_cache_clear(nvmfeep);
+#endif /* NVM_FEE_CACHE_SLOTS */
+#if NVM_FEE_USE_TRANSACTION
+    nvmfeep->transaction = false;
+#endif /* NVM_FEE_USE_TRANSACTION */
+
     /* Calculate and cache often reused values. */
     nvmGetInfo(nvmfeep->config->nvmp, &nvmfeep->llnvmdi);
-
-    nvmfeep->arena_num_sectors = nvmfeep->llnvmdi.sector_num / 2;
+    nvmfeep->map = NULL;
+
+    nvmfeep->slot_payload_size = (nvmfeep->config->slot_payload_size != 0) ?
+            nvmfeep->config->slot_payload_size : NVM_FEE_SLOT_PAYLOAD_SIZE;
+    osalDbgAssert(nvmfeep->slot_payload_size <= NVM_FEE_SLOT_PAYLOAD_SIZE,
+            "slot payload too large");
+    osalDbgAssert((nvmfeep->slot_payload_size + sizeof(uint32_t)) %
+            NVM_FEE_WRITE_UNIT_SIZE == 0, "slot payload misaligned");
+    nvmfeep->slot_size = 2 * sizeof(write_unit_t) + sizeof(uint32_t) +
+            nvmfeep->slot_payload_size;
+
+    nvmfeep->arena_num = (nvmfeep->config->arena_num != 0) ?
+            nvmfeep->config->arena_num : 2;
+    osalDbgAssert(nvmfeep->arena_num >= 2 &&
+            nvmfeep->arena_num <= NVM_FEE_MAX_ARENAS, "invalid arena number");
+    /* Metadata sectors precede the arenas. */
+    uint32_t header_sectors = 0;
+#if NVM_FEE_USE_CHECKPOINT
+    header_sectors = nvmfeep->config->sector_header_num;
+#endif /* NVM_FEE_USE_CHECKPOINT */
+    osalDbgAssert(nvmfeep->llnvmdi.sector_num >=
+            header_sectors + nvmfeep->arena_num, "too few sectors");
+
+    nvmfeep->arena_org = header_sectors * nvmfeep->llnvmdi.sector_size;
+    nvmfeep->arena_num_sectors =
+            (nvmfeep->llnvmdi.sector_num - header_sectors) /
+            nvmfeep->arena_num;
     nvmfeep->arena_num_slots =
             (nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size
                     - sizeof(struct arena_header)) /
-            sizeof(struct slot);
-    nvmfeep->fee_size = nvmfeep->arena_num_slots * NVM_FEE_SLOT_PAYLOAD_SIZE;
-
-    /* Check state and recover if necessary. */
-
-    /* Examine active arena. */
-    const enum arena_state states[2] =
-    {
-        [0] = nvm_fee_arena_state_get(nvmfeep, 0),
-        [1] = nvm_fee_arena_state_get(nvmfeep, 1),
-    };
-
-    /* Possible states are:
-     *
-     * - active / unused
-     * - unused / active
-     * - frozen / any
-     * - any / frozen
-     * - anything else
-     *
-     */
-
-    bool result;
-
-    if (states[0] == ARENA_STATE_ACTIVE && states[1] == ARENA_STATE_UNUSED)
+            nvmfeep->slot_size;
+    nvmfeep->page_slots = 0;
+    nvmfeep->page_first_slots = 0;
+    if (nvmfeep->config->page_size != 0)
     {
-        /* Load arena 0 as active arena. */
-        nvmfeep->arena_active = 0;
-        result = nvm_fee_arena_load(nvmfeep, 0);
-        if (result != HAL_SUCCESS)
-            goto out_error;
+        osalDbgAssert(nvmfeep->llnvmdi.sector_size %
+                nvmfeep->config->page_size == 0, "invalid page size");
+        osalDbgAssert(nvmfeep->config->page_size >=
+                sizeof(struct arena_header) + nvmfeep->slot_size,
+                "page too small");
+
+        /* Keep slots from straddling page boundaries. */
+        nvmfeep->page_slots = nvmfeep->config->page_size / nvmfeep->slot_size;
+        nvmfeep->page_first_slots = (nvmfeep->config->page_size -
+                sizeof(struct arena_header)) / nvmfeep->slot_size;
+        nvmfeep->arena_num_slots = nvmfeep->page_first_slots +
+                (nvmfeep->arena_num_sectors * nvmfeep->llnvmdi.sector_size /
+                        nvmfeep->config->page_size - 1) *
+                nvmfeep->page_slots;
     }
-    else if (states[0] == ARENA_STATE_UNUSED && states[1] == ARENA_STATE_ACTIVE)
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    osalDbgAssert(nvmfeep->slot_size <= NVM_FEE_PAGE_BUFFER_SIZE,
+            "page buffer too small");
+    nvmfeep->page_count = 0;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+    nvmfeep->gc_state = NVM_FEE_GC_IDLE;
+    nvmfeep->gc_step_slots = nvmfeep->arena_num_slots;
+    nvmfeep->gc_threshold_slots = 0;
+
+    /* Slots which may be written while an incremental collection is
+     * running have to be reserved. */
+    uint32_t reserved_slots = 0;
+    if (nvmfeep->config->gc_threshold != 0)
     {
-        /* Load arena 0 as active arena. */
-        nvmfeep->arena_active = 1;
-        result = nvm_fee_arena_load(nvmfeep, 1);
-        if (result != HAL_SUCCESS)
-            goto out_error;
+        /* Incremental collection relies on a single spare arena. */
+        osalDbgAssert(nvmfeep->arena_num == 2, "invalid arena number");
+        osalDbgAssert(nvmfeep->config->gc_threshold <= 100,
+                "invalid gc threshold");
+
+        if (nvmfeep->config->gc_step_slots != 0)
+            nvmfeep->gc_step_slots = nvmfeep->config->gc_step_slots;
+        nvmfeep->gc_threshold_slots = nvmfeep->arena_num_slots *
+                nvmfeep->config->gc_threshold / 100;
+        if (nvmfeep->gc_threshold_slots == 0)
+            nvmfeep->gc_threshold_slots = 1;
+
+        /* One step to begin, one per copy step and one per erased sector.*/
+        reserved_slots = 1 +
+                (nvmfeep->arena_num_slots + nvmfeep->gc_step_slots - 1) /
+                        nvmfeep->gc_step_slots +
+                nvmfeep->arena_num_sectors;
+        osalDbgAssert(reserved_slots < nvmfeep->arena_num_slots,
+                "gc step too small");
     }
-    else if (states[0] == ARENA_STATE_FROZEN)
-    {
-        /* Clear arena 1. */
-        result = nvm_fee_arena_erase(nvmfeep, 1);
-        if (result != HAL_SUCCESS)
-            goto out_error;
-
-        /* Load arena 0 as active arena. */
-        nvmfeep->arena_active = 0;
-        result = nvm_fee_arena_load(nvmfeep, 0);
-        if (result != HAL_SUCCESS)
-            goto out_error;
 
-        /* Restart garbage collection without omitting any address. */
-        result = nvm_fee_gc(nvmfeep, 0xffffffff);
-        if (result != HAL_SUCCESS)
-            goto out_error;
-    }
-    else if (states[1] == ARENA_STATE_FROZEN)
+#if NVM_FEE_USE_TRANSACTION
+    /* A transaction and its commit mark have to fit into one arena. Space
+     * is reserved in every used arena, so collecting the one holding the
+     * least live data always makes enough room. */
+    reserved_slots += (nvmfeep->arena_num - 1) * (NVM_FEE_CACHE_SLOTS + 1);
+    osalDbgAssert(reserved_slots < nvmfeep->arena_num_slots,
+            "transaction too large");
+#endif /* NVM_FEE_USE_TRANSACTION */
+
+    /* One arena is always kept as spare for garbage collection. */
+    nvmfeep->fee_size = ((nvmfeep->arena_num - 1) * nvmfeep->arena_num_slots -
+            reserved_slots) * nvmfeep->slot_payload_size;
+
+    /* A configured garbage collection bitmap covers all addresses for a
+     * single pass over the source arena, the internal one takes a pass per
+     * 8 * NVM_FEE_GC_BITMAP_SIZE addresses. */
+    osalDbgAssert(nvmfeep->config->gc_bitmapp == NULL ||
+            nvmfeep->config->gc_bitmap_size * 8 >=
+                    nvmfeep->fee_size / nvmfeep->slot_payload_size,
+            "gc bitmap too small");
+
+#if NVM_FEE_USE_INDEX
+    if (nvmfeep->config->indexp != NULL)
     {
-        /* Clear arena 0. */
-        result = nvm_fee_arena_erase(nvmfeep, 0);
-        if (result != HAL_SUCCESS)
-            goto out_error;
-
-        /* Load arena 1 as active arena. */
-        nvmfeep->arena_active = 1;
-        result = nvm_fee_arena_load(nvmfeep, 1);
-        if (result != HAL_SUCCESS)
-            goto out_error;
-
-        /* Restart garbage collection without omitting any address. */
-        result = nvm_fee_gc(nvmfeep, 0xffffffff);
-        if (result != HAL_SUCCESS)
-            goto out_error;
+        /* Verify index buffer covers all payload addresses. */
+        osalDbgAssert(nvmfeep->config->index_num >=
+                nvmfeep->fee_size / nvmfeep->slot_payload_size,
+                "index too small");
+        /* Verify slot numbers can be represented by index entries. */
+        osalDbgAssert(nvmfeep->arena_num * nvmfeep->arena_num_slots <
+                NVM_FEE_INDEX_EMPTY, "too many slots for index");
     }
-    else
+    nvm_fee_index_clear(nvmfeep);
+#endif /* NVM_FEE_USE_INDEX */
+
+    nvmfeep->run_units = 1;
+#if NVM_FEE_USE_INDEX
+    if (nvmfeep->config->run_units > 1)
     {
-        /* Pristine or totally broken memory. */
-        result = nvm_fee_arena_erase(nvmfeep, 0);
-        if (result != HAL_SUCCESS)
-            goto out_error;
+        /* Runs are only found through the index, their slots are packed
+         * and the unit count takes the top address byte. */
+        osalDbgAssert(nvmfeep->config->indexp != NULL, "runs need index");
+        osalDbgAssert(nvmfeep->config->page_size == 0,
+                "runs need packed slots");
+        osalDbgAssert(nvmfeep->config->run_units <= NVM_FEE_RUN_MAX,
+                "run too long");
+        osalDbgAssert(nvmfeep->fee_size <= (1UL << NVM_FEE_RUN_SHIFT),
+                "fee too large for runs");
+        nvmfeep->run_units = nvmfeep->config->run_units;
+    }
+#endif /* NVM_FEE_USE_INDEX */
 
-        result = nvm_fee_arena_erase(nvmfeep, 1);
-        if (result != HAL_SUCCESS)
-            goto out_error;
+#if NVM_FEE_USE_CHECKPOINT
+    /* Verify metadata sectors can hold at least one checkpoint. */
+    osalDbgAssert(nvmfeep->arena_org == 0 ||
+            nvm_fee_checkpoint_size(nvmfeep) <= nvmfeep->arena_org,
+            "metadata too small");
+    nvmfeep->sequence = 0;
+#endif /* NVM_FEE_USE_CHECKPOINT */
 
-        result = nvm_fee_arena_state_update(nvmfeep, 0, ARENA_STATE_ACTIVE);
-        if (result != HAL_SUCCESS)
-            goto out_error;
+#if NVM_FEE_USE_STATS
+    memset(&nvmfeep->stats, 0, sizeof(nvmfeep->stats));
+#endif /* NVM_FEE_USE_STATS */
 
-        nvmfeep->arena_active = 0;
-        nvmfeep->arena_slots[0] = 0;
-    }
+    /* Check state and recover if necessary. */
+    bool result = nvm_fee_recover(nvmfeep);
+    if (result != HAL_SUCCESS)
+        goto out_error;
 
     nvmfeep->state = NVM_READY;
     return;
@@ -1122,6 +3659,37 @@ void nvmfeeStop(NVMFeeDriver* nvmfeep)
     osalDbgAssert((nvmfeep->state == NVM_STOP) || (nvmfeep->state == NVM_READY),
             "invalid state");
 
+    nvmfeep->map = NULL;
+
+#if NVM_FEE_USE_TRANSACTION
+    /* Uncommitted transactions are discarded. */
+    if (nvmfeep->transaction == true)
+    {
+        nvm_fee_cache_clear(nvmfeep);
+        nvmfeep->transaction = false;
+    }
+#endif /* NVM_FEE_USE_TRANSACTION */
+
+#if NVM_FEE_CACHE_SLOTS || NVM_FEE_PAGE_BUFFER_SIZE
+    if (nvmfeep->state == NVM_READY)
+    {
+        bool flushed = false;
+#if NVM_FEE_CACHE_SLOTS
+        /* Write back cached data. */
+        if (nvm_fee_cache_flush(nvmfeep, &flushed) != HAL_SUCCESS)
+            flushed = false;
+#endif /* NVM_FEE_CACHE_SLOTS */
+#if NVM_FEE_PAGE_BUFFER_SIZE
+        /* Program gathered slots. */
+        if (nvmfeep->page_count != 0 &&
+                nvm_fee_page_flush(nvmfeep) == HAL_SUCCESS)
+            flushed = true;
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+        if (flushed == true)
+            nvmLldSync(NVM_FEE_LLD, nvmfeep->config->nvmp);
+    }
+#endif /* NVM_FEE_CACHE_SLOTS || NVM_FEE_PAGE_BUFFER_SIZE */
+
     nvmfeep->state = NVM_STOP;
 }
 
@@ -1148,14 +3716,19 @@ bool nvmfeeRead(NVMFeeDriver* nvmfeep, uint32_t startaddr,
     /* Verify range is within fee size. */
     osalDbgAssert(startaddr + n <= nvmfeep->fee_size, "invalid parameters");
 
+    nvmfeep->map = NULL;
+
     /* Read operation in progress. */
     nvmfeep->state = NVM_READING;
 
-    bool result = nvm_fee_read(nvmfeep, nvmfeep->arena_active, startaddr,
-            n, buffer);
+    bool result = nvm_fee_read(nvmfeep, startaddr, n, buffer);
     if (result != HAL_SUCCESS)
         return result;
 
+#if NVM_FEE_CACHE_SLOTS
+    nvm_fee_cache_read(nvmfeep, startaddr, n, buffer);
+#endif /* NVM_FEE_CACHE_SLOTS */
+
     /* Read operation finished. */
     nvmfeep->state = NVM_READY;
 
@@ -1185,11 +3758,14 @@ bool nvmfeeWrite(NVMFeeDriver* nvmfeep, uint32_t startaddr,
     /* Verify range is within fee size. */
     osalDbgAssert(startaddr + n <= nvmfeep->fee_size, "invalid parameters");
 
+    nvmfeep->map = NULL;
+
     /* Write operation in progress. */
     nvmfeep->state = NVM_WRITING;
 
-    bool result = nvm_fee_write(nvmfeep, nvmfeep->arena_active, startaddr,
-            n, buffer);
+    NVM_FEE_STATS_ADD(nvmfeep, bytes_requested, n);
+
+    bool result = nvm_fee_write(nvmfeep, startaddr, n, buffer);
     if (result != HAL_SUCCESS)
         return result;
 
@@ -1217,11 +3793,14 @@ bool nvmfeeErase(NVMFeeDriver* nvmfeep, uint32_t startaddr, uint32_t n)
     /* Verify range is within fee size. */
     osalDbgAssert(startaddr + n <= nvmfeep->fee_size, "invalid parameters");
 
+    nvmfeep->map = NULL;
+
     /* Erase operation in progress. */
     nvmfeep->state = NVM_ERASING;
 
-    bool result = nvm_fee_write_pattern(nvmfeep, nvmfeep->arena_active,
-            startaddr, n, 0xff);
+    NVM_FEE_STATS_ADD(nvmfeep, bytes_requested, n);
+
+    bool result = nvm_fee_write_pattern(nvmfeep, startaddr, n, 0xff);
     if (result != HAL_SUCCESS)
         return result;
 
@@ -1245,25 +3824,15 @@ bool nvmfeeMassErase(NVMFeeDriver* nvmfeep)
     /* Verify device status. */
     osalDbgAssert(nvmfeep->state >= NVM_READY, "invalid state");
 
+    nvmfeep->map = NULL;
+
     /* Erase operation in progress. */
     nvmfeep->state = NVM_ERASING;
 
-    bool result;
-
-    result = nvm_fee_arena_erase(nvmfeep, 0);
-    if (result != HAL_SUCCESS)
-        return result;
-
-    result = nvm_fee_arena_erase(nvmfeep, 1);
-    if (result != HAL_SUCCESS)
-        return result;
-
-    result = nvm_fee_arena_state_update(nvmfeep, 0, ARENA_STATE_ACTIVE);
+    bool result = nvm_fee_format(nvmfeep);
     if (result != HAL_SUCCESS)
         return result;
 
-    nvmfeep->arena_active = 0;
-
     return HAL_SUCCESS;
 }
 
@@ -1284,10 +3853,66 @@ bool nvmfeeSync(NVMFeeDriver* nvmfeep)
     /* Verify device status. */
     osalDbgAssert(nvmfeep->state >= NVM_READY, "invalid state");
 
+    nvmfeep->map = NULL;
+
+    bool result;
+
+#if NVM_FEE_CACHE_SLOTS
+    /* Write back cached data unless it belongs to a transaction. */
+    bool flushed = false;
+#if NVM_FEE_USE_TRANSACTION
+    if (nvmfeep->transaction == false)
+#endif /* NVM_FEE_USE_TRANSACTION */
+    {
+        result = nvm_fee_cache_flush(nvmfeep, &flushed);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    if (flushed == true)
+        nvmfeep->state = NVM_WRITING;
+#endif /* NVM_FEE_CACHE_SLOTS */
+
+    /* Give incremental garbage collection a chance to proceed. */
+    if (nvmfeep->gc_state != NVM_FEE_GC_IDLE ||
+            nvmfeep->gc_threshold_slots != 0)
+    {
+        result = nvm_fee_gc_schedule(nvmfeep);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        nvmfeep->state = NVM_WRITING;
+    }
+
+#if NVM_FEE_USE_CHECKPOINT
+    /* Record checkpoint after enough slots have been written. */
+    if (nvmfeep->config->checkpoint_slots != 0 &&
+            nvmfeep->checkpoint_pending >= nvmfeep->config->checkpoint_slots)
+    {
+        result = nvm_fee_checkpoint_write(nvmfeep);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        nvmfeep->state = NVM_WRITING;
+    }
+#endif /* NVM_FEE_USE_CHECKPOINT */
+
+#if NVM_FEE_PAGE_BUFFER_SIZE
+    /* Program gathered slots. */
+    if (nvmfeep->page_count != 0)
+    {
+        result = nvm_fee_page_flush(nvmfeep);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        nvmfeep->state = NVM_WRITING;
+    }
+#endif /* NVM_FEE_PAGE_BUFFER_SIZE */
+
     if (nvmfeep->state == NVM_READY)
         return HAL_SUCCESS;
 
-    bool result = nvmSync(nvmfeep->config->nvmp);
+    result = nvmLldSync(NVM_FEE_LLD, nvmfeep->config->nvmp);
     if (result != HAL_SUCCESS)
         return result;
 
@@ -1315,16 +3940,249 @@ bool nvmfeeGetInfo(NVMFeeDriver* nvmfeep, NVMDeviceInfo* nvmdip)
     /* Verify device status. */
     osalDbgAssert(nvmfeep->state >= NVM_READY, "invalid state");
 
-    nvmdip->sector_size = NVM_FEE_SLOT_PAYLOAD_SIZE;
-    nvmdip->sector_num = nvmfeep->arena_num_slots;
+    nvmdip->sector_size = nvmfeep->slot_payload_size;
+    nvmdip->sector_num = nvmfeep->fee_size / nvmfeep->slot_payload_size;
     memcpy(nvmdip->identification, nvmfeep->llnvmdi.identification,
            sizeof(nvmdip->identification));
     /* Note: The virtual address room can be written byte wise */
     nvmdip->write_alignment = 0;
+    nvmdip->page_size = 0;
+    memset(nvmdip->erase_sizes, 0, sizeof(nvmdip->erase_sizes));
+    nvmdip->erase_sizes[0] = nvmfeep->slot_payload_size;
+    memset(&nvmdip->timing, 0, sizeof(nvmdip->timing));
+    nvmdip->memory_mapped = false;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Executes a single step of the incremental garbage collection.
+ * @details Starts a collection if the fill threshold has been reached or
+ *          advances a running one by at most @p gc_step_slots slots or one
+ *          sector erase. Intended to be called from a low priority thread
+ *          while holding the bus, see @p nvmfeeAcquireBus().
+ * @note    @p nvmfeeSync() must be called afterwards.
+ *
+ * @param[in] nvmfeep       pointer to the @p NVMFeeDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmfeeGCStep(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck(nvmfeep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmfeep->state >= NVM_READY, "invalid state");
+
+    nvmfeep->map = NULL;
+
+    /* Write operation in progress. */
+    nvmfeep->state = NVM_WRITING;
+
+    bool result = nvm_fee_gc_schedule(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    return HAL_SUCCESS;
+}
+
+#if NVM_FEE_USE_STATS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns usage statistics.
+ * @details Counters are accumulated since @p nvmfeeStart(), erase counters
+ *          are read from the arena headers.
+ * @note    Determining the live slots walks all slots unless the slot index
+ *          is available.
+ *
+ * @param[in] nvmfeep       pointer to the @p NVMFeeDriver object
+ * @param[out] statsp       pointer to a @p NVMFeeStats structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmfeeGetStats(NVMFeeDriver* nvmfeep, NVMFeeStats* statsp)
+{
+    osalDbgCheck(nvmfeep != NULL);
+    osalDbgCheck(statsp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmfeep->state >= NVM_READY, "invalid state");
+
+    nvmfeep->map = NULL;
+
+    *statsp = nvmfeep->stats;
+
+    statsp->slots_used = 0;
+    for (uint32_t arena = 0; arena < nvmfeep->arena_num; ++arena)
+        statsp->slots_used += nvmfeep->arena_slots[arena];
+    statsp->slots_free = nvmfeep->arena_num * nvmfeep->arena_num_slots -
+            statsp->slots_used;
+
+    statsp->slots_live = 0;
+
+#if NVM_FEE_USE_INDEX
+    if (nvmfeep->run_units > 1)
+    {
+        /* Count slots of records backing at least one address. */
+        for (uint32_t arena = 0; arena < nvmfeep->arena_num; ++arena)
+        {
+            uint32_t extent;
+            for (uint32_t slot = 0; slot < nvmfeep->arena_slots[arena];
+                    slot += extent)
+            {
+                struct slot temp_slot;
+                const struct slot* imagep;
+                bool result = nvm_fee_slot_map(nvmfeep, arena, slot,
+                        &temp_slot, &imagep);
+                if (result != HAL_SUCCESS)
+                    return result;
+
+                extent = nvm_fee_record_extent(nvmfeep, slot, imagep);
+                if (nvm_fee_mark_2_slot_state(imagep->state_mark) !=
+                        SLOT_STATE_VALID)
+                    continue;
+
+                const uint32_t address = nvm_fee_record_address(nvmfeep,
+                        imagep->address);
+                const uint32_t units = nvm_fee_record_units(nvmfeep,
+                        imagep->address);
+                for (uint32_t i = 0; i < units; ++i)
+                {
+                    if (nvm_fee_unit_is_live(nvmfeep,
+                            address + i * nvmfeep->slot_payload_size,
+                            arena * nvmfeep->arena_num_slots + slot))
+                    {
+                        statsp->slots_live += extent;
+                        break;
+                    }
+                }
+            }
+        }
+        statsp->slots_stale = statsp->slots_used - statsp->slots_live;
+
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_FEE_USE_INDEX */
+
+    /* Count addresses backed by a valid slot. */
+    for (uint32_t addr = 0;
+            addr < nvmfeep->fee_size;
+            addr += nvmfeep->slot_payload_size)
+    {
+        uint32_t arena;
+        uint32_t slot;
+        bool found;
+
+        bool result = nvm_fee_lookup(nvmfeep, addr, &arena, &slot, &found);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (found == true)
+            ++statsp->slots_live;
+    }
+    statsp->slots_stale = statsp->slots_used - statsp->slots_live;
+
+    return HAL_SUCCESS;
+}
+#endif /* NVM_FEE_USE_STATS */
+
+#if NVM_FEE_USE_TRANSACTION || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a transaction.
+ * @details All following writes and erases are collected in the write-back
+ *          cache until @p nvmfeeTransactionCommit() stores them atomically.
+ *          Cached data of previous writes is written back first.
+ * @note    A transaction is limited to @p NVM_FEE_CACHE_SLOTS slots, writes
+ *          exceeding this limit fail.
+ *
+ * @param[in] nvmfeep       pointer to the @p NVMFeeDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmfeeTransactionBegin(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck(nvmfeep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmfeep->state >= NVM_READY, "invalid state");
+    osalDbgAssert(nvmfeep->transaction == false, "transaction in progress");
+
+    nvmfeep->map = NULL;
+
+    bool flushed;
+    bool result = nvm_fee_cache_flush(nvmfeep, &flushed);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    if (flushed == true)
+        nvmfeep->state = NVM_WRITING;
+
+    nvmfeep->transaction = true;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Stores all data written since @p nvmfeeTransactionBegin().
+ * @details Either all or none of the changes survive a power failure.
+ * @note    @p nvmfeeSync() must be called afterwards.
+ *
+ * @param[in] nvmfeep       pointer to the @p NVMFeeDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmfeeTransactionCommit(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck(nvmfeep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmfeep->state >= NVM_READY, "invalid state");
+    osalDbgAssert(nvmfeep->transaction == true, "no transaction");
+
+    nvmfeep->map = NULL;
+
+    /* Write operation in progress. */
+    nvmfeep->state = NVM_WRITING;
+
+    bool result = nvm_fee_transaction_commit(nvmfeep);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    nvmfeep->transaction = false;
 
     return HAL_SUCCESS;
 }
 
+/**
+ * @brief   Discards all data written since @p nvmfeeTransactionBegin().
+ *
+ * @param[in] nvmfeep       pointer to the @p NVMFeeDriver object
+ *
+ * @api
+ */
+void nvmfeeTransactionAbort(NVMFeeDriver* nvmfeep)
+{
+    osalDbgCheck(nvmfeep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmfeep->state >= NVM_READY, "invalid state");
+    osalDbgAssert(nvmfeep->transaction == true, "no transaction");
+
+    nvm_fee_cache_clear(nvmfeep);
+    nvmfeep->transaction = false;
+}
+#endif /* NVM_FEE_USE_TRANSACTION */
+
 /**
  * @brief   Gains exclusive access to the nvm device.
  * @details This function tries to gain ownership to the nvm device, if the
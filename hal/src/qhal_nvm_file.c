@@ -26,6 +26,14 @@
 
 #include <string.h>
 
+#if !HAS_FATFS
+#include <unistd.h>
+#endif /* !HAS_FATFS */
+
+#if NVM_FILE_USE_MMAP
+#include <sys/mman.h>
+#endif /* NVM_FILE_USE_MMAP */
+
 /*
  * @todo    - add write protection emulation
  *
@@ -61,12 +69,247 @@ static const struct NVMFileDriverVMT nvm_file_vmt =
     .mass_writeprotect = (bool (*)(void*))nvmfileMassWriteProtect,
     .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmfileWriteUnprotect,
     .mass_writeunprotect = (bool (*)(void*))nvmfileMassWriteUnprotect,
+#if NVM_FILE_USE_MMAP
+    .map = (bool (*)(void*, uint32_t, uint32_t, const uint8_t**))nvmfileMap,
+#endif /* NVM_FILE_USE_MMAP */
 };
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Fills a range of the file with erased bytes.
+ */
+static bool nvm_file_fill(NVMFileDriver* nvmfilep, uint32_t startaddr,
+        uint32_t n)
+{
+#if NVM_FILE_USE_MMAP
+    memset(nvmfilep->mapping + startaddr, 0xff, n);
+#else /* NVM_FILE_USE_MMAP */
+    uint8_t erased[NVM_FILE_FILL_BUFFER_SIZE];
+    memset(erased, 0xff, sizeof(erased));
+
+#if HAS_FATFS
+    if (f_lseek(&nvmfilep->file, startaddr) != FR_OK)
+        return HAL_FAILED;
+#else /* HAS_FATFS */
+    if (fseek(nvmfilep->file, startaddr, SEEK_SET) != 0)
+        return HAL_FAILED;
+#endif /* HAS_FATFS */
+
+    while (n > 0)
+    {
+        const uint32_t chunk = (n < sizeof(erased)) ? n : sizeof(erased);
+
+#if HAS_FATFS
+        UINT written;
+        if (f_write(&nvmfilep->file, erased, chunk, &written) != FR_OK ||
+                written != chunk)
+            return HAL_FAILED;
+#else /* HAS_FATFS */
+        if (fwrite(erased, 1, chunk, nvmfilep->file) != chunk)
+            return HAL_FAILED;
+#endif /* HAS_FATFS */
+
+        n -= chunk;
+    }
+#endif /* NVM_FILE_USE_MMAP */
+
+    return HAL_SUCCESS;
+}
+
+#if !NVM_FILE_USE_MMAP
+/**
+ * @brief   Reads a range straight from the file.
+ */
+static bool nvm_file_read_direct(NVMFileDriver* nvmfilep, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+#if HAS_FATFS
+    UINT read;
+
+    if (f_lseek(&nvmfilep->file, startaddr) != FR_OK)
+        return HAL_FAILED;
+
+    if (f_read(&nvmfilep->file, buffer, n, &read) != FR_OK || read != n)
+        return HAL_FAILED;
+#else /* HAS_FATFS */
+    if (fseek(nvmfilep->file, startaddr, SEEK_SET) != 0)
+        return HAL_FAILED;
+
+    if (fread(buffer, 1, n, nvmfilep->file) != n)
+        return HAL_FAILED;
+#endif /* HAS_FATFS */
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes a range straight to the file.
+ */
+static bool nvm_file_write_direct(NVMFileDriver* nvmfilep, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+#if HAS_FATFS
+    UINT written;
+
+    if (f_lseek(&nvmfilep->file, startaddr) != FR_OK)
+        return HAL_FAILED;
+
+    if (f_write(&nvmfilep->file, buffer, n, &written) != FR_OK ||
+            written != n)
+        return HAL_FAILED;
+#else /* HAS_FATFS */
+    if (fseek(nvmfilep->file, startaddr, SEEK_SET) != 0)
+        return HAL_FAILED;
+
+    if (fwrite(buffer, 1, n, nvmfilep->file) != n)
+        return HAL_FAILED;
+#endif /* HAS_FATFS */
+
+    return HAL_SUCCESS;
+}
+#endif /* !NVM_FILE_USE_MMAP */
+
+/**
+ * @brief   Records pending writes.
+ */
+static void nvm_file_mark_dirty(NVMFileDriver* nvmfilep)
+{
+#if NVM_FILE_SYNC_INTERVAL > 0
+    if (!nvmfilep->dirty)
+        nvmfilep->dirty_since = osalOsGetSystemTimeX();
+#endif /* NVM_FILE_SYNC_INTERVAL > 0 */
+
+    nvmfilep->dirty = true;
+}
+
+/**
+ * @brief   Flushes pending writes older than @p NVM_FILE_SYNC_INTERVAL.
+ */
+static bool nvm_file_sync_expired(NVMFileDriver* nvmfilep)
+{
+#if NVM_FILE_SYNC_INTERVAL > 0
+    if (nvmfilep->dirty &&
+            (systime_t)(osalOsGetSystemTimeX() - nvmfilep->dirty_since) >=
+            TIME_MS2I(NVM_FILE_SYNC_INTERVAL))
+        return nvmfileSync(nvmfilep);
+#else /* NVM_FILE_SYNC_INTERVAL > 0 */
+    (void)nvmfilep;
+#endif /* NVM_FILE_SYNC_INTERVAL > 0 */
+
+    return HAL_SUCCESS;
+}
+
+#if NVM_FILE_USE_FATFS_BUFFER
+/**
+ * @brief   Returns the number of file bytes covered by a buffer window.
+ */
+static uint32_t nvm_file_buffer_len(NVMFileDriver* nvmfilep, uint32_t window)
+{
+    const uint32_t size =
+            nvmfilep->config->sector_size * nvmfilep->config->sector_num;
+
+    if (size - window < NVM_FILE_FATFS_BUFFER_SIZE)
+        return size - window;
+
+    return NVM_FILE_FATFS_BUFFER_SIZE;
+}
+
+/**
+ * @brief   Writes the buffered window back to the file.
+ */
+static bool nvm_file_buffer_flush(NVMFileDriver* nvmfilep)
+{
+    if (!nvmfilep->buffer_dirty)
+        return HAL_SUCCESS;
+
+    if (nvm_file_write_direct(nvmfilep, nvmfilep->buffer_addr,
+            nvm_file_buffer_len(nvmfilep, nvmfilep->buffer_addr),
+            nvmfilep->buffer) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvmfilep->buffer_dirty = false;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Makes the window starting at @p window the buffered one.
+ */
+static bool nvm_file_buffer_load(NVMFileDriver* nvmfilep, uint32_t window)
+{
+    if (nvmfilep->buffer_addr == window)
+        return HAL_SUCCESS;
+
+    if (nvm_file_buffer_flush(nvmfilep) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvmfilep->buffer_addr = UINT32_MAX;
+
+    if (nvm_file_read_direct(nvmfilep, window,
+            nvm_file_buffer_len(nvmfilep, window),
+            nvmfilep->buffer) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvmfilep->buffer_addr = window;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns the overlap of a range with the buffered window.
+ *
+ * @return                  Number of overlapping bytes, zero if none.
+ */
+static uint32_t nvm_file_buffer_overlap(NVMFileDriver* nvmfilep,
+        uint32_t startaddr, uint32_t n, uint32_t* firstp)
+{
+    if (nvmfilep->buffer_addr == UINT32_MAX)
+        return 0;
+
+    const uint32_t window_end = nvmfilep->buffer_addr +
+            nvm_file_buffer_len(nvmfilep, nvmfilep->buffer_addr);
+    const uint32_t first = (startaddr > nvmfilep->buffer_addr) ?
+            startaddr : nvmfilep->buffer_addr;
+    const uint32_t last = (startaddr + n < window_end) ?
+            startaddr + n : window_end;
+
+    if (first >= last)
+        return 0;
+
+    *firstp = first;
+
+    return last - first;
+}
+#endif /* NVM_FILE_USE_FATFS_BUFFER */
+
+/**
+ * @brief   Erases a range of the file.
+ */
+static bool nvm_file_erase_range(NVMFileDriver* nvmfilep, uint32_t startaddr,
+        uint32_t n)
+{
+    if (nvm_file_fill(nvmfilep, startaddr, n) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+#if NVM_FILE_USE_FATFS_BUFFER
+    /* Keep the buffered window in line with the file. */
+    uint32_t first;
+    const uint32_t overlap =
+            nvm_file_buffer_overlap(nvmfilep, startaddr, n, &first);
+
+    if (overlap > 0)
+        memset(nvmfilep->buffer + (first - nvmfilep->buffer_addr), 0xff,
+                overlap);
+#endif /* NVM_FILE_USE_FATFS_BUFFER */
+
+    nvm_file_mark_dirty(nvmfilep);
+
+    return HAL_SUCCESS;
+}
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -94,6 +337,17 @@ void nvmfileObjectInit(NVMFileDriver* nvmfilep)
     nvmfilep->vmt = &nvm_file_vmt;
     nvmfilep->state = NVM_STOP;
     nvmfilep->config = NULL;
+#if !HAS_FATFS
+    nvmfilep->file = NULL;
+#endif /* !HAS_FATFS */
+#if NVM_FILE_USE_MMAP
+    nvmfilep->mapping = NULL;
+#endif /* NVM_FILE_USE_MMAP */
+    nvmfilep->dirty = false;
+#if NVM_FILE_USE_FATFS_BUFFER
+    nvmfilep->buffer_addr = UINT32_MAX;
+    nvmfilep->buffer_dirty = false;
+#endif /* NVM_FILE_USE_FATFS_BUFFER */
 #if NVM_FILE_USE_MUTUAL_EXCLUSION
     osalMutexObjectInit(&nvmfilep->mutex);
 #endif /* NVM_FILE_USE_MUTUAL_EXCLUSION */
@@ -118,6 +372,11 @@ void nvmfileStart(NVMFileDriver* nvmfilep, const NVMFileConfig* config)
         nvmfileStop(nvmfilep);
 
     nvmfilep->config = config;
+    nvmfilep->dirty = false;
+#if NVM_FILE_USE_FATFS_BUFFER
+    nvmfilep->buffer_addr = UINT32_MAX;
+    nvmfilep->buffer_dirty = false;
+#endif /* NVM_FILE_USE_FATFS_BUFFER */
 
 #if HAS_FATFS
     FRESULT result;
@@ -144,13 +403,40 @@ void nvmfileStart(NVMFileDriver* nvmfilep, const NVMFileConfig* config)
 
     if (current_size < desired_size)
     {
-        static const uint8_t erased = 0xff;
-        for (size_t i = current_size; i < desired_size; ++i)
-            if (f_write(&nvmfilep->file, &erased, 1, NULL) != FR_OK)
+#if NVM_FILE_USE_FATFS_EXPAND
+        if (current_size == 0)
+        {
+            /* Allocate one contiguous cluster chain, the content is
+               undefined until filled below. */
+            result = f_expand(&nvmfilep->file, desired_size, 1);
+
+            /* Note: Falls back to a fragmented file if the volume has no
+               contiguous space left. */
+            if (result != FR_OK && result != FR_DENIED)
                 return;
+        }
+#endif /* NVM_FILE_USE_FATFS_EXPAND */
+
+        if (nvm_file_fill(nvmfilep, current_size,
+                desired_size - current_size) != HAL_SUCCESS)
+            return;
         if (f_sync(&nvmfilep->file) != FR_OK)
             return;
     }
+
+#if NVM_FILE_FATFS_LINKMAP_SIZE > 0
+    /* Attach a cluster link map so seeks do not follow the FAT chain. */
+    nvmfilep->linkmap[0] = NVM_FILE_FATFS_LINKMAP_SIZE;
+    nvmfilep->file.cltbl = nvmfilep->linkmap;
+
+    result = f_lseek(&nvmfilep->file, CREATE_LINKMAP);
+
+    /* Note: A file too fragmented for the map is accessed without it. */
+    if (result == FR_NOT_ENOUGH_CORE)
+        nvmfilep->file.cltbl = NULL;
+    else if (result != FR_OK)
+        return;
+#endif /* NVM_FILE_FATFS_LINKMAP_SIZE > 0 */
 #else /* HAS_FATFS */
     nvmfilep->file = fopen(nvmfilep->config->file_name, "r+b");
 
@@ -175,12 +461,35 @@ void nvmfileStart(NVMFileDriver* nvmfilep, const NVMFileConfig* config)
 
     if (current_size < desired_size)
     {
-        static const uint8_t erased = 0xff;
-        for (size_t i = current_size; i < desired_size; ++i)
-            if (fwrite(&erased, 1, sizeof(erased), nvmfilep->file) != sizeof(erased))
-                return;
+        /* Note: The file grows at once, the new range reads as zero. */
+        if (ftruncate(fileno(nvmfilep->file), desired_size) != 0)
+            return;
+    }
+
+#if NVM_FILE_USE_MMAP
+    void* mapping = mmap(NULL, desired_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fileno(nvmfilep->file), 0);
+
+    osalDbgAssert(mapping != MAP_FAILED, "mapping failed");
+
+    if (mapping == MAP_FAILED)
+        return;
+
+    nvmfilep->mapping = mapping;
+#endif /* NVM_FILE_USE_MMAP */
+
+    if (current_size < desired_size)
+    {
+        if (nvm_file_fill(nvmfilep, current_size,
+                desired_size - current_size) != HAL_SUCCESS)
+            return;
+#if NVM_FILE_USE_MMAP
+        if (msync(nvmfilep->mapping, desired_size, MS_SYNC) != 0)
+            return;
+#else /* NVM_FILE_USE_MMAP */
         if (fflush(nvmfilep->file) != 0)
             return;
+#endif /* NVM_FILE_USE_MMAP */
     }
 #endif /* HAS_FATFS */
 
@@ -201,9 +510,21 @@ void nvmfileStop(NVMFileDriver* nvmfilep)
     osalDbgAssert((nvmfilep->state == NVM_STOP) || (nvmfilep->state == NVM_READY),
             "invalid state");
 
+    /* Write back pending data before closing. */
+    if (nvmfilep->state == NVM_READY)
+        nvmfileSync(nvmfilep);
+
 #if HAS_FATFS
     f_close(&nvmfilep->file);
 #else /* HAS_FATFS */
+#if NVM_FILE_USE_MMAP
+    if (nvmfilep->mapping != NULL)
+        munmap(nvmfilep->mapping,
+                nvmfilep->config->sector_size * nvmfilep->config->sector_num);
+
+    nvmfilep->mapping = NULL;
+#endif /* NVM_FILE_USE_MMAP */
+
     if (nvmfilep->file != NULL)
         fclose(nvmfilep->file);
 
@@ -237,25 +558,30 @@ bool nvmfileRead(NVMFileDriver* nvmfilep, uint32_t startaddr, uint32_t n,
     osalDbgAssert((startaddr + n <= nvmfilep->config->sector_size * nvmfilep->config->sector_num),
             "invalid parameters");
 
-    if (nvmfileSync(nvmfilep) != HAL_SUCCESS)
+    if (nvm_file_sync_expired(nvmfilep) != HAL_SUCCESS)
         return HAL_FAILED;
 
     /* Read operation in progress. */
     nvmfilep->state = NVM_READING;
 
-#if HAS_FATFS
-    if (f_lseek(&nvmfilep->file, startaddr) != FR_OK)
+#if NVM_FILE_USE_MMAP
+    /* Note: The mapping is coherent, nothing to wait for. */
+    memcpy(buffer, nvmfilep->mapping + startaddr, n);
+#else /* NVM_FILE_USE_MMAP */
+    if (nvm_file_read_direct(nvmfilep, startaddr, n, buffer) != HAL_SUCCESS)
         return HAL_FAILED;
 
-    if (f_read(&nvmfilep->file, buffer, n, NULL) != FR_OK)
-        return HAL_FAILED;
-#else /* HAS_FATFS */
-    if (fseek(nvmfilep->file, startaddr, SEEK_SET) != 0)
-        return HAL_FAILED;
+#if NVM_FILE_USE_FATFS_BUFFER
+    /* The buffered window may be newer than the file. */
+    uint32_t first;
+    const uint32_t overlap =
+            nvm_file_buffer_overlap(nvmfilep, startaddr, n, &first);
 
-    if (fread(buffer, 1, n, nvmfilep->file) != n)
-        return HAL_FAILED;
-#endif /* HAS_FATFS */
+    if (overlap > 0)
+        memcpy(buffer + (first - startaddr),
+                nvmfilep->buffer + (first - nvmfilep->buffer_addr), overlap);
+#endif /* NVM_FILE_USE_FATFS_BUFFER */
+#endif /* NVM_FILE_USE_MMAP */
 
     /* Read operation finished. */
     nvmfilep->state = NVM_READY;
@@ -265,6 +591,7 @@ bool nvmfileRead(NVMFileDriver* nvmfilep, uint32_t startaddr, uint32_t n,
 
 /**
  * @brief   Writes data crossing sector boundaries if required.
+ * @note    The data reaches the file on @p nvmfileSync() at the latest.
  *
  * @param[in] nvmfilep      pointer to the @p NVMFileDriver object
  * @param[in] startaddr     address to start writing to
@@ -287,25 +614,42 @@ bool nvmfileWrite(NVMFileDriver* nvmfilep, uint32_t startaddr, uint32_t n,
     osalDbgAssert((startaddr + n <= nvmfilep->config->sector_size * nvmfilep->config->sector_num),
             "invalid parameters");
 
-    if (nvmfileSync(nvmfilep) != HAL_SUCCESS)
+    if (nvm_file_sync_expired(nvmfilep) != HAL_SUCCESS)
         return HAL_FAILED;
 
     /* Write operation in progress. */
     nvmfilep->state = NVM_WRITING;
 
-#if HAS_FATFS
-    if (f_lseek(&nvmfilep->file, startaddr) != FR_OK)
-        return HAL_FAILED;
+#if NVM_FILE_USE_MMAP
+    memcpy(nvmfilep->mapping + startaddr, buffer, n);
+#elif NVM_FILE_USE_FATFS_BUFFER
+    while (n > 0)
+    {
+        const uint32_t window =
+                startaddr - (startaddr % NVM_FILE_FATFS_BUFFER_SIZE);
+        const uint32_t offset = startaddr - window;
+        const uint32_t chunk = (n < NVM_FILE_FATFS_BUFFER_SIZE - offset) ?
+                n : NVM_FILE_FATFS_BUFFER_SIZE - offset;
 
-    if (f_write(&nvmfilep->file, buffer, n, NULL) != FR_OK)
-        return HAL_FAILED;
-#else /* HAS_FATFS */
-    if (fseek(nvmfilep->file, startaddr, SEEK_SET) != 0)
-        return HAL_FAILED;
+        if (nvm_file_buffer_load(nvmfilep, window) != HAL_SUCCESS)
+            return HAL_FAILED;
 
-    if (fwrite(buffer, 1, n, nvmfilep->file) != n)
+        memcpy(nvmfilep->buffer + offset, buffer, chunk);
+        nvmfilep->buffer_dirty = true;
+
+        startaddr += chunk;
+        buffer += chunk;
+        n -= chunk;
+    }
+#else /* NVM_FILE_USE_MMAP */
+    if (nvm_file_write_direct(nvmfilep, startaddr, n, buffer) != HAL_SUCCESS)
         return HAL_FAILED;
-#endif /* HAS_FATFS */
+#endif /* NVM_FILE_USE_MMAP */
+
+    nvm_file_mark_dirty(nvmfilep);
+
+    /* Write operation finished. */
+    nvmfilep->state = NVM_READY;
 
     return HAL_SUCCESS;
 }
@@ -332,7 +676,7 @@ bool nvmfileErase(NVMFileDriver* nvmfilep, uint32_t startaddr, uint32_t n)
     osalDbgAssert((startaddr + n <= nvmfilep->config->sector_size * nvmfilep->config->sector_num),
             "invalid parameters");
 
-    if (nvmfileSync(nvmfilep) != HAL_SUCCESS)
+    if (nvm_file_sync_expired(nvmfilep) != HAL_SUCCESS)
         return HAL_FAILED;
 
     /* Erase operation in progress. */
@@ -340,34 +684,17 @@ bool nvmfileErase(NVMFileDriver* nvmfilep, uint32_t startaddr, uint32_t n)
 
     uint32_t first_sector_addr =
             startaddr - (startaddr % nvmfilep->config->sector_size);
+    uint32_t last_sector_end = startaddr + n +
+            (nvmfilep->config->sector_size -
+            (startaddr + n) % nvmfilep->config->sector_size) %
+            nvmfilep->config->sector_size;
 
-#if HAS_FATFS
-    if (f_lseek(&nvmfilep->file, first_sector_addr) != FR_OK)
-        return HAL_FAILED;
-
-    for (uint32_t addr = first_sector_addr;
-            addr < startaddr + n;
-            addr += nvmfilep->config->sector_size)
-    {
-        static const uint8_t erased = 0xff;
-        for (size_t i = 0; i < nvmfilep->config->sector_size; ++i)
-            if (f_write(&nvmfilep->file, &erased, sizeof(erased), NULL) != FR_OK)
-                return HAL_FAILED;
-    }
-#else /* HAS_FATFS */
-    if (fseek(nvmfilep->file, first_sector_addr, SEEK_SET) != 0)
+    if (nvm_file_erase_range(nvmfilep, first_sector_addr,
+            last_sector_end - first_sector_addr) != HAL_SUCCESS)
         return HAL_FAILED;
 
-    for (uint32_t addr = first_sector_addr;
-            addr < startaddr + n;
-            addr += nvmfilep->config->sector_size)
-    {
-        static const uint8_t erased = 0xff;
-        for (size_t i = 0; i < nvmfilep->config->sector_size; ++i)
-            if (fwrite(&erased, 1, sizeof(erased), nvmfilep->file) != sizeof(erased))
-                return HAL_FAILED;
-    }
-#endif /* HAS_FATFS */
+    /* Erase operation finished. */
+    nvmfilep->state = NVM_READY;
 
     return HAL_SUCCESS;
 }
@@ -389,45 +716,26 @@ bool nvmfileMassErase(NVMFileDriver* nvmfilep)
     /* Verify device status. */
     osalDbgAssert(nvmfilep->state >= NVM_READY, "invalid state");
 
-    if (nvmfileSync(nvmfilep) != HAL_SUCCESS)
+    if (nvm_file_sync_expired(nvmfilep) != HAL_SUCCESS)
         return HAL_FAILED;
 
     /* Erase operation in progress. */
     nvmfilep->state = NVM_ERASING;
 
-#if HAS_FATFS
-    for (uint32_t addr = 0;
-            addr < nvmfilep->config->sector_size * nvmfilep->config->sector_num;
-            addr += nvmfilep->config->sector_size)
-    {
-        if (f_lseek(&nvmfilep->file, addr) != FR_OK)
-            return HAL_FAILED;
-
-        static const uint8_t erased = 0xff;
-        for (size_t i = 0; i < nvmfilep->config->sector_size; ++i)
-            if (f_write(&nvmfilep->file, &erased, sizeof(erased), NULL) != FR_OK)
-                return HAL_FAILED;
-    }
-#else /* HAS_FATFS */
-    for (uint32_t addr = 0;
-            addr < nvmfilep->config->sector_size * nvmfilep->config->sector_num;
-            addr += nvmfilep->config->sector_size)
-    {
-        if (fseek(nvmfilep->file, addr, SEEK_SET) != 0)
-            return HAL_FAILED;
+    if (nvm_file_erase_range(nvmfilep, 0,
+            nvmfilep->config->sector_size * nvmfilep->config->sector_num) !=
+            HAL_SUCCESS)
+        return HAL_FAILED;
 
-        static const uint8_t erased = 0xff;
-        for (size_t i = 0; i < nvmfilep->config->sector_size; ++i)
-            if (fwrite(&erased, 1, sizeof(erased), nvmfilep->file) != sizeof(erased))
-                return HAL_FAILED;
-    }
-#endif /* HAS_FATFS */
+    /* Erase operation finished. */
+    nvmfilep->state = NVM_READY;
 
     return HAL_SUCCESS;
 }
 
 /**
- * @brief   Waits for idle condition.
+ * @brief   Flushes pending writes to the file.
+ * @details Does nothing unless writes or erases are pending.
  *
  * @param[in] nvmfilep      pointer to the @p NVMFileDriver object
  *
@@ -443,19 +751,28 @@ bool nvmfileSync(NVMFileDriver* nvmfilep)
     /* Verify device status. */
     osalDbgAssert(nvmfilep->state >= NVM_READY, "invalid state");
 
-    if (nvmfilep->state == NVM_READY)
+    if (!nvmfilep->dirty)
         return HAL_SUCCESS;
 
+#if NVM_FILE_USE_FATFS_BUFFER
+    if (nvm_file_buffer_flush(nvmfilep) != HAL_SUCCESS)
+        return HAL_FAILED;
+#endif /* NVM_FILE_USE_FATFS_BUFFER */
+
 #if HAS_FATFS
     if (f_sync(&nvmfilep->file) != FR_OK)
         return HAL_FAILED;
+#elif NVM_FILE_USE_MMAP
+    if (msync(nvmfilep->mapping,
+            nvmfilep->config->sector_size * nvmfilep->config->sector_num,
+            MS_SYNC) != 0)
+        return HAL_FAILED;
 #else /* HAS_FATFS */
     if (fflush(nvmfilep->file) != 0)
         return HAL_FAILED;
 #endif /* HAS_FATFS */
 
-    /* No more operation in progress. */
-    nvmfilep->state = NVM_READY;
+    nvmfilep->dirty = false;
 
     return HAL_SUCCESS;
 }
@@ -485,6 +802,15 @@ bool nvmfileGetInfo(NVMFileDriver* nvmfilep, NVMDeviceInfo* nvmdip)
     nvmdip->identification[2] = 'L';
     /* Note: The virtual address room can be written byte wise */
     nvmdip->write_alignment = 0;
+    nvmdip->page_size = 0;
+    memset(nvmdip->erase_sizes, 0, sizeof(nvmdip->erase_sizes));
+    nvmdip->erase_sizes[0] = nvmfilep->config->sector_size;
+    memset(&nvmdip->timing, 0, sizeof(nvmdip->timing));
+#if NVM_FILE_USE_MMAP
+    nvmdip->memory_mapped = true;
+#else /* NVM_FILE_USE_MMAP */
+    nvmdip->memory_mapped = false;
+#endif /* NVM_FILE_USE_MMAP */
 
     return HAL_SUCCESS;
 }
@@ -621,6 +947,37 @@ bool nvmfileMassWriteUnprotect(NVMFileDriver* nvmfilep)
     return HAL_SUCCESS;
 }
 
+#if NVM_FILE_USE_MMAP || defined(__DOXYGEN__)
+/**
+ * @brief   Maps a range for direct reads.
+ *
+ * @param[in] nvmfilep      pointer to the @p NVMFileDriver object
+ * @param[in] startaddr     first address to map
+ * @param[in] n             number of bytes to map
+ * @param[out] ptrp         receives the address of @p startaddr
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmfileMap(NVMFileDriver* nvmfilep, uint32_t startaddr, uint32_t n,
+        const uint8_t** ptrp)
+{
+    osalDbgCheck((nvmfilep != NULL) && (ptrp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmfilep->state >= NVM_READY, "invalid state");
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= nvmfilep->config->sector_size * nvmfilep->config->sector_num),
+            "invalid parameters");
+
+    *ptrp = nvmfilep->mapping + startaddr;
+
+    return HAL_SUCCESS;
+}
+#endif /* NVM_FILE_USE_MMAP */
+
 #endif /* HAL_USE_NVM_FILE */
 
 /** @} */
@@ -0,0 +1,910 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qhal_nvm_ftl.c
+ * @brief   NVM flash translation layer block device.
+ * @details Blocks are written out of place. Every sector of the device is
+ *          split into pages of the block size, the first page holding a
+ *          summary with the erase count, an allocation sequence number and
+ *          the logical block number of each data page. The map is rebuilt
+ *          from the summaries on connect, newer sectors and later pages
+ *          taking precedence.
+ *
+ * @addtogroup NVM_FTL
+ * @{
+ */
+
+#include "qhal.h"
+
+#if (HAL_USE_NVM_FTL == TRUE) || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Offsets within the sector summary.
+ */
+#define NVM_FTL_OFFSET_MAGIC                0
+#define NVM_FTL_OFFSET_ERASE_COUNT          4
+#define NVM_FTL_OFFSET_SEQUENCE             8
+
+/**
+ * @brief   Number of summary entries read at once.
+ */
+#define NVM_FTL_ENTRY_CHUNK                 8
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMFtlDriverVMT nvm_ftl_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint8_t*, uint32_t))nvmftlRead,
+    .write = (bool (*)(void*, uint32_t, const uint8_t*, uint32_t))nvmftlWrite,
+    .sync = (bool (*)(void*))nvmftlSync,
+    .get_info = (bool (*)(void*, BlockDeviceInfo*))nvmftlGetInfo,
+    .is_inserted = (bool (*)(void *))nvmftlIsInserted,
+    .is_protected = (bool (*)(void *))nvmftlIsProtected,
+    .connect = (bool (*)(void *))nvmftlConnect,
+    .disconnect = (bool (*)(void *))nvmftlDisconnect,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t nvm_ftl_sector_addr(NVMFtlDriver* nvmftlp, uint32_t sector)
+{
+    return sector * nvmftlp->pages * nvmftlp->config->block_size;
+}
+
+static uint32_t nvm_ftl_entry_addr(NVMFtlDriver* nvmftlp, uint32_t sector,
+        uint32_t page)
+{
+    return nvm_ftl_sector_addr(nvmftlp, sector) +
+            NVM_FTL_SUMMARY_HEADER_SIZE + (page - 1) * sizeof(uint32_t);
+}
+
+static uint32_t nvm_ftl_entry(uint32_t lba)
+{
+    return lba | ((~lba & 0xffff) << 16);
+}
+
+/**
+ * @brief   Decodes a summary entry.
+ *
+ * @return                  The logical block or @p NVM_FTL_NONE.
+ */
+static uint32_t nvm_ftl_entry_lba(NVMFtlDriver* nvmftlp, uint32_t entry)
+{
+    const uint32_t lba = entry & 0xffff;
+
+    if (entry != nvm_ftl_entry(lba) || lba >= nvmftlp->blk_num)
+        return NVM_FTL_NONE;
+
+    return lba;
+}
+
+static bool nvm_ftl_write_word(NVMFtlDriver* nvmftlp, uint32_t addr,
+        uint32_t value)
+{
+    return nvmWrite(nvmftlp->config->nvmp, addr, sizeof(value),
+            (const uint8_t*)&value);
+}
+
+/**
+ * @brief   Erases a free sector and records its erase count.
+ */
+static bool nvm_ftl_erase(NVMFtlDriver* nvmftlp, uint32_t sector)
+{
+    NVMFtlSector* sp = &nvmftlp->config->sectors[sector];
+    const uint32_t addr = nvm_ftl_sector_addr(nvmftlp, sector);
+
+    sp->flags = 0;
+
+    if (nvmErase(nvmftlp->config->nvmp, addr,
+            nvmftlp->pages * nvmftlp->config->block_size) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    sp->erase_count += 1;
+    sp->flags = NVM_FTL_SECTOR_ERASED;
+
+    if (nvm_ftl_write_word(nvmftlp, addr + NVM_FTL_OFFSET_ERASE_COUNT,
+            sp->erase_count) != HAL_SUCCESS ||
+            nvm_ftl_write_word(nvmftlp, addr + NVM_FTL_OFFSET_MAGIC,
+            NVM_FTL_MAGIC) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    sp->flags |= NVM_FTL_SECTOR_PREPARED;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Takes the least or, for cold data, the most worn free sector into
+ *          use.
+ */
+static bool nvm_ftl_allocate(NVMFtlDriver* nvmftlp, bool cold)
+{
+    NVMFtlSector* sectors = nvmftlp->config->sectors;
+    uint32_t sector = NVM_FTL_NONE;
+
+    for (uint32_t i = 0; i < nvmftlp->sector_num; ++i)
+    {
+        if (sectors[i].sequence != NVM_FTL_NONE)
+            continue;
+        if (sector == NVM_FTL_NONE ||
+                (cold == false &&
+                sectors[i].erase_count < sectors[sector].erase_count) ||
+                (cold == true &&
+                sectors[i].erase_count > sectors[sector].erase_count))
+            sector = i;
+    }
+
+    if (sector == NVM_FTL_NONE)
+        return HAL_FAILED;
+
+    NVMFtlSector* sp = &sectors[sector];
+    const uint32_t addr = nvm_ftl_sector_addr(nvmftlp, sector);
+
+    if ((sp->flags & NVM_FTL_SECTOR_ERASED) == 0)
+    {
+        if (nvm_ftl_erase(nvmftlp, sector) != HAL_SUCCESS)
+            return HAL_FAILED;
+    }
+    else if ((sp->flags & NVM_FTL_SECTOR_PREPARED) == 0)
+    {
+        if (nvm_ftl_write_word(nvmftlp, addr + NVM_FTL_OFFSET_ERASE_COUNT,
+                sp->erase_count) != HAL_SUCCESS ||
+                nvm_ftl_write_word(nvmftlp, addr + NVM_FTL_OFFSET_MAGIC,
+                NVM_FTL_MAGIC) != HAL_SUCCESS)
+            return HAL_FAILED;
+    }
+
+    if (nvm_ftl_write_word(nvmftlp, addr + NVM_FTL_OFFSET_SEQUENCE,
+            nvmftlp->sequence + 1) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvmftlp->sequence += 1;
+    sp->sequence = nvmftlp->sequence;
+    sp->valid = 0;
+    sp->flags = 0;
+
+    nvmftlp->active = sector;
+    nvmftlp->next_page = 1;
+    nvmftlp->free_num -= 1;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Unmaps a logical block.
+ */
+static void nvm_ftl_unmap(NVMFtlDriver* nvmftlp, uint32_t lba)
+{
+    const uint32_t phys = nvmftlp->config->map[lba];
+
+    if (phys == NVM_FTL_NONE)
+        return;
+
+    nvmftlp->config->sectors[phys / nvmftlp->pages].valid -= 1;
+    nvmftlp->config->map[lba] = NVM_FTL_NONE;
+}
+
+/**
+ * @brief   Writes a block to the next free page of the active sector.
+ * @note    Allocates a new sector from the free sectors if required
+ *          without collecting garbage.
+ */
+static bool nvm_ftl_program(NVMFtlDriver* nvmftlp, uint32_t lba,
+        const uint8_t* buffer, bool cold)
+{
+    if (nvmftlp->active == NVM_FTL_NONE || nvmftlp->next_page >= nvmftlp->pages)
+    {
+        nvmftlp->active = NVM_FTL_NONE;
+        if (nvm_ftl_allocate(nvmftlp, cold) != HAL_SUCCESS)
+            return HAL_FAILED;
+    }
+
+    const uint32_t sector = nvmftlp->active;
+    const uint32_t page = nvmftlp->next_page;
+    const uint32_t block_size = nvmftlp->config->block_size;
+
+    /* Note: The page is used up even if programming fails. */
+    nvmftlp->next_page += 1;
+
+    /* Note: The summary entry goes last to validate the data. */
+    if (nvmWrite(nvmftlp->config->nvmp,
+            nvm_ftl_sector_addr(nvmftlp, sector) + page * block_size,
+            block_size, buffer) != HAL_SUCCESS ||
+            nvm_ftl_write_word(nvmftlp,
+            nvm_ftl_entry_addr(nvmftlp, sector, page),
+            nvm_ftl_entry(lba)) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvm_ftl_unmap(nvmftlp, lba);
+    nvmftlp->config->map[lba] = sector * nvmftlp->pages + page;
+    nvmftlp->config->sectors[sector].valid += 1;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Picks the sector holding the least current data.
+ *
+ * @return                  The sector or @p NVM_FTL_NONE if no sector holds
+ *                          stale data.
+ */
+static uint32_t nvm_ftl_victim(NVMFtlDriver* nvmftlp)
+{
+    const NVMFtlSector* sectors = nvmftlp->config->sectors;
+    uint32_t victim = NVM_FTL_NONE;
+
+    for (uint32_t i = 0; i < nvmftlp->sector_num; ++i)
+    {
+        if (sectors[i].sequence == NVM_FTL_NONE || i == nvmftlp->active)
+            continue;
+        /* Note: Ties go to the less worn sector. */
+        if (victim == NVM_FTL_NONE ||
+                sectors[i].valid < sectors[victim].valid ||
+                (sectors[i].valid == sectors[victim].valid &&
+                sectors[i].erase_count < sectors[victim].erase_count))
+            victim = i;
+    }
+
+    if (victim != NVM_FTL_NONE && sectors[victim].valid >= nvmftlp->pages - 1)
+        return NVM_FTL_NONE;
+
+    return victim;
+}
+
+/**
+ * @brief   Picks the least worn sector holding data if it fell behind.
+ *
+ * @return                  The sector or @p NVM_FTL_NONE if wear leveling
+ *                          is not due.
+ */
+static uint32_t nvm_ftl_cold(NVMFtlDriver* nvmftlp)
+{
+    const NVMFtlSector* sectors = nvmftlp->config->sectors;
+    uint32_t cold = NVM_FTL_NONE;
+    uint32_t max_erase_count = 0;
+
+    for (uint32_t i = 0; i < nvmftlp->sector_num; ++i)
+    {
+        if (sectors[i].erase_count > max_erase_count)
+            max_erase_count = sectors[i].erase_count;
+
+        if (sectors[i].sequence == NVM_FTL_NONE || i == nvmftlp->active)
+            continue;
+        if (cold == NVM_FTL_NONE ||
+                sectors[i].erase_count < sectors[cold].erase_count)
+            cold = i;
+    }
+
+    if (cold == NVM_FTL_NONE || max_erase_count -
+            sectors[cold].erase_count < NVM_FTL_WEAR_LEVEL_THRESHOLD)
+        return NVM_FTL_NONE;
+
+    return cold;
+}
+
+/**
+ * @brief   Relocates the current data of a sector and frees it.
+ * @note    Cold data is moved to the most worn free sectors, leaving the
+ *          least worn ones to frequently changed data.
+ */
+static bool nvm_ftl_reclaim(NVMFtlDriver* nvmftlp, uint32_t sector,
+        bool cold)
+{
+    NVMFtlSector* sp = &nvmftlp->config->sectors[sector];
+    const uint32_t block_size = nvmftlp->config->block_size;
+    uint32_t entries[NVM_FTL_ENTRY_CHUNK];
+
+    for (uint32_t page = 1; page < nvmftlp->pages && sp->valid > 0;
+            page += NVM_FTL_ENTRY_CHUNK)
+    {
+        uint32_t n = nvmftlp->pages - page;
+        if (n > NVM_FTL_ENTRY_CHUNK)
+            n = NVM_FTL_ENTRY_CHUNK;
+
+        if (nvmRead(nvmftlp->config->nvmp,
+                nvm_ftl_entry_addr(nvmftlp, sector, page),
+                n * sizeof(uint32_t), (uint8_t*)entries) != HAL_SUCCESS)
+            return HAL_FAILED;
+
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const uint32_t phys = sector * nvmftlp->pages + page + i;
+            const uint32_t lba = nvm_ftl_entry_lba(nvmftlp, entries[i]);
+
+            if (lba == NVM_FTL_NONE || nvmftlp->config->map[lba] != phys)
+                continue;
+
+            if (nvmRead(nvmftlp->config->nvmp, phys * block_size, block_size,
+                    nvmftlp->config->buffer) != HAL_SUCCESS ||
+                    nvm_ftl_program(nvmftlp, lba,
+                    nvmftlp->config->buffer, cold) != HAL_SUCCESS)
+                return HAL_FAILED;
+        }
+    }
+
+    osalDbgAssert(sp->valid == 0, "map inconsistent");
+
+    /* Note: Keep cold data apart from the data written next. */
+    if (cold == true)
+        nvmftlp->active = NVM_FTL_NONE;
+
+    sp->sequence = NVM_FTL_NONE;
+    sp->flags = 0;
+    nvmftlp->free_num += 1;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Rebuilds the map from the summaries of the sectors in use.
+ */
+static bool nvm_ftl_mount(NVMFtlDriver* nvmftlp)
+{
+    const NVMFtlConfig* config = nvmftlp->config;
+    uint32_t header[3];
+
+    for (uint32_t lba = 0; lba < nvmftlp->blk_num; ++lba)
+        config->map[lba] = NVM_FTL_NONE;
+
+    nvmftlp->sequence = 0;
+    nvmftlp->active = NVM_FTL_NONE;
+    nvmftlp->next_page = 0;
+    nvmftlp->free_num = 0;
+
+    for (uint32_t sector = 0; sector < nvmftlp->sector_num; ++sector)
+    {
+        NVMFtlSector* sp = &config->sectors[sector];
+
+        if (nvmRead(config->nvmp, nvm_ftl_sector_addr(nvmftlp, sector),
+                sizeof(header), (uint8_t*)header) != HAL_SUCCESS)
+            return HAL_FAILED;
+
+        sp->valid = 0;
+
+        if (header[0] == NVM_FTL_MAGIC)
+        {
+            sp->erase_count = header[1];
+            sp->sequence = header[2];
+            sp->flags = NVM_FTL_SECTOR_ERASED | NVM_FTL_SECTOR_PREPARED;
+        }
+        else
+        {
+            bool erased;
+            if (nvmIsErased(config->nvmp,
+                    nvm_ftl_sector_addr(nvmftlp, sector),
+                    nvmftlp->pages * config->block_size, &erased) !=
+                    HAL_SUCCESS)
+                return HAL_FAILED;
+
+            /* Note: The erase count of a sector without summary is lost. */
+            sp->erase_count = 0;
+            sp->sequence = NVM_FTL_NONE;
+            sp->flags = (erased == true) ? NVM_FTL_SECTOR_ERASED : 0;
+        }
+
+        if (sp->sequence == NVM_FTL_NONE)
+            nvmftlp->free_num += 1;
+        else if (sp->sequence > nvmftlp->sequence)
+            nvmftlp->sequence = sp->sequence;
+    }
+
+    /* Replay the sectors in allocation order. */
+    uint32_t last = 0;
+    uint32_t entries[NVM_FTL_ENTRY_CHUNK];
+
+    while (true)
+    {
+        uint32_t sector = NVM_FTL_NONE;
+
+        for (uint32_t i = 0; i < nvmftlp->sector_num; ++i)
+        {
+            const uint32_t sequence = config->sectors[i].sequence;
+
+            if (sequence == NVM_FTL_NONE || sequence <= last)
+                continue;
+            if (sector == NVM_FTL_NONE ||
+                    sequence < config->sectors[sector].sequence)
+                sector = i;
+        }
+
+        if (sector == NVM_FTL_NONE)
+            break;
+
+        last = config->sectors[sector].sequence;
+
+        for (uint32_t page = 1; page < nvmftlp->pages;
+                page += NVM_FTL_ENTRY_CHUNK)
+        {
+            uint32_t n = nvmftlp->pages - page;
+            if (n > NVM_FTL_ENTRY_CHUNK)
+                n = NVM_FTL_ENTRY_CHUNK;
+
+            if (nvmRead(config->nvmp,
+                    nvm_ftl_entry_addr(nvmftlp, sector, page),
+                    n * sizeof(uint32_t), (uint8_t*)entries) != HAL_SUCCESS)
+                return HAL_FAILED;
+
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const uint32_t lba = nvm_ftl_entry_lba(nvmftlp, entries[i]);
+
+                if (lba == NVM_FTL_NONE)
+                    continue;
+
+                nvm_ftl_unmap(nvmftlp, lba);
+                config->map[lba] = sector * nvmftlp->pages + page + i;
+                config->sectors[sector].valid += 1;
+            }
+        }
+    }
+
+    /* Note: Sectors in use are not appended to after connecting as pages
+     * of an interrupted write may have been programmed partly. */
+
+    return HAL_SUCCESS;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM flash translation layer driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmftlInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmftlp      pointer to the @p NVMFtlDriver object
+ *
+ * @init
+ */
+void nvmftlObjectInit(NVMFtlDriver* nvmftlp)
+{
+    nvmftlp->vmt = &nvm_ftl_vmt;
+    nvmftlp->state = BLK_STOP;
+    nvmftlp->config = NULL;
+    nvmftlp->sector_num = 0;
+    nvmftlp->pages = 0;
+    nvmftlp->blk_num = 0;
+    nvmftlp->sequence = 0;
+    nvmftlp->active = NVM_FTL_NONE;
+    nvmftlp->next_page = 0;
+    nvmftlp->free_num = 0;
+}
+
+/**
+ * @brief   Configures and activates the NVM flash translation layer.
+ * @note    The media has to be connected before use.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ * @param[in] config        pointer to the @p NVMFtlConfig object.
+ *
+ * @api
+ */
+void nvmftlStart(NVMFtlDriver* nvmftlp, const NVMFtlConfig* config)
+{
+    osalDbgCheck((nvmftlp != NULL) && (config != NULL));
+    osalDbgCheck((config->map != NULL) && (config->sectors != NULL) &&
+            (config->buffer != NULL));
+    osalDbgAssert((nvmftlp->state == BLK_STOP) ||
+            (nvmftlp->state == BLK_ACTIVE), "invalid state");
+
+    NVMDeviceInfo nvmdi;
+    nvmGetInfo(config->nvmp, &nvmdi);
+
+    osalDbgAssert(nvmdi.sector_size % config->block_size == 0,
+            "block size incompatible with sector size");
+    osalDbgAssert(nvmdi.write_alignment <= sizeof(uint32_t),
+            "unsupported write alignment");
+    osalDbgAssert(nvmdi.sector_num > config->spare_sectors &&
+            config->spare_sectors >= 2, "invalid spare sectors");
+
+    nvmftlp->config = config;
+    nvmftlp->sector_num = nvmdi.sector_num;
+    nvmftlp->pages = nvmdi.sector_size / config->block_size;
+    nvmftlp->blk_num = NVM_FTL_BLOCK_NUM(nvmdi.sector_size,
+            nvmdi.sector_num, config->block_size, config->spare_sectors);
+
+    osalDbgAssert(nvmftlp->pages >= 2 &&
+            NVM_FTL_SUMMARY_HEADER_SIZE + (nvmftlp->pages - 1) *
+            sizeof(uint32_t) <= config->block_size, "block size too small");
+    osalDbgAssert(nvmftlp->blk_num <= 0xffff, "too many blocks");
+
+    nvmftlp->state = BLK_ACTIVE;
+}
+
+/**
+ * @brief   Disables the NVM flash translation layer.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ *
+ * @api
+ */
+void nvmftlStop(NVMFtlDriver* nvmftlp)
+{
+    osalDbgCheck(nvmftlp != NULL);
+    osalDbgAssert((nvmftlp->state == BLK_STOP) ||
+            (nvmftlp->state == BLK_ACTIVE) || (nvmftlp->state == BLK_READY),
+            "invalid state");
+
+    nvmftlp->state = BLK_STOP;
+}
+
+/**
+ * @brief   Reads blocks.
+ * @note    Blocks never written read as erased.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ * @param[in] startblk      block to start reading from
+ * @param[in] buffer        pointer to data buffer
+ * @param[in] n             number of blocks to read
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmftlRead(NVMFtlDriver* nvmftlp, uint32_t startblk,
+        uint8_t* buffer, uint32_t n)
+{
+    osalDbgCheck(nvmftlp != NULL);
+    osalDbgAssert(nvmftlp->state == BLK_READY, "invalid state");
+    osalDbgAssert(startblk + n <= nvmftlp->blk_num, "invalid parameters");
+
+    const uint32_t block_size = nvmftlp->config->block_size;
+
+    nvmftlp->state = BLK_READING;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const uint32_t phys = nvmftlp->config->map[startblk + i];
+        uint8_t* datap = buffer + i * block_size;
+
+        if (phys == NVM_FTL_NONE)
+        {
+            memset(datap, 0xff, block_size);
+        }
+        else if (nvmRead(nvmftlp->config->nvmp, phys * block_size,
+                block_size, datap) != HAL_SUCCESS)
+        {
+            nvmftlp->state = BLK_READY;
+            return HAL_FAILED;
+        }
+    }
+
+    nvmftlp->state = BLK_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes blocks.
+ * @details Data goes to pre-erased pages, collecting garbage only if the
+ *          free sectors run out.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ * @param[in] startblk      block to start writing to
+ * @param[in] buffer        pointer to data buffer
+ * @param[in] n             number of blocks to write
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmftlWrite(NVMFtlDriver* nvmftlp, uint32_t startblk,
+        const uint8_t* buffer, uint32_t n)
+{
+    osalDbgCheck(nvmftlp != NULL);
+    osalDbgAssert(nvmftlp->state == BLK_READY, "invalid state");
+    osalDbgAssert(startblk + n <= nvmftlp->blk_num, "invalid parameters");
+
+    nvmftlp->state = BLK_WRITING;
+
+    bool result = HAL_SUCCESS;
+
+    for (uint32_t i = 0; i < n && result == HAL_SUCCESS; ++i)
+    {
+        /* Keep one free sector for relocations. */
+        if (nvmftlp->active == NVM_FTL_NONE ||
+                nvmftlp->next_page >= nvmftlp->pages)
+        {
+            while (nvmftlp->free_num < 2)
+            {
+                const uint32_t victim = nvm_ftl_victim(nvmftlp);
+
+                if (victim == NVM_FTL_NONE)
+                {
+                    result = HAL_FAILED;
+                    break;
+                }
+                result = nvm_ftl_reclaim(nvmftlp, victim, false);
+                if (result != HAL_SUCCESS)
+                    break;
+            }
+            if (result != HAL_SUCCESS)
+                break;
+        }
+
+        result = nvm_ftl_program(nvmftlp, startblk + i,
+                buffer + i * nvmftlp->config->block_size, false);
+    }
+
+    nvmftlp->state = BLK_READY;
+
+    return result;
+}
+
+/**
+ * @brief   Discards blocks no longer holding data.
+ * @note    The map is only updated in memory, discarded blocks may return
+ *          their former data after connecting again.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ * @param[in] startblk      first block to discard
+ * @param[in] n             number of blocks to discard
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmftlDiscard(NVMFtlDriver* nvmftlp, uint32_t startblk, uint32_t n)
+{
+    osalDbgCheck(nvmftlp != NULL);
+    osalDbgAssert(nvmftlp->state == BLK_READY, "invalid state");
+    osalDbgAssert(startblk + n <= nvmftlp->blk_num, "invalid parameters");
+
+    for (uint32_t i = 0; i < n; ++i)
+        nvm_ftl_unmap(nvmftlp, startblk + i);
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Collects garbage and prepares free sectors.
+ * @details Reclaims sectors until @p free_num sectors are free, relocating
+ *          rarely changed data once wear leveling is due, then erases all
+ *          free sectors in advance. Intended to be invoked while the
+ *          device is idle to keep garbage collection out of writes.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ * @param[in] free_num      number of free sectors to aim for
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmftlGarbageCollect(NVMFtlDriver* nvmftlp, uint32_t free_num)
+{
+    osalDbgCheck(nvmftlp != NULL);
+    osalDbgAssert(nvmftlp->state == BLK_READY, "invalid state");
+
+    nvmftlp->state = BLK_WRITING;
+
+    bool result = HAL_SUCCESS;
+
+    while (result == HAL_SUCCESS && nvmftlp->free_num < free_num)
+    {
+        const uint32_t victim = nvm_ftl_victim(nvmftlp);
+
+        if (victim == NVM_FTL_NONE)
+            break;
+
+        result = nvm_ftl_reclaim(nvmftlp, victim, false);
+    }
+
+    /* Static wear leveling, limited to one sector per run. */
+    if (result == HAL_SUCCESS && nvmftlp->free_num >= 2)
+    {
+        const uint32_t cold = nvm_ftl_cold(nvmftlp);
+
+        if (cold != NVM_FTL_NONE)
+        {
+            nvmftlp->active = NVM_FTL_NONE;
+            result = nvm_ftl_reclaim(nvmftlp, cold, true);
+        }
+    }
+
+    for (uint32_t i = 0; i < nvmftlp->sector_num && result == HAL_SUCCESS; ++i)
+    {
+        if (nvmftlp->config->sectors[i].sequence == NVM_FTL_NONE &&
+                (nvmftlp->config->sectors[i].flags &
+                NVM_FTL_SECTOR_ERASED) == 0)
+            result = nvm_ftl_erase(nvmftlp, i);
+    }
+
+    nvmftlp->state = BLK_READY;
+
+    return result;
+}
+
+/**
+ * @brief   Waits for idle condition.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmftlSync(NVMFtlDriver* nvmftlp)
+{
+    osalDbgCheck(nvmftlp != NULL);
+    osalDbgAssert(nvmftlp->state == BLK_READY, "invalid state");
+
+    return nvmSync(nvmftlp->config->nvmp);
+}
+
+/**
+ * @brief   Returns media info.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ * @param[out] bdip         pointer to a @p BlockDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmftlGetInfo(NVMFtlDriver* nvmftlp, BlockDeviceInfo* bdip)
+{
+    osalDbgCheck((nvmftlp != NULL) && (bdip != NULL));
+    osalDbgAssert(nvmftlp->state >= BLK_ACTIVE, "invalid state");
+
+    bdip->blk_size = nvmftlp->config->block_size;
+    bdip->blk_num = nvmftlp->blk_num;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns if media is inserted.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ *
+ * @return                  The media presence status.
+ * @retval true             media is inserted.
+ * @retval false            media is not inserted.
+ *
+ * @api
+ */
+bool nvmftlIsInserted(NVMFtlDriver* nvmftlp)
+{
+    (void)nvmftlp;
+
+    /* Not supported by qio_nvm driver interface. Using a sensible default. */
+
+    return true;
+}
+
+/**
+ * @brief   Returns if media is write protected.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ *
+ * @return                  The media write protection status.
+ * @retval true             media is write protected.
+ * @retval false            media is not write protected.
+ *
+ * @api
+ */
+bool nvmftlIsProtected(NVMFtlDriver* nvmftlp)
+{
+    (void)nvmftlp;
+
+    /* Not supported by qio_nvm driver interface. Using a sensible default. */
+
+    return false;
+}
+
+/**
+ * @brief   Start accessing the media.
+ * @details Rebuilds the block map from the sector summaries.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmftlConnect(NVMFtlDriver* nvmftlp)
+{
+    osalDbgCheck(nvmftlp != NULL);
+    osalDbgAssert((nvmftlp->state == BLK_ACTIVE) ||
+            (nvmftlp->state == BLK_READY), "invalid state");
+
+    if (nvmftlp->state == BLK_READY)
+        return HAL_SUCCESS;
+
+    nvmftlp->state = BLK_CONNECTING;
+
+    if (nvm_ftl_mount(nvmftlp) != HAL_SUCCESS)
+    {
+        nvmftlp->state = BLK_ACTIVE;
+        return HAL_FAILED;
+    }
+
+    nvmftlp->state = BLK_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Stop accessing the media so it can be removed.
+ *
+ * @param[in] nvmftlp       pointer to the @p NVMFtlDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmftlDisconnect(NVMFtlDriver* nvmftlp)
+{
+    osalDbgCheck(nvmftlp != NULL);
+    osalDbgAssert((nvmftlp->state == BLK_ACTIVE) ||
+            (nvmftlp->state == BLK_READY), "invalid state");
+
+    if (nvmftlp->state == BLK_ACTIVE)
+        return HAL_SUCCESS;
+
+    bool result = nvmSync(nvmftlp->config->nvmp);
+
+    nvmftlp->state = BLK_ACTIVE;
+
+    return result;
+}
+
+#endif /* HAL_USE_NVM_FTL */
+
+/** @} */
@@ -22,6 +22,8 @@
 
 #include "qhal.h"
 
+#include <string.h>
+
 #if (HAL_USE_NVM_IOBLOCK == TRUE) || defined(__DOXYGEN__)
 
 /*===========================================================================*/
@@ -50,12 +52,71 @@ static const struct NVMIOBlockDriverVMT nvm_memory_vmt =
     .is_protected = (bool (*)(void *))nvmioblockIsProtected,
     .connect = (bool (*)(void *))nvmioblockConnect,
     .disconnect = (bool (*)(void *))nvmioblockDisconnect,
+    .discard = (bool (*)(void*, uint32_t, uint32_t))nvmioblockDiscard,
 };
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Sets or clears the discard bits of a range of blocks.
+ */
+static void nvm_ioblock_mark(NVMIOBlockDriver* nvmioblockp, uint32_t startblk,
+        uint32_t n, bool discarded)
+{
+    uint8_t* mapp = nvmioblockp->config->discard_map;
+
+    if (mapp == NULL)
+        return;
+
+    for (uint32_t blk = startblk; blk < startblk + n; ++blk)
+    {
+        if (discarded == true)
+            mapp[blk / 8] |= (uint8_t)(1 << (blk % 8));
+        else
+            mapp[blk / 8] &= (uint8_t)~(1 << (blk % 8));
+    }
+}
+
+/**
+ * @brief   Checks if all blocks of a range are discarded.
+ */
+static bool nvm_ioblock_is_discarded(NVMIOBlockDriver* nvmioblockp,
+        uint32_t startblk, uint32_t n)
+{
+    const uint8_t* mapp = nvmioblockp->config->discard_map;
+
+    if (mapp == NULL)
+        return false;
+
+    for (uint32_t blk = startblk; blk < startblk + n; ++blk)
+    {
+        if ((mapp[blk / 8] & (1 << (blk % 8))) == 0)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Erases a sector unless it is blank already.
+ */
+static bool nvm_ioblock_erase(NVMIOBlockDriver* nvmioblockp, uint32_t addr,
+        uint32_t n)
+{
+    bool erased;
+
+    if (nvmIsErased(nvmioblockp->config->nvmp, addr, n, &erased) !=
+            HAL_SUCCESS)
+        return HAL_FAILED;
+
+    if (erased == true)
+        return HAL_SUCCESS;
+
+    return nvmErase(nvmioblockp->config->nvmp, addr, n);
+}
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -100,6 +161,23 @@ void nvmioblockStart(NVMIOBlockDriver* nvmioblockp, const NVMIOBlockConfig* conf
             "invalid state");
 
     nvmioblockp->config = config;
+
+    if (config->discard_map != NULL)
+    {
+        NVMDeviceInfo nvmdi;
+        nvmGetInfo(config->nvmp, &nvmdi);
+
+        osalDbgAssert(nvmdi.sector_size % config->block_size == 0 ||
+                config->block_size % nvmdi.sector_size == 0,
+                "block size incompatible with sector size");
+
+        const uint32_t blk_num = nvmdi.sector_size * nvmdi.sector_num
+                / config->block_size;
+
+        /* Note: Blocks are considered in use until discarded. */
+        memset(config->discard_map, 0, (blk_num + 7) / 8);
+    }
+
     nvmioblockp->state = BLK_READY;
 }
 
@@ -179,6 +257,8 @@ bool nvmioblockWrite(NVMIOBlockDriver* nvmioblockp, uint32_t startblk,
 
     nvmioblockp->state = BLK_WRITING;
 
+    nvm_ioblock_mark(nvmioblockp, startblk, n, false);
+
     bool result = nvmWrite(nvmioblockp->config->nvmp,
             nvmioblockp->config->block_size * startblk,
             nvmioblockp->config->block_size * n,
@@ -189,6 +269,70 @@ bool nvmioblockWrite(NVMIOBlockDriver* nvmioblockp, uint32_t startblk,
     return result;
 }
 
+/**
+ * @brief   Discards blocks no longer holding data.
+ * @details Erases all sectors covered by the discarded blocks so later
+ *          writes to them program without an erase. Sectors covered in
+ *          parts are erased once all their blocks have been discarded,
+ *          if a @p discard_map is configured.
+ * @note    Discarded blocks read as erased afterwards only if their sector
+ *          got erased.
+ *
+ * @param[in] nvmioblockp   pointer to the @p NVMIOBlockDriver object
+ * @param[in] startblk      first block to discard
+ * @param[in] n             number of blocks to discard
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmioblockDiscard(NVMIOBlockDriver* nvmioblockp, uint32_t startblk,
+        uint32_t n)
+{
+    osalDbgCheck(nvmioblockp != NULL);
+    osalDbgAssert(nvmioblockp->state >= BLK_READY, "invalid state");
+
+    if (n == 0)
+        return HAL_SUCCESS;
+
+    if (nvmioblockSync(nvmioblockp) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    NVMDeviceInfo nvmdi;
+    if (nvmGetInfo(nvmioblockp->config->nvmp, &nvmdi) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvmioblockp->state = BLK_WRITING;
+
+    nvm_ioblock_mark(nvmioblockp, startblk, n, true);
+
+    const uint32_t block_size = nvmioblockp->config->block_size;
+    const uint32_t sector_size = nvmdi.sector_size;
+    const uint32_t startaddr = block_size * startblk;
+    const uint32_t endaddr = block_size * (startblk + n);
+    bool result = HAL_SUCCESS;
+
+    for (uint32_t addr = startaddr - startaddr % sector_size;
+            addr < endaddr; addr += sector_size)
+    {
+        /* Whole sector discarded now or together with earlier discards. */
+        if ((addr >= startaddr && addr + sector_size <= endaddr) ||
+                nvm_ioblock_is_discarded(nvmioblockp, addr / block_size,
+                        sector_size / block_size) == true)
+        {
+            result = nvm_ioblock_erase(nvmioblockp, addr, sector_size);
+            if (result != HAL_SUCCESS)
+                break;
+        }
+    }
+
+    nvmioblockp->state = BLK_READY;
+
+    return result;
+}
+
 /**
  * @brief   Waits for idle condition.
  *
@@ -63,6 +63,8 @@ static const struct NVMMemoryDriverVMT nvm_memory_vmt =
     .mass_writeprotect = (bool (*)(void*))nvmmemoryMassWriteProtect,
     .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmmemoryWriteUnprotect,
     .mass_writeunprotect = (bool (*)(void*))nvmmemoryMassWriteUnprotect,
+    .is_erased = (bool (*)(void*, uint32_t, uint32_t, bool*))nvmmemoryIsErased,
+    .map = (bool (*)(void*, uint32_t, uint32_t, const uint8_t**))nvmmemoryMap,
 };
 
 /*===========================================================================*/
@@ -332,6 +334,11 @@ bool nvmmemoryGetInfo(NVMMemoryDriver* nvmmemoryp, NVMDeviceInfo* nvmdip)
     nvmdip->identification[2] = 'M';
     /* Note: The virtual address room can be written byte wise */
     nvmdip->write_alignment = 0;
+    nvmdip->page_size = 0;
+    memset(nvmdip->erase_sizes, 0, sizeof(nvmdip->erase_sizes));
+    nvmdip->erase_sizes[0] = nvmmemoryp->config->sector_size;
+    memset(&nvmdip->timing, 0, sizeof(nvmdip->timing));
+    nvmdip->memory_mapped = true;
 
     return HAL_SUCCESS;
 }
@@ -468,6 +475,91 @@ bool nvmmemoryMassWriteUnprotect(NVMMemoryDriver* nvmmemoryp)
     return HAL_SUCCESS;
 }
 
+/**
+ * @brief   Checks whether a range is erased.
+ * @details Scans the memory word wise once the address is aligned.
+ *
+ * @param[in] nvmmemoryp    pointer to the @p NVMMemoryDriver object
+ * @param[in] startaddr     first address to check
+ * @param[in] n             number of bytes to check
+ * @param[out] erasedp      set to @p true if all bytes are erased
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmmemoryIsErased(NVMMemoryDriver* nvmmemoryp, uint32_t startaddr,
+        uint32_t n, bool* erasedp)
+{
+    osalDbgCheck((nvmmemoryp != NULL) && (erasedp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmmemoryp->state >= NVM_READY, "invalid state");
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= nvmmemoryp->config->sector_size * nvmmemoryp->config->sector_num),
+            "invalid parameters");
+
+    if (nvmmemorySync(nvmmemoryp) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    const uint8_t* p = nvmmemoryp->config->memoryp + startaddr;
+    const uint8_t* end = p + n;
+
+    *erasedp = false;
+
+    /* Leading bytes up to word alignment. */
+    while (p < end && ((uintptr_t)p % sizeof(uint32_t)) != 0)
+        if (*p++ != 0xff)
+            return HAL_SUCCESS;
+
+    /* Aligned words. */
+    while ((size_t)(end - p) >= sizeof(uint32_t))
+    {
+        if (*(const uint32_t*)p != 0xffffffff)
+            return HAL_SUCCESS;
+        p += sizeof(uint32_t);
+    }
+
+    /* Trailing bytes. */
+    while (p < end)
+        if (*p++ != 0xff)
+            return HAL_SUCCESS;
+
+    *erasedp = true;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Maps a range for direct reads.
+ *
+ * @param[in] nvmmemoryp    pointer to the @p NVMMemoryDriver object
+ * @param[in] startaddr     first address to map
+ * @param[in] n             number of bytes to map
+ * @param[out] ptrp         receives the address of @p startaddr
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmmemoryMap(NVMMemoryDriver* nvmmemoryp, uint32_t startaddr,
+        uint32_t n, const uint8_t** ptrp)
+{
+    osalDbgCheck((nvmmemoryp != NULL) && (ptrp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmmemoryp->state >= NVM_READY, "invalid state");
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= nvmmemoryp->config->sector_size * nvmmemoryp->config->sector_num),
+            "invalid parameters");
+
+    *ptrp = nvmmemoryp->config->memoryp + startaddr;
+
+    return HAL_SUCCESS;
+}
+
 #endif /* HAL_USE_NVM_MEMORY */
 
 /** @} */
@@ -42,16 +42,25 @@
  *          - dirty b
  *          - synced
  *          Mirror a and mirror b must be of the same size.
+ *          Mirror b can be placed on a separate device. In that case the
+ *          final sync of mirror b and the synced state are deferred to the
+ *          next operation, so mirror b programs while the caller continues.
+ *          Reads alternate between both devices while synced.
+ *          With background propagation enabled writes and erases return
+ *          once the state is dirty b and a dedicated thread updates mirror b
+ *          and sets the state to synced.
  *          The flow of operation is:
  *          Startup / Recovery rollback:
  *              - state synced:
  *                  Do nothing.
  *              - state dirty a:
- *                  Copy mirror b to mirror a erasing pages as required.
+ *                  Copy the sectors recorded as dirty from mirror b to
+ *                  mirror a erasing pages as required.
  *                  Set state to synced.
  *                  Execute sync of lower level driver.
  *              - state dirty b:
- *                  Copy mirror a to mirror b erasing pages as required.
+ *                  Copy the sectors recorded as dirty from mirror a to
+ *                  mirror b erasing pages as required.
  *                  Set state to synced.
  *                  Execute sync of lower level driver.
  *          Sync:
@@ -69,6 +78,8 @@
  *                  Invalid state!
  *          Write / Erase:
  *              - state synced:
+ *                  Affected sector range is being recorded.
+ *                  Execute sync of lower level driver.
  *                  State is being set to dirty a.
  *                  Execute sync of lower level driver.
  *                  Write(s) and / or erase(s) are being executed on mirror a.
@@ -81,6 +92,16 @@
  *                  Invalid state!
  *              - state dirty b:
  *                  Invalid state!
+ *          Transactions:
+ *              Writes and erases within a transaction stop after mirror a
+ *              has been updated and leave the state at dirty a. Commit
+ *              sets the state to dirty b, copies all sectors changed by
+ *              the transaction from mirror a to mirror b and sets the state
+ *              to synced.
+ *          Repair:
+ *              Copies sectors found to differ while synced from the intact
+ *              copy. The state is set to dirty for the damaged copy first,
+ *              so an interrupted repair is completed by the recovery.
  *
  * @todo    - add write protection pass-through to lower level driver
  *
@@ -103,6 +124,13 @@
  *          been filled. At that point the header is being erased and the first
  *          entry is being used.
  *          Also note that the chosen patterns assumes a little endian architecture.
+ *
+ *          Each dirty a state entry is preceded by a range entry holding the
+ *          first affected sector and the number of affected sectors in the
+ *          lower 32 bits and their complement in the upper 32 bits, so range
+ *          entries never match a state mark and interrupted writes of either
+ *          entry are detected. A state entry without a preceding range entry
+ *          or with a cleared (all zero) range entry covers the whole mirror.
  */
 static const uint64_t nvm_mirror_state_mark_table[] =
 {
@@ -114,6 +142,11 @@ static const uint64_t nvm_mirror_state_mark_table[] =
 STATIC_ASSERT(NELEMS(nvm_mirror_state_mark_table) == STATE_COUNT);
 STATIC_ASSERT(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
 
+/**
+ * @brief   Largest sector number representable by a range entry.
+ */
+#define NVM_MIRROR_RANGE_MAX            0xffff
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -141,12 +174,173 @@ static const struct NVMMirrorDriverVMT nvm_mirror_vmt =
     .mass_writeprotect = (bool (*)(void*))nvmmirrorMassWriteProtect,
     .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmmirrorWriteUnprotect,
     .mass_writeunprotect = (bool (*)(void*))nvmmirrorMassWriteUnprotect,
+    .readv = (bool (*)(void*, const NVMReadSegment*, uint32_t))nvmmirrorReadv,
+    .writev = (bool (*)(void*, const NVMWriteSegment*, uint32_t))nvmmirrorWritev,
+#if NVM_MIRROR_USE_RW_LOCK
+    .acquire_shared = (void (*)(void*))nvmmirrorAcquireBusShared,
+    .release_shared = (void (*)(void*))nvmmirrorReleaseBusShared,
+#endif /* NVM_MIRROR_USE_RW_LOCK */
 };
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+static bool nvm_mirror_state_is_synced(NVMMirrorDriver* nvmmirrorp)
+{
+#if NVM_MIRROR_USE_TRANSACTION
+    /* Mirror a is ahead of mirror b during transactions. */
+    if (nvmmirrorp->transaction == true)
+        return nvmmirrorp->mirror_state == STATE_SYNCED ||
+                nvmmirrorp->mirror_state == STATE_DIRTY_A;
+#endif /* NVM_MIRROR_USE_TRANSACTION */
+
+    /* Mirror a is valid while a separate mirror b device is still busy. */
+    if (nvmmirrorp->mirror_b_pending == true)
+        return nvmmirrorp->mirror_state == STATE_DIRTY_B;
+
+#if NVM_MIRROR_USE_ASYNC
+    /* Mirror a is valid while mirror b is being updated in background. */
+    if (nvmmirrorp->async_queued == true)
+        return nvmmirrorp->mirror_state == STATE_DIRTY_B ||
+                nvmmirrorp->mirror_state == STATE_SYNCED;
+#endif /* NVM_MIRROR_USE_ASYNC */
+
+    return nvmmirrorp->mirror_state == STATE_SYNCED;
+}
+
+static bool nvm_mirror_is_idle(NVMMirrorDriver* nvmmirrorp)
+{
+#if NVM_MIRROR_USE_TRANSACTION
+    if (nvmmirrorp->transaction == true)
+        return false;
+#endif /* NVM_MIRROR_USE_TRANSACTION */
+
+#if NVM_MIRROR_USE_ASYNC
+    if (nvmmirrorp->async_queued == true)
+        return false;
+#endif /* NVM_MIRROR_USE_ASYNC */
+
+    /* Both copies hold the same data. */
+    return nvmmirrorp->mirror_state == STATE_SYNCED &&
+            nvmmirrorp->mirror_b_pending == false;
+}
+
+static uint32_t nvm_mirror_sector_num(NVMMirrorDriver* nvmmirrorp)
+{
+    return nvmmirrorp->mirror_size / nvmmirrorp->llnvmdi.sector_size;
+}
+
+static void nvm_mirror_range_set_all(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    nvmmirrorp->mirror_dirty_first = 0;
+    nvmmirrorp->mirror_dirty_num = nvm_mirror_sector_num(nvmmirrorp);
+}
+
+static bool nvm_mirror_range_update(NVMMirrorDriver* nvmmirrorp,
+        uint32_t first, uint32_t num)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    if (nvmmirrorp->mirror_state != STATE_DIRTY_A)
+    {
+        /* Range is recorded along with the next dirty state entry. */
+        nvmmirrorp->mirror_dirty_first = first;
+        nvmmirrorp->mirror_dirty_num = num;
+        return HAL_SUCCESS;
+    }
+
+    /* Already dirty, recorded range has to cover this operation as well. */
+    if (first >= nvmmirrorp->mirror_dirty_first &&
+            first + num <= nvmmirrorp->mirror_dirty_first +
+                    nvmmirrorp->mirror_dirty_num)
+        return HAL_SUCCESS;
+
+    /* A partial range implies a range entry ahead of the state entry.
+     * Clearing it extends the range to the whole mirror. */
+    {
+        const uint64_t range_mark = 0;
+
+        bool result = nvmWrite(nvmmirrorp->config->nvmp,
+                nvmmirrorp->mirror_state_addr - sizeof(range_mark),
+                sizeof(range_mark), (uint8_t*)&range_mark);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        result = nvmSync(nvmmirrorp->config->nvmp);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    nvm_mirror_range_set_all(nvmmirrorp);
+
+    return HAL_SUCCESS;
+}
+
+static void nvm_mirror_range_get(NVMMirrorDriver* nvmmirrorp,
+        uint32_t startaddr, uint32_t n, uint32_t* firstp, uint32_t* nump)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    const uint32_t sector_size = nvmmirrorp->llnvmdi.sector_size;
+
+    *firstp = startaddr / sector_size;
+    *nump = 1;
+    if (n > 0)
+        *nump = (startaddr + n - 1) / sector_size - *firstp + 1;
+}
+
+#if NVM_MIRROR_USE_TRANSACTION || defined(__DOXYGEN__)
+static void nvm_mirror_transaction_add(NVMMirrorDriver* nvmmirrorp,
+        uint32_t first, uint32_t num)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    if (nvmmirrorp->transaction_num == 0)
+    {
+        nvmmirrorp->transaction_first = first;
+        nvmmirrorp->transaction_num = num;
+        return;
+    }
+
+    uint32_t end = nvmmirrorp->transaction_first + nvmmirrorp->transaction_num;
+    if (first + num > end)
+        end = first + num;
+    if (first < nvmmirrorp->transaction_first)
+        nvmmirrorp->transaction_first = first;
+    nvmmirrorp->transaction_num = end - nvmmirrorp->transaction_first;
+}
+#endif /* NVM_MIRROR_USE_TRANSACTION */
+
+static bool nvm_mirror_range_decode(NVMMirrorDriver* nvmmirrorp,
+        uint64_t range_mark, uint32_t* firstp, uint32_t* nump)
+{
+    const uint32_t range = (uint32_t)range_mark;
+
+    /* Cleared range entry covers the whole mirror. */
+    if (range_mark == 0)
+    {
+        *firstp = 0;
+        *nump = nvm_mirror_sector_num(nvmmirrorp);
+        return true;
+    }
+
+    if ((uint32_t)(range_mark >> 32) != (uint32_t)~range)
+        return false;
+
+    *firstp = range & NVM_MIRROR_RANGE_MAX;
+    *nump = range >> 16;
+
+    /* Reject ranges outside of the mirror. */
+    if (*nump == 0 ||
+            *firstp + *nump > nvm_mirror_sector_num(nvmmirrorp))
+        return false;
+
+    return true;
+}
+
 static bool nvm_mirror_state_init(NVMMirrorDriver* nvmmirrorp)
 {
     osalDbgCheck((nvmmirrorp != NULL));
@@ -157,6 +351,13 @@ static bool nvm_mirror_state_init(NVMMirrorDriver* nvmmirrorp)
     NVMMirrorState new_state = STATE_INVALID;
     uint32_t new_state_addr = 0;
 
+    /* Range recorded ahead of the current state entry. */
+    bool range_valid = false;
+    uint32_t range_first = 0;
+    uint32_t range_num = 0;
+
+    nvm_mirror_range_set_all(nvmmirrorp);
+
     uint64_t state_mark;
 
     for (uint32_t i = header_orig;
@@ -188,6 +389,17 @@ static bool nvm_mirror_state_init(NVMMirrorDriver* nvmmirrorp)
         else if (state_mark == nvm_mirror_state_mark_table[STATE_INVALID])
         {
             /* skip unused */
+            continue;
+        }
+        else if (nvm_mirror_range_decode(nvmmirrorp, state_mark,
+                &range_first, &range_num) == true)
+        {
+            /* Range for the following state entry. Both mirrors are still
+             * identical until that entry is written. */
+            new_state = STATE_SYNCED;
+            new_state_addr = i;
+            range_valid = true;
+            continue;
         }
         else
         {
@@ -196,6 +408,18 @@ static bool nvm_mirror_state_init(NVMMirrorDriver* nvmmirrorp)
             new_state_addr = 0;
             return HAL_SUCCESS;
         }
+
+        /* Use range recorded directly ahead of this state entry. */
+        if (range_valid == true)
+        {
+            nvmmirrorp->mirror_dirty_first = range_first;
+            nvmmirrorp->mirror_dirty_num = range_num;
+        }
+        else
+        {
+            nvm_mirror_range_set_all(nvmmirrorp);
+        }
+        range_valid = false;
     }
 
     nvmmirrorp->mirror_state = new_state;
@@ -218,12 +442,19 @@ static bool nvm_mirror_state_update(NVMMirrorDriver* nvmmirrorp,
     uint32_t new_state_addr = nvmmirrorp->mirror_state_addr;
     uint64_t new_state_mark = nvm_mirror_state_mark_table[new_state];
 
+    /* Entering dirty state records the affected sectors first. */
+    const bool range_write = (new_state == STATE_DIRTY_A &&
+            nvmmirrorp->mirror_dirty_first + nvmmirrorp->mirror_dirty_num <=
+                    NVM_MIRROR_RANGE_MAX);
+    const uint32_t entry_num = range_write ? 2 : 1;
+
     /* Advance state entry pointer if last state was synced */
     if (nvmmirrorp->mirror_state == STATE_SYNCED)
         new_state_addr += sizeof(new_state_mark);
 
     /* Erase header in case of wrap around or if its invalid. */
-    if (new_state_addr >= header_orig + header_size ||
+    if (new_state_addr + entry_num * sizeof(new_state_mark) >
+                    header_orig + header_size ||
             nvmmirrorp->mirror_state == STATE_INVALID)
     {
         new_state_addr = 0;
@@ -233,6 +464,26 @@ static bool nvm_mirror_state_update(NVMMirrorDriver* nvmmirrorp,
             return result;
     }
 
+    /* Write range entry. */
+    if (range_write == true)
+    {
+        const uint32_t range = nvmmirrorp->mirror_dirty_first |
+                (nvmmirrorp->mirror_dirty_num << 16);
+        const uint64_t range_mark = ((uint64_t)~range << 32) | range;
+
+        bool result = nvmWrite(nvmmirrorp->config->nvmp, new_state_addr,
+                sizeof(range_mark), (uint8_t*)&range_mark);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        /* Range has to be stored before the state entry. */
+        result = nvmSync(nvmmirrorp->config->nvmp);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        new_state_addr += sizeof(range_mark);
+    }
+
     /* Write updated state entry. */
     {
         bool result = nvmWrite(nvmmirrorp->config->nvmp, new_state_addr,
@@ -254,46 +505,316 @@ static bool nvm_mirror_state_update(NVMMirrorDriver* nvmmirrorp,
     return HAL_SUCCESS;
 }
 
-static bool nvm_mirror_copy(NVMMirrorDriver* nvmmirrorp, uint32_t src_addr,
-        uint32_t dst_addr, size_t n)
+static bool nvm_mirror_is_erased(const uint8_t* buffer, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        if (buffer[i] != 0xff)
+            return false;
+
+    return true;
+}
+
+static bool nvm_mirror_sector_compare(NVMMirrorDriver* nvmmirrorp,
+        BaseNVMDevice* srcp, uint32_t src_addr,
+        BaseNVMDevice* dstp, uint32_t dst_addr, size_t n, bool* equalp)
 {
     osalDbgCheck((nvmmirrorp != NULL));
 
-    uint64_t state_mark;
+    *equalp = false;
+
+    for (size_t offset = 0; offset < n; offset += NVM_MIRROR_COPY_BUFFER_SIZE)
+    {
+        const size_t chunk = (n - offset < NVM_MIRROR_COPY_BUFFER_SIZE) ?
+                n - offset : NVM_MIRROR_COPY_BUFFER_SIZE;
 
-    for (uint32_t offset = 0; offset < n; offset += sizeof(state_mark))
+        bool result = nvmRead(srcp, src_addr + offset,
+                chunk, nvmmirrorp->copy_src);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        result = nvmRead(dstp, dst_addr + offset,
+                chunk, nvmmirrorp->copy_dst);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        if (memcmp(nvmmirrorp->copy_src, nvmmirrorp->copy_dst, chunk) != 0)
+            return HAL_SUCCESS;
+    }
+
+    *equalp = true;
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_mirror_copy(NVMMirrorDriver* nvmmirrorp,
+        BaseNVMDevice* srcp, uint32_t src_addr,
+        BaseNVMDevice* dstp, uint32_t dst_addr, size_t n)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    const uint32_t sector_size = nvmmirrorp->llnvmdi.sector_size;
+
+    for (size_t sector = 0; sector < n; sector += sector_size)
     {
-        /* Detect start of a new sector and erase destination accordingly. */
-        if ((offset % nvmmirrorp->llnvmdi.sector_size) == 0)
+        const size_t sector_n = (n - sector < sector_size) ?
+                n - sector : sector_size;
+
+        /* Skip sectors which already match. */
         {
-            bool result = nvmErase(nvmmirrorp->config->nvmp,
-                    dst_addr + offset, nvmmirrorp->llnvmdi.sector_size);
+            bool equal;
+            bool result = nvm_mirror_sector_compare(nvmmirrorp,
+                    srcp, src_addr + sector, dstp, dst_addr + sector,
+                    sector_n, &equal);
             if (result != HAL_SUCCESS)
                 return result;
+            if (equal == true)
+                continue;
         }
 
-        /* Read mark into temporary buffer. */
+        /* Erase destination sector unless it is blank already. */
         {
-            bool result = nvmRead(nvmmirrorp->config->nvmp,
-                    src_addr + offset, sizeof(state_mark),
-                    (uint8_t*)&state_mark);
+            bool erased;
+            bool result = nvmIsErased(dstp, dst_addr + sector, sector_size,
+                    &erased);
             if (result != HAL_SUCCESS)
                 return result;
+            if (erased == false)
+            {
+                result = nvmErase(dstp, dst_addr + sector, sector_size);
+                if (result != HAL_SUCCESS)
+                    return result;
+            }
         }
 
-        /* Write mark to destination. */
+        for (size_t offset = sector; offset < sector + sector_n;
+                offset += NVM_MIRROR_COPY_BUFFER_SIZE)
         {
-            bool result = nvmWrite(nvmmirrorp->config->nvmp,
-                    dst_addr + offset, sizeof(state_mark),
-                    (uint8_t*)&state_mark);
-            if (result != HAL_SUCCESS)
-                return result;
+            const size_t chunk = (sector + sector_n - offset <
+                    NVM_MIRROR_COPY_BUFFER_SIZE) ?
+                    sector + sector_n - offset : NVM_MIRROR_COPY_BUFFER_SIZE;
+
+            /* Read source into temporary buffer. */
+            {
+                bool result = nvmRead(srcp, src_addr + offset, chunk,
+                        nvmmirrorp->copy_src);
+                if (result != HAL_SUCCESS)
+                    return result;
+            }
+
+            /* Erased data does not need programming. */
+            if (nvm_mirror_is_erased(nvmmirrorp->copy_src, chunk) == true)
+                continue;
+
+            /* Write buffer to destination. */
+            {
+                bool result = nvmWrite(dstp, dst_addr + offset, chunk,
+                        nvmmirrorp->copy_src);
+                if (result != HAL_SUCCESS)
+                    return result;
+            }
+        }
+    }
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_mirror_b_sync(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    /* Syncing the header device covers mirror b if they are the same. */
+    if (nvmmirrorp->mirror_b_nvmp == nvmmirrorp->config->nvmp)
+        return HAL_SUCCESS;
+
+    return nvmSync(nvmmirrorp->mirror_b_nvmp);
+}
+
+static bool nvm_mirror_b_complete(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    /* A separate mirror b device finishes in the background, synced state
+     * is set on the next operation. */
+    if (nvmmirrorp->mirror_b_nvmp != nvmmirrorp->config->nvmp)
+    {
+        nvmmirrorp->mirror_b_pending = true;
+        return HAL_SUCCESS;
+    }
+
+    return nvm_mirror_state_update(nvmmirrorp, STATE_SYNCED);
+}
+
+static bool nvm_mirror_b_flush(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    if (nvmmirrorp->mirror_b_pending == false)
+        return HAL_SUCCESS;
+
+    /* Mirror b has to be stored before the state changes to synced. */
+    bool result = nvm_mirror_b_sync(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    result = nvm_mirror_state_update(nvmmirrorp, STATE_SYNCED);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    nvmmirrorp->mirror_b_pending = false;
+
+    return HAL_SUCCESS;
+}
+
+static void nvm_mirror_read_select(NVMMirrorDriver* nvmmirrorp,
+        BaseNVMDevice** nvmpp, uint32_t* orgp)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    *nvmpp = nvmmirrorp->config->nvmp;
+    *orgp = nvmmirrorp->mirror_a_org;
+
+    /* Alternate between separate devices while both are idle and synced. */
+    if (nvmmirrorp->mirror_b_nvmp != nvmmirrorp->config->nvmp &&
+            nvmmirrorp->mirror_state == STATE_SYNCED)
+    {
+        if (nvmmirrorp->mirror_b_read == true)
+        {
+            *nvmpp = nvmmirrorp->mirror_b_nvmp;
+            *orgp = nvmmirrorp->mirror_b_org;
         }
+        nvmmirrorp->mirror_b_read = !nvmmirrorp->mirror_b_read;
+    }
+}
+
+static bool nvm_mirror_readv(NVMMirrorDriver* nvmmirrorp, BaseNVMDevice* nvmp,
+        uint32_t org, const NVMReadSegment* segp, uint32_t segn)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    NVMReadSegment batch[NVM_SEGMENT_BATCH_SIZE];
+
+    for (uint32_t i = 0; i < segn; i += NVM_SEGMENT_BATCH_SIZE)
+    {
+        uint32_t batch_n = segn - i;
+        if (batch_n > NVM_SEGMENT_BATCH_SIZE)
+            batch_n = NVM_SEGMENT_BATCH_SIZE;
+
+        for (uint32_t j = 0; j < batch_n; ++j)
+        {
+            batch[j] = segp[i + j];
+            batch[j].startaddr += org;
+        }
+
+        bool result = nvmReadv(nvmp, batch, batch_n);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+static bool nvm_mirror_writev(NVMMirrorDriver* nvmmirrorp, BaseNVMDevice* nvmp,
+        uint32_t org, const NVMWriteSegment* segp, uint32_t segn)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    NVMWriteSegment batch[NVM_SEGMENT_BATCH_SIZE];
+
+    for (uint32_t i = 0; i < segn; i += NVM_SEGMENT_BATCH_SIZE)
+    {
+        uint32_t batch_n = segn - i;
+        if (batch_n > NVM_SEGMENT_BATCH_SIZE)
+            batch_n = NVM_SEGMENT_BATCH_SIZE;
+
+        for (uint32_t j = 0; j < batch_n; ++j)
+        {
+            batch[j] = segp[i + j];
+            batch[j].startaddr += org;
+        }
+
+        bool result = nvmWritev(nvmp, batch, batch_n);
+        if (result != HAL_SUCCESS)
+            return result;
     }
 
     return HAL_SUCCESS;
 }
 
+#if NVM_MIRROR_USE_ASYNC || defined(__DOXYGEN__)
+static void nvm_mirror_async_worker(void* parameters)
+{
+    NVMMirrorDriver* nvmmirrorp = (NVMMirrorDriver*)parameters;
+
+    chRegSetThreadName("nvm_mirror_async");
+
+    while (true)
+    {
+        /* Nothing to do, going to sleep. */
+        osalSysLock();
+        while (nvmmirrorp->async_queued == false)
+            osalThreadSuspendS(&nvmmirrorp->async_wait);
+        osalSysUnlock();
+
+        bool result;
+        /* Apply queued operation to mirror b. */
+        if (nvmmirrorp->async_erase == true)
+            result = nvmErase(nvmmirrorp->mirror_b_nvmp,
+                    nvmmirrorp->mirror_b_org + nvmmirrorp->async_addr,
+                    nvmmirrorp->async_n);
+        else
+            result = nvmWrite(nvmmirrorp->mirror_b_nvmp,
+                    nvmmirrorp->mirror_b_org + nvmmirrorp->async_addr,
+                    nvmmirrorp->async_n, nvmmirrorp->async_buffer);
+
+        /* Advance state to synced. */
+        if (result == HAL_SUCCESS)
+            result = nvm_mirror_b_complete(nvmmirrorp);
+        if (result == HAL_SUCCESS)
+            result = nvm_mirror_b_flush(nvmmirrorp);
+
+        osalSysLock();
+        nvmmirrorp->async_result = result;
+        nvmmirrorp->async_queued = false;
+        osalThreadResumeS(&nvmmirrorp->async_done, MSG_OK);
+        osalOsRescheduleS();
+        osalSysUnlock();
+    }
+}
+
+static void nvm_mirror_async_queue(NVMMirrorDriver* nvmmirrorp, bool erase,
+        uint32_t startaddr, uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+    osalDbgAssert(nvmmirrorp->async_queued == false, "operation queued");
+
+    nvmmirrorp->async_erase = erase;
+    nvmmirrorp->async_addr = startaddr;
+    nvmmirrorp->async_n = n;
+    if (erase == false)
+        memcpy(nvmmirrorp->async_buffer, buffer, n);
+
+    osalSysLock();
+    nvmmirrorp->async_queued = true;
+    osalThreadResumeS(&nvmmirrorp->async_wait, MSG_OK);
+    osalOsRescheduleS();
+    osalSysUnlock();
+}
+
+static bool nvm_mirror_async_wait(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck((nvmmirrorp != NULL));
+
+    osalSysLock();
+    while (nvmmirrorp->async_queued == true)
+        osalThreadSuspendS(&nvmmirrorp->async_done);
+    bool result = nvmmirrorp->async_result;
+    nvmmirrorp->async_result = HAL_SUCCESS;
+    osalSysUnlock();
+
+    return result;
+}
+#endif /* NVM_MIRROR_USE_ASYNC */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -322,10 +843,41 @@ void nvmmirrorObjectInit(NVMMirrorDriver* nvmmirrorp)
     nvmmirrorp->state = NVM_STOP;
     nvmmirrorp->config = NULL;
 #if NVM_MIRROR_USE_MUTUAL_EXCLUSION
+#if NVM_MIRROR_USE_RW_LOCK
+    chRWLockObjectInit(&nvmmirrorp->lock);
+#else
     osalMutexObjectInit(&nvmmirrorp->mutex);
+#endif /* NVM_MIRROR_USE_RW_LOCK */
 #endif /* NVM_JEDEC_SPI_USE_MUTUAL_EXCLUSION */
     nvmmirrorp->mirror_state = STATE_INVALID;
     nvmmirrorp->mirror_state_addr = 0;
+    nvmmirrorp->mirror_dirty_first = 0;
+    nvmmirrorp->mirror_dirty_num = 0;
+    nvmmirrorp->mirror_b_nvmp = NULL;
+    nvmmirrorp->mirror_b_pending = false;
+    nvmmirrorp->mirror_b_read = false;
+#if NVM_MIRROR_USE_TRANSACTION
+    nvmmirrorp->transaction = false;
+    nvmmirrorp->transaction_first = 0;
+    nvmmirrorp->transaction_num = 0;
+#endif /* NVM_MIRROR_USE_TRANSACTION */
+#if NVM_MIRROR_USE_ASYNC
+    nvmmirrorp->async_tr = NULL;
+    nvmmirrorp->async_wait = NULL;
+    nvmmirrorp->async_done = NULL;
+    nvmmirrorp->async_queued = false;
+    nvmmirrorp->async_result = HAL_SUCCESS;
+
+    /* Filling the thread working area here because the function
+       @p chThdCreateI() does not do it.*/
+#if CH_DBG_FILL_THREADS
+    {
+        _thread_memfill((uint8_t*)THD_WORKING_AREA_BASE(nvmmirrorp->wa_async),
+            (uint8_t*)THD_WORKING_AREA_END(nvmmirrorp->wa_async),
+            CH_DBG_STACK_FILL_VALUE);
+    }
+#endif /* CH_DBG_FILL_THREADS */
+#endif /* NVM_MIRROR_USE_ASYNC */
 }
 
 /**
@@ -354,16 +906,48 @@ void nvmmirrorStart(NVMMirrorDriver* nvmmirrorp, const NVMMirrorConfig* config)
             nvmmirrorp->llnvmdi.sector_size * nvmmirrorp->config->sector_header_num;
     nvmmirrorp->mirror_b_org =
             nvmmirrorp->mirror_a_org + nvmmirrorp->mirror_size;
+    nvmmirrorp->mirror_b_nvmp = nvmmirrorp->config->nvmp;
+    nvmmirrorp->mirror_b_pending = false;
+    nvmmirrorp->mirror_b_read = false;
+
+    /* Mirror b on a separate device. */
+    if (nvmmirrorp->config->nvmp_b != NULL)
+    {
+        NVMDeviceInfo nvmdi_b;
+        nvmGetInfo(nvmmirrorp->config->nvmp_b, &nvmdi_b);
+        osalDbgAssert(nvmdi_b.sector_size == nvmmirrorp->llnvmdi.sector_size,
+                "sector size mismatch");
+
+        uint32_t sector_num = nvmmirrorp->llnvmdi.sector_num -
+                nvmmirrorp->config->sector_header_num;
+        if (nvmdi_b.sector_num < sector_num)
+            sector_num = nvmdi_b.sector_num;
+
+        nvmmirrorp->mirror_size = sector_num * nvmmirrorp->llnvmdi.sector_size;
+        nvmmirrorp->mirror_b_org = 0;
+        nvmmirrorp->mirror_b_nvmp = nvmmirrorp->config->nvmp_b;
+    }
 
     nvm_mirror_state_init(nvmmirrorp);
 
     {
+        /* Only sectors recorded as dirty can differ. */
+        uint32_t dirty_org = nvmmirrorp->mirror_dirty_first *
+                nvmmirrorp->llnvmdi.sector_size;
+        uint32_t dirty_size = nvmmirrorp->mirror_dirty_num *
+                nvmmirrorp->llnvmdi.sector_size;
+
         switch (nvmmirrorp->mirror_state)
         {
         case STATE_DIRTY_A:
-            /* Copy mirror b to mirror a erasing pages as required. */
-            if (nvm_mirror_copy(nvmmirrorp, nvmmirrorp->mirror_b_org,
-                    nvmmirrorp->mirror_a_org, nvmmirrorp->mirror_size) != HAL_SUCCESS)
+            /* Copy dirty sectors of mirror b to mirror a erasing pages as
+             * required. */
+            if (nvm_mirror_copy(nvmmirrorp,
+                    nvmmirrorp->mirror_b_nvmp,
+                    nvmmirrorp->mirror_b_org + dirty_org,
+                    nvmmirrorp->config->nvmp,
+                    nvmmirrorp->mirror_a_org + dirty_org,
+                    dirty_size) != HAL_SUCCESS)
                 return;
             /* Set state to synced. */
             if (nvm_mirror_state_update(nvmmirrorp, STATE_SYNCED) != HAL_SUCCESS)
@@ -374,10 +958,21 @@ void nvmmirrorStart(NVMMirrorDriver* nvmmirrorp, const NVMMirrorConfig* config)
             break;
         case STATE_INVALID:
             /* Invalid state (all header invalid) assumes mirror b to be dirty. */
+            dirty_org = 0;
+            dirty_size = nvmmirrorp->mirror_size;
+            /* Falls through. */
         case STATE_DIRTY_B:
-            /* Copy mirror a to mirror b erasing pages as required. */
-            if (nvm_mirror_copy(nvmmirrorp, nvmmirrorp->mirror_a_org,
-                    nvmmirrorp->mirror_b_org, nvmmirrorp->mirror_size) != HAL_SUCCESS)
+            /* Copy dirty sectors of mirror a to mirror b erasing pages as
+             * required. */
+            if (nvm_mirror_copy(nvmmirrorp,
+                    nvmmirrorp->config->nvmp,
+                    nvmmirrorp->mirror_a_org + dirty_org,
+                    nvmmirrorp->mirror_b_nvmp,
+                    nvmmirrorp->mirror_b_org + dirty_org,
+                    dirty_size) != HAL_SUCCESS)
+                return;
+            /* Mirror b has to be stored before the state changes. */
+            if (nvm_mirror_b_sync(nvmmirrorp) != HAL_SUCCESS)
                 return;
             /* Set state to synced. */
             if (nvm_mirror_state_update(nvmmirrorp, STATE_SYNCED) != HAL_SUCCESS)
@@ -392,6 +987,25 @@ void nvmmirrorStart(NVMMirrorDriver* nvmmirrorp, const NVMMirrorConfig* config)
         }
     }
 
+#if NVM_MIRROR_USE_ASYNC
+    /* Creates the propagation thread. Note, it is created only once.*/
+    osalSysLock();
+    if (nvmmirrorp->async_tr == NULL)
+    {
+        thread_descriptor_t async_descriptor = {
+          "nvm_mirror_async",
+          THD_WORKING_AREA_BASE(nvmmirrorp->wa_async),
+          THD_WORKING_AREA_END(nvmmirrorp->wa_async),
+          NVM_MIRROR_ASYNC_THREAD_PRIO,
+          nvm_mirror_async_worker,
+          (void*)nvmmirrorp
+        };
+        nvmmirrorp->async_tr = chThdCreateI(&async_descriptor);
+        osalOsRescheduleS();
+    }
+    osalSysUnlock();
+#endif /* NVM_MIRROR_USE_ASYNC */
+
     nvmmirrorp->state = NVM_READY;
 }
 
@@ -410,6 +1024,13 @@ void nvmmirrorStop(NVMMirrorDriver* nvmmirrorp)
             "invalid state");
     /* Verify mirror is in valid sync state. */
     osalDbgAssert(nvmmirrorp->mirror_state == STATE_SYNCED, "invalid mirror state");
+    osalDbgAssert(nvmmirrorp->mirror_b_pending == false, "mirror b not synced");
+#if NVM_MIRROR_USE_ASYNC
+    osalDbgAssert(nvmmirrorp->async_queued == false, "mirror b not synced");
+#endif /* NVM_MIRROR_USE_ASYNC */
+#if NVM_MIRROR_USE_TRANSACTION
+    osalDbgAssert(nvmmirrorp->transaction == false, "transaction in progress");
+#endif /* NVM_MIRROR_USE_TRANSACTION */
 
     nvmmirrorp->state = NVM_STOP;
 }
@@ -438,14 +1059,22 @@ bool nvmmirrorRead(NVMMirrorDriver* nvmmirrorp, uint32_t startaddr,
     osalDbgAssert(startaddr + n <= nvmmirrorp->mirror_size,
             "invalid parameters");
     /* Verify mirror is in valid sync state. */
-    osalDbgAssert(nvmmirrorp->mirror_state == STATE_SYNCED, "invalid mirror state");
+    osalDbgAssert(nvm_mirror_state_is_synced(nvmmirrorp), "invalid mirror state");
+
+#if NVM_MIRROR_USE_ASYNC
+    /* Lower level devices are in use until background operation is done. */
+    if (nvm_mirror_async_wait(nvmmirrorp) != HAL_SUCCESS)
+        return HAL_FAILED;
+#endif /* NVM_MIRROR_USE_ASYNC */
 
     /* Read operation in progress. */
     nvmmirrorp->state = NVM_READING;
 
-    bool result = nvmRead(nvmmirrorp->config->nvmp,
-            nvmmirrorp->mirror_a_org + startaddr,
-            n, buffer);
+    BaseNVMDevice* nvmp;
+    uint32_t org;
+    nvm_mirror_read_select(nvmmirrorp, &nvmp, &org);
+
+    bool result = nvmRead(nvmp, org + startaddr, n, buffer);
     if (result != HAL_SUCCESS)
         return result;
 
@@ -479,12 +1108,32 @@ bool nvmmirrorWrite(NVMMirrorDriver* nvmmirrorp, uint32_t startaddr,
     osalDbgAssert(startaddr + n <= nvmmirrorp->mirror_size,
             "invalid parameters");
     /* Verify mirror is in valid sync state. */
-    osalDbgAssert(nvmmirrorp->mirror_state == STATE_SYNCED, "invalid mirror state");
+    osalDbgAssert(nvm_mirror_state_is_synced(nvmmirrorp), "invalid mirror state");
 
     /* Write operation in progress. */
     nvmmirrorp->state = NVM_WRITING;
 
+    uint32_t first, num;
+    nvm_mirror_range_get(nvmmirrorp, startaddr, n, &first, &num);
+
     bool result;
+#if NVM_MIRROR_USE_ASYNC
+    /* Wait for background operation on mirror b. */
+    result = nvm_mirror_async_wait(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_MIRROR_USE_ASYNC */
+
+    /* Finish previous operation on mirror b. */
+    result = nvm_mirror_b_flush(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Record sectors affected by this operation. */
+    result = nvm_mirror_range_update(nvmmirrorp, first, num);
+    if (result != HAL_SUCCESS)
+        return result;
+
     /* Set state to mirror a dirty before changing contents. */
     result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_A);
     if (result != HAL_SUCCESS)
@@ -496,19 +1145,36 @@ bool nvmmirrorWrite(NVMMirrorDriver* nvmmirrorp, uint32_t startaddr,
     if (result != HAL_SUCCESS)
         return result;
 
+#if NVM_MIRROR_USE_TRANSACTION
+    /* Mirror b is updated on commit. */
+    if (nvmmirrorp->transaction == true)
+    {
+        nvm_mirror_transaction_add(nvmmirrorp, first, num);
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_MIRROR_USE_TRANSACTION */
     /* Advance state to mirror b dirty. */
     result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_B);
     if (result != HAL_SUCCESS)
         return result;
 
+#if NVM_MIRROR_USE_ASYNC
+    /* Apply write to mirror b in background. */
+    if (n <= NVM_MIRROR_ASYNC_BUFFER_SIZE)
+    {
+        nvm_mirror_async_queue(nvmmirrorp, false, startaddr, n, buffer);
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_MIRROR_USE_ASYNC */
+
     /* Apply write to mirror b. */
-    result = nvmWrite(nvmmirrorp->config->nvmp,
+    result = nvmWrite(nvmmirrorp->mirror_b_nvmp,
             nvmmirrorp->mirror_b_org + startaddr, n, buffer);
     if (result != HAL_SUCCESS)
         return result;
 
     /* Advance state to synced. */
-    result = nvm_mirror_state_update(nvmmirrorp, STATE_SYNCED);
+    result = nvm_mirror_b_complete(nvmmirrorp);
     if (result != HAL_SUCCESS)
         return result;
 
@@ -537,12 +1203,32 @@ bool nvmmirrorErase(NVMMirrorDriver* nvmmirrorp, uint32_t startaddr, uint32_t n)
     osalDbgAssert(startaddr + n <= nvmmirrorp->mirror_size,
             "invalid parameters");
     /* Verify mirror is in valid sync state. */
-    osalDbgAssert(nvmmirrorp->mirror_state == STATE_SYNCED, "invalid mirror state");
+    osalDbgAssert(nvm_mirror_state_is_synced(nvmmirrorp), "invalid mirror state");
 
     /* Erase operation in progress. */
     nvmmirrorp->state = NVM_ERASING;
 
+    uint32_t first, num;
+    nvm_mirror_range_get(nvmmirrorp, startaddr, n, &first, &num);
+
     bool result;
+#if NVM_MIRROR_USE_ASYNC
+    /* Wait for background operation on mirror b. */
+    result = nvm_mirror_async_wait(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_MIRROR_USE_ASYNC */
+
+    /* Finish previous operation on mirror b. */
+    result = nvm_mirror_b_flush(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Record sectors affected by this operation. */
+    result = nvm_mirror_range_update(nvmmirrorp, first, num);
+    if (result != HAL_SUCCESS)
+        return result;
+
     /* Set state to mirror a dirty before changing contents. */
     result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_A);
     if (result != HAL_SUCCESS)
@@ -554,23 +1240,37 @@ bool nvmmirrorErase(NVMMirrorDriver* nvmmirrorp, uint32_t startaddr, uint32_t n)
     if (result != HAL_SUCCESS)
         return result;
 
+#if NVM_MIRROR_USE_TRANSACTION
+    /* Mirror b is updated on commit. */
+    if (nvmmirrorp->transaction == true)
+    {
+        nvm_mirror_transaction_add(nvmmirrorp, first, num);
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_MIRROR_USE_TRANSACTION */
     /* Advance state to mirror b dirty. */
     result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_B);
     if (result != HAL_SUCCESS)
         return result;
 
+#if NVM_MIRROR_USE_ASYNC
+    /* Apply erase to mirror b in background. */
+    nvm_mirror_async_queue(nvmmirrorp, true, startaddr, n, NULL);
+    return HAL_SUCCESS;
+#else
     /* Apply erase to mirror b. */
-    result = nvmErase(nvmmirrorp->config->nvmp,
+    result = nvmErase(nvmmirrorp->mirror_b_nvmp,
             nvmmirrorp->mirror_b_org + startaddr, n);
     if (result != HAL_SUCCESS)
         return result;
 
     /* Advance state to synced. */
-    result = nvm_mirror_state_update(nvmmirrorp, STATE_SYNCED);
+    result = nvm_mirror_b_complete(nvmmirrorp);
     if (result != HAL_SUCCESS)
         return result;
 
     return HAL_SUCCESS;
+#endif /* NVM_MIRROR_USE_ASYNC */
 }
 
 /**
@@ -589,8 +1289,29 @@ bool nvmmirrorMassErase(NVMMirrorDriver* nvmmirrorp)
     osalDbgCheck(nvmmirrorp != NULL);
     /* Verify device status. */
     osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
+#if NVM_MIRROR_USE_ASYNC
+    /* Wait for background operation on mirror b. */
+    {
+        bool result = nvm_mirror_async_wait(nvmmirrorp);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+#endif /* NVM_MIRROR_USE_ASYNC */
+    /* Finish previous operation on mirror b. */
+    {
+        bool result = nvm_mirror_b_flush(nvmmirrorp);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
     /* Verify mirror is in valid sync state. */
     osalDbgAssert(nvmmirrorp->mirror_state != STATE_DIRTY_B, "invalid mirror state");
+    /* Record all sectors as affected. */
+    {
+        bool result = nvm_mirror_range_update(nvmmirrorp, 0,
+                nvm_mirror_sector_num(nvmmirrorp));
+        if (result != HAL_SUCCESS)
+            return result;
+    }
     /* Set mirror state to dirty if necessary. */
     if (nvmmirrorp->mirror_state == STATE_SYNCED)
     {
@@ -614,23 +1335,40 @@ bool nvmmirrorMassErase(NVMMirrorDriver* nvmmirrorp)
     if (result != HAL_SUCCESS)
         return result;
 
+#if NVM_MIRROR_USE_TRANSACTION
+    /* Mirror b is updated on commit. */
+    if (nvmmirrorp->transaction == true)
+    {
+        nvm_mirror_transaction_add(nvmmirrorp, 0,
+                nvm_mirror_sector_num(nvmmirrorp));
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_MIRROR_USE_TRANSACTION */
+
     /* Advance state to mirror b dirty. */
     result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_B);
     if (result != HAL_SUCCESS)
         return result;
 
+#if NVM_MIRROR_USE_ASYNC
+    /* Apply erase to mirror b in background. */
+    nvm_mirror_async_queue(nvmmirrorp, true, 0, nvmmirrorp->mirror_size,
+            NULL);
+    return HAL_SUCCESS;
+#else
     /* Apply erase to mirror b. */
-    result = nvmErase(nvmmirrorp->config->nvmp,
+    result = nvmErase(nvmmirrorp->mirror_b_nvmp,
             nvmmirrorp->mirror_b_org, nvmmirrorp->mirror_size);
     if (result != HAL_SUCCESS)
         return result;
 
     /* Advance state to synced. */
-    result = nvm_mirror_state_update(nvmmirrorp, STATE_SYNCED);
+    result = nvm_mirror_b_complete(nvmmirrorp);
     if (result != HAL_SUCCESS)
         return result;
 
     return HAL_SUCCESS;
+#endif /* NVM_MIRROR_USE_ASYNC */
 }
 
 /**
@@ -650,12 +1388,24 @@ bool nvmmirrorSync(NVMMirrorDriver* nvmmirrorp)
     /* Verify device status. */
     osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
     /* Verify mirror is in valid sync state. */
-    osalDbgAssert(nvmmirrorp->mirror_state == STATE_SYNCED, "invalid mirror state");
+    osalDbgAssert(nvm_mirror_state_is_synced(nvmmirrorp), "invalid mirror state");
 
     if (nvmmirrorp->state == NVM_READY)
         return HAL_SUCCESS;
 
-    bool result = nvmSync(nvmmirrorp->config->nvmp);
+    bool result;
+#if NVM_MIRROR_USE_ASYNC
+    /* Wait for background operation on mirror b. */
+    result = nvm_mirror_async_wait(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_MIRROR_USE_ASYNC */
+
+    result = nvm_mirror_b_flush(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    result = nvmSync(nvmmirrorp->config->nvmp);
     if (result != HAL_SUCCESS)
         return result;
 
@@ -665,6 +1415,296 @@ bool nvmmirrorSync(NVMMirrorDriver* nvmmirrorp)
     return HAL_SUCCESS;
 }
 
+#if NVM_MIRROR_USE_TRANSACTION || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a transaction.
+ * @details All following writes and erases are applied to mirror a only
+ *          under a single dirty state until @p nvmmirrorTransactionCommit()
+ *          updates mirror b. A power failure before the commit finished
+ *          rolls back all of them.
+ *
+ * @param[in] nvmmirrorp    pointer to the @p NVMMirrorDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmmirrorTransactionBegin(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck(nvmmirrorp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
+    osalDbgAssert(nvmmirrorp->transaction == false, "transaction in progress");
+
+    bool result;
+#if NVM_MIRROR_USE_ASYNC
+    /* Wait for background operation on mirror b. */
+    result = nvm_mirror_async_wait(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_MIRROR_USE_ASYNC */
+
+    /* Finish previous operation on mirror b. */
+    result = nvm_mirror_b_flush(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Verify mirror is in valid sync state. */
+    osalDbgAssert(nvmmirrorp->mirror_state == STATE_SYNCED, "invalid mirror state");
+
+    nvmmirrorp->transaction = true;
+    nvmmirrorp->transaction_first = 0;
+    nvmmirrorp->transaction_num = 0;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Applies all changes since @p nvmmirrorTransactionBegin() to
+ *          mirror b.
+ * @details Only the sectors changed by the transaction are copied.
+ *
+ * @param[in] nvmmirrorp    pointer to the @p NVMMirrorDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmmirrorTransactionCommit(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck(nvmmirrorp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
+    osalDbgAssert(nvmmirrorp->transaction == true, "no transaction");
+
+    if (nvmmirrorp->mirror_state == STATE_DIRTY_A)
+    {
+        const uint32_t org = nvmmirrorp->transaction_first *
+                nvmmirrorp->llnvmdi.sector_size;
+        const uint32_t size = nvmmirrorp->transaction_num *
+                nvmmirrorp->llnvmdi.sector_size;
+
+        /* Write operation in progress. */
+        nvmmirrorp->state = NVM_WRITING;
+
+        bool result;
+        /* Advance state to mirror b dirty. */
+        result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_B);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        /* Copy changed sectors of mirror a to mirror b. */
+        result = nvm_mirror_copy(nvmmirrorp,
+                nvmmirrorp->config->nvmp, nvmmirrorp->mirror_a_org + org,
+                nvmmirrorp->mirror_b_nvmp, nvmmirrorp->mirror_b_org + org,
+                size);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        /* Advance state to synced. */
+        result = nvm_mirror_b_complete(nvmmirrorp);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    nvmmirrorp->transaction = false;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Discards all changes since @p nvmmirrorTransactionBegin().
+ * @details Changed sectors of mirror a are restored from mirror b.
+ *
+ * @param[in] nvmmirrorp    pointer to the @p NVMMirrorDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmmirrorTransactionAbort(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck(nvmmirrorp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
+    osalDbgAssert(nvmmirrorp->transaction == true, "no transaction");
+
+    if (nvmmirrorp->mirror_state == STATE_DIRTY_A)
+    {
+        const uint32_t org = nvmmirrorp->transaction_first *
+                nvmmirrorp->llnvmdi.sector_size;
+        const uint32_t size = nvmmirrorp->transaction_num *
+                nvmmirrorp->llnvmdi.sector_size;
+
+        /* Write operation in progress. */
+        nvmmirrorp->state = NVM_WRITING;
+
+        bool result;
+        /* Copy changed sectors of mirror b to mirror a. */
+        result = nvm_mirror_copy(nvmmirrorp,
+                nvmmirrorp->mirror_b_nvmp, nvmmirrorp->mirror_b_org + org,
+                nvmmirrorp->config->nvmp, nvmmirrorp->mirror_a_org + org,
+                size);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        /* Set state to synced. */
+        result = nvm_mirror_state_update(nvmmirrorp, STATE_SYNCED);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    nvmmirrorp->transaction = false;
+
+    return HAL_SUCCESS;
+}
+#endif /* NVM_MIRROR_USE_TRANSACTION */
+
+/**
+ * @brief   Returns the location of one copy of the mirrored data.
+ * @details Allows checking both copies independently, e.g. by a scrubber
+ *          comparing their checksums. The copy is valid until the next
+ *          operation on the mirror, acquire the bus while using it.
+ * @note    Call @p nvmmirrorSync() first to finish pending updates.
+ *
+ * @param[in] nvmmirrorp    pointer to the @p NVMMirrorDriver object
+ * @param[in] mirror_b      @p true for mirror b, @p false for mirror a
+ * @param[out] nvmpp        receives the device holding the copy
+ * @param[out] orgp         receives the address of the copy on the device
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the copies may differ legitimately, e.g. while
+ *                          a transaction or an update is in progress.
+ *
+ * @api
+ */
+bool nvmmirrorGetCopy(NVMMirrorDriver* nvmmirrorp, bool mirror_b,
+        BaseNVMDevice** nvmpp, uint32_t* orgp)
+{
+    osalDbgCheck((nvmmirrorp != NULL) && (nvmpp != NULL) && (orgp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
+
+    if (nvmmirrorp->state != NVM_READY ||
+            nvm_mirror_is_idle(nvmmirrorp) == false)
+        return HAL_FAILED;
+
+    if (mirror_b == true)
+    {
+        *nvmpp = nvmmirrorp->mirror_b_nvmp;
+        *orgp = nvmmirrorp->mirror_b_org;
+    }
+    else
+    {
+        *nvmpp = nvmmirrorp->config->nvmp;
+        *orgp = nvmmirrorp->mirror_a_org;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Repairs a damaged copy from the other one.
+ * @details Sectors of the range differing between the copies are copied
+ *          from the intact copy. Which copy is intact has to be determined
+ *          by the caller, e.g. using checksums recorded while both matched.
+ *
+ * @param[in] nvmmirrorp    pointer to the @p NVMMirrorDriver object
+ * @param[in] startaddr     first address of the range, sector aligned
+ * @param[in] n             number of bytes of the range, sector aligned
+ * @param[in] from_b        @p true if mirror b is intact, @p false if
+ *                          mirror a is intact
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed or the copies may differ
+ *                          legitimately, see @p nvmmirrorGetCopy().
+ *
+ * @api
+ */
+bool nvmmirrorRepair(NVMMirrorDriver* nvmmirrorp, uint32_t startaddr,
+        uint32_t n, bool from_b)
+{
+    osalDbgCheck(nvmmirrorp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
+    /* Verify range is within mirror size and sector aligned. */
+    osalDbgAssert(startaddr + n <= nvmmirrorp->mirror_size &&
+            (startaddr % nvmmirrorp->llnvmdi.sector_size) == 0 &&
+            (n % nvmmirrorp->llnvmdi.sector_size) == 0,
+            "invalid parameters");
+
+    if (nvmmirrorp->state != NVM_READY ||
+            nvm_mirror_is_idle(nvmmirrorp) == false)
+        return HAL_FAILED;
+
+    if (n == 0)
+        return HAL_SUCCESS;
+
+    /* Write operation in progress. */
+    nvmmirrorp->state = NVM_WRITING;
+
+    bool result;
+    if (from_b == true)
+    {
+        uint32_t first, num;
+        nvm_mirror_range_get(nvmmirrorp, startaddr, n, &first, &num);
+
+        /* Record sectors affected by the repair. */
+        result = nvm_mirror_range_update(nvmmirrorp, first, num);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        /* Recovery copies mirror b to mirror a if interrupted. */
+        result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_A);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        result = nvm_mirror_copy(nvmmirrorp,
+                nvmmirrorp->mirror_b_nvmp, nvmmirrorp->mirror_b_org + startaddr,
+                nvmmirrorp->config->nvmp, nvmmirrorp->mirror_a_org + startaddr,
+                n);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+    else
+    {
+        /* Recovery copies mirror a to mirror b if interrupted. */
+        result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_B);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        result = nvm_mirror_copy(nvmmirrorp,
+                nvmmirrorp->config->nvmp, nvmmirrorp->mirror_a_org + startaddr,
+                nvmmirrorp->mirror_b_nvmp, nvmmirrorp->mirror_b_org + startaddr,
+                n);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        /* Mirror b has to be stored before the state changes. */
+        result = nvm_mirror_b_sync(nvmmirrorp);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    /* Set state to synced. */
+    result = nvm_mirror_state_update(nvmmirrorp, STATE_SYNCED);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Repair finished. */
+    nvmmirrorp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
 /**
  * @brief   Returns media info.
  *
@@ -683,14 +1723,10 @@ bool nvmmirrorGetInfo(NVMMirrorDriver* nvmmirrorp, NVMDeviceInfo* nvmdip)
     /* Verify device status. */
     osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
 
-    nvmdip->sector_num =
-            (nvmmirrorp->llnvmdi.sector_num - nvmmirrorp->config->sector_header_num) / 2;
-    nvmdip->sector_size =
-            nvmmirrorp->llnvmdi.sector_size;
-    memcpy(nvmdip->identification, nvmmirrorp->llnvmdi.identification,
-           sizeof(nvmdip->identification));
-    nvmdip->write_alignment =
-            nvmmirrorp->llnvmdi.write_alignment;
+    memcpy(nvmdip, &nvmmirrorp->llnvmdi, sizeof(*nvmdip));
+    nvmdip->sector_num = nvm_mirror_sector_num(nvmmirrorp);
+    /* Note: Addresses are remapped to either copy at runtime. */
+    nvmdip->memory_mapped = false;
 
     return HAL_SUCCESS;
 }
@@ -711,7 +1747,11 @@ void nvmmirrorAcquireBus(NVMMirrorDriver* nvmmirrorp)
     osalDbgCheck(nvmmirrorp != NULL);
 
 #if NVM_MIRROR_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if NVM_MIRROR_USE_RW_LOCK
+    chRWLockAcquire(&nvmmirrorp->lock);
+#else
     osalMutexLock(&nvmmirrorp->mutex);
+#endif /* NVM_MIRROR_USE_RW_LOCK */
 
     /* Lock the underlying device as well */
     nvmAcquire(nvmmirrorp->config->nvmp);
@@ -732,13 +1772,59 @@ void nvmmirrorReleaseBus(NVMMirrorDriver* nvmmirrorp)
     osalDbgCheck(nvmmirrorp != NULL);
 
 #if NVM_MIRROR_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if NVM_MIRROR_USE_RW_LOCK
+    chRWLockRelease(&nvmmirrorp->lock);
+#else
     osalMutexUnlock(&nvmmirrorp->mutex);
+#endif /* NVM_MIRROR_USE_RW_LOCK */
 
     /* Release the underlying device as well */
     nvmRelease(nvmmirrorp->config->nvmp);
 #endif /* NVM_MIRROR_USE_MUTUAL_EXCLUSION */
 }
 
+#if NVM_MIRROR_USE_RW_LOCK || defined(__DOXYGEN__)
+/**
+ * @brief   Gains shared access to the nvm device for reading.
+ * @details Other readers may use the device at the same time, writers are
+ *          queued. The underlying device is acquired for reading as well.
+ * @pre     In order to use this function the option
+ *          @p NVM_MIRROR_USE_RW_LOCK must be enabled.
+ *
+ * @param[in] nvmmirrorp    pointer to the @p NVMMirrorDriver object
+ *
+ * @api
+ */
+void nvmmirrorAcquireBusShared(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck(nvmmirrorp != NULL);
+
+    chRWLockAcquireShared(&nvmmirrorp->lock);
+
+    /* Lock the underlying device as well */
+    nvmAcquireShared(nvmmirrorp->config->nvmp);
+}
+
+/**
+ * @brief   Releases shared access to the nvm device.
+ * @pre     In order to use this function the option
+ *          @p NVM_MIRROR_USE_RW_LOCK must be enabled.
+ *
+ * @param[in] nvmmirrorp    pointer to the @p NVMMirrorDriver object
+ *
+ * @api
+ */
+void nvmmirrorReleaseBusShared(NVMMirrorDriver* nvmmirrorp)
+{
+    osalDbgCheck(nvmmirrorp != NULL);
+
+    chRWLockReleaseShared(&nvmmirrorp->lock);
+
+    /* Release the underlying device as well */
+    nvmReleaseShared(nvmmirrorp->config->nvmp);
+}
+#endif /* NVM_MIRROR_USE_RW_LOCK */
+
 /**
  * @brief   Write protects one or more sectors.
  *
@@ -833,6 +1919,163 @@ bool nvmmirrorMassWriteUnprotect(NVMMirrorDriver* nvmmirrorp)
     return HAL_SUCCESS;
 }
 
+/**
+ * @brief   Reads multiple segments.
+ *
+ * @param[in] nvmmirrorp    pointer to the @p NVMMirrorDriver object
+ * @param[in] segp          pointer to an array of @p NVMReadSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmmirrorReadv(NVMMirrorDriver* nvmmirrorp, const NVMReadSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmmirrorp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
+    /* Verify mirror is in valid sync state. */
+    osalDbgAssert(nvm_mirror_state_is_synced(nvmmirrorp), "invalid mirror state");
+
+    for (uint32_t i = 0; i < segn; ++i)
+    {
+        /* Verify range is within mirror size. */
+        osalDbgAssert(segp[i].startaddr + segp[i].n <= nvmmirrorp->mirror_size,
+                "invalid parameters");
+    }
+
+#if NVM_MIRROR_USE_ASYNC
+    /* Lower level devices are in use until background operation is done. */
+    if (nvm_mirror_async_wait(nvmmirrorp) != HAL_SUCCESS)
+        return HAL_FAILED;
+#endif /* NVM_MIRROR_USE_ASYNC */
+
+    /* Read operation in progress. */
+    nvmmirrorp->state = NVM_READING;
+
+    BaseNVMDevice* nvmp;
+    uint32_t org;
+    nvm_mirror_read_select(nvmmirrorp, &nvmp, &org);
+
+    bool result = nvm_mirror_readv(nvmmirrorp, nvmp, org, segp, segn);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Read operation finished. */
+    nvmmirrorp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes multiple segments.
+ * @details All segments are written to each mirror under a single state
+ *          change.
+ *
+ * @param[in] nvmmirrorp    pointer to the @p NVMMirrorDriver object
+ * @param[in] segp          pointer to an array of @p NVMWriteSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmmirrorWritev(NVMMirrorDriver* nvmmirrorp, const NVMWriteSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmmirrorp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmmirrorp->state >= NVM_READY, "invalid state");
+    /* Verify mirror is in valid sync state. */
+    osalDbgAssert(nvm_mirror_state_is_synced(nvmmirrorp), "invalid mirror state");
+
+    if (segn == 0)
+        return HAL_SUCCESS;
+
+    /* Sectors affected by all segments. */
+    uint32_t first = 0, last = 0;
+    for (uint32_t i = 0; i < segn; ++i)
+    {
+        /* Verify range is within mirror size. */
+        osalDbgAssert(segp[i].startaddr + segp[i].n <= nvmmirrorp->mirror_size,
+                "invalid parameters");
+
+        uint32_t seg_first, seg_num;
+        nvm_mirror_range_get(nvmmirrorp, segp[i].startaddr, segp[i].n,
+                &seg_first, &seg_num);
+        if (i == 0 || seg_first < first)
+            first = seg_first;
+        if (i == 0 || seg_first + seg_num - 1 > last)
+            last = seg_first + seg_num - 1;
+    }
+    const uint32_t num = last - first + 1;
+
+    /* Write operation in progress. */
+    nvmmirrorp->state = NVM_WRITING;
+
+    bool result;
+#if NVM_MIRROR_USE_ASYNC
+    /* Wait for background operation on mirror b. */
+    result = nvm_mirror_async_wait(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+#endif /* NVM_MIRROR_USE_ASYNC */
+
+    /* Finish previous operation on mirror b. */
+    result = nvm_mirror_b_flush(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Record sectors affected by this operation. */
+    result = nvm_mirror_range_update(nvmmirrorp, first, num);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Set state to mirror a dirty before changing contents. */
+    result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_A);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Apply writes to mirror a. */
+    result = nvm_mirror_writev(nvmmirrorp, nvmmirrorp->config->nvmp,
+            nvmmirrorp->mirror_a_org, segp, segn);
+    if (result != HAL_SUCCESS)
+        return result;
+
+#if NVM_MIRROR_USE_TRANSACTION
+    /* Mirror b is updated on commit. */
+    if (nvmmirrorp->transaction == true)
+    {
+        nvm_mirror_transaction_add(nvmmirrorp, first, num);
+        return HAL_SUCCESS;
+    }
+#endif /* NVM_MIRROR_USE_TRANSACTION */
+
+    /* Advance state to mirror b dirty. */
+    result = nvm_mirror_state_update(nvmmirrorp, STATE_DIRTY_B);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Apply writes to mirror b. */
+    result = nvm_mirror_writev(nvmmirrorp, nvmmirrorp->mirror_b_nvmp,
+            nvmmirrorp->mirror_b_org, segp, segn);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Advance state to synced. */
+    result = nvm_mirror_b_complete(nvmmirrorp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    return HAL_SUCCESS;
+}
+
 #endif /* HAL_USE_NVM_MIRROR */
 
 /** @} */
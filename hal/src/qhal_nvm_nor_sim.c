@@ -0,0 +1,618 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_nor_sim.c
+ * @brief   NVM simulated NOR flash driver code.
+ *
+ * @addtogroup NVM_NOR_SIM
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_NOR_SIM || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          Emulates a NOR flash in a memory block. Writes can only clear
+ *          bits and are split into page programs, erases set whole sectors
+ *          to 0xff. Every operation is charged against a virtual time
+ *          using the configured latencies, which allows judging the cost
+ *          of upper layers without real hardware.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMNorSimDriverVMT nvm_nor_sim_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmnorsimRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmnorsimWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmnorsimErase,
+    .mass_erase = (bool (*)(void*))nvmnorsimMassErase,
+    .sync = (bool (*)(void*))nvmnorsimSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmnorsimGetInfo,
+    .acquire = (void (*)(void*))nvmnorsimAcquireBus,
+    .release = (void (*)(void*))nvmnorsimReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmnorsimWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmnorsimMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmnorsimWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmnorsimMassWriteUnprotect,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static void nvm_nor_sim_charge(NVMNorSimDriver* nvmnorsimp, uint64_t ns)
+{
+    nvmnorsimp->time_ns += ns;
+    nvmnorsimp->stats.time_ns += ns;
+
+    if (!nvmnorsimp->config->sleep)
+        return;
+
+    /* Sleeps whole ticks, the remainder is carried over. */
+    nvmnorsimp->sleep_ns += ns;
+
+    uint64_t ticks = nvmnorsimp->sleep_ns * OSAL_ST_FREQUENCY / 1000000000U;
+    if (ticks > 0)
+    {
+        nvmnorsimp->sleep_ns -= ticks * 1000000000U / OSAL_ST_FREQUENCY;
+        osalThreadSleep((sysinterval_t)ticks);
+    }
+}
+
+static void nvm_nor_sim_erase_sector(NVMNorSimDriver* nvmnorsimp,
+        uint32_t sector)
+{
+    const NVMNorSimConfig* cfgp = nvmnorsimp->config;
+
+    memset(cfgp->memoryp + sector * cfgp->sector_size, 0xff,
+            cfgp->sector_size);
+
+    if (cfgp->erase_counters != NULL)
+        ++cfgp->erase_counters[sector];
+
+    ++nvmnorsimp->stats.sector_erases;
+    nvm_nor_sim_charge(nvmnorsimp, cfgp->sector_erase_ns);
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated NOR flash driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmnorsimInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmnorsimp   pointer to the @p NVMNorSimDriver object
+ *
+ * @init
+ */
+void nvmnorsimObjectInit(NVMNorSimDriver* nvmnorsimp)
+{
+    nvmnorsimp->vmt = &nvm_nor_sim_vmt;
+    nvmnorsimp->state = NVM_STOP;
+    nvmnorsimp->config = NULL;
+    nvmnorsimp->time_ns = 0;
+    nvmnorsimp->sleep_ns = 0;
+    memset(&nvmnorsimp->stats, 0, sizeof(nvmnorsimp->stats));
+#if NVM_NOR_SIM_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&nvmnorsimp->mutex);
+#endif /* NVM_NOR_SIM_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the simulated NOR flash.
+ * @details The memory block keeps its contents, it is not erased.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ * @param[in] config        pointer to the @p NVMNorSimConfig object.
+ *
+ * @api
+ */
+void nvmnorsimStart(NVMNorSimDriver* nvmnorsimp, const NVMNorSimConfig* config)
+{
+    osalDbgCheck((nvmnorsimp != NULL) && (config != NULL));
+    osalDbgCheck((config->memoryp != NULL) && (config->page_size > 0) &&
+            (config->sector_size % config->page_size) == 0);
+    osalDbgCheck(config->write_alignment == 0 ||
+            (config->page_size % config->write_alignment) == 0);
+    /* Verify device status. */
+    osalDbgAssert((nvmnorsimp->state == NVM_STOP) || (nvmnorsimp->state == NVM_READY),
+            "invalid state");
+
+    nvmnorsimp->config = config;
+    nvmnorsimp->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the simulated NOR flash.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ *
+ * @api
+ */
+void nvmnorsimStop(NVMNorSimDriver* nvmnorsimp)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmnorsimp->state == NVM_STOP) || (nvmnorsimp->state == NVM_READY),
+            "invalid state");
+
+    nvmnorsimp->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimRead(NVMNorSimDriver* nvmnorsimp, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= nvmnorsimp->config->sector_size * nvmnorsimp->config->sector_num),
+            "invalid parameters");
+
+    /* Read operation in progress. */
+    nvmnorsimp->state = NVM_READING;
+
+    memcpy(buffer, nvmnorsimp->config->memoryp + startaddr, n);
+
+    ++nvmnorsimp->stats.reads;
+    nvmnorsimp->stats.bytes_read += n;
+    nvm_nor_sim_charge(nvmnorsimp,
+            (uint64_t)n * nvmnorsimp->config->read_byte_ns);
+
+    /* Read operation finished. */
+    nvmnorsimp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes data crossing sector boundaries if required.
+ * @details Bits can only be cleared. In strict mode a write trying to set
+ *          a programmed bit fails before anything is programmed, otherwise
+ *          the data is ANDed like a real device does.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimWrite(NVMNorSimDriver* nvmnorsimp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+
+    const NVMNorSimConfig* cfgp = nvmnorsimp->config;
+
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= cfgp->sector_size * cfgp->sector_num),
+            "invalid parameters");
+    /* Verify write alignment. */
+    osalDbgAssert(cfgp->write_alignment == 0 ||
+            ((startaddr % cfgp->write_alignment) == 0 &&
+            (n % cfgp->write_alignment) == 0),
+            "invalid alignment");
+
+    uint8_t* dst = cfgp->memoryp + startaddr;
+
+    /* Check for bits being set. */
+    uint32_t i;
+    for (i = 0; i < n; ++i)
+        if ((dst[i] & buffer[i]) != buffer[i])
+            break;
+    if (i < n)
+    {
+        ++nvmnorsimp->stats.violations;
+        if (cfgp->strict == true)
+            return HAL_FAILED;
+    }
+
+    /* Write operation in progress. */
+    nvmnorsimp->state = NVM_WRITING;
+
+    uint32_t written = 0;
+
+    while (written < n)
+    {
+        uint32_t n_chunk =
+                cfgp->page_size - ((startaddr + written) % cfgp->page_size);
+        if (n_chunk > n - written)
+            n_chunk = n - written;
+
+        for (uint32_t j = 0; j < n_chunk; ++j)
+            dst[written + j] &= buffer[written + j];
+
+        ++nvmnorsimp->stats.page_programs;
+        nvmnorsimp->stats.bytes_programmed += n_chunk;
+        nvm_nor_sim_charge(nvmnorsimp, cfgp->page_program_ns);
+
+        written += n_chunk;
+    }
+
+    /* Write operation finished. */
+    nvmnorsimp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ * @param[in] startaddr     address within to be erased sector
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimErase(NVMNorSimDriver* nvmnorsimp, uint32_t startaddr,
+        uint32_t n)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+
+    const NVMNorSimConfig* cfgp = nvmnorsimp->config;
+
+    /* Verify range is within chip size. */
+    osalDbgAssert((startaddr + n <= cfgp->sector_size * cfgp->sector_num),
+            "invalid parameters");
+
+    if (n == 0)
+        return HAL_SUCCESS;
+
+    /* Erase operation in progress. */
+    nvmnorsimp->state = NVM_ERASING;
+
+    const uint32_t first = startaddr / cfgp->sector_size;
+    const uint32_t last = (startaddr + n - 1) / cfgp->sector_size;
+
+    for (uint32_t sector = first; sector <= last; ++sector)
+        nvm_nor_sim_erase_sector(nvmnorsimp, sector);
+
+    /* Erase operation finished. */
+    nvmnorsimp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases whole chip.
+ * @details Charged like erasing all sectors one by one.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimMassErase(NVMNorSimDriver* nvmnorsimp)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+
+    /* Erase operation in progress. */
+    nvmnorsimp->state = NVM_ERASING;
+
+    for (uint32_t sector = 0; sector < nvmnorsimp->config->sector_num;
+            ++sector)
+        nvm_nor_sim_erase_sector(nvmnorsimp, sector);
+
+    /* Erase operation finished. */
+    nvmnorsimp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Waits for idle condition.
+ * @note    Operations complete immediately in virtual time.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimSync(NVMNorSimDriver* nvmnorsimp)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns media info.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimGetInfo(NVMNorSimDriver* nvmnorsimp, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+
+    nvmdip->sector_num = nvmnorsimp->config->sector_num;
+    nvmdip->sector_size = nvmnorsimp->config->sector_size;
+    nvmdip->identification[0] = 'N';
+    nvmdip->identification[1] = 'O';
+    nvmdip->identification[2] = 'R';
+    nvmdip->write_alignment = nvmnorsimp->config->write_alignment;
+    nvmdip->page_size = nvmnorsimp->config->page_size;
+    memset(nvmdip->erase_sizes, 0, sizeof(nvmdip->erase_sizes));
+    nvmdip->erase_sizes[0] = nvmnorsimp->config->sector_size;
+    /* The simulation is deterministic, typical equals maximum. */
+    nvmdip->timing.program_typ = nvmnorsimp->config->page_program_ns / 1000;
+    nvmdip->timing.program_max = nvmdip->timing.program_typ;
+    nvmdip->timing.erase_typ = nvmnorsimp->config->sector_erase_ns / 1000;
+    nvmdip->timing.erase_max = nvmdip->timing.erase_typ;
+    nvmdip->memory_mapped = false;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Gains exclusive access to the nvm device.
+ * @details This function tries to gain ownership to the nvm device, if the
+ *          device is already being used then the invoking thread is queued.
+ * @pre     In order to use this function the option
+ *          @p NVM_NOR_SIM_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ *
+ * @api
+ */
+void nvmnorsimAcquireBus(NVMNorSimDriver* nvmnorsimp)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+
+#if NVM_NOR_SIM_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&nvmnorsimp->mutex);
+#endif /* NVM_NOR_SIM_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the nvm device.
+ * @pre     In order to use this function the option
+ *          @p NVM_NOR_SIM_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ *
+ * @api
+ */
+void nvmnorsimReleaseBus(NVMNorSimDriver* nvmnorsimp)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+
+#if NVM_NOR_SIM_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&nvmnorsimp->mutex);
+#endif /* NVM_NOR_SIM_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Write protects one or more sectors.
+ * @note    Protection is not simulated.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ * @param[in] startaddr     address within to be protected sector
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimWriteProtect(NVMNorSimDriver* nvmnorsimp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+
+    (void)startaddr;
+    (void)n;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Write protects the whole device.
+ * @note    Protection is not simulated.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimMassWriteProtect(NVMNorSimDriver* nvmnorsimp)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Write unprotects one or more sectors.
+ * @note    Protection is not simulated.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ * @param[in] startaddr     address within to be unprotected sector
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimWriteUnprotect(NVMNorSimDriver* nvmnorsimp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+
+    (void)startaddr;
+    (void)n;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ * @note    Protection is not simulated.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmnorsimMassWriteUnprotect(NVMNorSimDriver* nvmnorsimp)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmnorsimp->state >= NVM_READY, "invalid state");
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns the statistics.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ * @param[out] statsp       pointer to a @p NVMNorSimStats structure
+ *
+ * @api
+ */
+void nvmnorsimGetStats(NVMNorSimDriver* nvmnorsimp, NVMNorSimStats* statsp)
+{
+    osalDbgCheck((nvmnorsimp != NULL) && (statsp != NULL));
+
+    *statsp = nvmnorsimp->stats;
+}
+
+/**
+ * @brief   Resets the statistics.
+ * @note    Neither the virtual time nor the erase counters are reset.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ *
+ * @api
+ */
+void nvmnorsimResetStats(NVMNorSimDriver* nvmnorsimp)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+
+    memset(&nvmnorsimp->stats, 0, sizeof(nvmnorsimp->stats));
+}
+
+/**
+ * @brief   Returns the virtual time.
+ * @details The time increases by the latency of each operation and can be
+ *          used as clock when benchmarking upper layers.
+ *
+ * @param[in] nvmnorsimp    pointer to the @p NVMNorSimDriver object
+ *
+ * @return                  The virtual time since initialization in ns.
+ *
+ * @api
+ */
+uint64_t nvmnorsimGetTime(NVMNorSimDriver* nvmnorsimp)
+{
+    osalDbgCheck(nvmnorsimp != NULL);
+
+    return nvmnorsimp->time_ns;
+}
+
+#endif /* HAL_USE_NVM_NOR_SIM */
+
+/** @} */
@@ -59,6 +59,14 @@ static const struct NVMPartitionDriverVMT nvm_partition_vmt =
     .mass_writeprotect = (bool (*)(void*))nvmpartMassWriteProtect,
     .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmpartWriteUnprotect,
     .mass_writeunprotect = (bool (*)(void*))nvmpartMassWriteUnprotect,
+    .readv = (bool (*)(void*, const NVMReadSegment*, uint32_t))nvmpartReadv,
+    .writev = (bool (*)(void*, const NVMWriteSegment*, uint32_t))nvmpartWritev,
+    .is_erased = (bool (*)(void*, uint32_t, uint32_t, bool*))nvmpartIsErased,
+    .map = (bool (*)(void*, uint32_t, uint32_t, const uint8_t**))nvmpartMap,
+#if NVM_PARTITION_USE_RW_LOCK
+    .acquire_shared = (void (*)(void*))nvmpartAcquireBusShared,
+    .release_shared = (void (*)(void*))nvmpartReleaseBusShared,
+#endif /* NVM_PARTITION_USE_RW_LOCK */
 };
 
 /*===========================================================================*/
@@ -93,7 +101,11 @@ void nvmpartObjectInit(NVMPartitionDriver* nvmpartp)
     nvmpartp->state = NVM_STOP;
     nvmpartp->config = NULL;
 #if NVM_PARTITION_USE_MUTUAL_EXCLUSION
+#if NVM_PARTITION_USE_RW_LOCK
+    chRWLockObjectInit(&nvmpartp->lock);
+#else
     osalMutexObjectInit(&nvmpartp->mutex);
+#endif /* NVM_PARTITION_USE_RW_LOCK */
 #endif /* NVM_PARTITION_USE_MUTUAL_EXCLUSION */
 }
 
@@ -166,7 +178,7 @@ bool nvmpartRead(NVMPartitionDriver* nvmpartp, uint32_t startaddr,
     /* Read operation in progress. */
     nvmpartp->state = NVM_READING;
 
-    bool result = nvmRead(nvmpartp->config->nvmp,
+    bool result = nvmLldRead(NVM_PARTITION_LLD, nvmpartp->config->nvmp,
             nvmpartp->part_org + startaddr,
             n, buffer);
     if (result != HAL_SUCCESS)
@@ -204,7 +216,7 @@ bool nvmpartWrite(NVMPartitionDriver* nvmpartp, uint32_t startaddr,
     /* Write operation in progress. */
     nvmpartp->state = NVM_WRITING;
 
-    return nvmWrite(nvmpartp->config->nvmp,
+    return nvmLldWrite(NVM_PARTITION_LLD, nvmpartp->config->nvmp,
             nvmpartp->part_org + startaddr,
             n, buffer);
 }
@@ -234,7 +246,7 @@ bool nvmpartErase(NVMPartitionDriver* nvmpartp, uint32_t startaddr,
     /* Erase operation in progress. */
     nvmpartp->state = NVM_ERASING;
 
-    return nvmErase(nvmpartp->config->nvmp,
+    return nvmLldErase(NVM_PARTITION_LLD, nvmpartp->config->nvmp,
             nvmpartp->part_org + startaddr,
             n);
 }
@@ -259,7 +271,7 @@ bool nvmpartMassErase(NVMPartitionDriver* nvmpartp)
     /* Erase operation in progress. */
     nvmpartp->state = NVM_ERASING;
 
-    return nvmErase(nvmpartp->config->nvmp,
+    return nvmLldErase(NVM_PARTITION_LLD, nvmpartp->config->nvmp,
             nvmpartp->part_org,
             nvmpartp->part_size);
 }
@@ -284,7 +296,7 @@ bool nvmpartSync(NVMPartitionDriver* nvmpartp)
     if (nvmpartp->state == NVM_READY)
         return HAL_SUCCESS;
 
-    bool result = nvmSync(nvmpartp->config->nvmp);
+    bool result = nvmLldSync(NVM_PARTITION_LLD, nvmpartp->config->nvmp);
     if (result != HAL_SUCCESS)
         return result;
 
@@ -312,12 +324,8 @@ bool nvmpartGetInfo(NVMPartitionDriver* nvmpartp, NVMDeviceInfo* nvmdip)
     /* Verify device status. */
     osalDbgAssert(nvmpartp->state >= NVM_READY, "invalid state");
 
+    memcpy(nvmdip, &nvmpartp->llnvmdi, sizeof(*nvmdip));
     nvmdip->sector_num = nvmpartp->config->sector_num;
-    nvmdip->sector_size = nvmpartp->llnvmdi.sector_size;
-    memcpy(nvmdip->identification, nvmpartp->llnvmdi.identification,
-            sizeof(nvmdip->identification));
-    nvmdip->write_alignment =
-            nvmpartp->llnvmdi.write_alignment;
 
     return HAL_SUCCESS;
 }
@@ -339,7 +347,11 @@ void nvmpartAcquireBus(NVMPartitionDriver* nvmpartp)
     osalDbgCheck(nvmpartp != NULL);
 
 #if NVM_PARTITION_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if NVM_PARTITION_USE_RW_LOCK
+    chRWLockAcquire(&nvmpartp->lock);
+#else
     osalMutexLock(&nvmpartp->mutex);
+#endif /* NVM_PARTITION_USE_RW_LOCK */
 
     /* Lock the underlying device as well. */
     nvmAcquire(nvmpartp->config->nvmp);
@@ -360,13 +372,59 @@ void nvmpartReleaseBus(NVMPartitionDriver* nvmpartp)
     osalDbgCheck(nvmpartp != NULL);
 
 #if NVM_PARTITION_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if NVM_PARTITION_USE_RW_LOCK
+    chRWLockRelease(&nvmpartp->lock);
+#else
     osalMutexUnlock(&nvmpartp->mutex);
+#endif /* NVM_PARTITION_USE_RW_LOCK */
 
     /* Release the underlying device as well. */
     nvmRelease(nvmpartp->config->nvmp);
 #endif /* NVM_PARTITION_USE_MUTUAL_EXCLUSION */
 }
 
+#if NVM_PARTITION_USE_RW_LOCK || defined(__DOXYGEN__)
+/**
+ * @brief   Gains shared access to the nvm partition device for reading.
+ * @details Other readers may use the device at the same time, writers are
+ *          queued. The underlying device is acquired for reading as well.
+ * @pre     In order to use this function the option
+ *          @p NVM_PARTITION_USE_RW_LOCK must be enabled.
+ *
+ * @param[in] nvmpartp      pointer to the @p NVMPartitionDriver object
+ *
+ * @api
+ */
+void nvmpartAcquireBusShared(NVMPartitionDriver* nvmpartp)
+{
+    osalDbgCheck(nvmpartp != NULL);
+
+    chRWLockAcquireShared(&nvmpartp->lock);
+
+    /* Lock the underlying device as well. */
+    nvmAcquireShared(nvmpartp->config->nvmp);
+}
+
+/**
+ * @brief   Releases shared access to the nvm partition device.
+ * @pre     In order to use this function the option
+ *          @p NVM_PARTITION_USE_RW_LOCK must be enabled.
+ *
+ * @param[in] nvmpartp      pointer to the @p NVMPartitionDriver object
+ *
+ * @api
+ */
+void nvmpartReleaseBusShared(NVMPartitionDriver* nvmpartp)
+{
+    osalDbgCheck(nvmpartp != NULL);
+
+    chRWLockReleaseShared(&nvmpartp->lock);
+
+    /* Release the underlying device as well. */
+    nvmReleaseShared(nvmpartp->config->nvmp);
+}
+#endif /* NVM_PARTITION_USE_RW_LOCK */
+
 /**
  * @brief   Write protects one or more sectors.
  *
@@ -465,6 +523,164 @@ bool nvmpartMassWriteUnprotect(NVMPartitionDriver* nvmpartp)
             nvmpartp->part_size);
 }
 
+/**
+ * @brief   Reads multiple segments.
+ * @details Segments are translated in batches and passed on to the
+ *          underlying device as vectored reads.
+ *
+ * @param[in] nvmpartp      pointer to the @p NVMPartitionDriver object
+ * @param[in] segp          pointer to an array of @p NVMReadSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmpartReadv(NVMPartitionDriver* nvmpartp, const NVMReadSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmpartp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmpartp->state >= NVM_READY, "invalid state");
+
+    /* Read operation in progress. */
+    nvmpartp->state = NVM_READING;
+
+    NVMReadSegment batch[NVM_SEGMENT_BATCH_SIZE];
+
+    for (uint32_t i = 0; i < segn; i += NVM_SEGMENT_BATCH_SIZE)
+    {
+        uint32_t batch_n = segn - i;
+        if (batch_n > NVM_SEGMENT_BATCH_SIZE)
+            batch_n = NVM_SEGMENT_BATCH_SIZE;
+
+        for (uint32_t j = 0; j < batch_n; ++j)
+        {
+            /* Verify range is within partition size. */
+            osalDbgAssert((segp[i + j].startaddr + segp[i + j].n <=
+                    nvmpartp->part_size), "invalid parameters");
+            batch[j] = segp[i + j];
+            batch[j].startaddr += nvmpartp->part_org;
+        }
+
+        bool result = nvmReadv(nvmpartp->config->nvmp, batch, batch_n);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    /* Read operation finished. */
+    nvmpartp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes multiple segments.
+ * @details Segments are translated in batches and passed on to the
+ *          underlying device as vectored writes.
+ *
+ * @param[in] nvmpartp      pointer to the @p NVMPartitionDriver object
+ * @param[in] segp          pointer to an array of @p NVMWriteSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmpartWritev(NVMPartitionDriver* nvmpartp, const NVMWriteSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmpartp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmpartp->state >= NVM_READY, "invalid state");
+
+    /* Write operation in progress. */
+    nvmpartp->state = NVM_WRITING;
+
+    NVMWriteSegment batch[NVM_SEGMENT_BATCH_SIZE];
+
+    for (uint32_t i = 0; i < segn; i += NVM_SEGMENT_BATCH_SIZE)
+    {
+        uint32_t batch_n = segn - i;
+        if (batch_n > NVM_SEGMENT_BATCH_SIZE)
+            batch_n = NVM_SEGMENT_BATCH_SIZE;
+
+        for (uint32_t j = 0; j < batch_n; ++j)
+        {
+            /* Verify range is within partition size. */
+            osalDbgAssert((segp[i + j].startaddr + segp[i + j].n <=
+                    nvmpartp->part_size), "invalid parameters");
+            batch[j] = segp[i + j];
+            batch[j].startaddr += nvmpartp->part_org;
+        }
+
+        bool result = nvmWritev(nvmpartp->config->nvmp, batch, batch_n);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Checks whether a range is erased.
+ *
+ * @param[in] nvmpartp  pointer to the @p NVMPartitionDriver object
+ * @param[in] startaddr first address to check
+ * @param[in] n         number of bytes to check
+ * @param[out] erasedp  set to @p true if all bytes are erased
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool nvmpartIsErased(NVMPartitionDriver* nvmpartp, uint32_t startaddr,
+        uint32_t n, bool* erasedp)
+{
+    osalDbgCheck((nvmpartp != NULL) && (erasedp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmpartp->state >= NVM_READY, "invalid state");
+    /* Verify range is within partition size. */
+    osalDbgAssert( (startaddr + n <= nvmpartp->part_size), "invalid parameters");
+
+    return nvmIsErased(nvmpartp->config->nvmp,
+            nvmpartp->part_org + startaddr, n, erasedp);
+}
+
+/**
+ * @brief   Maps a range for direct reads.
+ * @details Passes the request on to the underlying device.
+ *
+ * @param[in] nvmpartp  pointer to the @p NVMPartitionDriver object
+ * @param[in] startaddr first address to map
+ * @param[in] n         number of bytes to map
+ * @param[out] ptrp     receives the address of @p startaddr
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the underlying device is not memory mapped.
+ *
+ * @api
+ */
+bool nvmpartMap(NVMPartitionDriver* nvmpartp, uint32_t startaddr,
+        uint32_t n, const uint8_t** ptrp)
+{
+    osalDbgCheck((nvmpartp != NULL) && (ptrp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmpartp->state >= NVM_READY, "invalid state");
+    /* Verify range is within partition size. */
+    osalDbgAssert( (startaddr + n <= nvmpartp->part_size), "invalid parameters");
+
+    return nvmMap(nvmpartp->config->nvmp,
+            nvmpartp->part_org + startaddr, n, ptrp);
+}
+
 #endif /* HAL_USE_NVM_PARTITION */
 
 /** @} */
@@ -0,0 +1,726 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_read_ahead.c
+ * @brief   NVM read ahead driver code.
+ *
+ * @addtogroup NVM_READ_AHEAD
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_READ_AHEAD || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          Each read starting where the previous one ended counts as
+ *          consecutive. Once the configured number of consecutive reads
+ *          has been seen, reads missing the buffers fill a buffer with a
+ *          whole window starting at the read address, following reads are
+ *          served from it. Reads of at least a window and reads not
+ *          detected as sequential go to the device directly.
+ *          With NVM_READ_AHEAD_USE_ASYNC the window following the one
+ *          being consumed is requested from the device after each
+ *          sequential read, so it is usually complete when needed. Only
+ *          one request is pending at a time and it is waited for before
+ *          any other operation is passed on to the device.
+ *          Writes and erases drop overlapping buffers.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMReadAheadDriverVMT nvm_read_ahead_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmraheadRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmraheadWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmraheadErase,
+    .mass_erase = (bool (*)(void*))nvmraheadMassErase,
+    .sync = (bool (*)(void*))nvmraheadSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmraheadGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))nvmraheadAcquireBus,
+    .release = (void (*)(void*))nvmraheadReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmraheadWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmraheadMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmraheadWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmraheadMassWriteUnprotect,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Waits for the pending request, if any.
+ * @details Buffers whose request failed are dropped.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ *
+ * @notapi
+ */
+static void nvm_read_ahead_wait(NVMReadAheadDriver* nvmraheadp)
+{
+#if NVM_READ_AHEAD_USE_ASYNC
+    for (uint32_t i = 0; i < NVM_READ_AHEAD_BUFFERS; ++i)
+    {
+        NVMReadAheadBuffer* bufp = &nvmraheadp->bufs[i];
+        if (bufp->pending == false)
+            continue;
+
+        bufp->pending = false;
+        if (nvmRequestWait(&bufp->req) != HAL_SUCCESS)
+            bufp->n = 0;
+    }
+#else
+    (void)nvmraheadp;
+#endif /* NVM_READ_AHEAD_USE_ASYNC */
+}
+
+/**
+ * @brief   Drops buffers overlapping a range.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[in] lo            first address of the range
+ * @param[in] hi            address following the range
+ *
+ * @notapi
+ */
+static void nvm_read_ahead_drop(NVMReadAheadDriver* nvmraheadp, uint32_t lo,
+        uint32_t hi)
+{
+    nvm_read_ahead_wait(nvmraheadp);
+
+    for (uint32_t i = 0; i < NVM_READ_AHEAD_BUFFERS; ++i)
+    {
+        NVMReadAheadBuffer* bufp = &nvmraheadp->bufs[i];
+        if (bufp->addr < hi && bufp->addr + bufp->n > lo)
+            bufp->n = 0;
+    }
+}
+
+/**
+ * @brief   Finds the buffer holding an address.
+ * @details A pending request filling it is waited for.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[in] addr          address to look for
+ *
+ * @return                  The buffer or @p NULL if not buffered.
+ *
+ * @notapi
+ */
+static NVMReadAheadBuffer* nvm_read_ahead_lookup(
+        NVMReadAheadDriver* nvmraheadp, uint32_t addr)
+{
+    for (uint32_t i = 0; i < NVM_READ_AHEAD_BUFFERS; ++i)
+    {
+        NVMReadAheadBuffer* bufp = &nvmraheadp->bufs[i];
+        if (addr < bufp->addr || addr - bufp->addr >= bufp->n)
+            continue;
+
+#if NVM_READ_AHEAD_USE_ASYNC
+        if (bufp->pending == true)
+        {
+            nvm_read_ahead_wait(nvmraheadp);
+            if (bufp->n == 0)
+                return NULL;
+        }
+#endif /* NVM_READ_AHEAD_USE_ASYNC */
+        return bufp;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief   Fills a buffer with the window starting at an address.
+ * @details Replaces the empty buffer or the one at the lowest address.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[in] addr          first address of the window
+ *
+ * @return                  The buffer or @p NULL if the read failed.
+ *
+ * @notapi
+ */
+static NVMReadAheadBuffer* nvm_read_ahead_fill(
+        NVMReadAheadDriver* nvmraheadp, uint32_t addr)
+{
+    nvm_read_ahead_wait(nvmraheadp);
+
+    NVMReadAheadBuffer* bufp = &nvmraheadp->bufs[0];
+    for (uint32_t i = 1; i < NVM_READ_AHEAD_BUFFERS && bufp->n > 0; ++i)
+    {
+        if (nvmraheadp->bufs[i].n == 0 ||
+                nvmraheadp->bufs[i].addr < bufp->addr)
+            bufp = &nvmraheadp->bufs[i];
+    }
+
+    uint32_t n = nvmraheadp->ra_size - addr;
+    if (n > nvmraheadp->ra_window)
+        n = nvmraheadp->ra_window;
+
+    bufp->n = 0;
+    if (nvmRead(nvmraheadp->config->nvmp, addr, n, bufp->data) != HAL_SUCCESS)
+        return NULL;
+    bufp->addr = addr;
+    bufp->n = n;
+
+    return bufp;
+}
+
+#if NVM_READ_AHEAD_USE_ASYNC || defined(__DOXYGEN__)
+/**
+ * @brief   Requests the window following the one being consumed.
+ * @details Nothing is started while a request is pending, when the window
+ *          is buffered already or the device does not serve requests.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ *
+ * @notapi
+ */
+static void nvm_read_ahead_prefetch(NVMReadAheadDriver* nvmraheadp)
+{
+    BaseNVMDevice* nvmp = nvmraheadp->config->nvmp;
+    if (nvmp->vmt->start_request == NULL)
+        return;
+
+    /* Window following the buffer the next read is expected in. */
+    uint32_t addr = nvmraheadp->ra_next;
+    NVMReadAheadBuffer* curp = NULL;
+    for (uint32_t i = 0; i < NVM_READ_AHEAD_BUFFERS; ++i)
+    {
+        NVMReadAheadBuffer* bufp = &nvmraheadp->bufs[i];
+        if (bufp->pending == true)
+            return;
+        if (addr >= bufp->addr && addr - bufp->addr < bufp->n)
+            curp = bufp;
+    }
+    if (curp != NULL)
+        addr = curp->addr + curp->n;
+    if (addr >= nvmraheadp->ra_size)
+        return;
+
+    NVMReadAheadBuffer* bufp = NULL;
+    for (uint32_t i = 0; i < NVM_READ_AHEAD_BUFFERS; ++i)
+    {
+        NVMReadAheadBuffer* p = &nvmraheadp->bufs[i];
+        if (addr >= p->addr && addr - p->addr < p->n)
+            return;
+        if (p != curp && (bufp == NULL || p->n == 0 || p->addr < bufp->addr))
+            bufp = p;
+    }
+
+    uint32_t n = nvmraheadp->ra_size - addr;
+    if (n > nvmraheadp->ra_window)
+        n = nvmraheadp->ra_window;
+
+    nvmRequestReadInit(&bufp->req, addr, n, bufp->data, NULL, NULL);
+    bufp->addr = addr;
+    bufp->n = n;
+    bufp->pending = true;
+    if (nvmStartRequest(nvmp, &bufp->req) != HAL_SUCCESS)
+    {
+        bufp->n = 0;
+        bufp->pending = false;
+    }
+}
+#endif /* NVM_READ_AHEAD_USE_ASYNC */
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM read ahead driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmraheadInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmraheadp   pointer to the @p NVMReadAheadDriver object
+ *
+ * @init
+ */
+void nvmraheadObjectInit(NVMReadAheadDriver* nvmraheadp)
+{
+    nvmraheadp->vmt = &nvm_read_ahead_vmt;
+    nvmraheadp->state = NVM_STOP;
+    nvmraheadp->config = NULL;
+    nvmraheadp->ra_size = 0;
+    nvmraheadp->ra_window = 0;
+    nvmraheadp->ra_next = 0;
+    nvmraheadp->ra_seq = 0;
+    for (uint32_t i = 0; i < NVM_READ_AHEAD_BUFFERS; ++i)
+    {
+        nvmraheadp->bufs[i].addr = 0;
+        nvmraheadp->bufs[i].n = 0;
+#if NVM_READ_AHEAD_USE_ASYNC
+        nvmraheadp->bufs[i].pending = false;
+#endif /* NVM_READ_AHEAD_USE_ASYNC */
+    }
+#if NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&nvmraheadp->mutex);
+#endif /* NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the NVM read ahead driver.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[in] config        pointer to the @p NVMReadAheadConfig object.
+ *
+ * @api
+ */
+void nvmraheadStart(NVMReadAheadDriver* nvmraheadp,
+        const NVMReadAheadConfig* config)
+{
+    osalDbgCheck((nvmraheadp != NULL) && (config != NULL));
+    /* Verify device status. */
+    osalDbgAssert((nvmraheadp->state == NVM_STOP) ||
+            (nvmraheadp->state == NVM_READY), "invalid state");
+    osalDbgAssert(config->window <= NVM_READ_AHEAD_SIZE, "invalid window");
+
+    nvmraheadp->config = config;
+
+    /* Calculate and cache often reused values. */
+    nvmGetInfo(nvmraheadp->config->nvmp, &nvmraheadp->llnvmdi);
+    nvmraheadp->ra_size =
+            nvmraheadp->llnvmdi.sector_size * nvmraheadp->llnvmdi.sector_num;
+    nvmraheadp->ra_window = nvmraheadp->config->window;
+    if (nvmraheadp->ra_window == 0)
+        nvmraheadp->ra_window = NVM_READ_AHEAD_SIZE;
+
+    /* No read can start at the end of the device. */
+    nvmraheadp->ra_next = nvmraheadp->ra_size;
+    nvmraheadp->ra_seq = 0;
+    nvm_read_ahead_drop(nvmraheadp, 0, nvmraheadp->ra_size);
+
+    nvmraheadp->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the NVM read ahead driver.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ *
+ * @api
+ */
+void nvmraheadStop(NVMReadAheadDriver* nvmraheadp)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmraheadp->state == NVM_STOP) ||
+            (nvmraheadp->state == NVM_READY), "invalid state");
+
+    nvm_read_ahead_drop(nvmraheadp, 0, nvmraheadp->ra_size);
+
+    nvmraheadp->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ * @details Sequential reads are served from the read ahead buffers.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadRead(NVMReadAheadDriver* nvmraheadp, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert((startaddr + n <= nvmraheadp->ra_size),
+            "invalid parameters");
+
+    nvmstate_t state = nvmraheadp->state;
+
+    /* Read operation in progress. */
+    nvmraheadp->state = NVM_READING;
+
+    /* Detect sequential pattern. */
+    if (startaddr == nvmraheadp->ra_next)
+    {
+        if (nvmraheadp->ra_seq < nvmraheadp->config->trigger)
+            ++nvmraheadp->ra_seq;
+    }
+    else
+    {
+        nvmraheadp->ra_seq = 0;
+    }
+    nvmraheadp->ra_next = startaddr + n;
+    bool ahead = nvmraheadp->ra_seq >= nvmraheadp->config->trigger;
+
+    bool result = HAL_SUCCESS;
+    while (n > 0)
+    {
+        NVMReadAheadBuffer* bufp = nvm_read_ahead_lookup(nvmraheadp,
+                startaddr);
+        if (bufp == NULL)
+        {
+            if (ahead == false || n >= nvmraheadp->ra_window)
+            {
+                nvm_read_ahead_wait(nvmraheadp);
+                result = nvmRead(nvmraheadp->config->nvmp, startaddr, n,
+                        buffer);
+                break;
+            }
+
+            bufp = nvm_read_ahead_fill(nvmraheadp, startaddr);
+            if (bufp == NULL)
+            {
+                result = HAL_FAILED;
+                break;
+            }
+        }
+
+        uint32_t offset = startaddr - bufp->addr;
+        uint32_t len = bufp->n - offset;
+        if (len > n)
+            len = n;
+        memcpy(buffer, bufp->data + offset, len);
+
+        startaddr += len;
+        buffer += len;
+        n -= len;
+    }
+
+#if NVM_READ_AHEAD_USE_ASYNC
+    if (result == HAL_SUCCESS && ahead == true)
+        nvm_read_ahead_prefetch(nvmraheadp);
+#endif /* NVM_READ_AHEAD_USE_ASYNC */
+
+    /* Read operation finished. */
+    nvmraheadp->state = state;
+
+    return result;
+}
+
+/**
+ * @brief   Writes data crossing sector boundaries if required.
+ * @details Buffers overlapping the range are dropped.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadWrite(NVMReadAheadDriver* nvmraheadp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert((startaddr + n <= nvmraheadp->ra_size),
+            "invalid parameters");
+
+    /* Write operation in progress. */
+    nvmraheadp->state = NVM_WRITING;
+
+    nvm_read_ahead_drop(nvmraheadp, startaddr, startaddr + n);
+
+    return nvmWrite(nvmraheadp->config->nvmp, startaddr, n, buffer);
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ * @details Buffers overlapping the erased sectors are dropped.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[in] startaddr     address within to be erased sector
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadErase(NVMReadAheadDriver* nvmraheadp, uint32_t startaddr,
+        uint32_t n)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert((startaddr + n <= nvmraheadp->ra_size),
+            "invalid parameters");
+
+    /* Erase operation in progress. */
+    nvmraheadp->state = NVM_ERASING;
+
+    /* Whole sectors are being erased. */
+    uint32_t sector_size = nvmraheadp->llnvmdi.sector_size;
+    uint32_t first = startaddr - (startaddr % sector_size);
+    uint32_t end = startaddr + n;
+    end += (sector_size - (end % sector_size)) % sector_size;
+    nvm_read_ahead_drop(nvmraheadp, first, end);
+
+    return nvmErase(nvmraheadp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Erases all sectors.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadMassErase(NVMReadAheadDriver* nvmraheadp)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+
+    /* Erase operation in progress. */
+    nvmraheadp->state = NVM_ERASING;
+
+    nvm_read_ahead_drop(nvmraheadp, 0, nvmraheadp->ra_size);
+
+    return nvmMassErase(nvmraheadp->config->nvmp);
+}
+
+/**
+ * @brief   Waits for idle condition.
+ * @details A pending read ahead is completed first.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadSync(NVMReadAheadDriver* nvmraheadp)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+
+    nvm_read_ahead_wait(nvmraheadp);
+
+    bool result = nvmSync(nvmraheadp->config->nvmp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* No more operation in progress. */
+    nvmraheadp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns media info.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadGetInfo(NVMReadAheadDriver* nvmraheadp, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+
+    memcpy(nvmdip, &nvmraheadp->llnvmdi, sizeof(*nvmdip));
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Gains exclusive access to the nvm read ahead device.
+ * @details This function tries to gain ownership to the nvm read ahead
+ *          device, if the device is already being used then the invoking
+ *          thread is queued.
+ * @pre     In order to use this function the option
+ *          @p NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ *
+ * @api
+ */
+void nvmraheadAcquireBus(NVMReadAheadDriver* nvmraheadp)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+
+#if NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&nvmraheadp->mutex);
+
+    /* Lock the underlying device as well. */
+    nvmAcquire(nvmraheadp->config->nvmp);
+#endif /* NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the nvm read ahead device.
+ * @pre     In order to use this function the option
+ *          @p NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ *
+ * @api
+ */
+void nvmraheadReleaseBus(NVMReadAheadDriver* nvmraheadp)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+
+#if NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&nvmraheadp->mutex);
+
+    /* Release the underlying device as well. */
+    nvmRelease(nvmraheadp->config->nvmp);
+#endif /* NVM_READ_AHEAD_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Write protects one or more sectors.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[in] startaddr     address within to be protected sector
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadWriteProtect(NVMReadAheadDriver* nvmraheadp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+
+    return nvmWriteProtect(nvmraheadp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write protects the whole device.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadMassWriteProtect(NVMReadAheadDriver* nvmraheadp)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteProtect(nvmraheadp->config->nvmp);
+}
+
+/**
+ * @brief   Write unprotects one or more sectors.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ * @param[in] startaddr     address within to be unprotected sector
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadWriteUnprotect(NVMReadAheadDriver* nvmraheadp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+
+    return nvmWriteUnprotect(nvmraheadp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ *
+ * @param[in] nvmraheadp    pointer to the @p NVMReadAheadDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmraheadMassWriteUnprotect(NVMReadAheadDriver* nvmraheadp)
+{
+    osalDbgCheck(nvmraheadp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmraheadp->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteUnprotect(nvmraheadp->config->nvmp);
+}
+
+#endif /* HAL_USE_NVM_READ_AHEAD */
+
+/** @} */
@@ -0,0 +1,1003 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_sched.c
+ * @brief   NVM I/O scheduler driver code.
+ *
+ * @addtogroup NVM_SCHED
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_SCHED || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          Clients, typically the partitions of one chip, queue their
+ *          requests and wait for the worker thread to serve them. Reads
+ *          are kept in a queue of their own and served first, adjacent
+ *          reads are merged into one vectored read. Writes, erases and
+ *          syncs are served in order of submission, adjacent writes are
+ *          merged unless a request in between overlaps them. Erases are
+ *          served one sector at a time, so reads only wait for the sector
+ *          in progress. Devices suspending a pending erase or program for
+ *          reads serve them without waiting at all.
+ *          A sync is queued as an empty write and syncs the underlying
+ *          device once all writes and erases queued before it are done.
+ *          Reads may overtake queued writes, clients of asynchronous
+ *          requests have to wait for a write before reading the data back.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMSchedDriverVMT nvm_sched_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmschedRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmschedWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmschedErase,
+    .mass_erase = (bool (*)(void*))nvmschedMassErase,
+    .sync = (bool (*)(void*))nvmschedSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmschedGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))nvmschedAcquireBus,
+    .release = (void (*)(void*))nvmschedReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmschedWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmschedMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmschedWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmschedMassWriteUnprotect,
+    .readv = (bool (*)(void*, const NVMReadSegment*, uint32_t))nvmschedReadv,
+    .writev = (bool (*)(void*, const NVMWriteSegment*, uint32_t))nvmschedWritev,
+    .start_request = (bool (*)(void*, NVMRequest*))nvmschedStartRequest,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static bool nvm_sched_is_sync(const NVMRequest* reqp)
+{
+    return reqp->op == NVM_REQUEST_WRITE && reqp->n == 0;
+}
+
+static bool nvm_sched_overlaps(const NVMRequest* ap, const NVMRequest* bp)
+{
+    return ap->startaddr < bp->startaddr + bp->n &&
+            bp->startaddr < ap->startaddr + ap->n;
+}
+
+/**
+ * @brief   Removes a request from a queue.
+ *
+ * @param[in] qp            pointer to the @p NVMSchedQueue
+ * @param[in] linkp         pointer to the link referencing the request
+ * @param[in] prevp         request preceding it or @p NULL
+ *
+ * @notapi
+ */
+static void nvm_sched_unlink(NVMSchedQueue* qp, NVMRequest** linkp,
+        NVMRequest* prevp)
+{
+    NVMRequest* reqp = *linkp;
+
+    *linkp = reqp->next;
+    if (qp->tail == reqp)
+        qp->tail = prevp;
+    reqp->next = NULL;
+}
+
+/**
+ * @brief   Queues a request.
+ *
+ * @sclass
+ */
+static void nvm_sched_enqueue_s(NVMSchedDriver* nvmschedp, NVMRequest* reqp)
+{
+    NVMSchedQueue* qp = (reqp->op == NVM_REQUEST_READ) ?
+            &nvmschedp->reads : &nvmschedp->writes;
+
+    reqp->nvmp = (BaseNVMDevice*)nvmschedp;
+    reqp->next = NULL;
+    reqp->done = false;
+
+    if (qp->tail != NULL)
+        qp->tail->next = reqp;
+    else
+        qp->head = reqp;
+    qp->tail = reqp;
+
+    osalThreadResumeS(&nvmschedp->wait, MSG_OK);
+}
+
+/**
+ * @brief   Queues requests and waits for their completion.
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      all requests succeeded.
+ * @retval HAL_FAILED       at least one request failed.
+ *
+ * @notapi
+ */
+static bool nvm_sched_submit_wait(NVMSchedDriver* nvmschedp,
+        NVMRequest* reqs, uint32_t n)
+{
+    osalSysLock();
+    for (uint32_t i = 0; i < n; ++i)
+        nvm_sched_enqueue_s(nvmschedp, &reqs[i]);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    bool result = HAL_SUCCESS;
+    for (uint32_t i = 0; i < n; ++i)
+        if (nvmRequestWait(&reqs[i]) != HAL_SUCCESS)
+            result = HAL_FAILED;
+
+    return result;
+}
+
+/**
+ * @brief   Takes the oldest read and all reads adjacent to it.
+ *
+ * @return                  The number of requests in the batch.
+ *
+ * @sclass
+ */
+static uint32_t nvm_sched_collect_reads_s(NVMSchedDriver* nvmschedp)
+{
+    NVMSchedQueue* qp = &nvmschedp->reads;
+    NVMRequest** batch = nvmschedp->batch;
+
+    batch[0] = qp->head;
+    nvm_sched_unlink(qp, &qp->head, NULL);
+
+    uint32_t first = batch[0]->startaddr;
+    uint32_t end = first + batch[0]->n;
+    uint32_t k = 1;
+
+    bool merged = true;
+    while (merged == true && k < NVM_SEGMENT_BATCH_SIZE)
+    {
+        merged = false;
+
+        NVMRequest** linkp = &qp->head;
+        NVMRequest* prevp = NULL;
+        while (*linkp != NULL && k < NVM_SEGMENT_BATCH_SIZE)
+        {
+            NVMRequest* reqp = *linkp;
+
+            if (reqp->startaddr == end)
+            {
+                nvm_sched_unlink(qp, linkp, prevp);
+                batch[k++] = reqp;
+                end += reqp->n;
+                merged = true;
+            }
+            else if (reqp->startaddr + reqp->n == first)
+            {
+                nvm_sched_unlink(qp, linkp, prevp);
+                memmove(&batch[1], &batch[0], k * sizeof(batch[0]));
+                batch[0] = reqp;
+                ++k;
+                first = reqp->startaddr;
+                merged = true;
+            }
+            else
+            {
+                prevp = reqp;
+                linkp = &reqp->next;
+            }
+        }
+    }
+
+    return k;
+}
+
+/**
+ * @brief   Checks whether a write may be served before the requests
+ *          queued ahead of it.
+ *
+ * @sclass
+ */
+static bool nvm_sched_may_advance_s(NVMSchedDriver* nvmschedp,
+        const NVMRequest* reqp)
+{
+    for (const NVMRequest* p = nvmschedp->writes.head; p != reqp; p = p->next)
+        if (nvm_sched_is_sync(p) || nvm_sched_overlaps(p, reqp))
+            return false;
+
+    return true;
+}
+
+/**
+ * @brief   Takes the oldest write and all writes adjacent to it.
+ * @pre     The head of the queue is a write.
+ *
+ * @return                  The number of requests in the batch.
+ *
+ * @sclass
+ */
+static uint32_t nvm_sched_collect_writes_s(NVMSchedDriver* nvmschedp)
+{
+    NVMSchedQueue* qp = &nvmschedp->writes;
+    NVMRequest** batch = nvmschedp->batch;
+
+    batch[0] = qp->head;
+    nvm_sched_unlink(qp, &qp->head, NULL);
+
+    uint32_t first = batch[0]->startaddr;
+    uint32_t end = first + batch[0]->n;
+    uint32_t k = 1;
+
+    bool merged = true;
+    while (merged == true && k < NVM_SEGMENT_BATCH_SIZE)
+    {
+        merged = false;
+
+        NVMRequest** linkp = &qp->head;
+        NVMRequest* prevp = NULL;
+        while (*linkp != NULL && k < NVM_SEGMENT_BATCH_SIZE)
+        {
+            NVMRequest* reqp = *linkp;
+
+            /* Writes are not moved across syncs. */
+            if (nvm_sched_is_sync(reqp))
+                break;
+
+            if (reqp->op == NVM_REQUEST_WRITE &&
+                    (reqp->startaddr == end ||
+                    reqp->startaddr + reqp->n == first) &&
+                    nvm_sched_may_advance_s(nvmschedp, reqp))
+            {
+                nvm_sched_unlink(qp, linkp, prevp);
+                if (reqp->startaddr == end)
+                {
+                    batch[k++] = reqp;
+                    end += reqp->n;
+                }
+                else
+                {
+                    memmove(&batch[1], &batch[0], k * sizeof(batch[0]));
+                    batch[0] = reqp;
+                    ++k;
+                    first = reqp->startaddr;
+                }
+                merged = true;
+            }
+            else
+            {
+                prevp = reqp;
+                linkp = &reqp->next;
+            }
+        }
+    }
+
+    return k;
+}
+
+/**
+ * @brief   Completes the requests of the current batch.
+ *
+ * @notapi
+ */
+static void nvm_sched_complete(NVMSchedDriver* nvmschedp, uint32_t k,
+        bool result)
+{
+    osalSysLock();
+    for (uint32_t i = 0; i < k; ++i)
+        nvmRequestCompleteI(nvmschedp->batch[i], result);
+    osalOsRescheduleS();
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Serves a batch of adjacent reads.
+ *
+ * @notapi
+ */
+static void nvm_sched_serve_reads(NVMSchedDriver* nvmschedp, uint32_t k)
+{
+    BaseNVMDevice* nvmp = nvmschedp->config->nvmp;
+
+    for (uint32_t i = 0; i < k; ++i)
+    {
+        nvmschedp->segs.read[i].startaddr = nvmschedp->batch[i]->startaddr;
+        nvmschedp->segs.read[i].n = nvmschedp->batch[i]->n;
+        nvmschedp->segs.read[i].buffer = nvmschedp->batch[i]->buffer.read;
+    }
+
+    nvmAcquireShared(nvmp);
+    bool result = nvmReadv(nvmp, nvmschedp->segs.read, k);
+    nvmReleaseShared(nvmp);
+
+    nvm_sched_complete(nvmschedp, k, result);
+}
+
+/**
+ * @brief   Serves a batch of adjacent writes.
+ *
+ * @notapi
+ */
+static void nvm_sched_serve_writes(NVMSchedDriver* nvmschedp, uint32_t k)
+{
+    BaseNVMDevice* nvmp = nvmschedp->config->nvmp;
+
+    for (uint32_t i = 0; i < k; ++i)
+    {
+        nvmschedp->segs.write[i].startaddr = nvmschedp->batch[i]->startaddr;
+        nvmschedp->segs.write[i].n = nvmschedp->batch[i]->n;
+        nvmschedp->segs.write[i].buffer = nvmschedp->batch[i]->buffer.write;
+    }
+
+    nvmAcquire(nvmp);
+    bool result = nvmWritev(nvmp, nvmschedp->segs.write, k);
+    nvmRelease(nvmp);
+
+    nvm_sched_complete(nvmschedp, k, result);
+}
+
+/**
+ * @brief   Serves a sync.
+ *
+ * @notapi
+ */
+static void nvm_sched_serve_sync(NVMSchedDriver* nvmschedp)
+{
+    BaseNVMDevice* nvmp = nvmschedp->config->nvmp;
+
+    nvmAcquire(nvmp);
+    bool result = nvmSync(nvmp);
+    nvmRelease(nvmp);
+
+    nvm_sched_complete(nvmschedp, 1, result);
+}
+
+/**
+ * @brief   Erases the next sector of the erase at the head of the queue.
+ * @details The request stays queued until all of its sectors are erased.
+ *
+ * @notapi
+ */
+static void nvm_sched_serve_erase_step(NVMSchedDriver* nvmschedp,
+        NVMRequest* reqp)
+{
+    BaseNVMDevice* nvmp = nvmschedp->config->nvmp;
+    const uint32_t sector_size = nvmschedp->llnvmdi.sector_size;
+
+    bool result = HAL_SUCCESS;
+    if (nvmschedp->erase_offset < reqp->n)
+    {
+        uint32_t addr = reqp->startaddr + nvmschedp->erase_offset;
+        uint32_t n = sector_size - (addr % sector_size);
+        if (n > reqp->n - nvmschedp->erase_offset)
+            n = reqp->n - nvmschedp->erase_offset;
+
+        nvmAcquire(nvmp);
+        result = nvmErase(nvmp, addr, n);
+        nvmRelease(nvmp);
+
+        nvmschedp->erase_offset += n;
+    }
+
+    if (result != HAL_SUCCESS || nvmschedp->erase_offset >= reqp->n)
+    {
+        osalSysLock();
+        nvm_sched_unlink(&nvmschedp->writes, &nvmschedp->writes.head, NULL);
+        nvmschedp->erase_offset = 0;
+        nvmRequestCompleteI(reqp, result);
+        osalOsRescheduleS();
+        osalSysUnlock();
+    }
+}
+
+/**
+ * @brief   Worker thread serving the queued requests.
+ */
+static void nvm_sched_worker(void* parameters)
+{
+    NVMSchedDriver* nvmschedp = (NVMSchedDriver*)parameters;
+
+    chRegSetThreadName("nvm_sched");
+
+    while (true)
+    {
+        osalSysLock();
+        while (nvmschedp->reads.head == NULL &&
+                nvmschedp->writes.head == NULL)
+            osalThreadSuspendS(&nvmschedp->wait);
+
+        /* Reads first, unless writes waited for a whole burst of them. */
+        if (nvmschedp->reads.head != NULL &&
+                (nvmschedp->writes.head == NULL ||
+                nvmschedp->read_burst < NVM_SCHED_READ_BURST))
+        {
+            ++nvmschedp->read_burst;
+            uint32_t k = nvm_sched_collect_reads_s(nvmschedp);
+            osalSysUnlock();
+
+            nvm_sched_serve_reads(nvmschedp, k);
+            continue;
+        }
+
+        nvmschedp->read_burst = 0;
+
+        NVMRequest* reqp = nvmschedp->writes.head;
+        if (reqp->op == NVM_REQUEST_ERASE)
+        {
+            osalSysUnlock();
+            nvm_sched_serve_erase_step(nvmschedp, reqp);
+        }
+        else if (nvm_sched_is_sync(reqp))
+        {
+            nvmschedp->batch[0] = reqp;
+            nvm_sched_unlink(&nvmschedp->writes, &nvmschedp->writes.head,
+                    NULL);
+            osalSysUnlock();
+            nvm_sched_serve_sync(nvmschedp);
+        }
+        else
+        {
+            uint32_t k = nvm_sched_collect_writes_s(nvmschedp);
+            osalSysUnlock();
+            nvm_sched_serve_writes(nvmschedp, k);
+        }
+    }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM I/O scheduler driver initialization.
+ * @note    This function is implicitly invoked by @p qhalInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmschedInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmschedp    pointer to the @p NVMSchedDriver object
+ *
+ * @init
+ */
+void nvmschedObjectInit(NVMSchedDriver* nvmschedp)
+{
+    nvmschedp->vmt = &nvm_sched_vmt;
+    nvmschedp->state = NVM_STOP;
+    nvmschedp->config = NULL;
+    nvmschedp->tr = NULL;
+    nvmschedp->wait = NULL;
+    nvmschedp->reads.head = NULL;
+    nvmschedp->reads.tail = NULL;
+    nvmschedp->writes.head = NULL;
+    nvmschedp->writes.tail = NULL;
+    nvmschedp->erase_offset = 0;
+    nvmschedp->read_burst = 0;
+
+    /* Filling the thread working area here because the function
+       @p chThdCreateI() does not do it.*/
+#if CH_DBG_FILL_THREADS
+    {
+        _thread_memfill((uint8_t*)THD_WORKING_AREA_BASE(nvmschedp->wa),
+            (uint8_t*)THD_WORKING_AREA_END(nvmschedp->wa),
+            CH_DBG_STACK_FILL_VALUE);
+    }
+#endif /* CH_DBG_FILL_THREADS */
+}
+
+/**
+ * @brief   Configures and activates the NVM I/O scheduler.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[in] config        pointer to the @p NVMSchedConfig object.
+ *
+ * @api
+ */
+void nvmschedStart(NVMSchedDriver* nvmschedp, const NVMSchedConfig* config)
+{
+    osalDbgCheck((nvmschedp != NULL) && (config != NULL));
+    /* Verify device status. */
+    osalDbgAssert((nvmschedp->state == NVM_STOP) ||
+            (nvmschedp->state == NVM_READY), "invalid state");
+
+    nvmschedp->config = config;
+
+    nvmGetInfo(nvmschedp->config->nvmp, &nvmschedp->llnvmdi);
+
+    /* Creates the worker thread. Note, it is created only once.*/
+    osalSysLock();
+    if (nvmschedp->tr == NULL)
+    {
+        thread_descriptor_t descriptor = {
+          "nvm_sched",
+          THD_WORKING_AREA_BASE(nvmschedp->wa),
+          THD_WORKING_AREA_END(nvmschedp->wa),
+          NVM_SCHED_THREAD_PRIO,
+          nvm_sched_worker,
+          (void*)nvmschedp
+        };
+        nvmschedp->tr = chThdCreateI(&descriptor);
+        osalOsRescheduleS();
+    }
+    osalSysUnlock();
+
+    nvmschedp->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the NVM I/O scheduler.
+ * @note    All submitted requests must have completed.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ *
+ * @api
+ */
+void nvmschedStop(NVMSchedDriver* nvmschedp)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmschedp->state == NVM_STOP) ||
+            (nvmschedp->state == NVM_READY), "invalid state");
+    osalDbgAssert(nvmschedp->reads.head == NULL &&
+            nvmschedp->writes.head == NULL, "requests queued");
+
+    nvmschedp->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedRead(NVMSchedDriver* nvmschedp, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    NVMRequest req;
+    nvmRequestReadInit(&req, startaddr, n, buffer, NULL, NULL);
+
+    return nvm_sched_submit_wait(nvmschedp, &req, 1);
+}
+
+/**
+ * @brief   Writes data crossing sector boundaries if required.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedWrite(NVMSchedDriver* nvmschedp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    /* Note: Empty writes are queued as syncs. */
+    if (n == 0)
+        return HAL_SUCCESS;
+
+    NVMRequest req;
+    nvmRequestWriteInit(&req, startaddr, n, buffer, NULL, NULL);
+
+    return nvm_sched_submit_wait(nvmschedp, &req, 1);
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[in] startaddr     address within to be erased sector
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedErase(NVMSchedDriver* nvmschedp, uint32_t startaddr,
+        uint32_t n)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    NVMRequest req;
+    nvmRequestEraseInit(&req, startaddr, n, NULL, NULL);
+
+    return nvm_sched_submit_wait(nvmschedp, &req, 1);
+}
+
+/**
+ * @brief   Erases all sectors.
+ * @details Waits for the writes and erases queued before, the mass erase
+ *          itself is not scheduled.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedMassErase(NVMSchedDriver* nvmschedp)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    if (nvmschedSync(nvmschedp) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvmAcquire(nvmschedp->config->nvmp);
+    bool result = nvmMassErase(nvmschedp->config->nvmp);
+    nvmRelease(nvmschedp->config->nvmp);
+
+    return result;
+}
+
+/**
+ * @brief   Waits for idle condition.
+ * @details Waits for the writes and erases queued before and syncs the
+ *          underlying device.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedSync(NVMSchedDriver* nvmschedp)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    NVMRequest req;
+    nvmRequestWriteInit(&req, 0, 0, NULL, NULL, NULL);
+
+    return nvm_sched_submit_wait(nvmschedp, &req, 1);
+}
+
+/**
+ * @brief   Returns media info.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedGetInfo(NVMSchedDriver* nvmschedp, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck((nvmschedp != NULL) && (nvmdip != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    *nvmdip = nvmschedp->llnvmdi;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Does nothing, clients are not serialized.
+ * @details Each request is served atomically by the worker thread, which
+ *          acquires the underlying device on its own.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ *
+ * @api
+ */
+void nvmschedAcquireBus(NVMSchedDriver* nvmschedp)
+{
+    osalDbgCheck(nvmschedp != NULL);
+}
+
+/**
+ * @brief   Does nothing, clients are not serialized.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ *
+ * @api
+ */
+void nvmschedReleaseBus(NVMSchedDriver* nvmschedp)
+{
+    osalDbgCheck(nvmschedp != NULL);
+}
+
+/**
+ * @brief   Write protects one or more sectors.
+ * @note    Not scheduled, passed on directly.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[in] startaddr     address within to be protected sector
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedWriteProtect(NVMSchedDriver* nvmschedp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    nvmAcquire(nvmschedp->config->nvmp);
+    bool result = nvmWriteProtect(nvmschedp->config->nvmp, startaddr, n);
+    nvmRelease(nvmschedp->config->nvmp);
+
+    return result;
+}
+
+/**
+ * @brief   Write protects the whole device.
+ * @note    Not scheduled, passed on directly.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedMassWriteProtect(NVMSchedDriver* nvmschedp)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    nvmAcquire(nvmschedp->config->nvmp);
+    bool result = nvmMassWriteProtect(nvmschedp->config->nvmp);
+    nvmRelease(nvmschedp->config->nvmp);
+
+    return result;
+}
+
+/**
+ * @brief   Write unprotects one or more sectors.
+ * @note    Not scheduled, passed on directly.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[in] startaddr     address within to be unprotected sector
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedWriteUnprotect(NVMSchedDriver* nvmschedp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    nvmAcquire(nvmschedp->config->nvmp);
+    bool result = nvmWriteUnprotect(nvmschedp->config->nvmp, startaddr, n);
+    nvmRelease(nvmschedp->config->nvmp);
+
+    return result;
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ * @note    Not scheduled, passed on directly.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedMassWriteUnprotect(NVMSchedDriver* nvmschedp)
+{
+    osalDbgCheck(nvmschedp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    nvmAcquire(nvmschedp->config->nvmp);
+    bool result = nvmMassWriteUnprotect(nvmschedp->config->nvmp);
+    nvmRelease(nvmschedp->config->nvmp);
+
+    return result;
+}
+
+/**
+ * @brief   Reads multiple segments.
+ * @details Up to @p NVM_SEGMENT_BATCH_SIZE segments are queued at once, so
+ *          they can be merged with each other and with other reads.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[in] segp          pointer to an array of @p NVMReadSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedReadv(NVMSchedDriver* nvmschedp, const NVMReadSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmschedp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    NVMRequest reqs[NVM_SEGMENT_BATCH_SIZE];
+    bool result = HAL_SUCCESS;
+
+    while (segn > 0)
+    {
+        uint32_t k = (segn < NVM_SEGMENT_BATCH_SIZE) ?
+                segn : NVM_SEGMENT_BATCH_SIZE;
+
+        for (uint32_t i = 0; i < k; ++i)
+            nvmRequestReadInit(&reqs[i], segp[i].startaddr, segp[i].n,
+                    segp[i].buffer, NULL, NULL);
+
+        if (nvm_sched_submit_wait(nvmschedp, reqs, k) != HAL_SUCCESS)
+            result = HAL_FAILED;
+
+        segp += k;
+        segn -= k;
+    }
+
+    return result;
+}
+
+/**
+ * @brief   Writes multiple segments.
+ * @details Up to @p NVM_SEGMENT_BATCH_SIZE segments are queued at once,
+ *          they are written in order.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[in] segp          pointer to an array of @p NVMWriteSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmschedWritev(NVMSchedDriver* nvmschedp, const NVMWriteSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmschedp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    NVMRequest reqs[NVM_SEGMENT_BATCH_SIZE];
+    bool result = HAL_SUCCESS;
+
+    while (segn > 0)
+    {
+        uint32_t k = 0;
+
+        /* Note: Empty segments would be taken for syncs. */
+        while (k < NVM_SEGMENT_BATCH_SIZE && segn > 0)
+        {
+            if (segp->n > 0)
+            {
+                nvmRequestWriteInit(&reqs[k], segp->startaddr, segp->n,
+                        segp->buffer, NULL, NULL);
+                ++k;
+            }
+            ++segp;
+            --segn;
+        }
+
+        if (k > 0 && nvm_sched_submit_wait(nvmschedp, reqs, k) != HAL_SUCCESS)
+            result = HAL_FAILED;
+    }
+
+    return result;
+}
+
+/**
+ * @brief   Queues an asynchronous request.
+ *
+ * @param[in] nvmschedp     pointer to the @p NVMSchedDriver object
+ * @param[in] reqp          pointer to an initialized @p NVMRequest
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the request has been queued.
+ *
+ * @api
+ */
+bool nvmschedStartRequest(NVMSchedDriver* nvmschedp, NVMRequest* reqp)
+{
+    osalDbgCheck((nvmschedp != NULL) && (reqp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmschedp->state >= NVM_READY, "invalid state");
+
+    osalSysLock();
+    if (reqp->op == NVM_REQUEST_WRITE && reqp->n == 0)
+    {
+        /* Note: Empty writes are queued as syncs. */
+        reqp->nvmp = (BaseNVMDevice*)nvmschedp;
+        reqp->done = false;
+        nvmRequestCompleteI(reqp, HAL_SUCCESS);
+    }
+    else
+    {
+        nvm_sched_enqueue_s(nvmschedp, reqp);
+    }
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return HAL_SUCCESS;
+}
+
+#endif /* HAL_USE_NVM_SCHED */
+
+/** @} */
@@ -0,0 +1,802 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_stripe.c
+ * @brief   NVM stripe driver code.
+ *
+ * @addtogroup NVM_STRIPE
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_STRIPE || defined(__DOXYGEN__)
+
+#include "static_assert.h"
+
+#include <string.h>
+
+/**
+ * @note
+ *      - Layout:
+ *        Stripe i of the striped device is located at stripe i / nvm_num
+ *        of device i % nvm_num. Any contiguous range of the striped device
+ *        maps to one contiguous range per device, erases and protection
+ *        are passed on as such.
+ *      - Sectors:
+ *        Stripes of at least the device sector size keep the sector size.
+ *        Smaller stripes join the sectors of all devices at the same
+ *        offset into one sector of the striped device.
+ *      - Parallelism:
+ *        Writes are issued in rounds of one stripe per device. Without
+ *        @p NVM_STRIPE_USE_ASYNC devices overlap only while they return
+ *        with an operation pending, like the JEDEC SPI driver does for the
+ *        last page program and for erases. Stripes of the page size keep
+ *        all devices programming then.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMStripeDriverVMT nvm_stripe_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmstripeRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmstripeWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmstripeErase,
+    .mass_erase = (bool (*)(void*))nvmstripeMassErase,
+    .sync = (bool (*)(void*))nvmstripeSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmstripeGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))nvmstripeAcquireBus,
+    .release = (void (*)(void*))nvmstripeReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmstripeWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmstripeMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmstripeWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmstripeMassWriteUnprotect,
+    .readv = NULL,
+    .writev = NULL,
+    .start_request = NULL,
+    .is_erased = (bool (*)(void*, uint32_t, uint32_t, bool*))nvmstripeIsErased,
+    .map = NULL,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Locates an address of the striped device.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] addr          address of the striped device
+ * @param[out] devp         index of the device holding @p addr
+ * @param[out] devaddrp     address within that device
+ *
+ * @return                  Number of bytes left in the stripe.
+ *
+ * @notapi
+ */
+static uint32_t nvm_stripe_locate(NVMStripeDriver* nvmstripep, uint32_t addr,
+        uint32_t* devp, uint32_t* devaddrp)
+{
+    const uint32_t stripe_size = nvmstripep->config->stripe_size;
+    const uint32_t stripe = addr / stripe_size;
+
+    *devp = stripe % nvmstripep->config->nvm_num;
+    *devaddrp = (stripe / nvmstripep->config->nvm_num) * stripe_size +
+            addr % stripe_size;
+
+    return stripe_size - addr % stripe_size;
+}
+
+/**
+ * @brief   Maps an address of the striped device onto a device.
+ * @details Returns the number of bytes of device @p dev located below
+ *          @p addr, which is the device address of @p addr if @p addr is
+ *          located on @p dev. A range of the striped device maps to the
+ *          range between the bounds of its start and end on every device.
+ *
+ * @notapi
+ */
+static uint32_t nvm_stripe_bound(NVMStripeDriver* nvmstripep, uint32_t addr,
+        uint32_t dev)
+{
+    const uint32_t stripe_size = nvmstripep->config->stripe_size;
+    const uint32_t stripe = addr / stripe_size;
+    const uint32_t row = stripe / nvmstripep->config->nvm_num;
+    const uint32_t addr_dev = stripe % nvmstripep->config->nvm_num;
+
+    if (dev < addr_dev)
+        return (row + 1) * stripe_size;
+    if (dev > addr_dev)
+        return row * stripe_size;
+    return row * stripe_size + addr % stripe_size;
+}
+
+/**
+ * @brief   Starts a write or erase on a device.
+ * @details Submitted to the async driver if configured, passed on directly
+ *          otherwise.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] slot          request slot, unique until the next wait
+ * @param[in] dev           index of the device
+ * @param[in] erase         erase instead of write
+ * @param[in] startaddr     device address
+ * @param[in] n             number of bytes
+ * @param[in] buffer        data to write, unused for erases
+ *
+ * @notapi
+ */
+static bool nvm_stripe_issue(NVMStripeDriver* nvmstripep, uint32_t slot,
+        uint32_t dev, bool erase, uint32_t startaddr, uint32_t n,
+        const uint8_t* buffer)
+{
+    BaseNVMDevice* nvmp = nvmstripep->config->nvmps[dev];
+
+#if NVM_STRIPE_USE_ASYNC
+    if (nvmstripep->config->asyncp != NULL)
+    {
+        NVMRequest* reqp = &nvmstripep->requests[slot];
+
+        if (erase == true)
+            nvmRequestEraseInit(reqp, startaddr, n, NULL, NULL);
+        else
+            nvmRequestWriteInit(reqp, startaddr, n, buffer, NULL, NULL);
+
+        return nvmasyncSubmit(nvmstripep->config->asyncp, nvmp, reqp);
+    }
+#else
+    (void)slot;
+#endif /* NVM_STRIPE_USE_ASYNC */
+
+    if (erase == true)
+        return nvmErase(nvmp, startaddr, n);
+
+    return nvmWrite(nvmp, startaddr, n, buffer);
+}
+
+/**
+ * @brief   Waits for the requests started by @p nvm_stripe_issue().
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] issued        number of requests started since the last wait
+ *
+ * @notapi
+ */
+static bool nvm_stripe_wait(NVMStripeDriver* nvmstripep, uint32_t issued)
+{
+    bool result = HAL_SUCCESS;
+
+#if NVM_STRIPE_USE_ASYNC
+    if (nvmstripep->config->asyncp != NULL)
+    {
+        for (uint32_t i = 0; i < issued; ++i)
+        {
+            if (nvmRequestWait(&nvmstripep->requests[i]) != HAL_SUCCESS)
+                result = HAL_FAILED;
+        }
+    }
+#else
+    (void)nvmstripep;
+    (void)issued;
+#endif /* NVM_STRIPE_USE_ASYNC */
+
+    return result;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM stripe driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmstripeInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmstripep   pointer to the @p NVMStripeDriver object
+ *
+ * @init
+ */
+void nvmstripeObjectInit(NVMStripeDriver* nvmstripep)
+{
+    nvmstripep->vmt = &nvm_stripe_vmt;
+    nvmstripep->state = NVM_STOP;
+    nvmstripep->config = NULL;
+    nvmstripep->sector_size = 0;
+    nvmstripep->size = 0;
+#if NVM_STRIPE_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&nvmstripep->mutex);
+#endif /* NVM_STRIPE_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the NVM stripe.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] config        pointer to the @p NVMStripeConfig object.
+ *
+ * @api
+ */
+void nvmstripeStart(NVMStripeDriver* nvmstripep,
+        const NVMStripeConfig* config)
+{
+    osalDbgCheck((nvmstripep != NULL) && (config != NULL));
+    /* Verify device status. */
+    osalDbgAssert((nvmstripep->state == NVM_STOP) || (nvmstripep->state == NVM_READY),
+            "invalid state");
+
+#define IS_POW2(x) ((((x) != 0) && !((x) & ((x) - 1))))
+
+    /* Sanity check configuration. */
+    osalDbgAssert(
+            config->nvm_num >= 1 &&
+            config->nvm_num <= NVM_STRIPE_DEVICES_MAX &&
+            IS_POW2(config->stripe_size),
+            "invalid config");
+
+    nvmstripep->config = config;
+
+    /* Calculate and cache often reused values. */
+    nvmGetInfo(config->nvmps[0], &nvmstripep->llnvmdi);
+
+    const uint32_t sector_size = nvmstripep->llnvmdi.sector_size;
+    const uint32_t dev_size = sector_size * nvmstripep->llnvmdi.sector_num;
+
+    for (uint32_t i = 1; i < config->nvm_num; ++i)
+    {
+        NVMDeviceInfo di;
+        nvmGetInfo(config->nvmps[i], &di);
+
+        osalDbgAssert(di.sector_size == sector_size &&
+                di.sector_num == nvmstripep->llnvmdi.sector_num,
+                "geometry mismatch");
+    }
+
+    osalDbgAssert(
+            (config->stripe_size % sector_size == 0 ||
+            sector_size % config->stripe_size == 0) &&
+            dev_size % config->stripe_size == 0,
+            "invalid stripe size");
+
+    if (config->stripe_size >= sector_size)
+        nvmstripep->sector_size = sector_size;
+    else
+        nvmstripep->sector_size = sector_size * config->nvm_num;
+    nvmstripep->size = dev_size * config->nvm_num;
+
+    nvmstripep->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the NVM stripe.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ *
+ * @api
+ */
+void nvmstripeStop(NVMStripeDriver* nvmstripep)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmstripep->state == NVM_STOP) || (nvmstripep->state == NVM_READY),
+            "invalid state");
+
+    nvmstripep->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeRead(NVMStripeDriver* nvmstripep, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+    /* Verify range is within stripe size. */
+    osalDbgAssert((startaddr + n <= nvmstripep->size), "invalid parameters");
+
+    const nvmstate_t pending = nvmstripep->state;
+
+    /* Read operation in progress. */
+    nvmstripep->state = NVM_READING;
+
+    while (n > 0)
+    {
+        uint32_t dev;
+        uint32_t devaddr;
+        uint32_t len = nvm_stripe_locate(nvmstripep, startaddr, &dev, &devaddr);
+        if (len > n)
+            len = n;
+
+        bool result = nvmRead(nvmstripep->config->nvmps[dev], devaddr, len,
+                buffer);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        startaddr += len;
+        buffer += len;
+        n -= len;
+    }
+
+    /* Read operation finished, pending operations go on. */
+    nvmstripep->state = pending;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes data crossing sector boundaries if required.
+ * @details Data is written in rounds of one stripe per device.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeWrite(NVMStripeDriver* nvmstripep, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+    /* Verify range is within stripe size. */
+    osalDbgAssert((startaddr + n <= nvmstripep->size), "invalid parameters");
+
+    /* Write operation in progress. */
+    nvmstripep->state = NVM_WRITING;
+
+    bool result = HAL_SUCCESS;
+
+    while (n > 0 && result == HAL_SUCCESS)
+    {
+        /* Consecutive stripes are located on different devices. */
+        uint32_t issued = 0;
+        while (n > 0 && issued < nvmstripep->config->nvm_num)
+        {
+            uint32_t dev;
+            uint32_t devaddr;
+            uint32_t len = nvm_stripe_locate(nvmstripep, startaddr, &dev,
+                    &devaddr);
+            if (len > n)
+                len = n;
+
+            result = nvm_stripe_issue(nvmstripep, issued, dev, false,
+                    devaddr, len, buffer);
+            if (result != HAL_SUCCESS)
+                break;
+            ++issued;
+
+            startaddr += len;
+            buffer += len;
+            n -= len;
+        }
+
+        if (nvm_stripe_wait(nvmstripep, issued) != HAL_SUCCESS)
+            result = HAL_FAILED;
+    }
+
+    return result;
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ * @details Every device erases its part of the range at once.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] startaddr     address within to be erased sector
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeErase(NVMStripeDriver* nvmstripep, uint32_t startaddr,
+        uint32_t n)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+    /* Verify range is within stripe size. */
+    osalDbgAssert((startaddr + n <= nvmstripep->size), "invalid parameters");
+
+    /* Erase whole sectors of the striped device. */
+    const uint32_t endaddr = (startaddr + n + nvmstripep->sector_size - 1) /
+            nvmstripep->sector_size * nvmstripep->sector_size;
+    startaddr -= startaddr % nvmstripep->sector_size;
+
+    /* Erase operation in progress. */
+    nvmstripep->state = NVM_ERASING;
+
+    bool result = HAL_SUCCESS;
+    uint32_t issued = 0;
+
+    for (uint32_t i = 0; i < nvmstripep->config->nvm_num; ++i)
+    {
+        const uint32_t first = nvm_stripe_bound(nvmstripep, startaddr, i);
+        const uint32_t last = nvm_stripe_bound(nvmstripep, endaddr, i);
+        if (last <= first)
+            continue;
+
+        result = nvm_stripe_issue(nvmstripep, issued, i, true, first,
+                last - first, NULL);
+        if (result != HAL_SUCCESS)
+            break;
+        ++issued;
+    }
+
+    if (nvm_stripe_wait(nvmstripep, issued) != HAL_SUCCESS)
+        result = HAL_FAILED;
+
+    return result;
+}
+
+/**
+ * @brief   Erases all sectors.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeMassErase(NVMStripeDriver* nvmstripep)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+
+    /* Erase operation in progress. */
+    nvmstripep->state = NVM_ERASING;
+
+    for (uint32_t i = 0; i < nvmstripep->config->nvm_num; ++i)
+    {
+        bool result = nvmMassErase(nvmstripep->config->nvmps[i]);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Waits for idle condition.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeSync(NVMStripeDriver* nvmstripep)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+
+    if (nvmstripep->state == NVM_READY)
+        return HAL_SUCCESS;
+
+    for (uint32_t i = 0; i < nvmstripep->config->nvm_num; ++i)
+    {
+        bool result = nvmSync(nvmstripep->config->nvmps[i]);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    /* No more operation in progress. */
+    nvmstripep->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns media info.
+ * @details Identification and timing are the ones of the first device.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeGetInfo(NVMStripeDriver* nvmstripep, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+
+    memcpy(nvmdip, &nvmstripep->llnvmdi, sizeof(*nvmdip));
+    nvmdip->sector_size = nvmstripep->sector_size;
+    nvmdip->sector_num = nvmstripep->size / nvmstripep->sector_size;
+    if (nvmdip->page_size > nvmstripep->config->stripe_size)
+        nvmdip->page_size = nvmstripep->config->stripe_size;
+    memset(nvmdip->erase_sizes, 0, sizeof(nvmdip->erase_sizes));
+    nvmdip->erase_sizes[0] = nvmstripep->sector_size;
+    nvmdip->memory_mapped = false;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Gains exclusive access to the nvm stripe device.
+ * @details This function tries to gain ownership to the nvm stripe device,
+ *          if the device is already being used then the invoking thread
+ *          is queued.
+ * @pre     In order to use this function the option
+ *          @p NVM_STRIPE_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ *
+ * @api
+ */
+void nvmstripeAcquireBus(NVMStripeDriver* nvmstripep)
+{
+    osalDbgCheck(nvmstripep != NULL);
+
+#if NVM_STRIPE_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&nvmstripep->mutex);
+
+    /* Lock the underlying devices as well. */
+    for (uint32_t i = 0; i < nvmstripep->config->nvm_num; ++i)
+        nvmAcquire(nvmstripep->config->nvmps[i]);
+#endif /* NVM_STRIPE_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the nvm stripe device.
+ * @pre     In order to use this function the option
+ *          @p NVM_STRIPE_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ *
+ * @api
+ */
+void nvmstripeReleaseBus(NVMStripeDriver* nvmstripep)
+{
+    osalDbgCheck(nvmstripep != NULL);
+
+#if NVM_STRIPE_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&nvmstripep->mutex);
+
+    /* Release the underlying devices as well. */
+    for (uint32_t i = nvmstripep->config->nvm_num; i > 0; --i)
+        nvmRelease(nvmstripep->config->nvmps[i - 1]);
+#endif /* NVM_STRIPE_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Write protects one or more sectors.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] startaddr     address within to be protected sector
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeWriteProtect(NVMStripeDriver* nvmstripep,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+    /* Verify range is within stripe size. */
+    osalDbgAssert((startaddr + n <= nvmstripep->size), "invalid parameters");
+
+    for (uint32_t i = 0; i < nvmstripep->config->nvm_num; ++i)
+    {
+        const uint32_t first = nvm_stripe_bound(nvmstripep, startaddr, i);
+        const uint32_t last = nvm_stripe_bound(nvmstripep, startaddr + n, i);
+        if (last <= first)
+            continue;
+
+        bool result = nvmWriteProtect(nvmstripep->config->nvmps[i], first,
+                last - first);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Write protects the whole device.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeMassWriteProtect(NVMStripeDriver* nvmstripep)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+
+    for (uint32_t i = 0; i < nvmstripep->config->nvm_num; ++i)
+    {
+        bool result = nvmMassWriteProtect(nvmstripep->config->nvmps[i]);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Write unprotects one or more sectors.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] startaddr     address within to be unprotected sector
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeWriteUnprotect(NVMStripeDriver* nvmstripep,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+    /* Verify range is within stripe size. */
+    osalDbgAssert((startaddr + n <= nvmstripep->size), "invalid parameters");
+
+    for (uint32_t i = 0; i < nvmstripep->config->nvm_num; ++i)
+    {
+        const uint32_t first = nvm_stripe_bound(nvmstripep, startaddr, i);
+        const uint32_t last = nvm_stripe_bound(nvmstripep, startaddr + n, i);
+        if (last <= first)
+            continue;
+
+        bool result = nvmWriteUnprotect(nvmstripep->config->nvmps[i], first,
+                last - first);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeMassWriteUnprotect(NVMStripeDriver* nvmstripep)
+{
+    osalDbgCheck(nvmstripep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+
+    for (uint32_t i = 0; i < nvmstripep->config->nvm_num; ++i)
+    {
+        bool result = nvmMassWriteUnprotect(nvmstripep->config->nvmps[i]);
+        if (result != HAL_SUCCESS)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Checks whether a range is erased.
+ *
+ * @param[in] nvmstripep    pointer to the @p NVMStripeDriver object
+ * @param[in] startaddr     first address to check
+ * @param[in] n             number of bytes to check
+ * @param[out] erasedp      set to @p true if all bytes are erased
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmstripeIsErased(NVMStripeDriver* nvmstripep, uint32_t startaddr,
+        uint32_t n, bool* erasedp)
+{
+    osalDbgCheck((nvmstripep != NULL) && (erasedp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmstripep->state >= NVM_READY, "invalid state");
+    /* Verify range is within stripe size. */
+    osalDbgAssert((startaddr + n <= nvmstripep->size), "invalid parameters");
+
+    *erasedp = true;
+
+    for (uint32_t i = 0; i < nvmstripep->config->nvm_num; ++i)
+    {
+        const uint32_t first = nvm_stripe_bound(nvmstripep, startaddr, i);
+        const uint32_t last = nvm_stripe_bound(nvmstripep, startaddr + n, i);
+        if (last <= first)
+            continue;
+
+        bool result = nvmIsErased(nvmstripep->config->nvmps[i], first,
+                last - first, erasedp);
+        if (result != HAL_SUCCESS || *erasedp == false)
+            return result;
+    }
+
+    return HAL_SUCCESS;
+}
+
+#endif /* HAL_USE_NVM_STRIPE */
+
+/** @} */
@@ -0,0 +1,602 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_trace.c
+ * @brief   NVM trace driver code.
+ *
+ * @addtogroup NVM_TRACE
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_TRACE || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          All operations are passed on to the underlying device unchanged.
+ *          Reads, writes, erases and syncs are counted together with the
+ *          number of bytes and the latency of each call. Placing a trace
+ *          driver above and below another layer shows the amplification
+ *          and the time spent within that layer.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMTraceDriverVMT nvm_trace_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmtraceRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmtraceWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmtraceErase,
+    .mass_erase = (bool (*)(void*))nvmtraceMassErase,
+    .sync = (bool (*)(void*))nvmtraceSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmtraceGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))nvmtraceAcquireBus,
+    .release = (void (*)(void*))nvmtraceReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmtraceWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmtraceMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmtraceWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmtraceMassWriteUnprotect,
+    .readv = (bool (*)(void*, const NVMReadSegment*, uint32_t))nvmtraceReadv,
+    .writev = (bool (*)(void*, const NVMWriteSegment*, uint32_t))nvmtraceWritev,
+    .is_erased = (bool (*)(void*, uint32_t, uint32_t, bool*))nvmtraceIsErased,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t nvm_trace_now(void)
+{
+#if NVM_TRACE_USE_DWT
+    return DWT->CYCCNT;
+#else
+    return (uint32_t)osalOsGetSystemTimeX();
+#endif /* NVM_TRACE_USE_DWT */
+}
+
+static uint32_t nvm_trace_elapsed(uint32_t start)
+{
+#if NVM_TRACE_USE_DWT
+    return DWT->CYCCNT - start;
+#else
+    /* Wrap around at the width of the system time. */
+    return (uint32_t)(systime_t)(osalOsGetSystemTimeX() - (systime_t)start);
+#endif /* NVM_TRACE_USE_DWT */
+}
+
+/**
+ * @brief   Accounts a finished call.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] opp           pointer to the statistics of the operation
+ * @param[in] n             number of bytes passed to the call
+ * @param[in] start         time stamp taken before the call
+ * @param[in] result        result of the call
+ *
+ * @notapi
+ */
+static void nvm_trace_account(NVMTraceDriver* nvmtracep,
+        NVMTraceOpStats* opp, uint32_t n, uint32_t start, bool result)
+{
+    (void)nvmtracep;
+
+    const uint32_t elapsed = nvm_trace_elapsed(start);
+    const uint32_t scaled = elapsed >> NVM_TRACE_HISTOGRAM_SHIFT;
+
+    /* Bin index is the number of significant bits. */
+    uint32_t bin = 0;
+    while (bin < NVM_TRACE_HISTOGRAM_BINS - 1 && bin < 32 &&
+            (scaled >> bin) != 0)
+        ++bin;
+
+    osalSysLock();
+    ++opp->calls;
+    if (result != HAL_SUCCESS)
+        ++opp->failures;
+    opp->bytes += n;
+    opp->time_total += elapsed;
+    if (elapsed > opp->time_max)
+        opp->time_max = elapsed;
+    ++opp->histogram[bin];
+    osalSysUnlock();
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM trace driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmtraceInit(void)
+{
+#if NVM_TRACE_USE_DWT
+    /* Enable the cycle counter. */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif /* NVM_TRACE_USE_DWT */
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmtracep    pointer to the @p NVMTraceDriver object
+ *
+ * @init
+ */
+void nvmtraceObjectInit(NVMTraceDriver* nvmtracep)
+{
+    nvmtracep->vmt = &nvm_trace_vmt;
+    nvmtracep->state = NVM_STOP;
+    nvmtracep->config = NULL;
+    memset(&nvmtracep->stats, 0, sizeof(nvmtracep->stats));
+}
+
+/**
+ * @brief   Configures and activates the NVM trace.
+ * @details Statistics are reset.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] config        pointer to the @p NVMTraceConfig object.
+ *
+ * @api
+ */
+void nvmtraceStart(NVMTraceDriver* nvmtracep, const NVMTraceConfig* config)
+{
+    osalDbgCheck((nvmtracep != NULL) && (config != NULL));
+    /* Verify device status. */
+    osalDbgAssert((nvmtracep->state == NVM_STOP) || (nvmtracep->state == NVM_READY),
+            "invalid state");
+
+    nvmtracep->config = config;
+
+    nvmGetInfo(nvmtracep->config->nvmp, &nvmtracep->llnvmdi);
+    memset(&nvmtracep->stats, 0, sizeof(nvmtracep->stats));
+
+    nvmtracep->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the NVM trace.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ *
+ * @api
+ */
+void nvmtraceStop(NVMTraceDriver* nvmtracep)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmtracep->state == NVM_STOP) || (nvmtracep->state == NVM_READY),
+            "invalid state");
+
+    nvmtracep->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceRead(NVMTraceDriver* nvmtracep, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    const uint32_t start = nvm_trace_now();
+    bool result = nvmRead(nvmtracep->config->nvmp, startaddr, n, buffer);
+    nvm_trace_account(nvmtracep, &nvmtracep->stats.read, n, start, result);
+
+    return result;
+}
+
+/**
+ * @brief   Writes data crossing sector boundaries if required.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceWrite(NVMTraceDriver* nvmtracep, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    const uint32_t start = nvm_trace_now();
+    bool result = nvmWrite(nvmtracep->config->nvmp, startaddr, n, buffer);
+    nvm_trace_account(nvmtracep, &nvmtracep->stats.write, n, start, result);
+
+    return result;
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] startaddr     address within to be erased sector
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceErase(NVMTraceDriver* nvmtracep, uint32_t startaddr,
+        uint32_t n)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    const uint32_t start = nvm_trace_now();
+    bool result = nvmErase(nvmtracep->config->nvmp, startaddr, n);
+    nvm_trace_account(nvmtracep, &nvmtracep->stats.erase, n, start, result);
+
+    return result;
+}
+
+/**
+ * @brief   Erases all sectors.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceMassErase(NVMTraceDriver* nvmtracep)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    const uint32_t start = nvm_trace_now();
+    bool result = nvmMassErase(nvmtracep->config->nvmp);
+    nvm_trace_account(nvmtracep, &nvmtracep->stats.erase,
+            nvmtracep->llnvmdi.sector_size * nvmtracep->llnvmdi.sector_num,
+            start, result);
+
+    return result;
+}
+
+/**
+ * @brief   Waits for idle condition.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceSync(NVMTraceDriver* nvmtracep)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    const uint32_t start = nvm_trace_now();
+    bool result = nvmSync(nvmtracep->config->nvmp);
+    nvm_trace_account(nvmtracep, &nvmtracep->stats.sync, 0, start, result);
+
+    return result;
+}
+
+/**
+ * @brief   Returns media info.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceGetInfo(NVMTraceDriver* nvmtracep, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    return nvmGetInfo(nvmtracep->config->nvmp, nvmdip);
+}
+
+/**
+ * @brief   Gains exclusive access to the underlying nvm device.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ *
+ * @api
+ */
+void nvmtraceAcquireBus(NVMTraceDriver* nvmtracep)
+{
+    osalDbgCheck(nvmtracep != NULL);
+
+    nvmAcquire(nvmtracep->config->nvmp);
+}
+
+/**
+ * @brief   Releases exclusive access to the underlying nvm device.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ *
+ * @api
+ */
+void nvmtraceReleaseBus(NVMTraceDriver* nvmtracep)
+{
+    osalDbgCheck(nvmtracep != NULL);
+
+    nvmRelease(nvmtracep->config->nvmp);
+}
+
+/**
+ * @brief   Write protects one or more sectors.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] startaddr     address within to be protected sector
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceWriteProtect(NVMTraceDriver* nvmtracep,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    return nvmWriteProtect(nvmtracep->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write protects the whole device.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceMassWriteProtect(NVMTraceDriver* nvmtracep)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteProtect(nvmtracep->config->nvmp);
+}
+
+/**
+ * @brief   Write unprotects one or more sectors.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] startaddr     address within to be unprotected sector
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceWriteUnprotect(NVMTraceDriver* nvmtracep,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    return nvmWriteUnprotect(nvmtracep->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceMassWriteUnprotect(NVMTraceDriver* nvmtracep)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteUnprotect(nvmtracep->config->nvmp);
+}
+
+/**
+ * @brief   Reads multiple segments.
+ * @details Accounted as a single read of all segment bytes.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] segp          pointer to an array of @p NVMReadSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceReadv(NVMTraceDriver* nvmtracep, const NVMReadSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmtracep != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < segn; ++i)
+        n += segp[i].n;
+
+    const uint32_t start = nvm_trace_now();
+    bool result = nvmReadv(nvmtracep->config->nvmp, segp, segn);
+    nvm_trace_account(nvmtracep, &nvmtracep->stats.read, n, start, result);
+
+    return result;
+}
+
+/**
+ * @brief   Writes multiple segments.
+ * @details Accounted as a single write of all segment bytes.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] segp          pointer to an array of @p NVMWriteSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceWritev(NVMTraceDriver* nvmtracep, const NVMWriteSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmtracep != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < segn; ++i)
+        n += segp[i].n;
+
+    const uint32_t start = nvm_trace_now();
+    bool result = nvmWritev(nvmtracep->config->nvmp, segp, segn);
+    nvm_trace_account(nvmtracep, &nvmtracep->stats.write, n, start, result);
+
+    return result;
+}
+
+/**
+ * @brief   Checks whether a range is erased.
+ * @note    Not accounted, the check is passed on directly.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[in] startaddr     first address to check
+ * @param[in] n             number of bytes to check
+ * @param[out] erasedp      set to @p true if all bytes are erased
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmtraceIsErased(NVMTraceDriver* nvmtracep, uint32_t startaddr,
+        uint32_t n, bool* erasedp)
+{
+    osalDbgCheck(nvmtracep != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmtracep->state >= NVM_READY, "invalid state");
+
+    return nvmIsErased(nvmtracep->config->nvmp, startaddr, n, erasedp);
+}
+
+/**
+ * @brief   Returns a consistent snapshot of the statistics.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ * @param[out] statsp       pointer to a @p NVMTraceStats structure
+ *
+ * @api
+ */
+void nvmtraceGetStats(NVMTraceDriver* nvmtracep, NVMTraceStats* statsp)
+{
+    osalDbgCheck((nvmtracep != NULL) && (statsp != NULL));
+
+    osalSysLock();
+    *statsp = nvmtracep->stats;
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Resets all statistics to zero.
+ *
+ * @param[in] nvmtracep     pointer to the @p NVMTraceDriver object
+ *
+ * @api
+ */
+void nvmtraceResetStats(NVMTraceDriver* nvmtracep)
+{
+    osalDbgCheck(nvmtracep != NULL);
+
+    osalSysLock();
+    memset(&nvmtracep->stats, 0, sizeof(nvmtracep->stats));
+    osalSysUnlock();
+}
+
+#endif /* HAL_USE_NVM_TRACE */
+
+/** @} */
@@ -0,0 +1,891 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_wear.c
+ * @brief   NVM wear monitor driver code.
+ *
+ * @addtogroup NVM_WEAR
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_WEAR || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          Operations are passed on to the underlying device, erases
+ *          increment the counters of all sectors they touch. The device
+ *          is reduced by two areas at its end holding snapshots of the
+ *          counters, each area large enough for at least one snapshot.
+ *          A snapshot consists of a header holding a magic, the sequence
+ *          number, the number of counters and a CRC followed by the
+ *          counters. The counters are programmed before the header, so a
+ *          snapshot is valid once its header is.
+ *          Snapshots are appended to the current area. When it is full the
+ *          other area is erased and used, so the previous snapshot is kept
+ *          until a newer one has been stored. On start the snapshot with
+ *          the highest sequence number is loaded.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of counters checked per read on start.
+ */
+#define NVM_WEAR_CHUNK                      16
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMWearDriverVMT nvm_wear_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmwearRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmwearWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmwearErase,
+    .mass_erase = (bool (*)(void*))nvmwearMassErase,
+    .sync = (bool (*)(void*))nvmwearSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmwearGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))nvmwearAcquireBus,
+    .release = (void (*)(void*))nvmwearReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmwearWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmwearMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmwearWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmwearMassWriteUnprotect,
+    .readv = (bool (*)(void*, const NVMReadSegment*, uint32_t))nvmwearReadv,
+    .writev = (bool (*)(void*, const NVMWriteSegment*, uint32_t))nvmwearWritev,
+    .is_erased = (bool (*)(void*, uint32_t, uint32_t, bool*))nvmwearIsErased,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t nvm_wear_crc32(uint32_t crc, const uint8_t* datap, uint32_t n)
+{
+    crc = ~crc;
+    while (n--)
+    {
+        crc ^= *datap++;
+        for (uint32_t i = 0; i < 8; ++i)
+            crc = (crc >> 1) ^ (0xedb88320UL & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static uint32_t nvm_wear_size(NVMWearDriver* nvmwearp)
+{
+    return nvmwearp->sector_num * nvmwearp->llnvmdi.sector_size;
+}
+
+static uint32_t nvm_wear_area_addr(NVMWearDriver* nvmwearp, uint32_t area)
+{
+    return (nvmwearp->sector_num + area * nvmwearp->area_sectors) *
+            nvmwearp->llnvmdi.sector_size;
+}
+
+static uint32_t nvm_wear_slot_num(NVMWearDriver* nvmwearp)
+{
+    return nvmwearp->area_sectors * nvmwearp->llnvmdi.sector_size /
+            nvmwearp->stride;
+}
+
+/**
+ * @brief   Counts an erase of the sectors holding a range.
+ */
+static void nvm_wear_count(NVMWearDriver* nvmwearp, uint32_t startaddr,
+        uint32_t n)
+{
+    const uint32_t sector_size = nvmwearp->llnvmdi.sector_size;
+
+    if (n == 0)
+        return;
+
+    for (uint32_t sector = startaddr / sector_size;
+            sector <= (startaddr + n - 1) / sector_size; ++sector)
+    {
+        nvmwearp->config->counts[sector] += 1;
+        nvmwearp->pending += 1;
+    }
+}
+
+/**
+ * @brief   Checks the CRC of the counters of a snapshot on the device.
+ */
+static bool nvm_wear_check(NVMWearDriver* nvmwearp, uint32_t addr,
+        const uint32_t* header, bool* validp)
+{
+    const uint32_t count_num = nvmwearp->llnvmdi.sector_num;
+    uint32_t counts[NVM_WEAR_CHUNK];
+    uint32_t crc = nvm_wear_crc32(0, (const uint8_t*)&header[1],
+            sizeof(header[1]));
+
+    *validp = false;
+
+    if (header[0] != NVM_WEAR_MAGIC || header[2] != count_num)
+        return HAL_SUCCESS;
+
+    for (uint32_t i = 0; i < count_num; i += NVM_WEAR_CHUNK)
+    {
+        uint32_t n = count_num - i;
+        if (n > NVM_WEAR_CHUNK)
+            n = NVM_WEAR_CHUNK;
+
+        if (nvmRead(nvmwearp->config->nvmp,
+                addr + NVM_WEAR_HEADER_SIZE + i * sizeof(uint32_t),
+                n * sizeof(uint32_t), (uint8_t*)counts) != HAL_SUCCESS)
+            return HAL_FAILED;
+
+        crc = nvm_wear_crc32(crc, (const uint8_t*)counts,
+                n * sizeof(uint32_t));
+    }
+
+    *validp = (crc == header[3]);
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Loads the most recent snapshot.
+ * @details Snapshots are appended in order, so scanning an area stops at
+ *          the first erased slot. Sectors count from zero if there is no
+ *          valid snapshot.
+ */
+static bool nvm_wear_mount(NVMWearDriver* nvmwearp)
+{
+    const NVMWearConfig* config = nvmwearp->config;
+    const uint32_t slot_num = nvm_wear_slot_num(nvmwearp);
+    uint32_t header[NVM_WEAR_HEADER_SIZE / sizeof(uint32_t)];
+    uint32_t best_addr = 0;
+    bool found = false;
+
+    memset(config->counts, 0,
+            nvmwearp->llnvmdi.sector_num * sizeof(uint32_t));
+
+    /* Without snapshot the first one erases area 0. */
+    nvmwearp->area = NVM_WEAR_AREAS - 1;
+    nvmwearp->slot = slot_num;
+    nvmwearp->sequence = 0;
+    nvmwearp->pending = 0;
+
+    for (uint32_t area = 0; area < NVM_WEAR_AREAS; ++area)
+    {
+        const uint32_t area_addr = nvm_wear_area_addr(nvmwearp, area);
+        uint32_t slot;
+
+        for (slot = 0; slot < slot_num; ++slot)
+        {
+            const uint32_t addr = area_addr + slot * nvmwearp->stride;
+            bool erased;
+
+            if (nvmRead(config->nvmp, addr, sizeof(header),
+                    (uint8_t*)header) != HAL_SUCCESS)
+                return HAL_FAILED;
+
+            bool valid;
+            if (nvm_wear_check(nvmwearp, addr, header, &valid) !=
+                    HAL_SUCCESS)
+                return HAL_FAILED;
+
+            if (valid == true)
+            {
+                if (found == false ||
+                        (int32_t)(header[1] - nvmwearp->sequence) > 0)
+                {
+                    found = true;
+                    best_addr = addr;
+                    nvmwearp->sequence = header[1];
+                    nvmwearp->area = area;
+                    nvmwearp->slot = slot_num;
+                }
+                continue;
+            }
+
+            if (nvmIsErased(config->nvmp, addr, nvmwearp->stride,
+                    &erased) != HAL_SUCCESS)
+                return HAL_FAILED;
+
+            if (erased == true)
+                break;
+        }
+
+        /* Append after the last snapshot, skipping torn ones. */
+        if (found == true && nvmwearp->area == area)
+            nvmwearp->slot = slot;
+    }
+
+    if (found == false)
+        return HAL_SUCCESS;
+
+    return nvmRead(config->nvmp, best_addr + NVM_WEAR_HEADER_SIZE,
+            nvmwearp->llnvmdi.sector_num * sizeof(uint32_t),
+            (uint8_t*)config->counts);
+}
+
+/**
+ * @brief   Stores a snapshot of the counters.
+ */
+static bool nvm_wear_store(NVMWearDriver* nvmwearp)
+{
+    const NVMWearConfig* config = nvmwearp->config;
+    const uint32_t count_num = nvmwearp->llnvmdi.sector_num;
+    uint32_t header[NVM_WEAR_HEADER_SIZE / sizeof(uint32_t)];
+
+    if (nvmwearp->slot >= nvm_wear_slot_num(nvmwearp))
+    {
+        const uint32_t area = (nvmwearp->area + 1) % NVM_WEAR_AREAS;
+        const uint32_t addr = nvm_wear_area_addr(nvmwearp, area);
+        const uint32_t n = nvmwearp->area_sectors *
+                nvmwearp->llnvmdi.sector_size;
+
+        /* The erase is part of the snapshot written next. */
+        nvm_wear_count(nvmwearp, addr, n);
+        if (nvmErase(config->nvmp, addr, n) != HAL_SUCCESS)
+            return HAL_FAILED;
+
+        nvmwearp->area = area;
+        nvmwearp->slot = 0;
+    }
+
+    const uint32_t addr = nvm_wear_area_addr(nvmwearp, nvmwearp->area) +
+            nvmwearp->slot * nvmwearp->stride;
+    const uint32_t sequence = nvmwearp->sequence + 1;
+
+    /* A failed snapshot is skipped on start, append after it. */
+    nvmwearp->slot += 1;
+
+    header[0] = NVM_WEAR_MAGIC;
+    header[1] = sequence;
+    header[2] = count_num;
+    header[3] = nvm_wear_crc32(nvm_wear_crc32(0, (const uint8_t*)&sequence,
+            sizeof(sequence)), (const uint8_t*)config->counts,
+            count_num * sizeof(uint32_t));
+
+    if (nvmWrite(config->nvmp, addr + NVM_WEAR_HEADER_SIZE,
+            count_num * sizeof(uint32_t),
+            (const uint8_t*)config->counts) != HAL_SUCCESS ||
+            nvmWrite(config->nvmp, addr, sizeof(header),
+            (const uint8_t*)header) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    nvmwearp->sequence = sequence;
+    nvmwearp->pending = 0;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Stores a snapshot once enough erases have been counted.
+ */
+static bool nvm_wear_update(NVMWearDriver* nvmwearp)
+{
+    if (nvmwearp->config->batch == 0 ||
+            nvmwearp->pending < nvmwearp->config->batch)
+        return HAL_SUCCESS;
+
+    return nvm_wear_store(nvmwearp);
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM wear monitor driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmwearInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmwearp     pointer to the @p NVMWearDriver object
+ *
+ * @init
+ */
+void nvmwearObjectInit(NVMWearDriver* nvmwearp)
+{
+    nvmwearp->vmt = &nvm_wear_vmt;
+    nvmwearp->state = NVM_STOP;
+    nvmwearp->config = NULL;
+    nvmwearp->sector_num = 0;
+    nvmwearp->area_sectors = 0;
+    nvmwearp->stride = 0;
+    nvmwearp->area = 0;
+    nvmwearp->slot = 0;
+    nvmwearp->sequence = 0;
+    nvmwearp->pending = 0;
+#if NVM_WEAR_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&nvmwearp->mutex);
+#endif /* NVM_WEAR_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the NVM wear monitor.
+ * @details Loads the counters stored on the device.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] config        pointer to the @p NVMWearConfig object.
+ *
+ * @api
+ */
+void nvmwearStart(NVMWearDriver* nvmwearp, const NVMWearConfig* config)
+{
+    osalDbgCheck((nvmwearp != NULL) && (config != NULL));
+    osalDbgCheck(config->counts != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmwearp->state == NVM_STOP) ||
+            (nvmwearp->state == NVM_READY), "invalid state");
+
+    nvmwearp->config = config;
+
+    /* Calculate and cache often reused values. */
+    nvmGetInfo(nvmwearp->config->nvmp, &nvmwearp->llnvmdi);
+
+    osalDbgAssert(nvmwearp->llnvmdi.write_alignment <= sizeof(uint32_t),
+            "unsupported write alignment");
+
+    const uint32_t sector_size = nvmwearp->llnvmdi.sector_size;
+
+    nvmwearp->stride = NVM_WEAR_HEADER_SIZE +
+            nvmwearp->llnvmdi.sector_num * sizeof(uint32_t);
+    nvmwearp->area_sectors = (nvmwearp->stride + sector_size - 1) /
+            sector_size;
+
+    osalDbgAssert(nvmwearp->llnvmdi.sector_num >
+            NVM_WEAR_AREAS * nvmwearp->area_sectors, "too few sectors");
+
+    nvmwearp->sector_num = nvmwearp->llnvmdi.sector_num -
+            NVM_WEAR_AREAS * nvmwearp->area_sectors;
+
+    if (nvm_wear_mount(nvmwearp) != HAL_SUCCESS)
+    {
+        nvmwearp->state = NVM_STOP;
+        return;
+    }
+
+    nvmwearp->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the NVM wear monitor.
+ * @details Counts not yet stored are stored first.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ *
+ * @api
+ */
+void nvmwearStop(NVMWearDriver* nvmwearp)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmwearp->state == NVM_STOP) ||
+            (nvmwearp->state == NVM_READY), "invalid state");
+
+    if (nvmwearp->state == NVM_READY && nvmwearp->pending != 0 &&
+            nvm_wear_store(nvmwearp) == HAL_SUCCESS)
+        nvmSync(nvmwearp->config->nvmp);
+
+    nvmwearp->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearRead(NVMWearDriver* nvmwearp, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert(startaddr + n <= nvm_wear_size(nvmwearp),
+            "invalid parameters");
+
+    return nvmRead(nvmwearp->config->nvmp, startaddr, n, buffer);
+}
+
+/**
+ * @brief   Writes data crossing sector boundaries if required.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearWrite(NVMWearDriver* nvmwearp, uint32_t startaddr,
+        uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert(startaddr + n <= nvm_wear_size(nvmwearp),
+            "invalid parameters");
+
+    return nvmWrite(nvmwearp->config->nvmp, startaddr, n, buffer);
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ * @details Counts the erase even if it fails, as it may have worn the
+ *          sectors anyway.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] startaddr     address within to be erased sector
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearErase(NVMWearDriver* nvmwearp, uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert(startaddr + n <= nvm_wear_size(nvmwearp),
+            "invalid parameters");
+
+    nvm_wear_count(nvmwearp, startaddr, n);
+
+    bool result = nvmErase(nvmwearp->config->nvmp, startaddr, n);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    return nvm_wear_update(nvmwearp);
+}
+
+/**
+ * @brief   Erases all sectors.
+ * @details The snapshot areas are kept, so this erases all sectors
+ *          available to users.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearMassErase(NVMWearDriver* nvmwearp)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+
+    return nvmwearErase(nvmwearp, 0, nvm_wear_size(nvmwearp));
+}
+
+/**
+ * @brief   Waits for idle condition.
+ * @details Counts not yet stored are stored first.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearSync(NVMWearDriver* nvmwearp)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+
+    if (nvmwearp->pending != 0 && nvm_wear_store(nvmwearp) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    return nvmSync(nvmwearp->config->nvmp);
+}
+
+/**
+ * @brief   Returns media info.
+ * @note    Reports the underlying device without the snapshot areas.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearGetInfo(NVMWearDriver* nvmwearp, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+
+    *nvmdip = nvmwearp->llnvmdi;
+    nvmdip->sector_num = nvmwearp->sector_num;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Gains exclusive access to the nvm wear monitor device.
+ * @details This function tries to gain ownership to the nvm wear monitor
+ *          device, if the device is already being used then the invoking
+ *          thread is queued.
+ * @pre     In order to use this function the option
+ *          @p NVM_WEAR_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ *
+ * @api
+ */
+void nvmwearAcquireBus(NVMWearDriver* nvmwearp)
+{
+    osalDbgCheck(nvmwearp != NULL);
+
+#if NVM_WEAR_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&nvmwearp->mutex);
+
+    /* Lock the underlying device as well. */
+    nvmAcquire(nvmwearp->config->nvmp);
+#endif /* NVM_WEAR_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the nvm wear monitor device.
+ * @pre     In order to use this function the option
+ *          @p NVM_WEAR_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ *
+ * @api
+ */
+void nvmwearReleaseBus(NVMWearDriver* nvmwearp)
+{
+    osalDbgCheck(nvmwearp != NULL);
+
+#if NVM_WEAR_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&nvmwearp->mutex);
+
+    /* Release the underlying device as well. */
+    nvmRelease(nvmwearp->config->nvmp);
+#endif /* NVM_WEAR_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Write protects one or more sectors.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] startaddr     address within to be protected sector
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearWriteProtect(NVMWearDriver* nvmwearp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert(startaddr + n <= nvm_wear_size(nvmwearp),
+            "invalid parameters");
+
+    return nvmWriteProtect(nvmwearp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write protects the whole device.
+ * @details The snapshot areas stay writable.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearMassWriteProtect(NVMWearDriver* nvmwearp)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+
+    return nvmWriteProtect(nvmwearp->config->nvmp, 0,
+            nvm_wear_size(nvmwearp));
+}
+
+/**
+ * @brief   Write unprotects one or more sectors.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] startaddr     address within to be unprotected sector
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearWriteUnprotect(NVMWearDriver* nvmwearp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert(startaddr + n <= nvm_wear_size(nvmwearp),
+            "invalid parameters");
+
+    return nvmWriteUnprotect(nvmwearp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearMassWriteUnprotect(NVMWearDriver* nvmwearp)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+
+    return nvmWriteUnprotect(nvmwearp->config->nvmp, 0,
+            nvm_wear_size(nvmwearp));
+}
+
+/**
+ * @brief   Reads multiple segments.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] segp          pointer to an array of @p NVMReadSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearReadv(NVMWearDriver* nvmwearp, const NVMReadSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmwearp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+
+    return nvmReadv(nvmwearp->config->nvmp, segp, segn);
+}
+
+/**
+ * @brief   Writes multiple segments.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] segp          pointer to an array of @p NVMWriteSegment
+ * @param[in] segn          number of segments
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearWritev(NVMWearDriver* nvmwearp, const NVMWriteSegment* segp,
+        uint32_t segn)
+{
+    osalDbgCheck((nvmwearp != NULL) && (segp != NULL || segn == 0));
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+
+    return nvmWritev(nvmwearp->config->nvmp, segp, segn);
+}
+
+/**
+ * @brief   Checks whether a range is erased.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] startaddr     first address to check
+ * @param[in] n             number of bytes to check
+ * @param[out] erasedp      set to @p true if all bytes are erased
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwearIsErased(NVMWearDriver* nvmwearp, uint32_t startaddr,
+        uint32_t n, bool* erasedp)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert(startaddr + n <= nvm_wear_size(nvmwearp),
+            "invalid parameters");
+
+    return nvmIsErased(nvmwearp->config->nvmp, startaddr, n, erasedp);
+}
+
+/**
+ * @brief   Returns the erase count of a sector.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] sector        sector of this device
+ *
+ * @return                  The number of erases counted.
+ *
+ * @api
+ */
+uint32_t nvmwearGetEraseCount(NVMWearDriver* nvmwearp, uint32_t sector)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+    osalDbgAssert(sector < nvmwearp->sector_num, "invalid parameters");
+
+    return nvmwearp->config->counts[sector];
+}
+
+/**
+ * @brief   Finds the least worn sector of a range.
+ * @details Layers placing data pick the returned sector for their next
+ *          erase to level the wear.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[in] first         first sector to consider
+ * @param[in] n             number of sectors to consider
+ *
+ * @return                  The first sector having the lowest erase count.
+ *
+ * @api
+ */
+uint32_t nvmwearFindLeastWorn(NVMWearDriver* nvmwearp, uint32_t first,
+        uint32_t n)
+{
+    osalDbgCheck(nvmwearp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+    osalDbgAssert(n != 0 && first + n <= nvmwearp->sector_num,
+            "invalid parameters");
+
+    const uint32_t* counts = nvmwearp->config->counts;
+    uint32_t best = first;
+
+    for (uint32_t sector = first + 1; sector < first + n; ++sector)
+    {
+        if (counts[sector] < counts[best])
+            best = sector;
+    }
+
+    return best;
+}
+
+/**
+ * @brief   Returns a summary of the wear of the sectors of this device.
+ * @note    Acquire the bus for a consistent summary while other threads
+ *          erase.
+ *
+ * @param[in] nvmwearp      pointer to the @p NVMWearDriver object
+ * @param[out] statsp       pointer to a @p NVMWearStats structure
+ *
+ * @api
+ */
+void nvmwearGetStats(NVMWearDriver* nvmwearp, NVMWearStats* statsp)
+{
+    osalDbgCheck((nvmwearp != NULL) && (statsp != NULL));
+    /* Verify device status. */
+    osalDbgAssert(nvmwearp->state >= NVM_READY, "invalid state");
+
+    const uint32_t* counts = nvmwearp->config->counts;
+
+    statsp->total = 0;
+    statsp->min = counts[0];
+    statsp->max = counts[0];
+    statsp->coldest = 0;
+    statsp->hottest = 0;
+    statsp->pending = nvmwearp->pending;
+
+    for (uint32_t sector = 0; sector < nvmwearp->sector_num; ++sector)
+    {
+        statsp->total += counts[sector];
+        if (counts[sector] < statsp->min)
+        {
+            statsp->min = counts[sector];
+            statsp->coldest = sector;
+        }
+        if (counts[sector] > statsp->max)
+        {
+            statsp->max = counts[sector];
+            statsp->hottest = sector;
+        }
+    }
+}
+
+#endif /* HAL_USE_NVM_WEAR */
+
+/** @} */
@@ -0,0 +1,642 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qnvm_write_buffer.c
+ * @brief   NVM write buffer driver code.
+ *
+ * @addtogroup NVM_WRITE_BUFFER
+ * @{
+ */
+
+#include "qhal.h"
+
+#if HAL_USE_NVM_WRITE_BUFFER || defined(__DOXYGEN__)
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          Writes smaller than a unit are collected in a buffer holding a
+ *          single aligned unit. The buffer is loaded from the device when
+ *          taking a new unit so bytes not written keep their contents.
+ *          The modified range, widened to the write alignment of the
+ *          device, is written once the end of the unit has been written,
+ *          when a write targets another unit or on sync.
+ *          Writes of whole units bypass the buffer.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct NVMWriteBufferDriverVMT nvm_write_buffer_vmt =
+{
+    (size_t)0,
+    .read = (bool (*)(void*, uint32_t, uint32_t, uint8_t*))nvmwbufRead,
+    .write = (bool (*)(void*, uint32_t, uint32_t, const uint8_t*))nvmwbufWrite,
+    .erase = (bool (*)(void*, uint32_t, uint32_t))nvmwbufErase,
+    .mass_erase = (bool (*)(void*))nvmwbufMassErase,
+    .sync = (bool (*)(void*))nvmwbufSync,
+    .get_info = (bool (*)(void*, NVMDeviceInfo*))nvmwbufGetInfo,
+    /* End of mandatory functions. */
+    .acquire = (void (*)(void*))nvmwbufAcquireBus,
+    .release = (void (*)(void*))nvmwbufReleaseBus,
+    .writeprotect = (bool (*)(void*, uint32_t, uint32_t))nvmwbufWriteProtect,
+    .mass_writeprotect = (bool (*)(void*))nvmwbufMassWriteProtect,
+    .writeunprotect = (bool (*)(void*, uint32_t, uint32_t))nvmwbufWriteUnprotect,
+    .mass_writeunprotect = (bool (*)(void*))nvmwbufMassWriteUnprotect,
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static bool nvm_write_buffer_flush(NVMWriteBufferDriver* nvmwbufp)
+{
+    if (nvmwbufp->wbuf_valid == false ||
+            nvmwbufp->dirty_hi <= nvmwbufp->dirty_lo)
+        return HAL_SUCCESS;
+
+    /* Widen range to write alignment of the device. */
+    uint32_t alignment = nvmwbufp->wbuf_alignment;
+    uint32_t lo = nvmwbufp->dirty_lo - (nvmwbufp->dirty_lo % alignment);
+    uint32_t hi = nvmwbufp->dirty_hi +
+            (alignment - (nvmwbufp->dirty_hi % alignment)) % alignment;
+
+    bool result = nvmWrite(nvmwbufp->config->nvmp, nvmwbufp->wbuf_addr + lo,
+            hi - lo, nvmwbufp->buffer + lo);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    nvmwbufp->dirty_lo = 0;
+    nvmwbufp->dirty_hi = 0;
+
+    return HAL_SUCCESS;
+}
+
+static void nvm_write_buffer_drop(NVMWriteBufferDriver* nvmwbufp)
+{
+    nvmwbufp->wbuf_valid = false;
+    nvmwbufp->dirty_lo = 0;
+    nvmwbufp->dirty_hi = 0;
+}
+
+/**
+ * @brief   Stores a write within a single unit in the buffer.
+ *
+ * @param[in] nvmwbufp      pointer to the @p NVMWriteBufferDriver object
+ * @param[in] addr          unit aligned address
+ * @param[in] offset        offset of the write within the unit
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @notapi
+ */
+static bool nvm_write_buffer_store(NVMWriteBufferDriver* nvmwbufp,
+        uint32_t addr, uint32_t offset, uint32_t n, const uint8_t* buffer)
+{
+    bool result;
+
+    if (nvmwbufp->wbuf_valid == false || nvmwbufp->wbuf_addr != addr)
+    {
+        /* Buffer holds another unit. */
+        result = nvm_write_buffer_flush(nvmwbufp);
+        if (result != HAL_SUCCESS)
+            return result;
+        nvm_write_buffer_drop(nvmwbufp);
+
+        result = nvmRead(nvmwbufp->config->nvmp, addr, nvmwbufp->wbuf_unit,
+                nvmwbufp->buffer);
+        if (result != HAL_SUCCESS)
+            return result;
+        nvmwbufp->wbuf_addr = addr;
+        nvmwbufp->wbuf_valid = true;
+    }
+
+    memcpy(nvmwbufp->buffer + offset, buffer, n);
+
+    if (nvmwbufp->dirty_hi <= nvmwbufp->dirty_lo)
+    {
+        nvmwbufp->dirty_lo = offset;
+        nvmwbufp->dirty_hi = offset + n;
+    }
+    else
+    {
+        if (offset < nvmwbufp->dirty_lo)
+            nvmwbufp->dirty_lo = offset;
+        if (offset + n > nvmwbufp->dirty_hi)
+            nvmwbufp->dirty_hi = offset + n;
+    }
+
+    /* End of unit reached, no more writes expected. */
+    if (offset + n == nvmwbufp->wbuf_unit)
+        return nvm_write_buffer_flush(nvmwbufp);
+
+    return HAL_SUCCESS;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM write buffer driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void nvmwbufInit(void)
+{
+}
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] nvmwbufp     pointer to the @p NVMWriteBufferDriver object
+ *
+ * @init
+ */
+void nvmwbufObjectInit(NVMWriteBufferDriver* nvmwbufp)
+{
+    nvmwbufp->vmt = &nvm_write_buffer_vmt;
+    nvmwbufp->state = NVM_STOP;
+    nvmwbufp->config = NULL;
+    nvmwbufp->wbuf_size = 0;
+    nvmwbufp->wbuf_unit = 0;
+    nvmwbufp->wbuf_alignment = 1;
+    nvmwbufp->wbuf_addr = 0;
+    nvm_write_buffer_drop(nvmwbufp);
+#if NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION
+    osalMutexObjectInit(&nvmwbufp->mutex);
+#endif /* NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Configures and activates the NVM write buffer.
+ *
+ * @param[in] nvmwbufp      pointer to the @p NVMWriteBufferDriver object
+ * @param[in] config        pointer to the @p NVMWriteBufferConfig object.
+ *
+ * @api
+ */
+void nvmwbufStart(NVMWriteBufferDriver* nvmwbufp,
+        const NVMWriteBufferConfig* config)
+{
+    osalDbgCheck((nvmwbufp != NULL) && (config != NULL));
+    /* Verify device status. */
+    osalDbgAssert((nvmwbufp->state == NVM_STOP) || (nvmwbufp->state == NVM_READY),
+            "invalid state");
+
+    nvmwbufp->config = config;
+
+    /* Calculate and cache often reused values. */
+    nvmGetInfo(nvmwbufp->config->nvmp, &nvmwbufp->llnvmdi);
+    nvmwbufp->wbuf_size =
+            nvmwbufp->llnvmdi.sector_size * nvmwbufp->llnvmdi.sector_num;
+    nvmwbufp->wbuf_alignment = nvmwbufp->llnvmdi.write_alignment;
+    if (nvmwbufp->wbuf_alignment == 0)
+        nvmwbufp->wbuf_alignment = 1;
+    nvmwbufp->wbuf_unit = nvmwbufp->config->unit_size;
+    if (nvmwbufp->wbuf_unit == 0)
+        nvmwbufp->wbuf_unit = nvmwbufp->wbuf_alignment;
+
+    osalDbgAssert(nvmwbufp->wbuf_unit <= NVM_WRITE_BUFFER_SIZE &&
+            (nvmwbufp->wbuf_unit % nvmwbufp->wbuf_alignment) == 0 &&
+            (nvmwbufp->llnvmdi.sector_size % nvmwbufp->wbuf_unit) == 0,
+            "invalid unit size");
+
+    nvm_write_buffer_drop(nvmwbufp);
+
+    nvmwbufp->state = NVM_READY;
+}
+
+/**
+ * @brief   Disables the NVM write buffer.
+ *
+ * @param[in] nvmwbufp      pointer to the @p NVMWriteBufferDriver object
+ *
+ * @api
+ */
+void nvmwbufStop(NVMWriteBufferDriver* nvmwbufp)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert((nvmwbufp->state == NVM_STOP) || (nvmwbufp->state == NVM_READY),
+            "invalid state");
+
+    nvm_write_buffer_drop(nvmwbufp);
+
+    nvmwbufp->state = NVM_STOP;
+}
+
+/**
+ * @brief   Reads data crossing sector boundaries if required.
+ * @details Buffered data not yet written is taken into account.
+ *
+ * @param[in] nvmwbufp      pointer to the @p NVMWriteBufferDriver object
+ * @param[in] startaddr     address to start reading from
+ * @param[in] n             number of bytes to read
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufRead(NVMWriteBufferDriver* nvmwbufp, uint32_t startaddr,
+        uint32_t n, uint8_t* buffer)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert((startaddr + n <= nvmwbufp->wbuf_size), "invalid parameters");
+
+    nvmstate_t state = nvmwbufp->state;
+
+    /* Read operation in progress. */
+    nvmwbufp->state = NVM_READING;
+
+    bool result = nvmRead(nvmwbufp->config->nvmp, startaddr, n, buffer);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* Overlay buffered unit. */
+    if (nvmwbufp->wbuf_valid == true &&
+            nvmwbufp->dirty_hi > nvmwbufp->dirty_lo)
+    {
+        uint32_t lo = nvmwbufp->wbuf_addr + nvmwbufp->dirty_lo;
+        uint32_t hi = nvmwbufp->wbuf_addr + nvmwbufp->dirty_hi;
+        if (lo < startaddr)
+            lo = startaddr;
+        if (hi > startaddr + n)
+            hi = startaddr + n;
+        if (lo < hi)
+            memcpy(buffer + (lo - startaddr),
+                    nvmwbufp->buffer + (lo - nvmwbufp->wbuf_addr), hi - lo);
+    }
+
+    /* Read operation finished. */
+    nvmwbufp->state = state;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes data crossing sector boundaries if required.
+ * @details Parts smaller than a unit are buffered, whole units are
+ *          written directly.
+ *
+ * @param[in] nvmwbufp      pointer to the @p NVMWriteBufferDriver object
+ * @param[in] startaddr     address to start writing to
+ * @param[in] n             number of bytes to write
+ * @param[in] buffer        pointer to data buffer
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufWrite(NVMWriteBufferDriver* nvmwbufp, uint32_t startaddr,
+       uint32_t n, const uint8_t* buffer)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert((startaddr + n <= nvmwbufp->wbuf_size), "invalid parameters");
+
+    /* Write operation in progress. */
+    nvmwbufp->state = NVM_WRITING;
+
+    uint32_t unit = nvmwbufp->wbuf_unit;
+
+    while (n > 0)
+    {
+        bool result;
+        uint32_t offset = startaddr % unit;
+        uint32_t addr = startaddr - offset;
+
+        if (offset == 0 && n >= unit)
+        {
+            /* Whole units replace buffered data. */
+            uint32_t len = n - (n % unit);
+            if (nvmwbufp->wbuf_valid == true &&
+                    nvmwbufp->wbuf_addr >= startaddr &&
+                    nvmwbufp->wbuf_addr < startaddr + len)
+                nvm_write_buffer_drop(nvmwbufp);
+
+            result = nvmWrite(nvmwbufp->config->nvmp, startaddr, len, buffer);
+            if (result != HAL_SUCCESS)
+                return result;
+
+            startaddr += len;
+            buffer += len;
+            n -= len;
+            continue;
+        }
+
+        uint32_t len = unit - offset;
+        if (len > n)
+            len = n;
+
+        result = nvm_write_buffer_store(nvmwbufp, addr, offset, len, buffer);
+        if (result != HAL_SUCCESS)
+            return result;
+
+        startaddr += len;
+        buffer += len;
+        n -= len;
+    }
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases one or more sectors.
+ * @details Buffered data within the erased sectors is dropped.
+ *
+ * @param[in] nvmwbufp      pointer to the @p NVMWriteBufferDriver object
+ * @param[in] startaddr     address within to be erased sector
+ * @param[in] n             number of bytes to erase
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufErase(NVMWriteBufferDriver* nvmwbufp, uint32_t startaddr,
+        uint32_t n)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+    /* Verify range is within device size. */
+    osalDbgAssert((startaddr + n <= nvmwbufp->wbuf_size), "invalid parameters");
+
+    /* Erase operation in progress. */
+    nvmwbufp->state = NVM_ERASING;
+
+    /* Whole sectors are being erased. */
+    uint32_t sector_size = nvmwbufp->llnvmdi.sector_size;
+    uint32_t first = startaddr - (startaddr % sector_size);
+    uint32_t end = startaddr + n;
+    end += (sector_size - (end % sector_size)) % sector_size;
+    if (nvmwbufp->wbuf_valid == true &&
+            nvmwbufp->wbuf_addr >= first &&
+            nvmwbufp->wbuf_addr < end)
+        nvm_write_buffer_drop(nvmwbufp);
+
+    return nvmErase(nvmwbufp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Erases all sectors.
+ *
+ * @param[in] nvmwbufp      pointer to the @p NVMWriteBufferDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufMassErase(NVMWriteBufferDriver* nvmwbufp)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+
+    /* Erase operation in progress. */
+    nvmwbufp->state = NVM_ERASING;
+
+    nvm_write_buffer_drop(nvmwbufp);
+
+    return nvmMassErase(nvmwbufp->config->nvmp);
+}
+
+/**
+ * @brief   Waits for idle condition.
+ * @details Writes buffered data first.
+ *
+ * @param[in] nvmwbufp      pointer to the @p NVMWriteBufferDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufSync(NVMWriteBufferDriver* nvmwbufp)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+
+    if (nvmwbufp->state == NVM_READY)
+        return HAL_SUCCESS;
+
+    bool result = nvm_write_buffer_flush(nvmwbufp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    result = nvmSync(nvmwbufp->config->nvmp);
+    if (result != HAL_SUCCESS)
+        return result;
+
+    /* No more operation in progress. */
+    nvmwbufp->state = NVM_READY;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns media info.
+ * @note    Reports no write alignment as it is handled by the buffer.
+ *
+ * @param[in] nvmwbufp      pointer to the @p NVMWriteBufferDriver object
+ * @param[out] nvmdip       pointer to a @p NVMDeviceInfo structure
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufGetInfo(NVMWriteBufferDriver* nvmwbufp, NVMDeviceInfo* nvmdip)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+
+    memcpy(nvmdip, &nvmwbufp->llnvmdi, sizeof(*nvmdip));
+    nvmdip->write_alignment = 0;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Gains exclusive access to the nvm write buffer device.
+ * @details This function tries to gain ownership to the nvm write buffer device,
+ *          if the device is already being used then the invoking thread
+ *          is queued.
+ * @pre     In order to use this function the option
+ *          @p NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmwbufp     pointer to the @p NVMWriteBufferDriver object
+ *
+ * @api
+ */
+void nvmwbufAcquireBus(NVMWriteBufferDriver* nvmwbufp)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+
+#if NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexLock(&nvmwbufp->mutex);
+
+    /* Lock the underlying device as well. */
+    nvmAcquire(nvmwbufp->config->nvmp);
+#endif /* NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Releases exclusive access to the nvm write buffer device.
+ * @pre     In order to use this function the option
+ *          @p NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION must be enabled.
+ *
+ * @param[in] nvmwbufp     pointer to the @p NVMWriteBufferDriver object
+ *
+ * @api
+ */
+void nvmwbufReleaseBus(NVMWriteBufferDriver* nvmwbufp)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+
+#if NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+    osalMutexUnlock(&nvmwbufp->mutex);
+
+    /* Release the underlying device as well. */
+    nvmRelease(nvmwbufp->config->nvmp);
+#endif /* NVM_WRITE_BUFFER_USE_MUTUAL_EXCLUSION */
+}
+
+/**
+ * @brief   Write protects one or more sectors.
+ *
+ * @param[in] nvmwbufp     pointer to the @p NVMWriteBufferDriver object
+ * @param[in] startaddr     address within to be protected sector
+ * @param[in] n             number of bytes to protect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufWriteProtect(NVMWriteBufferDriver* nvmwbufp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+
+    return nvmWriteProtect(nvmwbufp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write protects the whole device.
+ *
+ * @param[in] nvmwbufp     pointer to the @p NVMWriteBufferDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufMassWriteProtect(NVMWriteBufferDriver* nvmwbufp)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteProtect(nvmwbufp->config->nvmp);
+}
+
+/**
+ * @brief   Write unprotects one or more sectors.
+ *
+ * @param[in] nvmwbufp     pointer to the @p NVMWriteBufferDriver object
+ * @param[in] startaddr     address within to be unprotected sector
+ * @param[in] n             number of bytes to unprotect
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufWriteUnprotect(NVMWriteBufferDriver* nvmwbufp,
+        uint32_t startaddr, uint32_t n)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+
+    return nvmWriteUnprotect(nvmwbufp->config->nvmp, startaddr, n);
+}
+
+/**
+ * @brief   Write unprotects the whole device.
+ *
+ * @param[in] nvmwbufp     pointer to the @p NVMWriteBufferDriver object
+ *
+ * @return                  The operation status.
+ * @retval HAL_SUCCESS      the operation succeeded.
+ * @retval HAL_FAILED       the operation failed.
+ *
+ * @api
+ */
+bool nvmwbufMassWriteUnprotect(NVMWriteBufferDriver* nvmwbufp)
+{
+    osalDbgCheck(nvmwbufp != NULL);
+    /* Verify device status. */
+    osalDbgAssert(nvmwbufp->state >= NVM_READY, "invalid state");
+
+    return nvmMassWriteUnprotect(nvmwbufp->config->nvmp);
+}
+
+#endif /* HAL_USE_NVM_WRITE_BUFFER */
+
+/** @} */
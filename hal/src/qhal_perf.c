@@ -0,0 +1,200 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qhal_perf.c
+ * @brief   Performance counters code.
+ *
+ * @addtogroup HAL
+ * @{
+ */
+
+#include "qhal.h"
+
+#if QHAL_USE_PERF || defined(__DOXYGEN__)
+
+#include "chprintf.h"
+
+#include <string.h>
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Performance counters initialization.
+ * @note    This function is implicitly invoked by @p qhalInit(), there is
+ *          no need to explicitly initialize the module.
+ *
+ * @init
+ */
+void qhalPerfInit(void)
+{
+#if QHAL_PERF_CLOCK == QHAL_PERF_CLOCK_CYCLES
+    /* Enable the cycle counter. */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ * @brief   Adds to a counter.
+ *
+ * @param[in] statsp    pointer to the counter statistics
+ * @param[in] n         value to add
+ *
+ * @xclass
+ */
+void qhalPerfAddX(QHALPerfStats *statsp, uint32_t n)
+{
+    syssts_t sts = osalSysGetStatusAndLockX();
+    statsp->count += n;
+    osalSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Accounts a finished region run.
+ *
+ * @param[in] statsp    pointer to the region statistics
+ * @param[in] begin     time stamp taken at the begin of the run
+ *
+ * @xclass
+ */
+void qhalPerfAccountX(QHALPerfStats *statsp, qhalperftime_t begin)
+{
+#if QHAL_PERF_CLOCK == QHAL_PERF_CLOCK_TICKS
+    /* Wrap around at the width of the system time. */
+    qhalperftime_t elapsed =
+            (qhalperftime_t)(systime_t)(qhalPerfNowX() - begin);
+#else
+    qhalperftime_t elapsed = qhalPerfNowX() - begin;
+#endif
+
+    syssts_t sts = osalSysGetStatusAndLockX();
+    if (statsp->count == 0 || elapsed < statsp->time_min)
+        statsp->time_min = elapsed;
+    if (elapsed > statsp->time_max)
+        statsp->time_max = elapsed;
+    statsp->time_total += elapsed;
+    ++statsp->count;
+    osalSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Takes a consistent snapshot of an entry's statistics.
+ *
+ * @param[in] entryp    pointer to the table entry
+ * @param[out] statsp   pointer to the snapshot
+ *
+ * @api
+ */
+void qhalPerfGet(const QHALPerfEntry *entryp, QHALPerfStats *statsp)
+{
+    osalDbgCheck(entryp != NULL && statsp != NULL);
+
+    osalSysLock();
+    *statsp = *entryp->statsp;
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Resets all counters and regions.
+ *
+ * @api
+ */
+void qhalPerfReset(void)
+{
+    for (const QHALPerfEntry *entryp = __qhal_perf_start;
+            entryp < __qhal_perf_end; ++entryp)
+    {
+        osalSysLock();
+        memset(entryp->statsp, 0, sizeof(*entryp->statsp));
+        osalSysUnlock();
+    }
+}
+
+/**
+ * @brief   Prints all counters and regions.
+ *
+ * @param[in] chp       pointer to the output stream
+ *
+ * @api
+ */
+void qhalPerfDump(BaseSequentialStream *chp)
+{
+    osalDbgCheck(chp != NULL);
+
+    chprintf(chp, "%-24s %10s %10s %10s %10s (" QHAL_PERF_UNIT ")\r\n",
+            "name", "count", "min", "avg", "max");
+
+    for (const QHALPerfEntry *entryp = __qhal_perf_start;
+            entryp < __qhal_perf_end; ++entryp)
+    {
+        QHALPerfStats stats;
+        qhalPerfGet(entryp, &stats);
+
+        if (entryp->region == false)
+        {
+            chprintf(chp, "%-24s %10U\r\n", entryp->name, stats.count);
+            continue;
+        }
+
+        uint32_t avg = 0;
+        if (stats.count != 0)
+            avg = (uint32_t)(stats.time_total / stats.count);
+
+        chprintf(chp, "%-24s %10U %10U %10U %10U\r\n", entryp->name,
+                stats.count, stats.time_min, avg, stats.time_max);
+    }
+}
+
+/**
+ * @brief   Shell command printing the statistics.
+ * @details With the argument @p reset the statistics are reset after
+ *          printing them.
+ *
+ * @api
+ */
+void qhalPerfShellCmd(BaseSequentialStream *chp, int argc, char *argv[])
+{
+    if (argc > 1 || (argc == 1 && strcmp(argv[0], "reset") != 0))
+    {
+        chprintf(chp, "Usage: perf [reset]\r\n");
+        return;
+    }
+
+    qhalPerfDump(chp);
+    if (argc == 1)
+        qhalPerfReset();
+}
+
+#endif /* QHAL_USE_PERF */
+
+/** @} */
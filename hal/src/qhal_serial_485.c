@@ -155,6 +155,15 @@ void s485dObjectInit(Serial485Driver *s485dp, qnotify_t inotify, qnotify_t onoti
   s485dp->state = S485D_STOP;
   iqObjectInit(&s485dp->iqueue, s485dp->ib, SERIAL_BUFFERS_SIZE, inotify, s485dp);
   oqObjectInit(&s485dp->oqueue, s485dp->ob, SERIAL_BUFFERS_SIZE, onotify, s485dp);
+#if SERIAL_485_USE_FRAMES
+  s485dp->framemode = false;
+  s485dp->rxframe = NULL;
+  chMBObjectInit(&s485dp->rxfree, s485dp->rxfree_buf, SERIAL_485_FRAMES_NUM);
+  chMBObjectInit(&s485dp->rxdone, s485dp->rxdone_buf, SERIAL_485_FRAMES_NUM);
+  s485dp->txframe = NULL;
+  s485dp->txframe_n = 0;
+  s485dp->txthread = NULL;
+#endif
 }
 
 /**
@@ -203,6 +212,11 @@ void s485dStop(Serial485Driver *s485dp) {
   s485dp->state = S485D_STOP;
   oqResetI(&s485dp->oqueue);
   iqResetI(&s485dp->iqueue);
+#if SERIAL_485_USE_FRAMES
+  s485dp->txframe = NULL;
+  s485dp->txframe_n = 0;
+  osalThreadResumeI(&s485dp->txthread, MSG_RESET);
+#endif
   osalOsRescheduleS();
   osalSysUnlock();
 }
@@ -261,6 +275,232 @@ msg_t s485dRequestDataI(Serial485Driver *s485dp) {
   return b;
 }
 
+#if SERIAL_485_USE_FRAMES || defined(__DOXYGEN__)
+/**
+ * @brief   Enables or disables the frame mode.
+ * @details In frame mode received data is stored in the frames supplied
+ *          through @p s485dFrameRelease() instead of the input queue.
+ *          Disabling the frame mode drops the frame being received, frames
+ *          already received stay available to @p s485dFrameReceive().
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[in] enable    @p true to collect received data in frames
+ *
+ * @api
+ */
+void s485dFrameModeEnable(Serial485Driver *s485dp, bool enable) {
+
+  osalDbgCheck(s485dp != NULL);
+
+  osalSysLock();
+  s485dp->framemode = enable;
+  if (s485dp->rxframe != NULL) {
+    s485dp->rxframe->n = 0;
+    s485dp->rxframe->flags = 0;
+    (void)chMBPostI(&s485dp->rxfree, (msg_t)s485dp->rxframe);
+    s485dp->rxframe = NULL;
+  }
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns a frame to the pool of receive frames.
+ * @details Used both to supply new frame buffers and to give back frames
+ *          obtained from @p s485dFrameReceive().
+ * @note    At most @p SERIAL_485_FRAMES_NUM frames can be supplied.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[in] framep    pointer to the frame, @p buffer and @p size must
+ *                      be initialized
+ *
+ * @api
+ */
+void s485dFrameRelease(Serial485Driver *s485dp, Serial485Frame *framep) {
+  msg_t msg;
+
+  osalDbgCheck((s485dp != NULL) && (framep != NULL) &&
+               (framep->buffer != NULL) && (framep->size > 0));
+
+  framep->n = 0;
+  framep->flags = 0;
+  osalSysLock();
+  msg = chMBPostI(&s485dp->rxfree, (msg_t)framep);
+  osalSysUnlock();
+  osalDbgAssert(msg == MSG_OK, "too many frames");
+  (void)msg;
+}
+
+/**
+ * @brief   Waits for a received frame.
+ * @details The frame must be given back through @p s485dFrameRelease()
+ *          once processed.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[out] framepp  pointer to the received frame pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a frame has been received.
+ * @retval MSG_TIMEOUT  in case of operation timeout.
+ *
+ * @api
+ */
+msg_t s485dFrameReceive(Serial485Driver *s485dp, Serial485Frame **framepp,
+                        systime_t timeout) {
+  msg_t msg, rdymsg;
+
+  osalDbgCheck((s485dp != NULL) && (framepp != NULL));
+
+  rdymsg = chMBFetchTimeout(&s485dp->rxdone, &msg, timeout);
+  if (rdymsg == MSG_OK)
+    *framepp = (Serial485Frame *)msg;
+  return rdymsg;
+}
+
+/**
+ * @brief   Sends a frame.
+ * @details The data is transmitted from the caller's buffer, the function
+ *          returns once the last byte left the transmitter.
+ * @note    Data written in the output queue must be sent before, frames
+ *          and queue data are not serialized.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver object
+ * @param[in] buffer    pointer to the frame data
+ * @param[in] n         number of bytes to send
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the frame has been sent.
+ * @retval MSG_TIMEOUT  in case of operation timeout, the bytes not yet
+ *                      passed to the transmitter are dropped. With DMA the
+ *                      buffer may still be read until the transmission end.
+ * @retval MSG_RESET    if the driver has been stopped.
+ *
+ * @api
+ */
+msg_t s485dSendFrame(Serial485Driver *s485dp, const uint8_t *buffer,
+                     size_t n, systime_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck((s485dp != NULL) && (buffer != NULL) && (n > 0));
+
+  osalSysLock();
+  osalDbgAssert(s485dp->state == S485D_READY, "not ready");
+  osalDbgAssert(s485dp->txframe == NULL, "frame in progress");
+  s485dp->txframe = buffer;
+  s485dp->txframe_n = n;
+  /* The output notification starts the transmitter.*/
+  s485dp->oqueue.q_notify(&s485dp->oqueue);
+  msg = osalThreadSuspendTimeoutS(&s485dp->txthread, timeout);
+  if (msg == MSG_TIMEOUT) {
+    s485dp->txframe = NULL;
+    s485dp->txframe_n = 0;
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Handles incoming data in frame mode.
+ * @details Must be called by the low level driver instead of putting the
+ *          data in the input queue while @p framemode is set.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver structure
+ * @param[in] b         the received byte
+ *
+ * @iclass
+ */
+void s485dFrameDataI(Serial485Driver *s485dp, uint8_t b) {
+  Serial485Frame *framep = s485dp->rxframe;
+
+  osalDbgCheckClassI();
+
+  if (framep == NULL) {
+    msg_t msg;
+
+    if (chMBFetchI(&s485dp->rxfree, &msg) != MSG_OK) {
+      chnAddFlagsI(s485dp, S485D_OVERRUN_ERROR);
+      return;
+    }
+    framep = (Serial485Frame *)msg;
+    s485dp->rxframe = framep;
+  }
+  if (framep->n < framep->size)
+    framep->buffer[framep->n++] = b;
+  else
+    framep->flags |= S485D_OVERRUN_ERROR;
+}
+
+/**
+ * @brief   Handles the end of a received frame.
+ * @details Must be called by the low level driver when the line went idle
+ *          after receiving data.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver structure
+ *
+ * @iclass
+ */
+void s485dFrameEndI(Serial485Driver *s485dp) {
+  Serial485Frame *framep = s485dp->rxframe;
+
+  osalDbgCheckClassI();
+
+  if (framep == NULL)
+    return;
+  s485dp->rxframe = NULL;
+  /* There are never more frames than the mailbox size.*/
+  (void)chMBPostI(&s485dp->rxdone, (msg_t)framep);
+  chnAddFlagsI(s485dp, CHN_INPUT_AVAILABLE);
+}
+
+/**
+ * @brief   Handles outgoing frame data.
+ * @details Must be called by the low level driver while @p txframe is set
+ *          instead of reading the output queue.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver structure
+ * @return              The next byte of the frame.
+ * @retval Q_EMPTY      if the frame has been fully transmitted.
+ *
+ * @iclass
+ */
+msg_t s485dFrameRequestDataI(Serial485Driver *s485dp) {
+
+  osalDbgCheckClassI();
+
+  if (s485dp->txframe_n == 0)
+    return Q_EMPTY;
+  s485dp->txframe_n--;
+  return *s485dp->txframe++;
+}
+
+/**
+ * @brief   Handles the end of a frame transmission.
+ * @details Must be called by the low level driver once the last byte of
+ *          the frame left the transmitter.
+ *
+ * @param[in] s485dp    pointer to a @p Serial485Driver structure
+ *
+ * @iclass
+ */
+void s485dFrameSentI(Serial485Driver *s485dp) {
+
+  osalDbgCheckClassI();
+
+  if ((s485dp->txframe == NULL) || (s485dp->txframe_n > 0))
+    return;
+  s485dp->txframe = NULL;
+  osalThreadResumeI(&s485dp->txthread, MSG_OK);
+}
+#endif /* SERIAL_485_USE_FRAMES */
+
 /**
  * @brief   Direct output check on a @p SerialDriver.
  * @note    This function bypasses the indirect access to the channel and
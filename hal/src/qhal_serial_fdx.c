@@ -22,12 +22,64 @@
 
 #include "qhal.h"
 
+#include <string.h>
+
 #if HAL_USE_SERIAL_FDX || defined(__DOXYGEN__)
 
 /*===========================================================================*/
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Evaluates to @p true if a word contains a zero byte.
+ */
+#define SFDX_HAS_ZERO(w) ((((w) - 0x01010101U) & ~(w) & 0x80808080U) != 0)
+
+/**
+ * @brief   Evaluates to @p true if a word contains the byte @p b.
+ */
+#define SFDX_HAS_BYTE(w, b) SFDX_HAS_ZERO((w) ^ ((uint32_t)(b) * 0x01010101U))
+
+/**
+ * @brief   Evaluates to @p true if the byte @p c must be escaped.
+ */
+#define SFDX_IS_SPECIAL(c)                                                    \
+    ((c) == SFDX_FRAME_BEGIN || (c) == SFDX_FRAME_END || (c) == SFDX_BYTE_ESC)
+
+/**
+ * @brief   Frame size in use.
+ */
+#define SFDX_MTU(sfdxdp)                                                      \
+    ((sfdxdp)->configp->mtu != 0 ? (sfdxdp)->configp->mtu : SERIAL_FDX_MTU)
+
+/**
+ * @brief   Adds to a statistics counter.
+ */
+#if SERIAL_FDX_USE_STATS || defined(__DOXYGEN__)
+#define SFDX_STATS_ADD(sfdxdp, counter, n)                                    \
+    ((sfdxdp)->stats.counter += (n))
+#else
+#define SFDX_STATS_ADD(sfdxdp, counter, n) ((void)0)
+#endif /* SERIAL_FDX_USE_STATS */
+
+#if SERIAL_FDX_USE_WINDOW || defined(__DOXYGEN__)
+/**
+ * @brief   Windowed frame header size, flags, sequence and acknowledge.
+ */
+#define SFDX_WINDOW_HEADER_SIZE 3
+
+/**
+ * @brief   Windowed frame flag, the sender is not connected and asks the
+ *          receiver to synchronize to its sequence number.
+ */
+#define SFDX_WINDOW_SYN 0x01
+
+/**
+ * @brief   Windowed frame flag, the sender is synchronized to the receiver.
+ */
+#define SFDX_WINDOW_SYNCED 0x02
+#endif /* SERIAL_FDX_USE_WINDOW */
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -36,35 +88,199 @@
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+/* Encode and transmit time of frames. */
+QHAL_PERF_REGION(sfdx_send)
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
 /**
- * @brief   Character escape function.
- * @details If required, function escapes a single character.
+ * @brief   Returns the length of the leading run without special bytes.
+ * @details The data is scanned a word at a time.
  *
- * @param[in] c         character to escape
+ * @param[in] bp        pointer to the data
+ * @param[in] n         number of bytes
+ *
+ * @return              number of leading bytes not requiring escaping
+ *
+ * @notapi
+ */
+static size_t sfdxd_plain_run(const uint8_t* bp, size_t n)
+{
+    size_t i = 0;
+
+    while (n - i >= sizeof(uint32_t))
+    {
+        uint32_t w;
+        memcpy(&w, bp + i, sizeof(w));
+        if (SFDX_HAS_BYTE(w, SFDX_FRAME_BEGIN) ||
+                SFDX_HAS_BYTE(w, SFDX_FRAME_END) ||
+                SFDX_HAS_BYTE(w, SFDX_BYTE_ESC))
+            break;
+        i += sizeof(w);
+    }
+    while (i < n && !SFDX_IS_SPECIAL(bp[i]))
+        i++;
+    return i;
+}
+
+/**
+ * @brief   Escape function.
+ * @details Escapes data into the message buffer as long as it fits. Runs
+ *          without special bytes are copied as a whole.
+ *
+ * @param[in] src       pointer to the data to escape
+ * @param[in] n         number of bytes to escape
  * @param[out] buffer   pointer to message buffer
+ * @param[in] space     free space in the message buffer
+ * @param[out] usedp    byte count used in the message buffer
+ *
+ * @return              number of bytes consumed from @p src
+ *
+ * @notapi
+ */
+static size_t sfdxd_escape(const uint8_t* src, size_t n, uint8_t* buffer,
+        size_t space, size_t* usedp)
+{
+    size_t i = 0, idx = 0;
+
+    while (i < n && idx < space)
+    {
+        size_t run = sfdxd_plain_run(src + i, n - i);
+        if (run > space - idx)
+            run = space - idx;
+        memcpy(buffer + idx, src + i, run);
+        i += run;
+        idx += run;
+
+        if (i < n && idx < space)
+        {
+            if (space - idx < 2)
+                break;
+            buffer[idx++] = SFDX_BYTE_ESC;
+            buffer[idx++] = src[i++];
+        }
+    }
+    *usedp = idx;
+    return i;
+}
+
+/**
+ * @brief   Returns the input queue of a channel.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] id        channel number
+ *
+ * @notapi
+ */
+static symmetric_queue_t* sfdxd_iqueue(SerialFdxDriver* sfdxdp, uint8_t id)
+{
+#if SERIAL_FDX_CHANNELS > 1
+    if (id > 0)
+        return &sfdxdp->channels[id - 1].iqueue;
+#else
+    (void)id;
+#endif
+    return &sfdxdp->iqueue;
+}
+
+/**
+ * @brief   Returns the output queue of a channel.
  *
- * @return              byte count used to escape the character
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] id        channel number
  *
  * @notapi
  */
-static uint8_t sfdxd_escape(uint8_t c, uint8_t* buffer)
+static symmetric_queue_t* sfdxd_oqueue(SerialFdxDriver* sfdxdp, uint8_t id)
 {
-    uint8_t idx = 0;
-    if (c == SFDX_FRAME_BEGIN || c == SFDX_FRAME_END || c == SFDX_BYTE_ESC)
+#if SERIAL_FDX_CHANNELS > 1
+    if (id > 0)
+        return &sfdxdp->channels[id - 1].oqueue;
+#else
+    (void)id;
+#endif
+    return &sfdxdp->oqueue;
+}
+
+/**
+ * @brief   Adds flags to a channel.
+ * @note    Must be called with the kernel locked.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] id        channel number
+ * @param[in] flags     flags to be added
+ *
+ * @notapi
+ */
+static void sfdxd_add_flagsI(SerialFdxDriver* sfdxdp, uint8_t id,
+        eventflags_t flags)
+{
+#if SERIAL_FDX_CHANNELS > 1
+    if (id > 0)
     {
-        buffer[idx++] = SFDX_BYTE_ESC;
+        chnAddFlagsI(&sfdxdp->channels[id - 1], flags);
+        return;
+    }
+#else
+    (void)id;
+#endif
+    chnAddFlagsI(sfdxdp, flags);
+}
+
+/**
+ * @brief   Returns the channel to be served next.
+ * @note    Must be called with the kernel locked.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ *
+ * @return              The lowest numbered channel with data to send or
+ *                      @p SERIAL_FDX_CHANNELS if there is none.
+ *
+ * @notapi
+ */
+static uint8_t sfdxd_pendingI(SerialFdxDriver* sfdxdp)
+{
+    uint8_t id;
+
+    for (id = 0; id < SERIAL_FDX_CHANNELS; id++)
+    {
+        if (chSymQIsEmptyI(sfdxd_oqueue(sfdxdp, id)) == FALSE)
+            break;
+    }
+    return id;
+}
+
+/**
+ * @brief   Resets the queues of all channels.
+ * @note    Must be called with the kernel locked.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] flags     flags added to all channels, @p 0 for none
+ *
+ * @notapi
+ */
+static void sfdxd_resetI(SerialFdxDriver* sfdxdp, eventflags_t flags)
+{
+    uint8_t id;
+
+    for (id = 0; id < SERIAL_FDX_CHANNELS; id++)
+    {
+        chSymQResetI(sfdxd_oqueue(sfdxdp, id));
+        chSymQResetI(sfdxd_iqueue(sfdxdp, id));
+        if (flags != 0)
+            sfdxd_add_flagsI(sfdxdp, id, flags);
     }
-    buffer[idx++] = c;
-    return idx;
 }
 
 /**
  * @brief   Send function.
- * @details Called from pump thread function to send a frame.
+ * @details Called from pump thread function to send a frame. Contiguous
+ *          spans of the output queue are escaped straight into the message
+ *          buffer and dequeued under a single lock. With multiple channels
+ *          the frame carries data of the lowest numbered channel with data
+ *          pending, preceded by the channel number.
  *
  * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
  *
@@ -72,33 +288,97 @@ static uint8_t sfdxd_escape(uint8_t c, uint8_t* buffer)
  */
 static void sfdxd_send(SerialFdxDriver* sfdxdp)
 {
-    uint8_t idx = 0;
+    symmetric_queue_t* sqp;
+    size_t mtu = SFDX_MTU(sfdxdp);
+    size_t idx = 0;
+    size_t payload = 0;
+    uint8_t id;
+    QHAL_PERF_BEGIN(sfdx_send);
     sfdxdp->sendbuffer[idx++] = SFDX_FRAME_BEGIN;
 
     osalSysLock();
-    while ((chSymQIsEmptyI(&sfdxdp->oqueue) == FALSE) &&
-            (idx < (SERIAL_FDX_MTU - 3)))
+    id = sfdxd_pendingI(sfdxdp);
+    if (id == SERIAL_FDX_CHANNELS)
+        id = 0;
+    sqp = sfdxd_oqueue(sfdxdp, id);
+#if SERIAL_FDX_CHANNELS > 1
+    if (chSymQIsEmptyI(sqp) == FALSE)
     {
-        osalSysUnlock();
-        idx += sfdxd_escape((uint8_t)chSymQGet(&sfdxdp->oqueue),
-                sfdxdp->sendbuffer + idx);
-        osalSysLock();
+        size_t used;
+        (void)sfdxd_escape(&id, 1, sfdxdp->sendbuffer + idx, 2, &used);
+        idx += used;
+    }
+#endif
+    while (idx < (mtu - 1))
+    {
+        size_t used;
+        uint8_t* p;
+        size_t n = chSymQReadPeekI(sqp, &p);
+        if (n == 0)
+            break;
+
+        n = sfdxd_escape(p, n, sfdxdp->sendbuffer + idx,
+                (mtu - 1) - idx, &used);
+        if (n == 0)
+            break;
+        idx += used;
+        payload += n;
+        SFDX_STATS_ADD(sfdxdp, escapes_sent, used - n);
+        chSymQReadConsumeI(sqp, n);
     }
     osalSysUnlock();
 
     sfdxdp->sendbuffer[idx++] = SFDX_FRAME_END;
     streamWrite(sfdxdp->configp->farp, sfdxdp->sendbuffer, idx);
+    SFDX_STATS_ADD(sfdxdp, frames_sent, 1);
+    SFDX_STATS_ADD(sfdxdp, payload_sent, payload);
+    SFDX_STATS_ADD(sfdxdp, empty_sent, payload == 0);
 
     osalSysLock();
-    if ((sfdxdp->connected == TRUE) && (chSymQIsEmptyI(&sfdxdp->oqueue) == TRUE))
-        chnAddFlagsI(sfdxdp, CHN_OUTPUT_EMPTY);
+    if ((sfdxdp->connected == TRUE) && (chSymQIsEmptyI(sqp) == TRUE))
+        sfdxd_add_flagsI(sfdxdp, id, CHN_OUTPUT_EMPTY);
     osalOsRescheduleS();
     osalSysUnlock();
+    QHAL_PERF_END(sfdx_send);
+}
+
+/**
+ * @brief   Refills the receive block.
+ * @details Waits for the first byte only, the rest of the block is what the
+ *          far end has available.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] timeout   timeout for waiting for new data
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       The block holds new data.
+ * @retval Q_TIMEOUT    Specified timeout expired.
+ * @retval Q_RESET      Queue associated with the channel has been reset.
+ *
+ * @notapi
+ */
+static msg_t sfdxd_fill(SerialFdxDriver* sfdxdp, systime_t timeout)
+{
+    BaseAsynchronousChannel* farp =
+            (BaseAsynchronousChannel*)sfdxdp->configp->farp;
+    uint8_t* bp = sfdxdp->recvbuffer;
+    msg_t c;
+
+    if ((c = chnGetTimeout(farp, timeout)) < 0)
+        return c;
+    bp[0] = (uint8_t)c;
+    sfdxdp->recvlen = 1 + chnReadTimeout(farp, bp + 1, SERIAL_FDX_MTU - 1,
+            TIME_IMMEDIATE);
+    sfdxdp->recvpos = 0;
+    return MSG_OK;
 }
 
 /**
  * @brief   Receive function.
- * @details Called from pump thread function to receive a frame.
+ * @details Called from pump thread function to receive a frame. The far end
+ *          is read in blocks of the available data, each block is decoded
+ *          in place and its payload put in the input queue at once. Bytes
+ *          following the frame end are kept for the next call.
  *
  * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
  * @param[in] timeout   timeout for waiting for new data
@@ -111,47 +391,366 @@ static void sfdxd_send(SerialFdxDriver* sfdxdp)
  */
 static msg_t sfdxd_receive(SerialFdxDriver* sfdxdp, systime_t timeout)
 {
+    uint8_t* bp = sfdxdp->recvbuffer;
     bool foundFrameBegin = FALSE;
     bool foundEsc = FALSE;
+    bool foundFrameEnd = FALSE;
     msg_t byteCount = 0;
-    msg_t c;
-    while ((c = chnGetTimeout((BaseAsynchronousChannel*)sfdxdp->configp->farp,
-            timeout)) >= 0)
+    msg_t c = 0;
+#if SERIAL_FDX_USE_STATS
+    size_t payload = 0;
+#endif
+#if SERIAL_FDX_CHANNELS > 1
+    int id = -1;
+#else
+    int id = 0;
+#endif
+
+    while (foundFrameEnd == FALSE)
     {
-        if (c == SFDX_FRAME_BEGIN && foundFrameBegin == FALSE &&
-                foundEsc == FALSE)
+        size_t start, out, i;
+
+        if ((sfdxdp->recvpos >= sfdxdp->recvlen) &&
+                ((c = sfdxd_fill(sfdxdp, timeout)) < 0))
+            break;
+
+        /* Payload is compacted in place, it never outgrows the input. */
+        start = out = sfdxdp->recvpos;
+        for (i = sfdxdp->recvpos; i < sfdxdp->recvlen; i++)
         {
-            foundFrameBegin = TRUE;
+            uint8_t b = bp[i];
+            if (foundEsc == TRUE)
+            {
+                bp[out++] = b;
+                foundEsc = FALSE;
+            }
+            else if (b == SFDX_FRAME_BEGIN && foundFrameBegin == FALSE)
+            {
+                foundFrameBegin = TRUE;
+            }
+            else if (b == SFDX_FRAME_END && foundFrameBegin == TRUE)
+            {
+                foundFrameEnd = TRUE;
+                i++;
+                break;
+            }
+            else if (b == SFDX_BYTE_ESC)
+            {
+                foundEsc = TRUE;
+                SFDX_STATS_ADD(sfdxdp, escapes_received, 1);
+            }
+            else
+            {
+                bp[out++] = b;
+            }
         }
-        else if (c == SFDX_FRAME_END &&
-                foundFrameBegin == TRUE &&
-                foundEsc == FALSE)
+        sfdxdp->recvpos = i;
+
+#if SERIAL_FDX_CHANNELS > 1
+        /* The first payload byte selects the channel. */
+        if ((id < 0) && (out > start))
         {
-            return byteCount;
+            id = bp[start++];
+            if (id >= SERIAL_FDX_CHANNELS)
+            {
+                SFDX_STATS_ADD(sfdxdp, framing_errors, 1);
+                osalSysLock();
+                chnAddFlagsI(sfdxdp, SFDX_FRAMING_ERROR);
+                osalOsRescheduleS();
+                osalSysUnlock();
+            }
+        }
+#endif
+#if SERIAL_FDX_USE_STATS
+        payload += out - start;
+#endif
+
+        if ((out > start) && (id >= 0) && (id < SERIAL_FDX_CHANNELS) &&
+                (sfdxdp->connected == TRUE))
+        {
+            symmetric_queue_t* sqp = sfdxd_iqueue(sfdxdp, (uint8_t)id);
+
+            osalSysLock();
+            byteCount += (msg_t)(out - start);
+            if (chSymQIsEmptyI(sqp) == TRUE)
+            {
+                sfdxd_add_flagsI(sfdxdp, (uint8_t)id, CHN_INPUT_AVAILABLE);
+            }
+            if (chSymQWriteI(sqp, bp + start, out - start) < out - start)
+            {
+                SFDX_STATS_ADD(sfdxdp, overruns, 1);
+                sfdxd_add_flagsI(sfdxdp, (uint8_t)id, SFDX_OVERRUN_ERROR);
+            }
+            osalOsRescheduleS();
+            osalSysUnlock();
+        }
+    }
+
+    if (foundFrameEnd == TRUE)
+    {
+        SFDX_STATS_ADD(sfdxdp, frames_received, 1);
+        SFDX_STATS_ADD(sfdxdp, payload_received, payload);
+        SFDX_STATS_ADD(sfdxdp, empty_received, payload == 0);
+        return byteCount;
+    }
+
+    /* Raise an event if end of frame was not read */
+    if (foundFrameBegin)
+    {
+        SFDX_STATS_ADD(sfdxdp, framing_errors, 1);
+        osalSysLock();
+        chnAddFlagsI(sfdxdp, SFDX_FRAMING_ERROR);
+        osalOsRescheduleS();
+        osalSysUnlock();
+    }
+    return c;
+}
+
+#if SERIAL_FDX_USE_WINDOW || defined(__DOXYGEN__)
+/**
+ * @brief   Escapes queued data into the message buffer.
+ * @details The data starts @p offset bytes after the read pointer of the
+ *          output queue and is not dequeued.
+ * @note    Must be called with the kernel locked.
+ *
+ * @param[in] sqp       pointer to the output queue
+ * @param[in] offset    offset of the data in the queue
+ * @param[in] n         number of bytes to escape
+ * @param[out] buffer   pointer to message buffer
+ * @param[in] space     free space in the message buffer
+ * @param[out] usedp    byte count used in the message buffer
+ *
+ * @return              number of bytes consumed from the queue
+ *
+ * @notapi
+ */
+static size_t sfdxd_escape_queued(symmetric_queue_t* sqp, size_t offset,
+        size_t n, uint8_t* buffer, size_t space, size_t* usedp)
+{
+    uint8_t* p = sqp->q_rdptr + offset;
+    size_t i = 0, idx = 0;
+
+    if (p >= sqp->q_top)
+        p -= chSymQSizeI(sqp);
+
+    while (i < n)
+    {
+        size_t used, c;
+        size_t span = (size_t)(sqp->q_top - p);
+        if (span > n - i)
+            span = n - i;
+
+        c = sfdxd_escape(p, span, buffer + idx, space - idx, &used);
+        i += c;
+        idx += used;
+        if (c < span)
+            break;
+        p += c;
+        if (p >= sqp->q_top)
+            p = sqp->q_buffer;
+    }
+    *usedp = idx;
+    return i;
+}
+
+/**
+ * @brief   Sends a windowed frame.
+ * @details The payload space does not depend on the escaped header size,
+ *          so a retransmitted frame carries the same payload.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] seq       sequence number of the frame
+ * @param[in] offset    offset of the payload in the output queue
+ * @param[in] n         maximum payload size, @p 0 for a frame without data
+ *
+ * @return              payload bytes sent
+ *
+ * @notapi
+ */
+static size_t sfdxd_window_send_frame(SerialFdxDriver* sfdxdp, uint8_t seq,
+        size_t offset, size_t n)
+{
+    uint8_t* bp = sfdxdp->sendbuffer;
+    uint8_t header[SFDX_WINDOW_HEADER_SIZE];
+    size_t idx = 0, used;
+
+    header[0] = (sfdxdp->connected == TRUE ? 0 : SFDX_WINDOW_SYN) |
+            (sfdxdp->synced == TRUE ? SFDX_WINDOW_SYNCED : 0);
+    header[1] = seq;
+    header[2] = sfdxdp->rxnext;
+
+    bp[idx++] = SFDX_FRAME_BEGIN;
+    (void)sfdxd_escape(header, sizeof(header), bp + idx,
+            2 * sizeof(header), &used);
+    idx += used;
+    if (n > 0)
+    {
+        osalSysLock();
+        n = sfdxd_escape_queued(&sfdxdp->oqueue, offset, n, bp + idx,
+                SFDX_MTU(sfdxdp) - 2 - 2 * sizeof(header), &used);
+        osalSysUnlock();
+        idx += used;
+        SFDX_STATS_ADD(sfdxdp, escapes_sent, used - n);
+    }
+    bp[idx++] = SFDX_FRAME_END;
+    streamWrite(sfdxdp->configp->farp, bp, idx);
+    SFDX_STATS_ADD(sfdxdp, frames_sent, 1);
+    SFDX_STATS_ADD(sfdxdp, payload_sent, n);
+    SFDX_STATS_ADD(sfdxdp, empty_sent, n == 0);
+
+    sfdxdp->ackpending = FALSE;
+    sfdxdp->lasttx = osalOsGetSystemTimeX();
+    return n;
+}
+
+/**
+ * @brief   Windowed mode send function.
+ * @details Goes back to the oldest frame in flight on retransmission
+ *          timeout, then sends frames as long as the window allows. A frame
+ *          without data acknowledges received frames and keeps the
+ *          connection alive.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ *
+ * @notapi
+ */
+static void sfdxd_window_send(SerialFdxDriver* sfdxdp)
+{
+    uint8_t window = sfdxdp->configp->window;
+    size_t offset = 0;
+    bool sent = FALSE;
+    uint8_t k;
+
+    if ((sfdxdp->txcount > 0) && (chVTTimeElapsedSinceX(sfdxdp->txtime) >=
+            TIME_MS2I(SFDX_WINDOW_RETRANSMIT_MS)))
+    {
+        sfdxdp->txsent = 0;
+        sfdxdp->txtime = osalOsGetSystemTimeX();
+    }
+
+    for (k = 0; k < sfdxdp->txsent; k++)
+        offset += sfdxdp->txlen[(uint8_t)(sfdxdp->txbase + k) %
+                SERIAL_FDX_WINDOW_MAX];
+
+    while ((sfdxdp->connected == TRUE) && (sfdxdp->txsent < window))
+    {
+        uint8_t seq = sfdxdp->txbase + sfdxdp->txsent;
+        size_t* lenp = &sfdxdp->txlen[seq % SERIAL_FDX_WINDOW_MAX];
+
+        if (sfdxdp->txsent == sfdxdp->txcount)
+        {
+            /* New frame from the data not in flight yet. */
+            size_t n;
+
+            osalSysLock();
+            n = chSymQGetFullI(&sfdxdp->oqueue) - offset;
+            osalSysUnlock();
+            if (n == 0)
+                break;
+            if (sfdxdp->txcount == 0)
+                sfdxdp->txtime = osalOsGetSystemTimeX();
+            *lenp = sfdxd_window_send_frame(sfdxdp, seq, offset, n);
+            sfdxdp->txcount++;
         }
         else
         {
-            if (c == SFDX_BYTE_ESC && foundEsc == FALSE)
+            (void)sfdxd_window_send_frame(sfdxdp, seq, offset, *lenp);
+        }
+        offset += *lenp;
+        sfdxdp->txsent++;
+        sent = TRUE;
+    }
+
+    if ((sent == FALSE) && ((sfdxdp->ackpending == TRUE) ||
+            (chVTTimeElapsedSinceX(sfdxdp->lasttx) >=
+            TIME_MS2I(SFDX_WINDOW_KEEPALIVE_MS))))
+    {
+        (void)sfdxd_window_send_frame(sfdxdp,
+                sfdxdp->txbase + sfdxdp->txcount, 0, 0);
+    }
+}
+
+/**
+ * @brief   Windowed mode connection state change.
+ * @details Resets the queues, the sequence numbers of the frames in flight
+ *          are skipped so that frames from before the change are ignored.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] connected new connection state
+ *
+ * @notapi
+ */
+static void sfdxd_window_connect(SerialFdxDriver* sfdxdp, bool connected)
+{
+    osalSysLock();
+    sfdxdp->txbase += sfdxdp->txcount;
+    sfdxdp->txcount = 0;
+    sfdxdp->txsent = 0;
+    sfdxdp->connected = connected;
+    sfdxd_resetI(sfdxdp, connected == TRUE ? CHN_CONNECTED : CHN_DISCONNECTED);
+    osalOsRescheduleS();
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Windowed mode receive function.
+ * @details Decodes a single frame into the frame buffer.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] timeout   timeout for waiting for new data
+ *
+ * @return              size of the decoded frame
+ * @retval Q_TIMEOUT    Specified timeout expired.
+ * @retval Q_RESET      Queue associated with the channel has been reset.
+ *
+ * @notapi
+ */
+static msg_t sfdxd_window_receive_frame(SerialFdxDriver* sfdxdp,
+        systime_t timeout)
+{
+    uint8_t* fp = sfdxdp->framebuffer;
+    bool foundFrameBegin = FALSE;
+    bool foundEsc = FALSE;
+    size_t n = 0;
+    msg_t c = 0;
+
+    while (true)
+    {
+        if ((sfdxdp->recvpos >= sfdxdp->recvlen) &&
+                ((c = sfdxd_fill(sfdxdp, timeout)) < 0))
+            break;
+
+        while (sfdxdp->recvpos < sfdxdp->recvlen)
+        {
+            uint8_t b = sfdxdp->recvbuffer[sfdxdp->recvpos++];
+            if (foundFrameBegin == FALSE)
+            {
+                /* Data outside of frames is dropped. */
+                foundFrameBegin = (b == SFDX_FRAME_BEGIN);
+            }
+            else if (foundEsc == FALSE && b == SFDX_BYTE_ESC)
             {
                 foundEsc = TRUE;
+                SFDX_STATS_ADD(sfdxdp, escapes_received, 1);
+            }
+            else if (foundEsc == FALSE && b == SFDX_FRAME_END)
+            {
+                if (n <= sizeof(sfdxdp->framebuffer))
+                    return (msg_t)n;
+                /* Frame overflow. */
+                SFDX_STATS_ADD(sfdxdp, framing_errors, 1);
+                osalSysLock();
+                chnAddFlagsI(sfdxdp, SFDX_FRAMING_ERROR);
+                osalOsRescheduleS();
+                osalSysUnlock();
+                foundFrameBegin = FALSE;
+                n = 0;
             }
             else
             {
-                if (sfdxdp->connected == TRUE)
-                {
-                    osalSysLock();
-                    byteCount++;
-                    if (chSymQIsEmptyI(&sfdxdp->iqueue) == TRUE)
-                    {
-                        chnAddFlagsI(sfdxdp, CHN_INPUT_AVAILABLE);
-                    }
-                    if (chSymQPutI(&sfdxdp->iqueue, (uint8_t)c) == Q_FULL)
-                    {
-                        chnAddFlagsI(sfdxdp, SFDX_OVERRUN_ERROR);
-                    }
-                    osalOsRescheduleS();
-                    osalSysUnlock();
-                }
+                if (n < sizeof(sfdxdp->framebuffer))
+                    fp[n] = b;
+                n++;
                 foundEsc = FALSE;
             }
         }
@@ -160,6 +759,7 @@ static msg_t sfdxd_receive(SerialFdxDriver* sfdxdp, systime_t timeout)
     /* Raise an event if end of frame was not read */
     if (foundFrameBegin)
     {
+        SFDX_STATS_ADD(sfdxdp, framing_errors, 1);
         osalSysLock();
         chnAddFlagsI(sfdxdp, SFDX_FRAMING_ERROR);
         osalOsRescheduleS();
@@ -168,6 +768,217 @@ static msg_t sfdxd_receive(SerialFdxDriver* sfdxdp, systime_t timeout)
     return c;
 }
 
+/**
+ * @brief   Windowed mode receive function.
+ * @details Receives a frame, follows the connection handshake, releases the
+ *          acknowledged frames and accepts in order data if it fits in the
+ *          input queue. Otherwise the data is dropped and retransmitted by
+ *          the peer.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] timeout   timeout for waiting for new data
+ *
+ * @notapi
+ */
+static void sfdxd_window_receive(SerialFdxDriver* sfdxdp, systime_t timeout)
+{
+    uint8_t* fp = sfdxdp->framebuffer;
+    uint8_t flags, seq, ack, acked;
+    msg_t n = sfdxd_window_receive_frame(sfdxdp, timeout);
+
+    if (n < 0)
+    {
+        /* Connection lost. */
+        if (((sfdxdp->connected == TRUE) || (sfdxdp->synced == TRUE)) &&
+                (chVTTimeElapsedSinceX(sfdxdp->lastrx) >=
+                TIME_MS2I(SFDX_SLAVE_RECEIVE_TIMEOUT_MS)))
+        {
+            sfdxdp->synced = FALSE;
+            if (sfdxdp->connected == TRUE)
+                sfdxd_window_connect(sfdxdp, FALSE);
+        }
+        return;
+    }
+    if (n < SFDX_WINDOW_HEADER_SIZE)
+        return;
+
+    flags = fp[0];
+    seq = fp[1];
+    ack = fp[2];
+    n -= SFDX_WINDOW_HEADER_SIZE;
+    SFDX_STATS_ADD(sfdxdp, frames_received, 1);
+    SFDX_STATS_ADD(sfdxdp, payload_received, n);
+    SFDX_STATS_ADD(sfdxdp, empty_received, n == 0);
+    sfdxdp->lastrx = osalOsGetSystemTimeX();
+
+    /* Handshake, the peer synchronized to us only once it reported it
+       while not synchronized itself means the peer restarted. */
+    if (flags & SFDX_WINDOW_SYN)
+    {
+        if ((sfdxdp->connected == TRUE) && !(flags & SFDX_WINDOW_SYNCED))
+            sfdxd_window_connect(sfdxdp, FALSE);
+        if (sfdxdp->connected == FALSE)
+        {
+            sfdxdp->rxnext = seq;
+            sfdxdp->synced = TRUE;
+            sfdxdp->ackpending = TRUE;
+        }
+    }
+    if (sfdxdp->connected == FALSE)
+    {
+        if ((sfdxdp->synced == FALSE) || !(flags & SFDX_WINDOW_SYNCED))
+            return;
+        sfdxd_window_connect(sfdxdp, TRUE);
+    }
+
+    /* Cumulative acknowledge. */
+    acked = (uint8_t)(ack - sfdxdp->txbase);
+    if ((acked > 0) && (acked <= sfdxdp->txcount))
+    {
+        size_t freed = 0;
+        uint8_t k;
+
+        for (k = 0; k < acked; k++)
+            freed += sfdxdp->txlen[(uint8_t)(sfdxdp->txbase + k) %
+                    SERIAL_FDX_WINDOW_MAX];
+        osalSysLock();
+        chSymQReadConsumeI(&sfdxdp->oqueue, freed);
+        if (chSymQIsEmptyI(&sfdxdp->oqueue) == TRUE)
+            chnAddFlagsI(sfdxdp, CHN_OUTPUT_EMPTY);
+        osalOsRescheduleS();
+        osalSysUnlock();
+
+        sfdxdp->txbase = ack;
+        sfdxdp->txcount -= acked;
+        sfdxdp->txsent = sfdxdp->txsent > acked ? sfdxdp->txsent - acked : 0;
+        sfdxdp->txtime = osalOsGetSystemTimeX();
+    }
+
+    if (n > 0)
+    {
+        sfdxdp->ackpending = TRUE;
+        if (seq != sfdxdp->rxnext)
+            return;
+
+        osalSysLock();
+        if (chSymQGetEmptyI(&sfdxdp->iqueue) >= (size_t)n)
+        {
+            if (chSymQIsEmptyI(&sfdxdp->iqueue) == TRUE)
+                chnAddFlagsI(sfdxdp, CHN_INPUT_AVAILABLE);
+            (void)chSymQWriteI(&sfdxdp->iqueue, fp + SFDX_WINDOW_HEADER_SIZE,
+                    (size_t)n);
+            sfdxdp->rxnext++;
+        }
+        osalOsRescheduleS();
+        osalSysUnlock();
+    }
+}
+
+/**
+ * @brief   Windowed mode pump iteration.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ *
+ * @notapi
+ */
+static void sfdxd_window_pump(SerialFdxDriver* sfdxdp)
+{
+    systime_t timeout = TIME_MS2I(SFDX_WINDOW_POLL_MS);
+    size_t inflight = 0;
+    uint8_t k;
+
+    sfdxd_window_send(sfdxdp);
+
+    /* Do not wait for frames while there is more data to send. */
+    for (k = 0; k < sfdxdp->txcount; k++)
+        inflight += sfdxdp->txlen[(uint8_t)(sfdxdp->txbase + k) %
+                SERIAL_FDX_WINDOW_MAX];
+    osalSysLock();
+    if ((sfdxdp->connected == TRUE) &&
+            (sfdxdp->txcount < sfdxdp->configp->window) &&
+            (chSymQGetFullI(&sfdxdp->oqueue) > inflight))
+        timeout = TIME_IMMEDIATE;
+    osalSysUnlock();
+
+    sfdxd_window_receive(sfdxdp, timeout);
+}
+#endif /* SERIAL_FDX_USE_WINDOW */
+
+#if SERIAL_FDX_USE_STATS || defined(__DOXYGEN__)
+/**
+ * @brief   Accounts a master round trip.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] start     system time at the start of the request
+ *
+ * @notapi
+ */
+static void sfdxd_stats_rtt(SerialFdxDriver* sfdxdp, systime_t start)
+{
+    uint32_t rtt = (uint32_t)chVTTimeElapsedSinceX(start);
+
+    if ((sfdxdp->stats.rtt_count == 0) || (rtt < sfdxdp->stats.rtt_min))
+        sfdxdp->stats.rtt_min = rtt;
+    if (rtt > sfdxdp->stats.rtt_max)
+        sfdxdp->stats.rtt_max = rtt;
+    sfdxdp->stats.rtt_total += rtt;
+    sfdxdp->stats.rtt_count++;
+}
+#endif /* SERIAL_FDX_USE_STATS */
+
+#if (SFDX_MASTER_IDLE_MAX_MS > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Master idle delay.
+ * @details Delays the next request after an idle round trip, each idle
+ *          round trip doubles the delay. The delay ends as soon as data is
+ *          written to the driver.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] idle      the last round trip carried no data
+ *
+ * @notapi
+ */
+static void sfdxd_idle(SerialFdxDriver* sfdxdp, bool idle)
+{
+    if (idle == FALSE)
+    {
+        sfdxdp->idledelay = 0;
+        return;
+    }
+
+    if (sfdxdp->idledelay == 0)
+        sfdxdp->idledelay = SFDX_MASTER_IDLE_MIN_MS;
+    else if (sfdxdp->idledelay < SFDX_MASTER_IDLE_MAX_MS / 2)
+        sfdxdp->idledelay *= 2;
+    else
+        sfdxdp->idledelay = SFDX_MASTER_IDLE_MAX_MS;
+
+    osalSysLock();
+    if ((sfdxd_pendingI(sfdxdp) == SERIAL_FDX_CHANNELS) &&
+            (sfdxdp->state == SFDXD_READY))
+    {
+        (void)osalThreadSuspendTimeoutS(&sfdxdp->idle,
+                TIME_MS2I(sfdxdp->idledelay));
+    }
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Ends the master idle delay.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ *
+ * @notapi
+ */
+static void sfdxd_wakeup(SerialFdxDriver* sfdxdp)
+{
+    osalSysLock();
+    osalThreadResumeI(&sfdxdp->idle, MSG_OK);
+    osalOsRescheduleS();
+    osalSysUnlock();
+}
+#endif /* SFDX_MASTER_IDLE_MAX_MS > 0 */
+
 /**
  * @brief   Drivers pump thread function.
  *
@@ -192,11 +1003,39 @@ static void sfdxd_pump(void* parameters)
             chThdSuspendS(&sfdxdp->wait);
         osalSysUnlock();
 
+#if SERIAL_FDX_USE_WINDOW
+        if (sfdxdp->configp->window > 0)
+        {
+            sfdxd_window_pump(sfdxdp);
+            continue;
+        }
+#endif
+
         if (sfdxdp->configp->type == SFDXD_MASTER)
         {
+#if SFDX_MASTER_IDLE_MAX_MS > 0
+            bool idle;
+
+            osalSysLock();
+            idle = (sfdxd_pendingI(sfdxdp) == SERIAL_FDX_CHANNELS);
+            osalSysUnlock();
+#endif
+#if SERIAL_FDX_USE_STATS
+            systime_t start = osalOsGetSystemTimeX();
+#endif
             sfdxd_send(sfdxdp);
             receiveResult = sfdxd_receive(sfdxdp,
                     TIME_MS2I(SFDX_MASTER_RECEIVE_TIMEOUT_MS));
+#if SERIAL_FDX_USE_STATS
+            if (receiveResult >= 0)
+                sfdxd_stats_rtt(sfdxdp, start);
+#endif
+#if SFDX_MASTER_IDLE_MAX_MS > 0
+            /* Only a connected master idles, a connection is set up at the
+               full request rate. */
+            sfdxd_idle(sfdxdp, (idle == TRUE) && (receiveResult == 0) &&
+                    (sfdxdp->connected == TRUE));
+#endif
         }
         else
         {
@@ -212,10 +1051,8 @@ static void sfdxd_pump(void* parameters)
         {
             osalSysLock();
 
-            chSymQResetI(&sfdxdp->oqueue);
-            chSymQResetI(&sfdxdp->iqueue);
             sfdxdp->connected = TRUE;
-            chnAddFlagsI(sfdxdp, CHN_CONNECTED);
+            sfdxd_resetI(sfdxdp, CHN_CONNECTED);
 
             osalOsRescheduleS();
             osalSysUnlock();
@@ -226,9 +1063,7 @@ static void sfdxd_pump(void* parameters)
             osalSysLock();
 
             sfdxdp->connected = FALSE;
-            chnAddFlagsI(sfdxdp, CHN_DISCONNECTED);
-            chSymQResetI(&sfdxdp->oqueue);
-            chSymQResetI(&sfdxdp->iqueue);
+            sfdxd_resetI(sfdxdp, CHN_DISCONNECTED);
 
             osalOsRescheduleS();
             osalSysUnlock();
@@ -244,6 +1079,9 @@ static msg_t putt(void* ip, uint8_t b, systime_t timeout)
 {
     SerialFdxDriver* sfdxdp = (SerialFdxDriver*)ip;
     size_t result = chSymQPutTimeout(&sfdxdp->oqueue, b, timeout);
+#if SFDX_MASTER_IDLE_MAX_MS > 0
+    sfdxd_wakeup(sfdxdp);
+#endif
     return result;
 }
 
@@ -258,6 +1096,9 @@ static size_t writet(void* ip, const uint8_t* bp, size_t n, systime_t timeout)
 {
     SerialFdxDriver* sfdxdp = (SerialFdxDriver*)ip;
     size_t result = chSymQWriteTimeout(&sfdxdp->oqueue, bp, n, TIME_INFINITE);
+#if SFDX_MASTER_IDLE_MAX_MS > 0
+    sfdxd_wakeup(sfdxdp);
+#endif
     return result;
 }
 
@@ -295,6 +1136,73 @@ static const struct SerialFdxDriverVMT vmt =
     putt, gett, writet, readt
 };
 
+#if SERIAL_FDX_CHANNELS > 1
+/*
+ * Additional channels interface implementation.
+ */
+static msg_t chputt(void* ip, uint8_t b, systime_t timeout)
+{
+    SerialFdxChannel* sfdxcp = (SerialFdxChannel*)ip;
+    size_t result = chSymQPutTimeout(&sfdxcp->oqueue, b, timeout);
+#if SFDX_MASTER_IDLE_MAX_MS > 0
+    sfdxd_wakeup(sfdxcp->driverp);
+#endif
+    return result;
+}
+
+static msg_t chgett(void* ip, systime_t timeout)
+{
+    SerialFdxChannel* sfdxcp = (SerialFdxChannel*)ip;
+    size_t result = chSymQGetTimeout(&sfdxcp->iqueue, timeout);
+    return result;
+}
+
+static size_t chwritet(void* ip, const uint8_t* bp, size_t n,
+        systime_t timeout)
+{
+    SerialFdxChannel* sfdxcp = (SerialFdxChannel*)ip;
+    size_t result = chSymQWriteTimeout(&sfdxcp->oqueue, bp, n, timeout);
+#if SFDX_MASTER_IDLE_MAX_MS > 0
+    sfdxd_wakeup(sfdxcp->driverp);
+#endif
+    return result;
+}
+
+static size_t chreadt(void* ip, uint8_t* bp, size_t n, systime_t timeout)
+{
+    SerialFdxChannel* sfdxcp = (SerialFdxChannel*)ip;
+    size_t result = chSymQReadTimeout(&sfdxcp->iqueue, bp, n, timeout);
+    return result;
+}
+
+static size_t chwrite(void* ip, const uint8_t* bp, size_t n)
+{
+    return chwritet(ip, bp, n, TIME_INFINITE);
+}
+
+static size_t chread(void* ip, uint8_t* bp, size_t n)
+{
+    return chreadt(ip, bp, n, TIME_INFINITE);
+}
+
+static msg_t chput(void* ip, uint8_t b)
+{
+    return chputt(ip, b, TIME_INFINITE);
+}
+
+static msg_t chget(void* ip)
+{
+    return chgett(ip, TIME_INFINITE);
+}
+
+static const struct SerialFdxDriverVMT chvmt =
+{
+    (size_t)0,
+    chwrite, chread, chput, chget,
+    chputt, chgett, chwritet, chreadt
+};
+#endif /* SERIAL_FDX_CHANNELS > 1 */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -325,12 +1233,34 @@ void sfdxdObjectInit(SerialFdxDriver* sfdxdp)
     osalEventObjectInit(&sfdxdp->event);
     sfdxdp->state = SFDXD_STOP;
     sfdxdp->connected = FALSE;
+    sfdxdp->recvpos = 0;
+    sfdxdp->recvlen = 0;
+#if SERIAL_FDX_USE_WINDOW
+    sfdxdp->txbase = 0;
+    sfdxdp->txcount = 0;
+    sfdxdp->rxnext = 0;
+#endif
 
     chSymQObjectInit(&sfdxdp->iqueue, sfdxdp->ib,
             sizeof(sfdxdp->ib));
 
     chSymQObjectInit(&sfdxdp->oqueue, sfdxdp->ob,
             sizeof(sfdxdp->ob));
+#if SERIAL_FDX_USE_STATS
+    memset(&sfdxdp->stats, 0, sizeof(sfdxdp->stats));
+#endif
+
+#if SERIAL_FDX_CHANNELS > 1
+    for (uint8_t id = 1; id < SERIAL_FDX_CHANNELS; id++)
+    {
+        SerialFdxChannel* sfdxcp = &sfdxdp->channels[id - 1];
+        sfdxcp->vmt = &chvmt;
+        osalEventObjectInit(&sfdxcp->event);
+        sfdxcp->driverp = sfdxdp;
+        chSymQObjectInit(&sfdxcp->iqueue, sfdxcp->ib, sizeof(sfdxcp->ib));
+        chSymQObjectInit(&sfdxcp->oqueue, sfdxcp->ob, sizeof(sfdxcp->ob));
+    }
+#endif
 
 #if defined(_CHIBIOS_RT_)
     sfdxdp->tr = NULL;
@@ -346,6 +1276,10 @@ void sfdxdObjectInit(SerialFdxDriver* sfdxdp)
     }
 #endif /* CH_DBG_FILL_THREADS */
 #endif /* defined(_CHIBIOS_RT_) */
+#if SFDX_MASTER_IDLE_MAX_MS > 0
+    sfdxdp->idle = NULL;
+    sfdxdp->idledelay = 0;
+#endif
 }
 
 /**
@@ -364,6 +1298,20 @@ void sfdxdStart(SerialFdxDriver* sfdxdp, const SerialFdxConfig *configp)
     osalSysLock();
     osalDbgAssert((sfdxdp->state == SFDXD_STOP) || (sfdxdp->state == SFDXD_READY),
             "invalid state");
+    osalDbgAssert(configp->mtu == 0 || (configp->mtu >= 4 &&
+            configp->mtu <= SERIAL_FDX_MTU), "invalid MTU");
+#if SERIAL_FDX_USE_WINDOW
+    osalDbgAssert(configp->window <= SERIAL_FDX_WINDOW_MAX, "invalid window");
+    osalDbgAssert(configp->window == 0 || configp->mtu == 0 ||
+            configp->mtu >= SFDX_WINDOW_MTU_MIN, "invalid MTU");
+    sfdxdp->synced = FALSE;
+    sfdxdp->ackpending = FALSE;
+    sfdxdp->txbase += sfdxdp->txcount;
+    sfdxdp->txcount = 0;
+    sfdxdp->txsent = 0;
+    sfdxdp->lasttx = osalOsGetSystemTimeX();
+    sfdxdp->lastrx = sfdxdp->lasttx;
+#endif
     sfdxdp->configp = configp;
     sfdxdp->state = SFDXD_READY;
     sfdxdp->connected = FALSE;
@@ -410,16 +1358,74 @@ void sfdxdStop(SerialFdxDriver* sfdxdp)
             "invalid state");
     sfdxdp->state = SFDXD_STOP;
 
-    if (sfdxdp->connected == TRUE)
-        chnAddFlagsI(sfdxdp, CHN_DISCONNECTED);
-
+    sfdxd_resetI(sfdxdp,
+            sfdxdp->connected == TRUE ? CHN_DISCONNECTED : 0);
     sfdxdp->connected = FALSE;
-
-    chSymQResetI(&sfdxdp->oqueue);
-    chSymQResetI(&sfdxdp->iqueue);
+#if SFDX_MASTER_IDLE_MAX_MS > 0
+    osalThreadResumeI(&sfdxdp->idle, MSG_OK);
+#endif
     osalOsRescheduleS();
     osalSysUnlock();
 }
+
+#if SERIAL_FDX_USE_STATS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the link statistics.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[out] statsp   pointer to a @p SerialFdxStats structure
+ *
+ * @api
+ */
+void sfdxdGetStats(SerialFdxDriver* sfdxdp, SerialFdxStats* statsp)
+{
+    osalDbgCheck((sfdxdp != NULL) && (statsp != NULL));
+
+    osalSysLock();
+    *statsp = sfdxdp->stats;
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Resets the link statistics to zero.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ *
+ * @api
+ */
+void sfdxdResetStats(SerialFdxDriver* sfdxdp)
+{
+    osalDbgCheck(sfdxdp != NULL);
+
+    osalSysLock();
+    memset(&sfdxdp->stats, 0, sizeof(sfdxdp->stats));
+    osalSysUnlock();
+}
+#endif /* SERIAL_FDX_USE_STATS */
+
+#if (SERIAL_FDX_CHANNELS > 1) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a channel multiplexed over the driver link.
+ * @details Channel 0 is the driver itself. Lower numbered channels take
+ *          strict priority, a frame of a higher numbered channel delays
+ *          them by at most a frame.
+ *
+ * @param[in] sfdxdp    pointer to a @p SerialFdxDriver object
+ * @param[in] id        channel number, less than @p SERIAL_FDX_CHANNELS
+ *
+ * @return              The channel.
+ *
+ * @api
+ */
+BaseAsynchronousChannel* sfdxdGetChannel(SerialFdxDriver* sfdxdp, uint8_t id)
+{
+    osalDbgCheck((sfdxdp != NULL) && (id < SERIAL_FDX_CHANNELS));
+
+    if (id == 0)
+        return (BaseAsynchronousChannel*)sfdxdp;
+    return (BaseAsynchronousChannel*)&sfdxdp->channels[id - 1];
+}
+#endif /* SERIAL_FDX_CHANNELS > 1 */
 #endif /* HAL_USE_SERIAL_FDX */
 
 /** @} */
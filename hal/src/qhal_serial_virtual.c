@@ -24,6 +24,8 @@
 
 #if HAL_USE_SERIAL_VIRTUAL || defined(__DOXYGEN__)
 
+#include <string.h>
+
 /*===========================================================================*/
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
@@ -40,143 +42,255 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
-/*
- * Interface implementation, the following functions just invoke the equivalent
- * queue-level function or macro.
+/**
+ * @brief   Pushes data towards the far end without waiting.
+ * @details A far end reader blocked for direct transfer is served first,
+ *          data queued before it was blocked goes ahead. The rest is written
+ *          to the far queue. Flags are raised once per call.
+ *
+ * @param[in] svdp      pointer to a @p SerialVirtualDriver object
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes transferred.
+ *
+ * @sclass
  */
-
-static size_t write(void *ip, const uint8_t *bp, size_t n)
+static size_t sdvirtual_pushS(SerialVirtualDriver *svdp, const uint8_t *bp,
+        size_t n)
 {
-    SerialVirtualDriver *svdp = (SerialVirtualDriver*)ip;
-
-    osalSysLock();
-
+    SerialVirtualDriver *farp = svdp->configp->farp;
     size_t w = 0;
 
-    for (; w < n; ++w)
+    if (farp->rdbuf != NULL)
     {
-        /* Try to write a byte to far queue. */
-        msg_t result = chSymQPutTimeoutS(&svdp->configp->farp->queue, *bp++, TIME_INFINITE);
-        if (result != Q_OK)
+        uint8_t *p;
+        size_t span;
+
+        /* Older queued data first. */
+        while ((farp->rdleft > 0) &&
+                ((span = chSymQReadPeekI(&farp->queue, &p)) > 0))
         {
-            osalOsRescheduleS();
-            osalSysUnlock();
-            return w;
+            if (span > farp->rdleft)
+                span = farp->rdleft;
+            memcpy(farp->rdbuf, p, span);
+            chSymQReadConsumeI(&farp->queue, span);
+            farp->rdbuf += span;
+            farp->rdleft -= span;
         }
 
-        /* Check if far queue was empty and set flag. */
-        if (chSymQSpaceI(&svdp->configp->farp->queue) == 1)
-            chnAddFlagsI(svdp->configp->farp, CHN_INPUT_AVAILABLE);
+        w = (n < farp->rdleft) ? n : farp->rdleft;
+        memcpy(farp->rdbuf, bp, w);
+        farp->rdbuf += w;
+        farp->rdleft -= w;
+
+        if (farp->rdleft == 0)
+        {
+            farp->rdbuf = NULL;
+            osalThreadResumeI(&farp->reader, MSG_OK);
+        }
     }
 
-    osalOsRescheduleS();
-    osalSysUnlock();
+    if (w < n)
+    {
+        bool empty = chSymQIsEmptyI(&farp->queue);
+        size_t q = chSymQWriteI(&farp->queue, bp + w, n - w);
+
+        /* Check if far queue was empty and set flag. */
+        if ((empty == TRUE) && (q > 0))
+            chnAddFlagsI(farp, CHN_INPUT_AVAILABLE);
+        w += q;
+    }
+    else if ((w > 0) && (chSymQIsEmptyI(&farp->queue) == TRUE))
+    {
+        /* Everything went straight to the far end reader. */
+        chnAddFlagsI(svdp, CHN_OUTPUT_EMPTY);
+    }
 
     return w;
 }
 
-static size_t read(void *ip, uint8_t *bp, size_t n)
+/**
+ * @brief   Writes data to the far end.
+ *
+ * @param[in] svdp      pointer to a @p SerialVirtualDriver object
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the amount of data to be transferred
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @param[out] wp       number of bytes transferred
+ * @return              The operation status.
+ *
+ * @sclass
+ */
+static msg_t sdvirtual_writeS(SerialVirtualDriver *svdp, const uint8_t *bp,
+        size_t n, sysinterval_t timeout, size_t *wp)
 {
-    SerialVirtualDriver *svdp = (SerialVirtualDriver*)ip;
-
-    osalSysLock();
-
-    size_t r = 0;
+    SerialVirtualDriver *farp = svdp->configp->farp;
+    systime_t start = osalOsGetSystemTimeX();
+    size_t w = sdvirtual_pushS(svdp, bp, n);
+    msg_t result = Q_OK;
 
-    for (; r < n; ++r)
+    while (w < n)
     {
-        /* Try to get a byte from near queue. */
-        msg_t result = chSymQGetTimeoutS(&svdp->queue, TIME_INFINITE);
-        if (result < Q_OK)
+        /* Calculate remaining timeout. */
+        sysinterval_t this_timeout = timeout;
+        if (timeout != TIME_IMMEDIATE && timeout != TIME_INFINITE)
         {
-            osalOsRescheduleS();
-            osalSysUnlock();
-            return r;
+            if (chVTTimeElapsedSinceX(start) >= timeout)
+            {
+                result = Q_TIMEOUT;
+                break;
+            }
+            this_timeout = timeout - chVTTimeElapsedSinceX(start);
         }
 
-        /* Store it to buffer if successful. */
-        *bp++ = (uint8_t)result;
+        /* Wait for space in the far queue. */
+        result = chSymQPutTimeoutS(&farp->queue, bp[w], this_timeout);
+        if (result != Q_OK)
+            break;
+        w++;
 
-        /* Check if near queue is empty and set flags. */
-        if (chSymQIsEmptyI(&svdp->queue) == TRUE)
-            chnAddFlagsI(svdp->configp->farp, CHN_OUTPUT_EMPTY);
-    }
+        /* Check if far queue was empty and set flag. */
+        if (chSymQSpaceI(&farp->queue) == 1)
+            chnAddFlagsI(farp, CHN_INPUT_AVAILABLE);
 
-    osalOsRescheduleS();
-    osalSysUnlock();
+        /* Also hands the queued data to a reader blocked meanwhile. */
+        w += sdvirtual_pushS(svdp, bp + w, n - w);
+    }
 
-    return r;
+    *wp = w;
+    return result;
 }
 
-static msg_t put(void *ip, uint8_t b)
+/**
+ * @brief   Reads data from the near queue.
+ * @details Queued data is copied at once. If more is wanted, the buffer is
+ *          registered for the far end to write into directly and the thread
+ *          waits until it is filled.
+ *
+ * @param[in] svdp      pointer to a @p SerialVirtualDriver object
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the amount of data to be transferred
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @param[out] rp       number of bytes transferred
+ * @return              The operation status.
+ *
+ * @sclass
+ */
+static msg_t sdvirtual_readS(SerialVirtualDriver *svdp, uint8_t *bp,
+        size_t n, sysinterval_t timeout, size_t *rp)
 {
-    SerialVirtualDriver *svdp = (SerialVirtualDriver*)ip;
+    msg_t result = Q_OK;
+    size_t r = 0;
+    uint8_t *p;
+    size_t span;
 
-    osalSysLock();
+    while ((r < n) && ((span = chSymQReadPeekI(&svdp->queue, &p)) > 0))
+    {
+        if (span > n - r)
+            span = n - r;
+        memcpy(bp + r, p, span);
+        chSymQReadConsumeI(&svdp->queue, span);
+        r += span;
+    }
 
-    /* Try to write a byte to far queue. */
-    msg_t result = chSymQPutTimeoutS(&svdp->configp->farp->queue, b, TIME_INFINITE);
-    if (result != Q_OK)
+    /* Check if near queue is empty and set flags. */
+    if ((r > 0) && (chSymQIsEmptyI(&svdp->queue) == TRUE))
+        chnAddFlagsI(svdp->configp->farp, CHN_OUTPUT_EMPTY);
+
+    if (r < n)
     {
-        osalOsRescheduleS();
-        osalSysUnlock();
-        return result;
+        if (timeout == TIME_IMMEDIATE)
+        {
+            result = Q_TIMEOUT;
+        }
+        else if (svdp->rdbuf == NULL)
+        {
+            /* Waits for the far end to fill the buffer. */
+            svdp->rdbuf = bp + r;
+            svdp->rdleft = n - r;
+            result = osalThreadSuspendTimeoutS(&svdp->reader, timeout);
+            r = n - svdp->rdleft;
+            svdp->rdbuf = NULL;
+            svdp->rdleft = 0;
+        }
+        else
+        {
+            /* Another thread waits for direct transfer, waits on the
+               queue behind it. */
+            size_t q = chSymQReadTimeoutS(&svdp->queue, bp + r, n - r, timeout);
+            if (q < n - r)
+                result = (timeout == TIME_INFINITE) ? Q_RESET : Q_TIMEOUT;
+            r += q;
+        }
     }
 
-    /* Check if far queue was empty and set flag. */
-    if (chSymQSpaceI(&svdp->configp->farp->queue) == 1)
-        chnAddFlagsI(svdp->configp->farp, CHN_INPUT_AVAILABLE);
+    *rp = r;
+    return result;
+}
+
+/*
+ * Interface implementation, the following functions just invoke the driver
+ * transfer functions.
+ */
 
+static size_t write(void *ip, const uint8_t *bp, size_t n)
+{
+    size_t w;
+
+    osalSysLock();
+    (void)sdvirtual_writeS((SerialVirtualDriver*)ip, bp, n, TIME_INFINITE, &w);
     osalOsRescheduleS();
     osalSysUnlock();
 
-    return result;
+    return w;
 }
 
-static msg_t get(void *ip)
+static size_t read(void *ip, uint8_t *bp, size_t n)
 {
-    SerialVirtualDriver *svdp = (SerialVirtualDriver*)ip;
+    size_t r;
 
     osalSysLock();
+    (void)sdvirtual_readS((SerialVirtualDriver*)ip, bp, n, TIME_INFINITE, &r);
+    osalOsRescheduleS();
+    osalSysUnlock();
 
-    /* Try to get a byte from near queue. */
-    msg_t result = chSymQGetTimeoutS(&svdp->queue, TIME_INFINITE);
-    if (result < Q_OK)
-    {
-        osalOsRescheduleS();
-        osalSysUnlock();
-        return result;
-    }
+    return r;
+}
 
-    /* Check if near queue is empty and set flags. */
-    if (chSymQIsEmptyI(&svdp->queue) == TRUE)
-        chnAddFlagsI(svdp->configp->farp, CHN_OUTPUT_EMPTY);
+static msg_t put(void *ip, uint8_t b)
+{
+    size_t w;
 
+    osalSysLock();
+    msg_t result = sdvirtual_writeS((SerialVirtualDriver*)ip, &b, 1,
+            TIME_INFINITE, &w);
     osalOsRescheduleS();
     osalSysUnlock();
 
     return result;
 }
 
-static msg_t putt(void *ip, uint8_t b, systime_t timeout)
+static msg_t get(void *ip)
 {
-    SerialVirtualDriver *svdp = (SerialVirtualDriver*)ip;
+    uint8_t b;
+    size_t r;
 
     osalSysLock();
+    msg_t result = sdvirtual_readS((SerialVirtualDriver*)ip, &b, 1,
+            TIME_INFINITE, &r);
+    osalOsRescheduleS();
+    osalSysUnlock();
 
-    /* Try to write a byte to far queue. */
-    msg_t result = chSymQPutTimeoutS(&svdp->configp->farp->queue, b, timeout);
-    if (result != Q_OK)
-    {
-        osalOsRescheduleS();
-        osalSysUnlock();
-        return result;
-    }
+    return (r == 1) ? (msg_t)b : result;
+}
 
-    /* Check if far queue was empty and set flag. */
-    if (chSymQSpaceI(&svdp->configp->farp->queue) == 1)
-        chnAddFlagsI(svdp->configp->farp, CHN_INPUT_AVAILABLE);
+static msg_t putt(void *ip, uint8_t b, systime_t timeout)
+{
+    size_t w;
 
+    osalSysLock();
+    msg_t result = sdvirtual_writeS((SerialVirtualDriver*)ip, &b, 1,
+            timeout, &w);
     osalOsRescheduleS();
     osalSysUnlock();
 
@@ -185,66 +299,24 @@ static msg_t putt(void *ip, uint8_t b, systime_t timeout)
 
 static msg_t gett(void *ip, systime_t timeout)
 {
-    SerialVirtualDriver *svdp = (SerialVirtualDriver*)ip;
+    uint8_t b;
+    size_t r;
 
     osalSysLock();
-
-    /* Try to get a byte from near queue. */
-    msg_t result = chSymQGetTimeoutS(&svdp->queue, timeout);
-    if (result < Q_OK)
-    {
-        osalOsRescheduleS();
-        osalSysUnlock();
-        return result;
-    }
-
-    /* Check if near queue is empty and set flags. */
-    if (chSymQIsEmptyI(&svdp->queue) == TRUE)
-        chnAddFlagsI(svdp->configp->farp, CHN_OUTPUT_EMPTY);
-
+    msg_t result = sdvirtual_readS((SerialVirtualDriver*)ip, &b, 1,
+            timeout, &r);
     osalOsRescheduleS();
     osalSysUnlock();
 
-    return result;
+    return (r == 1) ? (msg_t)b : result;
 }
 
 static size_t writet(void *ip, const uint8_t *bp, size_t n, systime_t timeout)
 {
-    SerialVirtualDriver *svdp = (SerialVirtualDriver*)ip;
+    size_t w;
 
     osalSysLock();
-
-    size_t w = 0;
-    systime_t start = osalOsGetSystemTimeX();
-
-    for (; w < n; ++w)
-    {
-        /* Calculate remaining timeout. */
-        systime_t this_timeout = timeout;
-        if (timeout != TIME_IMMEDIATE && timeout != TIME_INFINITE)
-        {
-            if (chVTTimeElapsedSinceX(start) >= timeout)
-            {
-                osalSysUnlock();
-                return w;
-            }
-            this_timeout = timeout - chVTTimeElapsedSinceX(start);
-        }
-
-        /* Try to write a byte to far queue. */
-        msg_t result = chSymQPutTimeoutS(&svdp->configp->farp->queue, *bp++, this_timeout);
-        if (result != Q_OK)
-        {
-            osalOsRescheduleS();
-            osalSysUnlock();
-            return w;
-        }
-
-        /* Check if far queue was empty and set flag. */
-        if (chSymQSpaceI(&svdp->configp->farp->queue) == 1)
-            chnAddFlagsI(svdp->configp->farp, CHN_INPUT_AVAILABLE);
-    }
-
+    (void)sdvirtual_writeS((SerialVirtualDriver*)ip, bp, n, timeout, &w);
     osalOsRescheduleS();
     osalSysUnlock();
 
@@ -253,44 +325,10 @@ static size_t writet(void *ip, const uint8_t *bp, size_t n, systime_t timeout)
 
 static size_t readt(void *ip, uint8_t *bp, size_t n, systime_t timeout)
 {
-    SerialVirtualDriver *svdp = (SerialVirtualDriver*)ip;
+    size_t r;
 
     osalSysLock();
-
-    size_t r = 0;
-    systime_t start = osalOsGetSystemTimeX();
-
-    for (; r < n; ++r)
-    {
-        /* Calculate remaining timeout. */
-        systime_t this_timeout = timeout;
-        if (timeout != TIME_IMMEDIATE && timeout != TIME_INFINITE)
-        {
-            if (chVTTimeElapsedSinceX(start) >= timeout)
-            {
-                osalSysUnlock();
-                return r;
-            }
-            this_timeout = timeout - chVTTimeElapsedSinceX(start);
-        }
-
-        /* Try to get a byte from near queue. */
-        msg_t result = chSymQGetTimeoutS(&svdp->queue, this_timeout);
-        if (result < Q_OK)
-        {
-            osalOsRescheduleS();
-            osalSysUnlock();
-            return r;
-        }
-
-        /* Store it to buffer if successful. */
-        *bp++ = (uint8_t)result;
-
-        /* Check if near queue is empty and set flags. */
-        if (chSymQIsEmptyI(&svdp->queue) == TRUE)
-            chnAddFlagsI(svdp->configp->farp, CHN_OUTPUT_EMPTY);
-    }
-
+    (void)sdvirtual_readS((SerialVirtualDriver*)ip, bp, n, timeout, &r);
     osalOsRescheduleS();
     osalSysUnlock();
 
@@ -335,6 +373,9 @@ void sdvirtualObjectInit(SerialVirtualDriver *sdvirtualp)
     sdvirtualp->state = SDVIRTUAL_STOP;
     chSymQObjectInit(&sdvirtualp->queue, sdvirtualp->queuebuf,
             sizeof(sdvirtualp->queuebuf));
+    sdvirtualp->reader = NULL;
+    sdvirtualp->rdbuf = NULL;
+    sdvirtualp->rdleft = 0;
 }
 
 /**
@@ -363,8 +404,8 @@ void sdvirtualStart(SerialVirtualDriver *sdvirtualp, const SerialVirtualConfig *
 
 /**
  * @brief   Stops the driver.
- * @details Any thread waiting on the driver's queues will be awakened with
- *          the message @p Q_RESET.
+ * @details Any thread waiting on the driver's queues or reading directly
+ *          will be awakened with the message @p Q_RESET.
  *
  * @param[in] sdvirtualp    pointer to a @p SerialVirtualDriver object
  *
@@ -379,6 +420,7 @@ void sdvirtualStop(SerialVirtualDriver *sdvirtualp)
                 "invalid state");
     chnAddFlagsI(sdvirtualp, CHN_DISCONNECTED);
     chSymQResetI(&sdvirtualp->queue);
+    osalThreadResumeI(&sdvirtualp->reader, Q_RESET);
     osalOsRescheduleS();
     osalSysUnlock();
 }
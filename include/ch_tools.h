@@ -25,14 +25,65 @@
 /* Pre-compile time settings                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Number of wake-up lateness histogram bins of @p period_stats_t.
+ * @details Bin 0 counts wake-ups on time, bin i counts lateness from
+ *          2^(i-1) up to 2^i - 1 ticks and the last bin counts all later
+ *          wake-ups.
+ */
+#if !defined(CH_TOOLS_PERIOD_STATS_BINS) || defined(__DOXYGEN__)
+#define CH_TOOLS_PERIOD_STATS_BINS 8
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks                                        */
 /*===========================================================================*/
 
+#if CH_TOOLS_PERIOD_STATS_BINS < 1 || CH_TOOLS_PERIOD_STATS_BINS > 33
+#error "CH_TOOLS_PERIOD_STATS_BINS must be within 1 and 33"
+#endif
+
 /*===========================================================================*/
 /* Data structures and types                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Timing statistics of a periodic loop.
+ * @details Updated by @p chThdSleepPeriodStats() and
+ *          @p chEvtWaitAnyPeriodStats(), read with @p chPeriodStatsGet().
+ */
+typedef struct
+{
+    /**
+     * @brief Periods completed.
+     */
+    uint32_t periods;
+    /**
+     * @brief Periods whose end had passed before the loop waited for it.
+     */
+    uint32_t overruns;
+    /**
+     * @brief Longest time from a wake-up to the next wait.
+     */
+    sysinterval_t exec_max;
+    /**
+     * @brief Largest lateness of a period end.
+     */
+    sysinterval_t late_max;
+    /**
+     * @brief Lateness histogram of period ends, in ticks.
+     */
+    uint32_t histogram[CH_TOOLS_PERIOD_STATS_BINS];
+    /**
+     * @brief Time of the last wake-up.
+     */
+    systime_t wakeup;
+    /**
+     * @brief @p wakeup is valid.
+     */
+    bool running;
+} period_stats_t;
+
 /*===========================================================================*/
 /* Macros                                                                    */
 /*===========================================================================*/
@@ -46,10 +97,16 @@ extern "C"
 {
 #endif
     void chThdSleepPeriod(systime_t *previous, sysinterval_t period);
+    void chThdSleepPeriodStats(systime_t *previous, sysinterval_t period,
+            period_stats_t *statsp);
 #if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
     eventmask_t chEvtWaitAnyPeriod(eventmask_t mask, systime_t *previous,
             sysinterval_t period);
+    eventmask_t chEvtWaitAnyPeriodStats(eventmask_t mask, systime_t *previous,
+            sysinterval_t period, period_stats_t *statsp);
 #endif /* CH_CFG_USE_EVENTS || defined(__DOXYGEN__) */
+    void chPeriodStatsObjectInit(period_stats_t *statsp);
+    void chPeriodStatsGet(const period_stats_t *statsp, period_stats_t *copyp);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,131 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    gdglyph.h
+ * @brief   GD glyph cache structures and macros.
+ * @addtogroup gd_glyph
+ * @{
+ */
+
+#ifndef _GDGLYPH_H_
+#define _GDGLYPH_H_
+
+#include "qhal.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of glyphs held by a cache.
+ */
+#if !defined(GD_GLYPH_CACHE_SLOTS) || defined(__DOXYGEN__)
+#define GD_GLYPH_CACHE_SLOTS                16
+#endif
+
+/**
+ * @brief   Largest number of pixels of a cached glyph.
+ * @details Larger glyphs are drawn by @p gdBlit() directly.
+ */
+#if !defined(GD_GLYPH_CACHE_SLOT_SIZE) || defined(__DOXYGEN__)
+#define GD_GLYPH_CACHE_SLOT_SIZE            256
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if GD_GLYPH_CACHE_SLOTS < 1
+#error "GD_GLYPH_CACHE_SLOTS must be at least 1"
+#endif
+
+#if GD_GLYPH_CACHE_SLOT_SIZE < 1
+#error "GD_GLYPH_CACHE_SLOT_SIZE must be at least 1"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Cached glyph.
+ */
+typedef struct
+{
+    /* First row of the glyph bitmap, NULL if unused.*/
+    const void *data;
+    /* Bytes from one row to the next.*/
+    size_t stride;
+    /* Column of the glyph within the bitmap.*/
+    coord_t x;
+    /* Size of the glyph.*/
+    coord_t width;
+    coord_t height;
+    /* Colors of set and cleared bits.*/
+    color_t fg;
+    color_t bg;
+    /* Stamp of the last use.*/
+    uint32_t stamp;
+} GDGlyphEntry;
+
+/**
+ * @brief   Cache of glyphs converted to @p color_t.
+ * @details Holds @p GD_BLIT_MASK1 glyphs converted for a foreground and
+ *          background color, each cached glyph is drawn by a single stream
+ *          write. The least recently used glyph is replaced on a miss.
+ * @note    Glyphs are identified by their bitmap address, the bitmaps must
+ *          not change while cached.
+ */
+typedef struct
+{
+    /* Cached glyphs.*/
+    GDGlyphEntry entries[GD_GLYPH_CACHE_SLOTS];
+    /* Converted pixels of each entry, row by row.*/
+    color_t pixels[GD_GLYPH_CACHE_SLOTS][GD_GLYPH_CACHE_SLOT_SIZE];
+    /* Stamp of the last use of any entry.*/
+    uint32_t stamp;
+    /* Draws served from the cache.*/
+    uint32_t hits;
+    /* Draws converting the glyph.*/
+    uint32_t misses;
+} GDGlyphCache;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void gdglyphObjectInit(GDGlyphCache *cachep);
+    void gdglyphFlush(GDGlyphCache *cachep);
+    void gdglyphDraw(GDGlyphCache *cachep, BaseGDDevice *ip, coord_t left,
+            coord_t top, coord_t width, coord_t height,
+            const GDBlitSource *srcp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GDGLYPH_H_ */
+
+/** @} */
@@ -15,18 +15,115 @@
 #ifndef MODULE_INIT_H_
 #define MODULE_INIT_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+/*===========================================================================*/
+/* Constants                                                                 */
+/*===========================================================================*/
+
+/**
+ * @name    Module flags
+ * @{
+ */
+/**
+ * @brief   The start function runs on a worker thread.
+ * @details Only effective with @p MODULE_INIT_USE_ASYNC.
+ */
+#define MODULE_ASYNC 0x01
+/** @} */
+
+/*===========================================================================*/
+/* Pre-compile time settings                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts modules flagged @p MODULE_ASYNC on worker threads.
+ * @details @p MODULE_START_ALL() becomes @p moduleStartAll() which is
+ *          implemented by @p module_init.c.
+ */
+#if !defined(MODULE_INIT_USE_ASYNC) || defined(__DOXYGEN__)
+#define MODULE_INIT_USE_ASYNC FALSE
+#endif
+
+/**
+ * @brief   Number of worker threads starting modules concurrently.
+ */
+#if !defined(MODULE_INIT_WORKERS) || defined(__DOXYGEN__)
+#define MODULE_INIT_WORKERS 2
+#endif
+
+/**
+ * @brief   Worker thread stack size.
+ * @details The start functions of asynchronous modules run on this stack.
+ */
+#if !defined(MODULE_INIT_STACK_SIZE) || defined(__DOXYGEN__)
+#define MODULE_INIT_STACK_SIZE 1024
+#endif
+
+/**
+ * @brief   Worker thread priority.
+ */
+#if !defined(MODULE_INIT_PRIO) || defined(__DOXYGEN__)
+#define MODULE_INIT_PRIO NORMALPRIO
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks                                        */
+/*===========================================================================*/
+
+#if MODULE_INIT_USE_ASYNC && MODULE_INIT_WORKERS < 1
+#error "MODULE_INIT_WORKERS must be at least 1"
+#endif
+
+/*===========================================================================*/
+/* Data structures and types                                                 */
+/*===========================================================================*/
+
 typedef void (*initcall_t)(void);
 
-typedef struct
+/**
+ * @brief   Start state of a module.
+ */
+typedef enum
+{
+    MODULE_PENDING = 0,                     /**< Not started yet.           */
+    MODULE_STARTING = 1,                    /**< Start function running.    */
+    MODULE_STARTED = 2,                     /**< Start function returned.   */
+} module_state_t;
+
+typedef struct initmodule initmodule_t;
+
+struct initmodule
 {
     initcall_t fn_minit;
     initcall_t fn_mstart;
     initcall_t fn_mstop;
-} initmodule_t;
+    /**
+     * @brief Modules started before this one.
+     */
+    const initmodule_t *const *deps;
+    /**
+     * @brief Number of @p deps.
+     */
+    uint32_t deps_num;
+    /**
+     * @brief Module flags.
+     */
+    uint32_t flags;
+    /**
+     * @brief Start state, NULL for modules nobody depends on.
+     */
+    volatile module_state_t *statep;
+};
 
 // variables from linker script
 extern initmodule_t __module_initcall_start[], __module_initcall_end[];
 
+/*===========================================================================*/
+/* Macros                                                                    */
+/*===========================================================================*/
+
 /* initcalls are now grouped by functionality into separate
  * subsections. Ordering inside the subsections is determined
  * by link order.
@@ -43,6 +140,47 @@ extern initmodule_t __module_initcall_start[], __module_initcall_end[];
 #define MODULE_INITCALL(level, initfn, startfn, stopfn) \
     __define_module_initcall(level, initfn, startfn, stopfn)
 
+/**
+ * @brief   Declares a module registered in another file.
+ *
+ * @param[in] name      identifier given to @p MODULE_INITCALL_EX()
+ */
+#define MODULE_DECLARE(name) extern const initmodule_t __initmodule_##name
+
+/**
+ * @brief   Returns the table entry of a module.
+ *
+ * @param[in] name      identifier given to @p MODULE_INITCALL_EX()
+ */
+#define MODULE_REF(name) (&__initmodule_##name)
+
+/**
+ * @brief   Registers a module with dependencies.
+ * @details The start function runs once the start functions of all
+ *          dependencies returned. Without @p MODULE_INIT_USE_ASYNC modules
+ *          start in table order, dependencies must be placed at a lower
+ *          level then.
+ *
+ * @param[in] level     initcall level
+ * @param[in] name      unique identifier of the module
+ * @param[in] initfn    init function or NULL
+ * @param[in] startfn   start function or NULL
+ * @param[in] stopfn    stop function or NULL
+ * @param[in] modflags  module flags, e.g. @p MODULE_ASYNC
+ * @param[in] ...       dependencies given by @p MODULE_REF()
+ */
+#define MODULE_INITCALL_EX(level, name, initfn, startfn, stopfn, modflags, ...)\
+    static volatile module_state_t __initmodule_state_##name;                  \
+    static const initmodule_t *const __initmodule_deps_##name[] =              \
+        { NULL, ##__VA_ARGS__ };                                               \
+    const initmodule_t __initmodule_##name __attribute__((__used__))           \
+    __attribute__((__section__(".initcall." #level ".init")))                  \
+    = { .fn_minit = initfn, .fn_mstart = startfn, .fn_mstop = stopfn,          \
+        .deps = &__initmodule_deps_##name[1],                                  \
+        .deps_num = sizeof(__initmodule_deps_##name) /                         \
+            sizeof(__initmodule_deps_##name[0]) - 1,                           \
+        .flags = modflags, .statep = &__initmodule_state_##name };
+
 #define MODULE_INITIALISE_ALL()                                                \
     {                                                                          \
         for (initmodule_t *fn = __module_initcall_start;                       \
@@ -54,6 +192,14 @@ extern initmodule_t __module_initcall_start[], __module_initcall_end[];
         }                                                                      \
     }
 
+#if MODULE_INIT_USE_ASYNC || defined(__DOXYGEN__)
+/**
+ * @brief   Starts all modules.
+ * @details Returns once all modules not flagged @p MODULE_ASYNC started,
+ *          use @p moduleWait() or @p moduleWaitAll() for the others.
+ */
+#define MODULE_START_ALL() moduleStartAll()
+#else
 #define MODULE_START_ALL()                                                     \
     {                                                                          \
         for (initmodule_t *fn = __module_initcall_start;                       \
@@ -62,9 +208,16 @@ extern initmodule_t __module_initcall_start[], __module_initcall_end[];
         {                                                                      \
             if (fn->fn_mstart)                                                 \
                 (fn->fn_mstart)();                                             \
+            if (fn->statep)                                                    \
+                *fn->statep = MODULE_STARTED;                                  \
         }                                                                      \
     }
+#endif /* MODULE_INIT_USE_ASYNC */
 
+/**
+ * @brief   Stops all modules in reverse table order.
+ * @note    Wait for asynchronous starts to complete first.
+ */
 #define MODULE_STOP_ALL()                                                      \
     {                                                                          \
         for (initmodule_t *fn = __module_initcall_end - 1;                     \
@@ -75,7 +228,26 @@ extern initmodule_t __module_initcall_start[], __module_initcall_end[];
         {                                                                      \
             if (fn->fn_mstop)                                                  \
                 (fn->fn_mstop)();                                              \
+            if (fn->statep)                                                    \
+                *fn->statep = MODULE_PENDING;                                  \
         }                                                                      \
     }
 
+/*===========================================================================*/
+/* External declarations                                                     */
+/*===========================================================================*/
+
+#if MODULE_INIT_USE_ASYNC || defined(__DOXYGEN__)
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void moduleStartAll(void);
+    void moduleWait(const initmodule_t *modp);
+    void moduleWaitAll(void);
+#ifdef __cplusplus
+}
+#endif
+#endif /* MODULE_INIT_USE_ASYNC */
+
 #endif /* MODULE_INIT_H_ */
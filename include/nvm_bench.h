@@ -0,0 +1,161 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef NVM_BENCH_H_
+#define NVM_BENCH_H_
+
+#include "qhal.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*===========================================================================*/
+/* Constants                                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Pre-compile time settings                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Largest operation size supported by the benchmark.
+ */
+#if !defined(NVM_BENCH_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_BENCH_BUFFER_SIZE 256
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Data structures and types                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Benchmark workloads.
+ */
+typedef enum
+{
+    NVM_BENCH_RANDOM_WRITE = 0,     /**< Small writes at random addresses.  */
+    NVM_BENCH_SEQUENTIAL_FILL = 1,  /**< Writes filling the device in order.*/
+    NVM_BENCH_READ_MOSTLY = 2,      /**< Nine random reads per write.       */
+    NVM_BENCH_CHURN = 3,            /**< Rewrites of a small hot set.       */
+} nvmbenchworkload_t;
+
+/**
+ * @brief   Free running counter used to take latencies.
+ */
+typedef uint32_t (*nvmbenchclock_t)(void);
+
+/**
+ * @brief   Benchmark configuration structure.
+ */
+typedef struct
+{
+    /**
+     * @brief Workload to run.
+     */
+    nvmbenchworkload_t workload;
+    /**
+     * @brief Top of the nvm stack under test.
+     * @note  The device must accept rewrites of programmed data, as e.g.
+     *        the FEE or memory backed devices do.
+     */
+    BaseNVMDevice* nvmp;
+#if HAL_USE_NVM_TRACE || defined(__DOXYGEN__)
+    /**
+     * @brief Optional trace driver at the bottom of the stack or @p NULL.
+     * @details Its statistics are reset before the run and yield the
+     *          traffic on the lowest level.
+     */
+    NVMTraceDriver* tracep;
+#endif /* HAL_USE_NVM_TRACE */
+    /**
+     * @brief Number of bytes of @p nvmp used by the workload.
+     */
+    uint32_t size;
+    /**
+     * @brief Number of operations.
+     */
+    uint32_t ops;
+    /**
+     * @brief Bytes per read or write, up to @p NVM_BENCH_BUFFER_SIZE.
+     */
+    uint32_t op_size;
+    /**
+     * @brief Writes between syncs, 0 syncs once at the end.
+     */
+    uint32_t sync_every;
+    /**
+     * @brief Seed of the pseudo random sequence.
+     */
+    uint32_t seed;
+    /**
+     * @brief Counter to take latencies from or @p NULL for the system time.
+     */
+    nvmbenchclock_t clock;
+    /**
+     * @brief Frequency of @p clock in Hz.
+     */
+    uint32_t clock_frequency;
+    /**
+     * @brief Optional array of @p ops entries receiving the latencies.
+     * @details Required to report percentiles.
+     */
+    uint32_t* samples;
+} NVMBenchConfig;
+
+/**
+ * @brief   Benchmark results.
+ * @note    Times are in @p clock units.
+ */
+typedef struct
+{
+    uint32_t ops;                   /**< Operations performed.              */
+    uint32_t failures;              /**< Operations which failed.           */
+    uint32_t bytes_read;            /**< Bytes read from the stack.         */
+    uint32_t bytes_written;         /**< Bytes written to the stack.        */
+    uint32_t time;                  /**< Duration including syncs.          */
+    uint32_t ops_per_s;             /**< Operations per second.             */
+    uint32_t latency_p50;           /**< Median latency.                    */
+    uint32_t latency_p99;           /**< 99th percentile latency.           */
+    uint32_t latency_max;           /**< Longest latency.                   */
+    uint32_t lower_writes;          /**< Writes on the lowest level.        */
+    uint32_t lower_bytes_written;   /**< Bytes written on the lowest level. */
+    uint32_t lower_erases;          /**< Erases on the lowest level.        */
+    uint32_t lower_bytes_erased;    /**< Bytes erased on the lowest level.  */
+} NVMBenchResult;
+
+/*===========================================================================*/
+/* Macros                                                                    */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations                                                     */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    bool nvmbenchRun(const NVMBenchConfig* configp, NVMBenchResult* resultp);
+    int nvmbenchFormat(char* buffer, size_t size, const char* name,
+            const NVMBenchConfig* configp, const NVMBenchResult* resultp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NVM_BENCH_H_ */
@@ -18,10 +18,66 @@
 #include "qhal.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+/**
+ * @brief   Size of the stack buffer used by @p nvmcmp().
+ * @note    Half of the buffer is used for each device.
+ */
+#if !defined(NVM_TOOLS_CMP_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_TOOLS_CMP_BUFFER_SIZE 128
+#endif
+
+/**
+ * @brief   Size of the stack buffer used by @p nvmcpy() and @p nvmset().
+ */
+#if !defined(NVM_TOOLS_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_TOOLS_BUFFER_SIZE 64
+#endif
+
+/**
+ * @brief   Size of the stack buffer used by @p nvmcrc32().
+ */
+#if !defined(NVM_TOOLS_CRC_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_TOOLS_CRC_BUFFER_SIZE 128
+#endif
+
+/**
+ * @brief   Uses the slicing by 8 algorithm for software CRC32.
+ * @note    Costs 8k of constant tables, the bitwise fallback is slow.
+ */
+#if !defined(NVM_TOOLS_CRC_USE_SLICING) || defined(__DOXYGEN__)
+#define NVM_TOOLS_CRC_USE_SLICING TRUE
+#endif
+
+/**
+ * @brief   Uses the CRC unit of the port for @p nvmcrc32().
+ * @note    Requires a port providing @p qhal_crc_lld.h.
+ */
+#if !defined(NVM_TOOLS_USE_HW_CRC) || defined(__DOXYGEN__)
+#define NVM_TOOLS_USE_HW_CRC FALSE
+#endif
+
+#if NVM_TOOLS_CRC_BUFFER_SIZE % 4 != 0
+#error "NVM_TOOLS_CRC_BUFFER_SIZE must be a multiple of 4"
+#endif
+
 int nvmcmp(BaseNVMDevice* devap, BaseNVMDevice* devbp, uint32_t n);
+int nvmcmpex(BaseNVMDevice* devap, uint32_t addra, BaseNVMDevice* devbp,
+        uint32_t addrb, uint32_t n, uint8_t* bufferp, size_t size);
 bool nvmcpy(BaseNVMDevice* dstp, BaseNVMDevice* srcp, uint32_t n);
+bool nvmcpyex(BaseNVMDevice* dstp, uint32_t dstaddr, BaseNVMDevice* srcp,
+        uint32_t srcaddr, uint32_t n, uint8_t* bufferp, size_t size);
+#if HAL_USE_NVM_ASYNC || defined(__DOXYGEN__)
+bool nvmcpyasync(NVMAsyncDriver* nvmasyncp, BaseNVMDevice* dstp,
+        uint32_t dstaddr, BaseNVMDevice* srcp, uint32_t srcaddr, uint32_t n,
+        uint8_t* bufferp, size_t size);
+#endif /* HAL_USE_NVM_ASYNC */
 bool nvmset(BaseNVMDevice* dstp, uint8_t pattern, uint32_t n);
+bool nvmsetex(BaseNVMDevice* dstp, uint32_t dstaddr, uint8_t pattern,
+        uint32_t n, uint8_t* bufferp, size_t size);
+bool nvmcrc32(BaseNVMDevice* devp, uint32_t addr, uint32_t n,
+        uint32_t* crcp);
 
 #endif /* NVM_TOOLS_H_ */
@@ -0,0 +1,224 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    nvmbatch.h
+ * @brief   Batched sample logger structures and macros.
+ * @addtogroup nvm_batch
+ * @{
+ */
+
+#ifndef _NVMBATCH_H_
+#define _NVMBATCH_H_
+
+#include "qhal.h"
+#include "nvmlog.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Format identifier in the first byte of a batch record.
+ */
+#define NVM_BATCH_FORMAT                    0x01
+
+/**
+ * @brief   Largest encoded size of a sample.
+ */
+#define NVM_BATCH_SAMPLE_MAX                11
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of each of the two batch buffers.
+ * @details Batches are flushed once full, so the buffers should be about
+ *          as large as @p nvmlogMaxRecordSize() for one record per log
+ *          sector.
+ */
+#if !defined(NVM_BATCH_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define NVM_BATCH_BUFFER_SIZE               256
+#endif
+
+/**
+ * @brief   Number of sample channels.
+ */
+#if !defined(NVM_BATCH_CHANNELS) || defined(__DOXYGEN__)
+#define NVM_BATCH_CHANNELS                  8
+#endif
+
+/**
+ * @brief   Writer thread stack size.
+ */
+#if !defined(NVM_BATCH_STACK_SIZE) || defined(__DOXYGEN__)
+#define NVM_BATCH_STACK_SIZE                512
+#endif
+
+/**
+ * @brief   Writer thread priority.
+ */
+#if !defined(NVM_BATCH_PRIO) || defined(__DOXYGEN__)
+#define NVM_BATCH_PRIO                      LOWPRIO
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if NVM_BATCH_BUFFER_SIZE < 6 + NVM_BATCH_SAMPLE_MAX
+#error "NVM_BATCH_BUFFER_SIZE too small"
+#endif
+
+#if NVM_BATCH_CHANNELS < 1 || NVM_BATCH_CHANNELS > 256
+#error "NVM_BATCH_CHANNELS must be between 1 and 256"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Timestamped sample.
+ */
+typedef struct
+{
+    /* System time of the sample.*/
+    systime_t timestamp;
+    /* Channel, below NVM_BATCH_CHANNELS.*/
+    uint8_t channel;
+    /* Sample value.*/
+    int32_t value;
+} NVMBatchSample;
+
+/**
+ * @brief   Batch logger configuration structure.
+ */
+typedef struct
+{
+    /* Mounted log receiving the batches.*/
+    NVMLog *logp;
+    /* Batch size flushed, 0 for the largest size fitting buffer and log.*/
+    size_t size;
+    /* Largest age of the oldest sample of a batch, TIME_INFINITE for none.*/
+    sysinterval_t max_age;
+} NVMBatchConfig;
+
+/**
+ * @brief   Batch logger statistics.
+ */
+typedef struct
+{
+    /* Samples accepted.*/
+    uint32_t samples;
+    /* Samples dropped while both buffers were busy.*/
+    uint32_t dropped;
+    /* Batches appended to the log.*/
+    uint32_t batches;
+    /* Batches lost by failed appends.*/
+    uint32_t errors;
+} NVMBatchStats;
+
+/**
+ * @brief   Delta encoding state of a batch.
+ */
+typedef struct
+{
+    /* Timestamp of the previous sample.*/
+    systime_t timestamp;
+    /* Previous value of each channel.*/
+    int32_t last[NVM_BATCH_CHANNELS];
+} NVMBatchState;
+
+/**
+ * @brief   Logger collecting samples into batches appended to a @p NVMLog.
+ * @details Samples are delta encoded into one of two RAM buffers. A full
+ *          or aged buffer is handed to a writer thread appending it as
+ *          a single record while the other buffer collects the following
+ *          samples.
+ */
+typedef struct
+{
+    /* Current configuration.*/
+    const NVMBatchConfig *config;
+    /* Size at which a batch is flushed.*/
+    size_t limit;
+    /* Batch buffers.*/
+    uint8_t buffers[2][NVM_BATCH_BUFFER_SIZE];
+    /* Buffer collecting samples.*/
+    uint8_t fill;
+    /* Encoded size of the collecting buffer, 0 if empty.*/
+    size_t fill_n;
+    /* Encoded size of the buffer being flushed, 0 if free.*/
+    size_t flush_n;
+    /* Encoding state of the collecting buffer.*/
+    NVMBatchState state;
+    /* System time the collecting buffer received its first sample.*/
+    systime_t since;
+    /* Logging enabled.*/
+    bool running;
+    /* Statistics.*/
+    NVMBatchStats stats;
+    /* Writer thread or NULL if not created yet.*/
+    thread_t *tp;
+    /* Writer thread while waiting.*/
+    thread_reference_t wait;
+    /* Thread waiting for the writer to stop.*/
+    thread_reference_t stopper;
+    /* Working area of the writer thread.*/
+    THD_WORKING_AREA(wa, NVM_BATCH_STACK_SIZE);
+} NVMBatchLogger;
+
+/**
+ * @brief   Decoder of a batch record read from the log.
+ */
+typedef struct
+{
+    /* Next byte to decode.*/
+    const uint8_t *p;
+    /* End of the record.*/
+    const uint8_t *end;
+    /* Decoding state.*/
+    NVMBatchState state;
+} NVMBatchDecoder;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmbatchObjectInit(NVMBatchLogger *batchp);
+    void nvmbatchStart(NVMBatchLogger *batchp, const NVMBatchConfig *config);
+    void nvmbatchStop(NVMBatchLogger *batchp);
+    bool nvmbatchPut(NVMBatchLogger *batchp, uint8_t channel,
+            systime_t timestamp, int32_t value);
+    void nvmbatchFlush(NVMBatchLogger *batchp);
+    void nvmbatchGetStats(NVMBatchLogger *batchp, NVMBatchStats *statsp);
+    bool nvmbatchDecoderInit(NVMBatchDecoder *decp, const uint8_t *datap,
+            size_t n);
+    bool nvmbatchDecoderNext(NVMBatchDecoder *decp, NVMBatchSample *samplep);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NVMBATCH_H_ */
+
+/** @} */
@@ -0,0 +1,119 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    nvmlog.h
+ * @brief   NVM record log structures and macros.
+ *
+ * @addtogroup nvm_log
+ * @{
+ */
+
+#ifndef _NVMLOG_H_
+#define _NVMLOG_H_
+
+#include "qhal.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Magic identifying a log sector header.
+ */
+#define NVM_LOG_MAGIC                       0x474f4c4eUL
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Position within a @p NVMLog used to read records.
+ */
+typedef struct
+{
+    /* Sector of the next record.*/
+    uint32_t sector;
+    /* Offset of the next record within the sector.*/
+    uint32_t offset;
+} NVMLogCursor;
+
+/**
+ * @brief   Append only record log on a @p BaseNVMDevice.
+ * @details Every sector starts with a header holding a sequence number
+ *          incremented for each sector taken into use. Records follow as
+ *          length prefixed frames and never cross sectors. Once all
+ *          sectors are used the oldest one is erased and reused.
+ */
+typedef struct
+{
+    /* Pointer to the nvm device.*/
+    BaseNVMDevice *nvmdp;
+    /* Sector size of the device.*/
+    uint32_t sector_size;
+    /* Number of sectors of the device.*/
+    uint32_t sector_num;
+    /* Write alignment of the device, at least 1.*/
+    uint32_t align;
+    /* Size of the sector header padded to the alignment.*/
+    uint32_t sector_header_size;
+    /* Size of the record header padded to the alignment.*/
+    uint32_t record_header_size;
+    /* The log holds at least one sector.*/
+    bool mounted;
+    /* Oldest sector.*/
+    uint32_t head;
+    /* Sector being appended to.*/
+    uint32_t tail;
+    /* Sequence number of the tail sector.*/
+    uint32_t sequence;
+    /* Offset of the next record within the tail sector.*/
+    uint32_t tail_offset;
+} NVMLog;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmlogObjectInit(NVMLog *logp, BaseNVMDevice *nvmdp);
+    bool nvmlogMount(NVMLog *logp);
+    bool nvmlogFormat(NVMLog *logp);
+    bool nvmlogAppend(NVMLog *logp, const uint8_t *datap, size_t n);
+    bool nvmlogSync(NVMLog *logp);
+    size_t nvmlogMaxRecordSize(NVMLog *logp);
+    void nvmlogRewind(NVMLog *logp, NVMLogCursor *cursorp);
+    bool nvmlogNext(NVMLog *logp, NVMLogCursor *cursorp, uint8_t *buffer,
+            size_t size, size_t *np);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NVMLOG_H_ */
+
+/** @} */
@@ -0,0 +1,197 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    nvmscrub.h
+ * @brief   NVM background scrubber structures and macros.
+ * @addtogroup nvm_scrub
+ * @{
+ */
+
+#ifndef _NVMSCRUB_H_
+#define _NVMSCRUB_H_
+
+#include "qhal.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Scrubber event flags
+ * @{
+ */
+/**
+ * @brief   A sector does not match its checksum or the copies of a mirror
+ *          sector differ and none of them matches.
+ */
+#define NVM_SCRUB_EVENT_MISMATCH            ((eventflags_t)1)
+/**
+ * @brief   A damaged mirror sector has been repaired.
+ */
+#define NVM_SCRUB_EVENT_REPAIRED            ((eventflags_t)2)
+/**
+ * @brief   Reading or repairing a sector failed.
+ */
+#define NVM_SCRUB_EVENT_ERROR               ((eventflags_t)4)
+/**
+ * @brief   All sectors have been checked once more.
+ */
+#define NVM_SCRUB_EVENT_PASS                ((eventflags_t)8)
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Scrubber thread stack size.
+ */
+#if !defined(NVM_SCRUB_STACK_SIZE) || defined(__DOXYGEN__)
+#define NVM_SCRUB_STACK_SIZE                512
+#endif
+
+/**
+ * @brief   Scrubber thread priority.
+ */
+#if !defined(NVM_SCRUB_PRIO) || defined(__DOXYGEN__)
+#define NVM_SCRUB_PRIO                      LOWPRIO
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Checksum state of a sector.
+ */
+typedef enum
+{
+    NVM_SCRUB_UNKNOWN = 0,                  /**< No checksum recorded yet.  */
+    NVM_SCRUB_KNOWN = 1,                    /**< Checksum recorded.         */
+    NVM_SCRUB_BAD = 2,                      /**< Mismatch reported.         */
+} NVMScrubState;
+
+/**
+ * @brief   Checksum of a sector.
+ */
+typedef struct
+{
+    /* CRC32 of the sector contents.*/
+    uint32_t crc;
+    /* Checksum state.*/
+    NVMScrubState state;
+} NVMScrubSector;
+
+/**
+ * @brief   Scrubber configuration structure.
+ */
+typedef struct
+{
+    /* Device to check, ignored if mirrorp is set.*/
+    BaseNVMDevice *nvmp;
+#if HAL_USE_NVM_MIRROR || defined(__DOXYGEN__)
+    /* Mirror whose copies are compared and repaired or NULL.*/
+    NVMMirrorDriver *mirrorp;
+#endif /* HAL_USE_NVM_MIRROR */
+    /* Array of one NVMScrubSector per sector of the device.*/
+    NVMScrubSector *sectors;
+    /* Number of sectors checked per interval, not zero.*/
+    uint32_t sectors_per_interval;
+    /* Time between checks.*/
+    sysinterval_t interval;
+} NVMScrubConfig;
+
+/**
+ * @brief   Scrubber statistics.
+ */
+typedef struct
+{
+    /* Completed passes over all sectors.*/
+    uint32_t passes;
+    /* Sectors found damaged.*/
+    uint32_t mismatches;
+    /* Mirror sectors repaired.*/
+    uint32_t repairs;
+    /* Failed reads or repairs.*/
+    uint32_t errors;
+} NVMScrubStats;
+
+/**
+ * @brief   Background scrubber of a @p BaseNVMDevice.
+ * @details A low priority thread checks a few sectors per interval. The
+ *          checksum of each sector is recorded on its first check and
+ *          compared on the following ones. Mirror sectors are checked by
+ *          comparing the checksums of both copies, a damaged copy is
+ *          repaired from the copy matching the recorded checksum.
+ */
+typedef struct
+{
+    /* Current configuration.*/
+    const NVMScrubConfig *config;
+    /* Device being checked.*/
+    BaseNVMDevice *nvmp;
+    /* Sector size of the device.*/
+    uint32_t sector_size;
+    /* Number of sectors of the device.*/
+    uint32_t sector_num;
+    /* Sector checked next.*/
+    uint32_t next;
+    /* Incremented by each invalidation.*/
+    uint32_t generation;
+    /* Scrubbing enabled.*/
+    bool running;
+    /* Statistics.*/
+    NVMScrubStats stats;
+    /* Event source broadcasting the scrubber event flags.*/
+    event_source_t event;
+    /* Scrubber thread or NULL if not created yet.*/
+    thread_t *tp;
+    /* Scrubber thread while waiting.*/
+    thread_reference_t wait;
+    /* Thread waiting for the scrubber to stop.*/
+    thread_reference_t stopper;
+    /* Working area of the scrubber thread.*/
+    THD_WORKING_AREA(wa, NVM_SCRUB_STACK_SIZE);
+} NVMScrubber;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void nvmscrubObjectInit(NVMScrubber *scrubp);
+    void nvmscrubStart(NVMScrubber *scrubp, const NVMScrubConfig *config);
+    void nvmscrubStop(NVMScrubber *scrubp);
+    void nvmscrubInvalidate(NVMScrubber *scrubp, uint32_t first,
+            uint32_t num);
+    void nvmscrubGetStats(NVMScrubber *scrubp, NVMScrubStats *statsp);
+    event_source_t *nvmscrubGetEventSource(NVMScrubber *scrubp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NVMSCRUB_H_ */
+
+/** @} */
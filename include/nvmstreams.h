@@ -53,7 +53,19 @@
     /* Current end of stream.*/                                               \
     size_t eos;                                                               \
     /* Current read / write offset.*/                                         \
-    size_t offset;
+    size_t offset;                                                            \
+    /* Optional buffer or NULL.*/                                             \
+    uint8_t *buffer;                                                          \
+    /* Size of the buffer.*/                                                  \
+    size_t buffer_size;                                                       \
+    /* Page size of the device, 0 if unpaged.*/                               \
+    size_t page_size;                                                         \
+    /* Stream offset of the buffered data.*/                                  \
+    size_t buffer_org;                                                        \
+    /* Number of valid bytes in the buffer.*/                                 \
+    size_t buffer_n;                                                          \
+    /* The buffer holds data not yet written.*/                               \
+    bool dirty;
 
 /**
  * @brief   @p NVMStream virtual methods table.
@@ -87,6 +99,9 @@ typedef struct
 extern "C" {
 #endif
     void nvmsObjectInit(NVMStream *nvmsp, BaseNVMDevice *nvmdp, size_t eos);
+    void nvmsObjectInitBuffered(NVMStream *nvmsp, BaseNVMDevice *nvmdp,
+            size_t eos, uint8_t *buffer, size_t size);
+    bool nvmsFlush(NVMStream *nvmsp);
 #ifdef __cplusplus
 }
 #endif
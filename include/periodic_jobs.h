@@ -0,0 +1,165 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef PERIODIC_JOBS_H_
+#define PERIODIC_JOBS_H_
+
+#include "qhal.h"
+
+/*===========================================================================*/
+/* Constants                                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Pre-compile time settings                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum number of registered periodic jobs.
+ */
+#if !defined(PERIODIC_JOBS_MAX) || defined(__DOXYGEN__)
+#define PERIODIC_JOBS_MAX 32
+#endif
+
+/**
+ * @brief   Dispatcher thread stack size.
+ * @details All jobs run on this stack.
+ */
+#if !defined(PERIODIC_JOBS_STACK_SIZE) || defined(__DOXYGEN__)
+#define PERIODIC_JOBS_STACK_SIZE 512
+#endif
+
+/**
+ * @brief   Dispatcher thread priority.
+ */
+#if !defined(PERIODIC_JOBS_PRIO) || defined(__DOXYGEN__)
+#define PERIODIC_JOBS_PRIO NORMALPRIO
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks                                        */
+/*===========================================================================*/
+
+#if PERIODIC_JOBS_MAX < 1
+#error "PERIODIC_JOBS_MAX must be at least 1"
+#endif
+
+/*===========================================================================*/
+/* Data structures and types                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Periodic job function type.
+ * @note    Jobs share the dispatcher thread and must not block, a job
+ *          running late delays all jobs due after it.
+ */
+typedef void (*periodic_fn_t)(void *arg);
+
+/**
+ * @brief   Runtime state of a periodic job.
+ */
+typedef struct
+{
+    /**
+     * @brief Time of the next run.
+     */
+    systime_t due;
+    /**
+     * @brief Periods skipped because the job ran too late.
+     */
+    uint32_t overruns;
+    /**
+     * @brief Longest run time of the job.
+     */
+    sysinterval_t exec_max;
+} periodic_state_t;
+
+/**
+ * @brief   Periodic job table entry.
+ * @details Defined with @p PERIODIC_JOB(), the linker collects all entries
+ *          into one table.
+ */
+typedef struct
+{
+    /**
+     * @brief Job function.
+     */
+    periodic_fn_t fn;
+    /**
+     * @brief Argument of @p fn.
+     */
+    void *arg;
+    /**
+     * @brief Period, not zero.
+     */
+    sysinterval_t period;
+    /**
+     * @brief Delay of the first run after @p periodicJobsStart().
+     */
+    sysinterval_t phase;
+    /**
+     * @brief Runtime state.
+     */
+    periodic_state_t *statep;
+} periodic_job_t;
+
+// variables from linker script
+extern const periodic_job_t __periodic_jobs_start[], __periodic_jobs_end[];
+
+/*===========================================================================*/
+/* Macros                                                                    */
+/*===========================================================================*/
+
+/**
+ * @brief   Registers a periodic job.
+ * @details Jobs due at the same time run in the order of their names.
+ *
+ * @param[in] name      unique identifier of the job
+ * @param[in] jobfn     job function
+ * @param[in] jobarg    argument of @p jobfn
+ * @param[in] jobperiod period, not zero
+ * @param[in] jobphase  delay of the first run, less than @p jobperiod keeps
+ *                      the offset of the job within its period
+ */
+#define PERIODIC_JOB(name, jobfn, jobarg, jobperiod, jobphase)                 \
+    static periodic_state_t __periodic_state_##name;                           \
+    static const periodic_job_t __periodic_job_##name __attribute__((__used__))\
+    __attribute__((__section__(".periodic." #name)))                           \
+    = { .fn = jobfn, .arg = jobarg, .period = jobperiod,                       \
+        .phase = jobphase, .statep = &__periodic_state_##name };
+
+/**
+ * @brief   Returns the table entry of a job registered in the same file.
+ *
+ * @param[in] name      identifier given to @p PERIODIC_JOB()
+ */
+#define PERIODIC_JOB_REF(name) (&__periodic_job_##name)
+
+/*===========================================================================*/
+/* External declarations                                                     */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void periodicJobsStart(void);
+    void periodicJobsStop(void);
+    void periodicJobGetState(const periodic_job_t *jobp,
+            periodic_state_t *statep);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERIODIC_JOBS_H_ */
@@ -0,0 +1,84 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qrwlock.h
+ * @brief   Readers-writer lock macros and structures.
+ *
+ * @addtogroup rwlocks
+ * @{
+ */
+
+#ifndef _QRWLOCK_H_
+#define _QRWLOCK_H_
+
+/**
+ * @brief   Type of a readers-writer lock structure.
+ */
+typedef struct rwlock rwlock_t;
+
+/**
+ * @brief   Readers-writer lock structure.
+ * @details Any number of readers or one writer own the lock. Waiting
+ *          writers take precedence over new readers, so that readers can
+ *          not starve them.
+ */
+struct rwlock {
+  threads_queue_t l_readers;    /**< @brief Queue of waiting readers.        */
+  threads_queue_t l_writers;    /**< @brief Queue of waiting writers.        */
+  cnt_t l_readcnt;              /**< @brief Number of owning readers.        */
+  cnt_t l_writecnt;             /**< @brief Number of waiting writers.       */
+  bool l_written;               /**< @brief A writer owns the lock.          */
+};
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Evaluates to @p TRUE if the lock is owned by a writer.
+ *
+ * @param[in] rwlp      pointer to a @p rwlock_t structure.
+ * @return              The lock status.
+ *
+ * @iclass
+ */
+#define chRWLockIsWrittenI(rwlp) ((rwlp)->l_written)
+
+/**
+ * @brief   Returns the number of readers owning the lock.
+ *
+ * @param[in] rwlp      pointer to a @p rwlock_t structure.
+ * @return              The number of readers.
+ *
+ * @iclass
+ */
+#define chRWLockGetReadersI(rwlp) ((rwlp)->l_readcnt)
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRWLockObjectInit(rwlock_t *rwlp);
+  void chRWLockAcquireShared(rwlock_t *rwlp);
+  void chRWLockReleaseShared(rwlock_t *rwlp);
+  void chRWLockAcquire(rwlock_t *rwlp);
+  void chRWLockRelease(rwlock_t *rwlp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QRWLOCK_H_ */
+
+/** @} */
@@ -0,0 +1,186 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qspscqueue.h
+ * @brief   Single producer single consumer queue macros and structures.
+ *
+ * @addtogroup io_queues
+ * @{
+ */
+
+#ifndef _QSPSCQUEUE_H_
+#define _QSPSCQUEUE_H_
+
+/**
+ * @brief   Type of a single producer single consumer queue structure.
+ */
+typedef struct spsc_queue spsc_queue_t;
+
+/**
+ * @brief   Single producer single consumer queue structure.
+ * @details The indices run freely and are masked on access. Each index is
+ *          written by one side only, data is transferred without entering
+ *          the kernel. The kernel is entered only to wait and to wake a
+ *          waiting thread.
+ */
+struct spsc_queue {
+  size_t q_wrindex;         /**< @brief Write index, producer owned.         */
+  size_t q_rdindex;         /**< @brief Read index, consumer owned.          */
+  size_t q_mask;            /**< @brief Buffer size minus one.               */
+  uint8_t *q_buffer;        /**< @brief Pointer to the queue buffer.         */
+  thread_reference_t q_reader;  /**< @brief Waiting consumer or @p NULL.     */
+  thread_reference_t q_writer;  /**< @brief Waiting producer or @p NULL.     */
+};
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Returns the queue's buffer size.
+ *
+ * @param[in] sqp       pointer to a @p spsc_queue_t structure.
+ * @return              The buffer size.
+ *
+ * @xclass
+ */
+#define chSpscQSizeX(sqp) ((sqp)->q_mask + 1)
+
+/**
+ * @brief   Returns the filled space into a queue.
+ * @note    The value is exact for the producer and the consumer, other
+ *          contexts get a snapshot.
+ *
+ * @param[in] sqp       pointer to a @p spsc_queue_t structure.
+ * @return              The number of full bytes in the queue.
+ *
+ * @xclass
+ */
+#define chSpscQGetFullX(sqp)                                                \
+  (__atomic_load_n(&(sqp)->q_wrindex, __ATOMIC_ACQUIRE) -                   \
+   __atomic_load_n(&(sqp)->q_rdindex, __ATOMIC_ACQUIRE))
+
+/**
+ * @brief   Returns the empty space into a queue.
+ *
+ * @param[in] sqp       pointer to a @p spsc_queue_t structure.
+ * @return              The number of empty bytes in the queue.
+ *
+ * @xclass
+ */
+#define chSpscQGetEmptyX(sqp) (chSpscQSizeX(sqp) - chSpscQGetFullX(sqp))
+
+/**
+ * @brief   Evaluates to @p TRUE if the specified queue is empty.
+ *
+ * @param[in] sqp       pointer to a @p spsc_queue_t structure.
+ * @return              The queue status.
+ *
+ * @xclass
+ */
+#define chSpscQIsEmptyX(sqp) ((bool)(chSpscQGetFullX(sqp) == 0))
+
+/**
+ * @brief   Evaluates to @p TRUE if the specified queue is full.
+ *
+ * @param[in] sqp       pointer to a @p spsc_queue_t structure.
+ * @return              The queue status.
+ *
+ * @xclass
+ */
+#define chSpscQIsFullX(sqp) ((bool)(chSpscQGetEmptyX(sqp) == 0))
+
+/**
+ * @brief   Evaluates to @p TRUE if the consumer waits for data.
+ * @details Lets a producer in an ISR enter the kernel only when needed, the
+ *          preceding index update is ordered before the check.
+ *
+ * @param[in] sqp       pointer to a @p spsc_queue_t structure.
+ * @return              The consumer status.
+ *
+ * @xclass
+ */
+#define chSpscQIsReaderWaitingX(sqp)                                        \
+  (__atomic_thread_fence(__ATOMIC_SEQ_CST),                               \
+   __atomic_load_n(&(sqp)->q_reader, __ATOMIC_RELAXED) != NULL)
+
+/**
+ * @brief   Evaluates to @p TRUE if the producer waits for space.
+ *
+ * @param[in] sqp       pointer to a @p spsc_queue_t structure.
+ * @return              The producer status.
+ *
+ * @xclass
+ */
+#define chSpscQIsWriterWaitingX(sqp)                                        \
+  (__atomic_thread_fence(__ATOMIC_SEQ_CST),                               \
+   __atomic_load_n(&(sqp)->q_writer, __ATOMIC_RELAXED) != NULL)
+
+/**
+ * @brief   Single producer single consumer queue read.
+ * @details This function reads a byte value from a queue. If the queue
+ *          is empty then the calling thread is suspended until a byte arrives
+ *          in the queue.
+ *
+ * @param[in] sqp       pointer to a @p spsc_queue_t structure
+ * @return              A byte value from the queue.
+ * @retval Q_RESET      if the queue has been reset.
+ *
+ * @api
+ */
+#define chSpscQGet(sqp) chSpscQGetTimeout(sqp, TIME_INFINITE)
+
+/**
+ * @brief   Single producer single consumer queue write.
+ * @details This function writes a byte value to a queue. If the queue
+ *          is full then the calling thread is suspended until there is space
+ *          in the queue.
+ *
+ * @param[in] sqp       pointer to a @p spsc_queue_t structure
+ * @param[in] b         the byte value to be written in the queue
+ * @return              The operation status.
+ * @retval Q_OK         if the operation succeeded.
+ * @retval Q_RESET      if the queue has been reset.
+ *
+ * @api
+ */
+#define chSpscQPut(sqp, b) chSpscQPutTimeout(sqp, b, TIME_INFINITE)
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chSpscQObjectInit(spsc_queue_t *sqp, uint8_t *bp, size_t size);
+  void chSpscQResetI(spsc_queue_t *sqp);
+  msg_t chSpscQGetX(spsc_queue_t *sqp);
+  size_t chSpscQReadX(spsc_queue_t *sqp, uint8_t *bp, size_t n);
+  msg_t chSpscQPutX(spsc_queue_t *sqp, uint8_t b);
+  size_t chSpscQWriteX(spsc_queue_t *sqp, const uint8_t *bp, size_t n);
+  void chSpscQWakeReaderI(spsc_queue_t *sqp);
+  void chSpscQWakeWriterI(spsc_queue_t *sqp);
+  msg_t chSpscQGetTimeout(spsc_queue_t *sqp, sysinterval_t timeout);
+  size_t chSpscQReadTimeout(spsc_queue_t *sqp, uint8_t *bp,
+                            size_t n, sysinterval_t timeout);
+  msg_t chSpscQPutTimeout(spsc_queue_t *sqp, uint8_t b,
+                          sysinterval_t timeout);
+  size_t chSpscQWriteTimeout(spsc_queue_t *sqp, const uint8_t *bp,
+                             size_t n, sysinterval_t timeout);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QSPSCQUEUE_H_ */
+
+/** @} */
@@ -54,6 +54,10 @@ struct symmetric_queue {
                                         after the buffer.                    */
   uint8_t *q_wrptr;         /**< @brief Write pointer.                       */
   uint8_t *q_rdptr;         /**< @brief Read pointer.                        */
+  size_t q_rdmark;          /**< @brief Bytes queued to wake readers.        */
+  size_t q_wrmark;          /**< @brief Bytes free to wake writers.          */
+  size_t q_rdneed;          /**< @brief Least bytes a reader waits for.      */
+  size_t q_wrneed;          /**< @brief Least bytes a writer waits for.      */
 };
 
 /**
@@ -174,6 +178,10 @@ struct symmetric_queue {
   (uint8_t *)(buffer) + (size),                                             \
   (uint8_t *)(buffer),                                                      \
   (uint8_t *)(buffer),                                                      \
+  1,                                                                        \
+  1,                                                                        \
+  SIZE_MAX,                                                                 \
+  SIZE_MAX,                                                                 \
 }
 
 /**
@@ -193,6 +201,8 @@ extern "C" {
 #endif
   void chSymQObjectInit(symmetric_queue_t *sqp, uint8_t *bp, size_t size);
   void chSymQResetI(symmetric_queue_t *sqp);
+  void chSymQSetWatermarksI(symmetric_queue_t *sqp, size_t rdmark,
+                            size_t wrmark);
   msg_t chSymQGetI(symmetric_queue_t *sqp);
   msg_t chSymQGetTimeoutS(symmetric_queue_t *sqp, sysinterval_t timeout);
   msg_t chSymQGetTimeout(symmetric_queue_t *sqp, sysinterval_t timeout);
@@ -200,7 +210,12 @@ extern "C" {
                          size_t n, sysinterval_t timeout);
   size_t chSymQReadTimeout(symmetric_queue_t *sqp, uint8_t *bp,
                          size_t n, sysinterval_t timeout);
+  size_t chSymQReadPeekI(symmetric_queue_t *sqp, uint8_t **pp);
+  void chSymQReadConsumeI(symmetric_queue_t *sqp, size_t n);
   msg_t chSymQPutI(symmetric_queue_t *sqp, uint8_t b);
+  size_t chSymQWriteI(symmetric_queue_t *sqp, const uint8_t *bp, size_t n);
+  size_t chSymQWriteReserveI(symmetric_queue_t *sqp, uint8_t **pp, size_t max);
+  void chSymQWriteCommitI(symmetric_queue_t *sqp, size_t n);
   msg_t chSymQPutTimeoutS(symmetric_queue_t *sqp, uint8_t b, sysinterval_t timeout);
   msg_t chSymQPutTimeout(symmetric_queue_t *sqp, uint8_t b, sysinterval_t timeout);
   size_t chSymQWriteTimeoutS(symmetric_queue_t *sqp, const uint8_t *bp,
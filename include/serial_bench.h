@@ -0,0 +1,165 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SERIAL_BENCH_H_
+#define SERIAL_BENCH_H_
+
+#include "qhal.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*===========================================================================*/
+/* Constants                                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Pre-compile time settings                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Largest transfer size supported by the benchmark.
+ */
+#if !defined(SERIAL_BENCH_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define SERIAL_BENCH_BUFFER_SIZE 256
+#endif
+
+/**
+ * @brief   Stack size of the stream writer thread.
+ */
+#if !defined(SERIAL_BENCH_THREAD_STACK_SIZE) || defined(__DOXYGEN__)
+#define SERIAL_BENCH_THREAD_STACK_SIZE (512 + SERIAL_BENCH_BUFFER_SIZE)
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Data structures and types                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Benchmark workloads.
+ */
+typedef enum
+{
+    SERIAL_BENCH_STREAM = 0,        /**< Bulk stream from near to far end.  */
+    SERIAL_BENCH_ECHO = 1,          /**< Round trips echoed by the far end. */
+} serialbenchworkload_t;
+
+/**
+ * @brief   Free running counter used to take latencies.
+ */
+typedef uint32_t (*serialbenchclock_t)(void);
+
+/**
+ * @brief   Benchmark configuration structure.
+ * @details Both ends of the link are driven by the benchmark, e.g. the two
+ *          ends of a @p SerialVirtualDriver pair or of a pair of
+ *          @p SerialFdxDriver running over one.
+ */
+typedef struct
+{
+    /**
+     * @brief Workload to run.
+     */
+    serialbenchworkload_t workload;
+    /**
+     * @brief Near end of the link.
+     */
+    BaseAsynchronousChannel* nearp;
+    /**
+     * @brief Far end of the link.
+     */
+    BaseAsynchronousChannel* farp;
+#if (HAL_USE_SERIAL_FDX && SERIAL_FDX_USE_STATS) || defined(__DOXYGEN__)
+    /**
+     * @brief Optional FDX driver of the near end or @p NULL.
+     * @details Its statistics are reset before the run and yield the
+     *          frames carrying the traffic.
+     */
+    SerialFdxDriver* fdxp;
+#endif
+    /**
+     * @brief Number of transfers, chunks streamed or round trips.
+     */
+    uint32_t ops;
+    /**
+     * @brief Bytes per transfer, up to @p SERIAL_BENCH_BUFFER_SIZE.
+     */
+    uint32_t op_size;
+    /**
+     * @brief Timeout of each transfer, a transfer timing out ends the run.
+     */
+    sysinterval_t timeout;
+    /**
+     * @brief Counter to take latencies from or @p NULL for the system time.
+     */
+    serialbenchclock_t clock;
+    /**
+     * @brief Frequency of @p clock in Hz.
+     */
+    uint32_t clock_frequency;
+    /**
+     * @brief Optional array of @p ops entries receiving the round trip
+     *        latencies of the echo workload.
+     * @details Required to report percentiles.
+     */
+    uint32_t* samples;
+} SerialBenchConfig;
+
+/**
+ * @brief   Benchmark results.
+ * @note    Times are in @p clock units.
+ */
+typedef struct
+{
+    uint32_t ops;                   /**< Transfers completed.               */
+    uint32_t failures;              /**< Transfers timed out or corrupted.  */
+    uint32_t bytes;                 /**< Payload bytes delivered.           */
+    uint32_t time;                  /**< Duration of the run.               */
+    uint32_t bytes_per_s;           /**< Payload throughput.                */
+    uint32_t latency_p50;           /**< Median round trip.                 */
+    uint32_t latency_p99;           /**< 99th percentile round trip.        */
+    uint32_t latency_max;           /**< Longest round trip.                */
+    uint32_t mtu;                   /**< FDX frame size, 0 without FDX.     */
+    uint32_t frames_sent;           /**< FDX frames sent by the near end.   */
+    uint32_t frames_received;       /**< FDX frames received by it.         */
+    uint32_t frames_per_s;          /**< FDX frames sent per second.        */
+} SerialBenchResult;
+
+/*===========================================================================*/
+/* Macros                                                                    */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations                                                     */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    bool serialbenchRun(const SerialBenchConfig* configp,
+            SerialBenchResult* resultp);
+    int serialbenchFormat(char* buffer, size_t size, const char* name,
+            const SerialBenchConfig* configp,
+            const SerialBenchResult* resultp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SERIAL_BENCH_H_ */
@@ -15,6 +15,7 @@
 #include "ch_tools.h"
 
 #include <stdbool.h>
+#include <string.h>
 
 /*===========================================================================*/
 /* Local definitions                                                         */
@@ -44,6 +45,58 @@
 /* Local functions                                                           */
 /*===========================================================================*/
 
+/**
+ * @brief   Accounts the time the loop ran since its last wake-up.
+ */
+static void period_stats_enter(period_stats_t *statsp, systime_t now)
+{
+    if (statsp == NULL || statsp->running == false)
+        return;
+
+    sysinterval_t exec = chTimeDiffX(statsp->wakeup, now);
+    if (exec > statsp->exec_max)
+        statsp->exec_max = exec;
+}
+
+/**
+ * @brief   Records a wake-up of the loop.
+ */
+static void period_stats_wakeup(period_stats_t *statsp, systime_t now)
+{
+    if (statsp == NULL)
+        return;
+
+    statsp->wakeup = now;
+    statsp->running = true;
+}
+
+/**
+ * @brief   Accounts the end of a period and the lateness of the wake-up.
+ */
+static void period_stats_period(period_stats_t *statsp, systime_t future,
+        systime_t now, bool overrun)
+{
+    if (statsp == NULL)
+        return;
+
+    sysinterval_t late = chTimeDiffX(future, now);
+
+    /* Bin index is the number of significant bits. */
+    uint32_t bin = 0;
+    while (bin < CH_TOOLS_PERIOD_STATS_BINS - 1 && bin < 32 &&
+            ((uint32_t)late >> bin) != 0)
+        ++bin;
+
+    ++statsp->periods;
+    if (overrun)
+        ++statsp->overruns;
+    if (late > statsp->late_max)
+        statsp->late_max = late;
+    ++statsp->histogram[bin];
+
+    period_stats_wakeup(statsp, now);
+}
+
 /*===========================================================================*/
 /* Exported functions                                                        */
 /*===========================================================================*/
@@ -60,6 +113,26 @@
  * @api
  */
 void chThdSleepPeriod(systime_t *previous, sysinterval_t period)
+{
+    chThdSleepPeriodStats(previous, period, NULL);
+}
+
+/**
+ * @brief   Suspends the invoking thread to match the specified time interval
+ *          and records the loop timing.
+ *
+ * @param[in] previous  pointer to the previous sysinterval_t
+ * @param[in] period    time period to match
+ *                      - @a TIME_INFINITE the thread enters an infinite sleep
+ *                        state.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ * @param[in] statsp    pointer to the @p period_stats_t of the loop or
+ *                      @p NULL
+ *
+ * @api
+ */
+void chThdSleepPeriodStats(systime_t *previous, sysinterval_t period,
+        period_stats_t *statsp)
 {
     chDbgCheck(period != TIME_INFINITE && previous != NULL);
 
@@ -68,6 +141,7 @@ void chThdSleepPeriod(systime_t *previous, sysinterval_t period)
     chSysLock();
 
     systime_t now = chVTGetSystemTimeX();
+    period_stats_enter(statsp, now);
 
     bool mustDelay =
         now < *previous ?
@@ -75,7 +149,12 @@ void chThdSleepPeriod(systime_t *previous, sysinterval_t period)
         (now < future || future < *previous);
 
     if (mustDelay)
+    {
         chThdSleepS(future - now);
+        now = chVTGetSystemTimeX();
+    }
+
+    period_stats_period(statsp, future, now, !mustDelay);
 
     chSysUnlock();
 
@@ -104,6 +183,30 @@ void chThdSleepPeriod(systime_t *previous, sysinterval_t period)
  */
 eventmask_t chEvtWaitAnyPeriod(eventmask_t events, systime_t *previous,
         sysinterval_t period)
+{
+    return chEvtWaitAnyPeriodStats(events, previous, period, NULL);
+}
+
+/**
+ * @brief   Waits for any of the specified events and records the loop
+ *          timing.
+ * @details See @p chEvtWaitAnyPeriod(). Only timeouts complete a period,
+ *          wake-ups by events restart the execution time measurement.
+ *
+ * @param[in] events    mask of the event flags that the function should wait
+ *                      for, @p ALL_EVENTS enables all the events
+ * @param[in] previous  pointer to the previous sysinterval_t
+ * @param[in] period    time period to match, @a TIME_IMMEDIATE and
+ *                      @a TIME_INFINITE are not allowed
+ * @param[in] statsp    pointer to the @p period_stats_t of the loop or
+ *                      @p NULL
+ * @return              The mask of the served and cleared events.
+ * @retval 0            if the operation has timed out.
+ *
+ * @api
+ */
+eventmask_t chEvtWaitAnyPeriodStats(eventmask_t events, systime_t *previous,
+        sysinterval_t period, period_stats_t *statsp)
 {
     chDbgCheck(period != TIME_INFINITE && previous != NULL);
 
@@ -113,17 +216,19 @@ eventmask_t chEvtWaitAnyPeriod(eventmask_t events, systime_t *previous,
 
     chSysLock();
 
+    systime_t now = chVTGetSystemTimeX();
+    period_stats_enter(statsp, now);
+
     /* Check if event is already pending. */
     if ((m = (ctp->epending & events)) != 0)
     {
         ctp->epending &= ~m;
+        period_stats_wakeup(statsp, now);
         chSysUnlock();
         /* If we are woken because of an event, do not update previous time. */
         return m;
     }
 
-    systime_t now = chVTGetSystemTimeX();
-
     bool mustDelay =
         now < *previous ?
         (now < future && future < *previous) :
@@ -132,8 +237,11 @@ eventmask_t chEvtWaitAnyPeriod(eventmask_t events, systime_t *previous,
     if (mustDelay)
     {
         ctp->u.ewmask = events;
-        if (chSchGoSleepTimeoutS(CH_STATE_WTOREVT, future - now) < MSG_OK)
+        msg_t msg = chSchGoSleepTimeoutS(CH_STATE_WTOREVT, future - now);
+        now = chVTGetSystemTimeX();
+        if (msg < MSG_OK)
         {
+            period_stats_period(statsp, future, now, false);
             chSysUnlock();
             /* Update previous time because of timeout. */
             *previous = future;
@@ -141,12 +249,14 @@ eventmask_t chEvtWaitAnyPeriod(eventmask_t events, systime_t *previous,
         }
         m = ctp->epending & events;
         ctp->epending &= ~m;
+        period_stats_wakeup(statsp, now);
 
         chSysUnlock();
         /* If we are woken because of an event, do not update previous time. */
         return m;
     }
 
+    period_stats_period(statsp, future, now, true);
     chSysUnlock();
     /* Update previous time because of timeout. */
     *previous = future;
@@ -154,3 +264,38 @@ eventmask_t chEvtWaitAnyPeriod(eventmask_t events, systime_t *previous,
 }
 
 #endif /* CH_CFG_USE_EVENTS || defined(__DOXYGEN__) */
+
+/**
+ * @brief   Initializes or resets loop timing statistics.
+ *
+ * @param[out] statsp   pointer to the @p period_stats_t object
+ *
+ * @api
+ */
+void chPeriodStatsObjectInit(period_stats_t *statsp)
+{
+    chDbgCheck(statsp != NULL);
+
+    chSysLock();
+    memset(statsp, 0, sizeof(*statsp));
+    chSysUnlock();
+}
+
+/**
+ * @brief   Takes a consistent snapshot of loop timing statistics.
+ * @details Safe to call from any thread, e.g. a shell command, while the
+ *          loop runs.
+ *
+ * @param[in] statsp    pointer to the @p period_stats_t object
+ * @param[out] copyp    pointer to the snapshot
+ *
+ * @api
+ */
+void chPeriodStatsGet(const period_stats_t *statsp, period_stats_t *copyp)
+{
+    chDbgCheck(statsp != NULL && copyp != NULL);
+
+    chSysLock();
+    *copyp = *statsp;
+    chSysUnlock();
+}
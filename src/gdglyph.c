@@ -0,0 +1,171 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    gdglyph.c
+ * @brief   GD glyph cache code.
+ *
+ * @addtogroup gd_glyph
+ * @{
+ */
+
+#include "gdglyph.h"
+
+#include <string.h>
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static bool gd_glyph_match(const GDGlyphEntry *entryp, coord_t width,
+        coord_t height, const GDBlitSource *srcp)
+{
+    return entryp->data == srcp->data && entryp->stride == srcp->stride &&
+            entryp->x == srcp->x && entryp->width == width &&
+            entryp->height == height && entryp->fg == srcp->fg &&
+            entryp->bg == srcp->bg;
+}
+
+/**
+ * @brief   Returns the index of the entry holding a glyph.
+ * @details Converts the glyph into the least recently used entry if it is
+ *          not cached.
+ */
+static unsigned gd_glyph_lookup(GDGlyphCache *cachep, coord_t width,
+        coord_t height, const GDBlitSource *srcp)
+{
+    unsigned victim = 0;
+
+    for (unsigned i = 0; i < GD_GLYPH_CACHE_SLOTS; ++i)
+    {
+        GDGlyphEntry *entryp = &cachep->entries[i];
+
+        if (entryp->data != NULL && gd_glyph_match(entryp, width, height,
+                srcp))
+        {
+            entryp->stamp = ++cachep->stamp;
+            ++cachep->hits;
+            return i;
+        }
+
+        /* Unused entries first, then the oldest one. Wrap safe comparison
+           of stamps. */
+        const GDGlyphEntry *victimp = &cachep->entries[victim];
+        if (victimp->data != NULL && (entryp->data == NULL ||
+                (int32_t)(entryp->stamp - victimp->stamp) < 0))
+            victim = i;
+    }
+
+    GDGlyphEntry *entryp = &cachep->entries[victim];
+    color_t *pixels = cachep->pixels[victim];
+
+    for (coord_t row = 0; row < height; ++row)
+        gdBlitConvert(srcp, row, 0, width, pixels + row * width);
+
+    entryp->data = srcp->data;
+    entryp->stride = srcp->stride;
+    entryp->x = srcp->x;
+    entryp->width = width;
+    entryp->height = height;
+    entryp->fg = srcp->fg;
+    entryp->bg = srcp->bg;
+    entryp->stamp = ++cachep->stamp;
+    ++cachep->misses;
+
+    return victim;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a glyph cache.
+ *
+ * @param[out] cachep   pointer to the @p GDGlyphCache object
+ */
+void gdglyphObjectInit(GDGlyphCache *cachep)
+{
+    osalDbgCheck(cachep != NULL);
+
+    gdglyphFlush(cachep);
+    cachep->stamp = 0;
+    cachep->hits = 0;
+    cachep->misses = 0;
+}
+
+/**
+ * @brief   Drops all cached glyphs.
+ * @details Required before changing or releasing cached bitmaps.
+ *
+ * @param[in] cachep    pointer to the @p GDGlyphCache object
+ */
+void gdglyphFlush(GDGlyphCache *cachep)
+{
+    osalDbgCheck(cachep != NULL);
+
+    for (unsigned i = 0; i < GD_GLYPH_CACHE_SLOTS; ++i)
+        cachep->entries[i].data = NULL;
+}
+
+/**
+ * @brief   Draws a glyph.
+ * @details Opaque @p GD_BLIT_MASK1 glyphs of up to
+ *          @p GD_GLYPH_CACHE_SLOT_SIZE pixels are drawn from the cache by a
+ *          single stream write, all others are passed on to @p gdBlit().
+ * @note    The cache is not protected, use one cache per thread or
+ *          serialize the calls.
+ *
+ * @param[in] cachep    pointer to the @p GDGlyphCache object
+ * @param[in] ip        pointer to a @p BaseGDDevice or derived class
+ * @param[in] left      left rectangle border coordinate
+ * @param[in] top       top rectangle border coordinate
+ * @param[in] width     width of the glyph
+ * @param[in] height    height of the glyph
+ * @param[in] srcp      pointer to the @p GDBlitSource glyph bitmap
+ */
+void gdglyphDraw(GDGlyphCache *cachep, BaseGDDevice *ip, coord_t left,
+        coord_t top, coord_t width, coord_t height,
+        const GDBlitSource *srcp)
+{
+    osalDbgCheck((cachep != NULL) && (ip != NULL) && (srcp != NULL));
+
+    if (srcp->format != GD_BLIT_MASK1 || srcp->transparent ||
+            (uint32_t)width * height > GD_GLYPH_CACHE_SLOT_SIZE ||
+            width == 0 || height == 0)
+    {
+        gdBlit(ip, left, top, width, height, srcp);
+        return;
+    }
+
+    const unsigned i = gd_glyph_lookup(cachep, width, height, srcp);
+
+    gdStreamStart(ip, left, top, width, height);
+    gdStreamWrite(ip, cachep->pixels[i], (size_t)width * height);
+    gdStreamEnd(ip);
+}
+
+/** @} */
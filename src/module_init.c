@@ -0,0 +1,245 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Starts the modules of the initcall table. Modules flagged MODULE_ASYNC
+ * are started by a pool of worker threads, each worker picks the first
+ * pending module whose dependencies have started. All other modules are
+ * started by the calling thread in table order, waiting for their
+ * dependencies if required. Every finished start wakes all threads waiting
+ * for a module, so boot time approaches the longest dependency chain
+ * instead of the sum of all start times.
+ */
+
+#include "qhal.h"
+#include "module_init.h"
+
+#include <stdbool.h>
+
+#if MODULE_INIT_USE_ASYNC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Local definitions                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Imported variables                                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Exported variables                                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local types                                                               */
+/*===========================================================================*/
+
+typedef struct
+{
+    THD_WORKING_AREA(wa, MODULE_INIT_STACK_SIZE);
+} module_worker_t;
+
+/*===========================================================================*/
+/* Local constants                                                           */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local variables                                                           */
+/*===========================================================================*/
+
+static module_worker_t module_workers[MODULE_INIT_WORKERS];
+
+/* Threads waiting for a start to finish */
+static threads_queue_t module_queue;
+
+/*===========================================================================*/
+/* Local functions                                                           */
+/*===========================================================================*/
+
+static bool module_is_async(const initmodule_t *modp)
+{
+    return (modp->flags & MODULE_ASYNC) != 0 && modp->statep != NULL;
+}
+
+/**
+ * @brief   Returns whether all dependencies of a module started.
+ * @note    Called with the system locked.
+ */
+static bool module_is_ready(const initmodule_t *modp)
+{
+    for (uint32_t i = 0; i < modp->deps_num; ++i)
+    {
+        osalDbgCheck(modp->deps[i]->statep != NULL);
+
+        if (*modp->deps[i]->statep != MODULE_STARTED)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Runs the start function of a module.
+ * @note    Called with the system locked, unlocks while starting.
+ */
+static void module_start(const initmodule_t *modp)
+{
+    if (modp->statep != NULL)
+        *modp->statep = MODULE_STARTING;
+    osalSysUnlock();
+
+    if (modp->fn_mstart)
+        (modp->fn_mstart)();
+
+    osalSysLock();
+    if (modp->statep != NULL)
+        *modp->statep = MODULE_STARTED;
+    osalThreadDequeueAllI(&module_queue, MSG_OK);
+    osalOsRescheduleS();
+}
+
+static void module_worker(void *arg)
+{
+    (void)arg;
+
+    chRegSetThreadName("module_init");
+
+    osalSysLock();
+
+    while (true)
+    {
+        const initmodule_t *next = NULL;
+        bool pending = false;
+
+        for (const initmodule_t *modp = __module_initcall_start;
+                modp < __module_initcall_end; ++modp)
+        {
+            if (!module_is_async(modp) || *modp->statep != MODULE_PENDING)
+                continue;
+
+            pending = true;
+
+            if (module_is_ready(modp))
+            {
+                next = modp;
+                break;
+            }
+        }
+
+        if (next != NULL)
+            module_start(next);
+        else if (pending)
+            (void)osalThreadEnqueueTimeoutS(&module_queue, TIME_INFINITE);
+        else
+            break;
+    }
+
+    osalSysUnlock();
+}
+
+/*===========================================================================*/
+/* Exported functions                                                        */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts all modules.
+ * @details Asynchronous modules are handed to the workers, the others are
+ *          started in table order by the calling thread once their
+ *          dependencies started. The workers terminate when all
+ *          asynchronous modules started.
+ * @note    Dependencies must not be cyclic and a module started by the
+ *          calling thread must not depend on one placed after it in the
+ *          table unless that one is asynchronous.
+ */
+void moduleStartAll(void)
+{
+    bool async = false;
+
+    osalThreadQueueObjectInit(&module_queue);
+
+    for (const initmodule_t *modp = __module_initcall_start;
+            modp < __module_initcall_end; ++modp)
+    {
+        if (modp->statep != NULL)
+            *modp->statep = MODULE_PENDING;
+        if (module_is_async(modp))
+            async = true;
+    }
+
+    if (async)
+    {
+        for (size_t i = 0; i < MODULE_INIT_WORKERS; ++i)
+        {
+            chThdCreateStatic(module_workers[i].wa,
+                    sizeof(module_workers[i].wa), MODULE_INIT_PRIO,
+                    module_worker, NULL);
+        }
+    }
+
+    osalSysLock();
+
+    for (const initmodule_t *modp = __module_initcall_start;
+            modp < __module_initcall_end; ++modp)
+    {
+        if (module_is_async(modp))
+            continue;
+
+        /* Only asynchronous modules start while this thread waits. */
+        for (uint32_t i = 0; i < modp->deps_num; ++i)
+        {
+            osalDbgAssert(module_is_async(modp->deps[i]) ||
+                    *modp->deps[i]->statep == MODULE_STARTED,
+                    "dependency order");
+        }
+
+        while (!module_is_ready(modp))
+            (void)osalThreadEnqueueTimeoutS(&module_queue, TIME_INFINITE);
+
+        module_start(modp);
+    }
+
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Waits until a module started.
+ *
+ * @param[in] modp      module, see @p MODULE_REF()
+ */
+void moduleWait(const initmodule_t *modp)
+{
+    osalDbgCheck(modp != NULL && modp->statep != NULL);
+
+    osalSysLock();
+
+    while (*modp->statep != MODULE_STARTED)
+        (void)osalThreadEnqueueTimeoutS(&module_queue, TIME_INFINITE);
+
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Waits until all modules started.
+ */
+void moduleWaitAll(void)
+{
+    for (const initmodule_t *modp = __module_initcall_start;
+            modp < __module_initcall_end; ++modp)
+    {
+        if (module_is_async(modp))
+            moduleWait(modp);
+    }
+}
+
+#endif /* MODULE_INIT_USE_ASYNC */
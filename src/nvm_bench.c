@@ -0,0 +1,308 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "nvm_bench.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*===========================================================================*/
+/* Local definitions                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Fraction of the device rewritten by the churn workload.
+ */
+#define NVM_BENCH_CHURN_DIVIDER 16
+
+/*===========================================================================*/
+/* Imported variables                                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Exported variables                                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local types                                                               */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local constants                                                           */
+/*===========================================================================*/
+
+static const char* const nvm_bench_workload_names[] =
+{
+    [NVM_BENCH_RANDOM_WRITE] = "random_write",
+    [NVM_BENCH_SEQUENTIAL_FILL] = "sequential_fill",
+    [NVM_BENCH_READ_MOSTLY] = "read_mostly",
+    [NVM_BENCH_CHURN] = "churn",
+};
+
+/*===========================================================================*/
+/* Local variables                                                           */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local functions                                                           */
+/*===========================================================================*/
+
+static uint32_t nvm_bench_random(uint32_t* statep)
+{
+    /* xorshift32 */
+    uint32_t x = *statep;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *statep = x;
+    return x;
+}
+
+static uint32_t nvm_bench_now(const NVMBenchConfig* configp)
+{
+    if (configp->clock != NULL)
+        return configp->clock();
+
+    return (uint32_t)osalOsGetSystemTimeX();
+}
+
+static uint32_t nvm_bench_elapsed(const NVMBenchConfig* configp,
+        uint32_t start)
+{
+    if (configp->clock != NULL)
+        return configp->clock() - start;
+
+    /* Wrap around at the width of the system time. */
+    return (uint32_t)(systime_t)(osalOsGetSystemTimeX() - (systime_t)start);
+}
+
+static uint32_t nvm_bench_frequency(const NVMBenchConfig* configp)
+{
+    if (configp->clock != NULL)
+        return configp->clock_frequency;
+
+    return OSAL_ST_FREQUENCY;
+}
+
+static uint32_t nvm_bench_us(const NVMBenchConfig* configp, uint32_t t)
+{
+    const uint32_t frequency = nvm_bench_frequency(configp);
+
+    if (frequency == 0)
+        return 0;
+
+    return (uint32_t)((uint64_t)t * 1000000 / frequency);
+}
+
+static int nvm_bench_compare(const void* a, const void* b)
+{
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/*===========================================================================*/
+/* Exported functions                                                        */
+/*===========================================================================*/
+
+/**
+ * @brief   Runs a benchmark workload against a nvm stack.
+ * @details Operations are aligned to @p op_size. Each latency covers a
+ *          single read or write and the sync following it, if any.
+ *
+ * @param[in] configp   pointer to the @p NVMBenchConfig object
+ * @param[out] resultp  pointer to the @p NVMBenchResult object
+ *
+ * @return              The result of the operation.
+ * @retval HAL_SUCCESS  all operations succeeded.
+ * @retval HAL_FAILED   at least one operation failed.
+ *
+ * @api
+ */
+bool nvmbenchRun(const NVMBenchConfig* configp, NVMBenchResult* resultp)
+{
+    osalDbgCheck((configp != NULL) && (resultp != NULL));
+    osalDbgCheck(configp->nvmp != NULL);
+    osalDbgAssert(configp->op_size > 0 &&
+            configp->op_size <= NVM_BENCH_BUFFER_SIZE &&
+            configp->size >= configp->op_size,
+            "invalid parameters");
+
+    const uint32_t slots = configp->size / configp->op_size;
+    uint32_t hot = slots / NVM_BENCH_CHURN_DIVIDER;
+    if (hot == 0)
+        hot = 1;
+
+    uint32_t state = (configp->seed != 0) ? configp->seed : 1;
+    uint32_t writes = 0;
+    uint8_t buffer[NVM_BENCH_BUFFER_SIZE];
+
+    memset(resultp, 0, sizeof(*resultp));
+
+#if HAL_USE_NVM_TRACE
+    if (configp->tracep != NULL)
+        nvmtraceResetStats(configp->tracep);
+#endif /* HAL_USE_NVM_TRACE */
+
+    const uint32_t run_start = nvm_bench_now(configp);
+
+    for (uint32_t i = 0; i < configp->ops; ++i)
+    {
+        bool write = true;
+        uint32_t slot;
+
+        switch (configp->workload)
+        {
+        case NVM_BENCH_SEQUENTIAL_FILL:
+            slot = i % slots;
+            break;
+        case NVM_BENCH_READ_MOSTLY:
+            write = (nvm_bench_random(&state) % 10) == 0;
+            slot = nvm_bench_random(&state) % slots;
+            break;
+        case NVM_BENCH_CHURN:
+            slot = nvm_bench_random(&state) % hot;
+            break;
+        case NVM_BENCH_RANDOM_WRITE:
+        default:
+            slot = nvm_bench_random(&state) % slots;
+            break;
+        }
+
+        const uint32_t addr = slot * configp->op_size;
+
+        if (write == true)
+        {
+            for (uint32_t j = 0; j < configp->op_size; ++j)
+                buffer[j] = (uint8_t)nvm_bench_random(&state);
+        }
+
+        const uint32_t start = nvm_bench_now(configp);
+        bool result;
+
+        if (write == true)
+        {
+            result = nvmWrite(configp->nvmp, addr, configp->op_size, buffer);
+            ++writes;
+            if (result == HAL_SUCCESS && configp->sync_every != 0 &&
+                    (writes % configp->sync_every) == 0)
+                result = nvmSync(configp->nvmp);
+        }
+        else
+        {
+            result = nvmRead(configp->nvmp, addr, configp->op_size, buffer);
+        }
+
+        const uint32_t latency = nvm_bench_elapsed(configp, start);
+
+        ++resultp->ops;
+        if (result != HAL_SUCCESS)
+            ++resultp->failures;
+        if (write == true)
+            resultp->bytes_written += configp->op_size;
+        else
+            resultp->bytes_read += configp->op_size;
+        if (latency > resultp->latency_max)
+            resultp->latency_max = latency;
+        if (configp->samples != NULL)
+            configp->samples[i] = latency;
+    }
+
+    if (nvmSync(configp->nvmp) != HAL_SUCCESS)
+        ++resultp->failures;
+
+    resultp->time = nvm_bench_elapsed(configp, run_start);
+    if (resultp->time != 0)
+        resultp->ops_per_s = (uint32_t)((uint64_t)resultp->ops *
+                nvm_bench_frequency(configp) / resultp->time);
+
+    if (configp->samples != NULL && configp->ops > 0)
+    {
+        qsort(configp->samples, configp->ops, sizeof(configp->samples[0]),
+                nvm_bench_compare);
+        resultp->latency_p50 =
+                configp->samples[(uint64_t)(configp->ops - 1) * 50 / 100];
+        resultp->latency_p99 =
+                configp->samples[(uint64_t)(configp->ops - 1) * 99 / 100];
+    }
+
+#if HAL_USE_NVM_TRACE
+    if (configp->tracep != NULL)
+    {
+        NVMTraceStats stats;
+        nvmtraceGetStats(configp->tracep, &stats);
+        resultp->lower_writes = stats.write.calls;
+        resultp->lower_bytes_written = stats.write.bytes;
+        resultp->lower_erases = stats.erase.calls;
+        resultp->lower_bytes_erased = stats.erase.bytes;
+    }
+#endif /* HAL_USE_NVM_TRACE */
+
+    return (resultp->failures == 0) ? HAL_SUCCESS : HAL_FAILED;
+}
+
+/**
+ * @brief   Formats benchmark results as a single line JSON object.
+ * @details Times are converted to microseconds. The write amplification
+ *          is reported in per mille of the bytes written to the stack.
+ *
+ * @param[out] buffer   pointer to the output buffer
+ * @param[in] size      size of the output buffer
+ * @param[in] name      name identifying the stack under test
+ * @param[in] configp   pointer to the @p NVMBenchConfig object of the run
+ * @param[in] resultp   pointer to the @p NVMBenchResult object of the run
+ *
+ * @return              The number of characters of the complete line as
+ *                      returned by @p snprintf().
+ *
+ * @api
+ */
+int nvmbenchFormat(char* buffer, size_t size, const char* name,
+        const NVMBenchConfig* configp, const NVMBenchResult* resultp)
+{
+    osalDbgCheck((name != NULL) && (configp != NULL) && (resultp != NULL));
+
+    const uint32_t amplification = (resultp->bytes_written != 0) ?
+            (uint32_t)((uint64_t)resultp->lower_bytes_written * 1000 /
+            resultp->bytes_written) : 0;
+
+    const char* workload = "unknown";
+    if ((size_t)configp->workload < sizeof(nvm_bench_workload_names) /
+            sizeof(nvm_bench_workload_names[0]))
+        workload = nvm_bench_workload_names[configp->workload];
+
+    int length = snprintf(buffer, size,
+            "{\"name\":\"%s\",\"workload\":\"%s\",\"size\":%" PRIu32
+            ",\"op_size\":%" PRIu32 ",\"ops\":%" PRIu32
+            ",\"failures\":%" PRIu32 ",\"bytes_read\":%" PRIu32
+            ",\"bytes_written\":%" PRIu32 ",\"time_us\":%" PRIu32
+            ",\"ops_per_s\":%" PRIu32 ",\"latency_p50_us\":%" PRIu32
+            ",\"latency_p99_us\":%" PRIu32 ",\"latency_max_us\":%" PRIu32
+            ",\"lower_writes\":%" PRIu32 ",\"lower_bytes_written\":%" PRIu32
+            ",\"lower_erases\":%" PRIu32 ",\"lower_bytes_erased\":%" PRIu32
+            ",\"write_amplification_milli\":%" PRIu32 "}\n",
+            name, workload, configp->size, configp->op_size, resultp->ops,
+            resultp->failures, resultp->bytes_read, resultp->bytes_written,
+            nvm_bench_us(configp, resultp->time), resultp->ops_per_s,
+            nvm_bench_us(configp, resultp->latency_p50),
+            nvm_bench_us(configp, resultp->latency_p99),
+            nvm_bench_us(configp, resultp->latency_max),
+            resultp->lower_writes, resultp->lower_bytes_written,
+            resultp->lower_erases, resultp->lower_bytes_erased,
+            amplification);
+    return length;
+}
@@ -0,0 +1,478 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    nvmbatch.c
+ * @brief   Batched sample logger code.
+ *
+ * @addtogroup nvm_batch
+ * @{
+ */
+
+#include "nvmbatch.h"
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          Replaces one log append per sensor sample by one append per
+ *          batch of samples, so the flash is programmed once per batch.
+ *          Sensor threads put samples into the collecting buffer, which
+ *          is handed to the writer thread once the next sample might not
+ *          fit or its oldest sample reached the maximum age. A sample put
+ *          while both buffers are busy is dropped.
+ *          Record format: The format byte and the timestamp of the first
+ *          sample as varint, followed by the samples. Each sample is the
+ *          channel byte, the timestamp difference to the previous sample
+ *          and the value difference to the previous value of its channel,
+ *          both as zigzag varints. Every batch starts with all previous
+ *          values at 0, so batches decode on their own.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static size_t nvm_batch_put_varint(uint8_t *p, uint32_t v)
+{
+    size_t n = 0;
+
+    while (v >= 0x80)
+    {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+
+    return n;
+}
+
+static bool nvm_batch_get_varint(NVMBatchDecoder *decp, uint32_t *vp)
+{
+    uint32_t v = 0;
+
+    for (unsigned shift = 0; shift < 35; shift += 7)
+    {
+        if (decp->p == decp->end)
+            return false;
+
+        const uint8_t b = *decp->p++;
+        v |= (uint32_t)(b & 0x7f) << shift;
+
+        if ((b & 0x80) == 0)
+        {
+            *vp = v;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint32_t nvm_batch_zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t nvm_batch_unzigzag(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/**
+ * @brief   Returns the signed difference between two system times.
+ * @details Differences of more than half the system time range are
+ *          considered negative.
+ */
+static int32_t nvm_batch_time_diff(systime_t from, systime_t to)
+{
+    const systime_t d = (systime_t)(to - from);
+
+    if (d > TIME_MAX_SYSTIME / 2)
+        return -(int32_t)(systime_t)(from - to);
+
+    return (int32_t)d;
+}
+
+/**
+ * @brief   Hands the collecting buffer to the writer thread.
+ * @note    Called with the system locked.
+ *
+ * @return              @p false if the other buffer is still busy.
+ */
+static bool nvm_batch_swap_s(NVMBatchLogger *batchp)
+{
+    if (batchp->flush_n > 0)
+        return false;
+
+    batchp->flush_n = batchp->fill_n;
+    batchp->fill ^= 1;
+    batchp->fill_n = 0;
+    osalThreadResumeS(&batchp->wait, MSG_OK);
+
+    return true;
+}
+
+/**
+ * @brief   Appends the buffer handed to the writer thread.
+ * @note    Called with the system locked.
+ */
+static void nvm_batch_write_s(NVMBatchLogger *batchp)
+{
+    const uint8_t *datap = batchp->buffers[batchp->fill ^ 1];
+    const size_t n = batchp->flush_n;
+
+    osalSysUnlock();
+
+    bool result = nvmlogAppend(batchp->config->logp, datap, n);
+    if (result == HAL_SUCCESS)
+        result = nvmlogSync(batchp->config->logp);
+
+    osalSysLock();
+
+    if (result == HAL_SUCCESS)
+        ++batchp->stats.batches;
+    else
+        ++batchp->stats.errors;
+    batchp->flush_n = 0;
+}
+
+static void nvm_batch_thread(void *arg)
+{
+    NVMBatchLogger *batchp = arg;
+
+    chRegSetThreadName("nvm_batch");
+
+    osalSysLock();
+
+    while (true)
+    {
+        if (batchp->flush_n > 0)
+        {
+            nvm_batch_write_s(batchp);
+            continue;
+        }
+
+        /* Remaining samples are written before stopping. */
+        if (batchp->running == false)
+        {
+            if (batchp->fill_n > 0)
+            {
+                (void)nvm_batch_swap_s(batchp);
+                continue;
+            }
+
+            osalThreadResumeI(&batchp->stopper, MSG_OK);
+            (void)osalThreadSuspendS(&batchp->wait);
+            continue;
+        }
+
+        sysinterval_t timeout = TIME_INFINITE;
+
+        if (batchp->fill_n > 0 && batchp->config->max_age != TIME_INFINITE)
+        {
+            const sysinterval_t age = chTimeDiffX(batchp->since,
+                    osalOsGetSystemTimeX());
+
+            if (age >= batchp->config->max_age)
+            {
+                (void)nvm_batch_swap_s(batchp);
+                continue;
+            }
+
+            timeout = batchp->config->max_age - age;
+        }
+
+        (void)osalThreadSuspendTimeoutS(&batchp->wait, timeout);
+    }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a batch logger object.
+ *
+ * @param[out] batchp   pointer to the @p NVMBatchLogger object
+ */
+void nvmbatchObjectInit(NVMBatchLogger *batchp)
+{
+    osalDbgCheck(batchp != NULL);
+
+    batchp->config = NULL;
+    batchp->limit = 0;
+    batchp->fill = 0;
+    batchp->fill_n = 0;
+    batchp->flush_n = 0;
+    batchp->running = false;
+    batchp->tp = NULL;
+    batchp->wait = NULL;
+    batchp->stopper = NULL;
+    memset(&batchp->stats, 0, sizeof(batchp->stats));
+}
+
+/**
+ * @brief   Starts logging.
+ *
+ * @param[in] batchp    pointer to the @p NVMBatchLogger object
+ * @param[in] config    pointer to the @p NVMBatchConfig object
+ */
+void nvmbatchStart(NVMBatchLogger *batchp, const NVMBatchConfig *config)
+{
+    osalDbgCheck((batchp != NULL) && (config != NULL) &&
+            (config->logp != NULL));
+    osalDbgAssert(batchp->running == false, "already running");
+
+    size_t limit = NVM_BATCH_BUFFER_SIZE;
+    if (config->size > 0 && config->size < limit)
+        limit = config->size;
+    if (nvmlogMaxRecordSize(config->logp) < limit)
+        limit = nvmlogMaxRecordSize(config->logp);
+    osalDbgAssert(limit >= 6 + NVM_BATCH_SAMPLE_MAX, "batch too small");
+
+    batchp->config = config;
+    batchp->limit = limit;
+
+    osalSysLock();
+    batchp->running = true;
+    osalSysUnlock();
+
+    /* Creates the writer thread. Note, it is created only once.*/
+    if (batchp->tp == NULL)
+    {
+        batchp->tp = chThdCreateStatic(batchp->wa, sizeof(batchp->wa),
+                NVM_BATCH_PRIO, nvm_batch_thread, batchp);
+    }
+    else
+    {
+        osalSysLock();
+        osalThreadResumeS(&batchp->wait, MSG_OK);
+        osalSysUnlock();
+    }
+}
+
+/**
+ * @brief   Stops logging.
+ * @details Waits for all collected samples to be written.
+ *
+ * @param[in] batchp    pointer to the @p NVMBatchLogger object
+ */
+void nvmbatchStop(NVMBatchLogger *batchp)
+{
+    osalDbgCheck(batchp != NULL);
+
+    osalSysLock();
+
+    if (batchp->running)
+    {
+        batchp->running = false;
+        osalThreadResumeI(&batchp->wait, MSG_RESET);
+        osalThreadSuspendS(&batchp->stopper);
+    }
+
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Adds a sample to the collecting batch.
+ * @details Sensor values are scaled to integers by the caller, e.g. the
+ *          fields of a @p ms58xxsample_t are logged as they are.
+ * @note    Timestamps of consecutive samples are expected to be less than
+ *          half the system time range apart.
+ *
+ * @param[in] batchp    pointer to the @p NVMBatchLogger object
+ * @param[in] channel   channel of the sample, below @p NVM_BATCH_CHANNELS
+ * @param[in] timestamp system time of the sample
+ * @param[in] value     sample value
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the sample has been accepted.
+ * @retval HAL_FAILED   the logger is stopped or both buffers are busy.
+ */
+bool nvmbatchPut(NVMBatchLogger *batchp, uint8_t channel,
+        systime_t timestamp, int32_t value)
+{
+    osalDbgCheck((batchp != NULL) && (channel < NVM_BATCH_CHANNELS));
+
+    osalSysLock();
+
+    if (batchp->running == false)
+    {
+        osalSysUnlock();
+        return HAL_FAILED;
+    }
+
+    if (batchp->fill_n + NVM_BATCH_SAMPLE_MAX > batchp->limit &&
+            nvm_batch_swap_s(batchp) == false)
+    {
+        ++batchp->stats.dropped;
+        osalSysUnlock();
+        return HAL_FAILED;
+    }
+
+    uint8_t *p = batchp->buffers[batchp->fill];
+    NVMBatchState *statep = &batchp->state;
+    size_t n = batchp->fill_n;
+
+    if (n == 0)
+    {
+        p[n++] = NVM_BATCH_FORMAT;
+        n += nvm_batch_put_varint(&p[n], (uint32_t)timestamp);
+        statep->timestamp = timestamp;
+        memset(statep->last, 0, sizeof(statep->last));
+
+        /* Starts the age of the batch. */
+        batchp->since = osalOsGetSystemTimeX();
+        osalThreadResumeS(&batchp->wait, MSG_OK);
+    }
+
+    p[n++] = channel;
+    n += nvm_batch_put_varint(&p[n], nvm_batch_zigzag(
+            nvm_batch_time_diff(statep->timestamp, timestamp)));
+    n += nvm_batch_put_varint(&p[n], nvm_batch_zigzag(
+            (int32_t)((uint32_t)value - (uint32_t)statep->last[channel])));
+    statep->timestamp = timestamp;
+    statep->last[channel] = value;
+
+    batchp->fill_n = n;
+    ++batchp->stats.samples;
+
+    /* Flushes early while the other buffer is free. */
+    if (n + NVM_BATCH_SAMPLE_MAX > batchp->limit)
+        (void)nvm_batch_swap_s(batchp);
+
+    osalSysUnlock();
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Hands the collecting batch to the writer thread.
+ * @details Does nothing if the batch is empty or the previous batch is
+ *          still being written.
+ *
+ * @param[in] batchp    pointer to the @p NVMBatchLogger object
+ */
+void nvmbatchFlush(NVMBatchLogger *batchp)
+{
+    osalDbgCheck(batchp != NULL);
+
+    osalSysLock();
+    if (batchp->running && batchp->fill_n > 0)
+        (void)nvm_batch_swap_s(batchp);
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Returns a consistent snapshot of the statistics.
+ *
+ * @param[in] batchp    pointer to the @p NVMBatchLogger object
+ * @param[out] statsp   pointer to a @p NVMBatchStats structure
+ */
+void nvmbatchGetStats(NVMBatchLogger *batchp, NVMBatchStats *statsp)
+{
+    osalDbgCheck((batchp != NULL) && (statsp != NULL));
+
+    osalSysLock();
+    *statsp = batchp->stats;
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Initializes a decoder for a batch record.
+ *
+ * @param[out] decp     pointer to the @p NVMBatchDecoder object
+ * @param[in] datap     pointer to the record payload, see @p nvmlogNext()
+ * @param[in] n         size of the record payload
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the record is not a batch.
+ */
+bool nvmbatchDecoderInit(NVMBatchDecoder *decp, const uint8_t *datap,
+        size_t n)
+{
+    osalDbgCheck((decp != NULL) && (datap != NULL || n == 0));
+
+    decp->p = datap;
+    decp->end = datap + n;
+    memset(decp->state.last, 0, sizeof(decp->state.last));
+
+    uint32_t timestamp;
+    if (n == 0 || *decp->p++ != NVM_BATCH_FORMAT ||
+            nvm_batch_get_varint(decp, &timestamp) == false)
+    {
+        decp->p = decp->end;
+        return HAL_FAILED;
+    }
+
+    decp->state.timestamp = (systime_t)timestamp;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Decodes the next sample of a batch.
+ *
+ * @param[in] decp      pointer to an initialized @p NVMBatchDecoder object
+ * @param[out] samplep  pointer to the @p NVMBatchSample receiving the sample
+ *
+ * @return              @p true if a sample has been decoded, @p false at
+ *                      the end of the batch or on malformed data.
+ */
+bool nvmbatchDecoderNext(NVMBatchDecoder *decp, NVMBatchSample *samplep)
+{
+    osalDbgCheck((decp != NULL) && (samplep != NULL));
+
+    if (decp->p == decp->end)
+        return false;
+
+    const uint8_t channel = *decp->p++;
+    uint32_t dt, dv;
+
+    if (channel >= NVM_BATCH_CHANNELS ||
+            nvm_batch_get_varint(decp, &dt) == false ||
+            nvm_batch_get_varint(decp, &dv) == false)
+    {
+        decp->p = decp->end;
+        return false;
+    }
+
+    NVMBatchState *statep = &decp->state;
+    statep->timestamp = (systime_t)(statep->timestamp +
+            (systime_t)nvm_batch_unzigzag(dt));
+    statep->last[channel] = (int32_t)((uint32_t)statep->last[channel] +
+            (uint32_t)nvm_batch_unzigzag(dv));
+
+    samplep->timestamp = statep->timestamp;
+    samplep->channel = channel;
+    samplep->value = statep->last[channel];
+
+    return true;
+}
+
+/** @} */
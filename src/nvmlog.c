@@ -0,0 +1,596 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    nvmlog.c
+ * @brief   NVM record log code.
+ *
+ * @addtogroup nvm_log
+ * @{
+ */
+
+#include "nvmlog.h"
+
+#include <string.h>
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Largest write alignment supported.
+ */
+#define NVM_LOG_ALIGN_MAX                   8
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Header at the start of every sector in use.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t sequence;
+} nvm_log_sector_header_t;
+
+/**
+ * @brief   Header in front of every record.
+ * @note    Written after the payload, so a valid header implies a complete
+ *          record.
+ */
+typedef struct
+{
+    uint16_t length;
+    uint16_t length_inv;
+} nvm_log_record_header_t;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t nvm_log_round(const NVMLog *logp, uint32_t n)
+{
+    return (n + logp->align - 1) / logp->align * logp->align;
+}
+
+static uint32_t nvm_log_addr(const NVMLog *logp, uint32_t sector,
+        uint32_t offset)
+{
+    return sector * logp->sector_size + offset;
+}
+
+/**
+ * @brief   Writes data padding the last chunk to the write alignment.
+ */
+static bool nvm_log_write(NVMLog *logp, uint32_t addr, const uint8_t *datap,
+        uint32_t n)
+{
+    const uint32_t aligned_n = n - n % logp->align;
+
+    if (aligned_n > 0 &&
+            nvmWrite(logp->nvmdp, addr, aligned_n, datap) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    if (aligned_n == n)
+        return HAL_SUCCESS;
+
+    uint8_t temp[NVM_LOG_ALIGN_MAX];
+    memset(temp, 0xff, sizeof(temp));
+    memcpy(temp, datap + aligned_n, n - aligned_n);
+
+    return nvmWrite(logp->nvmdp, addr + aligned_n, logp->align, temp);
+}
+
+/**
+ * @brief   Reads the header of a sector.
+ *
+ * @param[out] sequencep    receives the sequence number of a valid sector
+ *
+ * @return                  @p true if the sector is in use.
+ */
+static bool nvm_log_sector_valid(NVMLog *logp, uint32_t sector,
+        uint32_t *sequencep)
+{
+    nvm_log_sector_header_t header;
+
+    if (nvmRead(logp->nvmdp, nvm_log_addr(logp, sector, 0), sizeof(header),
+            (uint8_t*)&header) != HAL_SUCCESS)
+        return false;
+
+    if (header.magic != NVM_LOG_MAGIC || header.sequence == 0xffffffffUL)
+        return false;
+
+    *sequencep = header.sequence;
+    return true;
+}
+
+/**
+ * @brief   Reads the record header at @p offset of @p sector.
+ *
+ * @param[out] lengthp      receives the payload length of a valid record
+ *
+ * @return                  @p true if a complete record starts at
+ *                          @p offset, @p false at the end of the sector.
+ */
+static bool nvm_log_record_valid(NVMLog *logp, uint32_t sector,
+        uint32_t offset, uint32_t *lengthp)
+{
+    nvm_log_record_header_t header;
+
+    if (offset + logp->record_header_size > logp->sector_size)
+        return false;
+
+    if (nvmRead(logp->nvmdp, nvm_log_addr(logp, sector, offset),
+            sizeof(header), (uint8_t*)&header) != HAL_SUCCESS)
+        return false;
+
+    const uint16_t length_inv = ~header.length;
+
+    if (header.length_inv != length_inv || header.length == 0)
+        return false;
+
+    if (offset + logp->record_header_size +
+            nvm_log_round(logp, header.length) > logp->sector_size)
+        return false;
+
+    *lengthp = header.length;
+    return true;
+}
+
+/**
+ * @brief   Takes a sector into use as the new tail.
+ */
+static bool nvm_log_open_sector(NVMLog *logp, uint32_t sector,
+        uint32_t sequence)
+{
+    const uint32_t addr = nvm_log_addr(logp, sector, 0);
+
+    bool erased;
+    if (nvmIsErased(logp->nvmdp, addr, logp->sector_size, &erased) !=
+            HAL_SUCCESS)
+        return HAL_FAILED;
+
+    if (erased == false &&
+            nvmErase(logp->nvmdp, addr, logp->sector_size) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    const nvm_log_sector_header_t header =
+    {
+        .magic = NVM_LOG_MAGIC,
+        .sequence = sequence,
+    };
+
+    if (nvm_log_write(logp, addr, (const uint8_t*)&header,
+            sizeof(header)) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    logp->tail = sector;
+    logp->sequence = sequence;
+    logp->tail_offset = logp->sector_header_size;
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Locates the newest sector.
+ * @details Starting at sector 0 the sequence numbers grow by one per sector
+ *          up to the tail. The sectors behind it are either erased or
+ *          older, which allows a binary search over the sector headers.
+ *
+ * @return                  @p true if the log holds any sector.
+ */
+static bool nvm_log_find_tail(NVMLog *logp, uint32_t *tailp,
+        uint32_t *sequencep)
+{
+    uint32_t sequence0;
+
+    if (nvm_log_sector_valid(logp, 0, &sequence0) == false)
+    {
+        /* Note: Sector 0 is only invalid apart from an empty log if it was
+         * being taken into use after the last sector. */
+        *tailp = logp->sector_num - 1;
+        return nvm_log_sector_valid(logp, *tailp, sequencep);
+    }
+
+    uint32_t lo = 0;
+    uint32_t hi = logp->sector_num;
+    *sequencep = sequence0;
+
+    while (hi - lo > 1)
+    {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t sequence;
+
+        if (nvm_log_sector_valid(logp, mid, &sequence) == true &&
+                sequence - sequence0 == mid)
+        {
+            lo = mid;
+            *sequencep = sequence;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    *tailp = lo;
+    return true;
+}
+
+/**
+ * @brief   Locates the oldest sector given the tail.
+ * @details The sector following the tail is the oldest unless it has been
+ *          erased to become the next tail, then it is the one after.
+ */
+static uint32_t nvm_log_find_head(NVMLog *logp)
+{
+    uint32_t sequence;
+
+    for (uint32_t i = 1; i <= 2; ++i)
+    {
+        const uint32_t sector = (logp->tail + i) % logp->sector_num;
+
+        if (sector == logp->tail)
+            break;
+        if (nvm_log_sector_valid(logp, sector, &sequence) == true)
+            return sector;
+    }
+
+    /* Not wrapped yet. */
+    if (nvm_log_sector_valid(logp, 0, &sequence) == true)
+        return 0;
+
+    return logp->tail;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   NVM log object initialization.
+ *
+ * @param[in] logp      pointer to the @p NVMLog object to be initialized
+ * @param[in] nvmdp     pointer to the @p BaseNVMDevice holding the log
+ *
+ */
+void nvmlogObjectInit(NVMLog *logp, BaseNVMDevice *nvmdp)
+{
+    osalDbgCheck((logp != NULL) && (nvmdp != NULL));
+
+    logp->nvmdp = nvmdp;
+    logp->sector_size = 0;
+    logp->sector_num = 0;
+    logp->align = 1;
+    logp->sector_header_size = 0;
+    logp->record_header_size = 0;
+    logp->mounted = false;
+    logp->head = 0;
+    logp->tail = 0;
+    logp->sequence = 0;
+    logp->tail_offset = 0;
+}
+
+/**
+ * @brief   Mounts the log found on the device.
+ * @details Locates the newest sector with a binary search over the sector
+ *          headers and the end of its records by following their lengths.
+ *          A tail sector holding a torn record is closed, appending
+ *          continues in the next sector.
+ *
+ * @param[in] logp      pointer to the @p NVMLog object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded, the log may be empty.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ */
+bool nvmlogMount(NVMLog *logp)
+{
+    osalDbgCheck(logp != NULL);
+
+    NVMDeviceInfo di;
+
+    if (nvmGetInfo(logp->nvmdp, &di) != HAL_SUCCESS)
+        return HAL_FAILED;
+
+    osalDbgAssert(di.sector_num >= 2, "invalid size");
+    osalDbgAssert(di.write_alignment <= NVM_LOG_ALIGN_MAX,
+            "unsupported write_alignment");
+
+    logp->sector_size = di.sector_size;
+    logp->sector_num = di.sector_num;
+    logp->align = (di.write_alignment != 0) ? di.write_alignment : 1;
+    logp->sector_header_size =
+            nvm_log_round(logp, sizeof(nvm_log_sector_header_t));
+    logp->record_header_size =
+            nvm_log_round(logp, sizeof(nvm_log_record_header_t));
+    logp->mounted = false;
+
+    nvmAcquire(logp->nvmdp);
+
+    uint32_t tail;
+    uint32_t sequence;
+    if (nvm_log_find_tail(logp, &tail, &sequence) == false)
+    {
+        nvmRelease(logp->nvmdp);
+        return HAL_SUCCESS;
+    }
+
+    logp->tail = tail;
+    logp->sequence = sequence;
+    logp->head = nvm_log_find_head(logp);
+
+    uint32_t offset = logp->sector_header_size;
+    uint32_t length;
+    while (nvm_log_record_valid(logp, tail, offset, &length) == true)
+        offset += logp->record_header_size + nvm_log_round(logp, length);
+
+    /* Close the sector if anything follows the last record. */
+    bool erased = true;
+    if (offset < logp->sector_size &&
+            nvmIsErased(logp->nvmdp, nvm_log_addr(logp, tail, offset),
+                    logp->sector_size - offset, &erased) != HAL_SUCCESS)
+    {
+        nvmRelease(logp->nvmdp);
+        return HAL_FAILED;
+    }
+
+    logp->tail_offset = (erased == true) ? offset : logp->sector_size;
+    logp->mounted = true;
+
+    nvmRelease(logp->nvmdp);
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Erases the whole log.
+ *
+ * @param[in] logp      pointer to a mounted @p NVMLog object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ */
+bool nvmlogFormat(NVMLog *logp)
+{
+    osalDbgCheck(logp != NULL);
+    osalDbgAssert(logp->sector_num > 0, "not mounted");
+
+    nvmAcquire(logp->nvmdp);
+    const bool result = nvmErase(logp->nvmdp, 0,
+            logp->sector_size * logp->sector_num);
+    nvmRelease(logp->nvmdp);
+
+    logp->mounted = false;
+
+    return result;
+}
+
+/**
+ * @brief   Returns the largest record payload supported.
+ *
+ * @param[in] logp      pointer to a mounted @p NVMLog object
+ *
+ * @return              The maximum payload size in bytes.
+ *
+ */
+size_t nvmlogMaxRecordSize(NVMLog *logp)
+{
+    osalDbgCheck(logp != NULL);
+
+    size_t n = logp->sector_size - logp->sector_header_size -
+            logp->record_header_size;
+    n -= n % logp->align;
+
+    if (n > 0xfffe)
+        n = 0xfffe;
+
+    return n;
+}
+
+/**
+ * @brief   Appends a record.
+ * @details Records not fitting the tail sector go to the next sector. Once
+ *          all sectors are in use the oldest sector is erased for it.
+ *
+ * @param[in] logp      pointer to a mounted @p NVMLog object
+ * @param[in] datap     pointer to the record payload
+ * @param[in] n         size of the payload, up to
+ *                      @p nvmlogMaxRecordSize()
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ */
+bool nvmlogAppend(NVMLog *logp, const uint8_t *datap, size_t n)
+{
+    osalDbgCheck((logp != NULL) && (datap != NULL));
+    osalDbgAssert(logp->sector_num > 0, "not mounted");
+    osalDbgAssert(n > 0 && n <= nvmlogMaxRecordSize(logp),
+            "invalid parameters");
+
+    const uint32_t record_size = logp->record_header_size +
+            nvm_log_round(logp, n);
+
+    nvmAcquire(logp->nvmdp);
+
+    if (logp->mounted == false)
+    {
+        if (nvm_log_open_sector(logp, 0, 0) != HAL_SUCCESS)
+        {
+            nvmRelease(logp->nvmdp);
+            return HAL_FAILED;
+        }
+        logp->head = 0;
+        logp->mounted = true;
+    }
+    else if (logp->tail_offset + record_size > logp->sector_size)
+    {
+        const uint32_t next = (logp->tail + 1) % logp->sector_num;
+
+        /* Drop the oldest sector. */
+        if (next == logp->head)
+            logp->head = (logp->head + 1) % logp->sector_num;
+
+        if (nvm_log_open_sector(logp, next, logp->sequence + 1) !=
+                HAL_SUCCESS)
+        {
+            nvmRelease(logp->nvmdp);
+            return HAL_FAILED;
+        }
+    }
+
+    const uint32_t addr = nvm_log_addr(logp, logp->tail, logp->tail_offset);
+    const nvm_log_record_header_t header =
+    {
+        .length = (uint16_t)n,
+        .length_inv = (uint16_t)~n,
+    };
+
+    /* Note: The header goes last to validate the complete record. */
+    if (nvm_log_write(logp, addr + logp->record_header_size, datap,
+            n) != HAL_SUCCESS ||
+            nvm_log_write(logp, addr, (const uint8_t*)&header,
+            sizeof(header)) != HAL_SUCCESS)
+    {
+        /* Do not reuse the partly written space. */
+        logp->tail_offset = logp->sector_size;
+        nvmRelease(logp->nvmdp);
+        return HAL_FAILED;
+    }
+
+    logp->tail_offset += record_size;
+
+    nvmRelease(logp->nvmdp);
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Synchronizes the underlying device.
+ *
+ * @param[in] logp      pointer to the @p NVMLog object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ */
+bool nvmlogSync(NVMLog *logp)
+{
+    osalDbgCheck(logp != NULL);
+
+    nvmAcquire(logp->nvmdp);
+    const bool result = nvmSync(logp->nvmdp);
+    nvmRelease(logp->nvmdp);
+
+    return result;
+}
+
+/**
+ * @brief   Positions a cursor at the oldest record.
+ *
+ * @param[in] logp      pointer to the @p NVMLog object
+ * @param[out] cursorp  pointer to the @p NVMLogCursor object
+ *
+ */
+void nvmlogRewind(NVMLog *logp, NVMLogCursor *cursorp)
+{
+    osalDbgCheck((logp != NULL) && (cursorp != NULL));
+
+    cursorp->sector = logp->head;
+    cursorp->offset = logp->sector_header_size;
+}
+
+/**
+ * @brief   Reads the record at a cursor and advances it.
+ * @note    Appends may erase the sector a cursor points to once the log
+ *          wrapped around.
+ *
+ * @param[in] logp      pointer to the @p NVMLog object
+ * @param[in,out] cursorp pointer to a rewound @p NVMLogCursor object
+ * @param[out] buffer   pointer to the payload buffer
+ * @param[in] size      size of the payload buffer, longer payloads are
+ *                      truncated
+ * @param[out] np       receives the payload length, 0 at the end of the log
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ */
+bool nvmlogNext(NVMLog *logp, NVMLogCursor *cursorp, uint8_t *buffer,
+        size_t size, size_t *np)
+{
+    osalDbgCheck((logp != NULL) && (cursorp != NULL) && (np != NULL));
+
+    *np = 0;
+
+    if (logp->mounted == false)
+        return HAL_SUCCESS;
+
+    nvmAcquireShared(logp->nvmdp);
+
+    uint32_t length;
+    while (true)
+    {
+        if (cursorp->sector == logp->tail &&
+                cursorp->offset >= logp->tail_offset)
+        {
+            nvmReleaseShared(logp->nvmdp);
+            return HAL_SUCCESS;
+        }
+
+        if (nvm_log_record_valid(logp, cursorp->sector, cursorp->offset,
+                &length) == true)
+            break;
+
+        if (cursorp->sector == logp->tail)
+        {
+            nvmReleaseShared(logp->nvmdp);
+            return HAL_SUCCESS;
+        }
+
+        cursorp->sector = (cursorp->sector + 1) % logp->sector_num;
+        cursorp->offset = logp->sector_header_size;
+    }
+
+    const size_t copy_n = (length < size) ? length : size;
+    if (copy_n > 0 && nvmRead(logp->nvmdp,
+            nvm_log_addr(logp, cursorp->sector, cursorp->offset +
+                    logp->record_header_size), copy_n, buffer) != HAL_SUCCESS)
+    {
+        nvmReleaseShared(logp->nvmdp);
+        return HAL_FAILED;
+    }
+
+    cursorp->offset += logp->record_header_size + nvm_log_round(logp, length);
+    *np = length;
+
+    nvmReleaseShared(logp->nvmdp);
+
+    return HAL_SUCCESS;
+}
+
+/** @} */
@@ -0,0 +1,413 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    nvmscrub.c
+ * @brief   NVM background scrubber code.
+ *
+ * @addtogroup nvm_scrub
+ * @{
+ */
+
+#include "nvmscrub.h"
+#include "nvm_tools.h"
+
+#include <string.h>
+
+/*
+ * @brief   Functional description
+ *          Replaces verifying whole devices at startup by checking a few
+ *          sectors per interval in the background, so every sector is
+ *          still checked once per pass.
+ *          Plain devices: The CRC32 of a sector is recorded on its first
+ *          check. A differing CRC32 on a later check is reported once,
+ *          intended changes have to be announced by nvmscrubInvalidate().
+ *          Mirrors: The CRC32 of both copies of a sector is computed. Equal
+ *          copies record their CRC32. If the copies differ, the copy
+ *          matching the recorded CRC32 is intact and repairs the other one
+ *          by nvmmirrorRepair(). Without a matching copy the mismatch is
+ *          reported. Sectors are skipped while the copies may differ
+ *          legitimately, e.g. during a transaction.
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Applies the CRC32 computed for a sector.
+ * @details The result is dropped if the checksums have been invalidated
+ *          meanwhile.
+ *
+ * @return              Event flags to be broadcast.
+ */
+static eventflags_t nvm_scrub_apply(NVMScrubber *scrubp, uint32_t sector,
+        uint32_t generation, uint32_t crc)
+{
+    NVMScrubSector *sp = &scrubp->config->sectors[sector];
+    eventflags_t flags = 0;
+
+    osalSysLock();
+    if (generation == scrubp->generation)
+    {
+        if (sp->state == NVM_SCRUB_UNKNOWN)
+        {
+            sp->crc = crc;
+            sp->state = NVM_SCRUB_KNOWN;
+        }
+        else if (sp->state == NVM_SCRUB_KNOWN && sp->crc != crc)
+        {
+            /* Reported once until invalidated. */
+            sp->state = NVM_SCRUB_BAD;
+            ++scrubp->stats.mismatches;
+            flags = NVM_SCRUB_EVENT_MISMATCH;
+        }
+    }
+    osalSysUnlock();
+
+    return flags;
+}
+
+/**
+ * @brief   Checks a sector of a plain device.
+ *
+ * @return              Event flags to be broadcast.
+ */
+static eventflags_t nvm_scrub_device(NVMScrubber *scrubp, uint32_t sector)
+{
+    osalSysLock();
+    const uint32_t generation = scrubp->generation;
+    osalSysUnlock();
+
+    uint32_t crc = 0;
+
+    nvmAcquireShared(scrubp->nvmp);
+    bool ok = nvmcrc32(scrubp->nvmp, sector * scrubp->sector_size,
+            scrubp->sector_size, &crc);
+    nvmReleaseShared(scrubp->nvmp);
+
+    if (ok == false)
+        return NVM_SCRUB_EVENT_ERROR;
+
+    return nvm_scrub_apply(scrubp, sector, generation, crc);
+}
+
+#if HAL_USE_NVM_MIRROR || defined(__DOXYGEN__)
+/**
+ * @brief   Checks and repairs a sector of a mirror.
+ * @note    Called with the mirror acquired.
+ *
+ * @param[out] busyp    set to @p true if the copies may differ legitimately
+ *
+ * @return              Event flags to be broadcast.
+ */
+static eventflags_t nvm_scrub_mirror(NVMScrubber *scrubp, uint32_t sector,
+        bool *busyp)
+{
+    NVMMirrorDriver *mirrorp = scrubp->config->mirrorp;
+    NVMScrubSector *sp = &scrubp->config->sectors[sector];
+    const uint32_t addr = sector * scrubp->sector_size;
+
+    /* Finish pending updates of mirror b. */
+    if (nvmSync((BaseNVMDevice *)mirrorp) != HAL_SUCCESS)
+        return NVM_SCRUB_EVENT_ERROR;
+
+    BaseNVMDevice *nvmap, *nvmbp;
+    uint32_t orga, orgb;
+    if (nvmmirrorGetCopy(mirrorp, false, &nvmap, &orga) != HAL_SUCCESS ||
+            nvmmirrorGetCopy(mirrorp, true, &nvmbp, &orgb) != HAL_SUCCESS)
+    {
+        *busyp = true;
+        return 0;
+    }
+
+    uint32_t crca = 0;
+    uint32_t crcb = 0;
+    if (nvmcrc32(nvmap, orga + addr, scrubp->sector_size, &crca) == false ||
+            nvmcrc32(nvmbp, orgb + addr, scrubp->sector_size, &crcb) == false)
+        return NVM_SCRUB_EVENT_ERROR;
+
+    /* Intact, changes by writes are taken over. */
+    if (crca == crcb)
+    {
+        sp->crc = crca;
+        sp->state = NVM_SCRUB_KNOWN;
+        return 0;
+    }
+
+    eventflags_t flags = 0;
+    if (sp->state != NVM_SCRUB_BAD)
+    {
+        ++scrubp->stats.mismatches;
+        flags = NVM_SCRUB_EVENT_MISMATCH;
+    }
+
+    /* Without a recorded CRC32 the intact copy is unknown. */
+    if (sp->state != NVM_SCRUB_KNOWN ||
+            (sp->crc != crca && sp->crc != crcb))
+    {
+        sp->state = NVM_SCRUB_BAD;
+        return flags;
+    }
+
+    if (nvmmirrorRepair(mirrorp, addr, scrubp->sector_size,
+            sp->crc == crcb) != HAL_SUCCESS)
+        return flags | NVM_SCRUB_EVENT_ERROR;
+
+    ++scrubp->stats.repairs;
+
+    return flags | NVM_SCRUB_EVENT_REPAIRED;
+}
+#endif /* HAL_USE_NVM_MIRROR */
+
+/**
+ * @brief   Checks the next sector.
+ *
+ * @return              @p false if the sector has to be checked again later.
+ */
+static bool nvm_scrub_step(NVMScrubber *scrubp)
+{
+    const uint32_t sector = scrubp->next;
+    eventflags_t flags;
+
+#if HAL_USE_NVM_MIRROR
+    if (scrubp->config->mirrorp != NULL)
+    {
+        bool busy = false;
+
+        nvmAcquire((BaseNVMDevice *)scrubp->config->mirrorp);
+        flags = nvm_scrub_mirror(scrubp, sector, &busy);
+        nvmRelease((BaseNVMDevice *)scrubp->config->mirrorp);
+
+        if (busy == true)
+            return false;
+    }
+    else
+#endif /* HAL_USE_NVM_MIRROR */
+    {
+        flags = nvm_scrub_device(scrubp, sector);
+    }
+
+    if (++scrubp->next == scrubp->sector_num)
+    {
+        scrubp->next = 0;
+        ++scrubp->stats.passes;
+        flags |= NVM_SCRUB_EVENT_PASS;
+    }
+
+    osalSysLock();
+    if ((flags & NVM_SCRUB_EVENT_ERROR) != 0)
+        ++scrubp->stats.errors;
+    if (flags != 0)
+        osalEventBroadcastFlagsI(&scrubp->event, flags);
+    osalOsRescheduleS();
+    osalSysUnlock();
+
+    return true;
+}
+
+static void nvm_scrub_thread(void *arg)
+{
+    NVMScrubber *scrubp = arg;
+
+    chRegSetThreadName("nvm_scrub");
+
+    osalSysLock();
+
+    while (true)
+    {
+        if (scrubp->running == false)
+        {
+            osalThreadResumeI(&scrubp->stopper, MSG_OK);
+            (void)osalThreadSuspendS(&scrubp->wait);
+            continue;
+        }
+
+        (void)osalThreadSuspendTimeoutS(&scrubp->wait,
+                scrubp->config->interval);
+        if (scrubp->running == false)
+            continue;
+
+        osalSysUnlock();
+
+        for (uint32_t i = 0; i < scrubp->config->sectors_per_interval; ++i)
+        {
+            if (nvm_scrub_step(scrubp) == false)
+                break;
+        }
+
+        osalSysLock();
+    }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a scrubber object.
+ *
+ * @param[out] scrubp   pointer to the @p NVMScrubber object
+ */
+void nvmscrubObjectInit(NVMScrubber *scrubp)
+{
+    osalDbgCheck(scrubp != NULL);
+
+    scrubp->config = NULL;
+    scrubp->nvmp = NULL;
+    scrubp->next = 0;
+    scrubp->generation = 0;
+    scrubp->running = false;
+    scrubp->tp = NULL;
+    scrubp->wait = NULL;
+    scrubp->stopper = NULL;
+    memset(&scrubp->stats, 0, sizeof(scrubp->stats));
+    osalEventObjectInit(&scrubp->event);
+}
+
+/**
+ * @brief   Starts scrubbing.
+ * @details The first check is due one interval after now. Recorded
+ *          checksums are kept, a new configuration may pass a sector array
+ *          restored from a previous run.
+ *
+ * @param[in] scrubp    pointer to the @p NVMScrubber object
+ * @param[in] config    pointer to the @p NVMScrubConfig object
+ */
+void nvmscrubStart(NVMScrubber *scrubp, const NVMScrubConfig *config)
+{
+    osalDbgCheck((scrubp != NULL) && (config != NULL));
+    osalDbgCheck((config->sectors != NULL) &&
+            (config->sectors_per_interval > 0));
+    osalDbgAssert(scrubp->running == false, "already running");
+
+    scrubp->config = config;
+    scrubp->nvmp = config->nvmp;
+#if HAL_USE_NVM_MIRROR
+    if (config->mirrorp != NULL)
+        scrubp->nvmp = (BaseNVMDevice *)config->mirrorp;
+#endif /* HAL_USE_NVM_MIRROR */
+    osalDbgCheck(scrubp->nvmp != NULL);
+
+    NVMDeviceInfo nvmdi;
+    nvmGetInfo(scrubp->nvmp, &nvmdi);
+    scrubp->sector_size = nvmdi.sector_size;
+    scrubp->sector_num = nvmdi.sector_num;
+    scrubp->next = 0;
+
+    osalSysLock();
+    scrubp->running = true;
+    osalSysUnlock();
+
+    /* Creates the scrubber thread. Note, it is created only once.*/
+    if (scrubp->tp == NULL)
+    {
+        scrubp->tp = chThdCreateStatic(scrubp->wa, sizeof(scrubp->wa),
+                NVM_SCRUB_PRIO, nvm_scrub_thread, scrubp);
+    }
+    else
+    {
+        osalSysLock();
+        osalThreadResumeS(&scrubp->wait, MSG_OK);
+        osalSysUnlock();
+    }
+}
+
+/**
+ * @brief   Stops scrubbing.
+ * @details Waits for the check in progress to complete.
+ *
+ * @param[in] scrubp    pointer to the @p NVMScrubber object
+ */
+void nvmscrubStop(NVMScrubber *scrubp)
+{
+    osalDbgCheck(scrubp != NULL);
+
+    osalSysLock();
+
+    if (scrubp->running)
+    {
+        scrubp->running = false;
+        osalThreadResumeI(&scrubp->wait, MSG_RESET);
+        osalThreadSuspendS(&scrubp->stopper);
+    }
+
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Forgets the checksums of a range of sectors.
+ * @details Required after intended changes of a plain device, the next
+ *          check records the new checksums. Mirrors take over changes
+ *          by themselves.
+ *
+ * @param[in] scrubp    pointer to the @p NVMScrubber object
+ * @param[in] first     first sector
+ * @param[in] num       number of sectors
+ */
+void nvmscrubInvalidate(NVMScrubber *scrubp, uint32_t first, uint32_t num)
+{
+    osalDbgCheck((scrubp != NULL) && (scrubp->config != NULL));
+    osalDbgCheck(first + num <= scrubp->sector_num);
+
+    osalSysLock();
+    for (uint32_t i = first; i < first + num; ++i)
+        scrubp->config->sectors[i].state = NVM_SCRUB_UNKNOWN;
+    /* Drops results of a check in progress. */
+    ++scrubp->generation;
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Returns a consistent snapshot of the statistics.
+ *
+ * @param[in] scrubp    pointer to the @p NVMScrubber object
+ * @param[out] statsp   pointer to a @p NVMScrubStats structure
+ */
+void nvmscrubGetStats(NVMScrubber *scrubp, NVMScrubStats *statsp)
+{
+    osalDbgCheck((scrubp != NULL) && (statsp != NULL));
+
+    osalSysLock();
+    *statsp = scrubp->stats;
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Returns the event source broadcasting the scrubber event flags.
+ *
+ * @param[in] scrubp    pointer to the @p NVMScrubber object
+ *
+ * @return              Pointer to the event source.
+ */
+event_source_t *nvmscrubGetEventSource(NVMScrubber *scrubp)
+{
+    osalDbgCheck(scrubp != NULL);
+
+    return &scrubp->event;
+}
+
+/** @} */
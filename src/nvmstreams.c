@@ -22,6 +22,8 @@
 
 #include "nvmstreams.h"
 
+#include <string.h>
+
 /*===========================================================================*/
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
@@ -38,23 +40,176 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
-static size_t writes(void *ip, const uint8_t *bp, size_t n)
+static size_t nvms_capacity(NVMStream *nvmsp)
 {
-    NVMStream *nvmsp = ip;
+    /* Note: Let runs end at page boundaries so flushes are page aligned. */
+    if (nvmsp->page_size > 0 && nvmsp->page_size <= nvmsp->buffer_size)
+        return nvmsp->buffer_size - nvmsp->buffer_org % nvmsp->page_size;
 
-    if (nvmsp->size - nvmsp->eos < n)
-        n = nvmsp->size - nvmsp->eos;
+    return nvmsp->buffer_size;
+}
+
+static bool nvms_flush(NVMStream *nvmsp)
+{
+    if (nvmsp->dirty == false)
+        return HAL_SUCCESS;
+
+    nvmsp->dirty = false;
+
+    nvmAcquire(nvmsp->nvmdp);
+    if (nvmWrite(nvmsp->nvmdp, nvmsp->buffer_org, nvmsp->buffer_n,
+            nvmsp->buffer) != HAL_SUCCESS)
+    {
+        nvmRelease(nvmsp->nvmdp);
+        /* Drop the data which could not be written. */
+        nvmsp->eos = nvmsp->buffer_org;
+        nvmsp->buffer_n = 0;
+        return HAL_FAILED;
+    }
+    nvmRelease(nvmsp->nvmdp);
+
+    /* Note: The buffer stays valid for reading back. */
+    return HAL_SUCCESS;
+}
 
+static bool nvms_write_direct(NVMStream *nvmsp, const uint8_t *bp, size_t n)
+{
     nvmAcquire(nvmsp->nvmdp);
     if (nvmWrite(nvmsp->nvmdp, nvmsp->eos, n, bp) != HAL_SUCCESS)
     {
         nvmRelease(nvmsp->nvmdp);
-        return 0;
+        return HAL_FAILED;
     }
     nvmRelease(nvmsp->nvmdp);
 
     nvmsp->eos += n;
 
+    return HAL_SUCCESS;
+}
+
+static bool nvms_read_direct(NVMStream *nvmsp, uint8_t *bp, size_t n)
+{
+    nvmAcquireShared(nvmsp->nvmdp);
+    if (nvmRead(nvmsp->nvmdp, nvmsp->offset, n, bp) != HAL_SUCCESS)
+    {
+        nvmReleaseShared(nvmsp->nvmdp);
+        return HAL_FAILED;
+    }
+    nvmReleaseShared(nvmsp->nvmdp);
+
+    nvmsp->offset += n;
+
+    return HAL_SUCCESS;
+}
+
+static bool nvms_write_buffered(NVMStream *nvmsp, const uint8_t *bp, size_t n)
+{
+    if (n >= nvmsp->buffer_size)
+    {
+        if (nvms_flush(nvmsp) != HAL_SUCCESS)
+            return HAL_FAILED;
+        return nvms_write_direct(nvmsp, bp, n);
+    }
+
+    while (n > 0)
+    {
+        /* Start a new run unless appending to the pending one. */
+        if (nvmsp->dirty == false ||
+                nvmsp->buffer_org + nvmsp->buffer_n != nvmsp->eos)
+        {
+            if (nvms_flush(nvmsp) != HAL_SUCCESS)
+                return HAL_FAILED;
+            nvmsp->buffer_org = nvmsp->eos;
+            nvmsp->buffer_n = 0;
+        }
+
+        const size_t capacity = nvms_capacity(nvmsp);
+        size_t chunk_n = capacity - nvmsp->buffer_n;
+        if (n < chunk_n)
+            chunk_n = n;
+
+        memcpy(nvmsp->buffer + nvmsp->buffer_n, bp, chunk_n);
+        nvmsp->buffer_n += chunk_n;
+        nvmsp->eos += chunk_n;
+        nvmsp->dirty = true;
+        bp += chunk_n;
+        n -= chunk_n;
+
+        if (nvmsp->buffer_n == capacity && nvms_flush(nvmsp) != HAL_SUCCESS)
+            return HAL_FAILED;
+    }
+
+    return HAL_SUCCESS;
+}
+
+static bool nvms_read_buffered(NVMStream *nvmsp, uint8_t *bp, size_t n)
+{
+    if (n >= nvmsp->buffer_size)
+    {
+        if (nvms_flush(nvmsp) != HAL_SUCCESS)
+            return HAL_FAILED;
+        return nvms_read_direct(nvmsp, bp, n);
+    }
+
+    while (n > 0)
+    {
+        /* Read ahead unless the offset is buffered. Pending data is
+         * served from the buffer as well. */
+        if (nvmsp->offset < nvmsp->buffer_org ||
+                nvmsp->offset >= nvmsp->buffer_org + nvmsp->buffer_n)
+        {
+            if (nvms_flush(nvmsp) != HAL_SUCCESS)
+                return HAL_FAILED;
+
+            size_t fill_n = nvmsp->eos - nvmsp->offset;
+            if (nvmsp->buffer_size < fill_n)
+                fill_n = nvmsp->buffer_size;
+
+            nvmsp->buffer_org = nvmsp->offset;
+            nvmsp->buffer_n = 0;
+
+            nvmAcquireShared(nvmsp->nvmdp);
+            if (nvmRead(nvmsp->nvmdp, nvmsp->buffer_org, fill_n,
+                    nvmsp->buffer) != HAL_SUCCESS)
+            {
+                nvmReleaseShared(nvmsp->nvmdp);
+                return HAL_FAILED;
+            }
+            nvmReleaseShared(nvmsp->nvmdp);
+
+            nvmsp->buffer_n = fill_n;
+        }
+
+        const size_t pos = nvmsp->offset - nvmsp->buffer_org;
+        size_t chunk_n = nvmsp->buffer_n - pos;
+        if (n < chunk_n)
+            chunk_n = n;
+
+        memcpy(bp, nvmsp->buffer + pos, chunk_n);
+        nvmsp->offset += chunk_n;
+        bp += chunk_n;
+        n -= chunk_n;
+    }
+
+    return HAL_SUCCESS;
+}
+
+static size_t writes(void *ip, const uint8_t *bp, size_t n)
+{
+    NVMStream *nvmsp = ip;
+
+    if (nvmsp->size - nvmsp->eos < n)
+        n = nvmsp->size - nvmsp->eos;
+
+    bool result;
+    if (nvmsp->buffer != NULL)
+        result = nvms_write_buffered(nvmsp, bp, n);
+    else
+        result = nvms_write_direct(nvmsp, bp, n);
+
+    if (result != HAL_SUCCESS)
+        return 0;
+
     return n;
 }
 
@@ -65,15 +220,14 @@ static size_t reads(void *ip, uint8_t *bp, size_t n)
     if (nvmsp->eos - nvmsp->offset < n)
         n = nvmsp->eos - nvmsp->offset;
 
-    nvmAcquire(nvmsp->nvmdp);
-    if (nvmRead(nvmsp->nvmdp, nvmsp->offset, n, bp) != HAL_SUCCESS)
-    {
-        nvmRelease(nvmsp->nvmdp);
-        return 0;
-    }
-    nvmRelease(nvmsp->nvmdp);
+    bool result;
+    if (nvmsp->buffer != NULL)
+        result = nvms_read_buffered(nvmsp, bp, n);
+    else
+        result = nvms_read_direct(nvmsp, bp, n);
 
-    nvmsp->offset += n;
+    if (result != HAL_SUCCESS)
+        return 0;
 
     return n;
 }
@@ -85,15 +239,8 @@ static msg_t put(void *ip, uint8_t b)
     if (nvmsp->size - nvmsp->eos <= 0)
         return MSG_RESET;
 
-    nvmAcquire(nvmsp->nvmdp);
-    if (nvmWrite(nvmsp->nvmdp, nvmsp->eos, 1, &b) != HAL_SUCCESS)
-    {
-        nvmRelease(nvmsp->nvmdp);
+    if (writes(ip, &b, 1) != 1)
         return MSG_RESET;
-    }
-    nvmRelease(nvmsp->nvmdp);
-
-    nvmsp->eos += 1;
 
     return MSG_OK;
 }
@@ -106,15 +253,8 @@ static msg_t get(void *ip)
     if (nvmsp->eos - nvmsp->offset <= 0)
         return MSG_RESET;
 
-    nvmAcquire(nvmsp->nvmdp);
-    if (nvmRead(nvmsp->nvmdp, nvmsp->offset, 1, &b) != HAL_SUCCESS)
-    {
-        nvmRelease(nvmsp->nvmdp);
+    if (reads(ip, &b, 1) != 1)
         return MSG_RESET;
-    }
-    nvmRelease(nvmsp->nvmdp);
-
-    nvmsp->offset += 1;
 
     return b;
 }
@@ -144,10 +284,40 @@ static const struct NVMStreamVMT vmt =
  */
 void nvmsObjectInit(NVMStream *nvmsp, BaseNVMDevice *nvmdp, size_t eos)
 {
+    nvmsObjectInitBuffered(nvmsp, nvmdp, eos, NULL, 0);
+}
+
+/**
+ * @brief   Buffered NVM stream object initialization.
+ * @details Writes are collected in @p buffer and written out once it is
+ *          full or on @p nvmsFlush(), runs ending at page boundaries of the
+ *          device. Reads fill the buffer ahead. Transfers not smaller than
+ *          the buffer bypass it.
+ * @note    Data written is not visible on the device before flushing.
+ *
+ * @param[in] nvmsp     pointer to the @p NVMStream object to be initialized
+ * @param[in] dev       pointer to the @p BaseNVMDevice for the stream
+ * @param[in] eos       Initial End Of Stream offset. Normally you need to
+ *                      put this to zero for output streams or equal to @p size
+ *                      for input streams.
+ * @param[in] buffer    pointer to the stream buffer or @p NULL
+ * @param[in] size      size of the stream buffer
+ *
+ */
+void nvmsObjectInitBuffered(NVMStream *nvmsp, BaseNVMDevice *nvmdp,
+        size_t eos, uint8_t *buffer, size_t size)
+{
+    osalDbgCheck((buffer != NULL) == (size > 0));
+
     nvmsp->vmt = &vmt;
     nvmsp->nvmdp = nvmdp;
     nvmsp->eos = eos;
     nvmsp->offset = 0;
+    nvmsp->buffer = buffer;
+    nvmsp->buffer_size = size;
+    nvmsp->buffer_org = 0;
+    nvmsp->buffer_n = 0;
+    nvmsp->dirty = false;
 
     /* Set size. */
     {
@@ -155,10 +325,12 @@ void nvmsObjectInit(NVMStream *nvmsp, BaseNVMDevice *nvmdp, size_t eos)
         if (nvmGetInfo(nvmdp, &di) == HAL_SUCCESS)
         {
             nvmsp->size = di.sector_size * di.sector_num;
+            nvmsp->page_size = di.page_size;
         }
         else
         {
             nvmsp->size = 0;
+            nvmsp->page_size = 0;
         }
     }
 
@@ -166,4 +338,22 @@ void nvmsObjectInit(NVMStream *nvmsp, BaseNVMDevice *nvmdp, size_t eos)
     osalDbgAssert(nvmsp->size > 0, "invalid size");
 }
 
+/**
+ * @brief   Writes out data pending in the stream buffer.
+ * @note    Data pending is dropped if writing fails.
+ *
+ * @param[in] nvmsp     pointer to the @p NVMStream object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ */
+bool nvmsFlush(NVMStream *nvmsp)
+{
+    osalDbgCheck(nvmsp != NULL);
+
+    return nvms_flush(nvmsp);
+}
+
 /** @} */
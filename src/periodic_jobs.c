@@ -0,0 +1,270 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Runs all jobs registered with PERIODIC_JOB() from one dispatcher thread.
+ * The jobs are kept in a min-heap ordered by their next run time, the
+ * dispatcher sleeps until the root is due, runs it and moves it one period
+ * ahead. Run times are compared relative to the run time of the last
+ * dispatched job, which no pending job precedes, so the order stays correct
+ * across system time wrap-arounds.
+ */
+
+#include "periodic_jobs.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/*===========================================================================*/
+/* Local definitions                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Imported variables                                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Exported variables                                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local types                                                               */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local constants                                                           */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local variables                                                           */
+/*===========================================================================*/
+
+static THD_WORKING_AREA(periodic_wa, PERIODIC_JOBS_STACK_SIZE);
+
+/* Dispatcher thread, created by the first start */
+static thread_t *periodic_tp;
+/* Dispatcher while sleeping or parked */
+static thread_reference_t periodic_wait;
+/* Thread waiting for the dispatcher to park */
+static thread_reference_t periodic_stopper;
+static bool periodic_running;
+
+/* Jobs ordered by run time */
+static const periodic_job_t *periodic_heap[PERIODIC_JOBS_MAX];
+static size_t periodic_count;
+/* Run time of the last dispatched job */
+static systime_t periodic_epoch;
+
+/*===========================================================================*/
+/* Local functions                                                           */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns whether job @p a runs before job @p b.
+ * @details Ties are broken by table order.
+ */
+static bool periodic_before(const periodic_job_t *a, const periodic_job_t *b)
+{
+    sysinterval_t da = chTimeDiffX(periodic_epoch, a->statep->due);
+    sysinterval_t db = chTimeDiffX(periodic_epoch, b->statep->due);
+
+    return da < db || (da == db && a < b);
+}
+
+static void periodic_sift_up(size_t i)
+{
+    const periodic_job_t *jobp = periodic_heap[i];
+
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+
+        if (!periodic_before(jobp, periodic_heap[parent]))
+            break;
+
+        periodic_heap[i] = periodic_heap[parent];
+        i = parent;
+    }
+
+    periodic_heap[i] = jobp;
+}
+
+static void periodic_sift_down(size_t i)
+{
+    const periodic_job_t *jobp = periodic_heap[i];
+
+    while (true)
+    {
+        size_t child = 2 * i + 1;
+
+        if (child >= periodic_count)
+            break;
+        if (child + 1 < periodic_count &&
+                periodic_before(periodic_heap[child + 1], periodic_heap[child]))
+            ++child;
+        if (!periodic_before(periodic_heap[child], jobp))
+            break;
+
+        periodic_heap[i] = periodic_heap[child];
+        i = child;
+    }
+
+    periodic_heap[i] = jobp;
+}
+
+/**
+ * @brief   Moves the root job to its next run time.
+ * @details Periods which already ended while the job ran are skipped and
+ *          counted as overruns, the job keeps its phase.
+ */
+static void periodic_reschedule(systime_t start, systime_t end)
+{
+    const periodic_job_t *jobp = periodic_heap[0];
+    periodic_state_t *statep = jobp->statep;
+
+    sysinterval_t exec = chTimeDiffX(start, end);
+    if (exec > statep->exec_max)
+        statep->exec_max = exec;
+
+    sysinterval_t late = chTimeDiffX(statep->due, end);
+    sysinterval_t skipped = late / jobp->period;
+
+    statep->overruns += skipped;
+    statep->due = chTimeAddX(statep->due, (skipped + 1) * jobp->period);
+
+    periodic_sift_down(0);
+}
+
+static void periodic_dispatcher(void *arg)
+{
+    (void)arg;
+
+    chRegSetThreadName("periodic");
+
+    osalSysLock();
+
+    while (true)
+    {
+        if (periodic_running == false)
+        {
+            osalThreadResumeS(&periodic_stopper, MSG_OK);
+            osalThreadSuspendS(&periodic_wait);
+            continue;
+        }
+
+        const periodic_job_t *jobp = periodic_heap[0];
+        systime_t now = chVTGetSystemTimeX();
+
+        if (chTimeDiffX(periodic_epoch, now) <
+                chTimeDiffX(periodic_epoch, jobp->statep->due))
+        {
+            (void)osalThreadSuspendTimeoutS(&periodic_wait,
+                    chTimeDiffX(now, jobp->statep->due));
+            continue;
+        }
+
+        periodic_epoch = jobp->statep->due;
+        osalSysUnlock();
+
+        jobp->fn(jobp->arg);
+
+        osalSysLock();
+        periodic_reschedule(now, chVTGetSystemTimeX());
+    }
+}
+
+/*===========================================================================*/
+/* Exported functions                                                        */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts dispatching the periodic jobs.
+ * @details The first run of each job is due its phase after now. The
+ *          runtime state of all jobs is reset. Without registered jobs no
+ *          thread is created.
+ */
+void periodicJobsStart(void)
+{
+    osalDbgAssert(periodic_running == false, "already running");
+    osalDbgAssert(__periodic_jobs_end - __periodic_jobs_start <=
+            PERIODIC_JOBS_MAX, "too many jobs");
+
+    systime_t now = chVTGetSystemTime();
+
+    periodic_epoch = now;
+    periodic_count = 0;
+
+    for (const periodic_job_t *jobp = __periodic_jobs_start;
+            jobp < __periodic_jobs_end; ++jobp)
+    {
+        osalDbgCheck(jobp->fn != NULL && jobp->period > 0);
+
+        memset(jobp->statep, 0, sizeof(*jobp->statep));
+        jobp->statep->due = chTimeAddX(now, jobp->phase);
+
+        periodic_heap[periodic_count] = jobp;
+        periodic_sift_up(periodic_count++);
+    }
+
+    if (periodic_count == 0)
+        return;
+
+    periodic_running = true;
+
+    /* Creates the dispatcher thread. Note, it is created only once.*/
+    if (periodic_tp == NULL)
+    {
+        periodic_tp = chThdCreateStatic(periodic_wa, sizeof(periodic_wa),
+                PERIODIC_JOBS_PRIO, periodic_dispatcher, NULL);
+    }
+    else
+    {
+        osalSysLock();
+        osalThreadResumeS(&periodic_wait, MSG_OK);
+        osalSysUnlock();
+    }
+}
+
+/**
+ * @brief   Stops dispatching the periodic jobs.
+ * @details Waits for the job in progress to complete.
+ */
+void periodicJobsStop(void)
+{
+    osalSysLock();
+
+    if (periodic_running)
+    {
+        periodic_running = false;
+        osalThreadResumeI(&periodic_wait, MSG_RESET);
+        osalThreadSuspendS(&periodic_stopper);
+    }
+
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Gets a snapshot of the runtime state of a job.
+ *
+ * @param[in] jobp      job, see @p PERIODIC_JOB_REF()
+ * @param[out] statep   pointer to the state copy
+ */
+void periodicJobGetState(const periodic_job_t *jobp, periodic_state_t *statep)
+{
+    osalDbgCheck(jobp != NULL && statep != NULL);
+
+    osalSysLock();
+    *statep = *jobp->statep;
+    osalSysUnlock();
+}
@@ -0,0 +1,136 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qrwlock.c
+ * @brief   Readers-writer locks code.
+ *
+ * @addtogroup rwlocks
+ * @details Readers-writer locks let threads which only read a resource
+ *          share it, threads modifying it own it exclusively. Unlike
+ *          mutexes they are not recursive and do not provide priority
+ *          inheritance.
+ * @{
+ */
+
+#include "qhal.h"
+#include "qrwlock.h"
+
+/**
+ * @brief   Initializes a readers-writer lock.
+ *
+ * @param[out] rwlp     pointer to a @p rwlock_t structure
+ *
+ * @init
+ */
+void chRWLockObjectInit(rwlock_t *rwlp)
+{
+    osalDbgCheck(rwlp != NULL);
+
+    osalThreadQueueObjectInit(&rwlp->l_readers);
+    osalThreadQueueObjectInit(&rwlp->l_writers);
+    rwlp->l_readcnt = 0;
+    rwlp->l_writecnt = 0;
+    rwlp->l_written = false;
+}
+
+/**
+ * @brief   Acquires the lock for reading.
+ * @details The calling thread is suspended while a writer owns or waits
+ *          for the lock.
+ *
+ * @param[in] rwlp      pointer to a @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockAcquireShared(rwlock_t *rwlp)
+{
+    osalDbgCheck(rwlp != NULL);
+
+    osalSysLock();
+    while (rwlp->l_written || rwlp->l_writecnt > 0)
+        (void)osalThreadEnqueueTimeoutS(&rwlp->l_readers, TIME_INFINITE);
+    ++rwlp->l_readcnt;
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Releases the lock acquired for reading.
+ * @details The last reader hands the lock over to a waiting writer.
+ *
+ * @param[in] rwlp      pointer to a @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockReleaseShared(rwlock_t *rwlp)
+{
+    osalDbgCheck(rwlp != NULL);
+
+    osalSysLock();
+    osalDbgAssert(rwlp->l_readcnt > 0, "not owned");
+    if (--rwlp->l_readcnt == 0 && rwlp->l_writecnt > 0)
+    {
+        osalThreadDequeueNextI(&rwlp->l_writers, MSG_OK);
+        osalOsRescheduleS();
+    }
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Acquires the lock for writing.
+ * @details The calling thread is suspended while readers or another writer
+ *          own the lock.
+ *
+ * @param[in] rwlp      pointer to a @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockAcquire(rwlock_t *rwlp)
+{
+    osalDbgCheck(rwlp != NULL);
+
+    osalSysLock();
+    ++rwlp->l_writecnt;
+    while (rwlp->l_written || rwlp->l_readcnt > 0)
+        (void)osalThreadEnqueueTimeoutS(&rwlp->l_writers, TIME_INFINITE);
+    --rwlp->l_writecnt;
+    rwlp->l_written = true;
+    osalSysUnlock();
+}
+
+/**
+ * @brief   Releases the lock acquired for writing.
+ * @details The lock is handed over to the next waiting writer, without
+ *          waiting writers all waiting readers are resumed.
+ *
+ * @param[in] rwlp      pointer to a @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockRelease(rwlock_t *rwlp)
+{
+    osalDbgCheck(rwlp != NULL);
+
+    osalSysLock();
+    osalDbgAssert(rwlp->l_written, "not owned");
+    rwlp->l_written = false;
+    if (rwlp->l_writecnt > 0)
+        osalThreadDequeueNextI(&rwlp->l_writers, MSG_OK);
+    else
+        osalThreadDequeueAllI(&rwlp->l_readers, MSG_OK);
+    osalOsRescheduleS();
+    osalSysUnlock();
+}
+
+/** @} */
@@ -0,0 +1,453 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    qspscqueue.c
+ * @brief   Single producer single consumer queues code.
+ *
+ * @addtogroup io_queues
+ * @details Single producer single consumer queues transfer data without
+ *          entering the kernel. Exactly one context may write and exactly one
+ *          context may read, either of them may be an ISR using the X-class
+ *          functions. An ISR producer wakes a waiting consumer with:
+ *          @code
+ *          chSpscQWriteX(sqp, bp, n);
+ *          if (chSpscQIsReaderWaitingX(sqp)) {
+ *              osalSysLockFromISR();
+ *              chSpscQWakeReaderI(sqp);
+ *              osalSysUnlockFromISR();
+ *          }
+ *          @endcode
+ * @{
+ */
+
+#include "qhal.h"
+#include "qspscqueue.h"
+
+#include <string.h>
+
+/**
+ * @brief   Wakes a thread waiting on the queue, if any.
+ * @details The kernel is entered only if a thread is waiting.
+ *
+ * @param[in] trp       pointer to the waiting thread reference
+ *
+ * @notapi
+ */
+static void spsc_wake(thread_reference_t *trp)
+{
+    /* Orders the index update before the check of the waiting thread. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(trp, __ATOMIC_RELAXED) != NULL)
+    {
+        osalSysLock();
+        osalThreadResumeI(trp, MSG_OK);
+        osalOsRescheduleS();
+        osalSysUnlock();
+    }
+}
+
+/**
+ * @brief   Waits on the queue.
+ *
+ * @param[in] trp       pointer to the waiting thread reference
+ * @param[in] start     system time at the start of the operation
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @return              The wakeup message.
+ *
+ * @sclass
+ */
+static msg_t spsc_waitS(thread_reference_t *trp, systime_t start,
+                        sysinterval_t timeout)
+{
+    if (timeout != TIME_IMMEDIATE && timeout != TIME_INFINITE)
+    {
+        if (chVTTimeElapsedSinceX(start) >= timeout)
+            return MSG_TIMEOUT;
+        timeout -= chVTTimeElapsedSinceX(start);
+    }
+    return osalThreadSuspendTimeoutS(trp, timeout);
+}
+
+/**
+ * @brief   Initializes a single producer single consumer queue.
+ *
+ * @param[out] sqp      pointer to an @p spsc_queue_t structure
+ * @param[in] bp        pointer to a memory area allocated as queue buffer
+ * @param[in] size      size of the queue buffer, must be a power of two
+ *
+ * @init
+ */
+void chSpscQObjectInit(spsc_queue_t *sqp, uint8_t *bp, size_t size)
+{
+    osalDbgCheck((size > 0) && ((size & (size - 1)) == 0));
+
+    sqp->q_wrindex = 0;
+    sqp->q_rdindex = 0;
+    sqp->q_mask = size - 1;
+    sqp->q_buffer = bp;
+    sqp->q_reader = NULL;
+    sqp->q_writer = NULL;
+}
+
+/**
+ * @brief   Resets a single producer single consumer queue.
+ * @details All the data in the queue is erased and lost, any waiting
+ *          thread is resumed with status @p Q_RESET.
+ * @note    Neither side may be transferring data during the reset.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ *
+ * @iclass
+ */
+void chSpscQResetI(spsc_queue_t *sqp)
+{
+    osalDbgCheckClassI();
+
+    sqp->q_rdindex = sqp->q_wrindex;
+    osalThreadResumeI(&sqp->q_reader, Q_RESET);
+    osalThreadResumeI(&sqp->q_writer, Q_RESET);
+}
+
+/**
+ * @brief   Single producer single consumer queue read.
+ * @details This function reads a byte value from the queue without waking
+ *          a waiting producer. To be called by the consumer only.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ *
+ * @return              A byte value from the queue.
+ * @retval Q_EMPTY      If the queue is empty.
+ *
+ * @xclass
+ */
+msg_t chSpscQGetX(spsc_queue_t *sqp)
+{
+    size_t rd = sqp->q_rdindex;
+    uint8_t b;
+
+    if (__atomic_load_n(&sqp->q_wrindex, __ATOMIC_ACQUIRE) == rd)
+        return Q_EMPTY;
+
+    b = sqp->q_buffer[rd & sqp->q_mask];
+    __atomic_store_n(&sqp->q_rdindex, rd + 1, __ATOMIC_RELEASE);
+
+    return (msg_t)b;
+}
+
+/**
+ * @brief   Single producer single consumer queue bulk read.
+ * @details This function reads as much data as available, up to @p n bytes,
+ *          without waking a waiting producer. To be called by the consumer
+ *          only.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes effectively transferred.
+ *
+ * @xclass
+ */
+size_t chSpscQReadX(spsc_queue_t *sqp, uint8_t *bp, size_t n)
+{
+    size_t rd = sqp->q_rdindex;
+    size_t full = __atomic_load_n(&sqp->q_wrindex, __ATOMIC_ACQUIRE) - rd;
+    size_t pos = rd & sqp->q_mask;
+    size_t span = chSpscQSizeX(sqp) - pos;
+
+    if (n > full)
+        n = full;
+    if (span > n)
+        span = n;
+
+    memcpy(bp, sqp->q_buffer + pos, span);
+    memcpy(bp + span, sqp->q_buffer, n - span);
+    __atomic_store_n(&sqp->q_rdindex, rd + n, __ATOMIC_RELEASE);
+
+    return n;
+}
+
+/**
+ * @brief   Single producer single consumer queue write.
+ * @details This function writes a byte value to the queue without waking
+ *          a waiting consumer. To be called by the producer only.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ * @param[in] b         the byte value to be written in the queue
+ * @return              The operation status.
+ * @retval Q_OK         If the operation succeeded.
+ * @retval Q_FULL       If the queue is full.
+ *
+ * @xclass
+ */
+msg_t chSpscQPutX(spsc_queue_t *sqp, uint8_t b)
+{
+    size_t wr = sqp->q_wrindex;
+
+    if (wr - __atomic_load_n(&sqp->q_rdindex, __ATOMIC_ACQUIRE) >
+            sqp->q_mask)
+        return Q_FULL;
+
+    sqp->q_buffer[wr & sqp->q_mask] = b;
+    __atomic_store_n(&sqp->q_wrindex, wr + 1, __ATOMIC_RELEASE);
+
+    return Q_OK;
+}
+
+/**
+ * @brief   Single producer single consumer queue bulk write.
+ * @details This function writes as much of a buffer as fits into the queue
+ *          without waking a waiting consumer. To be called by the producer
+ *          only.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes effectively transferred.
+ *
+ * @xclass
+ */
+size_t chSpscQWriteX(spsc_queue_t *sqp, const uint8_t *bp, size_t n)
+{
+    size_t wr = sqp->q_wrindex;
+    size_t empty = chSpscQSizeX(sqp) -
+            (wr - __atomic_load_n(&sqp->q_rdindex, __ATOMIC_ACQUIRE));
+    size_t pos = wr & sqp->q_mask;
+    size_t span = chSpscQSizeX(sqp) - pos;
+
+    if (n > empty)
+        n = empty;
+    if (span > n)
+        span = n;
+
+    memcpy(sqp->q_buffer + pos, bp, span);
+    memcpy(sqp->q_buffer, bp + span, n - span);
+    __atomic_store_n(&sqp->q_wrindex, wr + n, __ATOMIC_RELEASE);
+
+    return n;
+}
+
+/**
+ * @brief   Wakes the consumer if it waits for data.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ *
+ * @iclass
+ */
+void chSpscQWakeReaderI(spsc_queue_t *sqp)
+{
+    osalDbgCheckClassI();
+
+    osalThreadResumeI(&sqp->q_reader, MSG_OK);
+}
+
+/**
+ * @brief   Wakes the producer if it waits for space.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ *
+ * @iclass
+ */
+void chSpscQWakeWriterI(spsc_queue_t *sqp)
+{
+    osalDbgCheckClassI();
+
+    osalThreadResumeI(&sqp->q_writer, MSG_OK);
+}
+
+/**
+ * @brief   Single producer single consumer queue read with timeout.
+ * @details This function reads a byte value from the queue. If the queue
+ *          is empty then the calling thread is suspended until a byte arrives
+ *          in the queue or a timeout occurs.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              A byte value from the queue.
+ * @retval Q_TIMEOUT    if the specified time expired.
+ * @retval Q_RESET      if the queue has been reset.
+ *
+ * @api
+ */
+msg_t chSpscQGetTimeout(spsc_queue_t *sqp, sysinterval_t timeout)
+{
+    msg_t msg;
+
+    osalSysLock();
+    if (chSpscQIsEmptyX(sqp))
+    {
+        if ((msg = osalThreadSuspendTimeoutS(&sqp->q_reader, timeout)) !=
+                MSG_OK)
+        {
+            osalSysUnlock();
+            return msg;
+        }
+    }
+    osalSysUnlock();
+
+    msg = chSpscQGetX(sqp);
+    spsc_wake(&sqp->q_writer);
+
+    return msg;
+}
+
+/**
+ * @brief   Single producer single consumer queue read with timeout.
+ * @details The function reads data from the queue into a buffer. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or after the specified timeout or if the queue has
+ *          been reset. Available data is copied at once, the kernel is
+ *          entered only to wait and to wake a waiting producer.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred, the
+ *                      value 0 is reserved
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t chSpscQReadTimeout(spsc_queue_t *sqp, uint8_t *bp,
+                          size_t n, sysinterval_t timeout)
+{
+    systime_t start = osalOsGetSystemTimeX();
+    size_t r = 0;
+
+    osalDbgCheck(n > 0);
+
+    while (TRUE)
+    {
+        size_t done = chSpscQReadX(sqp, bp + r, n - r);
+        if (done > 0)
+        {
+            r += done;
+            spsc_wake(&sqp->q_writer);
+            if (r == n)
+                return r;
+        }
+
+        osalSysLock();
+        if (chSpscQIsEmptyX(sqp) &&
+                (spsc_waitS(&sqp->q_reader, start, timeout) != MSG_OK))
+        {
+            osalSysUnlock();
+            return r;
+        }
+        osalSysUnlock();
+    }
+}
+
+/**
+ * @brief   Single producer single consumer queue write with timeout.
+ * @details This function writes a byte value to the queue. If the queue
+ *          is full then the calling thread is suspended until there is space
+ *          in the queue or a timeout occurs.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ * @param[in] b         the byte value to be written in the queue
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval Q_OK         if the operation succeeded.
+ * @retval Q_TIMEOUT    if the specified time expired.
+ * @retval Q_RESET      if the queue has been reset.
+ *
+ * @api
+ */
+msg_t chSpscQPutTimeout(spsc_queue_t *sqp, uint8_t b, sysinterval_t timeout)
+{
+    msg_t msg;
+
+    osalSysLock();
+    if (chSpscQIsFullX(sqp))
+    {
+        if ((msg = osalThreadSuspendTimeoutS(&sqp->q_writer, timeout)) !=
+                MSG_OK)
+        {
+            osalSysUnlock();
+            return msg;
+        }
+    }
+    osalSysUnlock();
+
+    msg = chSpscQPutX(sqp, b);
+    spsc_wake(&sqp->q_reader);
+
+    return msg;
+}
+
+/**
+ * @brief   Single producer single consumer queue write with timeout.
+ * @details The function writes data from a buffer to the queue. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or after the specified timeout or if the queue has
+ *          been reset. Free space is filled at once, the kernel is entered
+ *          only to wait and to wake a waiting consumer.
+ *
+ * @param[in] sqp       pointer to an @p spsc_queue_t structure
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred, the
+ *                      value 0 is reserved
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t chSpscQWriteTimeout(spsc_queue_t *sqp, const uint8_t *bp,
+                           size_t n, sysinterval_t timeout)
+{
+    systime_t start = osalOsGetSystemTimeX();
+    size_t w = 0;
+
+    osalDbgCheck(n > 0);
+
+    while (TRUE)
+    {
+        size_t done = chSpscQWriteX(sqp, bp + w, n - w);
+        if (done > 0)
+        {
+            w += done;
+            spsc_wake(&sqp->q_reader);
+            if (w == n)
+                return w;
+        }
+
+        osalSysLock();
+        if (chSpscQIsFullX(sqp) &&
+                (spsc_waitS(&sqp->q_writer, start, timeout) != MSG_OK))
+        {
+            osalSysUnlock();
+            return w;
+        }
+        osalSysUnlock();
+    }
+}
+
+/** @} */
@@ -37,6 +37,75 @@
 #include "qhal.h"
 #include "qsymqueue.h"
 
+#include <string.h>
+
+/**
+ * @brief   Returns the smaller of a watermark and a request size.
+ */
+#define symq_level(mark, n) ((mark) < (n) ? (mark) : (n))
+
+/**
+ * @brief   Wakes the waiting readers once enough data is queued.
+ * @details Woken readers check the queue again.
+ *
+ * @param[in] sqp       pointer to an @p symmetric_queue_t structure
+ *
+ * @notapi
+ */
+static void symq_wake_readersI(symmetric_queue_t *sqp)
+{
+    if (sqp->q_counter >= symq_level(sqp->q_rdmark, sqp->q_rdneed))
+    {
+        sqp->q_rdneed = SIZE_MAX;
+        osalThreadDequeueAllI(&sqp->q_readers, Q_OK);
+    }
+}
+
+/**
+ * @brief   Wakes the waiting writers once enough space is free.
+ * @details Woken writers check the queue again.
+ *
+ * @param[in] sqp       pointer to an @p symmetric_queue_t structure
+ *
+ * @notapi
+ */
+static void symq_wake_writersI(symmetric_queue_t *sqp)
+{
+    if (chSymQGetEmptyI(sqp) >= symq_level(sqp->q_wrmark, sqp->q_wrneed))
+    {
+        sqp->q_wrneed = SIZE_MAX;
+        osalThreadDequeueAllI(&sqp->q_writers, Q_OK);
+    }
+}
+
+/**
+ * @brief   Waits on the queue for a given amount of data or space.
+ *
+ * @param[in] tqp       pointer to the threads queue to wait on
+ * @param[in,out] needp pointer to the smallest amount waited for
+ * @param[in] need      amount waited for by the calling thread
+ * @param[in] start     system time at the start of the operation
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @return              The wakeup message.
+ *
+ * @sclass
+ */
+static msg_t symq_waitS(threads_queue_t *tqp, size_t *needp, size_t need,
+                        systime_t start, sysinterval_t timeout)
+{
+    if (need < *needp)
+        *needp = need;
+
+    if (timeout != TIME_IMMEDIATE && timeout != TIME_INFINITE)
+    {
+        if (chVTTimeElapsedSinceX(start) >= timeout)
+            return Q_TIMEOUT;
+        timeout -= chVTTimeElapsedSinceX(start);
+    }
+
+    return osalThreadEnqueueTimeoutS(tqp, timeout);
+}
+
 /**
  * @brief   Initializes a symmetric queue.
  * @details A semaphore is internally initialized and works as a counter of
@@ -57,6 +126,10 @@ void chSymQObjectInit(symmetric_queue_t *sqp, uint8_t *bp, size_t size)
     sqp->q_counter = 0;
     sqp->q_buffer = sqp->q_rdptr = sqp->q_wrptr = bp;
     sqp->q_top = bp + size;
+    sqp->q_rdmark = 1;
+    sqp->q_wrmark = 1;
+    sqp->q_rdneed = SIZE_MAX;
+    sqp->q_wrneed = SIZE_MAX;
 }
 
 /**
@@ -76,10 +149,39 @@ void chSymQResetI(symmetric_queue_t *sqp)
 
     sqp->q_rdptr = sqp->q_wrptr = sqp->q_buffer;
     sqp->q_counter = 0;
+    sqp->q_rdneed = SIZE_MAX;
+    sqp->q_wrneed = SIZE_MAX;
     osalThreadDequeueAllI(&sqp->q_readers, Q_RESET);
     osalThreadDequeueAllI(&sqp->q_writers, Q_RESET);
 }
 
+/**
+ * @brief   Sets the wakeup watermarks of a symmetric queue.
+ * @details A waiting reader is woken once @p rdmark bytes are queued and a
+ *          waiting writer once @p wrmark bytes are free, or when fewer bytes
+ *          complete its request. Until then the transfers are not woken on
+ *          each byte. On timeout the data queued so far is read, or the
+ *          free space is filled.
+ *
+ * @param[in] sqp       pointer to an @p symmetric_queue_t structure
+ * @param[in] rdmark    readers watermark, from 1 to the queue size
+ * @param[in] wrmark    writers watermark, from 1 to the queue size
+ *
+ * @iclass
+ */
+void chSymQSetWatermarksI(symmetric_queue_t *sqp, size_t rdmark,
+                          size_t wrmark)
+{
+    osalDbgCheckClassI();
+    osalDbgCheck((rdmark > 0) && (rdmark <= chSymQSizeI(sqp)) &&
+                 (wrmark > 0) && (wrmark <= chSymQSizeI(sqp)));
+
+    sqp->q_rdmark = rdmark;
+    sqp->q_wrmark = wrmark;
+    symq_wake_readersI(sqp);
+    symq_wake_writersI(sqp);
+}
+
 /**
  * @brief   Symmetric queue read.
  * @details This function reads a byte value from a symmetric queue.
@@ -105,8 +207,7 @@ msg_t chSymQGetI(symmetric_queue_t *sqp)
     if (sqp->q_rdptr >= sqp->q_top)
         sqp->q_rdptr = sqp->q_buffer;
 
-    /* Wake first eventually pending writer. */
-    osalThreadDequeueNextI(&sqp->q_writers, Q_OK);
+    symq_wake_writersI(sqp);
 
     return b;
 }
@@ -131,14 +232,16 @@ msg_t chSymQGetI(symmetric_queue_t *sqp)
  */
 msg_t chSymQGetTimeoutS(symmetric_queue_t *sqp, sysinterval_t timeout)
 {
+    systime_t start = osalOsGetSystemTimeX();
     uint8_t b;
 
     osalDbgCheckClassS();
 
-    if (chSymQIsEmptyI(sqp))
+    while (chSymQIsEmptyI(sqp))
     {
         msg_t msg;
-        if ((msg = osalThreadEnqueueTimeoutS(&sqp->q_readers, timeout)) != Q_OK)
+        if ((msg = symq_waitS(&sqp->q_readers, &sqp->q_rdneed, 1,
+                start, timeout)) != Q_OK)
             return msg;
     }
 
@@ -147,8 +250,7 @@ msg_t chSymQGetTimeoutS(symmetric_queue_t *sqp, sysinterval_t timeout)
     if (sqp->q_rdptr >= sqp->q_top)
         sqp->q_rdptr = sqp->q_buffer;
 
-    /* Wake first eventually pending writer. */
-    osalThreadDequeueNextI(&sqp->q_writers, Q_OK);
+    symq_wake_writersI(sqp);
 
     return b;
 }
@@ -186,7 +288,9 @@ msg_t chSymQGetTimeout(symmetric_queue_t *sqp, sysinterval_t timeout)
  * @details The function reads data from an input queue into a buffer. The
  *          operation completes when the specified amount of data has been
  *          transferred or after the specified timeout or if the queue has
- *          been reset.
+ *          been reset. Contiguous spans are copied at once, the kernel is
+ *          unlocked between spans. The thread is woken once the watermark
+ *          set by @p chSymQSetWatermarksI() is reached.
  * @note    The function is not atomic, if you need atomicity it is suggested
  *          to use a semaphore or a mutex for mutual exclusion.
  *
@@ -212,36 +316,46 @@ size_t chSymQReadTimeoutS(symmetric_queue_t *sqp, uint8_t *bp,
 
     osalDbgCheck(n > 0);
 
-    sysinterval_t start = osalOsGetSystemTimeX();
+    systime_t start = osalOsGetSystemTimeX();
 
     while (TRUE)
     {
-        if (chSymQIsEmptyI(sqp))
+        size_t level = symq_level(sqp->q_rdmark, n);
+        if (sqp->q_counter < level)
         {
-            sysinterval_t this_timeout = timeout;
-            if (timeout != TIME_IMMEDIATE && timeout != TIME_INFINITE)
-            {
-                if (chVTTimeElapsedSinceX(start) >= timeout)
-                    return r;
-                this_timeout = timeout - chVTTimeElapsedSinceX(start);
-            }
-
-            if (osalThreadEnqueueTimeoutS(&sqp->q_readers, this_timeout) != Q_OK)
+            msg_t msg = symq_waitS(&sqp->q_readers, &sqp->q_rdneed, level,
+                    start, timeout);
+            if (msg == Q_OK)
+                continue;
+            if ((msg != Q_TIMEOUT) || chSymQIsEmptyI(sqp))
                 return r;
+
+            /* Timed out below the watermark, takes what is queued. */
+            if (n > sqp->q_counter)
+                n = sqp->q_counter;
         }
 
-        sqp->q_counter--;
-        *bp++ = *sqp->q_rdptr++;
+        /* Largest contiguous span available. */
+        size_t span = (size_t)(sqp->q_top - sqp->q_rdptr);
+        if (span > sqp->q_counter)
+            span = sqp->q_counter;
+        if (span > n)
+            span = n;
+
+        memcpy(bp, sqp->q_rdptr, span);
+        bp += span;
+        sqp->q_counter -= span;
+        sqp->q_rdptr += span;
         if (sqp->q_rdptr >= sqp->q_top)
             sqp->q_rdptr = sqp->q_buffer;
 
-        /* Wake first eventually pending writer. */
-        osalThreadDequeueNextI(&sqp->q_writers, Q_OK);
+        symq_wake_writersI(sqp);
 
         osalOsRescheduleS();
         osalSysUnlock(); /* Gives a preemption chance in a controlled point.*/
-        r++;
-        if (--n == 0)
+        r += span;
+        n -= span;
+        if (n == 0)
         {
             osalSysLock();
             return r;
@@ -283,6 +397,55 @@ size_t chSymQReadTimeout(symmetric_queue_t *sqp, uint8_t *bp,
     return result;
 }
 
+/**
+ * @brief   Symmetric queue zero copy read.
+ * @details Returns the contiguous span of queued data starting at the read
+ *          pointer, up to the end of the buffer. The data stays in the queue
+ *          until released with @p chSymQReadConsumeI().
+ * @note    Only one context may peek at a time and other readers must not
+ *          read the queue until the data is consumed.
+ *
+ * @param[in] sqp       pointer to an @p symmetric_queue_t structure
+ * @param[out] pp       pointer to the start of the span
+ * @return              The size of the span.
+ * @retval 0            if the queue is empty.
+ *
+ * @iclass
+ */
+size_t chSymQReadPeekI(symmetric_queue_t *sqp, uint8_t **pp)
+{
+    size_t n = chSymQGetFullI(sqp);
+
+    osalDbgCheckClassI();
+
+    if (n > (size_t)(sqp->q_top - sqp->q_rdptr))
+        n = (size_t)(sqp->q_top - sqp->q_rdptr);
+    *pp = sqp->q_rdptr;
+
+    return n;
+}
+
+/**
+ * @brief   Releases data obtained with @p chSymQReadPeekI().
+ *
+ * @param[in] sqp       pointer to an @p symmetric_queue_t structure
+ * @param[in] n         number of bytes to release, not exceeding the span
+ *
+ * @iclass
+ */
+void chSymQReadConsumeI(symmetric_queue_t *sqp, size_t n)
+{
+    osalDbgCheckClassI();
+    osalDbgCheck(n <= chSymQGetFullI(sqp));
+
+    sqp->q_counter -= n;
+    sqp->q_rdptr += n;
+    if (sqp->q_rdptr >= sqp->q_top)
+        sqp->q_rdptr -= chSymQSizeI(sqp);
+
+    symq_wake_writersI(sqp);
+}
+
 /**
  * @brief   Symmetric queue write.
  * @details This function writes a byte value to a symmetric queue.
@@ -308,12 +471,107 @@ msg_t chSymQPutI(symmetric_queue_t *sqp, uint8_t b)
     if (sqp->q_wrptr >= sqp->q_top)
         sqp->q_wrptr = sqp->q_buffer;
 
-    /* Wake first eventually pending reader. */
-    osalThreadDequeueNextI(&sqp->q_readers, Q_OK);
+    symq_wake_readersI(sqp);
 
     return Q_OK;
 }
 
+/**
+ * @brief   Symmetric queue bulk write.
+ * @details This function writes as much of a buffer as fits into a
+ *          symmetric queue, copying contiguous spans at once.
+ *
+ * @param[in] sqp       pointer to an @p symmetric_queue_t structure
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes effectively transferred.
+ *
+ * @iclass
+ */
+size_t chSymQWriteI(symmetric_queue_t *sqp, const uint8_t *bp, size_t n)
+{
+    size_t w = 0;
+
+    osalDbgCheckClassI();
+
+    if (n > chSymQGetEmptyI(sqp))
+        n = chSymQGetEmptyI(sqp);
+
+    while (w < n)
+    {
+        size_t span = (size_t)(sqp->q_top - sqp->q_wrptr);
+        if (span > n - w)
+            span = n - w;
+        memcpy(sqp->q_wrptr, bp + w, span);
+        w += span;
+        sqp->q_wrptr += span;
+        if (sqp->q_wrptr >= sqp->q_top)
+            sqp->q_wrptr = sqp->q_buffer;
+    }
+    sqp->q_counter += w;
+
+    symq_wake_readersI(sqp);
+
+    return w;
+}
+
+/**
+ * @brief   Symmetric queue zero copy write.
+ * @details Returns the contiguous span of free space starting at the write
+ *          pointer, up to the end of the buffer and at most @p max bytes.
+ *          The data written there is queued by @p chSymQWriteCommitI(). An
+ *          empty queue is rewound first, so that the whole buffer is
+ *          available.
+ * @note    Only one context may reserve at a time and other writers must not
+ *          write the queue until the data is committed.
+ *
+ * @param[in] sqp       pointer to an @p symmetric_queue_t structure
+ * @param[out] pp       pointer to the start of the span
+ * @param[in] max       the maximum size of the span
+ * @return              The size of the span.
+ * @retval 0            if the queue is full.
+ *
+ * @iclass
+ */
+size_t chSymQWriteReserveI(symmetric_queue_t *sqp, uint8_t **pp, size_t max)
+{
+    size_t n = chSymQGetEmptyI(sqp);
+
+    osalDbgCheckClassI();
+
+    if (chSymQIsEmptyI(sqp) == TRUE)
+        sqp->q_rdptr = sqp->q_wrptr = sqp->q_buffer;
+
+    if (n > (size_t)(sqp->q_top - sqp->q_wrptr))
+        n = (size_t)(sqp->q_top - sqp->q_wrptr);
+    if (n > max)
+        n = max;
+    *pp = sqp->q_wrptr;
+
+    return n;
+}
+
+/**
+ * @brief   Queues data written into a span from @p chSymQWriteReserveI().
+ *
+ * @param[in] sqp       pointer to an @p symmetric_queue_t structure
+ * @param[in] n         number of bytes to queue, not exceeding the span
+ *
+ * @iclass
+ */
+void chSymQWriteCommitI(symmetric_queue_t *sqp, size_t n)
+{
+    osalDbgCheckClassI();
+    osalDbgCheck(n <= chSymQGetEmptyI(sqp));
+
+    sqp->q_counter += n;
+    sqp->q_wrptr += n;
+    if (sqp->q_wrptr >= sqp->q_top)
+        sqp->q_wrptr -= chSymQSizeI(sqp);
+
+    symq_wake_readersI(sqp);
+}
+
 /**
  * @brief   Symmetric queue write with timeout.
  * @details This function writes a byte value to an output queue. If the queue
@@ -336,12 +594,15 @@ msg_t chSymQPutI(symmetric_queue_t *sqp, uint8_t b)
  */
 msg_t chSymQPutTimeoutS(symmetric_queue_t *sqp, uint8_t b, sysinterval_t timeout)
 {
+    systime_t start = osalOsGetSystemTimeX();
+
     osalDbgCheckClassS();
 
-    if (chSymQIsFullI(sqp))
+    while (chSymQIsFullI(sqp))
     {
         msg_t msg;
-        if ((msg = osalThreadEnqueueTimeoutS(&sqp->q_writers, timeout)) != Q_OK)
+        if ((msg = symq_waitS(&sqp->q_writers, &sqp->q_wrneed, 1,
+                start, timeout)) != Q_OK)
             return msg;
     }
 
@@ -350,8 +611,7 @@ msg_t chSymQPutTimeoutS(symmetric_queue_t *sqp, uint8_t b, sysinterval_t timeout
     if (sqp->q_wrptr >= sqp->q_top)
         sqp->q_wrptr = sqp->q_buffer;
 
-    /* Wake first eventually pending reader. */
-    osalThreadDequeueNextI(&sqp->q_readers, Q_OK);
+    symq_wake_readersI(sqp);
 
     return Q_OK;
 }
@@ -391,7 +651,9 @@ msg_t chSymQPutTimeout(symmetric_queue_t *sqp, uint8_t b, sysinterval_t timeout)
  * @details The function writes data from a buffer to an output queue. The
  *          operation completes when the specified amount of data has been
  *          transferred or after the specified timeout or if the queue has
- *          been reset.
+ *          been reset. Contiguous spans are copied at once, the kernel is
+ *          unlocked between spans. The thread is woken once the watermark
+ *          set by @p chSymQSetWatermarksI() is reached.
  * @note    The function is not atomic, if you need atomicity it is suggested
  *          to use a semaphore or a mutex for mutual exclusion.
  *
@@ -417,36 +679,46 @@ size_t chSymQWriteTimeoutS(symmetric_queue_t *sqp, const uint8_t *bp,
 
     osalDbgCheck(n > 0);
 
-    sysinterval_t start = osalOsGetSystemTimeX();
+    systime_t start = osalOsGetSystemTimeX();
 
     while (TRUE)
     {
-        if (chSymQIsFullI(sqp))
+        size_t level = symq_level(sqp->q_wrmark, n);
+        if (chSymQGetEmptyI(sqp) < level)
         {
-            sysinterval_t this_timeout = timeout;
-            if (timeout != TIME_IMMEDIATE && timeout != TIME_INFINITE)
-            {
-                if (chVTTimeElapsedSinceX(start) >= timeout)
-                    return w;
-                this_timeout = timeout - chVTTimeElapsedSinceX(start);
-            }
-
-            if (osalThreadEnqueueTimeoutS(&sqp->q_writers, this_timeout) != Q_OK)
+            msg_t msg = symq_waitS(&sqp->q_writers, &sqp->q_wrneed, level,
+                    start, timeout);
+            if (msg == Q_OK)
+                continue;
+            if ((msg != Q_TIMEOUT) || chSymQIsFullI(sqp))
                 return w;
+
+            /* Timed out below the watermark, fills the free space. */
+            if (n > chSymQGetEmptyI(sqp))
+                n = chSymQGetEmptyI(sqp);
         }
 
-        sqp->q_counter++;
-        *sqp->q_wrptr++ = *bp++;
+        /* Largest contiguous span available. */
+        size_t span = (size_t)(sqp->q_top - sqp->q_wrptr);
+        if (span > chSymQGetEmptyI(sqp))
+            span = chSymQGetEmptyI(sqp);
+        if (span > n)
+            span = n;
+
+        memcpy(sqp->q_wrptr, bp, span);
+        bp += span;
+        sqp->q_counter += span;
+        sqp->q_wrptr += span;
         if (sqp->q_wrptr >= sqp->q_top)
             sqp->q_wrptr = sqp->q_buffer;
 
-        /* Wake first eventually pending reader. */
-        osalThreadDequeueNextI(&sqp->q_readers, Q_OK);
+        symq_wake_readersI(sqp);
 
         osalOsRescheduleS();
         osalSysUnlock(); /* Gives a preemption chance in a controlled point.*/
-        w++;
-        if (--n == 0)
+        w += span;
+        n -= span;
+        if (n == 0)
         {
             osalSysLock();
             return w;
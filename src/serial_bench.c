@@ -0,0 +1,332 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "serial_bench.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*===========================================================================*/
+/* Local definitions                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Imported variables                                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Exported variables                                                        */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local types                                                               */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Local constants                                                           */
+/*===========================================================================*/
+
+static const char* const serial_bench_workload_names[] =
+{
+    [SERIAL_BENCH_STREAM] = "stream",
+    [SERIAL_BENCH_ECHO] = "echo",
+};
+
+/*===========================================================================*/
+/* Local variables                                                           */
+/*===========================================================================*/
+
+/**
+ * @brief   Working area of the stream writer thread.
+ */
+static THD_WORKING_AREA(serial_bench_wa, SERIAL_BENCH_THREAD_STACK_SIZE);
+
+/**
+ * @brief   Stops the stream writer once the reader gave up.
+ */
+static volatile bool serial_bench_abort;
+
+/*===========================================================================*/
+/* Local functions                                                           */
+/*===========================================================================*/
+
+static uint32_t serial_bench_now(const SerialBenchConfig* configp)
+{
+    if (configp->clock != NULL)
+        return configp->clock();
+
+    return (uint32_t)osalOsGetSystemTimeX();
+}
+
+static uint32_t serial_bench_elapsed(const SerialBenchConfig* configp,
+        uint32_t start)
+{
+    if (configp->clock != NULL)
+        return configp->clock() - start;
+
+    /* Wrap around at the width of the system time. */
+    return (uint32_t)(systime_t)(osalOsGetSystemTimeX() - (systime_t)start);
+}
+
+static uint32_t serial_bench_frequency(const SerialBenchConfig* configp)
+{
+    if (configp->clock != NULL)
+        return configp->clock_frequency;
+
+    return OSAL_ST_FREQUENCY;
+}
+
+static uint32_t serial_bench_us(const SerialBenchConfig* configp, uint32_t t)
+{
+    const uint32_t frequency = serial_bench_frequency(configp);
+
+    if (frequency == 0)
+        return 0;
+
+    return (uint32_t)((uint64_t)t * 1000000 / frequency);
+}
+
+static int serial_bench_compare(const void* a, const void* b)
+{
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+static void serial_bench_fill(uint8_t* buffer, uint32_t pos, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i, ++pos)
+        buffer[i] = (uint8_t)(pos ^ (pos >> 8));
+}
+
+static bool serial_bench_check(const uint8_t* buffer, uint32_t pos,
+        uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i, ++pos)
+    {
+        if (buffer[i] != (uint8_t)(pos ^ (pos >> 8)))
+            return false;
+    }
+
+    return true;
+}
+
+static void serial_bench_writer(void* arg)
+{
+    const SerialBenchConfig* configp = (const SerialBenchConfig*)arg;
+    uint8_t buffer[SERIAL_BENCH_BUFFER_SIZE];
+
+    chRegSetThreadName("serial_bench");
+
+    for (uint32_t i = 0; (i < configp->ops) && !serial_bench_abort; ++i)
+    {
+        serial_bench_fill(buffer, i * configp->op_size, configp->op_size);
+        if (chnWriteTimeout(configp->nearp, buffer, configp->op_size,
+                configp->timeout) != configp->op_size)
+            break;
+    }
+}
+
+static void serial_bench_stream(const SerialBenchConfig* configp,
+        SerialBenchResult* resultp)
+{
+    uint8_t buffer[SERIAL_BENCH_BUFFER_SIZE];
+
+    serial_bench_abort = false;
+    thread_t* tp = chThdCreateStatic(serial_bench_wa, sizeof(serial_bench_wa),
+            chThdGetPriorityX(), serial_bench_writer, (void*)configp);
+
+    for (uint32_t i = 0; i < configp->ops; ++i)
+    {
+        size_t n = chnReadTimeout(configp->farp, buffer, configp->op_size,
+                configp->timeout);
+
+        resultp->bytes += n;
+        if ((n != configp->op_size) || (serial_bench_check(buffer,
+                i * configp->op_size, configp->op_size) == false))
+        {
+            ++resultp->failures;
+            serial_bench_abort = true;
+            break;
+        }
+        ++resultp->ops;
+    }
+
+    chThdWait(tp);
+}
+
+static void serial_bench_echo(const SerialBenchConfig* configp,
+        SerialBenchResult* resultp)
+{
+    uint8_t buffer[SERIAL_BENCH_BUFFER_SIZE];
+
+    for (uint32_t i = 0; i < configp->ops; ++i)
+    {
+        const uint32_t n = configp->op_size;
+        const uint32_t start = serial_bench_now(configp);
+        bool result;
+
+        serial_bench_fill(buffer, i * n, n);
+        result = (chnWriteTimeout(configp->nearp, buffer, n,
+                configp->timeout) == n) &&
+                (chnReadTimeout(configp->farp, buffer, n,
+                configp->timeout) == n) &&
+                (chnWriteTimeout(configp->farp, buffer, n,
+                configp->timeout) == n) &&
+                (chnReadTimeout(configp->nearp, buffer, n,
+                configp->timeout) == n) &&
+                serial_bench_check(buffer, i * n, n);
+
+        const uint32_t latency = serial_bench_elapsed(configp, start);
+
+        if (result == false)
+        {
+            ++resultp->failures;
+            break;
+        }
+        ++resultp->ops;
+        resultp->bytes += n;
+        if (latency > resultp->latency_max)
+            resultp->latency_max = latency;
+        if (configp->samples != NULL)
+            configp->samples[i] = latency;
+    }
+}
+
+/*===========================================================================*/
+/* Exported functions                                                        */
+/*===========================================================================*/
+
+/**
+ * @brief   Runs a benchmark workload across a serial link.
+ * @details The stream workload writes from a helper thread at the priority
+ *          of the caller while the caller reads and checks the data. The
+ *          echo workload sends each transfer to the far end and back from
+ *          the calling thread. The run ends at the first transfer which
+ *          times out or arrives corrupted.
+ * @note    The benchmark is not reentrant.
+ *
+ * @param[in] configp   pointer to the @p SerialBenchConfig object
+ * @param[out] resultp  pointer to the @p SerialBenchResult object
+ *
+ * @return              The result of the operation.
+ * @retval HAL_SUCCESS  all transfers succeeded.
+ * @retval HAL_FAILED   a transfer failed.
+ *
+ * @api
+ */
+bool serialbenchRun(const SerialBenchConfig* configp,
+        SerialBenchResult* resultp)
+{
+    osalDbgCheck((configp != NULL) && (resultp != NULL));
+    osalDbgCheck((configp->nearp != NULL) && (configp->farp != NULL));
+    osalDbgAssert(configp->op_size > 0 &&
+            configp->op_size <= SERIAL_BENCH_BUFFER_SIZE,
+            "invalid parameters");
+
+    memset(resultp, 0, sizeof(*resultp));
+
+#if HAL_USE_SERIAL_FDX && SERIAL_FDX_USE_STATS
+    if (configp->fdxp != NULL)
+        sfdxdResetStats(configp->fdxp);
+#endif
+
+    const uint32_t run_start = serial_bench_now(configp);
+
+    if (configp->workload == SERIAL_BENCH_ECHO)
+        serial_bench_echo(configp, resultp);
+    else
+        serial_bench_stream(configp, resultp);
+
+    resultp->time = serial_bench_elapsed(configp, run_start);
+    if (resultp->time != 0)
+        resultp->bytes_per_s = (uint32_t)((uint64_t)resultp->bytes *
+                serial_bench_frequency(configp) / resultp->time);
+
+    if (configp->workload == SERIAL_BENCH_ECHO &&
+            configp->samples != NULL && resultp->ops > 0)
+    {
+        qsort(configp->samples, resultp->ops, sizeof(configp->samples[0]),
+                serial_bench_compare);
+        resultp->latency_p50 =
+                configp->samples[(uint64_t)(resultp->ops - 1) * 50 / 100];
+        resultp->latency_p99 =
+                configp->samples[(uint64_t)(resultp->ops - 1) * 99 / 100];
+    }
+
+#if HAL_USE_SERIAL_FDX && SERIAL_FDX_USE_STATS
+    if (configp->fdxp != NULL)
+    {
+        SerialFdxStats stats;
+        sfdxdGetStats(configp->fdxp, &stats);
+        resultp->mtu = (configp->fdxp->configp->mtu != 0) ?
+                (uint32_t)configp->fdxp->configp->mtu : SERIAL_FDX_MTU;
+        resultp->frames_sent = stats.frames_sent;
+        resultp->frames_received = stats.frames_received;
+        if (resultp->time != 0)
+            resultp->frames_per_s = (uint32_t)((uint64_t)stats.frames_sent *
+                    serial_bench_frequency(configp) / resultp->time);
+    }
+#endif
+
+    return (resultp->failures == 0) ? HAL_SUCCESS : HAL_FAILED;
+}
+
+/**
+ * @brief   Formats benchmark results as a single line JSON object.
+ * @details Times are converted to microseconds.
+ *
+ * @param[out] buffer   pointer to the output buffer
+ * @param[in] size      size of the output buffer
+ * @param[in] name      name identifying the link under test
+ * @param[in] configp   pointer to the @p SerialBenchConfig object of the run
+ * @param[in] resultp   pointer to the @p SerialBenchResult object of the run
+ *
+ * @return              The number of characters of the complete line as
+ *                      returned by @p snprintf().
+ *
+ * @api
+ */
+int serialbenchFormat(char* buffer, size_t size, const char* name,
+        const SerialBenchConfig* configp, const SerialBenchResult* resultp)
+{
+    osalDbgCheck((name != NULL) && (configp != NULL) && (resultp != NULL));
+
+    const char* workload = "unknown";
+    if ((size_t)configp->workload < sizeof(serial_bench_workload_names) /
+            sizeof(serial_bench_workload_names[0]))
+        workload = serial_bench_workload_names[configp->workload];
+
+    int length = snprintf(buffer, size,
+            "{\"name\":\"%s\",\"workload\":\"%s\",\"op_size\":%" PRIu32
+            ",\"ops\":%" PRIu32 ",\"failures\":%" PRIu32
+            ",\"bytes\":%" PRIu32 ",\"time_us\":%" PRIu32
+            ",\"bytes_per_s\":%" PRIu32 ",\"latency_p50_us\":%" PRIu32
+            ",\"latency_p99_us\":%" PRIu32 ",\"latency_max_us\":%" PRIu32
+            ",\"mtu\":%" PRIu32 ",\"frames_sent\":%" PRIu32
+            ",\"frames_received\":%" PRIu32 ",\"frames_per_s\":%" PRIu32
+            "}\n",
+            name, workload, configp->op_size, resultp->ops,
+            resultp->failures, resultp->bytes,
+            serial_bench_us(configp, resultp->time), resultp->bytes_per_s,
+            serial_bench_us(configp, resultp->latency_p50),
+            serial_bench_us(configp, resultp->latency_p99),
+            serial_bench_us(configp, resultp->latency_max),
+            resultp->mtu, resultp->frames_sent, resultp->frames_received,
+            resultp->frames_per_s);
+    return length;
+}